@@ -0,0 +1,268 @@
+#
+# ESP32-S3リンク 相手側模擬スクリプト
+#   drv_espのフレーム(同期/Go-Back-N/累積応答/CRC-16)をESP32-S3側として実装し、
+#   main_appのエコーバックに各チャネルで送信したデータが一致して戻ることを
+#   確認してスループットを表示する。シミュレーターがログに出力する
+#   疑似端末(ESP32-S3 link: /dev/pts/N)に接続する(pyserial不要)。
+#   --drop/--corruptで送受信フレームの欠落/破損を注入し、再送で回復することを確認できる。
+#
+#   使い方: python3 esp_peer.py デバイス [総バイト数] [--drop 確率] [--corrupt 確率] [--seed 値]
+#
+import argparse
+import os
+import random
+import select
+import sys
+import termios
+import time
+import tty
+
+SOF = b"\xA5\x5A"
+TYPE_DATA = 0x00
+TYPE_ACK = 0x10
+TYPE_SYNC = 0x20
+TYPE_SYNC_ACK = 0x30
+HEADER_SIZE = 6
+CRC_SIZE = 2
+PAYLOAD_MAX = 192
+WINDOW = 4
+CH_NUM = 4
+RTO = 0.05          # 再送までの時間[s]
+RETRY_MAX = 8       # 続けて再送する回数(超えると同期からやり直す)
+SYNC_PERIOD = 0.1   # 同期要求の送信周期[s]
+TIMEOUT = 10.0      # 受信が進まない場合の打ち切り時間[s]
+
+
+def crc_table():
+    table = []
+    for i in range(256):
+        crc = i << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if (crc & 0x8000) else (crc << 1)
+        table.append(crc & 0xFFFF)
+    return table
+
+
+CRC_TABLE = crc_table()
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        crc = ((crc << 8) & 0xFFFF) ^ CRC_TABLE[(crc >> 8) ^ b]
+    return crc
+
+
+def frame(kind, ch, seq, ack, payload=b""):
+    body = bytes((kind | ch, seq & 0xFF, ack & 0xFF, len(payload))) + payload
+    crc = crc16(body)
+    return SOF + body + bytes((crc & 0xFF, crc >> 8))
+
+
+class Peer:
+    def __init__(self, fd, args):
+        self.fd = fd
+        self.args = args
+        self.rng = random.Random(args.seed)
+        self.rx = bytearray()
+        self.up = False
+        self.stats = dict(tx=0, rx=0, retx=0, timeout=0, crc=0, seq=0, sync=0, drop=0, corrupt=0)
+        self.reset()
+
+    def reset(self):
+        self.tx_base = 0
+        self.tx_next = 0
+        self.frames = {}        # 送信番号 -> (チャネル, データ)
+        self.rx_expect = 0
+        self.ack_pending = False
+        self.retries = 0
+        self.deadline = 0.0
+
+    # ---- 送信 ----
+    def send(self, data):
+        if self.rng.random() < self.args.drop:
+            self.stats["drop"] += 1
+            return
+        if self.rng.random() < self.args.corrupt:
+            self.stats["corrupt"] += 1
+            pos = self.rng.randrange(2, len(data))
+            data = data[:pos] + bytes((data[pos] ^ 0x10,)) + data[pos + 1:]
+        os.write(self.fd, data)
+
+    def send_data(self, seq):
+        ch, payload = self.frames[seq]
+        self.send(frame(TYPE_DATA, ch, seq, self.rx_expect, payload))
+        self.ack_pending = False
+
+    def window_free(self):
+        return ((self.tx_next - self.tx_base) & 0xFF) < WINDOW
+
+    def write(self, ch, payload):
+        seq = self.tx_next
+        self.frames[seq] = (ch, payload)
+        self.tx_next = (seq + 1) & 0xFF
+        self.stats["tx"] += len(payload)
+        self.send_data(seq)
+        if self.deadline == 0.0:
+            self.deadline = time.monotonic() + RTO
+
+    def poll_timeout(self, now):
+        if not self.frames or now < self.deadline:
+            return
+        self.stats["timeout"] += 1
+        self.retries += 1
+        if self.retries > RETRY_MAX:
+            # 相手が応答しない: 同期からやり直す(未応答のデータは相手に届いていない)
+            self.up = False
+            return
+        seq = self.tx_base
+        while seq != self.tx_next:
+            self.stats["retx"] += 1
+            self.send_data(seq)
+            seq = (seq + 1) & 0xFF
+        self.deadline = now + RTO
+
+    # ---- 受信 ----
+    def receive(self, data, sink):
+        self.rx += data
+        while True:
+            pos = self.rx.find(SOF)
+            if pos < 0:
+                del self.rx[:-1]
+                return
+            del self.rx[:pos]
+            if len(self.rx) < HEADER_SIZE:
+                return
+            size = HEADER_SIZE + self.rx[5]
+            if self.rx[5] > PAYLOAD_MAX:
+                del self.rx[:1]
+                continue
+            if len(self.rx) < size + CRC_SIZE:
+                return
+            body = bytes(self.rx[2:size])
+            crc = self.rx[size] | (self.rx[size + 1] << 8)
+            if crc16(body) != crc:
+                self.stats["crc"] += 1
+                del self.rx[:1]
+                continue
+            del self.rx[:size + CRC_SIZE]
+            if self.rng.random() < self.args.drop:
+                self.stats["drop"] += 1
+                continue
+            self.handle(body, sink)
+
+    def handle(self, body, sink):
+        kind = body[0] & 0xF0
+        ch = body[0] & 0x0F
+        seq, ack = body[1], body[2]
+        if kind == TYPE_SYNC:
+            self.reset()
+            self.up = True
+            self.stats["sync"] += 1
+            self.send(frame(TYPE_SYNC_ACK, 0, 0, 0))
+        elif kind == TYPE_SYNC_ACK:
+            if not self.up:
+                self.up = True
+                self.stats["sync"] += 1
+        elif self.up and kind in (TYPE_DATA, TYPE_ACK):
+            self.handle_ack(ack)
+            if kind == TYPE_DATA:
+                self.ack_pending = True
+                if seq != self.rx_expect:
+                    self.stats["seq"] += 1
+                    return
+                self.rx_expect = (self.rx_expect + 1) & 0xFF
+                self.stats["rx"] += len(body) - 4
+                sink(ch, body[4:])
+
+    def handle_ack(self, ack):
+        acked = (ack - self.tx_base) & 0xFF
+        if acked == 0 or acked > ((self.tx_next - self.tx_base) & 0xFF):
+            return
+        while self.tx_base != ack:
+            del self.frames[self.tx_base]
+            self.tx_base = (self.tx_base + 1) & 0xFF
+        self.retries = 0
+        self.deadline = (time.monotonic() + RTO) if self.frames else 0.0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="ESP32-S3 link peer for drv_esp")
+    parser.add_argument("device")
+    parser.add_argument("bytes", nargs="?", type=int, default=65536)
+    parser.add_argument("--drop", type=float, default=0.0, help="frame drop probability")
+    parser.add_argument("--corrupt", type=float, default=0.0, help="frame corruption probability")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    fd = os.open(args.device, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    termios.tcflush(fd, termios.TCIOFLUSH)
+    peer = Peer(fd, args)
+
+    # チャネル毎に異なるデータを送り、エコーを同じチャネルで受け取る
+    total = args.bytes
+    share = [total // CH_NUM + (1 if ch < total % CH_NUM else 0) for ch in range(CH_NUM)]
+    data = [bytes(((i * 7 + ch * 61 + (i >> 8)) & 0xFF) for i in range(share[ch])) for ch in range(CH_NUM)]
+    sent = [0] * CH_NUM
+    echoed = [bytearray() for _ in range(CH_NUM)]
+
+    def sink(ch, payload):
+        if ch < CH_NUM:
+            echoed[ch] += payload
+
+    start = time.monotonic()
+    last = start
+    sync_next = 0.0
+    ch = 0
+    while sum(len(e) for e in echoed) < total:
+        now = time.monotonic()
+        if not peer.up:
+            if now >= sync_next:
+                peer.reset()
+                peer.send(frame(TYPE_SYNC, 0, 0, 0))
+                sync_next = now + SYNC_PERIOD
+        else:
+            peer.poll_timeout(now)
+            # エコー待ちが多い間は送らない(相手の送信ウィンドウで流量が決まる)
+            in_flight = sum(sent) - sum(len(e) for e in echoed)
+            for _ in range(CH_NUM):
+                if not peer.window_free() or in_flight >= WINDOW * PAYLOAD_MAX:
+                    break
+                if sent[ch] < share[ch]:
+                    payload = data[ch][sent[ch]:sent[ch] + PAYLOAD_MAX]
+                    peer.write(ch, payload)
+                    sent[ch] += len(payload)
+                    in_flight += len(payload)
+                ch = (ch + 1) % CH_NUM
+        rd, _, _ = select.select([fd], [], [], 0.002)
+        if rd:
+            peer.receive(os.read(fd, 4096), sink)
+            last = time.monotonic()
+            if peer.up and peer.ack_pending:
+                peer.send(frame(TYPE_ACK, 0, peer.tx_next, peer.rx_expect))
+                peer.ack_pending = False
+        if not peer.up and any(sent):
+            # 同期し直した: 相手に届いていないデータから送り直す
+            sent = [len(e) for e in echoed]
+        if time.monotonic() - last > TIMEOUT:
+            break
+    elapsed = time.monotonic() - start
+    os.close(fd)
+
+    st = peer.stats
+    print("peer: retx=%d timeout=%d crc=%d seq=%d sync=%d drop=%d corrupt=%d"
+          % (st["retx"], st["timeout"], st["crc"], st["seq"], st["sync"], st["drop"], st["corrupt"]))
+    for ch in range(CH_NUM):
+        if bytes(echoed[ch]) != data[ch]:
+            diff = next((i for i, (a, b) in enumerate(zip(echoed[ch], data[ch])) if a != b),
+                        min(len(echoed[ch]), share[ch]))
+            print("NG: ch%d received %d/%d bytes, first mismatch at %d" % (ch, len(echoed[ch]), share[ch], diff))
+            return 1
+    print("OK: %d bytes echoed on %d channels in %.2f s (%.1f KB/s each way)"
+          % (total, CH_NUM, elapsed, total / elapsed / 1024))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,12 @@
+#
+# 浮動小数点ABI設定スクリプト
+#   build_flags はコンパイル時にしか反映されないため、
+#   アセンブル/リンク時にも同じ -mfloat-abi/-mfpu を指定する。
+#
+Import("env")
+
+FLOAT_FLAGS = ["-mfloat-abi=hard", "-mfpu=fpv4-sp-d16"]
+
+for var in ("ASFLAGS", "ASPPFLAGS", "LINKFLAGS"):
+    flags = [f for f in env.get(var, []) if not str(f).startswith(("-mfloat-abi", "-mfpu"))]
+    env.Replace(**{var: flags + FLOAT_FLAGS})
@@ -13,6 +13,12 @@
 
 /* Exported types ------------------------------------------------------------*/
 
+/* GPIO設定(GpioBatchで使用) */
+#define GPIO_PORT_NUM		(10)	/* ポート数(PORT0～PORT9)				*/
+
+/* クロック動作モード数(ClockStatisticsで使用) */
+#define CLOCK_MODE_NUM		(3)		/* CLOCK_MODE_HIGH～CLOCK_MODE_LOW		*/
+
 /* キュー制御情報 */
 typedef struct _QueueControl {
 	uint16_t u16_head;				/* 先頭データのインデックス				*/
@@ -20,12 +26,428 @@ typedef struct _QueueControl {
 	uint16_t u16_count;				/* データの登録数						*/
 } QueueControl;
 
+/* ADCブロック完了コールバック(割り込みから呼ばれる) */
+/* pu16_Block は [チャネル][ADC_BLOCK_SCANS] の配置 */
+typedef void (*AdcBlockCallback)(uint8_t u8_Half, const uint16_t *pu16_Block, uint8_t u8_ChCount);
+
+/* UARTパケット受信コールバック(割り込みから呼ばれる) */
+/* pu8_Data は次のパケットが完了するまで有効 */
+typedef void (*UartPacketCallback)(const uint8_t *pu8_Data, uint16_t u16_Size, uint32_t u32_TimeUs);
+
+/* UARTパケット受信統計情報 */
+typedef struct _UartPacketStatistics {
+	uint32_t u32_packets;			/* 受信パケット数						*/
+	uint32_t u32_bytes;				/* 受信データ数							*/
+	uint32_t u32_rx_irqs;			/* SCI1_RXIのCPU割り込み数				*/
+	uint32_t u32_idle_irqs;			/* アイドル検出の割り込み数				*/
+	uint32_t u32_splits;			/* バッファが一杯で区切ったパケット数	*/
+} UartPacketStatistics;
+
+/* ADC統計情報 */
+typedef struct _AdcStatistics {
+	uint32_t u32_sample_rate;		/* 実サンプリング周波数[Hz]				*/
+	uint16_t u16_cpu_load;			/* 割り込み処理のCPU負荷[0.1%]			*/
+	uint32_t u32_blocks;			/* 完了ブロック数						*/
+	uint32_t u32_overruns;			/* 送信前に上書きされたブロック数		*/
+	uint32_t u32_missed;			/* DTC再設定中に取りこぼしたスキャン数	*/
+} AdcStatistics;
+
+/* GPIO一括更新情報 */
+typedef struct _GpioBatch {
+	uint16_t u16_dirty;							/* 更新するポート(bitn:PORTn)	*/
+	uint16_t u16_set[GPIO_PORT_NUM];			/* High出力する端子				*/
+	uint16_t u16_clear[GPIO_PORT_NUM];			/* Low出力する端子				*/
+} GpioBatch;
+
+/* 外部端子割り込み設定 */
+typedef struct _ExtiConfig {
+	uint8_t u8_port;				/* 端子のポート番号						*/
+	uint8_t u8_pin;					/* 端子番号								*/
+	uint8_t u8_edge;				/* 検出エッジ(EXTI_EDGE_xxx)			*/
+	uint8_t u8_filter;				/* デジタルフィルタ(EXTI_FILTER_xxx)	*/
+	bool bl_pullup;					/* 入力プルアップ						*/
+	uint32_t u32_debounce_us;		/* デバウンス時間[us](0:無し)			*/
+} ExtiConfig;
+
+/* 外部端子割り込みイベント */
+typedef struct _ExtiEvent {
+	uint32_t u32_time_us;			/* エッジの時刻[us]						*/
+	uint8_t u8_channel;				/* チャネル(IRQ0～IRQ15)				*/
+	uint8_t u8_level;				/* エッジ後の端子レベル					*/
+} ExtiEvent;
+
+/* 外部端子割り込み計測結果 */
+typedef struct _ExtiMeasure {
+	uint32_t u32_period_us;			/* 周期[us]								*/
+	uint32_t u32_high_us;			/* High幅[us](両エッジ検出時)			*/
+	uint32_t u32_low_us;			/* Low幅[us](両エッジ検出時)			*/
+	uint32_t u32_freq_mhz;			/* 周波数[mHz]							*/
+	uint32_t u32_edges;				/* 受け付けたエッジ数					*/
+	uint32_t u32_bounces;			/* デバウンスで捨てたエッジ数			*/
+} ExtiMeasure;
+
+/* リセット要因情報 */
+typedef struct _WdtResetInfo {
+	uint8_t u8_cause;				/* リセット要因(WDT_RESET_xxx)			*/
+	uint32_t u32_stalled;			/* 停止したタスク(TASK_ID_xxxのビット)	*/
+	uint32_t u32_boot_count;		/* 電源投入後のリセット回数				*/
+	uint32_t u32_timeout_ms;		/* WDTタイムアウト時間(現在の動作モード)[ms]	*/
+} WdtResetInfo;
+
+/* キー・バリューストア統計情報 */
+typedef struct _KvsStatistics {
+	uint32_t u32_records;			/* 書き込んだレコード数					*/
+	uint32_t u32_coalesced;			/* 書き込み前にまとめた更新数			*/
+	uint32_t u32_erases;			/* ブロック消去回数						*/
+	uint32_t u32_compactions;		/* 追記し直し回数						*/
+	uint32_t u32_torn;				/* 起動時に読み飛ばした不正レコード数	*/
+	uint32_t u32_errors;			/* 書き込み/消去エラー数				*/
+	uint32_t u32_max_step_us;		/* 1周期の最大処理時間[us]				*/
+	uint8_t u8_used_blocks;			/* 使用中のブロック数					*/
+	uint8_t u8_free_blocks;			/* 空きブロック数						*/
+} KvsStatistics;
+
+/* スタック使用量 */
+typedef struct _StackUsage {
+	uint32_t u32_size;				/* サイズ[byte]							*/
+	uint32_t u32_peak;				/* 最大使用量[byte]						*/
+} StackUsage;
+
+/* スタックオーバーフロー診断情報 */
+typedef struct _StackOverflowInfo {
+	uint8_t u8_monitor;				/* 検出したスタック(STACK_CTX_xxxのビット)	*/
+	uint32_t u32_msp;				/* 検出時のMSP							*/
+	uint32_t u32_psp;				/* 検出時のPSP							*/
+} StackOverflowInfo;
+
+/* USB統計情報 */
+typedef struct _UsbStatistics {
+	uint32_t u32_rx_bytes;			/* 受信データ数							*/
+	uint32_t u32_tx_bytes;			/* 送信データ数							*/
+	uint32_t u32_rx_packets;		/* 受信パケット数						*/
+	uint32_t u32_tx_packets;		/* 送信パケット数						*/
+	uint32_t u32_rx_paused;			/* 受信Queueが一杯で受信を保留した回数	*/
+	uint32_t u32_resets;			/* バスリセット回数						*/
+	uint32_t u32_setups;			/* セットアップ受信数					*/
+	uint32_t u32_stalls;			/* 未対応リクエスト(STALL応答)数		*/
+} UsbStatistics;
+
+/* クロック変更コールバック(u8_Event: CLOCK_EVENT_xxx, u8_Mode: 切り替え先) */
+/* CLOCK_EVENT_PREでNGを返すと切り替えを中止する */
+typedef uint8_t (*ClockCallback)(uint8_t u8_Event, uint8_t u8_Mode);
+
+/* クロック統計情報 */
+typedef struct _ClockStatistics {
+	uint8_t u8_mode;				/* 現在の動作モード(CLOCK_MODE_xxx)		*/
+	bool bl_auto;					/* 負荷による自動切り替え中				*/
+	uint16_t u16_load;				/* 周期処理の負荷[0.1%]					*/
+	uint32_t u32_transitions;		/* 切り替え回数							*/
+	uint32_t u32_vetoes;			/* 拒否された切り替え回数				*/
+	uint32_t u32_last_ns;			/* 最後の切り替え時間[ns]				*/
+	uint32_t u32_max_ns;			/* 最大の切り替え時間[ns]				*/
+	uint32_t u32_residency_ms[CLOCK_MODE_NUM];	/* 動作モード毎の滞在時間[ms]	*/
+	uint16_t u16_energy;			/* 消費電荷の目安(常に高速モード比)[0.1%]	*/
+} ClockStatistics;
+
+/* IIC転送完了コールバック(周期処理から呼ばれる) */
+/* u8_Result: IIC_RESULT_xxx, u32_TimeUs: 開始からストップ条件までの時間[us] */
+struct _IicTransfer;
+typedef void (*IicCallback)(const struct _IicTransfer *pst_Xfer, uint8_t u8_Result, uint32_t u32_TimeUs);
+
+/* IIC転送要求(送信→再スタート→受信の順に行う。片方は0でよい) */
+typedef struct _IicTransfer {
+	uint8_t u8_addr;				/* スレーブアドレス(7bit)				*/
+	const uint8_t *pu8_tx;			/* 送信データ							*/
+	uint16_t u16_tx_size;			/* 送信データ数							*/
+	uint8_t *pu8_rx;				/* 受信データの格納先					*/
+	uint16_t u16_rx_size;			/* 受信データ数							*/
+	IicCallback pf_callback;		/* 完了コールバック(NULL:通知なし)		*/
+	void *pv_context;				/* 呼び出し元の任意の情報				*/
+} IicTransfer;
+
+/* IIC統計情報 */
+typedef struct _IicStatistics {
+	uint32_t u32_transfers;			/* 正常終了した転送数					*/
+	uint32_t u32_nacks;				/* NACKで終了した転送数					*/
+	uint32_t u32_timeouts;			/* タイムアウトした転送数				*/
+	uint32_t u32_bus_errors;		/* バスエラー(アービトレーションロスト)数	*/
+	uint32_t u32_recoveries;		/* SCL追加出力でバスを復旧した回数		*/
+	uint32_t u32_irqs;				/* 割り込み回数							*/
+	uint32_t u32_dtc_bytes;			/* DTCで転送したデータ数				*/
+	uint32_t u32_last_us;			/* 最後の転送時間[us]					*/
+	uint32_t u32_avg_us;			/* 正常終了した転送の平均時間[us]		*/
+	uint32_t u32_max_us;			/* 最大の転送時間[us]					*/
+	uint32_t u32_bitrate;			/* 設定した転送速度[bps]				*/
+	uint8_t u8_queue_peak;			/* 転送要求Queueの最大登録数			*/
+} IicStatistics;
+
+/* SPIデバイス設定(チップセレクトはGPIOでLowアクティブ) */
+typedef struct _SpiDevice {
+	uint8_t u8_cs_port;				/* チップセレクトのポート番号			*/
+	uint16_t u16_cs_mask;			/* チップセレクトの端子のマスク			*/
+	uint8_t u8_mode;				/* SPIモード(SPI_MODE_x)				*/
+	uint8_t u8_options;				/* オプション(SPI_OPT_xxx)				*/
+	uint32_t u32_bitrate;			/* 転送速度の上限[bps]					*/
+} SpiDevice;
+
+/* SPI転送完了コールバック(周期処理から呼ばれる) */
+/* u8_Result: SPI_RESULT_xxx, u32_TimeUs: チップセレクト選択から完了までの時間[us] */
+struct _SpiTransfer;
+typedef void (*SpiCallback)(const struct _SpiTransfer *pst_Xfer, uint8_t u8_Result, uint32_t u32_TimeUs);
+
+/* SPI転送要求(pv_rx=NULLは送信のみ,pv_tx=NULLはダミーデータを送信する) */
+typedef struct _SpiTransfer {
+	const SpiDevice *pst_dev;		/* 転送先のデバイス						*/
+	uint8_t u8_bits;				/* フレーム長(8/16/32)					*/
+	const void *pv_tx;				/* 送信データ(フレーム長の配列)			*/
+	void *pv_rx;					/* 受信データの格納先(フレーム長の配列)	*/
+	uint16_t u16_frames;			/* フレーム数							*/
+	bool bl_keep_cs;				/* 完了後もチップセレクトを保持する		*/
+	SpiCallback pf_callback;		/* 完了コールバック(NULL:通知なし)		*/
+	void *pv_context;				/* 呼び出し元の任意の情報				*/
+} SpiTransfer;
+
+/* SPI統計情報 */
+typedef struct _SpiStatistics {
+	uint32_t u32_transfers;			/* 正常終了した転送数					*/
+	uint32_t u32_errors;			/* オーバーラン/モードフォルトの転送数	*/
+	uint32_t u32_timeouts;			/* タイムアウトした転送数				*/
+	uint32_t u32_irqs;				/* 割り込み回数							*/
+	uint32_t u32_dtc_frames;		/* DTCで転送したフレーム数				*/
+	uint32_t u32_bytes;				/* 正常終了した転送のデータ数[byte]		*/
+	uint32_t u32_cpu_cycles;		/* 開始処理と割り込みのCPUクロック数	*/
+	uint32_t u32_last_us;			/* 最後の転送時間[us]					*/
+	uint32_t u32_max_us;			/* 最大の転送時間[us]					*/
+	uint32_t u32_bitrate;			/* 最後に設定した転送速度[bps]			*/
+	uint8_t u8_queue_peak;			/* 転送要求Queueの最大登録数			*/
+} SpiStatistics;
+
+/* CANフレーム */
+typedef struct _CanFrame {
+	uint32_t u32_id;				/* ID(拡張IDはCAN_ID_EXTを付ける)		*/
+	uint8_t u8_dlc;					/* データ長(0～8)						*/
+	uint8_t u8_flags;				/* CAN_FLAG_xxx							*/
+	uint16_t u16_timestamp;			/* 受信時のタイムスタンプ				*/
+	uint8_t u8_data[8];				/* データ								*/
+} CanFrame;
+
+/* CAN受信フィルター(u32_maskが1のbitを比較する,IDの種類は常に比較する) */
+typedef struct _CanFilter {
+	uint32_t u32_id;				/* ID(拡張IDはCAN_ID_EXTを付ける)		*/
+	uint32_t u32_mask;				/* 比較するbit(0:全て受信)				*/
+} CanFilter;
+
+/* CAN設定 */
+typedef struct _CanConfig {
+	uint32_t u32_bitrate;			/* 通信速度[bps]						*/
+	uint8_t u8_mode;				/* 動作モード(CAN_MODE_xxx)				*/
+	uint8_t u8_filter_num;			/* フィルター数(0:全て受信)				*/
+	const CanFilter *pst_filters;	/* フィルター(0,1:受信FIFO, 2～:メールボックス)	*/
+} CanConfig;
+
+/* CAN状態と統計情報 */
+typedef struct _CanStatus {
+	uint8_t u8_state;				/* 状態(CAN_STATE_xxx)					*/
+	uint8_t u8_tec;					/* 送信エラーカウンター					*/
+	uint8_t u8_rec;					/* 受信エラーカウンター					*/
+	uint8_t u8_error_code;			/* 検出したエラーの種類(ECSRの累積)		*/
+	uint32_t u32_bitrate;			/* 設定した通信速度[bps]				*/
+	uint32_t u32_tx_frames;			/* 送信完了したフレーム数				*/
+	uint32_t u32_rx_frames;			/* 受信したフレーム数					*/
+	uint32_t u32_rx_dropped;		/* 受信リングが一杯で捨てたフレーム数	*/
+	uint32_t u32_rx_lost;			/* 受信FIFO/メールボックスのメッセージロスト数	*/
+	uint32_t u32_bus_errors;		/* バスエラー検出数						*/
+	uint32_t u32_passives;			/* エラーパッシブになった回数			*/
+	uint32_t u32_busoffs;			/* バスオフになった回数					*/
+	uint32_t u32_recoveries;		/* バスオフから復帰した回数				*/
+	uint32_t u32_irqs;				/* 割り込み回数							*/
+	uint8_t u8_rx_peak;				/* 受信リングの最大使用数				*/
+	uint8_t u8_tx_pending;			/* 送信待ちのフレーム数					*/
+} CanStatus;
+
+/* 割り込み遅延の計測結果(遅延はCPUクロックのサイクル数) */
+typedef struct _LatResult {
+	const char *pc_name;			/* 表示名(対象の割り込み)				*/
+	uint32_t u32_period;			/* プローブの周期[サイクル]				*/
+	uint32_t u32_count;				/* 計測回数								*/
+	uint32_t u32_missed;			/* 周期を超えて欠落した回数				*/
+	uint32_t u32_min;				/* 最小遅延								*/
+	uint32_t u32_p50;				/* 50パーセンタイル(区間の上限)			*/
+	uint32_t u32_p99;				/* 99パーセンタイル(区間の上限)			*/
+	uint32_t u32_max;				/* 最大遅延								*/
+} LatResult;
+
+/* ESP32-S3リンクの受信コールバック(周期処理から呼ばれる) */
+/* falseを返すとフレームを受け取らず、相手の再送を待つ(受け取り側の流量制御) */
+typedef bool (*EspRxCallback)(uint8_t u8_Ch, const uint8_t *pu8_Data, uint16_t u16_Size);
+
+/* ESP32-S3リンク統計情報 */
+typedef struct _EspStatistics {
+	uint8_t u8_link;				/* リンク状態(ESP_LINK_xxx)	*/
+	uint32_t u32_bitrate;			/* 設定した通信速度[bps]	*/
+	uint32_t u32_tx_frames;			/* 送信したデータフレーム数(再送を除く)	*/
+	uint32_t u32_rx_frames;			/* 受け取ったデータフレーム数	*/
+	uint32_t u32_tx_bytes;			/* 送信したデータ数(再送を除く)	*/
+	uint32_t u32_rx_bytes;			/* 受け取ったデータ数	*/
+	uint32_t u32_retransmits;		/* 再送したフレーム数	*/
+	uint32_t u32_timeouts;			/* 応答待ちのタイムアウト回数	*/
+	uint32_t u32_crc_errors;		/* CRC異常で捨てたフレーム数	*/
+	uint32_t u32_frame_errors;		/* 長さ/種別の異常で捨てたフレーム数	*/
+	uint32_t u32_seq_errors;		/* 順序外で捨てたデータフレーム数	*/
+	uint32_t u32_rx_refused;		/* 受信コールバックが受け取らなかった数	*/
+	uint32_t u32_rx_overruns;		/* 受信リングの上書きで捨てた回数	*/
+	uint32_t u32_line_errors;		/* オーバーラン/フレーミングエラー数	*/
+	uint32_t u32_syncs;				/* 同期(リンクの初期化)回数	*/
+	uint32_t u32_tx_irqs;			/* 送信割り込み回数(フレーム毎)	*/
+	uint32_t u32_rx_irqs;			/* 受信割り込み回数(受信リング1周毎)	*/
+} EspStatistics;
+
+/* LEDマトリクス統計情報(サイクル数はCPUクロック) */
+typedef struct _MatrixStatistics {
+	uint32_t u32_frames;			/* 表示したフレーム数					*/
+	uint32_t u32_swaps;				/* 表示面を切り替えた回数				*/
+	uint32_t u32_busy;				/* 切り替え待ちで受け付けなかったmatrixSwap()の回数	*/
+	uint32_t u32_frame_cycles;		/* 1フレームの走査に要したサイクル(最新)	*/
+	uint32_t u32_frame_cycles_max;	/* 1フレームの走査に要したサイクル(最大)	*/
+	uint32_t u32_frame_us;			/* フレーム周期の実測値[us]				*/
+	uint16_t u16_cpu_load;			/* 走査のCPU負荷[0.1%]					*/
+} MatrixStatistics;
+
 /* Exported constants --------------------------------------------------------*/
 
+/* UARTパケット受信 */
+#define UART_PACKET_SIZE	(128)	/* パケットバッファサイズ[byte]			*/
+
+/* UARTダンプ表示(uartEchoDump) */
+#define UART_DUMP_BYTES		(16)	/* 1行のデータ数[byte]					*/
+#define UART_DUMP_LINE_MAX	(80)	/* 1行の最大文字数(改行を含む)			*/
+
+/* ADC設定 */
+#define ADC_CH_MAX			(6)		/* アナログ入力チャネル数(A0～A5)		*/
+#define ADC_BLOCK_SCANS		(64)	/* 1ブロック(半面)あたりのスキャン数	*/
+#define ADC_HALF_FIRST		(0)		/* 前半バッファ完了						*/
+#define ADC_HALF_SECOND		(1)		/* 後半バッファ完了						*/
+
+/* GPIOエッジ検出 */
+#define GPIO_EDGE_RISING	(0x01)	/* 立ち上がりエッジ						*/
+#define GPIO_EDGE_FALLING	(0x02)	/* 立ち下がりエッジ						*/
+#define GPIO_EDGE_BOTH		(0x03)	/* 両エッジ								*/
+
+/* 外部端子割り込み */
+#define EXTI_CH_NUM			(16)	/* チャネル数(IRQ0～IRQ15)				*/
+#define EXTI_EDGE_FALLING	(0)		/* 立ち下がりエッジ(IRQCR.IRQMD)		*/
+#define EXTI_EDGE_RISING	(1)		/* 立ち上がりエッジ						*/
+#define EXTI_EDGE_BOTH		(2)		/* 両エッジ								*/
+#define EXTI_FILTER_PCLKB_1	(0)		/* デジタルフィルタ PCLKB/1(IRQCR.FCLKSEL)	*/
+#define EXTI_FILTER_PCLKB_8	(1)		/* デジタルフィルタ PCLKB/8				*/
+#define EXTI_FILTER_PCLKB_32	(2)	/* デジタルフィルタ PCLKB/32			*/
+#define EXTI_FILTER_PCLKB_64	(3)	/* デジタルフィルタ PCLKB/64			*/
+#define EXTI_FILTER_OFF		(4)		/* デジタルフィルタ無し					*/
+
+/* リセット要因 */
+#define WDT_RESET_POWER_ON	(0)		/* パワーオンリセット					*/
+#define WDT_RESET_PIN		(1)		/* RES端子リセット等					*/
+#define WDT_RESET_SOFTWARE	(2)		/* ソフトウェアリセット(^R)				*/
+#define WDT_RESET_WATCHDOG	(3)		/* WDTリセット(タスク停止)				*/
+#define WDT_RESET_ERROR		(4)		/* WDTリセット(Error_Handler)			*/
+#define WDT_RESET_STACK		(5)		/* スタックオーバーフロー(SPMON NMI)	*/
+#define WDT_RESET_NUM		(6)
+
+/* キー・バリューストア */
+#define KVS_KEY_MAX			(32)	/* キー数(キー:0～KVS_KEY_MAX-1)		*/
+#define KVS_VALUE_MAX		(32)	/* 値の最大長[byte]						*/
+
+/* スタック監視のコンテキスト */
+#define STACK_CTX_MAIN		(0)		/* 周期処理(メインスタック,PSP)			*/
+#define STACK_CTX_ISR		(1)		/* 割り込み(割り込みスタック,MSP)		*/
+#define STACK_CTX_NUM		(2)
+
+/* USB(CDC-ACM) */
+#define USB_QUEUE_SIZE		(1024)	/* 送信/受信Queueサイズ[byte]			*/
+
+/* クロック動作モード */
+#define CLOCK_MODE_HIGH		(0)		/* HOCO 48MHz(高速モード)				*/
+#define CLOCK_MODE_MIDDLE	(1)		/* HOCO/4 12MHz(中速モード)				*/
+#define CLOCK_MODE_LOW		(2)		/* MOCO 8MHz(中速モード)				*/
+#define CLOCK_MODE_AUTO		(0xFF)	/* 負荷で自動切り替え(clockSetMode)		*/
+#define CLOCK_EVENT_PRE		(0)		/* 切り替え前の確認(NGで中止)			*/
+#define CLOCK_EVENT_POST	(1)		/* 切り替え後の通知(割り込み禁止中)		*/
+#define CLOCK_EVENT_ABORT	(2)		/* 確認後の中止							*/
+#define CLOCK_CALLBACK_MAX	(12)	/* 登録できるコールバック数(登録ドライバー数以上)	*/
+
+/* IIC */
+#define IIC_QUEUE_SIZE		(8)		/* 転送要求Queueサイズ					*/
+#define IIC_RESULT_OK		(0)		/* 正常終了								*/
+#define IIC_RESULT_NACK_ADDR	(1)	/* アドレスにNACK(スレーブ無し/ビジー)	*/
+#define IIC_RESULT_NACK_DATA	(2)	/* データにNACK							*/
+#define IIC_RESULT_TIMEOUT	(3)		/* タイムアウト(クロックストレッチ等)	*/
+#define IIC_RESULT_BUS_ERROR	(4)	/* バスエラー(アービトレーションロスト)	*/
+
+/* SPI */
+#define SPI_QUEUE_SIZE		(8)		/* 転送要求Queueサイズ					*/
+#define SPI_MODE_0			(0)		/* CPOL=0,CPHA=0						*/
+#define SPI_MODE_1			(1)		/* CPOL=0,CPHA=1						*/
+#define SPI_MODE_2			(2)		/* CPOL=1,CPHA=0						*/
+#define SPI_MODE_3			(3)		/* CPOL=1,CPHA=1						*/
+#define SPI_OPT_LSB_FIRST	(0x01)	/* LSBファースト						*/
+#define SPI_OPT_LOOPBACK	(0x02)	/* 内部ループバック(MOSI→MISO,試験用)	*/
+#define SPI_DUMMY_DATA		(0xFFFFFFFFUL)	/* 受信のみの転送で送信するデータ	*/
+#define SPI_RESULT_OK		(0)		/* 正常終了								*/
+#define SPI_RESULT_ERROR	(1)		/* オーバーラン/モードフォルト			*/
+#define SPI_RESULT_TIMEOUT	(2)		/* タイムアウト							*/
+
+/* CAN */
+#define CAN_ID_EXT			(0x80000000UL)	/* 拡張ID(29bit)				*/
+#define CAN_ID_STD_MASK		(0x000007FFUL)	/* 標準IDの全bit				*/
+#define CAN_ID_EXT_MASK		(0x1FFFFFFFUL)	/* 拡張IDの全bit				*/
+#define CAN_FLAG_RTR		(0x01)	/* リモートフレーム						*/
+#define CAN_MODE_NORMAL		(0)		/* 通常動作								*/
+#define CAN_MODE_LISTEN		(1)		/* リッスンオンリー(ACK/送信なし)		*/
+#define CAN_MODE_LOOPBACK	(2)		/* 内部ループバック(トランシーバー不要)	*/
+#define CAN_STATE_STOPPED	(0)		/* 停止中								*/
+#define CAN_STATE_ACTIVE	(1)		/* エラーアクティブ						*/
+#define CAN_STATE_WARNING	(2)		/* エラーワーニング(カウンター96以上)	*/
+#define CAN_STATE_PASSIVE	(3)		/* エラーパッシブ						*/
+#define CAN_STATE_BUSOFF	(4)		/* バスオフ								*/
+#define CAN_FILTER_MAX		(8)		/* フィルター数(受信FIFO 2+メールボックス 6)	*/
+#define CAN_RX_RING_SIZE	(32)	/* 受信リングサイズ(2のべき乗)			*/
+#define CAN_TX_RING_SIZE	(16)	/* 送信リングサイズ(2のべき乗)			*/
+
+/* 割り込み遅延計測 */
+#define LAT_PROBE_SCI1_RXI	(0)		/* SCI1_RXIと同じ優先度のプローブ(GPT6)	*/
+#define LAT_PROBE_PORT_IRQ	(1)		/* PORT_IRQnと同じ優先度のプローブ(GPT7)	*/
+#define LAT_PROBE_NUM		(2)
+#define LAT_HIST_BUCKETS	(64)	/* ヒストグラムの区間数(131071サイクルまで)	*/
+
+/* ESP32-S3リンク */
+#define ESP_CH_NUM			(4)		/* 論理チャネル数						*/
+#define ESP_PAYLOAD_MAX		(192)	/* 1フレームのデータ長[byte](最大)		*/
+#define ESP_WINDOW			(4)		/* 応答を待たずに送るフレーム数(2のべき乗)	*/
+#define ESP_RX_RING_SIZE	(1024)	/* 受信リングサイズ[byte](2のべき乗,相手のウィンドウ分以上)	*/
+#define ESP_LINK_CLOSED		(0)		/* 停止中								*/
+#define ESP_LINK_SYNC		(1)		/* 同期中(相手の応答待ち)				*/
+#define ESP_LINK_UP			(2)		/* 通信中								*/
+
+/* LEDマトリクス(UNO R4 WiFi) */
+#define MATRIX_ROWS			(8)		/* 行数									*/
+#define MATRIX_COLS			(12)	/* 列数									*/
+#define MATRIX_LEVELS		(16)	/* 表示できる輝度の段階(0～255を変換する)	*/
+#define MATRIX_FRAME_HZ		(120)	/* フレーム周波数[Hz]					*/
+
 /* Exported macro ------------------------------------------------------------*/
 
 /* Exported functions prototypes ---------------------------------------------*/
 
+/* drv_clock.c */
+extern void taskClockDriverInit(void);										/* クロック管理ドライバー初期化処理		*/
+extern void taskClockDriverInput(void);										/* クロック管理ドライバー入力処理		*/
+extern void taskClockDriverOutput(void);									/* クロック管理ドライバー出力処理		*/
+extern uint8_t clockRegisterCallback(ClockCallback pf_Callback);			/* クロック変更の通知先を登録する		*/
+extern uint8_t clockSetMode(uint8_t u8_Mode);								/* 動作モードを指定する					*/
+extern uint8_t clockGetMode(void);											/* 現在の動作モードを取得する			*/
+extern uint32_t clockGetSwitchCycle(void);									/* 切り替え時点のサイクル数を取得する	*/
+extern void clockGetStatistics(ClockStatistics *pst_Stat);					/* 統計情報を取得する					*/
+
 /* drv_uart.c */
 extern void taskUartDriverInit(void);										/* UARTドライバー初期化処理				*/
 extern void taskUartDriverInput(void);										/* UARTドライバー入力処理				*/
@@ -33,10 +455,143 @@ extern void taskUartDriverOutput(void);										/* UARTドライバー出力処
 extern uint16_t uartSetTxData(const uint8_t *pu8_Data, uint16_t u16_Size);	/* UART送信データを登録する				*/
 extern uint16_t uartGetRxData(uint8_t *pu8_Data, uint16_t u16_Size);		/* UART受信データを取得する				*/
 extern uint16_t uartGetRxCount(void);										/* UART受信データの数を取得する			*/
+extern uint16_t uartGetTxCount(void);										/* UART送信データの数を取得する			*/
+extern uint16_t uartGetTxFree(void);										/* UART送信Queueの空き数を取得する		*/
+extern uint8_t uartPacketStart(UartPacketCallback pf_Callback, uint8_t u8_IdleChars);	/* パケット受信モードを開始する	*/
+extern void uartPacketStop(void);											/* パケット受信モードを停止する			*/
+extern void uartGetPacketStatistics(UartPacketStatistics *pst_Stat);		/* パケット受信統計情報を取得する		*/
 extern void uartEchoHex8(uint8_t u8_Data);									/* Hex1Byte表示処理						*/
 extern void uartEchoHex16(uint16_t u16_Data);								/* Hex2Byte表示処理						*/
 extern void uartEchoHex32(uint32_t u32_Data);								/* Hex4Byte表示処理						*/
 extern void uartEchoStr(const char *ps8_Data);								/* 文字列表示処理						*/
 extern void uartEchoStrln(const char *ps8_Data);							/* 文字列表示処理(改行付き)				*/
+extern uint8_t uartEchoDump(const volatile void *pv_Addr, uint8_t u8_Size, uint8_t u8_Width);	/* ダンプ1行表示処理	*/
+
+/* drv_adc.c */
+extern void taskAdcDriverInit(void);										/* ADCドライバー初期化処理				*/
+extern void taskAdcDriverOutput(void);										/* ADCドライバー出力処理				*/
+extern uint8_t adcStart(uint8_t u8_ChMask, uint32_t u32_SampleRate);		/* ADC連続変換を開始する				*/
+extern void adcStop(void);													/* ADC連続変換を停止する				*/
+extern void adcSetCallback(AdcBlockCallback pf_Callback);					/* ブロック完了コールバックを登録する	*/
+extern void adcSetStreaming(bool bl_Enable);								/* ストリーミング送信を設定する			*/
+extern bool adcIsStreaming(void);											/* ストリーミング送信の動作状態を取得する	*/
+extern void adcGetStatistics(AdcStatistics *pst_Stat);						/* ADC統計情報を取得する				*/
+
+/* drv_gpio.c */
+extern void taskGpioDriverInit(void);										/* GPIOドライバー初期化処理				*/
+extern void taskGpioDriverInput(void);										/* GPIOドライバー入力処理				*/
+extern void gpioSetOutput(uint8_t u8_Port, uint16_t u16_Mask);				/* 端子を出力方向にする					*/
+extern void gpioSetInput(uint8_t u8_Port, uint16_t u16_Mask);				/* 端子を入力方向にする					*/
+extern void gpioSet(uint8_t u8_Port, uint16_t u16_Mask);					/* 端子をHigh出力する					*/
+extern void gpioClear(uint8_t u8_Port, uint16_t u16_Mask);					/* 端子をLow出力する					*/
+extern void gpioWrite(uint8_t u8_Port, uint16_t u16_SetMask, uint16_t u16_ClearMask);	/* High/Low出力を同時に行う	*/
+extern void gpioToggle(uint8_t u8_Port, uint16_t u16_Mask);					/* 端子の出力を反転する					*/
+extern uint16_t gpioRead(uint8_t u8_Port);									/* 端子の入力レベルを取得する			*/
+extern void gpioBatchInit(GpioBatch *pst_Batch);							/* 一括更新情報を初期化する				*/
+extern void gpioBatchSet(GpioBatch *pst_Batch, uint8_t u8_Port, uint16_t u16_Mask);		/* 一括更新にHigh出力を登録する	*/
+extern void gpioBatchClear(GpioBatch *pst_Batch, uint8_t u8_Port, uint16_t u16_Mask);	/* 一括更新にLow出力を登録する	*/
+extern void gpioBatchApply(const GpioBatch *pst_Batch);						/* 一括更新を出力する					*/
+extern void gpioEdgeWatch(uint8_t u8_Port, uint16_t u16_Mask);				/* エッジ検出対象の端子を設定する		*/
+extern uint16_t gpioGetEdge(uint8_t u8_Port, uint16_t u16_Mask, uint8_t u8_Edge);	/* 検出したエッジを取得する		*/
+
+/* drv_exti.c */
+extern void taskExtiDriverInit(void);										/* 外部端子割り込みドライバー初期化処理	*/
+extern void taskExtiDriverInput(void);										/* 外部端子割り込みドライバー入力処理	*/
+extern uint8_t extiOpen(uint8_t u8_Ch, const ExtiConfig *pst_Config);		/* 外部端子割り込みを開始する			*/
+extern void extiClose(uint8_t u8_Ch);										/* 外部端子割り込みを停止する			*/
+extern bool extiGetEvent(ExtiEvent *pst_Event);								/* デバウンス後のエッジイベントを取得する	*/
+extern uint8_t extiGetMeasure(uint8_t u8_Ch, ExtiMeasure *pst_Measure);		/* パルス幅/周期の計測結果を取得する	*/
+extern uint32_t extiGetOverflowCount(void);									/* FIFOあふれで捨てたイベント数を取得する	*/
+extern uint32_t extiGetTimeUs(void);										/* 現在時刻[us]を取得する				*/
+
+/* drv_wdt.c */
+extern void taskWdtDriverInit(void);										/* ウォッチドッグドライバー初期化処理	*/
+extern void taskWdtDriverOutput(void);										/* ウォッチドッグドライバー出力処理		*/
+extern void wdtCheckin(uint8_t u8_Task);									/* タスクの進行を報告する				*/
+extern void wdtSystemReset(void);											/* ソフトウェアリセットする				*/
+extern void wdtNotifyError(void);											/* エラー停止を記録する					*/
+extern void wdtGetResetInfo(WdtResetInfo *pst_Info);						/* 起動時に確定したリセット要因を取得する	*/
+extern void wdtStackOverflowReset(void);									/* スタックオーバーフローでリセットする	*/
+
+/* drv_kvs.c */
+extern void taskKvsDriverInit(void);										/* キー・バリューストア ドライバー初期化処理	*/
+extern void taskKvsDriverOutput(void);										/* キー・バリューストア ドライバー出力処理	*/
+extern uint8_t kvsSet(uint8_t u8_Key, const uint8_t *pu8_Data, uint8_t u8_Len);	/* 値を設定する				*/
+extern uint8_t kvsGet(uint8_t u8_Key, uint8_t *pu8_Data, uint8_t u8_Size);	/* 値を取得する							*/
+extern uint8_t kvsDelete(uint8_t u8_Key);									/* 値を削除する							*/
+extern void kvsFlush(void);													/* 未書き込みの値をすぐに書き込む		*/
+extern bool kvsIsBusy(void);												/* 書き込み/消去の実行状態を取得する	*/
+extern void kvsGetStatistics(KvsStatistics *pst_Stat);						/* 統計情報を取得する					*/
+
+/* drv_usb.c */
+extern void taskUsbDriverInit(void);										/* USBドライバー初期化処理				*/
+extern void taskUsbDriverInput(void);										/* USBドライバー入力処理				*/
+extern void taskUsbDriverOutput(void);										/* USBドライバー出力処理				*/
+extern uint16_t usbSetTxData(const uint8_t *pu8_Data, uint16_t u16_Size);	/* USB送信データを登録する				*/
+extern uint16_t usbGetRxData(uint8_t *pu8_Data, uint16_t u16_Size);		/* USB受信データを取得する				*/
+extern uint16_t usbGetRxCount(void);										/* USB受信データの数を取得する			*/
+extern uint16_t usbGetTxCount(void);										/* USB送信データの数を取得する			*/
+extern bool usbIsConnected(void);											/* ホストがポートを開いているかを取得する	*/
+extern void usbGetStatistics(UsbStatistics *pst_Stat);						/* USB統計情報を取得する				*/
+
+/* drv_stack.c */
+extern void taskStackDriverInit(void);										/* スタック監視ドライバー初期化処理		*/
+extern void taskStackDriverOutput(void);									/* スタック監視ドライバー出力処理		*/
+extern void stackStartMain(void (*pf_Main)(void)) __attribute__((noreturn));	/* メインスタック(PSP)に切り替えて実行する	*/
+extern uint8_t stackGetUsage(uint8_t u8_Ctx, StackUsage *pst_Usage);		/* スタック使用量を取得する				*/
+extern bool stackGetOverflowInfo(StackOverflowInfo *pst_Info);				/* スタックオーバーフロー診断情報を取得する	*/
+
+/* drv_iic.c */
+extern void taskIicDriverInit(void);										/* IICドライバー初期化処理				*/
+extern void taskIicDriverInput(void);										/* IICドライバー入力処理				*/
+extern uint8_t iicSubmit(const IicTransfer *pst_Xfer);						/* IIC転送を登録する					*/
+extern bool iicIsBusy(void);												/* 転送中または未完了の要求があるかを取得する	*/
+extern void iicGetStatistics(IicStatistics *pst_Stat);						/* IIC統計情報を取得する				*/
+
+/* drv_spi.c */
+extern void taskSpiDriverInit(void);										/* SPIドライバー初期化処理				*/
+extern void taskSpiDriverInput(void);										/* SPIドライバー入力処理				*/
+extern uint8_t spiSubmit(const SpiTransfer *pst_Xfer);						/* SPI転送を登録する					*/
+extern bool spiIsBusy(void);												/* 転送中または未完了の要求があるかを取得する	*/
+extern void spiGetStatistics(SpiStatistics *pst_Stat);						/* SPI統計情報を取得する				*/
+extern void spiReleasePins(void);											/* 端子を汎用入出力に戻す				*/
+
+/* drv_can.c */
+extern void taskCanDriverInit(void);										/* CANドライバー初期化処理				*/
+extern void taskCanDriverInput(void);										/* CANドライバー入力処理				*/
+extern uint8_t canStart(const CanConfig *pst_Config);						/* CAN通信を開始する					*/
+extern void canStop(void);													/* CAN通信を停止する					*/
+extern uint8_t canSend(const CanFrame *pst_Frame);							/* CANフレームを送信する				*/
+extern uint8_t canReceive(CanFrame *pst_Frame);								/* 受信したCANフレームを取り出す		*/
+extern uint8_t canRecover(void);											/* バスオフから強制復帰する				*/
+extern void canGetStatus(CanStatus *pst_Status);							/* CAN状態と統計情報を取得する			*/
+
+/* drv_lat.c */
+extern void taskLatDriverInit(void);										/* 割り込み遅延計測ドライバー初期化処理	*/
+extern uint8_t latStart(void);												/* 割り込み遅延の計測を開始する			*/
+extern void latStop(void);													/* 割り込み遅延の計測を停止する			*/
+extern bool latIsRunning(void);												/* 計測中かを取得する					*/
+extern void latClear(void);													/* 計測結果を消去する					*/
+extern uint8_t latGetResult(uint8_t u8_Probe, LatResult *pst_Result);		/* 計測結果を取得する					*/
+
+/* drv_esp.c */
+extern void taskEspDriverInit(void);											/* ESP32-S3リンクドライバー初期化処理	*/
+extern void taskEspDriverInput(void);											/* ESP32-S3リンクドライバー入力処理	*/
+extern void taskEspDriverOutput(void);											/* ESP32-S3リンクドライバー出力処理	*/
+extern uint8_t espOpen(void);													/* リンクを開始する	*/
+extern void espClose(void);														/* リンクを停止する	*/
+extern void espSetReceiver(uint8_t u8_Ch, EspRxCallback pf_Callback);			/* チャネルの受信コールバックを登録する	*/
+extern uint16_t espWrite(uint8_t u8_Ch, const uint8_t *pu8_Data, uint16_t u16_Size);	/* チャネルへ送信する	*/
+extern uint16_t espGetTxFree(uint8_t u8_Ch);									/* すぐに送信できるデータ数を取得する	*/
+extern bool espIsConnected(void);												/* 通信中かを取得する	*/
+extern void espGetStatistics(EspStatistics *pst_Stat);							/* ESP32-S3リンク統計情報を取得する	*/
+
+/* drv_matrix.c */
+extern void taskMatrixDriverInit(void);										/* LEDマトリクスドライバー初期化処理	*/
+extern uint8_t matrixOpen(void);												/* 表示を開始する	*/
+extern void matrixClose(void);												/* 表示を停止する	*/
+extern uint8_t *matrixGetBuffer(void);											/* 描画用のフレームバッファを取得する	*/
+extern uint8_t matrixSwap(void);												/* 描画した内容を次のフレームから表示する	*/
+extern void matrixGetStatistics(MatrixStatistics *pst_Stat);					/* LEDマトリクス統計情報を取得する	*/
 
 #endif /* __DRV_H */
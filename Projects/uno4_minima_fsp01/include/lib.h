@@ -19,10 +19,183 @@ typedef struct _Timer {
 	bool bl_state;					/* タイマー動作状態						*/
 } Timer;
 
+/* 固定小数点型 */
+typedef int16_t q15_t;				/* Q15(-1.0 ～ 1.0-2^-15)				*/
+typedef int32_t q31_t;				/* Q31(-1.0 ～ 1.0-2^-31)				*/
+
+/* FIRフィルター情報(q15) */
+typedef struct _DspFirQ15 {
+	const q15_t *pq15_coef;			/* 係数(時間反転順)						*/
+	q15_t *pq15_state;				/* 状態バッファ							*/
+	uint16_t u16_taps;				/* タップ数								*/
+	uint16_t u16_block_max;			/* 最大ブロック長						*/
+} DspFirQ15;
+
+/* FIRフィルター情報(q31) */
+typedef struct _DspFirQ31 {
+	const q31_t *pq31_coef;			/* 係数(時間反転順)						*/
+	q31_t *pq31_state;				/* 状態バッファ							*/
+	uint16_t u16_taps;				/* タップ数								*/
+	uint16_t u16_block_max;			/* 最大ブロック長						*/
+} DspFirQ31;
+
+/* FIRフィルター情報(float) */
+typedef struct _DspFirF32 {
+	const float *pf32_coef;			/* 係数(時間反転順)						*/
+	float *pf32_state;				/* 状態バッファ							*/
+	uint16_t u16_taps;				/* タップ数								*/
+	uint16_t u16_block_max;			/* 最大ブロック長						*/
+} DspFirF32;
+
+/* 移動平均情報(q15) */
+typedef struct _DspMovAvgQ15 {
+	q15_t *pq15_history;			/* 履歴バッファ							*/
+	uint16_t u16_length;			/* 平均長(2のべき乗)					*/
+	uint16_t u16_pos;				/* 次に書き込む履歴位置					*/
+	int32_t s32_sum;				/* 履歴の総和							*/
+	uint8_t u8_shift;				/* log2(平均長)							*/
+} DspMovAvgQ15;
+
+/* DSPベンチマーク結果 */
+typedef struct _DspBenchResult {
+	const char *ps8_name;			/* カーネル名							*/
+	uint32_t u32_cycles_x100;		/* 1サンプルあたりのサイクル数(×100)	*/
+	uint32_t u32_ref_cycles_x100;	/* C参照実装のサイクル数(×100, 無しは0)	*/
+} DspBenchResult;
+
+/* メモリプール統計情報 */
+typedef struct _PoolStatistics {
+	uint16_t u16_block_size;		/* ブロックサイズ[byte]						*/
+	uint16_t u16_block_num;			/* ブロック数								*/
+	uint16_t u16_used;				/* 使用中ブロック数							*/
+	uint16_t u16_high_water;		/* 最大使用ブロック数						*/
+	uint32_t u32_alloc_count;		/* 確保回数									*/
+	uint32_t u32_fail_count;		/* 確保失敗回数								*/
+} PoolStatistics;
+
+/* メモリプールベンチマーク結果 */
+typedef struct _PoolBenchResult {
+	uint32_t u32_pool_cycles;		/* poolAlloc/poolFree 平均サイクル数		*/
+	uint32_t u32_pool_max;			/* poolAlloc/poolFree 最大サイクル数		*/
+	uint32_t u32_malloc_cycles;		/* malloc/free 平均サイクル数				*/
+	uint32_t u32_malloc_max;		/* malloc/free 最大サイクル数				*/
+} PoolBenchResult;
+
+/* タスク監視設定(Supervisorで使用) */
+#define SUP_TASK_MAX			(32)		/* 監視できるタスク数(ビットマップの幅)	*/
+
+/* タスク監視情報 */
+typedef struct _Supervisor {
+	uint32_t u32_registered;		/* 登録済みタスク							*/
+	volatile uint32_t u32_checkin;	/* 今回の周期にチェックインしたタスク		*/
+	uint32_t u32_failed;			/* 停止と判定したタスク(保持)				*/
+	uint16_t u16_limit[SUP_TASK_MAX];	/* チェックインの無い周期の許容数		*/
+	uint16_t u16_count[SUP_TASK_MAX];	/* チェックインの無い周期の連続数		*/
+} Supervisor;
+
+/* コルーチン情報(再開位置と待ち条件) */
+typedef struct _Coro {
+	Timer st_timer;					/* 時間待ちのタイマー						*/
+	uint32_t u32_arg;				/* 待ち条件(時間[ms]/イベント), 再開後は成立したイベント	*/
+	uint16_t u16_line;				/* 再開位置(行番号, 0:先頭)					*/
+	uint8_t u8_wait;				/* 待ち種別(CORO_WAIT_xxx)					*/
+} Coro;
+
+/* コルーチン関数 */
+typedef void (*CoroFunc)(Coro *pst_Coro);
+
+/* コルーチン統計情報 */
+typedef struct _CoroStatistics {
+	uint8_t u8_active;				/* 動作中のコルーチン数						*/
+	uint8_t u8_high_water;			/* 最大動作数								*/
+	uint32_t u32_resume;			/* 再開回数									*/
+	uint32_t u32_check;				/* 待ち条件の確認回数						*/
+} CoroStatistics;
+
 /* Exported constants --------------------------------------------------------*/
 
+/* Biquadフィルター */
+#define DSP_BIQUAD_COEF_NUM		(6)		/* 1段あたりの係数の数(q15)			*/
+#define DSP_BIQUAD_STATE_NUM	(4)		/* 1段あたりの状態の数				*/
+
+/* DSPベンチマーク対象カーネル */
+#define DSP_BENCH_FIR_Q15		(0)
+#define DSP_BENCH_BIQUAD_Q15	(1)
+#define DSP_BENCH_MOVAVG_Q15	(2)
+#define DSP_BENCH_DECIM_Q15		(3)
+#define DSP_BENCH_RMS_Q15		(4)
+#define DSP_BENCH_PEAK_Q15		(5)
+#define DSP_BENCH_ADD_Q15		(6)
+#define DSP_BENCH_FIXED_NUM		(7)		/* 固定小数点カーネルの数(セルフテスト対象)	*/
+#define DSP_BENCH_FIR_F32		(7)
+#define DSP_BENCH_BIQUAD_F32	(8)
+#define DSP_BENCH_MAG_F32		(9)
+#define DSP_BENCH_KERNEL_NUM	(10)
+
+/* メモリプール設定(ブロックサイズは4の倍数で昇順,ビルドオプションで変更可) */
+#define POOL_CLASS_NUM			(3)			/* クラス数							*/
+#ifndef POOL_BLOCK_SIZE_0
+#define POOL_BLOCK_SIZE_0		(16)		/* クラス0 ブロックサイズ[byte]		*/
+#endif
+#ifndef POOL_BLOCK_NUM_0
+#define POOL_BLOCK_NUM_0		(32)		/* クラス0 ブロック数				*/
+#endif
+#ifndef POOL_BLOCK_SIZE_1
+#define POOL_BLOCK_SIZE_1		(64)		/* クラス1 ブロックサイズ[byte]		*/
+#endif
+#ifndef POOL_BLOCK_NUM_1
+#define POOL_BLOCK_NUM_1		(16)		/* クラス1 ブロック数				*/
+#endif
+#ifndef POOL_BLOCK_SIZE_2
+#define POOL_BLOCK_SIZE_2		(256)		/* クラス2 ブロックサイズ[byte]		*/
+#endif
+#ifndef POOL_BLOCK_NUM_2
+#define POOL_BLOCK_NUM_2		(4)			/* クラス2 ブロック数				*/
+#endif
+
+/* コルーチン設定(ビルドオプションで変更可) */
+#ifndef CORO_MAX
+#define CORO_MAX				(8)			/* 同時に動作できるコルーチン数		*/
+#endif
+#define CORO_ID_NONE			(0xFF)		/* 登録失敗							*/
+
+/* コルーチン待ち種別 */
+#define CORO_WAIT_YIELD			(0)			/* 次の周期で再開					*/
+#define CORO_WAIT_TIMER			(1)			/* 時間待ち							*/
+#define CORO_WAIT_UART_RX		(2)			/* UART受信待ち						*/
+#define CORO_WAIT_EVENT			(3)			/* イベント待ち						*/
+#define CORO_WAIT_END			(4)			/* 終了								*/
+
 /* Exported macro ------------------------------------------------------------*/
 
+/*
+ * スタックレス コルーチン(switch文と行番号による再開)
+ *
+ *   static void task(Coro *pst_Coro)
+ *   {
+ *       CORO_BEGIN(pst_Coro);
+ *       while (true) {
+ *           CORO_AWAIT_TIMER(pst_Coro, 1000);
+ *           ...
+ *       }
+ *       CORO_END(pst_Coro);
+ *   }
+ *
+ *   ・待ちを跨いでローカル変数は保持されない(static変数に置く)
+ *   ・再開位置は行番号で区別するため、1行に複数の待ちを書かない
+ *   ・待ちをswitch文の中に書かない(CORO_BEGINのswitchと区別できない)
+ *   ・UART受信待ちは受信データを取り出すまで毎周期再開する
+ */
+#define CORO_BEGIN(pst)				switch ((pst)->u16_line) { case 0:
+#define CORO_END(pst)				} (pst)->u8_wait = CORO_WAIT_END
+#define CORO_EXIT(pst)				do { (pst)->u8_wait = CORO_WAIT_END; return; } while (0)
+#define CORO_AWAIT_(pst, wait, arg)	do { coroWait((pst), (wait), (arg)); (pst)->u16_line = __LINE__; return; case __LINE__:; } while (0)
+#define CORO_YIELD(pst)				CORO_AWAIT_((pst), CORO_WAIT_YIELD, 0)				/* 次の周期まで待つ			*/
+#define CORO_AWAIT_TIMER(pst, ms)	CORO_AWAIT_((pst), CORO_WAIT_TIMER, (ms))			/* 時間[ms]の経過を待つ		*/
+#define CORO_AWAIT_UART_RX(pst)		CORO_AWAIT_((pst), CORO_WAIT_UART_RX, 0)			/* UART受信データを待つ		*/
+#define CORO_AWAIT_EVENT(pst, ev)	CORO_AWAIT_((pst), CORO_WAIT_EVENT, (ev))			/* イベント(いずれかのbit)を待つ	*/
+#define CORO_EVENTS(pst)			((pst)->u32_arg)								/* 成立したイベント			*/
+
 /* Exported functions prototypes ---------------------------------------------*/
 
 /* lib_timer.c */
@@ -44,4 +217,68 @@ extern int mem_cmp32(const uint32_t *s1, const uint32_t *s2, size_t n);		/* memc
 extern int mem_cmp16(const uint16_t *s1, const uint16_t *s2, size_t n);		/* memcmp(16bit版)						*/
 extern int mem_cmp08(const uint8_t *s1, const uint8_t *s2, size_t n);		/* memcmp(8bit版)						*/
 
+
+/* lib_dsp.c */
+extern void dspFirInitQ15(DspFirQ15 *pst_Fir, const q15_t *pq15_Coef, uint16_t u16_Taps, q15_t *pq15_State, uint16_t u16_BlockMax);	/* FIR初期化(q15)	*/
+extern void dspFirQ15(DspFirQ15 *pst_Fir, const q15_t *pq15_In, q15_t *pq15_Out, uint16_t u16_Size);				/* FIRフィルター(q15)			*/
+extern void dspFirQ15Ref(DspFirQ15 *pst_Fir, const q15_t *pq15_In, q15_t *pq15_Out, uint16_t u16_Size);			/* FIRフィルター(q15,参照)		*/
+extern void dspFirInitQ31(DspFirQ31 *pst_Fir, const q31_t *pq31_Coef, uint16_t u16_Taps, q31_t *pq31_State, uint16_t u16_BlockMax);	/* FIR初期化(q31)	*/
+extern void dspFirQ31(DspFirQ31 *pst_Fir, const q31_t *pq31_In, q31_t *pq31_Out, uint16_t u16_Size);				/* FIRフィルター(q31)			*/
+extern void dspBiquadQ15(const q15_t *pq15_Coef, q15_t *pq15_State, uint8_t u8_Stages, q15_t *pq15_Data, uint16_t u16_Size);		/* Biquad(q15)		*/
+extern void dspBiquadQ15Ref(const q15_t *pq15_Coef, q15_t *pq15_State, uint8_t u8_Stages, q15_t *pq15_Data, uint16_t u16_Size);	/* Biquad(q15,参照)	*/
+extern void dspBiquadQ31(const q31_t *pq31_Coef, q31_t *pq31_State, uint8_t u8_Stages, q31_t *pq31_Data, uint16_t u16_Size);		/* Biquad(q31)		*/
+extern void dspMovAvgInitQ15(DspMovAvgQ15 *pst_Avg, q15_t *pq15_History, uint8_t u8_Shift);						/* 移動平均初期化(q15)			*/
+extern void dspMovAvgQ15(DspMovAvgQ15 *pst_Avg, const q15_t *pq15_In, q15_t *pq15_Out, uint16_t u16_Size);		/* 移動平均(q15)				*/
+extern void dspMovAvgQ15Ref(DspMovAvgQ15 *pst_Avg, const q15_t *pq15_In, q15_t *pq15_Out, uint16_t u16_Size);	/* 移動平均(q15,参照)			*/
+extern void dspDecimateQ15(DspFirQ15 *pst_Fir, uint8_t u8_Factor, const q15_t *pq15_In, q15_t *pq15_Out, uint16_t u16_Size);		/* 間引き(q15)		*/
+extern void dspDecimateQ15Ref(DspFirQ15 *pst_Fir, uint8_t u8_Factor, const q15_t *pq15_In, q15_t *pq15_Out, uint16_t u16_Size);	/* 間引き(q15,参照)	*/
+extern q15_t dspRmsQ15(const q15_t *pq15_In, uint16_t u16_Size);													/* 実効値(q15)					*/
+extern q15_t dspRmsQ15Ref(const q15_t *pq15_In, uint16_t u16_Size);												/* 実効値(q15,参照)				*/
+extern q31_t dspRmsQ31(const q31_t *pq31_In, uint16_t u16_Size);													/* 実効値(q31)					*/
+extern q15_t dspPeakQ15(const q15_t *pq15_In, uint16_t u16_Size);													/* ピーク値(q15)				*/
+extern q15_t dspPeakQ15Ref(const q15_t *pq15_In, uint16_t u16_Size);												/* ピーク値(q15,参照)			*/
+extern q31_t dspPeakQ31(const q31_t *pq31_In, uint16_t u16_Size);													/* ピーク値(q31)				*/
+extern void dspAddQ15(const q15_t *pq15_In1, const q15_t *pq15_In2, q15_t *pq15_Out, uint16_t u16_Size);			/* 飽和加算(q15)				*/
+extern void dspAddQ15Ref(const q15_t *pq15_In1, const q15_t *pq15_In2, q15_t *pq15_Out, uint16_t u16_Size);		/* 飽和加算(q15,参照)			*/
+extern void dspFirInitF32(DspFirF32 *pst_Fir, const float *pf32_Coef, uint16_t u16_Taps, float *pf32_State, uint16_t u16_BlockMax);	/* FIR初期化(float)	*/
+extern void dspFirF32(DspFirF32 *pst_Fir, const float *pf32_In, float *pf32_Out, uint16_t u16_Size);				/* FIRフィルター(float)			*/
+extern void dspBiquadF32(const float *pf32_Coef, float *pf32_State, uint8_t u8_Stages, float *pf32_Data, uint16_t u16_Size);		/* Biquad(float)	*/
+extern void dspMagF32(const float *pf32_In, float *pf32_Out, uint16_t u16_Size);									/* 複素数の大きさ(float)		*/
+extern const char *dspGetFloatAbi(void);																			/* 浮動小数点ABI名を取得する	*/
+extern uint32_t dspSelfTest(void);																				/* セルフテスト					*/
+extern void dspBenchmark(DspBenchResult *pst_Result);																/* ベンチマーク					*/
+
+/* lib_pool.c */
+extern void poolInit(void);													/* メモリプール初期化処理			*/
+extern void *poolAlloc(uint32_t u32_Size);									/* メモリブロックを確保する			*/
+extern uint8_t poolFree(void *pv_Block);									/* メモリブロックを解放する			*/
+extern uint8_t poolGetStatistics(uint8_t u8_Class, PoolStatistics *pst_Stat);	/* 統計情報を取得する			*/
+extern uint32_t poolSelfTest(void);											/* セルフテスト						*/
+extern void poolBenchmark(PoolBenchResult *pst_Result);						/* ベンチマーク						*/
+
+/* lib_sup.c */
+extern void supInit(Supervisor *pst_Sup);									/* タスク監視を初期化する			*/
+extern uint8_t supRegister(Supervisor *pst_Sup, uint8_t u8_Task, uint16_t u16_MaxCycles);	/* 監視対象のタスクを登録する	*/
+extern void supCheckin(Supervisor *pst_Sup, uint8_t u8_Task);				/* タスクの進行を報告する			*/
+extern bool supEvaluate(Supervisor *pst_Sup);								/* 全タスクの進行を判定する			*/
+extern uint32_t supGetFailed(const Supervisor *pst_Sup);					/* 停止と判定したタスクを取得する	*/
+extern uint32_t supSelfTest(void);											/* セルフテスト						*/
+
+/* lib_coro.c */
+extern void coroInit(void);													/* コルーチン初期化処理				*/
+extern uint8_t coroStart(CoroFunc pf_Func);									/* コルーチンを開始する				*/
+extern void coroStop(uint8_t u8_Id);										/* コルーチンを停止する				*/
+extern bool coroIsRunning(uint8_t u8_Id);									/* コルーチンの動作状態を取得する	*/
+extern void coroSetEvent(uint32_t u32_Event);								/* イベントを通知する				*/
+extern void coroRun(void);													/* 待ち条件の成立したコルーチンを再開する	*/
+extern void coroWait(Coro *pst_Coro, uint8_t u8_Wait, uint32_t u32_Arg);	/* 待ち条件を設定する(CORO_AWAIT_xxx用)	*/
+extern void coroGetStatistics(CoroStatistics *pst_Stat);					/* 統計情報を取得する				*/
+
+/* lib_mon.c */
+extern void monInit(void);													/* モニター初期化処理				*/
+extern void monStart(void);													/* モニターを開始する				*/
+extern bool monIsActive(void);												/* モニターの動作状態を取得する		*/
+extern void monInput(const uint8_t *pu8_Data, uint16_t u16_Size);			/* 受信データを入力する				*/
+extern void monRun(void);													/* モニターの出力を進める			*/
+
 #endif /* __LIB_H */
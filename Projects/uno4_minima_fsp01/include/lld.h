@@ -13,8 +13,45 @@
 
 /* Exported types ------------------------------------------------------------*/
 
+/* DTC転送情報(メモリ上の配置はDTCのMRA/MRB,SAR,DAR,CRA/CRBと一致させる) */
+typedef struct _DtcTransferInfo {
+	volatile uint32_t u32_mode;		/* MRA[31:24], MRB[23:16]				*/
+	volatile const void *pv_src;	/* 転送元アドレス(SAR)					*/
+	volatile void *pv_dst;			/* 転送先アドレス(DAR)					*/
+	volatile uint16_t u16_crb;		/* ブロック転送回数(CRB)				*/
+	volatile uint16_t u16_cra;		/* 転送回数(CRA)						*/
+} DtcTransferInfo;
+
 /* Exported constants --------------------------------------------------------*/
 
+/* DTC転送モード(MRA) */
+#define DTC_MD_NORMAL		(0x0UL << 30)	/* ノーマル転送							*/
+#define DTC_MD_REPEAT		(0x1UL << 30)	/* リピート転送							*/
+#define DTC_MD_BLOCK		(0x2UL << 30)	/* ブロック転送							*/
+#define DTC_SZ_BYTE			(0x0UL << 28)	/* 8bit転送								*/
+#define DTC_SZ_HALF			(0x1UL << 28)	/* 16bit転送							*/
+#define DTC_SZ_WORD			(0x2UL << 28)	/* 32bit転送							*/
+#define DTC_SM_FIXED		(0x0UL << 26)	/* 転送元アドレス固定					*/
+#define DTC_SM_INC			(0x2UL << 26)	/* 転送元アドレス加算					*/
+/* DTC転送モード(MRB) */
+#define DTC_CHNE			(0x1UL << 23)	/* チェーン転送許可						*/
+#define DTC_CHNS			(0x1UL << 22)	/* カウンタ0時のみチェーン転送			*/
+#define DTC_DISEL			(0x1UL << 21)	/* 転送毎にCPU割り込み					*/
+#define DTC_DTS_SRC			(0x1UL << 20)	/* 転送元をリピート/ブロック領域とする	*/
+#define DTC_DM_FIXED		(0x0UL << 18)	/* 転送先アドレス固定					*/
+#define DTC_DM_INC			(0x2UL << 18)	/* 転送先アドレス加算					*/
+
+/* データフラッシュ */
+#define LL_FLASH_DATA_SIZE	(8192)			/* データフラッシュサイズ[byte]			*/
+#define LL_FLASH_BLOCK_SIZE	(1024)			/* 消去ブロックサイズ[byte]				*/
+#define LL_FLASH_BUSY		(0)				/* 書き込み/消去中						*/
+#define LL_FLASH_DONE		(1)				/* 書き込み/消去完了					*/
+#define LL_FLASH_ERROR		(2)				/* 書き込み/消去エラー					*/
+
+/* セミホスティング */
+#define LL_SEMIHOST_OK		(0)				/* 成功									*/
+#define LL_SEMIHOST_NC		(-1)			/* デバッガー未接続(要求しない)			*/
+
 /* Exported macro ------------------------------------------------------------*/
 #define SET_BIT(REG, BIT)			((REG) |= (BIT))
 #define CLEAR_BIT(REG, BIT)			((REG) &= ~(BIT))
@@ -23,6 +60,26 @@
 
 /* lld_utils.c */
 extern void LL_mDelay(uint32_t Delay);										/* 時間待ち処理(ms指定)					*/
+extern void LL_DWT_Init(void);												/* DWTサイクルカウンター初期化処理		*/
+
+/* lld_dtc.c */
+extern void LL_DTC_Init(void);												/* DTC初期化処理						*/
+extern void LL_DTC_SetVector(uint8_t u8_Irq, DtcTransferInfo *pst_Info);	/* DTCベクターを登録する				*/
+
+/* lld_flash.c */
+extern void LL_FLASH_Init(void);											/* データフラッシュ初期化処理			*/
+extern void LL_FLASH_Read(uint32_t u32_Offset, uint8_t *pu8_Data, uint32_t u32_Size);	/* データフラッシュを読み出す	*/
+extern void LL_FLASH_EnterPE(void);											/* データフラッシュP/Eモードにする		*/
+extern void LL_FLASH_ExitPE(void);											/* リードモードに戻す					*/
+extern void LL_FLASH_ProgramStart(uint32_t u32_Offset, uint8_t u8_Data);	/* 1byte書き込みを開始する				*/
+extern void LL_FLASH_EraseStart(uint32_t u32_Offset);						/* ブロック消去を開始する				*/
+extern uint8_t LL_FLASH_Poll(void);											/* 書き込み/消去の完了を確認する		*/
+extern bool LL_FLASH_IsPeMode(void);										/* P/Eモード中かを取得する				*/
+
+/* lld_semihost.c */
+extern bool LL_SEMIHOST_IsConnected(void);									/* デバッガーの接続を確認する			*/
+extern int32_t LL_SEMIHOST_Write0(const char *pc_Str);						/* 文字列をホストのコンソールに出力する	*/
+extern int32_t LL_SEMIHOST_Exit(bool bl_Success);							/* ホストに終了を通知する				*/
 
 /* Exported functions --------------------------------------------------------*/
 
@@ -46,4 +103,61 @@ static __inline void LL_SYSTICK_DisableIT(void)
 	CLEAR_BIT(SysTick->CTRL, SysTick_CTRL_TICKINT_Msk);
 }
 
+/**
+  * @brief  DWTサイクルカウンターを取得する
+  * @param  None
+  * @retval サイクル数
+  */
+static __inline uint32_t LL_DWT_GetCycle(void)
+{
+	return DWT->CYCCNT;
+}
+
+/**
+  * @brief  優先度シーリングの割り込み禁止区間を開始する
+  * @param  u32_Ceiling: シーリング(データを扱うISRの最も高い優先度, 1～15)
+  * @retval 開始前のBASEPRI(LL_IRQ_Unlockに渡す)
+  * @note   BASEPRIでシーリング以下の優先度の割り込みだけを保留し、より高い優先度の
+  *         割り込みは止めない。入れ子にしてもマスクは下がらない(BASEPRI_MAX)。
+  *         優先度0はBASEPRIでマスクできないため、シーリングには使用しない。
+  */
+static __inline uint32_t LL_IRQ_Lock(uint32_t u32_Ceiling)
+{
+	uint32_t u32_Prev = __get_BASEPRI();
+
+	__set_BASEPRI_MAX(u32_Ceiling << (8U - __NVIC_PRIO_BITS));
+	__ISB();
+	return u32_Prev;
+}
+
+/**
+  * @brief  優先度シーリングの割り込み禁止区間を終了する
+  * @param  u32_Prev: LL_IRQ_Lockの戻り値
+  * @retval None
+  */
+static __inline void LL_IRQ_Unlock(uint32_t u32_Prev)
+{
+	__set_BASEPRI(u32_Prev);
+}
+
+/**
+  * @brief  DTC起動を許可する
+  * @param  u8_Irq: IRQ番号
+  * @retval None
+  */
+static __inline void LL_DTC_EnableIT(uint8_t u8_Irq)
+{
+	R_ICU->IELSR_b[u8_Irq].DTCE = 1;
+}
+
+/**
+  * @brief  DTC起動を禁止する
+  * @param  u8_Irq: IRQ番号
+  * @retval None
+  */
+static __inline void LL_DTC_DisableIT(uint8_t u8_Irq)
+{
+	R_ICU->IELSR_b[u8_Irq].DTCE = 0;
+}
+
 #endif /* __LLD_H */
@@ -35,14 +35,111 @@ extern "C" {
 
 #define SYS_CYCLE_TIME		(5)		/* システムの周期時間[ms]		*/
 
+/* ウォッチドッグ設定(ビルドオプションで変更可) */
+/* WDTはPCLKBで計数し、設定はリセット後に1回しか書き込めないため、タイムアウトは */
+/* CLOCK_MODE_HIGH(PCLKB 24MHz)での値となる。MIDDLE(12MHz)では2倍,LOW(8MHz)では */
+/* 3倍に延びる(現在の値はwdtGetResetInfo()のu32_timeout_ms) */
+#ifndef WDT_TIMEOUT_CYCLES
+#define WDT_TIMEOUT_CYCLES	(40)	/* タイムアウト[周期](これ以上で最小の設定を選ぶ)	*/
+#endif
+#define WDT_TIMEOUT_TIME	(SYS_CYCLE_TIME * WDT_TIMEOUT_CYCLES)	/* タイムアウト[ms]	*/
+
+/* メインスタック(周期処理,PSP)のサイズ[byte](ビルドオプションで変更可) */
+#ifndef STACK_MAIN_SIZE
+#define STACK_MAIN_SIZE		(2048)
+#endif
+
+/* ウォッチドッグの監視対象タスク(周期処理の実行順) */
+#define TASK_ID_CLOCK_IN	(0)		/* クロック管理ドライバー入力処理		*/
+#define TASK_ID_TIMER		(1)		/* タイマー更新処理						*/
+#define TASK_ID_UART_IN		(2)		/* UARTドライバー入力処理				*/
+#define TASK_ID_GPIO_IN		(3)		/* GPIOドライバー入力処理				*/
+#define TASK_ID_EXTI_IN		(4)		/* 外部端子割り込みドライバー入力処理	*/
+#define TASK_ID_USB_IN		(5)		/* USBドライバー入力処理				*/
+#define TASK_ID_IIC_IN		(6)		/* IICドライバー入力処理				*/
+#define TASK_ID_SPI_IN		(7)		/* SPIドライバー入力処理(WiFiは無し)	*/
+#define TASK_ID_CAN_IN		(8)		/* CANドライバー入力処理				*/
+#define TASK_ID_ESP_IN		(9)		/* ESP32-S3リンクドライバー入力処理		*/
+#define TASK_ID_LOOP		(10)	/* 周期処理関数							*/
+#define TASK_ID_ADC_OUT		(11)	/* ADCドライバー出力処理				*/
+#define TASK_ID_KVS_OUT		(12)	/* キー・バリューストア ドライバー出力処理	*/
+#define TASK_ID_STACK_OUT	(13)	/* スタック監視ドライバー出力処理		*/
+#define TASK_ID_USB_OUT		(14)	/* USBドライバー出力処理				*/
+#define TASK_ID_ESP_OUT		(15)	/* ESP32-S3リンクドライバー出力処理		*/
+#define TASK_ID_UART_OUT	(16)	/* UARTドライバー出力処理				*/
+#define TASK_ID_CLOCK_OUT	(17)	/* クロック管理ドライバー出力処理		*/
+#define TASK_ID_NUM			(18)
+
+/* 監視するタスク(bitn:TASK_ID_xxx)。WiFiではSPIドライバーを使用しない */
+#if defined(BOARD_UNO_R4_WIFI)
+#define TASK_ID_MASK		(((1UL << TASK_ID_NUM) - 1) & ~(1UL << TASK_ID_SPI_IN))
+#else
+#define TASK_ID_MASK		((1UL << TASK_ID_NUM) - 1)
+#endif
+
 /* IRQ番号の割り当て */
 #define IRQ_SCI1_RXI		(0)		/* SCI1受信データフル割り込み			*/
 #define IRQ_SCI1_TXI		(1)		/* SCI1送信データエンプティ割り込み		*/
 #define IRQ_SCI1_TEI		(2)		/* SCI1送信終了割り込み					*/
 #define IRQ_SCI1_ERI		(3)		/* SCI1受信エラー割り込み				*/
-#define IRQ_PORT_IRQ0		(4)		/* 外部端子割り込み0					*/
+#define IRQ_PORT_IRQ_FIRST	(4)		/* 外部端子割り込み(drv_extiが割り当て)	*/
+#define IRQ_PORT_IRQ_NUM	(4)		/* 同時に使用できる外部端子割り込み数	*/
+#define IRQ_ADC0_ADI		(8)		/* ADC0スキャン終了割り込み(DTC起動)	*/
+#define IRQ_GPT5_OVF		(9)		/* SCI1受信アイドル検出(GPT5オーバーフロー)	*/
+#define IRQ_USBFS_INT		(10)	/* USBFS割り込み						*/
+#define IRQ_IIC1_RXI		(11)	/* IIC1受信データフル割り込み(DTC起動)	*/
+#define IRQ_IIC1_TXI		(12)	/* IIC1送信データエンプティ割り込み(DTC起動)	*/
+#define IRQ_IIC1_TEI		(13)	/* IIC1送信終了割り込み					*/
+#define IRQ_IIC1_EEI		(14)	/* IIC1通信エラー/イベント発生割り込み	*/
+#define IRQ_SPI0_RXI		(15)	/* SPI0受信バッファフル割り込み(DTC起動)	*/
+#define IRQ_SPI0_TXI		(16)	/* SPI0送信バッファエンプティ割り込み(DTC起動)	*/
+#define IRQ_SPI0_TEI		(17)	/* SPI0送信完了割り込み					*/
+#define IRQ_SPI0_ERI		(18)	/* SPI0エラー割り込み					*/
+#define IRQ_CAN0_ERS		(19)	/* CAN0エラー割り込み					*/
+#define IRQ_CAN0_RXF		(20)	/* CAN0受信FIFO割り込み					*/
+#define IRQ_CAN0_TXF		(21)	/* CAN0送信FIFO割り込み					*/
+#define IRQ_CAN0_RXM		(22)	/* CAN0メールボックス受信割り込み		*/
+#define IRQ_GPT6_OVF		(23)	/* 割り込み遅延計測プローブ(GPT6オーバーフロー)	*/
+#define IRQ_GPT7_OVF		(24)	/* 割り込み遅延計測プローブ(GPT7オーバーフロー)	*/
+#define IRQ_SCI9_RXI		(25)	/* SCI9受信データフル割り込み(DTC起動)	*/
+#define IRQ_SCI9_TXI		(26)	/* SCI9送信データエンプティ割り込み(DTC起動)	*/
+#define IRQ_SCI9_ERI		(27)	/* SCI9受信エラー割り込み				*/
+#define IRQ_GPT0_OVF		(28)	/* LEDマトリクス走査(GPT0オーバーフロー)	*/
+
+/* 割り込み優先度(0～15, 数値が小さいほど高い。0はBASEPRIでマスクできないため使用しない) */
+#define IRQ_PRIO_SCI9		(9)		/* SCI9_RXI/TXI/ERI(3Mbpsで1文字3.3us以内に受信リングを再設定する)	*/
+#define IRQ_PRIO_ADC0		(10)	/* ADC0_ADI								*/
+#define IRQ_PRIO_GPT0		(10)	/* GPT0_OVF(LEDマトリクス走査)			*/
+#define IRQ_PRIO_SPI0		(10)	/* SPI0_RXI/TXI/TEI/ERI					*/
+#define IRQ_PRIO_SCI1		(11)	/* SCI1_RXI/TXI/ERI, GPT5_OVF(受信アイドル)	*/
+#define IRQ_PRIO_USBFS		(11)	/* USBFS_INT							*/
+#define IRQ_PRIO_CAN0		(11)	/* CAN0_ERS/RXF/TXF/RXM					*/
+#define IRQ_PRIO_PORT_IRQ	(12)	/* PORT_IRQn(外部端子割り込み)			*/
+#define IRQ_PRIO_IIC1		(12)	/* IIC1_RXI/TXI/TEI/EEI					*/
+#define IRQ_PRIO_SYSTICK	(15)	/* SysTick(SysTick_Configが最低優先度に設定)	*/
+
+/* ユーザーLEDの端子 */
+#define LED_SCK_PORT		(1)			/* SCK LED(P111): High点灯(SPI使用中はRSPCKを表示)	*/
+#define LED_SCK_MASK		(0x0800)
+#define LED_TXRX_PORT		(0)			/* TX/RX LED(P012/P013): Low点灯	*/
+#if defined(BOARD_UNO_R4_WIFI)
+#define LED_TX_MASK			(0x0000)	/* WiFiではP012/P013はLEDマトリクスの端子のため使用しない	*/
+#define LED_RX_MASK			(0x0000)
+#else
+#define LED_TX_MASK			(0x1000)
+#define LED_RX_MASK			(0x2000)
+#endif
+
+/* SPIチップセレクトの端子 */
+#define SPI_CS_PORT			(1)			/* SPI CS(P112/D10): Low選択		*/
+#define SPI_CS_MASK			(0x1000)
 
 /* Exported macro ------------------------------------------------------------*/
+/* 2つの割り込み優先度のうち高い方(シーリングの算出用) */
+#define IRQ_PRIO_HIGHER(a, b)	(((a) < (b)) ? (a) : (b))
+
+/* PDRのシーリング(PDRを書き換えるADC0_ADI/SCI1のアプリのコールバック, LEDマトリクス走査のGPT0_OVF) */
+#define GPIO_PDR_CEILING		(IRQ_PRIO_HIGHER(IRQ_PRIO_HIGHER(IRQ_PRIO_ADC0, IRQ_PRIO_SCI1), IRQ_PRIO_GPT0))
 
 /* Exported functions prototypes ---------------------------------------------*/
 
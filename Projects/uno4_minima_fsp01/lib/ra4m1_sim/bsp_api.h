@@ -0,0 +1,793 @@
+/**
+  ******************************************************************************
+  * @file           : bsp_api.h
+  * @brief          : RA4M1レジスタモデル(ホスト実行用 bsp_api.h 代替)
+  ******************************************************************************
+  * @note   env:native でのみ使用する。FSP/CMSISのうち本プロジェクトが使う
+  *         型・マクロ・関数だけを同名で定義し、周辺レジスタはRAM上の構造体で
+  *         置き換える。SCI1/PORT/SysTick/DWT/SYSTEM(クロック)/FACI(データフラッシュ)/
+  *         FCACHE/USBFS/IIC1はシミュレーターがアクセスを捕捉して実機と同じ振る舞い
+  *         (送受信タイミング,割り込み,書き込み/消去時間,クロック変更)を再現する。
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __BSP_API_H
+#define __BSP_API_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Exported constants --------------------------------------------------------*/
+
+/* CMSIS互換定義 */
+#define __I					volatile const
+#define __O					volatile
+#define __IO				volatile
+#define __IM				volatile const
+#define __OM				volatile
+#define __IOM				volatile
+#define __STATIC_INLINE		static inline
+#define __FPU_USED			(0U)		/* ホストではFPU設定を行わない	*/
+#define __NVIC_PRIO_BITS	(4U)
+
+/* BSP定義 */
+#define BSP_CORTEX_VECTOR_TABLE_ENTRIES		(16U)
+#define BSP_ICU_VECTOR_MAX_ENTRIES			(32U)
+#define BSP_DONT_REMOVE
+#define BSP_PLACE_IN_SECTION(x)
+#define BSP_SECTION_NOINIT					".noinit"
+#define BSP_SECTION_APPLICATION_VECTORS
+#define BSP_ALIGN_VARIABLE(x)				__attribute__((aligned(x)))
+#define BSP_FEATURE_FLASH_DATA_FLASH_START	((uint32_t)(uintptr_t)&g_sim_dflash[0])
+
+/* Exported types ------------------------------------------------------------*/
+
+typedef void (*fsp_vector_t)(void);
+
+typedef enum IRQn {
+	NonMaskableInt_IRQn	= -14,
+	HardFault_IRQn		= -13,
+	SVCall_IRQn			= -5,
+	PendSV_IRQn			= -2,
+	SysTick_IRQn		= -1,
+} IRQn_Type;
+
+typedef enum e_bsp_reg_protect {
+	BSP_REG_PROTECT_CGC = 0,
+	BSP_REG_PROTECT_OM_LPC_BATT,
+	BSP_REG_PROTECT_LVD,
+	BSP_REG_PROTECT_SAR,
+} bsp_reg_protect_t;
+
+typedef enum e_fsp_priv_clock {
+	FSP_PRIV_CLOCK_PCLKD = 0,
+	FSP_PRIV_CLOCK_PCLKC,
+	FSP_PRIV_CLOCK_PCLKB,
+	FSP_PRIV_CLOCK_PCLKA,
+	FSP_PRIV_CLOCK_BCLK,
+	FSP_PRIV_CLOCK_ICLK,
+	FSP_PRIV_CLOCK_FCLK,
+} fsp_priv_clock_t;
+
+typedef enum e_fsp_err {
+	FSP_SUCCESS = 0,
+} fsp_err_t;
+
+/* NMI要因(NMISRのビット番号) */
+typedef enum e_bsp_grp_irq {
+	BSP_GRP_IRQ_MPU_STACK = 12,
+} bsp_grp_irq_t;
+
+/* ELCイベント番号(RA4M1) */
+typedef enum e_elc_event {
+	ELC_EVENT_NONE							= 0x000,
+	ELC_EVENT_ICU_IRQ0						= 0x001,
+	ELC_EVENT_ICU_IRQ1						= 0x002,
+	ELC_EVENT_ICU_IRQ2						= 0x003,
+	ELC_EVENT_ICU_IRQ3						= 0x004,
+	ELC_EVENT_ICU_IRQ4						= 0x005,
+	ELC_EVENT_ICU_IRQ5						= 0x006,
+	ELC_EVENT_ICU_IRQ6						= 0x007,
+	ELC_EVENT_ICU_IRQ7						= 0x008,
+	ELC_EVENT_ICU_IRQ8						= 0x009,
+	ELC_EVENT_ICU_IRQ9						= 0x00A,
+	ELC_EVENT_ICU_IRQ10						= 0x00B,
+	ELC_EVENT_ICU_IRQ11						= 0x00C,
+	ELC_EVENT_ICU_IRQ12						= 0x00D,
+	ELC_EVENT_ICU_IRQ13						= 0x00E,
+	ELC_EVENT_ICU_IRQ14						= 0x00F,
+	ELC_EVENT_ICU_IRQ15						= 0x010,
+	ELC_EVENT_USBFS_INT						= 0x032,
+	ELC_EVENT_ADC0_SCAN_END					= 0x04B,
+	ELC_EVENT_GPT0_COUNTER_OVERFLOW			= 0x05F,
+	ELC_EVENT_IIC1_RXI						= 0x078,
+	ELC_EVENT_IIC1_TXI						= 0x079,
+	ELC_EVENT_IIC1_TEI						= 0x07A,
+	ELC_EVENT_IIC1_EEI						= 0x07B,
+	ELC_EVENT_GPT4_COUNTER_OVERFLOW			= 0x091,
+	ELC_EVENT_GPT5_COUNTER_OVERFLOW			= 0x097,
+	ELC_EVENT_GPT6_COUNTER_OVERFLOW			= 0x09D,
+	ELC_EVENT_GPT7_COUNTER_OVERFLOW			= 0x0A3,
+	ELC_EVENT_SCI1_RXI						= 0x09E,
+	ELC_EVENT_SCI1_TXI						= 0x09F,
+	ELC_EVENT_SCI1_TEI						= 0x0A0,
+	ELC_EVENT_SCI1_ERI						= 0x0A1,
+	ELC_EVENT_SCI9_RXI						= 0x0A8,
+	ELC_EVENT_SCI9_TXI						= 0x0A9,
+	ELC_EVENT_SCI9_TEI						= 0x0AA,
+	ELC_EVENT_SCI9_ERI						= 0x0AB,
+	ELC_EVENT_SPI0_RXI						= 0x0C4,
+	ELC_EVENT_SPI0_TXI						= 0x0C5,
+	ELC_EVENT_SPI0_IDLE						= 0x0C6,
+	ELC_EVENT_SPI0_ERI						= 0x0C7,
+	ELC_EVENT_SPI0_TEI						= 0x0C8,
+	ELC_EVENT_CAN0_ERROR					= 0x0CE,
+	ELC_EVENT_CAN0_FIFO_RX					= 0x0CF,
+	ELC_EVENT_CAN0_FIFO_TX					= 0x0D0,
+	ELC_EVENT_CAN0_MAILBOX_RX				= 0x0D1,
+	ELC_EVENT_CAN0_MAILBOX_TX				= 0x0D2,
+} elc_event_t;
+
+typedef enum e_elc_peripheral {
+	ELC_PERIPHERAL_GPT_A	= 0,
+	ELC_PERIPHERAL_GPT_B	= 1,
+	ELC_PERIPHERAL_GPT_C	= 2,
+	ELC_PERIPHERAL_GPT_D	= 3,
+	ELC_PERIPHERAL_ADC0		= 8,
+	ELC_PERIPHERAL_ADC0_B	= 9,
+} elc_peripheral_t;
+
+/* ---- ビットフィールド生成マクロ ---- */
+#define SIM_BITS16(T, N)	\
+	__IOM T N##0 : 1; __IOM T N##1 : 1; __IOM T N##2 : 1; __IOM T N##3 : 1; \
+	__IOM T N##4 : 1; __IOM T N##5 : 1; __IOM T N##6 : 1; __IOM T N##7 : 1; \
+	__IOM T N##8 : 1; __IOM T N##9 : 1; __IOM T N##10 : 1; __IOM T N##11 : 1; \
+	__IOM T N##12 : 1; __IOM T N##13 : 1; __IOM T N##14 : 1; __IOM T N##15 : 1;
+#define SIM_BITS32(N)	\
+	SIM_BITS16(uint32_t, N) \
+	__IOM uint32_t N##16 : 1; __IOM uint32_t N##17 : 1; __IOM uint32_t N##18 : 1; __IOM uint32_t N##19 : 1; \
+	__IOM uint32_t N##20 : 1; __IOM uint32_t N##21 : 1; __IOM uint32_t N##22 : 1; __IOM uint32_t N##23 : 1; \
+	__IOM uint32_t N##24 : 1; __IOM uint32_t N##25 : 1; __IOM uint32_t N##26 : 1; __IOM uint32_t N##27 : 1; \
+	__IOM uint32_t N##28 : 1; __IOM uint32_t N##29 : 1; __IOM uint32_t N##30 : 1; __IOM uint32_t N##31 : 1;
+#define SIM_REG16(N)	union { __IOM uint16_t N; struct { SIM_BITS16(uint16_t, N) } N##_b; }
+#define SIM_REG32(N, B)	union { __IOM uint32_t N; struct { SIM_BITS32(B) } N##_b; }
+
+/* ---- SCI ---- */
+typedef struct {
+	__IOM uint8_t SMR;
+	__IOM uint8_t BRR;
+	union {
+		__IOM uint8_t SCR;
+		struct {
+			__IOM uint8_t CKE : 2;
+			__IOM uint8_t TEIE : 1;
+			__IOM uint8_t MPIE : 1;
+			__IOM uint8_t RE : 1;
+			__IOM uint8_t TE : 1;
+			__IOM uint8_t RIE : 1;
+			__IOM uint8_t TIE : 1;
+		} SCR_b;
+	};
+	__IOM uint8_t TDR;
+	union {
+		__IOM uint8_t SSR;
+		struct {
+			__IOM uint8_t MPBT : 1;
+			__IM  uint8_t MPB : 1;
+			__IM  uint8_t TEND : 1;
+			__IOM uint8_t PER : 1;
+			__IOM uint8_t FER : 1;
+			__IOM uint8_t ORER : 1;
+			__IOM uint8_t RDRF : 1;
+			__IOM uint8_t TDRE : 1;
+		} SSR_b;
+	};
+	__IM  uint8_t RDR;
+	__IOM uint8_t SCMR;
+	__IOM uint8_t SEMR;
+	__IOM uint8_t SNFR;
+	__IOM uint8_t SIMR1;
+	__IOM uint8_t SIMR2;
+	__IOM uint8_t SIMR3;
+	__IM  uint8_t SISR;
+	__IOM uint8_t SPMR;
+	__IOM uint16_t TDRHL;
+	__IM  uint16_t RDRHL;
+	__IOM uint8_t MDDR;
+	__IOM uint8_t DCCR;
+	__IOM uint16_t FCR;
+	__IM  uint16_t FDR;
+	__IM  uint16_t LSR;
+	__IOM uint16_t CDR;
+	__IOM uint8_t SPTR;
+	__IOM uint8_t reserved[3];
+} R_SCI0_Type;
+
+/* ---- PORT ---- */
+typedef struct {
+	union {
+		__IOM uint32_t PCNTR1;
+		struct {
+			SIM_REG16(PDR);
+			SIM_REG16(PODR);
+		};
+	};
+	union {
+		__IM uint32_t PCNTR2;
+		struct {
+			SIM_REG16(PIDR);
+			SIM_REG16(EIDR);
+		};
+	};
+	union {
+		__OM uint32_t PCNTR3;
+		struct {
+			SIM_REG16(POSR);
+			SIM_REG16(PORR);
+		};
+	};
+	union {
+		__IOM uint32_t PCNTR4;
+		struct {
+			SIM_REG16(EOSR);
+			SIM_REG16(EORR);
+		};
+	};
+} R_PORT0_Type;
+
+/* ---- PFS ---- */
+typedef struct {
+	union {
+		__IOM uint32_t PmnPFS;
+		struct {
+			__IOM uint32_t PODR : 1;
+			__IM  uint32_t PIDR : 1;
+			__IOM uint32_t PDR : 1;
+			uint32_t : 1;
+			__IOM uint32_t PCR : 1;
+			uint32_t : 1;
+			__IOM uint32_t NCODR : 1;
+			uint32_t : 3;
+			__IOM uint32_t DSCR : 2;
+			__IOM uint32_t EOFR : 2;
+			__IOM uint32_t ISEL : 1;
+			__IOM uint32_t ASEL : 1;
+			__IOM uint32_t PMR : 1;
+			uint32_t : 7;
+			__IOM uint32_t PSEL : 5;
+			uint32_t : 3;
+		} PmnPFS_b;
+	};
+} R_PFS_PIN_Type;
+
+typedef struct {
+	struct {
+		R_PFS_PIN_Type PIN[16];
+	} PORT[15];
+} R_PFS_Type;
+
+/* ---- MSTP ---- */
+typedef struct {
+	SIM_REG32(MSTPCRA, MSTPA);
+	SIM_REG32(MSTPCRB, MSTPB);
+	SIM_REG32(MSTPCRC, MSTPC);
+	SIM_REG32(MSTPCRD, MSTPD);
+} R_MSTP_Type;
+
+/* ---- ICU ---- */
+typedef struct {
+	union {
+		__IOM uint8_t IRQCR[16];
+		struct {
+			__IOM uint8_t IRQMD : 2;
+			uint8_t : 2;
+			__IOM uint8_t FCLKSEL : 2;
+			uint8_t : 1;
+			__IOM uint8_t FLTEN : 1;
+		} IRQCR_b[16];
+	};
+	__IOM uint8_t NMICR;
+	__IOM uint16_t NMIER;
+	__IOM uint16_t NMICLR;
+	__IM  uint16_t NMISR;
+	__IOM uint32_t WUPEN;
+	__IOM uint8_t IELEN;
+	__IOM uint8_t SELSR0;
+	union {
+		__IOM uint32_t IELSR[32];
+		struct {
+			__IOM uint32_t IELS : 9;
+			uint32_t : 7;
+			__IOM uint32_t IR : 1;
+			uint32_t : 7;
+			__IOM uint32_t DTCE : 1;
+			uint32_t : 7;
+		} IELSR_b[32];
+	};
+} R_ICU_Type;
+
+/* ---- DTC ---- */
+typedef struct {
+	__IOM uint8_t DTCCR;
+	__IOM uint32_t DTCVBR;
+	__IOM uint8_t DTCST;
+	__IM  uint16_t DTCSTS;
+} R_DTC_Type;
+
+/* ---- ELC ---- */
+typedef struct {
+	__IOM uint8_t ELCR;
+	__IOM uint8_t ELSEGR[2];
+	struct {
+		__IOM uint16_t HA;
+	} ELSR[19];
+} R_ELC_Type;
+
+/* ---- ADC ---- */
+typedef struct {
+	__IOM uint16_t ADCSR;
+	__IOM uint16_t ADANSA[2];
+	__IOM uint16_t ADADS[2];
+	__IOM uint8_t ADADC;
+	__IOM uint16_t ADCER;
+	__IOM uint16_t ADSTRGR;
+	__IOM uint16_t ADEXICR;
+	__IOM uint16_t ADANSB[2];
+	__IM  uint16_t ADDBLDR;
+	__IM  uint16_t ADTSDR;
+	__IM  uint16_t ADOCDR;
+	__IM  uint16_t ADDR[32];
+	__IOM uint8_t ADSSTR[16];
+} R_ADC0_Type;
+
+/* ---- GPT ---- */
+typedef struct {
+	__IOM uint32_t GTWP;
+	__IOM uint32_t GTSTR;
+	__IOM uint32_t GTSTP;
+	__IOM uint32_t GTCLR;
+	__IOM uint32_t GTSSR;
+	__IOM uint32_t GTPSR;
+	__IOM uint32_t GTCSR;
+	__IOM uint32_t GTUPSR;
+	__IOM uint32_t GTDNSR;
+	__IOM uint32_t GTICASR;
+	__IOM uint32_t GTICBSR;
+	union {
+		__IOM uint32_t GTCR;
+		struct {
+			__IOM uint32_t CST : 1;
+			uint32_t : 15;
+			__IOM uint32_t MD : 3;
+			uint32_t : 5;
+			__IOM uint32_t TPCS : 3;
+			uint32_t : 5;
+		} GTCR_b;
+	};
+	__IOM uint32_t GTUDDTYC;
+	__IOM uint32_t GTIOR;
+	__IOM uint32_t GTINTAD;
+	__IOM uint32_t GTST;
+	__IOM uint32_t GTBER;
+	__IOM uint32_t GTCNT;
+	__IOM uint32_t GTCCR[6];
+	__IOM uint32_t GTPR;
+	__IOM uint32_t GTPBR;
+} R_GPT0_Type;
+
+/* ---- MPU(スタックポインタモニター) ---- */
+typedef struct {
+	struct {
+		__IOM uint32_t OAD;
+		__IOM uint16_t CTL;
+		__IOM uint16_t PT;
+		__IOM uint32_t SA;
+		__IOM uint32_t EA;
+	} SP[2];
+} R_MPU_SPMON_Type;
+
+/* ---- SYSTEM(クロック発生回路,動作電力モード,リセットステータス) ---- */
+typedef struct {
+	__IOM uint32_t SCKDIVCR;
+	__IOM uint8_t SCKSCR;
+	__IOM uint8_t MEMWAIT;
+	__IOM uint8_t HOCOCR;
+	__IOM uint8_t MOCOCR;
+	__IOM uint8_t OSCSF;
+	__IOM uint8_t OPCCR;
+	__IOM uint16_t PRCR;
+	__IOM uint8_t RSTSR0;
+	__IOM uint8_t RSTSR2;
+	__IOM uint16_t RSTSR1;
+} R_SYSTEM_Type;
+
+/* ---- WDT ---- */
+typedef struct {
+	__IOM uint8_t WDTRR;
+	__IM  uint8_t RESERVED;
+	__IOM uint16_t WDTCR;
+	__IOM uint16_t WDTSR;
+	__IOM uint8_t WDTRCR;
+	__IM  uint8_t RESERVED1;
+	__IOM uint8_t WDTCSTPR;
+} R_WDT_Type;
+
+/* ---- Cortex-M4 コアペリフェラル ---- */
+typedef struct {
+	__IOM uint32_t CTRL;
+	__IOM uint32_t LOAD;
+	__IOM uint32_t VAL;
+	__IM  uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct {
+	__IOM uint32_t CTRL;
+	__IOM uint32_t CYCCNT;
+	__IOM uint32_t CPICNT;
+	__IOM uint32_t EXCCNT;
+	__IOM uint32_t SLEEPCNT;
+	__IOM uint32_t LSUCNT;
+	__IOM uint32_t FOLDCNT;
+} DWT_Type;
+
+typedef struct {
+	__IOM uint32_t DHCSR;
+	__OM  uint32_t DCRSR;
+	__IOM uint32_t DCRDR;
+	__IOM uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct {
+	__IM  uint32_t CPUID;
+	__IOM uint32_t ICSR;
+	__IOM uint32_t VTOR;
+	__IOM uint32_t AIRCR;
+	__IOM uint32_t SCR;
+	__IOM uint32_t CCR;
+	__IOM uint8_t  SHP[12];
+	__IOM uint32_t SHCSR;
+	__IOM uint32_t CFSR;
+	__IOM uint32_t HFSR;
+	__IOM uint32_t DFSR;
+	__IOM uint32_t MMFAR;
+	__IOM uint32_t BFAR;
+	__IOM uint32_t AFSR;
+	__IOM uint32_t CPACR;
+} SCB_Type;
+
+typedef struct {
+	__IOM uint32_t FPCCR;
+	__IOM uint32_t FPCAR;
+	__IOM uint32_t FPDSCR;
+} FPU_Type;
+
+/* ---- FACI(低消費電力フラッシュ,データフラッシュのP/E) ---- */
+typedef struct {
+	__IOM uint8_t DFLCTL;
+	__IOM uint8_t FPMCR;
+	__IOM uint8_t FASR;
+	__IOM uint8_t FCR;
+	__IOM uint16_t FSARL;
+	__IOM uint16_t FSARH;
+	__IOM uint16_t FEARL;
+	__IOM uint16_t FEARH;
+	__IOM uint16_t FWBL0;
+	__IOM uint16_t FSTATR2;
+	__IOM uint8_t FSTATR1;
+	__IOM uint8_t FPR;
+	__IOM uint8_t FISR;
+	__IM  uint8_t RESERVED;
+	__IOM uint16_t FENTRYR;
+} R_FACI_LP_Type;
+
+/* ---- FCACHE(フラッシュキャッシュ) ---- */
+typedef struct {
+	__IOM uint16_t FCACHEE;
+	__IOM uint16_t FCACHEIV;
+} R_FCACHE_Type;
+
+/* ---- USBFS ---- */
+typedef struct {
+	__IOM uint16_t SYSCFG;
+	__IM  uint16_t RESERVED;
+	__IM  uint16_t SYSSTS0;
+	__IM  uint16_t RESERVED1;
+	__IOM uint16_t DVSTCTR0;
+	__IM  uint16_t RESERVED2[5];
+	union {
+		__IOM uint16_t CFIFO;
+		__IOM uint8_t CFIFOL;
+	};
+	__IM  uint16_t RESERVED3[5];
+	__IOM uint16_t CFIFOSEL;
+	__IOM uint16_t CFIFOCTR;
+	__IM  uint16_t RESERVED4[6];
+	__IOM uint16_t INTENB0;
+	__IOM uint16_t INTENB1;
+	__IM  uint16_t RESERVED5;
+	__IOM uint16_t BRDYENB;
+	__IOM uint16_t NRDYENB;
+	__IOM uint16_t BEMPENB;
+	__IOM uint16_t SOFCFG;
+	__IM  uint16_t RESERVED6;
+	__IOM uint16_t INTSTS0;
+	__IOM uint16_t INTSTS1;
+	__IM  uint16_t RESERVED7;
+	__IOM uint16_t BRDYSTS;
+	__IOM uint16_t NRDYSTS;
+	__IOM uint16_t BEMPSTS;
+	__IM  uint16_t FRMNUM;
+	__IM  uint16_t RESERVED8[3];
+	__IM  uint16_t USBREQ;
+	__IM  uint16_t USBVAL;
+	__IM  uint16_t USBINDX;
+	__IM  uint16_t USBLENG;
+	__IOM uint16_t DCPCFG;
+	__IOM uint16_t DCPMAXP;
+	__IOM uint16_t DCPCTR;
+	__IM  uint16_t RESERVED9;
+	__IOM uint16_t PIPESEL;
+	__IM  uint16_t RESERVED10;
+	__IOM uint16_t PIPECFG;
+	__IM  uint16_t RESERVED11;
+	__IOM uint16_t PIPEMAXP;
+	__IOM uint16_t PIPEPERI;
+	__IOM uint16_t PIPE_CTR[9];
+	__IM  uint16_t RESERVED12[37];
+	__IOM uint16_t USBMC;
+} R_USB_FS0_Type;
+
+/* ---- IIC ---- */
+typedef struct {
+	__IOM uint8_t ICCR1;
+	__IOM uint8_t ICCR2;
+	__IOM uint8_t ICMR1;
+	__IOM uint8_t ICMR2;
+	__IOM uint8_t ICMR3;
+	__IOM uint8_t ICFER;
+	__IOM uint8_t ICSER;
+	__IOM uint8_t ICIER;
+	__IOM uint8_t ICSR1;
+	__IOM uint8_t ICSR2;
+	struct {
+		__IOM uint8_t SARL;
+		__IOM uint8_t SARU;
+	} SAR[3];
+	__IOM uint8_t ICBRL;
+	__IOM uint8_t ICBRH;
+	__IOM uint8_t ICDRT;
+	__IM  uint8_t ICDRR;
+	__IM  uint8_t RESERVED[2];
+	__IOM uint8_t ICWUR;
+	__IOM uint8_t ICWUR2;
+} R_IIC0_Type;
+
+/* ---- SPI(RSPI) ---- */
+typedef struct {
+	__IOM uint8_t SPCR;
+	__IOM uint8_t SSLP;
+	__IOM uint8_t SPPCR;
+	__IOM uint8_t SPSR;
+	union {
+		__IOM uint32_t SPDR;
+		__IOM uint16_t SPDR_HA;
+		__IOM uint8_t SPDR_BY;
+	};
+	__IOM uint8_t SPSCR;
+	__IM  uint8_t SPSSR;
+	__IOM uint8_t SPBR;
+	__IOM uint8_t SPDCR;
+	__IOM uint8_t SPCKD;
+	__IOM uint8_t SSLND;
+	__IOM uint8_t SPND;
+	__IOM uint8_t SPCR2;
+	__IOM uint16_t SPCMD0;
+	__IM  uint16_t RESERVED[7];
+} R_SPI0_Type;
+
+/* ---- CAN ---- */
+typedef struct {
+	__IOM uint32_t ID;							/* IDE(31) RTR(30) SID(28:18) EID(17:0)	*/
+	__IOM uint16_t DL;							/* DLC(3:0)							*/
+	__IOM uint8_t D[8];
+	__IOM uint16_t TS;
+} R_CAN0_MB_Type;
+
+typedef struct {
+	__IM  uint32_t RESERVED[512];
+	R_CAN0_MB_Type MB[32];						/* 0x800							*/
+	__IOM uint32_t MKR[8];						/* 0xA00							*/
+	__IOM uint32_t FIDCR[2];					/* 0xA20							*/
+	__IOM uint32_t MKIVLR;						/* 0xA28							*/
+	__IOM uint32_t MIER;						/* 0xA2C							*/
+	__IM  uint32_t RESERVED1[124];
+	union {										/* 0xC20							*/
+		__IOM uint8_t MCTL_TX[32];
+		__IOM uint8_t MCTL_RX[32];
+	};
+	__IOM uint16_t CTLR;						/* 0xC40							*/
+	__IM  uint16_t STR;
+	__IOM uint32_t BCR;
+	__IOM uint8_t RFCR;							/* 0xC48							*/
+	__OM  uint8_t RFPCR;
+	__IOM uint8_t TFCR;
+	__OM  uint8_t TFPCR;
+	__IOM uint8_t EIER;							/* 0xC4C							*/
+	__IOM uint8_t EIFR;
+	__IM  uint8_t RECR;
+	__IM  uint8_t TECR;
+	__IOM uint8_t ECSR;							/* 0xC50							*/
+	__IOM uint8_t CSSR;
+	__IM  uint8_t MSSR;
+	__IOM uint8_t MSMR;
+	__IM  uint16_t TSR;							/* 0xC54							*/
+	__IOM uint16_t AFSR;
+	__IOM uint8_t TCR;							/* 0xC58							*/
+	__IM  uint8_t RESERVED2[3];
+} R_CAN0_Type;
+
+/* アクセス捕捉対象のペリフェラル(シミュレーターが監視するページに配置) */
+typedef struct {
+	R_SCI0_Type sci[10];
+	uint8_t pad0[4096 - (10 * sizeof(R_SCI0_Type))];
+	R_PORT0_Type port[10];
+	uint8_t pad1[4096 - (10 * sizeof(R_PORT0_Type))];
+	SysTick_Type systick;
+	DWT_Type dwt;
+	R_SYSTEM_Type system;
+	uint8_t pad2[4096 - sizeof(SysTick_Type) - sizeof(DWT_Type) - sizeof(R_SYSTEM_Type)];
+	R_FACI_LP_Type faci;
+	R_FCACHE_Type fcache;
+	uint8_t pad3[4096 - sizeof(R_FACI_LP_Type) - sizeof(R_FCACHE_Type)];
+	R_USB_FS0_Type usbfs;
+	uint8_t pad4[4096 - sizeof(R_USB_FS0_Type)];
+	R_IIC0_Type iic[2];
+	uint8_t pad5[4096 - (2 * sizeof(R_IIC0_Type))];
+	R_SPI0_Type spi[2];
+	uint8_t pad6[4096 - (2 * sizeof(R_SPI0_Type))];
+	R_CAN0_Type can0;
+	uint8_t pad7[4096 - sizeof(R_CAN0_Type)];
+	R_GPT0_Type gpt[8];
+	uint8_t pad8[4096 - (8 * sizeof(R_GPT0_Type))];
+} SimTrapRegs;
+
+/* Exported variables --------------------------------------------------------*/
+extern SimTrapRegs *g_sim_trap;
+extern R_PFS_Type g_sim_pfs;
+extern R_MSTP_Type g_sim_mstp;
+extern R_ICU_Type g_sim_icu;
+extern R_DTC_Type g_sim_dtc;
+extern R_ELC_Type g_sim_elc;
+extern R_ADC0_Type g_sim_adc0;
+extern R_MPU_SPMON_Type g_sim_spmon;
+extern R_WDT_Type g_sim_wdt;
+extern CoreDebug_Type g_sim_coredebug;
+extern SCB_Type g_sim_scb;
+extern FPU_Type g_sim_fpu;
+extern uint32_t SystemCoreClock;
+extern uint8_t g_sim_dflash[8192];
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* ペリフェラル */
+#define R_SCI0				(&g_sim_trap->sci[0])
+#define R_SCI1				(&g_sim_trap->sci[1])
+#define R_SCI2				(&g_sim_trap->sci[2])
+#define R_SCI9				(&g_sim_trap->sci[9])
+#define R_PORT0				(&g_sim_trap->port[0])
+#define R_PORT1				(&g_sim_trap->port[1])
+#define R_PORT2				(&g_sim_trap->port[2])
+#define R_PORT3				(&g_sim_trap->port[3])
+#define R_PORT4				(&g_sim_trap->port[4])
+#define R_PORT5				(&g_sim_trap->port[5])
+#define R_PORT6				(&g_sim_trap->port[6])
+#define R_PORT7				(&g_sim_trap->port[7])
+#define R_PORT8				(&g_sim_trap->port[8])
+#define R_PORT9				(&g_sim_trap->port[9])
+#define SysTick				(&g_sim_trap->systick)
+#define DWT					(&g_sim_trap->dwt)
+#define R_FACI_LP			(&g_sim_trap->faci)
+#define R_FCACHE			(&g_sim_trap->fcache)
+#define R_SYSTEM			(&g_sim_trap->system)
+#define R_USB_FS0			(&g_sim_trap->usbfs)
+#define R_IIC0				(&g_sim_trap->iic[0])
+#define R_IIC1				(&g_sim_trap->iic[1])
+#define R_SPI0				(&g_sim_trap->spi[0])
+#define R_SPI1				(&g_sim_trap->spi[1])
+#define R_CAN0				(&g_sim_trap->can0)
+#define R_PFS				(&g_sim_pfs)
+#define R_MSTP				(&g_sim_mstp)
+#define R_ICU				(&g_sim_icu)
+#define R_DTC				(&g_sim_dtc)
+#define R_ELC				(&g_sim_elc)
+#define R_ADC0				(&g_sim_adc0)
+#define R_GPT0				(&g_sim_trap->gpt[0])
+#define R_GPT1				(&g_sim_trap->gpt[1])
+#define R_GPT2				(&g_sim_trap->gpt[2])
+#define R_GPT3				(&g_sim_trap->gpt[3])
+#define R_GPT4				(&g_sim_trap->gpt[4])
+#define R_GPT5				(&g_sim_trap->gpt[5])
+#define R_GPT6				(&g_sim_trap->gpt[6])
+#define R_GPT7				(&g_sim_trap->gpt[7])
+#define R_MPU_SPMON			(&g_sim_spmon)
+#define R_WDT				(&g_sim_wdt)
+#define CoreDebug			(&g_sim_coredebug)
+#define SCB					(&g_sim_scb)
+#define FPU					(&g_sim_fpu)
+
+/* レジスタビット定義 */
+#define SysTick_CTRL_ENABLE_Msk			(1UL << 0)
+#define SysTick_CTRL_TICKINT_Msk		(1UL << 1)
+#define SysTick_CTRL_CLKSOURCE_Msk		(1UL << 2)
+#define SysTick_CTRL_COUNTFLAG_Msk		(1UL << 16)
+#define SysTick_LOAD_RELOAD_Msk			(0xFFFFFFUL)
+#define DWT_CTRL_CYCCNTENA_Msk			(1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk		(1UL << 24)
+#define CoreDebug_DHCSR_C_DEBUGEN_Msk	(1UL << 0)
+#define CONTROL_SPSEL_Msk				(1UL << 1)
+#define R_ICU_NMIER_SPEEN_Msk			(1UL << 12)
+#define R_MPU_SPMON_SP_CTL_ENABLE_Msk	(1UL << 0)
+#define R_MPU_SPMON_SP_CTL_ERROR_Msk	(1UL << 8)
+#define FPU_FPCCR_LSPEN_Msk				(1UL << 30)
+#define FPU_FPCCR_ASPEN_Msk				(1UL << 31)
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+/* CMSIS互換関数(sim_ra4m1.c,sim_clock.c) */
+extern void __disable_irq(void);
+extern void __enable_irq(void);
+extern uint32_t __get_BASEPRI(void);
+extern void __set_BASEPRI(uint32_t basePri);
+extern void __set_BASEPRI_MAX(uint32_t basePri);
+extern void __WFE(void);
+extern void __WFI(void);
+extern void NVIC_EnableIRQ(IRQn_Type IRQn);
+extern void NVIC_DisableIRQ(IRQn_Type IRQn);
+extern void NVIC_ClearPendingIRQ(IRQn_Type IRQn);
+extern void NVIC_SetPendingIRQ(IRQn_Type IRQn);
+extern uint32_t NVIC_GetPendingIRQ(IRQn_Type IRQn);
+extern void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority);
+extern uint32_t NVIC_GetPriority(IRQn_Type IRQn);
+extern void NVIC_SetVector(IRQn_Type IRQn, uintptr_t vector);
+extern uint32_t NVIC_GetVector(IRQn_Type IRQn);
+extern void NVIC_SystemReset(void) __attribute__((noreturn));
+extern uint32_t SysTick_Config(uint32_t ticks);
+extern void SystemCoreClockUpdate(void);
+extern uint32_t __get_MSP(void);
+extern uint32_t __get_PSP(void);
+extern void __set_PSP(uint32_t topOfProcStack);
+extern uint32_t __get_CONTROL(void);
+extern void __set_CONTROL(uint32_t control);
+
+/* セミホスティング(ARMコンパイラ互換,sim_ra4m1.c) */
+extern int __semihost(int op, const void *arg);
+
+/* FSP互換関数(sim_ra4m1.c,sim_clock.c) */
+extern void R_BSP_RegisterProtectEnable(bsp_reg_protect_t regs_to_protect);
+extern void R_BSP_RegisterProtectDisable(bsp_reg_protect_t regs_to_protect);
+extern void R_BSP_PinAccessEnable(void);
+extern void R_BSP_PinAccessDisable(void);
+extern uint32_t R_FSP_SystemClockHzGet(fsp_priv_clock_t clock);
+extern fsp_err_t R_BSP_GroupIrqWrite(bsp_grp_irq_t irq, void (*p_callback)(bsp_grp_irq_t irq));
+
+/* Exported functions --------------------------------------------------------*/
+
+/* 命令バリアはホストではコンパイラバリアとして扱う */
+__STATIC_INLINE void __DSB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+__STATIC_INLINE void __DMB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+__STATIC_INLINE void __ISB(void) { __atomic_signal_fence(__ATOMIC_SEQ_CST); }
+__STATIC_INLINE void __NOP(void) { __asm__ volatile ("nop"); }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BSP_API_H */
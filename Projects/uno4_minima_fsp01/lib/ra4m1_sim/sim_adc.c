@@ -0,0 +1,73 @@
+/**
+  ******************************************************************************
+  * @file           : sim_adc.c
+  * @brief          : RA4M1レジスタモデル ADC0
+  ******************************************************************************
+  * @note   ADC0はELC(ELC_AD00)で起動されたスキャンを即時に完了し、ADANSAの
+  *         各チャネルにチャネル毎の周期の三角波(12bit)を格納してスキャン終了
+  *         イベントを発生させる。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim_local.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define SIM_ADCSR_ADIE		(0x1000)			/* ADCSR.ADIE						*/
+#define SIM_ADC_FULL		(0x0FFF)			/* 変換値の最大(12bit)				*/
+#define SIM_ADC_WAVE_PERIOD	(1000000000ULL)		/* AN000の三角波の周期[ns]			*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static uint16_t sim_adc_sample(uint32_t u32_An, uint64_t u64_Now);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  ELCイベントによるADC0のスキャン
+  * @param  en_Event: ELCイベント番号
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   変換時間は模擬せず、起動と同時にスキャン終了イベントを発生させる
+  */
+void sim_adc_elc(elc_event_t en_Event, uint64_t u64_Now)
+{
+	uint32_t u32_An;
+
+	if (((g_sim_elc.ELCR & SIM_ELC_ELCON) == 0)
+	 || (g_sim_elc.ELSR[ELC_PERIPHERAL_ADC0].HA != (uint16_t)en_Event)
+	 || ((g_sim_adc0.ADCSR & SIM_ADCSR_TRGE) == 0)) {
+		return;
+	}
+	for (u32_An=0; u32_An<32; u32_An++) {
+		if (g_sim_adc0.ADANSA[u32_An / 16] & (1U << (u32_An % 16))) {
+			*(volatile uint16_t *)&g_sim_adc0.ADDR[u32_An] = sim_adc_sample(u32_An, u64_Now);
+		}
+	}
+	if (g_sim_adc0.ADCSR & SIM_ADCSR_ADIE) {
+		simRaiseEvent(ELC_EVENT_ADC0_SCAN_END);
+	}
+}
+
+/**
+  * @brief  アナログ入力の模擬値を求める
+  * @param  u32_An: アナログチャネル(ANxxx)
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval 変換値(12bit)
+  * @note   ANxxxの三角波の周期はSIM_ADC_WAVE_PERIOD/(xxx+1)
+  */
+static uint16_t sim_adc_sample(uint32_t u32_An, uint64_t u64_Now)
+{
+	uint64_t u64_Period = SIM_ADC_WAVE_PERIOD / (u32_An + 1);
+	uint64_t u64_Level = ((u64_Now % u64_Period) * 2 * SIM_ADC_FULL) / u64_Period;
+
+	if (u64_Level > SIM_ADC_FULL) {
+		u64_Level = (2 * SIM_ADC_FULL) - u64_Level;
+	}
+	return (uint16_t)u64_Level;
+}
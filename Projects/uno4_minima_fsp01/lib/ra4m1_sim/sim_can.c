@@ -0,0 +1,799 @@
+/**
+  ******************************************************************************
+  * @file           : sim_can.c
+  * @brief          : RA4M1レジスタモデル CAN0
+  ******************************************************************************
+  * @note   CAN0はFIFOメールボックスモードをフレーム単位(スタッフビットと
+  *         フレーム間スペースを含むbit数)の時間で模擬する。内部ループバックでは
+  *         送信したフレームを自身のフィルターで受信する。バスの相手ノード(-b)が
+  *         無い通常モードではACKエラーで再送を繰り返す(エラーパッシブまで)。
+  *         応答ノード(echo)は受信したフレームをID+1で送り返し、標準ID 0x7FFの
+  *         フレームを受けると次の送信からdata[0][ms]の間バスをドミナントに
+  *         固定する(送信側はビットエラーからバスオフになる)。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim_local.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* CANフレーム(メールボックスの形式) */
+typedef struct {
+	uint32_t u32_id;							/* IDE(31) RTR(30) SID(28:18) EID(17:0)	*/
+	uint8_t u8_dlc;								/* データ長							*/
+	uint8_t u8_data[8];							/* データ							*/
+} SimCanMsg;
+
+/* Private define ------------------------------------------------------------*/
+
+/* CAN0 */
+#define CAN_CTLR_MLM		(0x0008)
+#define CAN_CTLR_CANM		(0x0300)
+#define CAN_CTLR_CANM_HALT	(0x0200)
+#define CAN_CTLR_SLPM		(0x0400)
+#define CAN_CTLR_RBOC		(0x2000)
+#define CAN_CTLR_INIT		(0x0500)			/* リセット後(CANスリープ,CANリセットモード)	*/
+#define CAN_STR_NDST		(0x0001)
+#define CAN_STR_RFST		(0x0004)
+#define CAN_STR_TFST		(0x0008)
+#define CAN_STR_EST			(0x0080)
+#define CAN_STR_RSTST		(0x0100)
+#define CAN_STR_HLTST		(0x0200)
+#define CAN_STR_SLPST		(0x0400)
+#define CAN_STR_EPST		(0x0800)
+#define CAN_STR_BOST		(0x1000)
+#define CAN_STR_TRMST		(0x2000)
+#define CAN_STR_RECST		(0x4000)
+#define CAN_MCTL_NEWDATA	(0x01)
+#define CAN_MCTL_MSGLOST	(0x04)
+#define CAN_MCTL_RECREQ		(0x40)
+#define CAN_MCTL_W0C		(0x05)				/* 0書き込みで解除するbit(NEWDATA/MSGLOST)	*/
+#define CAN_FIFO_RFE		(0x01)				/* RFCR.RFE/TFCR.TFE				*/
+#define CAN_RFCR_RFMLF		(0x10)
+#define CAN_RFCR_RFFST		(0x20)
+#define CAN_RFCR_RFWST		(0x40)
+#define CAN_TFCR_TFFST		(0x40)
+#define CAN_FIFO_EST		(0x80)				/* RFCR.RFEST/TFCR.TFEST			*/
+#define CAN_EI_BE			(0x01)				/* EIER/EIFR						*/
+#define CAN_EI_EW			(0x02)
+#define CAN_EI_EP			(0x04)
+#define CAN_EI_BOE			(0x08)
+#define CAN_EI_BOR			(0x10)
+#define CAN_EI_OR			(0x20)
+#define CAN_ECSR_BE1F		(0x10)				/* ビットエラー(レセシブ)			*/
+#define CAN_ECSR_AEF		(0x04)				/* ACKエラー						*/
+#define CAN_MSSR_SEST		(0x80)
+#define CAN_MIER_TX_FIFO	(0x01000000UL)
+#define CAN_MIER_TX_EMPTY	(0x02000000UL)		/* 送信FIFOが空で割り込み			*/
+#define CAN_MIER_RX_FIFO	(0x10000000UL)
+#define CAN_MIER_RX_WARN	(0x20000000UL)		/* 受信FIFOのバッファワーニングで割り込み	*/
+#define CAN_TCR_MASK		(0x07)
+#define CAN_TCR_LISTEN		(0x03)
+#define CAN_TCR_LOOPBACK	(0x07)
+#define CAN_MB_IDE			(0x80000000UL)
+#define CAN_MB_ID_MASK		(0x1FFFFFFFUL)
+#define CAN_MB_TX_FIFO		(24)
+#define CAN_MB_RX_FIFO		(28)
+#define SIM_CAN_FIFO		(4)					/* 送信/受信FIFOの段数				*/
+#define SIM_CAN_MAILBOXES	(24)				/* 通常のメールボックス数(FIFOモード)	*/
+#define SIM_CAN_PEER_QUEUE	(8)					/* 相手ノードの送信待ち数			*/
+#define SIM_CAN_FAULT_ID	(0x7FFUL << 18)		/* 障害注入(標準ID 0x7FF, data[0]=固定時間[ms])	*/
+#define SIM_CAN_WARNING		(96)				/* エラーワーニングのカウンター値	*/
+#define SIM_CAN_PASSIVE		(128)				/* エラーパッシブのカウンター値		*/
+#define SIM_CAN_BUSOFF		(256)				/* バスオフの送信エラーカウンター値	*/
+#define SIM_CAN_AFTER_ACK	(11)				/* ACKスロット後のbit数(デリミタ,EOF,IFS)	*/
+#define SIM_CAN_ERROR_ACTIVE	(17)			/* エラーフレーム(アクティブ)+IFS[bit]	*/
+#define SIM_CAN_ERROR_PASSIVE	(25)			/* エラーフレーム(パッシブ)+IFS+送信休止[bit]	*/
+#define SIM_CAN_STUCK_FLAG	(14)				/* エラーフラグ後に許容するドミナント[bit]	*/
+#define SIM_CAN_STUCK_STEP	(8)					/* 以降のエラーカウンター加算間隔[bit]	*/
+#define SIM_CAN_RECOVERY	(128 * 11)			/* バスオフ復帰に要するレセシブ[bit]	*/
+#define SIM_CAN_IDLE		(0)					/* バス空き							*/
+#define SIM_CAN_TX			(1)					/* 送信中(ACKあり)					*/
+#define SIM_CAN_TX_NOACK	(2)					/* 送信中(ACKエラーになる)			*/
+#define SIM_CAN_RX			(3)					/* 相手ノードのフレームを受信中		*/
+#define SIM_CAN_ERROR		(4)					/* エラーフレーム/送信休止			*/
+#define SIM_CAN_STUCK		(5)					/* ドミナント固定中の送信			*/
+#define SIM_CAN_OFF			(6)					/* バスオフ(復帰待ち)				*/
+#define SIM_CAN_PEER_NONE	(0)					/* 相手ノード無し					*/
+#define SIM_CAN_PEER_ECHO	(1)					/* 応答ノード						*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* CAN0(u8s_Lockで排他) */
+static uint8_t u8s_CanPeer = SIM_CAN_PEER_NONE;	/* バスの相手ノード(-b)				*/
+static uint16_t u16s_CanCtlr = CAN_CTLR_INIT;		/* CTLR								*/
+static uint8_t u8s_CanMctl[32];						/* MCTL								*/
+static uint8_t u8s_CanRfcr;							/* RFCR(RFE,RFMLF)					*/
+static uint8_t u8s_CanTfcr;							/* TFCR(TFE)						*/
+static SimCanMsg sts_CanTxFifo[SIM_CAN_FIFO];		/* 送信FIFO(先頭が送信中)			*/
+static uint8_t u8s_CanTxNum;
+static SimCanMsg sts_CanRxFifo[SIM_CAN_FIFO];		/* 受信FIFO(先頭がMB[28])			*/
+static uint8_t u8s_CanRxNum;
+static uint8_t u8s_CanEifr;							/* EIFR								*/
+static uint8_t u8s_CanEcsr;							/* ECSR								*/
+static uint16_t u16s_CanTec;						/* 送信エラーカウンター				*/
+static uint8_t u8s_CanRec;							/* 受信エラーカウンター				*/
+static uint8_t u8s_CanBus = SIM_CAN_IDLE;			/* バスの状態(SIM_CAN_xxx)			*/
+static uint64_t u64s_CanNext;						/* 次のイベント時刻[ns](0:無し)		*/
+static SimCanMsg sts_CanPeerQueue[SIM_CAN_PEER_QUEUE];	/* 相手ノードの送信待ち			*/
+static uint8_t u8s_CanPeerHead;
+static uint8_t u8s_CanPeerNum;
+static uint8_t u8s_CanFaultMs;						/* 次の送信で始めるドミナント固定[ms]	*/
+static uint64_t u64s_CanStuckEnd;					/* ドミナント固定の終了時刻[ns]		*/
+static bool bls_CanStuckFirst;						/* ドミナント固定の最初のエラー		*/
+static uint64_t u64s_CanTxFrames;
+static uint64_t u64s_CanRxFrames;
+static uint64_t u64s_CanErrors;
+static uint64_t u64s_CanBusOffs;
+static uint64_t u64s_CanLost;
+static uint64_t u64s_CanPeerFrames;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint64_t sim_can_bit_time(void);
+static uint32_t sim_can_frame_bits(const SimCanMsg *pst_Msg);
+static void sim_can_event(uint64_t u64_Time);
+static void sim_can_kick(uint64_t u64_Now);
+static bool sim_can_match(uint32_t u32_Id, uint32_t u32_Filter, uint32_t u32_Mask);
+static void sim_can_receive(const SimCanMsg *pst_Msg, uint64_t u64_Time);
+static void sim_can_peer(const SimCanMsg *pst_Msg);
+static void sim_can_error(uint8_t u8_Flags, uint8_t u8_Code);
+static void sim_can_tec(int32_t i32_Add, uint64_t u64_Time);
+static void sim_can_recover(void);
+static void sim_can_reset(void);
+static void sim_can_sync(uint64_t u64_Now);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  CAN0の1bitの時間
+  * @param  None
+  * @retval 時間[ns]
+  * @note   (1 + TSEG1 + TSEG2)Tq × (BRP+1) / PCLKB
+  */
+static uint64_t sim_can_bit_time(void)
+{
+	uint32_t u32_Bcr = g_sim_hw->can0.BCR;
+	uint64_t u64_Tq = 1 + ((u32_Bcr >> 28) & 0xF) + 1 + ((u32_Bcr >> 8) & 0x7) + 1;
+	uint64_t u64_Counts = u64_Tq * (((u32_Bcr >> 16) & 0x3FF) + 1);
+	uint64_t u64_Time = (u64_Counts * SIM_NS_PER_SEC) / R_FSP_SystemClockHzGet(FSP_PRIV_CLOCK_PCLKB);
+
+	return (u64_Time > 0) ? u64_Time : 1;
+}
+
+/**
+  * @brief  CANフレームのbit数
+  * @param  pst_Msg: フレーム
+  * @retval SOFからフレーム間スペースまでのbit数
+  * @note   SOF～CRCは実際のビット列からスタッフビットを数える
+  */
+static uint32_t sim_can_frame_bits(const SimCanMsg *pst_Msg)
+{
+	uint8_t u8_Bits[128];
+	uint32_t u32_Num = 0;
+	uint32_t u32_Id = pst_Msg->u32_id;
+	uint32_t u32_Dlc = (pst_Msg->u8_dlc > 8) ? 8 : pst_Msg->u8_dlc;
+	uint32_t u32_Data = (u32_Id & 0x40000000UL) ? 0 : u32_Dlc;
+	uint32_t u32_Stuff = 0;
+	uint32_t u32_Run = 0;
+	uint16_t u16_Crc = 0;
+	uint8_t u8_Last = 2;
+	int32_t _i;
+	uint32_t _j;
+
+#define SIM_CAN_PUT(v, n)	for (_i=(int32_t)(n)-1; _i>=0; _i--) { u8_Bits[u32_Num++] = (uint8_t)(((v) >> _i) & 1); }
+	SIM_CAN_PUT(0, 1);									// SOF
+	SIM_CAN_PUT(u32_Id >> 18, 11);						// SID
+	if (u32_Id & CAN_MB_IDE) {
+		SIM_CAN_PUT(3, 2);								// SRR, IDE
+		SIM_CAN_PUT(u32_Id, 18);						// EID
+		SIM_CAN_PUT(u32_Id >> 30, 1);					// RTR
+		SIM_CAN_PUT(0, 2);								// r1, r0
+	}
+	else {
+		SIM_CAN_PUT(u32_Id >> 30, 1);					// RTR
+		SIM_CAN_PUT(0, 2);								// IDE, r0
+	}
+	SIM_CAN_PUT(u32_Dlc, 4);
+	for (_j=0; _j<u32_Data; _j++) {
+		SIM_CAN_PUT(pst_Msg->u8_data[_j], 8);
+	}
+	for (_j=0; _j<u32_Num; _j++) {
+		/* CRC-15(x^15+x^14+x^10+x^8+x^7+x^4+x^3+1) */
+		uint16_t u16_Next = (uint16_t)(u8_Bits[_j] ^ ((u16_Crc >> 14) & 1));
+		u16_Crc = (uint16_t)((u16_Crc << 1) & 0x7FFF);
+		if (u16_Next) {
+			u16_Crc ^= 0x4599;
+		}
+	}
+	SIM_CAN_PUT(u16_Crc, 15);
+#undef SIM_CAN_PUT
+	/* 同じ値が5bit続いたら反転したbitを挿入する(挿入したbitも次の連続に数える) */
+	for (_j=0; _j<u32_Num; _j++) {
+		if (u8_Bits[_j] == u8_Last) {
+			u32_Run++;
+		}
+		else {
+			u8_Last = u8_Bits[_j];
+			u32_Run = 1;
+		}
+		if (u32_Run == 5) {
+			u32_Stuff++;
+			u8_Last ^= 1;
+			u32_Run = 1;
+		}
+	}
+	/* CRCデリミタ,ACK,ACKデリミタ,EOF(7),IFS(3) */
+	return u32_Num + u32_Stuff + 2 + SIM_CAN_AFTER_ACK;
+}
+
+/**
+  * @brief  CAN0レジスタのアクセス
+  * @param  u32_Member: R_CAN0_Type内のオフセット
+  * @param  bl_Write: 書き込みアクセス
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   EIFR/ECSR/MCTLのフラグは0の書き込みでだけ解除でき、状態を表す
+  *         レジスタは書き込んでもモデルの値に戻す
+  */
+void sim_can_access(size_t u32_Member, bool bl_Write, uint64_t u64_Now)
+{
+	/* 書き込み値はモデルの反映(sim_can_sync)で上書きされる前に取り出す */
+	R_CAN0_Type *pst_Can = &g_sim_hw->can0;
+	uint16_t u16_Ctlr = pst_Can->CTLR;
+	uint8_t u8_Data = ((const volatile uint8_t *)pst_Can)[u32_Member];
+	size_t u32_Mctl = offsetof(R_CAN0_Type, MCTL_RX);
+	SimCanMsg *pst_Msg;
+	bool bl_WasBusOff = (u8s_CanBus == SIM_CAN_OFF);
+
+	sim_can_update(u64_Now);
+	if (!bl_Write) {
+		return;
+	}
+	if ((u32_Member >= u32_Mctl) && (u32_Member < (u32_Mctl + 32))) {
+		u8s_CanMctl[u32_Member - u32_Mctl] = (uint8_t)((u8_Data & (uint8_t)~CAN_MCTL_W0C)
+			| (u8s_CanMctl[u32_Member - u32_Mctl] & u8_Data & CAN_MCTL_W0C));
+	}
+	switch (u32_Member) {
+	case offsetof(R_CAN0_Type, CTLR):
+		u16s_CanCtlr = (uint16_t)(u16_Ctlr & (uint16_t)~CAN_CTLR_RBOC);
+		if ((u16_Ctlr & CAN_CTLR_CANM) == CAN_CTLR_CANM_HALT) {
+			/* 送信中のフレームは送信FIFOに残して中断する */
+			u8s_CanBus = SIM_CAN_IDLE;
+			u64s_CanNext = 0;
+		}
+		else if (u16_Ctlr & CAN_CTLR_CANM) {
+			sim_can_reset();
+		}
+		else if ((u16_Ctlr & CAN_CTLR_RBOC) && bl_WasBusOff) {
+			sim_can_recover();
+		}
+		break;
+	case offsetof(R_CAN0_Type, RFCR):
+		u8s_CanRfcr = (uint8_t)((u8_Data & CAN_FIFO_RFE) | (u8s_CanRfcr & u8_Data & CAN_RFCR_RFMLF));
+		if (!(u8_Data & CAN_FIFO_RFE)) {
+			u8s_CanRxNum = 0;
+		}
+		break;
+	case offsetof(R_CAN0_Type, RFPCR):
+		if (u8s_CanRxNum > 0) {
+			memmove(&sts_CanRxFifo[0], &sts_CanRxFifo[1], sizeof(SimCanMsg) * (SIM_CAN_FIFO - 1));
+			u8s_CanRxNum--;
+		}
+		break;
+	case offsetof(R_CAN0_Type, TFCR):
+		u8s_CanTfcr = u8_Data & CAN_FIFO_RFE;
+		if (!(u8_Data & CAN_FIFO_RFE)) {
+			u8s_CanTxNum = 0;
+			if ((u8s_CanBus == SIM_CAN_TX) || (u8s_CanBus == SIM_CAN_TX_NOACK) || (u8s_CanBus == SIM_CAN_STUCK)) {
+				u8s_CanBus = SIM_CAN_IDLE;
+				u64s_CanNext = 0;
+			}
+		}
+		break;
+	case offsetof(R_CAN0_Type, TFPCR):
+		if ((u8s_CanTfcr & CAN_FIFO_RFE) && (u8s_CanTxNum < SIM_CAN_FIFO)) {
+			pst_Msg = &sts_CanTxFifo[u8s_CanTxNum++];
+			pst_Msg->u32_id = pst_Can->MB[CAN_MB_TX_FIFO].ID;
+			pst_Msg->u8_dlc = (uint8_t)(pst_Can->MB[CAN_MB_TX_FIFO].DL & 0x0F);
+			memcpy(pst_Msg->u8_data, (const void *)pst_Can->MB[CAN_MB_TX_FIFO].D, 8);
+		}
+		break;
+	case offsetof(R_CAN0_Type, EIFR):
+		u8s_CanEifr &= u8_Data;
+		break;
+	case offsetof(R_CAN0_Type, ECSR):
+		u8s_CanEcsr &= u8_Data;
+		break;
+	default:
+		break;
+	}
+	sim_can_kick(u64_Now);
+	sim_can_sync(u64_Now);
+}
+
+/**
+  * @brief  CAN0の時間経過処理
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+void sim_can_update(uint64_t u64_Now)
+{
+	uint64_t u64_Time;
+
+	while ((u64s_CanNext != 0) && (u64_Now >= u64s_CanNext)) {
+		u64_Time = u64s_CanNext;
+		u64s_CanNext = 0;
+		sim_can_event(u64_Time);
+		sim_can_kick(u64_Time);
+	}
+	sim_can_sync(u64_Now);
+}
+
+/**
+  * @brief  CAN0のバスのイベント(フレームの完了,エラー,バスオフ復帰)
+  * @param  u64_Time: 発生時刻[ns]
+  * @retval None
+  */
+static void sim_can_event(uint64_t u64_Time)
+{
+	uint32_t u32_Mier = g_sim_hw->can0.MIER;
+	bool bl_Loop = ((g_sim_hw->can0.TCR & CAN_TCR_MASK) == CAN_TCR_LOOPBACK);
+	SimCanMsg st_Msg;
+
+	switch (u8s_CanBus) {
+	case SIM_CAN_TX:
+		st_Msg = sts_CanTxFifo[0];
+		memmove(&sts_CanTxFifo[0], &sts_CanTxFifo[1], sizeof(SimCanMsg) * (SIM_CAN_FIFO - 1));
+		u8s_CanTxNum--;
+		u64s_CanTxFrames++;
+		sim_can_tec(-1, u64_Time);
+		u8s_CanBus = SIM_CAN_IDLE;
+		if ((u32_Mier & CAN_MIER_TX_FIFO) && (!(u32_Mier & CAN_MIER_TX_EMPTY) || (u8s_CanTxNum == 0))) {
+			simRaiseEvent(ELC_EVENT_CAN0_FIFO_TX);
+		}
+		if (bl_Loop) {
+			sim_can_receive(&st_Msg, u64_Time);
+		}
+		else {
+			sim_can_peer(&st_Msg);
+		}
+		break;
+	case SIM_CAN_TX_NOACK:
+		/* エラーパッシブの送信ノードはACKエラーで送信エラーカウンターを増やさない */
+		u64s_CanErrors++;
+		sim_can_error(CAN_EI_BE, CAN_ECSR_AEF);
+		if (u16s_CanTec < SIM_CAN_PASSIVE) {
+			sim_can_tec(8, u64_Time);
+		}
+		u8s_CanBus = SIM_CAN_ERROR;
+		u64s_CanNext = u64_Time + sim_can_bit_time()
+			* ((u16s_CanTec < SIM_CAN_PASSIVE) ? SIM_CAN_ERROR_ACTIVE : SIM_CAN_ERROR_PASSIVE);
+		break;
+	case SIM_CAN_STUCK:
+		/* 最初はビットエラー、以降はドミナントが続く間8bit毎に加算する */
+		if (bls_CanStuckFirst) {
+			bls_CanStuckFirst = false;
+			u64s_CanErrors++;
+			sim_can_error(CAN_EI_BE, CAN_ECSR_BE1F);
+		}
+		sim_can_tec(8, u64_Time);
+		if (u8s_CanBus == SIM_CAN_OFF) {
+			break;
+		}
+		if (u64_Time >= u64s_CanStuckEnd) {
+			u8s_CanBus = SIM_CAN_ERROR;
+			u64s_CanNext = u64_Time + (sim_can_bit_time() * SIM_CAN_ERROR_ACTIVE);
+		}
+		else {
+			u64s_CanNext = u64_Time + (sim_can_bit_time() * SIM_CAN_STUCK_STEP);
+		}
+		break;
+	case SIM_CAN_RX:
+		st_Msg = sts_CanPeerQueue[u8s_CanPeerHead];
+		u8s_CanPeerHead = (uint8_t)((u8s_CanPeerHead + 1) % SIM_CAN_PEER_QUEUE);
+		u8s_CanPeerNum--;
+		if (u8s_CanRec > 0) {
+			u8s_CanRec--;
+		}
+		u8s_CanBus = SIM_CAN_IDLE;
+		sim_can_receive(&st_Msg, u64_Time);
+		break;
+	case SIM_CAN_OFF:
+		sim_can_recover();
+		break;
+	default:
+		u8s_CanBus = SIM_CAN_IDLE;
+		break;
+	}
+}
+
+/**
+  * @brief  バスが空いていれば次のフレームを開始する
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   自ノードと相手ノードの両方に送信待ちがあればIDの小さい方が
+  *         調停に勝つ(標準IDは同じベースIDの拡張IDより優先)
+  */
+static void sim_can_kick(uint64_t u64_Now)
+{
+	uint8_t u8_Test = g_sim_hw->can0.TCR & CAN_TCR_MASK;
+	bool bl_Loop = (u8_Test == CAN_TCR_LOOPBACK);
+	bool bl_Own;
+	bool bl_Peer;
+	uint64_t u64_Own;
+	uint64_t u64_Peer;
+	const SimCanMsg *pst_Msg;
+
+	if ((u8s_CanBus != SIM_CAN_IDLE) || (u16s_CanCtlr & (CAN_CTLR_CANM | CAN_CTLR_SLPM))) {
+		return;
+	}
+	bl_Own = (u8s_CanTfcr & CAN_FIFO_RFE) && (u8s_CanTxNum > 0) && (u8_Test != CAN_TCR_LISTEN);
+	bl_Peer = !bl_Loop && (u8s_CanPeerNum > 0);
+	if (bl_Own && bl_Peer) {
+		/* 調停: ベースID,IDE,拡張IDの順に比較する */
+		pst_Msg = &sts_CanTxFifo[0];
+		u64_Own = ((uint64_t)((pst_Msg->u32_id >> 18) & 0x7FF) << 19)
+			| ((pst_Msg->u32_id & CAN_MB_IDE) ? ((1ULL << 18) | (pst_Msg->u32_id & 0x3FFFF)) : 0);
+		pst_Msg = &sts_CanPeerQueue[u8s_CanPeerHead];
+		u64_Peer = ((uint64_t)((pst_Msg->u32_id >> 18) & 0x7FF) << 19)
+			| ((pst_Msg->u32_id & CAN_MB_IDE) ? ((1ULL << 18) | (pst_Msg->u32_id & 0x3FFFF)) : 0);
+		bl_Own = (u64_Own <= u64_Peer);
+	}
+	if (bl_Own) {
+		if (!bl_Loop && ((u8s_CanFaultMs > 0) || (u64_Now < u64s_CanStuckEnd))) {
+			/* 相手ノードがバスをドミナントに固定している */
+			if (u8s_CanFaultMs > 0) {
+				u64s_CanStuckEnd = u64_Now + ((uint64_t)u8s_CanFaultMs * 1000000ULL);
+				u8s_CanFaultMs = 0;
+			}
+			bls_CanStuckFirst = true;
+			u8s_CanBus = SIM_CAN_STUCK;
+			u64s_CanNext = u64_Now + (sim_can_bit_time() * SIM_CAN_STUCK_FLAG);
+		}
+		else if (bl_Loop || (u8s_CanPeer != SIM_CAN_PEER_NONE)) {
+			u8s_CanBus = SIM_CAN_TX;
+			u64s_CanNext = u64_Now + (sim_can_bit_time() * sim_can_frame_bits(&sts_CanTxFifo[0]));
+		}
+		else {
+			/* ACKを返すノードが無い */
+			u8s_CanBus = SIM_CAN_TX_NOACK;
+			u64s_CanNext = u64_Now + (sim_can_bit_time() * (sim_can_frame_bits(&sts_CanTxFifo[0]) - SIM_CAN_AFTER_ACK));
+		}
+	}
+	else if (bl_Peer) {
+		u8s_CanBus = SIM_CAN_RX;
+		u64s_CanNext = u64_Now + (sim_can_bit_time() * sim_can_frame_bits(&sts_CanPeerQueue[u8s_CanPeerHead]));
+	}
+}
+
+/**
+  * @brief  アクセプタンスフィルターの判定
+  * @param  u32_Id: 受信したID(メールボックスの形式)
+  * @param  u32_Filter: メールボックス/FIDCRのID
+  * @param  u32_Mask: MKR(1のbitを比較する)
+  * @retval 一致した
+  * @note   ID混在モードではIDE(標準/拡張)も一致すること
+  */
+static bool sim_can_match(uint32_t u32_Id, uint32_t u32_Filter, uint32_t u32_Mask)
+{
+	if ((u32_Id ^ u32_Filter) & CAN_MB_IDE) {
+		return false;
+	}
+	return (((u32_Id ^ u32_Filter) & u32_Mask & CAN_MB_ID_MASK) == 0);
+}
+
+/**
+  * @brief  フレームを受信する
+  * @param  pst_Msg: フレーム
+  * @param  u64_Time: 受信完了時刻[ns]
+  * @retval None
+  * @note   受信メールボックス(番号順)、受信FIFOの順にフィルターを判定する
+  */
+static void sim_can_receive(const SimCanMsg *pst_Msg, uint64_t u64_Time)
+{
+	R_CAN0_Type *pst_Can = &g_sim_hw->can0;
+	uint32_t u32_Mier = pst_Can->MIER;
+	uint32_t u32_Mask;
+	uint16_t u16_Stamp = (uint16_t)(u64_Time / sim_can_bit_time());
+	uint32_t _i;
+
+	for (_i=0; _i<SIM_CAN_MAILBOXES; _i++) {
+		if (!(u8s_CanMctl[_i] & CAN_MCTL_RECREQ)) {
+			continue;
+		}
+		u32_Mask = (pst_Can->MKIVLR & (1UL << _i)) ? CAN_MB_ID_MASK : pst_Can->MKR[_i / 4];
+		if (!sim_can_match(pst_Msg->u32_id, pst_Can->MB[_i].ID, u32_Mask)) {
+			continue;
+		}
+		u64s_CanRxFrames++;
+		if (u8s_CanMctl[_i] & CAN_MCTL_NEWDATA) {
+			u8s_CanMctl[_i] |= CAN_MCTL_MSGLOST;
+			u64s_CanLost++;
+			if (u16s_CanCtlr & CAN_CTLR_MLM) {
+				return;									// オーバーランモード: 新しいメッセージを捨てる
+			}
+		}
+		pst_Can->MB[_i].ID = pst_Msg->u32_id;
+		pst_Can->MB[_i].DL = pst_Msg->u8_dlc;
+		memcpy((void *)pst_Can->MB[_i].D, pst_Msg->u8_data, 8);
+		pst_Can->MB[_i].TS = u16_Stamp;
+		u8s_CanMctl[_i] |= CAN_MCTL_NEWDATA;
+		if (u32_Mier & (1UL << _i)) {
+			simRaiseEvent(ELC_EVENT_CAN0_MAILBOX_RX);
+		}
+		return;
+	}
+	if (!(u8s_CanRfcr & CAN_FIFO_RFE)
+	 || (!sim_can_match(pst_Msg->u32_id, pst_Can->FIDCR[0], pst_Can->MKR[6])
+	  && !sim_can_match(pst_Msg->u32_id, pst_Can->FIDCR[1], pst_Can->MKR[7]))) {
+		return;
+	}
+	u64s_CanRxFrames++;
+	if (u8s_CanRxNum >= SIM_CAN_FIFO) {
+		u8s_CanRfcr |= CAN_RFCR_RFMLF;
+		u64s_CanLost++;
+		return;
+	}
+	sts_CanRxFifo[u8s_CanRxNum++] = *pst_Msg;
+	g_sim_hw->can0.MB[CAN_MB_RX_FIFO + u8s_CanRxNum - 1].TS = u16_Stamp;
+	if ((u32_Mier & CAN_MIER_RX_FIFO) && (!(u32_Mier & CAN_MIER_RX_WARN) || (u8s_CanRxNum == 3))) {
+		simRaiseEvent(ELC_EVENT_CAN0_FIFO_RX);
+	}
+}
+
+/**
+  * @brief  相手ノードがフレームを受信する
+  * @param  pst_Msg: フレーム
+  * @retval None
+  * @note   応答ノードはIDを+1して同じデータを送り返す。障害注入のフレームには
+  *         応答せず、次の送信からバスをドミナントに固定する
+  */
+static void sim_can_peer(const SimCanMsg *pst_Msg)
+{
+	SimCanMsg *pst_Reply;
+
+	if (u8s_CanPeer != SIM_CAN_PEER_ECHO) {
+		return;
+	}
+	u64s_CanPeerFrames++;
+	if ((pst_Msg->u32_id & (CAN_MB_IDE | CAN_MB_ID_MASK)) == SIM_CAN_FAULT_ID) {
+		if (pst_Msg->u8_dlc > 0) {
+			u8s_CanFaultMs = pst_Msg->u8_data[0];
+		}
+		return;
+	}
+	if (u8s_CanPeerNum >= SIM_CAN_PEER_QUEUE) {
+		return;
+	}
+	pst_Reply = &sts_CanPeerQueue[(u8s_CanPeerHead + u8s_CanPeerNum) % SIM_CAN_PEER_QUEUE];
+	*pst_Reply = *pst_Msg;
+	if (pst_Msg->u32_id & CAN_MB_IDE) {
+		pst_Reply->u32_id = CAN_MB_IDE | ((pst_Msg->u32_id + 1) & CAN_MB_ID_MASK);
+	}
+	else {
+		pst_Reply->u32_id = (pst_Msg->u32_id & 0x40000000UL) | ((pst_Msg->u32_id + (1UL << 18)) & (0x7FFUL << 18));
+	}
+	u8s_CanPeerNum++;
+}
+
+/**
+  * @brief  エラー割り込み要因を記録する
+  * @param  u8_Flags: EIFRのbit
+  * @param  u8_Code: ECSRのbit
+  * @retval None
+  */
+static void sim_can_error(uint8_t u8_Flags, uint8_t u8_Code)
+{
+	u8s_CanEifr |= u8_Flags;
+	u8s_CanEcsr |= u8_Code;
+	if (u8_Flags & g_sim_hw->can0.EIER) {
+		simRaiseEvent(ELC_EVENT_CAN0_ERROR);
+	}
+}
+
+/**
+  * @brief  送信エラーカウンターを更新する
+  * @param  i32_Add: 加算値(-1:送信成功)
+  * @param  u64_Time: 発生時刻[ns]
+  * @retval None
+  * @note   エラーワーニング/エラーパッシブ/バスオフへの遷移で割り込み要因を
+  *         記録する。バスオフはドミナント固定の解除後に128×11bitで復帰する
+  */
+static void sim_can_tec(int32_t i32_Add, uint64_t u64_Time)
+{
+	uint16_t u16_Old = u16s_CanTec;
+	uint8_t u8_Flags = 0;
+	uint64_t u64_Free;
+
+	if (i32_Add < 0) {
+		if (u16s_CanTec > 0) {
+			u16s_CanTec--;
+		}
+		return;
+	}
+	u16s_CanTec = (uint16_t)(u16s_CanTec + (uint16_t)i32_Add);
+	if ((u16_Old < SIM_CAN_WARNING) && (u16s_CanTec >= SIM_CAN_WARNING)) {
+		u8_Flags |= CAN_EI_EW;
+	}
+	if ((u16_Old < SIM_CAN_PASSIVE) && (u16s_CanTec >= SIM_CAN_PASSIVE)) {
+		u8_Flags |= CAN_EI_EP;
+	}
+	if (u16s_CanTec >= SIM_CAN_BUSOFF) {
+		u8_Flags |= CAN_EI_BOE;
+		u64s_CanBusOffs++;
+		u8s_CanBus = SIM_CAN_OFF;
+		u64_Free = (u64_Time > u64s_CanStuckEnd) ? u64_Time : u64s_CanStuckEnd;
+		u64s_CanNext = u64_Free + (sim_can_bit_time() * SIM_CAN_RECOVERY);
+	}
+	if (u8_Flags != 0) {
+		sim_can_error(u8_Flags, 0);
+	}
+}
+
+/**
+  * @brief  バスオフから復帰する(エラーアクティブ)
+  * @param  None
+  * @retval None
+  */
+static void sim_can_recover(void)
+{
+	u16s_CanTec = 0;
+	u8s_CanRec = 0;
+	u8s_CanBus = SIM_CAN_IDLE;
+	u64s_CanNext = 0;
+	sim_can_error(CAN_EI_BOR, 0);
+}
+
+/**
+  * @brief  CANリセットモードへの遷移
+  * @param  None
+  * @retval None
+  * @note   FIFO,MCTL,エラー状態とカウンターを初期化し、バスから外れる
+  */
+static void sim_can_reset(void)
+{
+	memset(u8s_CanMctl, 0, sizeof(u8s_CanMctl));
+	u8s_CanRfcr = 0;
+	u8s_CanTfcr = 0;
+	u8s_CanTxNum = 0;
+	u8s_CanRxNum = 0;
+	u8s_CanEifr = 0;
+	u8s_CanEcsr = 0;
+	u16s_CanTec = 0;
+	u8s_CanRec = 0;
+	u8s_CanBus = SIM_CAN_IDLE;
+	u64s_CanNext = 0;
+	u8s_CanFaultMs = 0;
+	u64s_CanStuckEnd = 0;
+}
+
+/**
+  * @brief  モデルの値をレジスタに反映する
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+static void sim_can_sync(uint64_t u64_Now)
+{
+	R_CAN0_Type *pst_Can = &g_sim_hw->can0;
+	uint16_t u16_Str = 0;
+	uint8_t u8_Search = CAN_MSSR_SEST;
+	uint32_t _i;
+
+	for (_i=0; _i<32; _i++) {
+		pst_Can->MCTL_RX[_i] = u8s_CanMctl[_i];
+	}
+	for (_i=0; _i<SIM_CAN_MAILBOXES; _i++) {
+		if ((u8s_CanMctl[_i] & (CAN_MCTL_RECREQ | CAN_MCTL_NEWDATA)) == (CAN_MCTL_RECREQ | CAN_MCTL_NEWDATA)) {
+			u16_Str |= CAN_STR_NDST;
+			if ((u8_Search == CAN_MSSR_SEST) && (pst_Can->MSMR == 0)) {
+				u8_Search = (uint8_t)_i;
+			}
+		}
+	}
+	if (u8s_CanRxNum > 0) {
+		u16_Str |= CAN_STR_RFST;
+		pst_Can->MB[CAN_MB_RX_FIFO].ID = sts_CanRxFifo[0].u32_id;
+		pst_Can->MB[CAN_MB_RX_FIFO].DL = sts_CanRxFifo[0].u8_dlc;
+		memcpy((void *)pst_Can->MB[CAN_MB_RX_FIFO].D, sts_CanRxFifo[0].u8_data, 8);
+	}
+	if (u8s_CanTxNum > 0) {
+		u16_Str |= CAN_STR_TFST;
+	}
+	if (u8s_CanEifr != 0) {
+		u16_Str |= CAN_STR_EST;
+	}
+	if (u16s_CanCtlr & CAN_CTLR_SLPM) {
+		u16_Str |= CAN_STR_SLPST;
+	}
+	if ((u16s_CanCtlr & CAN_CTLR_CANM) == CAN_CTLR_CANM_HALT) {
+		u16_Str |= CAN_STR_HLTST;
+	}
+	else if (u16s_CanCtlr & CAN_CTLR_CANM) {
+		u16_Str |= CAN_STR_RSTST;
+	}
+	if ((u16s_CanTec >= SIM_CAN_PASSIVE) || (u8s_CanRec >= SIM_CAN_PASSIVE)) {
+		u16_Str |= CAN_STR_EPST;
+	}
+	if (u8s_CanBus == SIM_CAN_OFF) {
+		u16_Str |= CAN_STR_BOST;
+	}
+	else if ((u8s_CanBus == SIM_CAN_TX) || (u8s_CanBus == SIM_CAN_TX_NOACK) || (u8s_CanBus == SIM_CAN_STUCK)) {
+		u16_Str |= CAN_STR_TRMST;
+	}
+	else if (u8s_CanBus == SIM_CAN_RX) {
+		u16_Str |= CAN_STR_RECST;
+	}
+	pst_Can->CTLR = u16s_CanCtlr;
+	*(volatile uint16_t *)&pst_Can->STR = u16_Str;
+	pst_Can->RFCR = (uint8_t)(u8s_CanRfcr | (uint8_t)(u8s_CanRxNum << 1)
+		| ((u8s_CanRxNum >= SIM_CAN_FIFO) ? CAN_RFCR_RFFST : 0) | ((u8s_CanRxNum >= 3) ? CAN_RFCR_RFWST : 0)
+		| ((u8s_CanRxNum == 0) ? CAN_FIFO_EST : 0));
+	pst_Can->TFCR = (uint8_t)(u8s_CanTfcr | (uint8_t)(u8s_CanTxNum << 1)
+		| ((u8s_CanTxNum >= SIM_CAN_FIFO) ? CAN_TFCR_TFFST : 0) | ((u8s_CanTxNum == 0) ? CAN_FIFO_EST : 0));
+	pst_Can->EIFR = u8s_CanEifr;
+	pst_Can->ECSR = u8s_CanEcsr;
+	*(volatile uint8_t *)&pst_Can->RECR = u8s_CanRec;
+	*(volatile uint8_t *)&pst_Can->TECR = (uint8_t)((u16s_CanTec > 255) ? 255 : u16s_CanTec);
+	*(volatile uint8_t *)&pst_Can->MSSR = u8_Search;
+	*(volatile uint16_t *)&pst_Can->TSR = (uint16_t)(u64_Now / sim_can_bit_time());
+}
+
+/**
+  * @brief  CAN0のレジスタ初期値を設定する
+  * @param  None
+  * @retval None
+  */
+void sim_can_init(void)
+{
+	sim_can_reset();
+	sim_can_sync(0);
+}
+
+/**
+  * @brief  CANバスの相手ノードを設定する
+  * @param  pc_Name: none:無し, echo:応答ノード
+  * @retval true:成功 false:不明な相手ノード
+  */
+bool sim_can_set_peer(const char *pc_Name)
+{
+	if (strcmp(pc_Name, "echo") == 0) {
+		u8s_CanPeer = SIM_CAN_PEER_ECHO;
+	}
+	else if (strcmp(pc_Name, "none") == 0) {
+		u8s_CanPeer = SIM_CAN_PEER_NONE;
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+/**
+  * @brief  CAN0の次のイベント時刻を反映する
+  * @param  pu64_Next: 次のイベント時刻[ns](より早ければ更新する)
+  * @retval None
+  */
+void sim_can_schedule(uint64_t *pu64_Next)
+{
+	if ((u64s_CanNext != 0) && (u64s_CanNext < *pu64_Next)) {
+		*pu64_Next = u64s_CanNext;
+	}
+}
+
+/**
+  * @brief  CAN0の統計を出力する
+  * @param  None
+  * @retval None
+  */
+void sim_can_report(void)
+{
+	if ((u64s_CanTxFrames > 0) || (u64s_CanErrors > 0)) {
+		fprintf(stderr, "[sim] CAN0 tx %llu, rx %llu, errors %llu, bus-off %llu, lost %llu, peer rx %llu\n",
+			(unsigned long long)u64s_CanTxFrames, (unsigned long long)u64s_CanRxFrames,
+			(unsigned long long)u64s_CanErrors, (unsigned long long)u64s_CanBusOffs,
+			(unsigned long long)u64s_CanLost, (unsigned long long)u64s_CanPeerFrames);
+	}
+}
@@ -0,0 +1,530 @@
+/**
+  ******************************************************************************
+  * @file           : sim_clock.c
+  * @brief          : RA4M1レジスタモデル SysTick/DWT/クロック発生回路
+  ******************************************************************************
+  * @note   クロックはSCKSCR/SCKDIVCRからICLK/PCLKx/FCLKを求め、変更時は
+  *         DWT/SysTickの計数,SCI1のビット時間,GPTの周期を新しいクロックで
+  *         続ける。書き込みプロテクト(PRCR),MOCOの発振安定時間,動作電力モード
+  *         の遷移(OPCCR.OPCMTSF),メモリウェイト,フラッシュキャッシュ無効中の
+  *         変更といった手順の誤りは違反として記録する。動作電力モード(OPCM)の
+  *         上限を超えるICLKは動作保証外のため、記録して終了コード4で終了する。
+  *         CPUの実行時間はホストで決まるため、ICLKを下げても処理時間は延びない。
+  *         他のモデルはクロック周波数をR_FSP_SystemClockHzGet()で取得する。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim_local.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* クロック */
+#define SIM_HOCO_HZ			(48000000UL)		/* HOCO周波数[Hz]					*/
+#define SIM_MOCO_HZ			(8000000UL)			/* MOCO周波数[Hz]					*/
+#define SIM_LOCO_HZ			(32768UL)			/* LOCO周波数[Hz]					*/
+#define SIM_MOCO_WAIT		(15000)				/* MOCO発振安定時間[ns]				*/
+#define SIM_OPCM_TRANSITION	(5000)				/* 動作電力モードの遷移時間[ns]		*/
+#define SIM_MEMWAIT_HZ		(32000000UL)		/* MEMWAIT=0で動作できるICLK上限[Hz]	*/
+#define SIM_PCLKB_MAX		(32000000UL)		/* PCLKB上限[Hz]					*/
+#define SIM_FCLK_MAX		(32000000UL)		/* FCLK上限[Hz]						*/
+#define SIM_OPCM_HIGH_MAX	(48000000UL)		/* 高速モードのICLK上限[Hz]			*/
+#define SIM_OPCM_MIDDLE_MAX	(12000000UL)		/* 中速モードのICLK上限[Hz]			*/
+#define SIM_OPCM_LOWV_MAX	(4000000UL)			/* 低電圧モードのICLK上限[Hz]		*/
+#define SIM_OPCM_LOW_MAX	(1000000UL)			/* 低速モードのICLK上限[Hz]			*/
+#define SYS_SCKSCR_HOCO		(0)
+#define SYS_SCKSCR_MOCO		(1)
+#define SYS_SCKSCR_LOCO		(2)
+#define SYS_PRCR_KEY		(0xA500)
+#define SYS_PRCR_PRC0		(0x01)				/* クロック発生回路					*/
+#define SYS_PRCR_PRC1		(0x02)				/* 動作電力モード等					*/
+#define SYS_PRCR_PRC3		(0x08)				/* LVD								*/
+#define SYS_OPCCR_OPCM		(0x03)
+#define SYS_OPCCR_OPCMTSF	(0x10)
+#define SYS_OPCM_HIGH		(0)					/* 高速モード						*/
+#define SYS_OPCM_MIDDLE		(1)					/* 中速モード						*/
+#define SYS_OPCM_LOWV		(2)					/* 低電圧モード						*/
+#define SYS_OPCM_LOW		(3)					/* 低速モード						*/
+#define SIM_EXIT_CLOCK		(4)					/* 動作電力モード違反の終了コード	*/
+#define SYS_OSCSF_HOCOSF	(0x01)
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* クロック */
+static uint32_t u32s_CycleBase;						/* DWT CYCCNTの基準					*/
+static uint64_t u64s_CycleEpoch;					/* ICLK変更時の仮想時間[ns]			*/
+static uint64_t u64s_CycleAtEpoch;					/* ICLK変更時のCPUクロック数		*/
+static uint32_t u32s_ClockHz[FSP_PRIV_CLOCK_FCLK + 1];	/* クロック周波数[Hz]			*/
+static R_SYSTEM_Type sts_SysAccepted;				/* 受け付けたクロック設定			*/
+static uint8_t u8s_ProtectCount[BSP_REG_PROTECT_SAR + 1];	/* 書き込みプロテクト解除の入れ子数	*/
+static uint64_t u64s_MocoReady;						/* MOCO発振安定の時刻[ns]			*/
+static uint64_t u64s_OpccrEnd;						/* 動作電力モード遷移完了の時刻[ns]	*/
+static uint64_t u64s_ClockChanges;					/* クロック変更回数					*/
+static uint64_t u64s_ClockViolations;				/* 手順違反の回数					*/
+
+/* SysTick(sim_lock()で排他) */
+static bool bls_SysTickRun;
+static uint64_t u64s_SysTickPeriod;
+static uint64_t u64s_SysTickNext;
+static uint64_t u64s_SysTickLast;
+
+/* Private function prototypes -----------------------------------------------*/
+static void sim_systick_config(uint64_t u64_Now, bool bl_Restart);
+static uint64_t sim_cpu_cycles(uint64_t u64_Now);
+static void sim_clock_update(void);
+static void sim_clock_change(uint64_t u64_Now);
+static void sim_clock_violation(const char *pc_Reason);
+static void sim_clock_check(void);
+static void sim_system_write(size_t u32_Member, uint64_t u64_Now);
+
+/* Exported functions --------------------------------------------------------*/
+
+/* CMSIS互換関数 -------------------------------------------------------------*/
+
+/**
+  * @brief  SystemCoreClockを更新する
+  * @param  None
+  * @retval None
+  */
+void SystemCoreClockUpdate(void)
+{
+	SystemCoreClock = u32s_ClockHz[FSP_PRIV_CLOCK_ICLK];
+}
+
+/* FSP互換関数 ---------------------------------------------------------------*/
+
+/**
+  * @brief  レジスタ書き込み保護有効
+  * @param  regs_to_protect: 保護対象
+  * @retval None
+  */
+void R_BSP_RegisterProtectEnable(bsp_reg_protect_t regs_to_protect)
+{
+	static const uint8_t cu8_Bits[] = {SYS_PRCR_PRC0, SYS_PRCR_PRC1, SYS_PRCR_PRC3, 0};
+
+	if (u8s_ProtectCount[regs_to_protect] > 0) {
+		u8s_ProtectCount[regs_to_protect]--;
+		if (u8s_ProtectCount[regs_to_protect] == 0) {
+			R_SYSTEM->PRCR = (uint16_t)(SYS_PRCR_KEY | (R_SYSTEM->PRCR & (uint8_t)~cu8_Bits[regs_to_protect]));
+		}
+	}
+}
+
+/**
+  * @brief  レジスタ書き込み保護解除
+  * @param  regs_to_protect: 保護対象
+  * @retval None
+  */
+void R_BSP_RegisterProtectDisable(bsp_reg_protect_t regs_to_protect)
+{
+	static const uint8_t cu8_Bits[] = {SYS_PRCR_PRC0, SYS_PRCR_PRC1, SYS_PRCR_PRC3, 0};
+
+	if (u8s_ProtectCount[regs_to_protect] == 0) {
+		R_SYSTEM->PRCR = (uint16_t)(SYS_PRCR_KEY | (R_SYSTEM->PRCR & 0xFF) | cu8_Bits[regs_to_protect]);
+	}
+	u8s_ProtectCount[regs_to_protect]++;
+}
+
+/**
+  * @brief  クロック周波数取得
+  * @param  clock: 対象クロック
+  * @retval 周波数[Hz]
+  */
+uint32_t R_FSP_SystemClockHzGet(fsp_priv_clock_t clock)
+{
+	return u32s_ClockHz[clock];
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  SysTick設定変更
+  * @param  u64_Now: 仮想時間[ns]
+  * @param  bl_Restart: カウンター再スタート(VAL書き込み)
+  * @retval None
+  */
+static void sim_systick_config(uint64_t u64_Now, bool bl_Restart)
+{
+	uint32_t u32_Ctrl = g_sim_hw->systick.CTRL;
+
+	if (bl_Restart) {
+		g_sim_hw->systick.VAL = 0;
+		g_sim_hw->systick.CTRL &= ~SysTick_CTRL_COUNTFLAG_Msk;
+	}
+	u64s_SysTickPeriod = (((uint64_t)(g_sim_hw->systick.LOAD & SysTick_LOAD_RELOAD_Msk) + 1) * SIM_NS_PER_SEC) / u32s_ClockHz[FSP_PRIV_CLOCK_ICLK];
+	if (u32_Ctrl & SysTick_CTRL_ENABLE_Msk) {
+		if (!bls_SysTickRun || bl_Restart) {
+			u64s_SysTickLast = u64_Now;
+			u64s_SysTickNext = u64_Now + u64s_SysTickPeriod;
+		}
+		if (!bls_SysTickRun) {
+			sim_fw_timer_request();
+		}
+		bls_SysTickRun = true;
+	}
+	else {
+		bls_SysTickRun = false;
+	}
+}
+
+/**
+  * @brief  SysTickの時間経過処理
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+void sim_systick_update(uint64_t u64_Now)
+{
+	while (bls_SysTickRun && (u64_Now >= u64s_SysTickNext)) {
+		g_sim_hw->systick.CTRL |= SysTick_CTRL_COUNTFLAG_Msk;
+		u64s_SysTickLast = u64s_SysTickNext;
+		u64s_SysTickNext += u64s_SysTickPeriod;
+		if (g_sim_hw->systick.CTRL & SysTick_CTRL_TICKINT_Msk) {
+			sim_raise_irq(SIM_IRQ_SYSTICK, u64s_SysTickLast);
+		}
+	}
+}
+
+/**
+  * @brief  仮想時間をCPUクロック数に換算する
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval CPUクロック数(起動からの累計)
+  * @note   ICLKの変更時点を基準に、変更後のICLKで数える
+  */
+static uint64_t sim_cpu_cycles(uint64_t u64_Now)
+{
+	uint64_t u64_Elapsed = (u64_Now > u64s_CycleEpoch) ? (u64_Now - u64s_CycleEpoch) : 0;
+	uint64_t u64_Hz = u32s_ClockHz[FSP_PRIV_CLOCK_ICLK];
+
+	return u64s_CycleAtEpoch + ((u64_Elapsed / SIM_NS_PER_SEC) * u64_Hz)
+		+ (((u64_Elapsed % SIM_NS_PER_SEC) * u64_Hz) / SIM_NS_PER_SEC);
+}
+
+/**
+  * @brief  クロック周波数を求める
+  * @param  None
+  * @retval None
+  * @note   SCKDIVCRの各フィールド(3bit)は分周比 1/2^n
+  */
+static void sim_clock_update(void)
+{
+	static const uint8_t cu8_Shift[FSP_PRIV_CLOCK_FCLK + 1] = {0, 4, 8, 12, 16, 24, 28};
+	uint32_t u32_Source;
+	uint32_t _i;
+
+	switch (sts_SysAccepted.SCKSCR) {
+	case SYS_SCKSCR_MOCO:
+		u32_Source = SIM_MOCO_HZ;
+		break;
+	case SYS_SCKSCR_LOCO:
+		u32_Source = SIM_LOCO_HZ;
+		break;
+	default:
+		u32_Source = SIM_HOCO_HZ;
+		break;
+	}
+	for (_i=0; _i<=FSP_PRIV_CLOCK_FCLK; _i++) {
+		u32s_ClockHz[_i] = u32_Source >> ((sts_SysAccepted.SCKDIVCR >> cu8_Shift[_i]) & 0x07);
+	}
+}
+
+/**
+  * @brief  クロック変更
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   DWTは変更時点までを旧クロックで数え、SysTickは残りのカウント数を
+  *         新しいクロックで数え直す
+  */
+static void sim_clock_change(uint64_t u64_Now)
+{
+	uint64_t u64_OldHz = u32s_ClockHz[FSP_PRIV_CLOCK_ICLK];
+	uint64_t u64_Remain;
+
+	u64s_CycleAtEpoch = sim_cpu_cycles(u64_Now);
+	u64s_CycleEpoch = u64_Now;
+	sim_clock_update();
+	if (bls_SysTickRun) {
+		u64_Remain = (u64s_SysTickNext > u64_Now) ? (u64s_SysTickNext - u64_Now) : 0;
+		u64_Remain = (((u64_Remain * u64_OldHz) / SIM_NS_PER_SEC) * SIM_NS_PER_SEC) / u32s_ClockHz[FSP_PRIV_CLOCK_ICLK];
+		u64s_SysTickPeriod = (((uint64_t)(g_sim_hw->systick.LOAD & SysTick_LOAD_RELOAD_Msk) + 1) * SIM_NS_PER_SEC) / u32s_ClockHz[FSP_PRIV_CLOCK_ICLK];
+		u64s_SysTickNext = u64_Now + u64_Remain;
+		u64s_SysTickLast = (u64s_SysTickNext > u64s_SysTickPeriod) ? (u64s_SysTickNext - u64s_SysTickPeriod) : 0;
+	}
+	sim_sci_config();
+	sim_esp_config();
+	u64s_ClockChanges++;
+	if (g_sim_verbose) {
+		sim_log("%10.3f ms ICLK %lu Hz, PCLKA %lu Hz", (double)u64_Now / 1000000.0,
+			(unsigned long)u32s_ClockHz[FSP_PRIV_CLOCK_ICLK], (unsigned long)u32s_ClockHz[FSP_PRIV_CLOCK_PCLKA]);
+	}
+}
+
+/**
+  * @brief  クロック設定の手順違反を記録する
+  * @param  pc_Reason: 内容
+  * @retval None
+  */
+static void sim_clock_violation(const char *pc_Reason)
+{
+	u64s_ClockViolations++;
+	sim_log("clock violation: %s", pc_Reason);
+}
+
+/**
+  * @brief  クロック設定の制約を確認する
+  * @param  None
+  * @retval None
+  */
+static void sim_clock_check(void)
+{
+	uint32_t u32_Iclk = u32s_ClockHz[FSP_PRIV_CLOCK_ICLK];
+	uint32_t u32_Max;
+
+	if ((u32_Iclk > SIM_MEMWAIT_HZ) && (sts_SysAccepted.MEMWAIT == 0)) {
+		sim_clock_violation("ICLK > 32MHz with MEMWAIT=0");
+	}
+	switch (sts_SysAccepted.OPCCR & SYS_OPCCR_OPCM) {
+	case SYS_OPCM_HIGH:
+		u32_Max = SIM_OPCM_HIGH_MAX;
+		break;
+	case SYS_OPCM_MIDDLE:
+		u32_Max = SIM_OPCM_MIDDLE_MAX;
+		break;
+	case SYS_OPCM_LOWV:
+		u32_Max = SIM_OPCM_LOWV_MAX;
+		break;
+	default:
+		u32_Max = SIM_OPCM_LOW_MAX;
+		break;
+	}
+	if (u32_Iclk > u32_Max) {
+		/* 動作保証外のクロックで実行を続けない */
+		sim_clock_violation("ICLK exceeds the operating power mode");
+		simFinish(SIM_EXIT_CLOCK);
+	}
+	if ((u32s_ClockHz[FSP_PRIV_CLOCK_PCLKB] > SIM_PCLKB_MAX) || (u32s_ClockHz[FSP_PRIV_CLOCK_FCLK] > SIM_FCLK_MAX)) {
+		sim_clock_violation("PCLKB/FCLK > 32MHz");
+	}
+	if ((u32s_ClockHz[FSP_PRIV_CLOCK_PCLKB] > u32_Iclk) || (u32s_ClockHz[FSP_PRIV_CLOCK_FCLK] > u32_Iclk)) {
+		sim_clock_violation("PCLKB/FCLK > ICLK");
+	}
+}
+
+/**
+  * @brief  SYSTEM書き込み(クロック発生回路,動作電力モード)
+  * @param  u32_Member: R_SYSTEM_Type内のオフセット
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   受け付けない書き込みは違反として記録し、元の値に戻す
+  */
+static void sim_system_write(size_t u32_Member, uint64_t u64_Now)
+{
+	R_SYSTEM_Type *pst_Sys = &g_sim_hw->system;
+	R_SYSTEM_Type *pst_Acc = &sts_SysAccepted;
+	uint8_t u8_Prcr = (uint8_t)sts_SysAccepted.PRCR;
+	bool bl_Change = false;
+
+	if (u32_Member == offsetof(R_SYSTEM_Type, PRCR)) {
+		/* 上位8bitがキー(A5h)でない書き込みは無視する */
+		if ((pst_Sys->PRCR & 0xFF00) == SYS_PRCR_KEY) {
+			pst_Acc->PRCR = pst_Sys->PRCR & 0x00FF;
+		}
+		pst_Sys->PRCR = pst_Acc->PRCR;
+		return;
+	}
+	if (u32_Member == offsetof(R_SYSTEM_Type, OPCCR)) {
+		if ((u8_Prcr & SYS_PRCR_PRC1) == 0) {
+			sim_clock_violation("OPCCR written with PRC1=0");
+		}
+		else if (u64_Now < u64s_OpccrEnd) {
+			sim_clock_violation("OPCCR written during OPCMTSF=1");
+		}
+		else {
+			pst_Acc->OPCCR = pst_Sys->OPCCR & SYS_OPCCR_OPCM;
+			u64s_OpccrEnd = u64_Now + SIM_OPCM_TRANSITION;
+			pst_Sys->OPCCR = pst_Acc->OPCCR | SYS_OPCCR_OPCMTSF;
+			sim_clock_check();
+			return;
+		}
+		pst_Sys->OPCCR = pst_Acc->OPCCR;
+		return;
+	}
+	if ((u32_Member == offsetof(R_SYSTEM_Type, OSCSF)) || (u32_Member >= offsetof(R_SYSTEM_Type, RSTSR0))) {
+		return;										// ステータス(書き込みは模擬しない)
+	}
+	/* ---- クロック発生回路(PRC0) ---- */
+	if ((u8_Prcr & SYS_PRCR_PRC0) == 0) {
+		sim_clock_violation("CGC register written with PRC0=0");
+		memcpy((uint8_t *)pst_Sys + u32_Member, (const uint8_t *)pst_Acc + u32_Member,
+			(u32_Member == offsetof(R_SYSTEM_Type, SCKDIVCR)) ? sizeof(uint32_t) : sizeof(uint8_t));
+		return;
+	}
+	switch (u32_Member) {
+	case offsetof(R_SYSTEM_Type, HOCOCR):
+		if ((pst_Sys->HOCOCR & 0x01) && (pst_Acc->SCKSCR == SYS_SCKSCR_HOCO)) {
+			sim_clock_violation("HOCO stopped while selected");
+			pst_Sys->HOCOCR = pst_Acc->HOCOCR;
+		}
+		pst_Acc->HOCOCR = pst_Sys->HOCOCR & 0x01;
+		pst_Sys->OSCSF = (pst_Acc->HOCOCR == 0) ? SYS_OSCSF_HOCOSF : 0;
+		break;
+	case offsetof(R_SYSTEM_Type, MOCOCR):
+		if ((pst_Sys->MOCOCR & 0x01) && (pst_Acc->SCKSCR == SYS_SCKSCR_MOCO)) {
+			sim_clock_violation("MOCO stopped while selected");
+			pst_Sys->MOCOCR = pst_Acc->MOCOCR;
+		}
+		if ((pst_Acc->MOCOCR != 0) && ((pst_Sys->MOCOCR & 0x01) == 0)) {
+			u64s_MocoReady = u64_Now + SIM_MOCO_WAIT;
+		}
+		pst_Acc->MOCOCR = pst_Sys->MOCOCR & 0x01;
+		break;
+	case offsetof(R_SYSTEM_Type, MEMWAIT):
+		if (g_sim_hw->fcache.FCACHEE & 0x01) {
+			sim_clock_violation("MEMWAIT changed with FCACHEE=1");
+		}
+		pst_Acc->MEMWAIT = pst_Sys->MEMWAIT & 0x01;
+		break;
+	case offsetof(R_SYSTEM_Type, SCKSCR):
+		if (pst_Sys->SCKSCR == pst_Acc->SCKSCR) {
+			break;
+		}
+		if ((pst_Sys->SCKSCR == SYS_SCKSCR_HOCO) && (pst_Acc->HOCOCR != 0)) {
+			sim_clock_violation("switched to stopped HOCO");
+		}
+		else if ((pst_Sys->SCKSCR == SYS_SCKSCR_MOCO) && ((pst_Acc->MOCOCR != 0) || (u64_Now < u64s_MocoReady))) {
+			sim_clock_violation("switched to MOCO before stabilization");
+		}
+		else if ((pst_Sys->SCKSCR != SYS_SCKSCR_HOCO) && (pst_Sys->SCKSCR != SYS_SCKSCR_MOCO)) {
+			sim_clock_violation("unsupported clock source");
+		}
+		else {
+			if (g_sim_hw->fcache.FCACHEE & 0x01) {
+				sim_clock_violation("clock changed with FCACHEE=1");
+			}
+			pst_Acc->SCKSCR = pst_Sys->SCKSCR;
+			bl_Change = true;
+		}
+		pst_Sys->SCKSCR = pst_Acc->SCKSCR;
+		break;
+	case offsetof(R_SYSTEM_Type, SCKDIVCR):
+		if (pst_Sys->SCKDIVCR != pst_Acc->SCKDIVCR) {
+			if (g_sim_hw->fcache.FCACHEE & 0x01) {
+				sim_clock_violation("clock changed with FCACHEE=1");
+			}
+			pst_Acc->SCKDIVCR = pst_Sys->SCKDIVCR & 0x77077777;
+			bl_Change = true;
+		}
+		pst_Sys->SCKDIVCR = pst_Acc->SCKDIVCR;
+		break;
+	default:
+		break;
+	}
+	if (bl_Change) {
+		sim_clock_change(u64_Now);
+	}
+	sim_clock_check();
+}
+
+/**
+  * @brief  SysTick/SYSTEMのレジスタ初期値を設定する
+  * @param  None
+  * @retval None
+  */
+void sim_clock_init(void)
+{
+	*(volatile uint32_t *)&g_sim_hw->systick.CALIB = SIM_CPU_CLOCK / 100;
+	g_sim_hw->system.SCKDIVCR = 0x10010100;				// HOCO 48MHz: ICLK/1, PCLKB/2, FCLK/2
+	g_sim_hw->system.MEMWAIT = 1;
+	g_sim_hw->system.OSCSF = SYS_OSCSF_HOCOSF;
+	g_sim_hw->system.RSTSR0 = 0x01;						// PORF(電源投入として起動)
+	g_sim_hw->fcache.FCACHEE = 1;
+	sts_SysAccepted = g_sim_hw->system;
+	sim_clock_update();
+}
+
+/**
+  * @brief  SysTick/DWT/SYSTEMの読み出し前のモデル更新
+  * @param  u32_Offset: 捕捉領域内のオフセット
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+void sim_clock_read(size_t u32_Offset, uint64_t u64_Now)
+{
+	uint64_t u64_Elapsed;
+	uint64_t u64_Count;
+
+	if (u32_Offset == offsetof(SimTrapRegs, systick.VAL)) {
+		/* 現在のダウンカウント値 */
+		u64_Elapsed = (u64_Now > u64s_SysTickLast) ? (u64_Now - u64s_SysTickLast) : 0;
+		u64_Count = (u64_Elapsed * u32s_ClockHz[FSP_PRIV_CLOCK_ICLK]) / SIM_NS_PER_SEC;
+		g_sim_hw->systick.VAL = (u64_Count > g_sim_hw->systick.LOAD) ? 0 : (uint32_t)(g_sim_hw->systick.LOAD - u64_Count);
+	}
+	else if (u32_Offset == offsetof(SimTrapRegs, dwt.CYCCNT)) {
+		/* 仮想時間をCPUクロック数に換算する */
+		if (g_sim_coredebug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk) {
+			if (g_sim_hw->dwt.CTRL & DWT_CTRL_CYCCNTENA_Msk) {
+				g_sim_hw->dwt.CYCCNT = (uint32_t)sim_cpu_cycles(u64_Now) - u32s_CycleBase;
+			}
+		}
+	}
+	else if (u32_Offset == offsetof(SimTrapRegs, system.OPCCR)) {
+		/* 動作電力モードの遷移完了 */
+		if (u64_Now >= u64s_OpccrEnd) {
+			g_sim_hw->system.OPCCR &= (uint8_t)~SYS_OPCCR_OPCMTSF;
+		}
+	}
+}
+
+/**
+  * @brief  SysTick/DWT/SYSTEMのアクセス後のモデル更新
+  * @param  u32_Offset: 捕捉領域内のオフセット
+  * @param  bl_Write: 書き込みアクセス
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+void sim_clock_access(size_t u32_Offset, bool bl_Write, uint64_t u64_Now)
+{
+	if (u32_Offset < offsetof(SimTrapRegs, dwt)) {
+		if (bl_Write) {
+			sim_systick_config(u64_Now, (u32_Offset == offsetof(SimTrapRegs, systick.VAL)));
+		}
+		else if (u32_Offset == offsetof(SimTrapRegs, systick.CTRL)) {
+			/* CTRLの読み出しでCOUNTFLAGを解除する */
+			g_sim_hw->systick.CTRL &= ~SysTick_CTRL_COUNTFLAG_Msk;
+		}
+	}
+	else if (bl_Write && (u32_Offset == offsetof(SimTrapRegs, dwt.CYCCNT))) {
+		u32s_CycleBase = (uint32_t)sim_cpu_cycles(u64_Now) - g_sim_hw->dwt.CYCCNT;
+	}
+	else if (bl_Write && (u32_Offset >= offsetof(SimTrapRegs, system))) {
+		sim_system_write(u32_Offset - offsetof(SimTrapRegs, system), u64_Now);
+	}
+}
+
+/**
+  * @brief  SysTickの次のイベント時刻を反映する
+  * @param  pu64_Next: 次のイベント時刻[ns](より早ければ更新する)
+  * @retval None
+  */
+void sim_systick_schedule(uint64_t *pu64_Next)
+{
+	if (bls_SysTickRun && (u64s_SysTickNext < *pu64_Next)) {
+		*pu64_Next = u64s_SysTickNext;
+	}
+}
+
+/**
+  * @brief  クロック変更の統計を出力する
+  * @param  None
+  * @retval None
+  */
+void sim_clock_report(void)
+{
+	if ((u64s_ClockChanges > 0) || (u64s_ClockViolations > 0)) {
+		fprintf(stderr, "[sim] clock changes %llu, violations %llu\n",
+			(unsigned long long)u64s_ClockChanges, (unsigned long long)u64s_ClockViolations);
+	}
+}
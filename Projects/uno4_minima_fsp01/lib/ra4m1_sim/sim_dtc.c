@@ -0,0 +1,198 @@
+/**
+  ******************************************************************************
+  * @file           : sim_dtc.c
+  * @brief          : RA4M1レジスタモデル DTC
+  ******************************************************************************
+  * @note   DTCはIELSR.DTCE=1の割り込み要因でノーマル/リピート/ブロック転送と
+  *         チェーン転送を行う。捕捉対象のレジスタへの転送はCPUからのアクセスと
+  *         同じくモデルを更新する(sim_pre_access()/sim_post_access())。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim_local.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* DTC転送情報(lld.hのDtcTransferInfoと同じ配置) */
+typedef struct {
+	uint32_t u32_mode;							/* MRA[31:24], MRB[23:16]			*/
+	uintptr_t u_src;							/* 転送元アドレス(SAR)				*/
+	uintptr_t u_dst;							/* 転送先アドレス(DAR)				*/
+	uint16_t u16_crb;							/* ブロック転送回数(CRB)			*/
+	uint16_t u16_cra;							/* 転送回数(CRA)					*/
+} SimDtcInfo;
+
+/* Private define ------------------------------------------------------------*/
+
+/* DTC転送情報のビット */
+#define DTC_MRA_MD_POS		(30)
+#define DTC_MRA_SZ_POS		(28)
+#define DTC_MRA_SM_POS		(26)
+#define DTC_MRB_CHNE		(0x00800000UL)
+#define DTC_MRB_CHNS		(0x00400000UL)
+#define DTC_MRB_DISEL		(0x00200000UL)
+#define DTC_MRB_DTS			(0x00100000UL)
+#define DTC_MRB_DM_POS		(18)
+#define DTC_MD_NORMAL		(0)
+#define DTC_MD_REPEAT		(1)
+#define DTC_MD_BLOCK		(2)
+#define DTC_ADDR_INC		(2)
+#define DTC_ADDR_DEC		(3)
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t sim_dtc_read(uintptr_t u_Addr, uint32_t u32_Size, uint64_t u64_Now);
+static void sim_dtc_write(uintptr_t u_Addr, uint32_t u32_Size, uint32_t u32_Data, uint64_t u64_Now);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  DTC転送
+  * @param  u32_Irq: 起動要因の割り込み番号
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval true:CPU割り込みを発生させる
+  * @note   転送情報はDTCVBRのベクターから読み出し、転送後の値を書き戻す。
+  *         ノーマル/ブロック転送の完了時はDTCEを解除する
+  */
+bool sim_dtc_transfer(uint32_t u32_Irq, uint64_t u64_Now)
+{
+	const uint32_t *pu32_Vector = (const uint32_t *)(uintptr_t)g_sim_dtc.DTCVBR;
+	SimDtcInfo *pst_Info;
+	uint32_t u32_Size;
+	uint32_t u32_Units;
+	uint32_t u32_Md;
+	uint32_t u32_Sm;
+	uint32_t u32_Dm;
+	bool bl_End;
+	bool bl_Irq = false;
+	uint32_t _i;
+
+	if ((pu32_Vector == NULL) || (pu32_Vector[u32_Irq] == 0)) {
+		return true;
+	}
+	pst_Info = (SimDtcInfo *)(uintptr_t)pu32_Vector[u32_Irq];
+	while (true) {
+		u32_Md = (pst_Info->u32_mode >> DTC_MRA_MD_POS) & 0x3;
+		u32_Size = 1U << ((pst_Info->u32_mode >> DTC_MRA_SZ_POS) & 0x3);
+		u32_Sm = (pst_Info->u32_mode >> DTC_MRA_SM_POS) & 0x3;
+		u32_Dm = (pst_Info->u32_mode >> DTC_MRB_DM_POS) & 0x3;
+		u32_Units = (u32_Md == DTC_MD_BLOCK) ? (pst_Info->u16_cra & 0xFF) : 1;
+		if (u32_Units == 0) {
+			u32_Units = 256;
+		}
+
+		for (_i=0; _i<u32_Units; _i++) {
+			sim_dtc_write(pst_Info->u_dst, u32_Size, sim_dtc_read(pst_Info->u_src, u32_Size, u64_Now), u64_Now);
+			if (u32_Sm == DTC_ADDR_INC) {
+				pst_Info->u_src += u32_Size;
+			}
+			else if (u32_Sm == DTC_ADDR_DEC) {
+				pst_Info->u_src -= u32_Size;
+			}
+			if (u32_Dm == DTC_ADDR_INC) {
+				pst_Info->u_dst += u32_Size;
+			}
+			else if (u32_Dm == DTC_ADDR_DEC) {
+				pst_Info->u_dst -= u32_Size;
+			}
+		}
+
+		switch (u32_Md) {
+		case DTC_MD_REPEAT:
+			/* CRAL=0でCRAHから再設定し、リピート領域のアドレスを戻す */
+			bl_End = false;
+			pst_Info->u16_cra = (uint16_t)((pst_Info->u16_cra & 0xFF00) | ((pst_Info->u16_cra - 1) & 0xFF));
+			if ((pst_Info->u16_cra & 0xFF) == 0) {
+				pst_Info->u16_cra |= (uint16_t)(pst_Info->u16_cra >> 8);
+				if (pst_Info->u32_mode & DTC_MRB_DTS) {
+					pst_Info->u_src = (u32_Sm == DTC_ADDR_DEC) ? (pst_Info->u_src + (pst_Info->u16_cra & 0xFF) * u32_Size) : (pst_Info->u_src - (pst_Info->u16_cra & 0xFF) * u32_Size);
+				}
+				else {
+					pst_Info->u_dst = (u32_Dm == DTC_ADDR_DEC) ? (pst_Info->u_dst + (pst_Info->u16_cra & 0xFF) * u32_Size) : (pst_Info->u_dst - (pst_Info->u16_cra & 0xFF) * u32_Size);
+				}
+			}
+			break;
+		case DTC_MD_BLOCK:
+			/* ブロック領域のアドレスを戻す */
+			if (pst_Info->u32_mode & DTC_MRB_DTS) {
+				pst_Info->u_src = (u32_Sm == DTC_ADDR_DEC) ? (pst_Info->u_src + u32_Units * u32_Size) : (pst_Info->u_src - u32_Units * u32_Size);
+			}
+			else {
+				pst_Info->u_dst = (u32_Dm == DTC_ADDR_DEC) ? (pst_Info->u_dst + u32_Units * u32_Size) : (pst_Info->u_dst - u32_Units * u32_Size);
+			}
+			pst_Info->u16_crb--;
+			bl_End = (pst_Info->u16_crb == 0);
+			break;
+		default:
+			pst_Info->u16_cra--;
+			bl_End = (pst_Info->u16_cra == 0);
+			break;
+		}
+
+		/* 最後に実行した転送情報でCPU割り込みを判定する */
+		bl_Irq = bl_End || ((pst_Info->u32_mode & DTC_MRB_DISEL) != 0);
+		if (((pst_Info->u32_mode & DTC_MRB_CHNE) == 0)
+		 || ((pst_Info->u32_mode & DTC_MRB_CHNS) && !bl_End)) {
+			break;
+		}
+		pst_Info++;
+	}
+	if (bl_Irq && bl_End) {
+		g_sim_icu.IELSR_b[u32_Irq].DTCE = 0;
+	}
+	return bl_Irq;
+}
+
+/**
+  * @brief  DTCの読み出し
+  * @param  u_Addr: アドレス
+  * @param  u32_Size: サイズ[byte]
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval 読み出し値
+  * @note   捕捉対象のレジスタはモデル側から読み出し、読み出しの副作用を反映する
+  */
+static uint32_t sim_dtc_read(uintptr_t u_Addr, uint32_t u32_Size, uint64_t u64_Now)
+{
+	size_t u32_Offset = u_Addr - (uintptr_t)g_sim_trap;
+	const uint8_t *pu8_Addr = (const uint8_t *)u_Addr;
+	uint32_t u32_Data = 0;
+	bool bl_Trap = (u_Addr >= (uintptr_t)g_sim_trap) && (u32_Offset < sizeof(SimTrapRegs));
+
+	if (bl_Trap) {
+		sim_pre_access(u32_Offset, false, u64_Now);
+		pu8_Addr = (const uint8_t *)g_sim_hw + u32_Offset;
+	}
+	memcpy(&u32_Data, pu8_Addr, u32_Size);
+	if (bl_Trap) {
+		sim_post_access(u32_Offset, false, u64_Now);
+	}
+	return u32_Data;
+}
+
+/**
+  * @brief  DTCの書き込み
+  * @param  u_Addr: アドレス
+  * @param  u32_Size: サイズ[byte]
+  * @param  u32_Data: 書き込み値
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   捕捉対象のレジスタはモデル側へ書き込み、書き込みの副作用を反映する
+  */
+static void sim_dtc_write(uintptr_t u_Addr, uint32_t u32_Size, uint32_t u32_Data, uint64_t u64_Now)
+{
+	size_t u32_Offset = u_Addr - (uintptr_t)g_sim_trap;
+	uint8_t *pu8_Addr = (uint8_t *)u_Addr;
+	bool bl_Trap = (u_Addr >= (uintptr_t)g_sim_trap) && (u32_Offset < sizeof(SimTrapRegs));
+
+	if (bl_Trap) {
+		pu8_Addr = (uint8_t *)g_sim_hw + u32_Offset;
+	}
+	memcpy(pu8_Addr, &u32_Data, u32_Size);
+	if (bl_Trap) {
+		sim_post_access(u32_Offset, true, u64_Now);
+	}
+}
@@ -0,0 +1,293 @@
+/**
+  ******************************************************************************
+  * @file           : sim_esp.c
+  * @brief          : RA4M1レジスタモデル SCI9(ESP32-S3接続)
+  ******************************************************************************
+  * @note   SCI9はUNO R4 WiFiのESP32-S3との接続として送受信をバイト単位の時間で
+  *         模擬し、最初に送受信を許可した時に作成する疑似端末(/dev/pts/N)に中継する
+  *         (相手側はesp_peer.pyで模擬する)。受信はRDRFが解除されるまで次のバイトを
+  *         待たせ、オーバーランは発生させない。疑似端末が開かれていない間の送信
+  *         データは破棄する。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim_local.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define SIM_ESP_BUFF		(4096)				/* SCI9と疑似端末の中継バッファ[byte]	*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* SCI9(sim_lock()で排他) */
+static uint8_t u8s_EspScr;							/* SCI9(ESP32-S3)					*/
+static bool bls_EspTxBusy;
+static uint8_t u8s_EspTxByte;
+static uint64_t u64s_EspTxEnd;
+static uint64_t u64s_EspRxNext;
+static uint64_t u64s_EspByteTime = SIM_NS_PER_SEC / 960;
+static int i32s_EspPty = -1;						/* 疑似端末(マスター)				*/
+static char cs_EspPtyName[64];
+static bool bls_EspPtyOpen;							/* 疑似端末のスレーブ側が開いている	*/
+static bool bls_EspStarted;							/* 疑似端末の作成を試みた			*/
+static uint8_t u8s_EspTxBuff[SIM_ESP_BUFF];			/* 疑似端末へ書き込むデータ			*/
+static uint16_t u16s_EspTxLen;
+static uint8_t u8s_EspRxBuff[SIM_ESP_BUFF];			/* 疑似端末から読み出したデータ		*/
+static uint16_t u16s_EspRxLen;
+static uint16_t u16s_EspRxPos;
+static uint64_t u64s_EspTxCount;
+static uint64_t u64s_EspRxCount;
+static uint64_t u64s_EspDrop;
+
+/* Private function prototypes -----------------------------------------------*/
+static void sim_esp_open_pty(void);
+static void sim_esp_scr_write(uint64_t u64_Now);
+static void sim_esp_tdr_write(uint64_t u64_Now);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  SCI9(ESP32-S3)の疑似端末を作成する
+  * @param  None
+  * @retval None
+  * @note   USBと同じくスレーブ側をrawモードにしておき、接続はPOLLHUPで判定する
+  */
+static void sim_esp_open_pty(void)
+{
+	struct termios st_Term;
+	int i32_Slave;
+
+	i32s_EspPty = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if (i32s_EspPty < 0) {
+		return;
+	}
+	if ((grantpt(i32s_EspPty) != 0) || (unlockpt(i32s_EspPty) != 0)
+	 || (ptsname_r(i32s_EspPty, cs_EspPtyName, sizeof(cs_EspPtyName)) != 0)) {
+		close(i32s_EspPty);
+		i32s_EspPty = -1;
+		return;
+	}
+	i32_Slave = open(cs_EspPtyName, O_RDWR | O_NOCTTY);
+	if (i32_Slave >= 0) {
+		if (tcgetattr(i32_Slave, &st_Term) == 0) {
+			cfmakeraw(&st_Term);
+			(void)tcsetattr(i32_Slave, TCSANOW, &st_Term);
+		}
+		close(i32_Slave);
+	}
+}
+
+/**
+  * @brief  SCI9の通信速度を求める
+  * @param  None
+  * @retval None
+  */
+void sim_esp_config(void)
+{
+	u64s_EspByteTime = sim_sci_byte_time(&g_sim_hw->sci[9]);
+}
+
+/**
+  * @brief  SCI9 SCR書き込み
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   最初に送受信を許可した時に疑似端末を作成する
+  */
+static void sim_esp_scr_write(uint64_t u64_Now)
+{
+	R_SCI0_Type *pst_Sci = &g_sim_hw->sci[9];
+	uint8_t u8_Scr = pst_Sci->SCR;
+	uint8_t u8_TxOn = SCI_SCR_TE | SCI_SCR_TIE;
+
+	if ((u8_Scr & (SCI_SCR_TE | SCI_SCR_RE)) && !bls_EspStarted) {
+		bls_EspStarted = true;
+		sim_esp_open_pty();
+		sim_log("ESP32-S3 link: %s", (i32s_EspPty >= 0) ? cs_EspPtyName : "(no pty)");
+	}
+	if ((u8_Scr & SCI_SCR_TE) == 0) {
+		bls_EspTxBusy = false;
+		pst_Sci->SSR |= (SCI_SSR_TDRE | SCI_SSR_TEND);
+	}
+	if (((u8_Scr & u8_TxOn) == u8_TxOn) && ((u8s_EspScr & u8_TxOn) != u8_TxOn)
+	 && (pst_Sci->SSR & SCI_SSR_TDRE)) {
+		simRaiseEvent(ELC_EVENT_SCI9_TXI);
+	}
+	if ((u8_Scr & SCI_SCR_RE) && !(u8s_EspScr & SCI_SCR_RE)) {
+		u64s_EspRxNext = u64_Now;
+	}
+	u8s_EspScr = u8_Scr;
+}
+
+/**
+  * @brief  SCI9 TDR書き込み
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+static void sim_esp_tdr_write(uint64_t u64_Now)
+{
+	R_SCI0_Type *pst_Sci = &g_sim_hw->sci[9];
+
+	if ((pst_Sci->SCR & SCI_SCR_TE) == 0) {
+		return;
+	}
+	if (!bls_EspTxBusy) {
+		u8s_EspTxByte = pst_Sci->TDR;
+		bls_EspTxBusy = true;
+		u64s_EspTxEnd = u64_Now + u64s_EspByteTime;
+		pst_Sci->SSR = (uint8_t)((pst_Sci->SSR | SCI_SSR_TDRE) & ~SCI_SSR_TEND);
+		if (pst_Sci->SCR & SCI_SCR_TIE) {
+			simRaiseEvent(ELC_EVENT_SCI9_TXI);
+		}
+	}
+	else {
+		pst_Sci->SSR &= (uint8_t)~SCI_SSR_TDRE;
+	}
+}
+
+/**
+  * @brief  SCI9の時間経過処理
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   3Mbpsでは1バイトがHWタイマーの最小周期より短いため、経過した時間分の
+  *         バイトをまとめて送受信する(DTCは割り込み要因の発生時に転送する)
+  */
+void sim_esp_update(uint64_t u64_Now)
+{
+	R_SCI0_Type *pst_Sci = &g_sim_hw->sci[9];
+	struct pollfd st_Poll;
+	ssize_t i32_Len;
+
+	if (i32s_EspPty < 0) {
+		return;
+	}
+	st_Poll.fd = i32s_EspPty;
+	st_Poll.events = POLLIN;
+	st_Poll.revents = 0;
+	if (poll(&st_Poll, 1, 0) >= 0) {
+		bls_EspPtyOpen = ((st_Poll.revents & POLLHUP) == 0);
+	}
+
+	/* ---- 送信 ---- */
+	while (bls_EspTxBusy && (u64_Now >= u64s_EspTxEnd)) {
+		if (u16s_EspTxLen < SIM_ESP_BUFF) {
+			u8s_EspTxBuff[u16s_EspTxLen++] = u8s_EspTxByte;
+		}
+		else {
+			u64s_EspDrop++;
+		}
+		if ((pst_Sci->SSR & SCI_SSR_TDRE) == 0) {
+			u8s_EspTxByte = pst_Sci->TDR;
+			u64s_EspTxEnd += u64s_EspByteTime;
+			pst_Sci->SSR |= SCI_SSR_TDRE;
+			if (pst_Sci->SCR & SCI_SCR_TIE) {
+				simRaiseEvent(ELC_EVENT_SCI9_TXI);
+			}
+		}
+		else {
+			bls_EspTxBusy = false;
+			pst_Sci->SSR |= SCI_SSR_TEND;
+			if (pst_Sci->SCR & SCI_SCR_TEIE) {
+				simRaiseEvent(ELC_EVENT_SCI9_TEI);
+			}
+		}
+	}
+	if (u16s_EspTxLen > 0) {
+		i32_Len = bls_EspPtyOpen ? write(i32s_EspPty, u8s_EspTxBuff, u16s_EspTxLen) : 0;
+		if (i32_Len > 0) {
+			u64s_EspTxCount += (uint64_t)i32_Len;
+			u64s_EspDrop += (uint64_t)(u16s_EspTxLen - i32_Len);
+		}
+		else {
+			/* 相手が居ない(または受け取れない)データは線路上で失われる */
+			u64s_EspDrop += u16s_EspTxLen;
+		}
+		u16s_EspTxLen = 0;
+	}
+
+	/* ---- 受信 ---- */
+	if ((pst_Sci->SCR & SCI_SCR_RE) == 0) {
+		return;
+	}
+	if (u16s_EspRxPos >= u16s_EspRxLen) {
+		u16s_EspRxPos = 0;
+		u16s_EspRxLen = 0;
+		i32_Len = bls_EspPtyOpen ? read(i32s_EspPty, u8s_EspRxBuff, sizeof(u8s_EspRxBuff)) : 0;
+		if (i32_Len <= 0) {
+			u64s_EspRxNext = u64_Now;					// 受信線はアイドル
+			return;
+		}
+		u16s_EspRxLen = (uint16_t)i32_Len;
+		if (u64s_EspRxNext < u64_Now) {
+			u64s_EspRxNext = u64_Now;
+		}
+	}
+	while ((u16s_EspRxPos < u16s_EspRxLen) && (u64_Now >= u64s_EspRxNext)
+	 && ((pst_Sci->SSR & SCI_SSR_RDRF) == 0)) {
+		*(volatile uint8_t *)&pst_Sci->RDR = u8s_EspRxBuff[u16s_EspRxPos++];
+		pst_Sci->SSR |= SCI_SSR_RDRF;
+		u64s_EspRxCount++;
+		u64s_EspRxNext += u64s_EspByteTime;
+		if (pst_Sci->SCR & SCI_SCR_RIE) {
+			simRaiseEvent(ELC_EVENT_SCI9_RXI);
+		}
+	}
+}
+
+/**
+  * @brief  SCI9のアクセス後のモデル更新
+  * @param  u32_Member: R_SCI0_Type内のオフセット
+  * @param  bl_Write: 書き込みアクセス
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+void sim_esp_access(size_t u32_Member, bool bl_Write, uint64_t u64_Now)
+{
+	if (bl_Write) {
+		if (u32_Member == offsetof(R_SCI0_Type, TDR)) {
+			sim_esp_tdr_write(u64_Now);
+		}
+		else if (u32_Member == offsetof(R_SCI0_Type, SCR)) {
+			sim_esp_scr_write(u64_Now);
+		}
+		else if ((u32_Member == offsetof(R_SCI0_Type, SMR)) || (u32_Member == offsetof(R_SCI0_Type, BRR))
+		 || (u32_Member == offsetof(R_SCI0_Type, SEMR))) {
+			sim_esp_config();
+		}
+	}
+	else if (u32_Member == offsetof(R_SCI0_Type, RDR)) {
+		g_sim_hw->sci[9].SSR &= (uint8_t)~SCI_SSR_RDRF;
+	}
+}
+
+/**
+  * @brief  SCI9の次のイベント時刻を反映する
+  * @param  pu64_Next: 次のイベント時刻[ns](より早ければ更新する)
+  * @retval None
+  */
+void sim_esp_schedule(uint64_t *pu64_Next)
+{
+	if (bls_EspTxBusy && (u64s_EspTxEnd < *pu64_Next)) {
+		*pu64_Next = u64s_EspTxEnd;
+	}
+	if ((u16s_EspRxPos < u16s_EspRxLen) && (u64s_EspRxNext < *pu64_Next)) {
+		*pu64_Next = u64s_EspRxNext;
+	}
+}
+
+/**
+  * @brief  SCI9の統計を出力する
+  * @param  None
+  * @retval None
+  * @note   疑似端末を作成していなければ出力しない
+  */
+void sim_esp_report(void)
+{
+	if (i32s_EspPty >= 0) {
+		fprintf(stderr, "[sim] SCI9(ESP32-S3) tx %llu bytes, rx %llu bytes, dropped %llu\n",
+			(unsigned long long)u64s_EspTxCount, (unsigned long long)u64s_EspRxCount, (unsigned long long)u64s_EspDrop);
+	}
+}
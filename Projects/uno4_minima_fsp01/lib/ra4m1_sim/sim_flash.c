@@ -0,0 +1,295 @@
+/**
+  ******************************************************************************
+  * @file           : sim_flash.c
+  * @brief          : RA4M1レジスタモデル FACI/FCACHE(データフラッシュ)
+  ******************************************************************************
+  * @note   データフラッシュは書き込み/消去に時間を要し(FSTATR1.FRDY)、内容を
+  *         ファイルに保存できる(-f)。指定した回数目の書き込み/消去の途中で
+  *         電源断を模擬して終了できる(-c)。ファームウェア(テスト)からは
+  *         simFlashPowerCut()で終了せずに電源断させ、復電後の再起動(マウント)を
+  *         同じ実行の中で確認できる。電源断の間の書き込み/消去は内容を変えずに
+  *         すぐ完了する。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim_local.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* データフラッシュ */
+#define SIM_DFLASH_BLOCK	(1024)				/* 消去単位[byte]					*/
+#define SIM_DFLASH_PE_BASE	(0xFE000000UL)		/* P/E時のアドレス					*/
+#define SIM_DFLASH_PROGRAM	(50000)				/* 1byte書き込み時間[ns]			*/
+#define SIM_DFLASH_ERASE	(10000000)			/* 1ブロック消去時間[ns]			*/
+#define FACI_FCR_OPST		(0x80)
+#define FACI_FCR_CMD		(0x0F)
+#define FACI_CMD_PROGRAM	(0x01)
+#define FACI_CMD_ERASE		(0x04)
+#define FACI_FSTATR1_FRDY	(0x40)
+#define FACI_FSTATR2_ERERR	(0x0001)
+#define FACI_FSTATR2_PRGERR	(0x0002)
+#define FACI_FSTATR2_ILGLERR	(0x0010)
+#define FACI_FENTRYR_KEY	(0xAA00)
+#define FACI_FENTRYR_PE_D	(0x0080)			/* データフラッシュP/Eモード		*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* データフラッシュ(sim_lock()で排他) */
+static bool bls_FlashBusy;
+static uint8_t u8s_FlashCmd;
+static uint32_t u32s_FlashAddr;
+static uint8_t u8s_FlashData;
+static uint64_t u64s_FlashEnd;
+static uint64_t u64s_FlashOps;						/* 書き込み/消去の実行回数			*/
+static uint64_t u64s_FlashCut;						/* 電源断させる実行回数(0:無し)		*/
+static bool bls_FlashCutHold;						/* 電源断で終了しない(simFlashPowerCut)	*/
+static bool bls_FlashOff;							/* 電源断中							*/
+static uint64_t u64s_FlashCuts;						/* 終了しない電源断の回数			*/
+static const char *pcs_FlashFile;					/* データフラッシュの保存先			*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void sim_flash_entry(void);
+static void sim_flash_command(uint64_t u64_Now);
+static void sim_flash_power_cut(void);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  データフラッシュの内容をファイルから読み込む
+  * @param  None
+  * @retval None
+  * @note   ファイルが無い場合は消去状態(0xFF)から始める
+  */
+void sim_flash_load(void)
+{
+	int i32_Fd;
+
+	memset(g_sim_dflash, 0xFF, SIM_DFLASH_SIZE);
+	if (pcs_FlashFile == NULL) {
+		return;
+	}
+	i32_Fd = open(pcs_FlashFile, O_RDONLY);
+	if (i32_Fd >= 0) {
+		if (read(i32_Fd, g_sim_dflash, SIM_DFLASH_SIZE) != SIM_DFLASH_SIZE) {
+			memset(g_sim_dflash, 0xFF, SIM_DFLASH_SIZE);
+		}
+		close(i32_Fd);
+	}
+}
+
+/**
+  * @brief  データフラッシュの内容をファイルに保存する
+  * @param  None
+  * @retval None
+  */
+void sim_flash_save(void)
+{
+	int i32_Fd;
+
+	if (pcs_FlashFile == NULL) {
+		return;
+	}
+	i32_Fd = open(pcs_FlashFile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (i32_Fd >= 0) {
+		(void)!write(i32_Fd, g_sim_dflash, SIM_DFLASH_SIZE);
+		close(i32_Fd);
+	}
+}
+
+/**
+  * @brief  FENTRYR書き込み(P/Eモードの切り替え)
+  * @param  None
+  * @retval None
+  * @note   上位8bitがキー(AAh)でない書き込みは無視する
+  */
+static void sim_flash_entry(void)
+{
+	static uint16_t u16_Mode;
+	uint16_t u16_Value = g_sim_hw->faci.FENTRYR;
+
+	if ((u16_Value & 0xFF00) == FACI_FENTRYR_KEY) {
+		u16_Mode = u16_Value & 0x00FF;
+	}
+	g_sim_hw->faci.FENTRYR = u16_Mode;
+}
+
+/**
+  * @brief  FCR書き込み(書き込み/消去の開始,完了の確認)
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+static void sim_flash_command(uint64_t u64_Now)
+{
+	R_FACI_LP_Type *pst_Faci = &g_sim_hw->faci;
+	uint8_t u8_Fcr = pst_Faci->FCR;
+
+	if ((u8_Fcr & FACI_FCR_OPST) == 0) {
+		/* OPST=0でFRDYを解除する */
+		sim_flash_update(u64_Now);
+		if (!bls_FlashBusy) {
+			pst_Faci->FSTATR1 &= (uint8_t)~FACI_FSTATR1_FRDY;
+		}
+		return;
+	}
+	u8s_FlashCmd = u8_Fcr & FACI_FCR_CMD;
+	u32s_FlashAddr = (((uint32_t)pst_Faci->FSARH << 16) | pst_Faci->FSARL) - SIM_DFLASH_PE_BASE;
+	u8s_FlashData = (uint8_t)pst_Faci->FWBL0;
+	pst_Faci->FSTATR2 = 0;
+	if ((pst_Faci->FENTRYR != FACI_FENTRYR_PE_D) || (u32s_FlashAddr >= SIM_DFLASH_SIZE)
+	 || ((u8s_FlashCmd != FACI_CMD_PROGRAM) && (u8s_FlashCmd != FACI_CMD_ERASE))) {
+		pst_Faci->FSTATR2 = FACI_FSTATR2_ILGLERR;
+		pst_Faci->FSTATR1 |= FACI_FSTATR1_FRDY;
+		return;
+	}
+	if (bls_FlashOff) {
+		pst_Faci->FSTATR1 |= FACI_FSTATR1_FRDY;
+		return;
+	}
+	u64s_FlashOps++;
+	if (u64s_FlashOps == u64s_FlashCut) {
+		sim_flash_power_cut();
+		pst_Faci->FSTATR1 |= FACI_FSTATR1_FRDY;
+		return;
+	}
+	bls_FlashBusy = true;
+	u64s_FlashEnd = u64_Now + ((u8s_FlashCmd == FACI_CMD_PROGRAM) ? SIM_DFLASH_PROGRAM : SIM_DFLASH_ERASE);
+}
+
+/**
+  * @brief  書き込み/消去の時間経過処理
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   書き込みは1→0の変化だけを反映する(消去せずに重ね書きするとPRGERR)
+  */
+void sim_flash_update(uint64_t u64_Now)
+{
+	R_FACI_LP_Type *pst_Faci = &g_sim_hw->faci;
+
+	if (!bls_FlashBusy || (u64_Now < u64s_FlashEnd)) {
+		return;
+	}
+	bls_FlashBusy = false;
+	if (u8s_FlashCmd == FACI_CMD_PROGRAM) {
+		if ((g_sim_dflash[u32s_FlashAddr] & u8s_FlashData) != u8s_FlashData) {
+			pst_Faci->FSTATR2 |= FACI_FSTATR2_PRGERR;
+		}
+		g_sim_dflash[u32s_FlashAddr] &= u8s_FlashData;
+	}
+	else {
+		memset(&g_sim_dflash[(u32s_FlashAddr / SIM_DFLASH_BLOCK) * SIM_DFLASH_BLOCK], 0xFF, SIM_DFLASH_BLOCK);
+	}
+	pst_Faci->FSTATR1 |= FACI_FSTATR1_FRDY;
+}
+
+/**
+  * @brief  書き込み/消去の途中で電源断する
+  * @param  None
+  * @retval None
+  * @note   書き込みは一部のビットだけ、消去は一部のバイトだけ反映した状態で
+  *         保存して終了する(乱数は実行回数から決めるため再現できる)。
+  *         simFlashPowerCut()で設定した場合は終了せずに電源断中にする。
+  */
+static void sim_flash_power_cut(void)
+{
+	uint32_t u32_Random = (uint32_t)u64s_FlashOps * 2654435761U;
+	uint8_t *pu8_Block = &g_sim_dflash[(u32s_FlashAddr / SIM_DFLASH_BLOCK) * SIM_DFLASH_BLOCK];
+	size_t _i;
+
+	if (u8s_FlashCmd == FACI_CMD_PROGRAM) {
+		g_sim_dflash[u32s_FlashAddr] &= (uint8_t)(u8s_FlashData | u32_Random);
+	}
+	else {
+		for (_i=0; _i<SIM_DFLASH_BLOCK; _i++) {
+			u32_Random ^= u32_Random << 13;
+			u32_Random ^= u32_Random >> 17;
+			u32_Random ^= u32_Random << 5;
+			if (u32_Random & 1) {
+				pu8_Block[_i] = 0xFF;
+			}
+		}
+	}
+	if (bls_FlashCutHold) {
+		bls_FlashOff = true;
+		u64s_FlashCut = 0;
+		u64s_FlashCuts++;
+		return;
+	}
+	sim_log("power cut at data flash operation %llu", (unsigned long long)u64s_FlashOps);
+	simFinish(3);
+}
+
+/**
+  * @brief  データフラッシュの保存先を設定する
+  * @param  pc_Path: ファイル名
+  * @retval None
+  */
+void sim_flash_set_file(const char *pc_Path)
+{
+	pcs_FlashFile = pc_Path;
+}
+
+/**
+  * @brief  電源断させる書き込み/消去の回数を設定する
+  * @param  u64_Count: 回数(0:電源断しない)
+  * @retval None
+  */
+void sim_flash_set_cut(uint64_t u64_Count)
+{
+	u64s_FlashCut = u64_Count;
+}
+
+/**
+  * @brief  データフラッシュを電源断/復電させる
+  * @param  u32_Count: この後のこの回数目の書き込み/消去の途中で電源断させる(0:復電)
+  * @retval None
+  * @note   ファームウェア(ホスト実行版のテスト)から呼ぶ。電源断では終了しない。
+  *         復電しても書き込み中の処理は再開しないため、ドライバーを初期化し直して
+  *         再起動後の状態を確認すること。
+  */
+void simFlashPowerCut(uint32_t u32_Count)
+{
+	sigset_t st_Saved;
+
+	sim_lock_fw(&st_Saved);
+	bls_FlashOff = false;
+	bls_FlashCutHold = (u32_Count != 0);
+	u64s_FlashCut = (u32_Count != 0) ? (u64s_FlashOps + u32_Count) : 0;
+	sim_unlock_fw(&st_Saved);
+}
+
+/**
+  * @brief  FACI/FCACHE書き込み
+  * @param  u32_Offset: 捕捉領域内のオフセット
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+void sim_flash_write(size_t u32_Offset, uint64_t u64_Now)
+{
+	if (u32_Offset == offsetof(SimTrapRegs, faci.FCR)) {
+		sim_flash_command(u64_Now);
+	}
+	else if (u32_Offset == offsetof(SimTrapRegs, faci.FENTRYR)) {
+		sim_flash_entry();
+	}
+	else if (u32_Offset == offsetof(SimTrapRegs, fcache.FCACHEIV)) {
+		g_sim_hw->fcache.FCACHEIV = 0;				// 無効化は即時に完了する
+	}
+}
+
+/**
+  * @brief  データフラッシュの統計を出力する
+  * @param  None
+  * @retval None
+  */
+void sim_flash_report(void)
+{
+	if (u64s_FlashOps > 0) {
+		fprintf(stderr, "[sim] data flash %llu operations, %llu power cuts\n",
+			(unsigned long long)u64s_FlashOps, (unsigned long long)u64s_FlashCuts);
+	}
+}
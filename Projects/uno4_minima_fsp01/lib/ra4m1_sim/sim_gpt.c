@@ -0,0 +1,244 @@
+/**
+  ******************************************************************************
+  * @file           : sim_gpt.c
+  * @brief          : RA4M1レジスタモデル GPT
+  ******************************************************************************
+  * @note   GPTはCPU/ELCからの開始/停止/クリアとオーバーフローイベントの発生時刻を
+  *         模擬し、GTCNTは読み出し時に仮想時間から求める。オーバーフローの時刻に
+  *         HWタイマーを合わせるのは割り込み/ELCで使用しているチャネルだけとする。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim_local.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define SIM_GPT_NUM			(8)
+#define SIM_ELC_GPT_NUM		(4)					/* ELC_GPTA～ELC_GPTD				*/
+#define SIM_GTSSR_SSELCA	(0x00010000UL)		/* GTSSR/GTCSR: ELC_GPTA(以降+1bit)	*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* GPT(sim_lock()で排他) */
+static bool bls_GptRun[SIM_GPT_NUM];				/* カウント中						*/
+static uint64_t u64s_GptBase[SIM_GPT_NUM];			/* カウント0の仮想時間[ns]			*/
+
+/* GPTオーバーフローのELCイベント(模擬しないチャネルはELC_EVENT_NONE) */
+static const elc_event_t ens_GptOverflow[SIM_GPT_NUM] = {
+	[0] = ELC_EVENT_GPT0_COUNTER_OVERFLOW,
+	[4] = ELC_EVENT_GPT4_COUNTER_OVERFLOW,
+	[5] = ELC_EVENT_GPT5_COUNTER_OVERFLOW,
+	[6] = ELC_EVENT_GPT6_COUNTER_OVERFLOW,
+	[7] = ELC_EVENT_GPT7_COUNTER_OVERFLOW,
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static uint64_t sim_gpt_period(uint32_t u32_Ch);
+static uint64_t sim_gpt_counts_ns(uint32_t u32_Ch, uint32_t u32_Count);
+static uint32_t sim_gpt_count(uint32_t u32_Ch, uint64_t u64_Now);
+static bool sim_gpt_event_used(uint32_t u32_Ch);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  GPTのオーバーフロー周期を取得する
+  * @param  u32_Ch: チャネル
+  * @retval 周期[ns]
+  */
+static uint64_t sim_gpt_period(uint32_t u32_Ch)
+{
+	return sim_gpt_counts_ns(u32_Ch, g_sim_hw->gpt[u32_Ch].GTPR + 1);
+}
+
+/**
+  * @brief  GPTのカウント数を時間に換算する
+  * @param  u32_Ch: チャネル
+  * @param  u32_Count: カウント数
+  * @retval 時間[ns]
+  */
+static uint64_t sim_gpt_counts_ns(uint32_t u32_Ch, uint32_t u32_Count)
+{
+	uint64_t u64_Counts = (uint64_t)u32_Count << (2 * g_sim_hw->gpt[u32_Ch].GTCR_b.TPCS);
+
+	return (u64_Counts * SIM_NS_PER_SEC) / R_FSP_SystemClockHzGet(FSP_PRIV_CLOCK_PCLKD);
+}
+
+/**
+  * @brief  GPTの現在のカウント値を求める
+  * @param  u32_Ch: チャネル
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval カウント値(停止中は保持している値)
+  */
+static uint32_t sim_gpt_count(uint32_t u32_Ch, uint64_t u64_Now)
+{
+	const R_GPT0_Type *pst_Gpt = &g_sim_hw->gpt[u32_Ch];
+	uint64_t u64_Elapsed;
+	uint64_t u64_Count;
+
+	if (!bls_GptRun[u32_Ch]) {
+		return pst_Gpt->GTCNT;
+	}
+	u64_Elapsed = (u64_Now > u64s_GptBase[u32_Ch]) ? (u64_Now - u64s_GptBase[u32_Ch]) : 0;
+	u64_Count = ((u64_Elapsed * R_FSP_SystemClockHzGet(FSP_PRIV_CLOCK_PCLKD)) / SIM_NS_PER_SEC) >> (2 * pst_Gpt->GTCR_b.TPCS);
+	/* オーバーフロー処理(sim_gpt_update)前の周期もカウンタは0から数え直している */
+	return (uint32_t)(u64_Count % ((uint64_t)pst_Gpt->GTPR + 1));
+}
+
+/**
+  * @brief  GPTレジスタアクセス
+  * @param  u32_Member: gpt[0]からのオフセット
+  * @param  bl_Write: 書き込みアクセス
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   GTCR.CSTの書き込みでカウントの開始/停止を、GTCNTの書き込みで
+  *         カウント位置をアクセスした時刻に合わせる
+  */
+void sim_gpt_access(size_t u32_Member, bool bl_Write, uint64_t u64_Now)
+{
+	uint32_t u32_Ch = (uint32_t)(u32_Member / sizeof(R_GPT0_Type));
+	size_t u32_Reg = u32_Member % sizeof(R_GPT0_Type);
+	R_GPT0_Type *pst_Gpt;
+
+	if (u32_Ch >= SIM_GPT_NUM) {
+		return;
+	}
+	pst_Gpt = &g_sim_hw->gpt[u32_Ch];
+	if (!bl_Write) {
+		if (u32_Reg == offsetof(R_GPT0_Type, GTCNT)) {
+			pst_Gpt->GTCNT = sim_gpt_count(u32_Ch, u64_Now);
+		}
+		return;
+	}
+	if (u32_Reg == offsetof(R_GPT0_Type, GTCR)) {
+		if (pst_Gpt->GTCR_b.CST && !bls_GptRun[u32_Ch]) {
+			/* 停止中に書き込まれたカウント値から開始する */
+			bls_GptRun[u32_Ch] = true;
+			u64s_GptBase[u32_Ch] = u64_Now - sim_gpt_counts_ns(u32_Ch, pst_Gpt->GTCNT);
+		}
+		else if (!pst_Gpt->GTCR_b.CST && bls_GptRun[u32_Ch]) {
+			/* 停止時のカウント値を保持する */
+			pst_Gpt->GTCNT = sim_gpt_count(u32_Ch, u64_Now);
+			bls_GptRun[u32_Ch] = false;
+		}
+	}
+	else if ((u32_Reg == offsetof(R_GPT0_Type, GTCNT)) && bls_GptRun[u32_Ch]) {
+		u64s_GptBase[u32_Ch] = u64_Now - sim_gpt_counts_ns(u32_Ch, pst_Gpt->GTCNT);
+	}
+}
+
+/**
+  * @brief  ELCイベントによるGPTの開始/クリア
+  * @param  en_Event: ELCイベント番号
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   GTSSR/GTCSRのELC_GPTA～ELC_GPTDを模擬する
+  */
+void sim_gpt_elc(elc_event_t en_Event, uint64_t u64_Now)
+{
+	uint32_t u32_Bit;
+	uint32_t _i;
+	uint32_t _j;
+
+	if ((g_sim_elc.ELCR & SIM_ELC_ELCON) == 0) {
+		return;
+	}
+	for (_i=0; _i<SIM_ELC_GPT_NUM; _i++) {
+		if (g_sim_elc.ELSR[ELC_PERIPHERAL_GPT_A + _i].HA != (uint16_t)en_Event) {
+			continue;
+		}
+		u32_Bit = SIM_GTSSR_SSELCA << _i;
+		for (_j=0; _j<SIM_GPT_NUM; _j++) {
+			/* 停止中のカウンタはCPUが書き込んだ値(0)から開始する */
+			if ((g_sim_hw->gpt[_j].GTSSR & u32_Bit) && !g_sim_hw->gpt[_j].GTCR_b.CST) {
+				g_sim_hw->gpt[_j].GTCR_b.CST = 1;
+				bls_GptRun[_j] = true;
+				u64s_GptBase[_j] = u64_Now;
+			}
+			if (g_sim_hw->gpt[_j].GTCSR & u32_Bit) {
+				u64s_GptBase[_j] = u64_Now;
+			}
+		}
+	}
+}
+
+/**
+  * @brief  GPTのオーバーフローを発生させる
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   CPUによるGTCR.CSTの書き込みはsim_gpt_access()で反映済み
+  */
+void sim_gpt_update(uint64_t u64_Now)
+{
+	uint64_t u64_Period;
+	uint32_t _i;
+
+	for (_i=0; _i<SIM_GPT_NUM; _i++) {
+		if (!g_sim_hw->gpt[_i].GTCR_b.CST) {
+			bls_GptRun[_i] = false;
+			continue;
+		}
+		if (!bls_GptRun[_i]) {
+			bls_GptRun[_i] = true;
+			u64s_GptBase[_i] = u64_Now;
+		}
+		u64_Period = sim_gpt_period(_i);
+		if (u64_Now >= (u64s_GptBase[_i] + u64_Period)) {
+			/* 複数周期の経過は1回のイベントにまとめる */
+			u64s_GptBase[_i] += ((u64_Now - u64s_GptBase[_i]) / u64_Period) * u64_Period;
+			if (ens_GptOverflow[_i] != ELC_EVENT_NONE) {
+				simRaiseEvent(ens_GptOverflow[_i]);
+			}
+		}
+	}
+}
+
+/**
+  * @brief  GPTのオーバーフローを割り込みで使用しているか
+  * @param  u32_Ch: チャネル
+  * @retval true:使用している
+  */
+static bool sim_gpt_event_used(uint32_t u32_Ch)
+{
+	uint32_t _i;
+
+	if (ens_GptOverflow[u32_Ch] == ELC_EVENT_NONE) {
+		return false;
+	}
+	for (_i=0; _i<SIM_IRQ_NUM; _i++) {
+		if (g_sim_icu.IELSR_b[_i].IELS == (uint32_t)ens_GptOverflow[u32_Ch]) {
+			return true;
+		}
+	}
+	/* ELCでADC0を起動している場合も時刻を合わせる */
+	if ((g_sim_elc.ELCR & SIM_ELC_ELCON)
+	 && (g_sim_elc.ELSR[ELC_PERIPHERAL_ADC0].HA == (uint16_t)ens_GptOverflow[u32_Ch])
+	 && (g_sim_adc0.ADCSR & SIM_ADCSR_TRGE)) {
+		return true;
+	}
+	return false;
+}
+
+/**
+  * @brief  GPTの次のイベント時刻を反映する
+  * @param  pu64_Next: 次のイベント時刻[ns](より早ければ更新する)
+  * @retval None
+  */
+void sim_gpt_schedule(uint64_t *pu64_Next)
+{
+	uint64_t u64_Overflow;
+	uint32_t _i;
+
+	for (_i=0; _i<SIM_GPT_NUM; _i++) {
+		/* 割り込みで使用しているオーバーフローだけ時刻を合わせる */
+		if (bls_GptRun[_i] && sim_gpt_event_used(_i)) {
+			u64_Overflow = u64s_GptBase[_i] + sim_gpt_period(_i);
+			if (u64_Overflow < *pu64_Next) {
+				*pu64_Next = u64_Overflow;
+			}
+		}
+	}
+}
@@ -0,0 +1,778 @@
+/**
+  ******************************************************************************
+  * @file           : sim_iic.c
+  * @brief          : RA4M1レジスタモデル IIC1
+  ******************************************************************************
+  * @note   IIC1はマスター動作をバイト単位(9クロック)の時間で模擬し、バスには
+  *         EEPROM(24C02相当,0x50)と温度センサー(LM75相当,0x48)を接続する。
+  *         センサーの障害注入レジスタ(0xF0)への書き込みで、次の読み出しでの
+  *         長いクロックストレッチやストップ条件後のSDA固定を再現できる。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim_local.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* EEPROM(24C02相当) */
+typedef struct {
+	uint8_t u8_ptr;								/* メモリアドレス					*/
+	uint8_t u8_base;							/* 書き込み中のページの先頭			*/
+	uint8_t u8_page[8];							/* ページバッファ					*/
+	uint8_t u8_pending;							/* ページバッファの書き込み済みbit	*/
+	uint64_t u64_busy_until;					/* 書き込み完了の時刻[ns]			*/
+} SimIicEeprom;
+
+/* 温度センサー(LM75相当) */
+typedef struct {
+	uint8_t u8_ptr;								/* レジスタポインター				*/
+	uint8_t u8_byte;							/* 温度レジスタの読み出し位置		*/
+	uint8_t u8_config;							/* 設定レジスタ						*/
+	uint8_t u8_fault;							/* 障害注入レジスタ(SIM_IIC_FAULT_xxx)	*/
+} SimIicSensor;
+
+/* Private define ------------------------------------------------------------*/
+
+/* IIC1 */
+#define SIM_IIC_RISE_FALL	(1300)				/* SCL立ち上がり+立ち下がり時間[ns]	*/
+#define SIM_IIC_NO_SLAVE	(0xFF)
+#define SIM_IIC_EEPROM		(0x50)				/* EEPROMのアドレス					*/
+#define SIM_IIC_EEPROM_SIZE	(256)				/* EEPROMの容量[byte]				*/
+#define SIM_IIC_EEPROM_PAGE	(8)					/* EEPROMのページサイズ[byte]		*/
+#define SIM_IIC_EEPROM_WRITE	(5000000)		/* EEPROMの書き込み時間[ns]			*/
+#define SIM_IIC_SENSOR		(0x48)				/* 温度センサーのアドレス			*/
+#define SIM_IIC_SENSOR_CONV	(250000)			/* 温度読み出しのクロックストレッチ[ns]	*/
+#define SIM_IIC_SENSOR_STEP	(100000000ULL)		/* 温度の変化周期[ns]				*/
+#define SIM_IIC_REG_TEMP	(0x00)				/* 温度レジスタ						*/
+#define SIM_IIC_REG_CONFIG	(0x01)				/* 設定レジスタ						*/
+#define SIM_IIC_REG_FAULT	(0xF0)				/* 障害注入レジスタ(模擬専用)		*/
+#define SIM_IIC_FAULT_STRETCH	(0x01)			/* 次の読み出しで長いクロックストレッチ	*/
+#define SIM_IIC_FAULT_STUCK	(0x02)				/* 次の読み出しのストップ条件後にSDAを保持	*/
+#define SIM_IIC_FAULT_STRETCH_NS	(100000000ULL)	/* 障害時のクロックストレッチ[ns]	*/
+#define SIM_IIC_FAULT_CLOCKS	(5)				/* 障害時にSDAを保持するクロック数	*/
+#define SIM_IIC_IDLE		(0)					/* バス開放							*/
+#define SIM_IIC_START		(1)					/* スタート/再スタート条件の発行中	*/
+#define SIM_IIC_TX_WAIT		(2)					/* ICDRTへの書き込み待ち(SCL Low)	*/
+#define SIM_IIC_TX			(3)					/* 1byte送信中						*/
+#define SIM_IIC_TX_NACK		(4)					/* NACK受信で中断(SP待ち)			*/
+#define SIM_IIC_RX_WAIT		(5)					/* ICDRRの読み出し待ち(SCL Low)		*/
+#define SIM_IIC_RX			(6)					/* 1byte受信中						*/
+#define SIM_IIC_STOP		(7)					/* ストップ条件の発行中				*/
+#define SIM_IIC_HOLD_DUMMY	(0)					/* アドレス送信後(ダミーリード待ち)	*/
+#define SIM_IIC_HOLD_WAIT	(1)					/* ICMR3.WAIT						*/
+#define SIM_IIC_HOLD_STALL	(2)					/* 前のデータが未読					*/
+#define SIM_IIC_HOLD_LAST	(3)					/* NACKを返した(SP待ち)				*/
+#define IIC_ICCR1_ICE		(0x80)
+#define IIC_ICCR1_IICRST	(0x40)
+#define IIC_ICCR1_CLO		(0x20)
+#define IIC_ICCR1_SOWP		(0x10)
+#define IIC_ICCR1_SCLO		(0x08)
+#define IIC_ICCR1_SDAO		(0x04)
+#define IIC_ICCR1_SCLI		(0x02)
+#define IIC_ICCR1_SDAI		(0x01)
+#define IIC_ICCR2_BBSY		(0x80)
+#define IIC_ICCR2_MST		(0x40)
+#define IIC_ICCR2_TRS		(0x20)
+#define IIC_ICCR2_SP		(0x08)
+#define IIC_ICCR2_RS		(0x04)
+#define IIC_ICCR2_ST		(0x02)
+#define IIC_ICMR3_WAIT		(0x40)
+#define IIC_ICMR3_ACKWP		(0x10)
+#define IIC_ICMR3_ACKBT		(0x08)
+#define IIC_ICFER_TMOE		(0x01)
+#define IIC_SR2_TDRE		(0x80)				/* ICIERの同じbitで割り込み許可		*/
+#define IIC_SR2_TEND		(0x40)
+#define IIC_SR2_RDRF		(0x20)
+#define IIC_SR2_NACKF		(0x10)
+#define IIC_SR2_STOP		(0x08)
+#define IIC_SR2_START		(0x04)
+#define IIC_SR2_AL			(0x02)
+#define IIC_SR2_TMOF		(0x01)
+#define IIC_SR2_W0C			(0x1F)				/* 0書き込みで解除するフラグ(EEI要因)	*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* IIC1(u8s_Lockで排他) */
+static uint8_t u8s_IicState;						/* バスの状態(SIM_IIC_xxx)			*/
+static uint8_t u8s_IicHold;							/* 受信でSCLを保持している理由		*/
+static uint64_t u64s_IicNext;						/* バス動作の完了時刻[ns](0:無し)	*/
+static uint64_t u64s_IicTmoTime;					/* タイムアウト検出の時刻[ns](0:無し)	*/
+static uint64_t u64s_IicCloEnd;						/* 追加クロックの完了時刻[ns](0:無し)	*/
+static uint64_t u64s_IicSclLowUntil;				/* スレーブがSCLを解放する時刻[ns]	*/
+static uint8_t u8s_IicStuckClocks;					/* スレーブがSDAをLowに保持するクロック数	*/
+static bool bls_IicStuckArm;						/* 次のストップ条件後にSDAを保持する	*/
+static uint8_t u8s_IicCr1;							/* ICCR1(ICE/IICRST/SOWP)			*/
+static uint8_t u8s_IicCr2;							/* ICCR2(BBSY/MST/TRS)				*/
+static uint8_t u8s_IicReq;							/* 保留中のST/RS/SP要求				*/
+static uint8_t u8s_IicMr3;							/* ICMR3							*/
+static uint8_t u8s_IicSr2;							/* ICSR2							*/
+static uint8_t u8s_IicIer;							/* ICIER							*/
+static uint8_t u8s_IicRaise;						/* 発生させる割り込み要因(ICSR2のbit)	*/
+static bool bls_IicFlushing;						/* 割り込み要因の発生中				*/
+static uint8_t u8s_IicShift;						/* 送信中のデータ					*/
+static uint8_t u8s_IicRxData;						/* 受信中のデータ					*/
+static bool bls_IicAddress;							/* 次の送信はアドレス				*/
+static bool bls_IicRead;							/* マスター受信						*/
+static uint8_t u8s_IicSlave = SIM_IIC_NO_SLAVE;		/* 選択中のスレーブのアドレス		*/
+static uint8_t u8s_IicSlaveIndex;					/* アドレス後のデータ数				*/
+static uint8_t u8s_IicEepromMem[SIM_IIC_EEPROM_SIZE];	/* EEPROMの内容					*/
+static SimIicEeprom sts_IicEeprom;
+static SimIicSensor sts_IicSensor;
+static uint64_t u64s_IicBytes;
+static uint64_t u64s_IicStarts;
+static uint64_t u64s_IicNacks;
+static uint64_t u64s_IicStretches;
+static uint64_t u64s_IicTimeouts;
+static uint64_t u64s_IicArbLost;
+static uint64_t u64s_IicCloCount;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint64_t sim_iic_bit_time(void);
+static uint64_t sim_iic_timeout(void);
+static void sim_iic_event(uint64_t u64_Time);
+static void sim_iic_kick(uint64_t u64_Now);
+static void sim_iic_load(uint64_t u64_Now);
+static void sim_iic_rx_start(uint64_t u64_Now);
+static void sim_iic_drr_read(uint64_t u64_Now);
+static void sim_iic_reset(void);
+static void sim_iic_sync(uint64_t u64_Now);
+static void sim_iic_raise(uint8_t u8_Flags);
+static void sim_iic_flush(void);
+static bool sim_iic_slave_address(uint8_t u8_Byte, uint64_t u64_Now);
+static bool sim_iic_slave_write(uint8_t u8_Data, uint64_t u64_Now);
+static uint8_t sim_iic_slave_read(uint64_t *pu64_Stretch, uint64_t u64_Now);
+static void sim_iic_slave_stop(uint64_t u64_Now);
+static uint64_t sim_iic_next_event(void);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  IIC1のビット時間
+  * @param  None
+  * @retval 1bitの時間[ns]
+  * @note   {(ICBRH+1) + (ICBRL+1)} / IICφ + tr + tf (IICφ = PCLKB / 2^CKS)
+  */
+static uint64_t sim_iic_bit_time(void)
+{
+	const R_IIC0_Type *pst_Iic = &g_sim_hw->iic[1];
+	uint64_t u64_Counts = (uint64_t)((pst_Iic->ICBRH & 0x1F) + 1 + (pst_Iic->ICBRL & 0x1F) + 1);
+
+	u64_Counts <<= (pst_Iic->ICMR1 >> 4) & 0x7;
+	return ((u64_Counts * SIM_NS_PER_SEC) / R_FSP_SystemClockHzGet(FSP_PRIV_CLOCK_PCLKB)) + SIM_IIC_RISE_FALL;
+}
+
+/**
+  * @brief  IIC1のタイムアウト検出時間(ロングモード)
+  * @param  None
+  * @retval 検出時間[ns]
+  */
+static uint64_t sim_iic_timeout(void)
+{
+	uint64_t u64_Counts = 65536ULL << ((g_sim_hw->iic[1].ICMR1 >> 4) & 0x7);
+
+	return (u64_Counts * SIM_NS_PER_SEC) / R_FSP_SystemClockHzGet(FSP_PRIV_CLOCK_PCLKB);
+}
+
+/**
+  * @brief  IIC1レジスタのアクセス
+  * @param  u32_Member: R_IIC0_Type内のオフセット
+  * @param  bl_Write: 書き込みアクセス
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   ICSR2のフラグは0の書き込みでだけ解除でき、ICCR2のBBSY/MST/TRSと
+  *         ICMR3.ACKBT(ACKWP=0の時)は書き込んでもモデルの値に戻す
+  */
+void sim_iic_access(size_t u32_Member, bool bl_Write, uint64_t u64_Now)
+{
+	/* 書き込み値はモデルの反映(sim_iic_sync)で上書きされる前に取り出す */
+	uint8_t u8_Data = ((const volatile uint8_t *)&g_sim_hw->iic[1])[u32_Member];
+
+	sim_iic_update(u64_Now);
+	if (bl_Write) {
+		switch (u32_Member) {
+		case offsetof(R_IIC0_Type, ICCR1):
+			if ((u8_Data & IIC_ICCR1_IICRST) && !(u8s_IicCr1 & IIC_ICCR1_IICRST)) {
+				sim_iic_reset();
+			}
+			if ((u8_Data & IIC_ICCR1_CLO) && (u64s_IicCloEnd == 0) && (u8_Data & IIC_ICCR1_ICE) && !(u8_Data & IIC_ICCR1_IICRST)) {
+				u64s_IicCloEnd = u64_Now + sim_iic_bit_time();
+			}
+			u8s_IicCr1 = u8_Data & (IIC_ICCR1_ICE | IIC_ICCR1_IICRST | IIC_ICCR1_SOWP);
+			break;
+		case offsetof(R_IIC0_Type, ICCR2):
+			if ((u8s_IicCr1 & (IIC_ICCR1_ICE | IIC_ICCR1_IICRST)) == IIC_ICCR1_ICE) {
+				u8s_IicReq |= u8_Data & (IIC_ICCR2_ST | IIC_ICCR2_RS | IIC_ICCR2_SP);
+			}
+			break;
+		case offsetof(R_IIC0_Type, ICMR3):
+			if ((u8s_IicMr3 & IIC_ICMR3_ACKWP) == 0) {
+				u8_Data = (uint8_t)((u8_Data & ~IIC_ICMR3_ACKBT) | (u8s_IicMr3 & IIC_ICMR3_ACKBT));
+			}
+			u8s_IicMr3 = u8_Data;
+			break;
+		case offsetof(R_IIC0_Type, ICSR2):
+			u8s_IicSr2 &= (uint8_t)(u8_Data | ~IIC_SR2_W0C);
+			break;
+		case offsetof(R_IIC0_Type, ICIER):
+			/* 許可した時点で立っている要因は割り込みにする */
+			sim_iic_raise(u8s_IicSr2 & (uint8_t)~u8s_IicIer);
+			u8s_IicIer = u8_Data;
+			break;
+		case offsetof(R_IIC0_Type, ICDRT):
+			u8s_IicSr2 &= (uint8_t)~(IIC_SR2_TDRE | IIC_SR2_TEND);
+			if (u8s_IicState == SIM_IIC_TX_WAIT) {
+				sim_iic_load(u64_Now);
+			}
+			break;
+		default:
+			break;
+		}
+	}
+	else if (u32_Member == offsetof(R_IIC0_Type, ICDRR)) {
+		sim_iic_drr_read(u64_Now);
+	}
+	sim_iic_kick(u64_Now);
+	sim_iic_sync(u64_Now);
+	sim_iic_flush();
+}
+
+/**
+  * @brief  IIC1の時間経過処理
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+void sim_iic_update(uint64_t u64_Now)
+{
+	uint64_t u64_Time;
+
+	while ((u64s_IicNext != 0) && (u64_Now >= u64s_IicNext)) {
+		u64_Time = u64s_IicNext;
+		u64s_IicNext = 0;
+		sim_iic_event(u64_Time);
+		sim_iic_kick(u64_Time);
+	}
+	if ((u64s_IicTmoTime != 0) && (u64_Now >= u64s_IicTmoTime)) {
+		/* SCLがLowのまま(クロックストレッチ)でタイムアウト */
+		u64s_IicTmoTime = 0;
+		u8s_IicSr2 |= IIC_SR2_TMOF;
+		sim_iic_raise(IIC_SR2_TMOF);
+		u64s_IicTimeouts++;
+	}
+	if ((u64s_IicCloEnd != 0) && (u64_Now >= u64s_IicCloEnd)) {
+		/* 追加クロックでSDAを保持しているスレーブのビットが進む */
+		u64s_IicCloEnd = 0;
+		u64s_IicCloCount++;
+		if (u8s_IicStuckClocks > 0) {
+			u8s_IicStuckClocks--;
+		}
+	}
+	sim_iic_sync(u64_Now);
+	sim_iic_flush();
+}
+
+/**
+  * @brief  IIC1のバス動作の完了
+  * @param  u64_Time: 完了時刻[ns]
+  * @retval None
+  */
+static void sim_iic_event(uint64_t u64_Time)
+{
+	bool bl_Ack;
+
+	switch (u8s_IicState) {
+	case SIM_IIC_START:
+		/* スタート/再スタート条件: アドレスの書き込みを待つ */
+		u8s_IicCr2 = IIC_ICCR2_BBSY | IIC_ICCR2_MST | IIC_ICCR2_TRS;
+		u8s_IicSr2 = (uint8_t)((u8s_IicSr2 & ~IIC_SR2_TEND) | IIC_SR2_START | IIC_SR2_TDRE);
+		sim_iic_raise(IIC_SR2_START | IIC_SR2_TDRE);
+		u8s_IicState = SIM_IIC_TX_WAIT;
+		bls_IicAddress = true;
+		u8s_IicSlave = SIM_IIC_NO_SLAVE;
+		u64s_IicStarts++;
+		break;
+	case SIM_IIC_TX:
+		/* 9クロック目: スレーブの応答 */
+		u64s_IicBytes++;
+		if (bls_IicAddress) {
+			bls_IicAddress = false;
+			bls_IicRead = ((u8s_IicShift & 0x01) != 0);
+			bl_Ack = sim_iic_slave_address(u8s_IicShift, u64_Time);
+		}
+		else {
+			bl_Ack = sim_iic_slave_write(u8s_IicShift, u64_Time);
+		}
+		if (!bl_Ack) {
+			/* NACK: ICFER.NACKE=1で送信を中断する */
+			u8s_IicSr2 |= IIC_SR2_NACKF;
+			sim_iic_raise(IIC_SR2_NACKF);
+			u8s_IicState = SIM_IIC_TX_NACK;
+			u64s_IicNacks++;
+		}
+		else if (bls_IicRead) {
+			/* マスター受信へ切り替え: ダミーリードで受信を開始する */
+			u8s_IicCr2 &= (uint8_t)~IIC_ICCR2_TRS;
+			u8s_IicSr2 = (uint8_t)((u8s_IicSr2 & ~(IIC_SR2_TDRE | IIC_SR2_TEND)) | IIC_SR2_RDRF);
+			*(volatile uint8_t *)&g_sim_hw->iic[1].ICDRR = u8s_IicShift;
+			sim_iic_raise(IIC_SR2_RDRF);
+			u8s_IicState = SIM_IIC_RX_WAIT;
+			u8s_IicHold = SIM_IIC_HOLD_DUMMY;
+		}
+		else if ((u8s_IicSr2 & IIC_SR2_TDRE) == 0) {
+			sim_iic_load(u64_Time);
+		}
+		else {
+			u8s_IicSr2 |= IIC_SR2_TEND;
+			sim_iic_raise(IIC_SR2_TEND);
+			u8s_IicState = SIM_IIC_TX_WAIT;
+		}
+		break;
+	case SIM_IIC_RX:
+		if (u8s_IicSr2 & IIC_SR2_RDRF) {
+			/* 前のデータが未読: SCLをLowに保持する */
+			u8s_IicState = SIM_IIC_RX_WAIT;
+			u8s_IicHold = SIM_IIC_HOLD_STALL;
+			break;
+		}
+		/* 9クロック目: ACK/NACKを返す */
+		u64s_IicBytes++;
+		*(volatile uint8_t *)&g_sim_hw->iic[1].ICDRR = u8s_IicRxData;
+		u8s_IicSr2 |= IIC_SR2_RDRF;
+		sim_iic_raise(IIC_SR2_RDRF);
+		if (u8s_IicMr3 & IIC_ICMR3_ACKBT) {
+			u8s_IicState = SIM_IIC_RX_WAIT;
+			u8s_IicHold = SIM_IIC_HOLD_LAST;
+		}
+		else if (u8s_IicMr3 & IIC_ICMR3_WAIT) {
+			u8s_IicState = SIM_IIC_RX_WAIT;
+			u8s_IicHold = SIM_IIC_HOLD_WAIT;
+		}
+		else {
+			sim_iic_rx_start(u64_Time);
+		}
+		break;
+	case SIM_IIC_STOP:
+		u8s_IicCr2 = 0;
+		u8s_IicSr2 = (uint8_t)((u8s_IicSr2 & ~(IIC_SR2_TDRE | IIC_SR2_TEND)) | IIC_SR2_STOP);
+		sim_iic_raise(IIC_SR2_STOP);
+		u8s_IicState = SIM_IIC_IDLE;
+		sim_iic_slave_stop(u64_Time);
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+  * @brief  IIC1の発行要求(ST/RS/SP)を実行する
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   要求はバスが要求を受け付けられる状態になるまで保留する
+  */
+static void sim_iic_kick(uint64_t u64_Now)
+{
+	if ((u8s_IicCr1 & (IIC_ICCR1_ICE | IIC_ICCR1_IICRST)) != IIC_ICCR1_ICE) {
+		u8s_IicReq = 0;
+		return;
+	}
+	if ((u8s_IicReq & IIC_ICCR2_ST) && (u8s_IicState == SIM_IIC_IDLE)) {
+		u8s_IicReq &= (uint8_t)~IIC_ICCR2_ST;
+		if ((u64_Now < u64s_IicSclLowUntil) || (u8s_IicStuckClocks > 0)) {
+			/* SCL/SDAがLowのまま: スタート条件を発行できない */
+			u8s_IicSr2 |= IIC_SR2_AL;
+			sim_iic_raise(IIC_SR2_AL);
+			u64s_IicArbLost++;
+		}
+		else {
+			u8s_IicState = SIM_IIC_START;
+			u64s_IicNext = u64_Now + sim_iic_bit_time();
+		}
+	}
+	if ((u8s_IicReq & IIC_ICCR2_RS) && (u8s_IicState == SIM_IIC_TX_WAIT)) {
+		u8s_IicReq &= (uint8_t)~IIC_ICCR2_RS;
+		u8s_IicSr2 &= (uint8_t)~IIC_SR2_TEND;
+		u8s_IicState = SIM_IIC_START;
+		u64s_IicNext = u64_Now + sim_iic_bit_time();
+	}
+	if ((u8s_IicReq & IIC_ICCR2_SP)
+	 && ((u8s_IicState == SIM_IIC_TX_WAIT) || (u8s_IicState == SIM_IIC_TX_NACK)
+	  || ((u8s_IicState == SIM_IIC_RX_WAIT) && (u8s_IicHold == SIM_IIC_HOLD_LAST) && !(u8s_IicSr2 & IIC_SR2_RDRF)))) {
+		u8s_IicReq &= (uint8_t)~IIC_ICCR2_SP;
+		u8s_IicState = SIM_IIC_STOP;
+		u64s_IicNext = u64_Now + sim_iic_bit_time();
+	}
+}
+
+/**
+  * @brief  ICDRTのデータをシフトレジスタに移して送信を開始する
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+static void sim_iic_load(uint64_t u64_Now)
+{
+	u8s_IicShift = g_sim_hw->iic[1].ICDRT;
+	u8s_IicSr2 |= IIC_SR2_TDRE;
+	sim_iic_raise(IIC_SR2_TDRE);
+	u8s_IicState = SIM_IIC_TX;
+	u64s_IicNext = u64_Now + (9 * sim_iic_bit_time());
+}
+
+/**
+  * @brief  1byteの受信を開始する
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   スレーブのクロックストレッチ中はSCLがLowになり、タイムアウト
+  *         検出(ICFER.TMOE)の時間を超えるとTMOFを立てる
+  */
+static void sim_iic_rx_start(uint64_t u64_Now)
+{
+	uint64_t u64_Stretch = 0;
+
+	u8s_IicRxData = sim_iic_slave_read(&u64_Stretch, u64_Now);
+	u8s_IicState = SIM_IIC_RX;
+	u64s_IicNext = u64_Now + (9 * sim_iic_bit_time()) + u64_Stretch;
+	if (u64_Stretch > 0) {
+		u64s_IicStretches++;
+		u64s_IicSclLowUntil = u64_Now + u64_Stretch;
+		if ((g_sim_hw->iic[1].ICFER & IIC_ICFER_TMOE) && (u64_Stretch >= sim_iic_timeout())) {
+			u64s_IicTmoTime = u64_Now + sim_iic_timeout();
+		}
+	}
+}
+
+/**
+  * @brief  ICDRRの読み出し
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+static void sim_iic_drr_read(uint64_t u64_Now)
+{
+	u8s_IicSr2 &= (uint8_t)~IIC_SR2_RDRF;
+	if (u8s_IicState != SIM_IIC_RX_WAIT) {
+		return;
+	}
+	switch (u8s_IicHold) {
+	case SIM_IIC_HOLD_DUMMY:
+	case SIM_IIC_HOLD_WAIT:
+		sim_iic_rx_start(u64_Now);
+		break;
+	case SIM_IIC_HOLD_STALL:
+		/* 保留していた9クロック目を出力する */
+		u8s_IicState = SIM_IIC_RX;
+		u64s_IicNext = u64_Now + sim_iic_bit_time();
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+  * @brief  IIC1の内部リセット(ICCR1.IICRST)
+  * @param  None
+  * @retval None
+  * @note   スレーブの状態(クロックストレッチ,SDAの保持)は変わらない
+  */
+static void sim_iic_reset(void)
+{
+	u8s_IicState = SIM_IIC_IDLE;
+	u64s_IicNext = 0;
+	u64s_IicTmoTime = 0;
+	u64s_IicCloEnd = 0;
+	u8s_IicReq = 0;
+	u8s_IicCr2 = 0;
+	u8s_IicSr2 = 0;
+	u8s_IicRaise = 0;
+	u8s_IicSlave = SIM_IIC_NO_SLAVE;
+	sts_IicEeprom.u8_pending = 0;
+}
+
+/**
+  * @brief  モデルの値をレジスタに反映する
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+static void sim_iic_sync(uint64_t u64_Now)
+{
+	R_IIC0_Type *pst_Iic = &g_sim_hw->iic[1];
+	uint8_t u8_Cr1 = u8s_IicCr1 | IIC_ICCR1_SCLO | IIC_ICCR1_SDAO;
+
+	if (u64s_IicCloEnd != 0) {
+		u8_Cr1 |= IIC_ICCR1_CLO;
+	}
+	if (u64_Now >= u64s_IicSclLowUntil) {
+		u8_Cr1 |= IIC_ICCR1_SCLI;
+	}
+	if (u8s_IicStuckClocks == 0) {
+		u8_Cr1 |= IIC_ICCR1_SDAI;
+	}
+	pst_Iic->ICCR1 = u8_Cr1;
+	pst_Iic->ICCR2 = u8s_IicCr2 | u8s_IicReq;
+	pst_Iic->ICMR3 = u8s_IicMr3;
+	pst_Iic->ICSR2 = u8s_IicSr2;
+}
+
+/**
+  * @brief  割り込み要因を記録する
+  * @param  u8_Flags: 立てたICSR2のフラグ
+  * @retval None
+  * @note   ICIERで許可している要因だけをsim_iic_flush()で発生させる
+  */
+static void sim_iic_raise(uint8_t u8_Flags)
+{
+	u8s_IicRaise |= u8_Flags;
+}
+
+/**
+  * @brief  記録した割り込み要因を発生させる
+  * @param  None
+  * @retval None
+  * @note   DTCの転送で再びIIC1のレジスタをアクセスするため、モデルの更新が
+  *         済んでから発生させる。DTC転送で発生した要因も続けて処理する
+  */
+static void sim_iic_flush(void)
+{
+	uint8_t u8_Raise;
+
+	if (bls_IicFlushing) {
+		return;
+	}
+	bls_IicFlushing = true;
+	while ((u8_Raise = (uint8_t)(u8s_IicRaise & u8s_IicIer)) != 0) {
+		u8s_IicRaise = 0;
+		if (u8_Raise & IIC_SR2_TDRE) {
+			simRaiseEvent(ELC_EVENT_IIC1_TXI);
+		}
+		if (u8_Raise & IIC_SR2_RDRF) {
+			simRaiseEvent(ELC_EVENT_IIC1_RXI);
+		}
+		if (u8_Raise & IIC_SR2_TEND) {
+			simRaiseEvent(ELC_EVENT_IIC1_TEI);
+		}
+		if (u8_Raise & IIC_SR2_W0C) {
+			simRaiseEvent(ELC_EVENT_IIC1_EEI);
+		}
+	}
+	u8s_IicRaise = 0;
+	bls_IicFlushing = false;
+}
+
+/**
+  * @brief  スレーブ: アドレスの受信
+  * @param  u8_Byte: アドレス+R/W
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval true:ACK
+  * @note   EEPROMは書き込み中(SIM_IIC_EEPROM_WRITE)はNACKを返す
+  */
+static bool sim_iic_slave_address(uint8_t u8_Byte, uint64_t u64_Now)
+{
+	uint8_t u8_Addr = (uint8_t)(u8_Byte >> 1);
+
+	u8s_IicSlave = SIM_IIC_NO_SLAVE;
+	u8s_IicSlaveIndex = 0;
+	if ((u8_Addr == SIM_IIC_EEPROM) && (u64_Now >= sts_IicEeprom.u64_busy_until)) {
+		u8s_IicSlave = u8_Addr;
+		sts_IicEeprom.u8_pending = 0;
+	}
+	else if (u8_Addr == SIM_IIC_SENSOR) {
+		u8s_IicSlave = u8_Addr;
+	}
+	return (u8s_IicSlave != SIM_IIC_NO_SLAVE);
+}
+
+/**
+  * @brief  スレーブ: データの受信
+  * @param  u8_Data: データ
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval true:ACK
+  * @note   先頭はレジスタ/メモリアドレス。EEPROMはページ内で折り返し、
+  *         ストップ条件で書き込む
+  */
+static bool sim_iic_slave_write(uint8_t u8_Data, uint64_t u64_Now)
+{
+	uint8_t u8_Index = u8s_IicSlaveIndex;
+
+	(void)u64_Now;
+	if (u8s_IicSlaveIndex < 0xFF) {
+		u8s_IicSlaveIndex++;
+	}
+	if (u8s_IicSlave == SIM_IIC_EEPROM) {
+		if (u8_Index == 0) {
+			sts_IicEeprom.u8_ptr = u8_Data;
+		}
+		else {
+			sts_IicEeprom.u8_page[sts_IicEeprom.u8_ptr % SIM_IIC_EEPROM_PAGE] = u8_Data;
+			sts_IicEeprom.u8_pending |= (uint8_t)(1U << (sts_IicEeprom.u8_ptr % SIM_IIC_EEPROM_PAGE));
+			sts_IicEeprom.u8_base = (uint8_t)(sts_IicEeprom.u8_ptr & ~(SIM_IIC_EEPROM_PAGE - 1));
+			sts_IicEeprom.u8_ptr = (uint8_t)(sts_IicEeprom.u8_base | ((sts_IicEeprom.u8_ptr + 1) % SIM_IIC_EEPROM_PAGE));
+		}
+		return true;
+	}
+	if (u8s_IicSlave == SIM_IIC_SENSOR) {
+		if (u8_Index == 0) {
+			sts_IicSensor.u8_ptr = u8_Data;
+			sts_IicSensor.u8_byte = 0;
+			return true;
+		}
+		switch (sts_IicSensor.u8_ptr) {
+		case SIM_IIC_REG_CONFIG:
+			sts_IicSensor.u8_config = u8_Data;
+			return true;
+		case SIM_IIC_REG_FAULT:
+			sts_IicSensor.u8_fault = u8_Data;
+			if (g_sim_verbose) {
+				sim_log("IIC1 sensor fault 0x%02X armed", u8_Data);
+			}
+			return true;
+		default:
+			return false;							// 温度レジスタは書き込み不可
+		}
+	}
+	return false;
+}
+
+/**
+  * @brief  スレーブ: データの送信
+  * @param  pu64_Stretch: クロックストレッチ時間[ns]の格納先
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval データ
+  * @note   温度センサーは温度レジスタの読み出しで変換時間だけSCLをLowに保持する
+  */
+static uint8_t sim_iic_slave_read(uint64_t *pu64_Stretch, uint64_t u64_Now)
+{
+	uint16_t u16_Temp;
+	uint8_t u8_Data = 0xFF;
+	uint8_t u8_Index = u8s_IicSlaveIndex;
+
+	if (u8s_IicSlaveIndex < 0xFF) {
+		u8s_IicSlaveIndex++;
+	}
+	if (u8s_IicSlave == SIM_IIC_EEPROM) {
+		u8_Data = u8s_IicEepromMem[sts_IicEeprom.u8_ptr];
+		sts_IicEeprom.u8_ptr++;
+	}
+	else if (u8s_IicSlave == SIM_IIC_SENSOR) {
+		switch (sts_IicSensor.u8_ptr) {
+		case SIM_IIC_REG_TEMP:
+			/* 25.0～28.5℃を0.5℃刻みで変化させる(上位:整数部,下位bit7:0.5℃) */
+			u16_Temp = (uint16_t)((25U << 8) + (((u64_Now / SIM_IIC_SENSOR_STEP) % 8) << 7));
+			u8_Data = (sts_IicSensor.u8_byte == 0) ? (uint8_t)(u16_Temp >> 8) : (uint8_t)u16_Temp;
+			sts_IicSensor.u8_byte ^= 1;
+			if (u8_Index == 0) {
+				*pu64_Stretch = SIM_IIC_SENSOR_CONV;
+			}
+			break;
+		case SIM_IIC_REG_CONFIG:
+			u8_Data = sts_IicSensor.u8_config;
+			break;
+		case SIM_IIC_REG_FAULT:
+			u8_Data = sts_IicSensor.u8_fault;
+			break;
+		default:
+			break;
+		}
+		if (u8_Index == 0) {
+			/* 障害注入: 長いクロックストレッチ/ストップ条件後のSDA保持 */
+			if (sts_IicSensor.u8_fault & SIM_IIC_FAULT_STRETCH) {
+				sts_IicSensor.u8_fault &= (uint8_t)~SIM_IIC_FAULT_STRETCH;
+				*pu64_Stretch = SIM_IIC_FAULT_STRETCH_NS;
+			}
+			if (sts_IicSensor.u8_fault & SIM_IIC_FAULT_STUCK) {
+				sts_IicSensor.u8_fault &= (uint8_t)~SIM_IIC_FAULT_STUCK;
+				bls_IicStuckArm = true;
+			}
+		}
+	}
+	return u8_Data;
+}
+
+/**
+  * @brief  スレーブ: ストップ条件の受信
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+static void sim_iic_slave_stop(uint64_t u64_Now)
+{
+	uint8_t _i;
+
+	if ((u8s_IicSlave == SIM_IIC_EEPROM) && (sts_IicEeprom.u8_pending != 0)) {
+		for (_i=0; _i<SIM_IIC_EEPROM_PAGE; _i++) {
+			if (sts_IicEeprom.u8_pending & (1U << _i)) {
+				u8s_IicEepromMem[sts_IicEeprom.u8_base + _i] = sts_IicEeprom.u8_page[_i];
+			}
+		}
+		sts_IicEeprom.u8_pending = 0;
+		sts_IicEeprom.u64_busy_until = u64_Now + SIM_IIC_EEPROM_WRITE;
+	}
+	if (bls_IicStuckArm) {
+		/* 送信途中のビットでSDAをLowに保持したままになる */
+		bls_IicStuckArm = false;
+		u8s_IicStuckClocks = SIM_IIC_FAULT_CLOCKS;
+	}
+	u8s_IicSlave = SIM_IIC_NO_SLAVE;
+}
+
+/**
+  * @brief  IIC1の次のイベント時刻
+  * @param  None
+  * @retval 時刻[ns](0:無し)
+  */
+static uint64_t sim_iic_next_event(void)
+{
+	uint64_t u64_Next = 0;
+
+	if (u64s_IicNext != 0) {
+		u64_Next = u64s_IicNext;
+	}
+	if ((u64s_IicTmoTime != 0) && ((u64_Next == 0) || (u64s_IicTmoTime < u64_Next))) {
+		u64_Next = u64s_IicTmoTime;
+	}
+	if ((u64s_IicCloEnd != 0) && ((u64_Next == 0) || (u64s_IicCloEnd < u64_Next))) {
+		u64_Next = u64s_IicCloEnd;
+	}
+	return u64_Next;
+}
+
+/**
+  * @brief  IIC1のレジスタ初期値を設定する
+  * @param  None
+  * @retval None
+  * @note   EEPROMは消去状態(0xFF)で開始する
+  */
+void sim_iic_init(void)
+{
+	g_sim_hw->iic[1].ICBRH = 0xFF;
+	g_sim_hw->iic[1].ICBRL = 0xFF;
+	memset(u8s_IicEepromMem, 0xFF, sizeof(u8s_IicEepromMem));
+	sim_iic_sync(0);
+}
+
+/**
+  * @brief  IIC1の次のイベント時刻を反映する
+  * @param  pu64_Next: 次のイベント時刻[ns](より早ければ更新する)
+  * @retval None
+  */
+void sim_iic_schedule(uint64_t *pu64_Next)
+{
+	uint64_t u64_Event = sim_iic_next_event();
+
+	if ((u64_Event != 0) && (u64_Event < *pu64_Next)) {
+		*pu64_Next = u64_Event;
+	}
+}
+
+/**
+  * @brief  IIC1の統計を出力する
+  * @param  None
+  * @retval None
+  */
+void sim_iic_report(void)
+{
+	if (u64s_IicStarts > 0) {
+		fprintf(stderr, "[sim] IIC1 starts %llu, bytes %llu, nack %llu, stretch %llu, timeout %llu, arbitration lost %llu, extra clocks %llu\n",
+			(unsigned long long)u64s_IicStarts, (unsigned long long)u64s_IicBytes, (unsigned long long)u64s_IicNacks,
+			(unsigned long long)u64s_IicStretches, (unsigned long long)u64s_IicTimeouts,
+			(unsigned long long)u64s_IicArbLost, (unsigned long long)u64s_IicCloCount);
+	}
+}
@@ -0,0 +1,161 @@
+/**
+  ******************************************************************************
+  * @file           : sim_local.h
+  * @brief          : RA4M1レジスタモデル シミュレーター内部の共有定義
+  ******************************************************************************
+  * @note   sim_ra4m1.cと周辺機能のモデル(sim_<周辺機能>.c)の間で共有する定義。
+  *         各モデルのファイルは最初にこのヘッダーをインクルードする(_GNU_SOURCE)。
+  *         ファームウェアはsim_ra4m1.hを使い、このヘッダーはインクルードしない。
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SIM_LOCAL_H
+#define __SIM_LOCAL_H
+
+/* Includes ------------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+#include <poll.h>
+#include <termios.h>
+#include "sim_ra4m1.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/* Exported constants --------------------------------------------------------*/
+#define SIM_NS_PER_SEC		(1000000000ULL)
+#define SIM_TIMER_MAX		(1000000)			/* HWタイマーの最大周期(実時間)[ns]	*/
+#define SIM_ELC_ELCON		(0x80)				/* ELCR.ELCON						*/
+#define SIM_ADCSR_TRGE		(0x0200)			/* ADCSR.TRGE						*/
+
+/* SCIレジスタのビット */
+#define SCI_SCR_TEIE		(0x04)
+#define SCI_SCR_RE			(0x10)
+#define SCI_SCR_TE			(0x20)
+#define SCI_SCR_RIE			(0x40)
+#define SCI_SCR_TIE			(0x80)
+#define SCI_SSR_TEND		(0x04)
+#define SCI_SSR_RDRF		(0x40)
+#define SCI_SSR_TDRE		(0x80)
+
+/* データフラッシュ */
+#define SIM_DFLASH_SIZE		(8192)				/* 容量[byte]						*/
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variables --------------------------------------------------------*/
+extern SimTrapRegs *g_sim_hw;
+extern bool g_sim_verbose;
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+/* sim_ra4m1.c */
+extern void sim_lock(void);													/* HWモデルの排他開始					*/
+extern void sim_unlock(void);												/* HWモデルの排他終了					*/
+extern void sim_lock_fw(sigset_t *pst_Saved);								/* ファームウェアからのHWモデルの排他開始	*/
+extern void sim_unlock_fw(const sigset_t *pst_Saved);						/* ファームウェアからのHWモデルの排他終了	*/
+extern void sim_raise_irq(uint32_t u32_Irq, uint64_t u64_Now);				/* 割り込みを保留にしてCPUスレッドへ通知する	*/
+extern void sim_pre_access(size_t u32_Offset, bool bl_Write, uint64_t u64_Now);	/* アクセス前のモデル更新(読み出し値の準備)	*/
+extern void sim_post_access(size_t u32_Offset, bool bl_Write, uint64_t u64_Now);	/* アクセス後のモデル更新(書き込み/読み出しの副作用)	*/
+extern void sim_log(const char *pc_Format, ...) __attribute__((format(printf, 1, 2)));	/* ログ出力(標準エラー出力)	*/
+extern void sim_fw_timer_request(void);										/* lib_timerのシステムタイマーの先送りを要求する	*/
+
+/* sim_clock.c */
+extern void sim_systick_update(uint64_t u64_Now);							/* SysTickの時間経過処理				*/
+extern void sim_clock_init(void);											/* SysTick/SYSTEMのレジスタ初期値を設定する	*/
+extern void sim_clock_read(size_t u32_Offset, uint64_t u64_Now);			/* SysTick/DWT/SYSTEMの読み出し前のモデル更新	*/
+extern void sim_clock_access(size_t u32_Offset, bool bl_Write, uint64_t u64_Now);	/* SysTick/DWT/SYSTEMのアクセス後のモデル更新	*/
+extern void sim_systick_schedule(uint64_t *pu64_Next);						/* SysTickの次のイベント時刻を反映する	*/
+extern void sim_clock_report(void);											/* クロック変更の統計を出力する			*/
+
+/* sim_sci.c */
+extern uint64_t sim_sci_byte_time(const R_SCI0_Type *pst_Sci);				/* SCIの1バイトの時間を求める			*/
+extern void sim_sci_config(void);											/* SCI1の通信速度を求める				*/
+extern void sim_sci_update(uint64_t u64_Now);								/* SCI1の時間経過処理					*/
+extern void sim_sci_init(void);												/* SCIのレジスタ初期値を設定する		*/
+extern void sim_sci_access(size_t u32_Offset, bool bl_Write, uint64_t u64_Now);	/* SCIのアクセス後のモデル更新		*/
+extern void sim_sci_schedule(uint64_t u64_Now, uint64_t *pu64_Next);		/* SCI1の次のイベント時刻を反映する		*/
+extern bool sim_sci_open_input(const char *pc_Path);						/* SCI1の受信データのファイルを開く		*/
+extern bool sim_sci_open_output(const char *pc_Path);						/* SCI1の送信データのファイルを開く		*/
+extern void sim_sci_start(void);											/* SCI1の入力を開始する					*/
+extern uint64_t sim_sci_input_end(uint64_t u64_Now);						/* SCI1の入力の終端の時刻を求める		*/
+extern bool sim_txlog_open(const char *pc_Path);							/* 送信ログのファイルを開く				*/
+extern void sim_sci_report(void);											/* SCI1の統計を出力する					*/
+extern void sim_script_load(const char *pc_Path);							/* 入力スクリプトを読み込む				*/
+extern void sim_script_update(uint64_t u64_Now);							/* 入力スクリプトの時間経過処理(受信キューに積む)	*/
+
+/* sim_esp.c */
+extern void sim_esp_config(void);											/* SCI9の通信速度を求める				*/
+extern void sim_esp_update(uint64_t u64_Now);								/* SCI9の時間経過処理					*/
+extern void sim_esp_access(size_t u32_Member, bool bl_Write, uint64_t u64_Now);	/* SCI9のアクセス後のモデル更新		*/
+extern void sim_esp_schedule(uint64_t *pu64_Next);							/* SCI9の次のイベント時刻を反映する		*/
+extern void sim_esp_report(void);											/* SCI9の統計を出力する					*/
+
+/* sim_dtc.c */
+extern bool sim_dtc_transfer(uint32_t u32_Irq, uint64_t u64_Now);			/* DTC転送								*/
+
+/* sim_gpt.c */
+extern void sim_gpt_access(size_t u32_Member, bool bl_Write, uint64_t u64_Now);	/* GPTレジスタアクセス				*/
+extern void sim_gpt_elc(elc_event_t en_Event, uint64_t u64_Now);			/* ELCイベントによるGPTの開始/クリア	*/
+extern void sim_gpt_update(uint64_t u64_Now);								/* GPTのオーバーフローを発生させる		*/
+extern void sim_gpt_schedule(uint64_t *pu64_Next);							/* GPTの次のイベント時刻を反映する		*/
+
+/* sim_adc.c */
+extern void sim_adc_elc(elc_event_t en_Event, uint64_t u64_Now);			/* ELCイベントによるADC0のスキャン		*/
+
+/* sim_port.c */
+extern void sim_port_init(void);											/* PORTのレジスタ初期値を設定する		*/
+extern void sim_port_write(uint32_t u32_Port, uint64_t u64_Now);			/* PORT書き込み(POSR/PORRの反映と出力変化のログ)	*/
+extern void sim_matrix_print(void);											/* LEDマトリクスの表示内容の出力		*/
+
+/* sim_flash.c */
+extern void sim_flash_load(void);											/* データフラッシュの内容をファイルから読み込む	*/
+extern void sim_flash_save(void);											/* データフラッシュの内容をファイルに保存する	*/
+extern void sim_flash_update(uint64_t u64_Now);								/* 書き込み/消去の時間経過処理			*/
+extern void sim_flash_set_file(const char *pc_Path);						/* データフラッシュの保存先を設定する	*/
+extern void sim_flash_set_cut(uint64_t u64_Count);							/* 電源断させる書き込み/消去の回数を設定する	*/
+extern void sim_flash_write(size_t u32_Offset, uint64_t u64_Now);			/* FACI/FCACHE書き込み					*/
+extern void sim_flash_report(void);											/* データフラッシュの統計を出力する		*/
+
+/* sim_usb.c */
+extern void sim_usb_open_pty(void);											/* USB仮想COMポート(疑似端末)を作成する	*/
+extern void sim_usb_read(size_t u32_Member);								/* USBFSレジスタの読み出し値を準備する	*/
+extern void sim_usb_write(size_t u32_Member, uint64_t u64_Now);				/* USBFSレジスタ書き込み				*/
+extern void sim_usb_update(uint64_t u64_Now);								/* USBFSの時間経過処理					*/
+extern void sim_usb_schedule(uint64_t *pu64_Next);							/* USBFSの次のイベント時刻を反映する	*/
+extern void sim_usb_report(void);											/* USBFSの統計を出力する				*/
+
+/* sim_iic.c */
+extern void sim_iic_access(size_t u32_Member, bool bl_Write, uint64_t u64_Now);	/* IIC1レジスタのアクセス			*/
+extern void sim_iic_update(uint64_t u64_Now);								/* IIC1の時間経過処理					*/
+extern void sim_iic_init(void);												/* IIC1のレジスタ初期値を設定する		*/
+extern void sim_iic_schedule(uint64_t *pu64_Next);							/* IIC1の次のイベント時刻を反映する		*/
+extern void sim_iic_report(void);											/* IIC1の統計を出力する					*/
+
+/* sim_spi.c */
+extern void sim_spi_access(size_t u32_Member, bool bl_Write, uint64_t u64_Now);	/* RSPI0レジスタのアクセス			*/
+extern void sim_spi_update(uint64_t u64_Now);								/* RSPI0の時間経過処理					*/
+extern void sim_spi_init(void);												/* SPI0のレジスタ初期値を設定する		*/
+extern void sim_spi_schedule(uint64_t *pu64_Next);							/* SPI0の次のイベント時刻を反映する		*/
+extern void sim_spi_report(void);											/* SPI0の統計を出力する					*/
+
+/* sim_can.c */
+extern void sim_can_access(size_t u32_Member, bool bl_Write, uint64_t u64_Now);	/* CAN0レジスタのアクセス			*/
+extern void sim_can_update(uint64_t u64_Now);								/* CAN0の時間経過処理					*/
+extern void sim_can_init(void);												/* CAN0のレジスタ初期値を設定する		*/
+extern bool sim_can_set_peer(const char *pc_Name);							/* CANバスの相手ノードを設定する		*/
+extern void sim_can_schedule(uint64_t *pu64_Next);							/* CAN0の次のイベント時刻を反映する		*/
+extern void sim_can_report(void);											/* CAN0の統計を出力する					*/
+
+#endif /* __SIM_LOCAL_H */
@@ -0,0 +1,130 @@
+/**
+  ******************************************************************************
+  * @file           : sim_mem.c
+  * @brief          : メモリ操作ライブラリー(ホスト実行用 lib_mem.s 代替)
+  ******************************************************************************
+  * @note   lib_mem.s と同じ処理をCで記述する(差分の計算方法も合わせる)
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "bsp_api.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+void mem_cpy32(uint32_t *dst, const uint32_t *src, size_t n);
+void mem_cpy16(uint16_t *dst, const uint16_t *src, size_t n);
+void mem_cpy08(uint8_t *dst, const uint8_t *src, size_t n);
+void mem_set32(uint32_t *s, uint32_t c, size_t n);
+void mem_set16(uint16_t *s, uint16_t c, size_t n);
+void mem_set08(uint8_t *s, uint8_t c, size_t n);
+int mem_cmp32(const uint32_t *s1, const uint32_t *s2, size_t n);
+int mem_cmp16(const uint16_t *s1, const uint16_t *s2, size_t n);
+int mem_cmp08(const uint8_t *s1, const uint8_t *s2, size_t n);
+
+/* Exported functions --------------------------------------------------------*/
+
+void mem_cpy32(uint32_t *dst, const uint32_t *src, size_t n)
+{
+	uint32_t *dst_end = dst + n;
+
+	while (dst < dst_end) {
+		*(dst++) = *(src++);
+	}
+}
+
+void mem_cpy16(uint16_t *dst, const uint16_t *src, size_t n)
+{
+	uint16_t *dst_end = dst + n;
+
+	while (dst < dst_end) {
+		*(dst++) = *(src++);
+	}
+}
+
+void mem_cpy08(uint8_t *dst, const uint8_t *src, size_t n)
+{
+	uint8_t *dst_end = dst + n;
+
+	while (dst < dst_end) {
+		*(dst++) = *(src++);
+	}
+}
+
+void mem_set32(uint32_t *s, uint32_t c, size_t n)
+{
+	uint32_t *s_end = s + n;
+
+	while (s < s_end) {
+		*(s++) = c;
+	}
+}
+
+void mem_set16(uint16_t *s, uint16_t c, size_t n)
+{
+	uint16_t *s_end = s + n;
+
+	while (s < s_end) {
+		*(s++) = c;
+	}
+}
+
+void mem_set08(uint8_t *s, uint8_t c, size_t n)
+{
+	uint8_t *s_end = s + n;
+
+	while (s < s_end) {
+		*(s++) = c;
+	}
+}
+
+int mem_cmp32(const uint32_t *s1, const uint32_t *s2, size_t n)
+{
+	const uint32_t *s1_end = s1 + n;
+	int diff;
+
+	while (s1 < s1_end) {
+		diff = (int)(*(s1++) - *(s2++));
+		if (diff != 0) {
+			return diff;
+		}
+	}
+	return 0;
+}
+
+int mem_cmp16(const uint16_t *s1, const uint16_t *s2, size_t n)
+{
+	const uint16_t *s1_end = s1 + n;
+	int diff;
+
+	while (s1 < s1_end) {
+		diff = (int)*(s1++) - (int)*(s2++);
+		if (diff != 0) {
+			return diff;
+		}
+	}
+	return 0;
+}
+
+int mem_cmp08(const uint8_t *s1, const uint8_t *s2, size_t n)
+{
+	const uint8_t *s1_end = s1 + n;
+	int diff;
+
+	while (s1 < s1_end) {
+		diff = (int)*(s1++) - (int)*(s2++);
+		if (diff != 0) {
+			return diff;
+		}
+	}
+	return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
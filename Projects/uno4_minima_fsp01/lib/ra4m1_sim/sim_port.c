@@ -0,0 +1,266 @@
+/**
+  ******************************************************************************
+  * @file           : sim_port.c
+  * @brief          : RA4M1レジスタモデル PORT/IRQ端子/LEDマトリクス
+  ******************************************************************************
+  * @note   PORTの出力の変化をログ出力し(-v)、入力端子のレベル(simSetPinInput())の
+  *         変化でIRQ端子の割り込みを発生させる。
+  *         PORT0/PORT2の出力からUNO R4 WiFiのLEDマトリクス(11ラインの
+  *         チャーリープレクシング)の各LEDの点灯時間を集計し、マトリクスとして
+  *         駆動された場合は終了時に直前25msの輝度を8行×12列で出力する。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim_local.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define SIM_PORT_NUM		(10)
+#define SIM_MATRIX_LINES	(11)				/* LEDマトリクスのライン数			*/
+#define SIM_MATRIX_ROWS		(8)
+#define SIM_MATRIX_COLS		(12)
+#define SIM_MATRIX_LEDS		(SIM_MATRIX_ROWS * SIM_MATRIX_COLS)
+#define SIM_MATRIX_WINDOW	(25000000)			/* 点灯時間の集計区間[ns]			*/
+#define SIM_MATRIX_DUTY		(11)				/* 1ラインの点灯率の逆数(最大輝度)	*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* PORT/LEDマトリクス(sim_lock()で排他) */
+static uint16_t u16s_PortInput[SIM_PORT_NUM];
+static uint16_t u16s_PortOutput[SIM_PORT_NUM];
+static bool bls_MatrixLit[SIM_MATRIX_LEDS];			/* 点灯中のLED						*/
+static uint64_t u64s_MatrixOn[2][SIM_MATRIX_LEDS];	/* 点灯時間[ns](集計中/直前の区間)	*/
+static uint64_t u64s_MatrixWindow;					/* 集計中の区間の開始時刻[ns]		*/
+static uint64_t u64s_MatrixLast;					/* 前回の点灯状態の変化時刻[ns]		*/
+static bool bls_MatrixSeen;							/* 3本以上のラインを出力した		*/
+static bool bls_MatrixDone;							/* 直前の区間が有効					*/
+
+/* IRQ端子の割り当て(ポート,端子,IRQ番号) */
+static const uint8_t u8s_IrqPinTable[][3] = {
+	{1, 5, 0}, {2, 6, 0},
+	{1, 4, 1}, {1, 1, 1}, {2, 5, 1},
+	{1, 0, 2}, {2, 13, 2},
+	{1, 10, 3}, {1, 11, 3},
+};
+
+/* LEDマトリクスのライン端子(ポート,端子) */
+static const uint8_t u8s_MatrixLinePin[SIM_MATRIX_LINES][2] = {
+	{2, 5}, {0, 12}, {0, 13}, {0, 3}, {0, 4}, {0, 11}, {0, 15}, {2, 4}, {2, 6}, {2, 12}, {2, 13},
+};
+
+/* LEDマトリクスのLED毎のライン(アノード,カソード)。行0の左端から行毎 */
+static const uint8_t u8s_MatrixLed[SIM_MATRIX_LEDS][2] = {
+	{ 7, 3}, { 3, 7}, { 7, 4}, { 4, 7}, { 3, 4}, { 4, 3}, { 7, 8}, { 8, 7}, { 3, 8}, { 8, 3}, { 4, 8}, { 8, 4},
+	{ 7, 0}, { 0, 7}, { 3, 0}, { 0, 3}, { 4, 0}, { 0, 4}, { 8, 0}, { 0, 8}, { 7, 6}, { 6, 7}, { 3, 6}, { 6, 3},
+	{ 4, 6}, { 6, 4}, { 8, 6}, { 6, 8}, { 0, 6}, { 6, 0}, { 7, 5}, { 5, 7}, { 3, 5}, { 5, 3}, { 4, 5}, { 5, 4},
+	{ 8, 5}, { 5, 8}, { 0, 5}, { 5, 0}, { 6, 5}, { 5, 6}, { 7, 1}, { 1, 7}, { 3, 1}, { 1, 3}, { 4, 1}, { 1, 4},
+	{ 8, 1}, { 1, 8}, { 0, 1}, { 1, 0}, { 6, 1}, { 1, 6}, { 5, 1}, { 1, 5}, { 7, 2}, { 2, 7}, { 3, 2}, { 2, 3},
+	{ 4, 2}, { 2, 4}, { 8, 2}, { 2, 8}, { 0, 2}, { 2, 0}, { 6, 2}, { 2, 6}, { 5, 2}, { 2, 5}, { 1, 2}, { 2, 1},
+	{ 7,10}, {10, 7}, { 3,10}, {10, 3}, { 4,10}, {10, 4}, { 8,10}, {10, 8}, { 0,10}, {10, 0}, { 6,10}, {10, 6},
+	{ 5,10}, {10, 5}, { 1,10}, {10, 1}, { 2,10}, {10, 2}, { 7, 9}, { 9, 7}, { 3, 9}, { 9, 3}, { 4, 9}, { 9, 4},
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static void sim_matrix_update(uint64_t u64_Now);
+static void sim_port_input(uint32_t u32_Port, uint16_t u16_Level, uint64_t u64_Now);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  入力端子レベルを設定する
+  * @param  u8_Port: ポート番号
+  * @param  u8_Pin: 端子番号
+  * @param  u8_Level: LOW/HIGH
+  * @retval None
+  */
+void simSetPinInput(uint8_t u8_Port, uint8_t u8_Pin, uint8_t u8_Level)
+{
+	sigset_t st_Saved;
+	uint16_t u16_Level;
+
+	if (u8_Port >= SIM_PORT_NUM) {
+		return;
+	}
+	sim_lock_fw(&st_Saved);
+	u16_Level = u16s_PortInput[u8_Port] & (uint16_t)~(1U << u8_Pin);
+	if (u8_Level) {
+		u16_Level |= (uint16_t)(1U << u8_Pin);
+	}
+	sim_port_input(u8_Port, u16_Level, simGetTime());
+	sim_unlock_fw(&st_Saved);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  PORTのレジスタ初期値を設定する
+  * @param  None
+  * @retval None
+  */
+void sim_port_init(void)
+{
+	uint32_t _i;
+
+	for (_i=0; _i<SIM_PORT_NUM; _i++) {
+		u16s_PortInput[_i] = 0xFFFF;					// 未接続端子はプルアップ相当
+		g_sim_hw->port[_i].PIDR = 0xFFFF;
+	}
+}
+
+/**
+  * @brief  PORT書き込み(POSR/PORRの反映と出力変化のログ)
+  * @param  u32_Port: ポート番号
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+void sim_port_write(uint32_t u32_Port, uint64_t u64_Now)
+{
+	R_PORT0_Type *pst_Port = &g_sim_hw->port[u32_Port];
+	uint16_t u16_Changed;
+	uint32_t _i;
+
+	if (u32_Port >= SIM_PORT_NUM) {
+		return;
+	}
+	/* 出力セット/リセットはPODRに反映し、読み出し値は0とする */
+	pst_Port->PODR = (uint16_t)((pst_Port->PODR | pst_Port->POSR) & ~pst_Port->PORR);
+	pst_Port->PCNTR3 = 0;
+	pst_Port->PIDR = (uint16_t)((pst_Port->PODR & pst_Port->PDR) | (u16s_PortInput[u32_Port] & ~pst_Port->PDR));
+
+	u16_Changed = (uint16_t)((pst_Port->PODR & pst_Port->PDR) ^ u16s_PortOutput[u32_Port]);
+	u16s_PortOutput[u32_Port] = (uint16_t)(pst_Port->PODR & pst_Port->PDR);
+	if (g_sim_verbose && u16_Changed) {
+		for (_i=0; _i<16; _i++) {
+			if (u16_Changed & (1U << _i)) {
+				sim_log("%10.3f ms P%u%02u=%u", (double)u64_Now / 1000000.0,
+					u32_Port, _i, (u16s_PortOutput[u32_Port] >> _i) & 1U);
+			}
+		}
+	}
+	if ((u32_Port == 0) || (u32_Port == 2)) {
+		sim_matrix_update(u64_Now);
+	}
+}
+
+/**
+  * @brief  LEDマトリクスの点灯状態の更新
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   前回からの点灯時間を集計し、ライン端子の出力からLED毎の点灯を求め直す。
+  *         アノードがHigh出力、カソードがLow出力のLEDを点灯とする
+  */
+static void sim_matrix_update(uint64_t u64_Now)
+{
+	R_PORT0_Type *pst_Port;
+	uint16_t u16_High[SIM_MATRIX_LINES];
+	uint16_t u16_Low[SIM_MATRIX_LINES];
+	uint32_t u32_Driven = 0;
+	uint32_t _i;
+
+	for (_i=0; _i<SIM_MATRIX_LEDS; _i++) {
+		if (bls_MatrixLit[_i]) {
+			u64s_MatrixOn[0][_i] += u64_Now - u64s_MatrixLast;
+		}
+	}
+	u64s_MatrixLast = u64_Now;
+	if ((u64_Now - u64s_MatrixWindow) >= SIM_MATRIX_WINDOW) {
+		memcpy(u64s_MatrixOn[1], u64s_MatrixOn[0], sizeof(u64s_MatrixOn[1]));
+		memset(u64s_MatrixOn[0], 0, sizeof(u64s_MatrixOn[0]));
+		u64s_MatrixWindow = u64_Now;
+		bls_MatrixDone = bls_MatrixSeen;
+	}
+
+	for (_i=0; _i<SIM_MATRIX_LINES; _i++) {
+		pst_Port = &g_sim_hw->port[u8s_MatrixLinePin[_i][0]];
+		u16_High[_i] = (uint16_t)((pst_Port->PDR & pst_Port->PODR) >> u8s_MatrixLinePin[_i][1]) & 1U;
+		u16_Low[_i] = (uint16_t)((pst_Port->PDR & ~pst_Port->PODR) >> u8s_MatrixLinePin[_i][1]) & 1U;
+		u32_Driven += u16_High[_i] | u16_Low[_i];
+	}
+	if (u32_Driven > 2) {
+		bls_MatrixSeen = true;
+	}
+	for (_i=0; _i<SIM_MATRIX_LEDS; _i++) {
+		bls_MatrixLit[_i] = u16_High[u8s_MatrixLed[_i][0]] && u16_Low[u8s_MatrixLed[_i][1]];
+	}
+}
+
+/**
+  * @brief  LEDマトリクスの表示内容の出力
+  * @param  None
+  * @retval None
+  * @note   直前の集計区間の点灯時間を輝度0～F(1ラインの点灯率1/11を最大)で出力する。
+  *         ライン端子をマトリクスとして駆動していない場合は出力しない
+  */
+void sim_matrix_print(void)
+{
+	uint64_t u64_Level;
+	uint32_t _i;
+
+	if (!bls_MatrixDone) {
+		return;
+	}
+	fprintf(stderr, "[sim] LED matrix (last %u ms, 0-F)\n", SIM_MATRIX_WINDOW / 1000000);
+	for (_i=0; _i<SIM_MATRIX_LEDS; _i++) {
+		u64_Level = (u64s_MatrixOn[1][_i] * SIM_MATRIX_DUTY * 15 + (SIM_MATRIX_WINDOW / 2)) / SIM_MATRIX_WINDOW;
+		if ((_i % SIM_MATRIX_COLS) == 0) {
+			fprintf(stderr, "[sim]   ");
+		}
+		fputc("0123456789ABCDEF"[(u64_Level > 15) ? 15 : u64_Level], stderr);
+		if ((_i % SIM_MATRIX_COLS) == (SIM_MATRIX_COLS - 1)) {
+			fputc('\n', stderr);
+		}
+	}
+}
+
+/**
+  * @brief  入力端子レベルの変化(IRQ端子のエッジ検出を含む)
+  * @param  u32_Port: ポート番号
+  * @param  u16_Level: 入力レベル
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+static void sim_port_input(uint32_t u32_Port, uint16_t u16_Level, uint64_t u64_Now)
+{
+	R_PORT0_Type *pst_Port = &g_sim_hw->port[u32_Port];
+	uint16_t u16_Changed = u16s_PortInput[u32_Port] ^ u16_Level;
+	uint8_t u8_Pin;
+	uint8_t u8_Irq;
+	uint8_t u8_Level;
+	size_t _i;
+
+	(void)u64_Now;
+	u16s_PortInput[u32_Port] = u16_Level;
+	pst_Port->PIDR = (uint16_t)((pst_Port->PODR & pst_Port->PDR) | (u16_Level & ~pst_Port->PDR));
+
+	for (_i=0; _i<(sizeof(u8s_IrqPinTable) / sizeof(u8s_IrqPinTable[0])); _i++) {
+		u8_Pin = u8s_IrqPinTable[_i][1];
+		if ((u8s_IrqPinTable[_i][0] != u32_Port) || !(u16_Changed & (1U << u8_Pin))) {
+			continue;
+		}
+		if (g_sim_pfs.PORT[u32_Port].PIN[u8_Pin].PmnPFS_b.ISEL == 0) {
+			continue;
+		}
+		u8_Irq = u8s_IrqPinTable[_i][2];
+		u8_Level = (uint8_t)((u16_Level >> u8_Pin) & 1U);
+		switch (g_sim_icu.IRQCR_b[u8_Irq].IRQMD) {
+		case 0:											// 立ち下がり
+		case 3:											// Lowレベル
+			if (u8_Level == 0) {
+				simRaiseEvent((elc_event_t)(ELC_EVENT_ICU_IRQ0 + u8_Irq));
+			}
+			break;
+		case 1:											// 立ち上がり
+			if (u8_Level != 0) {
+				simRaiseEvent((elc_event_t)(ELC_EVENT_ICU_IRQ0 + u8_Irq));
+			}
+			break;
+		default:										// 両エッジ
+			simRaiseEvent((elc_event_t)(ELC_EVENT_ICU_IRQ0 + u8_Irq));
+			break;
+		}
+	}
+}
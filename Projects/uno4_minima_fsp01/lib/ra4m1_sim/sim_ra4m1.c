@@ -0,0 +1,1464 @@
+/**
+  ******************************************************************************
+  * @file           : sim_ra4m1.c
+  * @brief          : RA4M1レジスタモデル シミュレーター(ホスト実行用)
+  ******************************************************************************
+  * @note   実行スレッドの役割
+  *         - CPUスレッド : hal_entry()を実行する。割り込みはSIGUSR1で
+  *                         このスレッドに割り込ませて実行する。
+  *         - 入力スレッド: 入力(標準入力)を読み出してSCI1受信キューに積む。
+  *         仮想時間はCPUスレッドへのタイマーシグナル(SIGALRM)で進め、
+  *         周辺機能のモデルを動かす。ファームウェアがビジーループで
+  *         CPUを占有していても(1コアの環境でも)周辺機能の時間が遅れない。
+  *
+  *         SCI/PORT/SysTick/DWT/FACI/USBFS/IIC/SPI/CAN/GPTのレジスタは保護したページに配置し、CPUスレッド
+  *         からのアクセスをSIGSEGVで捕捉する。保護を一時解除して1命令だけ
+  *         ステップ実行(SIGTRAP)させた後、アクセス内容に応じてモデルを更新する。
+  *         モデル側は同じメモリの別マッピング(g_sim_hw)から読み書きする。
+  *
+  *         このファイルはアクセスの捕捉,割り込み,仮想時間とCMSIS/FSP互換関数を
+  *         受け持つ。周辺機能のモデルは次のファイルに分け、モデル間で共有する
+  *         宣言はsim_local.hに置く。
+  *           sim_clock.c : SysTick/DWT/クロック発生回路/動作電力モード
+  *           sim_sci.c   : SCI1(入力スレッド,入力スクリプト,送信ログ)
+  *           sim_esp.c   : SCI9(ESP32-S3との接続)
+  *           sim_dtc.c   : DTC
+  *           sim_gpt.c   : GPT
+  *           sim_adc.c   : ADC0
+  *           sim_port.c  : PORT/IRQ端子/LEDマトリクス
+  *           sim_flash.c : FACI/FCACHE(データフラッシュ)
+  *           sim_usb.c   : USBFS(模擬ホスト)
+  *           sim_iic.c   : IIC1(EEPROM,温度センサー)
+  *           sim_spi.c   : RSPI0
+  *           sim_can.c   : CAN0
+  *
+  *         早送り(-x)では仮想時間を実時間から切り離し、CPUスレッドが
+  *         アイドル(前回のHWタイマーから同じ位置で中断,レジスタアクセス無し,
+  *         割り込み許可中,ISR外: 周期待ちのビジーループ/WFE)なら次のイベント
+  *         時刻まで一度に進める。それ以外は実時間の経過分(×速度倍率)だけ進める。
+  *         lib_timerのシステムタイマーはSysTick開始時に指定値まで先送りでき(-w)、
+  *         起動から約49.7日後の32bit周回を数秒で再現できる。ただし先送りされるのは
+  *         lib_timerのシステムタイマーだけで、仮想時間は進まない。lib_timerを経由
+  *         しない時間計測(コルーチンのタイマー,KVSの遅延,UARTのアイドル
+  *         タイムアウト等)は周回を経験しない。
+  *
+  *         セミホスティング(__semihost)はSYS_WRITE0を標準エラー出力に出し、
+  *         SYS_EXITで終了する(デバッガー接続中としてDHCSR.C_DEBUGEN=1)。
+  *
+  *         BASEPRIはスレッド側で設定値以下の優先度の割り込みを保留させる。
+  *
+  *         制約: Linux x86-64専用。ISR同士の多重割り込み(プリエンプション)は
+  *         模擬せず、優先度は保留中割り込みの選択順にのみ反映する。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim_local.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* 割り込み統計 */
+typedef struct {
+	uint64_t u64_count;							/* 実行回数							*/
+	uint64_t u64_lost;							/* 保留中の再発生(取りこぼし)回数	*/
+	uint64_t u64_lat_sum;						/* 発生から実行までの合計[ns]		*/
+	uint64_t u64_lat_max;						/* 発生から実行までの最大[ns]		*/
+} SimIrqStat;
+
+/* ファームウェアのタイマー(lib.hのTimerと同じ配置) */
+typedef struct {
+	uint32_t u32_time;
+	bool bl_state;
+} SimFwTimer;
+
+/* アクセス捕捉中の情報 */
+typedef struct {
+	bool bl_active;								/* ステップ実行中					*/
+	bool bl_write;								/* 書き込みアクセス					*/
+	size_t u32_offset;							/* 捕捉領域内のオフセット			*/
+	sigset_t st_mask;							/* 捕捉前のシグナルマスク			*/
+} SimTrap;
+
+/* Private define ------------------------------------------------------------*/
+#define SIM_PAGE_SIZE		(4096)
+#define SIM_PAGE_SCI		(0)					/* SCIのページ						*/
+#define SIM_PAGE_PORT		(1)					/* PORTのページ						*/
+#define SIM_PAGE_CORE		(2)					/* SysTick/DWT/SYSTEMのページ		*/
+#define SIM_PAGE_FLASH		(3)					/* FACI/FCACHEのページ				*/
+#define SIM_PAGE_USB		(4)					/* USBFSのページ					*/
+#define SIM_PAGE_IIC		(5)					/* IIC0/IIC1のページ				*/
+#define SIM_PAGE_SPI		(6)					/* SPI0/SPI1のページ				*/
+#define SIM_PAGE_CAN		(7)					/* CAN0のページ						*/
+#define SIM_PAGE_GPT		(8)					/* GPT0～GPT7のページ				*/
+#define SIM_PAGE_NUM		(sizeof(SimTrapRegs) / SIM_PAGE_SIZE)
+#define SIM_TIMER_MIN		(10000)				/* HWタイマーの最小周期(実時間)[ns]	*/
+#define SIM_WFE_POLL		(20000)				/* WFE中の確認周期[ns]				*/
+#define SIM_ACCEL_PERIOD	(10000)				/* 早送り時のHWタイマーの間隔(実時間)[ns]	*/
+#define SIM_ACCEL_PC_RANGE	(64)				/* 早送り時に同じ位置とみなす範囲[byte]	*/
+#define SIM_TRAP_TF			(0x100)				/* EFLAGS トラップフラグ			*/
+#define SIM_SEMIHOST_WRITE0	(0x04)				/* セミホスティング SYS_WRITE0		*/
+#define SIM_SEMIHOST_EXIT	(0x18)				/* セミホスティング SYS_EXIT		*/
+#define SIM_SEMIHOST_EXIT_OK	(0x20026)		/* ADP_Stopped_ApplicationExit		*/
+#define SIM_STACK_SIZE		(0x800)				/* メインスタック(MSP)のサイズ		*/
+
+/* Private macro -------------------------------------------------------------*/
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id	_sigev_un._tid		/* 古いglibc向け					*/
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+
+/* ペリフェラル(CPUから見たレジスタ) */
+SimTrapRegs *g_sim_trap;
+R_PFS_Type g_sim_pfs;
+R_MSTP_Type g_sim_mstp;
+R_ICU_Type g_sim_icu;
+R_DTC_Type g_sim_dtc;
+R_ELC_Type g_sim_elc;
+R_ADC0_Type g_sim_adc0;
+R_MPU_SPMON_Type g_sim_spmon;
+R_WDT_Type g_sim_wdt;
+CoreDebug_Type g_sim_coredebug;
+SCB_Type g_sim_scb;
+FPU_Type g_sim_fpu;
+uint32_t SystemCoreClock = SIM_CPU_CLOCK;
+uint8_t g_sim_dflash[SIM_DFLASH_SIZE];
+
+/* ベクターテーブル(FSPスタートアップ/リンカースクリプトの代替) */
+extern void SysTick_Handler(void) __attribute__((weak));
+const fsp_vector_t __VECTOR_TABLE[BSP_CORTEX_VECTOR_TABLE_ENTRIES] = {
+	[15] = SysTick_Handler,
+};
+/* メインスタック(__StackLimit～__StackTop)とRAMベクターテーブル(__StackTop～)を連続して配置する。
+   ホストの割り込み処理はこのスタックを使用しないため、使用量は常に0となる */
+struct {
+	uint32_t u32_stack[SIM_STACK_SIZE / 4];
+	uint32_t u32_vector[BSP_CORTEX_VECTOR_TABLE_ENTRIES + BSP_ICU_VECTOR_MAX_ENTRIES];
+} g_sim_ram __attribute__((aligned(512)));
+__asm__(".globl __StackLimit\n.set __StackLimit, g_sim_ram\n"
+		".globl __StackTop\n.set __StackTop, g_sim_ram + 0x800\n");
+_Static_assert(SIM_STACK_SIZE == 0x800, "__StackTop offset");
+
+/* モデルから見たレジスタ(同じメモリの別マッピング) */
+SimTrapRegs *g_sim_hw;
+
+/* CPU状態 */
+static pthread_t sts_CpuThread;
+static volatile uint32_t u32s_Primask;				/* 割り込み禁止						*/
+static volatile uint32_t u32s_Active;				/* 割り込み処理中					*/
+static volatile uint32_t u32s_Basepri;				/* 割り込み優先度マスク(0:無効)		*/
+static uint64_t u64s_Pending;						/* 保留中割り込み(bit32:SysTick)	*/
+static uint64_t u64s_Enable = (1ULL << SIM_IRQ_SYSTICK);	/* 許可中割り込み			*/
+static uint8_t u8s_Priority[SIM_IRQ_NUM + 1];
+static uint64_t u64s_RaiseTime[SIM_IRQ_NUM + 1];
+static SimIrqStat sts_IrqStat[SIM_IRQ_NUM + 1];
+static volatile uint64_t u64s_WakeCount;			/* 割り込み実行数(WFE解除用)		*/
+static SimTrap sts_Trap;
+static uint32_t u32s_Psp;							/* PSP(値の保持のみ)				*/
+static uint32_t u32s_Control;						/* CONTROL(値の保持のみ)			*/
+static timer_t sts_Timer;
+
+/* 仮想時間 */
+static double dbs_Speedup = 1.0;					/* 実時間に対する速度倍率			*/
+static uint64_t u64s_StartReal;						/* 開始時の実時間[ns]				*/
+static uint64_t u64s_TimeLimit;						/* 実行時間の上限[ns](0:無制限)		*/
+static uint64_t u64s_ExitAfterInput;				/* 入力終了後に終了するまで[ns]		*/
+
+/* 早送り(CPUスレッドのみで更新) */
+static bool bls_Accel;								/* 早送りする						*/
+static volatile uint64_t u64s_AccelNow;				/* 仮想時間[ns]						*/
+static uint64_t u64s_AccelReal;						/* 前回のHWタイマーの実時間[ns]		*/
+static uint64_t u64s_AccelNext;						/* 次のイベントの仮想時刻[ns]		*/
+static uint64_t u64s_AccelTraps;					/* 前回のHWタイマーでの捕捉回数		*/
+static uintptr_t us_AccelPc;						/* 前回のHWタイマーで中断した位置	*/
+static uint64_t u64s_AccelSkips;					/* 次のイベントまで進めた回数		*/
+static uint64_t u64s_TrapCount;						/* レジスタアクセスの捕捉回数		*/
+
+/* ファームウェアのタイマー先送り(lib_timer.cが無ければ行わない) */
+extern void taskTimerUpdate(void) __attribute__((weak));
+extern void startTimer(SimFwTimer *pst_Timer) __attribute__((weak));
+static bool bls_FwTimerPreset;						/* 先送りする						*/
+static bool bls_FwTimerRequest;						/* SysTick開始で先送りを要求		*/
+static uint32_t u32s_FwTimerPreset;					/* 先送り後のタイマー値[ms]			*/
+
+/* HWモデルの排他(sim_lock()/sim_unlock()) */
+static volatile uint8_t u8s_Lock;
+
+/* 詳細ログ(-v) */
+bool g_sim_verbose;
+
+/* Private function prototypes -----------------------------------------------*/
+extern void hal_entry(void);
+static uint64_t sim_real_time(void);
+static void sim_dispatch(void);
+static int32_t sim_next_irq(void);
+static bool sim_irq_masked(uint32_t u32_Irq);
+static fsp_vector_t sim_get_handler(uint32_t u32_Irq);
+static void sim_usr1_handler(int i32_Sig);
+static void sim_segv_handler(int i32_Sig, siginfo_t *pst_Info, void *pv_Context);
+static void sim_trap_handler(int i32_Sig, siginfo_t *pst_Info, void *pv_Context);
+static void sim_page_protect(size_t u32_Page);
+static uint64_t sim_accel_advance(uintptr_t u_Pc);
+static void sim_accel_arm(void);
+static void sim_fw_timer_preset(void);
+static void sim_timer_handler(int i32_Sig, siginfo_t *pst_Info, void *pv_Context);
+static void sim_schedule(uint64_t u64_Now);
+static void sim_usage(const char *pc_Name);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  シミュレーターのエントリー
+  * @param  argc: 引数の数
+  * @param  argv: 引数
+  * @retval 終了コード
+  * @note   -s 倍率   : 実時間に対する仮想時間の速度倍率(既定1.0)
+  *         -t ms     : 仮想時間でこの時間を実行したら終了
+  *         -e ms     : 入力の終端に達してからこの時間で終了
+  *         -i ファイル: SCI1受信データ(既定:標準入力)
+  *         -o ファイル: SCI1送信データ(既定:標準出力)
+  *         -v        : 端子出力の変化をログ出力
+  *         -f ファイル: データフラッシュの内容(起動時に読み込み,終了時に保存)
+  *         -c 回数   : データフラッシュの書き込み/消去のこの回数目で電源断
+  *         -b 相手   : CANバスの相手ノード(none:無し(既定), echo:応答ノード)
+  *         -x        : 早送り(アイドル区間は次のイベント時刻まで進める)
+  *         -I ファイル: SCI1受信データの入力スクリプト(-iの代わり)
+  *         -O ファイル: SCI1送信データを仮想時刻付きで記録する
+  *         -w ms     : SysTick開始時にlib_timerのシステムタイマーをこの値まで進める
+  *                     (lib_timer以外の時間計測は先送りされない)
+  */
+int main(int argc, char *argv[])
+{
+	int i32_Opt;
+	int i32_Fd;
+	sigset_t st_Mask;
+	struct sigaction st_Action;
+	struct sigevent st_Event;
+	size_t _i;
+
+	while ((i32_Opt = getopt(argc, argv, "s:t:e:i:o:f:c:b:xI:O:w:vh")) != -1) {
+		switch (i32_Opt) {
+		case 's':
+			dbs_Speedup = atof(optarg);
+			if (dbs_Speedup <= 0.0) {
+				sim_usage(argv[0]);
+			}
+			break;
+		case 't':
+			u64s_TimeLimit = strtoull(optarg, NULL, 0) * 1000000ULL;
+			break;
+		case 'e':
+			u64s_ExitAfterInput = strtoull(optarg, NULL, 0) * 1000000ULL;
+			break;
+		case 'i':
+			if (!sim_sci_open_input(optarg)) {
+				return 1;
+			}
+			break;
+		case 'o':
+			if (!sim_sci_open_output(optarg)) {
+				return 1;
+			}
+			break;
+		case 'v':
+			g_sim_verbose = true;
+			break;
+		case 'f':
+			sim_flash_set_file(optarg);
+			break;
+		case 'c':
+			sim_flash_set_cut(strtoull(optarg, NULL, 0));
+			break;
+		case 'b':
+			if (!sim_can_set_peer(optarg)) {
+				sim_usage(argv[0]);
+			}
+			break;
+		case 'x':
+			bls_Accel = true;
+			break;
+		case 'I':
+			sim_script_load(optarg);
+			break;
+		case 'O':
+			if (!sim_txlog_open(optarg)) {
+				return 1;
+			}
+			break;
+		case 'w':
+			u32s_FwTimerPreset = (uint32_t)strtoul(optarg, NULL, 0);
+			bls_FwTimerPreset = true;
+			break;
+		default:
+			sim_usage(argv[0]);
+			break;
+		}
+	}
+
+	/* ---- 捕捉対象レジスタの領域確保(同じメモリを2か所にマッピング) ---- */
+	i32_Fd = memfd_create("ra4m1_sim", 0);
+	if ((i32_Fd < 0) || (ftruncate(i32_Fd, sizeof(SimTrapRegs)) != 0)) {
+		perror("memfd_create");
+		return 1;
+	}
+	g_sim_hw = mmap(NULL, sizeof(SimTrapRegs), PROT_READ | PROT_WRITE, MAP_SHARED, i32_Fd, 0);
+	g_sim_trap = mmap(NULL, sizeof(SimTrapRegs), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_32BIT, i32_Fd, 0);
+	if ((g_sim_hw == MAP_FAILED) || (g_sim_trap == MAP_FAILED)) {
+		perror("mmap");
+		return 1;
+	}
+
+	/* ---- レジスタ初期値 ---- */
+	g_sim_mstp.MSTPCRA = 0xFFBFFFFF;
+	g_sim_mstp.MSTPCRB = 0xFFFFFFFF;
+	g_sim_mstp.MSTPCRC = 0xFFFFFFFF;
+	g_sim_mstp.MSTPCRD = 0xFFFFFFFF;
+	g_sim_spmon.SP[0].CTL = 0x0001;
+	g_sim_coredebug.DHCSR = CoreDebug_DHCSR_C_DEBUGEN_Msk;	// セミホスティングはシミュレーターが受ける
+	g_sim_wdt.WDTCR = 0x33F3;
+	sim_clock_init();
+	sim_sci_init();
+	sim_port_init();
+	sim_flash_load();
+	sim_iic_init();
+	sim_spi_init();
+	sim_can_init();
+
+	/* ---- シグナル設定 ---- */
+	sts_CpuThread = pthread_self();
+	memset(&st_Action, 0, sizeof(st_Action));
+	sigemptyset(&st_Action.sa_mask);
+	sigaddset(&st_Action.sa_mask, SIGUSR1);
+	sigaddset(&st_Action.sa_mask, SIGALRM);
+	st_Action.sa_flags = SA_SIGINFO;
+	st_Action.sa_sigaction = sim_segv_handler;
+	sigaction(SIGSEGV, &st_Action, NULL);
+	st_Action.sa_sigaction = sim_trap_handler;
+	sigaction(SIGTRAP, &st_Action, NULL);
+	memset(&st_Action, 0, sizeof(st_Action));
+	sigemptyset(&st_Action.sa_mask);
+	sigaddset(&st_Action.sa_mask, SIGUSR1);
+	st_Action.sa_flags = SA_RESTART | SA_SIGINFO;
+	st_Action.sa_sigaction = sim_timer_handler;
+	sigaction(SIGALRM, &st_Action, NULL);
+	sigemptyset(&st_Action.sa_mask);
+	st_Action.sa_flags = SA_RESTART;
+	st_Action.sa_handler = sim_usr1_handler;
+	sigaction(SIGUSR1, &st_Action, NULL);
+
+	/* ---- USB仮想COMポート(接続時にパスをログ出力する) ---- */
+	sim_usb_open_pty();
+
+	/* ---- 入力スレッド開始(シグナルはCPUスレッドのみで受ける) ---- */
+	sigemptyset(&st_Mask);
+	sigaddset(&st_Mask, SIGUSR1);
+	sigaddset(&st_Mask, SIGALRM);
+	pthread_sigmask(SIG_BLOCK, &st_Mask, NULL);
+	sim_sci_start();
+
+	/* ---- HWタイマー作成(CPUスレッドへ通知) ---- */
+	memset(&st_Event, 0, sizeof(st_Event));
+	st_Event.sigev_notify = SIGEV_THREAD_ID;
+	st_Event.sigev_signo = SIGALRM;
+	st_Event.sigev_notify_thread_id = gettid();
+	if (timer_create(CLOCK_MONOTONIC, &st_Event, &sts_Timer) != 0) {
+		perror("timer_create");
+		return 1;
+	}
+
+	for (_i=0; _i<SIM_PAGE_NUM; _i++) {
+		sim_page_protect(_i);
+	}
+	u64s_StartReal = sim_real_time();
+	u64s_AccelReal = u64s_StartReal;
+	sim_schedule(0);
+	sim_accel_arm();
+	pthread_sigmask(SIG_UNBLOCK, &st_Mask, NULL);
+
+	/* ---- ファームウェア実行 ---- */
+	hal_entry();
+
+	simFinish(0);
+}
+
+/**
+  * @brief  仮想時間[ns]を取得する
+  * @param  None
+  * @retval 仮想時間[ns]
+  */
+uint64_t simGetTime(void)
+{
+	if (bls_Accel) {
+		return u64s_AccelNow;
+	}
+	return (uint64_t)((double)(sim_real_time() - u64s_StartReal) * dbs_Speedup);
+}
+
+/**
+  * @brief  ELCイベントを発生させる
+  * @param  en_Event: ELCイベント番号
+  * @retval None
+  * @note   ELCでリンクしたGPTを開始/クリアし、IELSRで選択している全ての
+  *         割り込みを保留にする。DTC起動(DTCE=1)の要因はDTC転送を行い、
+  *         転送の完了時(またはDISEL=1)だけCPU割り込みにする。
+  */
+void simRaiseEvent(elc_event_t en_Event)
+{
+	uint64_t u64_Now = simGetTime();
+	uint32_t _i;
+
+	sim_gpt_elc(en_Event, u64_Now);
+	sim_adc_elc(en_Event, u64_Now);
+	for (_i=0; _i<SIM_IRQ_NUM; _i++) {
+		if (g_sim_icu.IELSR_b[_i].IELS == (uint32_t)en_Event) {
+			if (g_sim_icu.IELSR_b[_i].DTCE && g_sim_dtc.DTCST) {
+				if (!sim_dtc_transfer(_i, u64_Now)) {
+					continue;
+				}
+			}
+			g_sim_icu.IELSR_b[_i].IR = 1;
+			sim_raise_irq(_i, u64_Now);
+		}
+	}
+}
+
+/**
+  * @brief  統計を出力して終了する
+  * @param  i32_Code: 終了コード
+  * @retval None
+  */
+void simFinish(int i32_Code)
+{
+	uint64_t u64_Now = simGetTime();
+	uint64_t u64_Real = sim_real_time() - u64s_StartReal;
+	uint32_t _i;
+
+	fprintf(stderr, "\n[sim] virtual %.3f s, real %.3f s, x%.1f\n",
+		(double)u64_Now / SIM_NS_PER_SEC, (double)u64_Real / SIM_NS_PER_SEC,
+		(u64_Real > 0) ? ((double)u64_Now / (double)u64_Real) : 0.0);
+	if (bls_Accel) {
+		fprintf(stderr, "[sim] accel: %llu idle skips\n", (unsigned long long)u64s_AccelSkips);
+	}
+	sim_sci_report();
+	sim_esp_report();
+	sim_clock_report();
+	sim_flash_report();
+	sim_iic_report();
+	sim_spi_report();
+	sim_can_report();
+	sim_usb_report();
+	sim_matrix_print();
+	fprintf(stderr, "[sim] %-8s %10s %8s %12s %12s\n", "irq", "count", "lost", "lat_avg[us]", "lat_max[us]");
+	for (_i=0; _i<=SIM_IRQ_NUM; _i++) {
+		SimIrqStat *pst_Stat = &sts_IrqStat[_i];
+		if ((pst_Stat->u64_count == 0) && (pst_Stat->u64_lost == 0)) {
+			continue;
+		}
+		if (_i == SIM_IRQ_SYSTICK) {
+			fprintf(stderr, "[sim] %-8s", "SysTick");
+		}
+		else {
+			fprintf(stderr, "[sim] %-8u", _i);
+		}
+		fprintf(stderr, " %10llu %8llu %12.2f %12.2f\n",
+			(unsigned long long)pst_Stat->u64_count, (unsigned long long)pst_Stat->u64_lost,
+			(pst_Stat->u64_count > 0) ? ((double)pst_Stat->u64_lat_sum / (double)pst_Stat->u64_count / 1000.0) : 0.0,
+			(double)pst_Stat->u64_lat_max / 1000.0);
+	}
+	sim_flash_save();
+	exit(i32_Code);
+}
+
+/* CMSIS互換関数 -------------------------------------------------------------*/
+
+/**
+  * @brief  割り込み禁止(PRIMASK=1)
+  * @param  None
+  * @retval None
+  */
+void __disable_irq(void)
+{
+	u32s_Primask = 1;
+	__atomic_signal_fence(__ATOMIC_SEQ_CST);
+}
+
+/**
+  * @brief  割り込み許可(PRIMASK=0)
+  * @param  None
+  * @retval None
+  * @note   禁止中に保留となった割り込みをここで実行する
+  */
+void __enable_irq(void)
+{
+	__atomic_signal_fence(__ATOMIC_SEQ_CST);
+	u32s_Primask = 0;
+	if (u32s_Active == 0) {
+		sim_dispatch();
+	}
+}
+
+/**
+  * @brief  イベント待ち
+  * @param  None
+  * @retval None
+  * @note   いずれかの割り込みが実行(または保留)されるまで待つ
+  */
+void __WFE(void)
+{
+	uint64_t u64_Wake = u64s_WakeCount;
+	struct timespec st_Wait = {0, SIM_WFE_POLL};
+
+	int32_t i32_Irq;
+
+	while (u64_Wake == u64s_WakeCount) {
+		i32_Irq = sim_next_irq();
+		if (i32_Irq >= 0) {
+			if (u32s_Primask || sim_irq_masked((uint32_t)i32_Irq)) {
+				break;
+			}
+			sim_dispatch();
+		}
+		else {
+			nanosleep(&st_Wait, NULL);
+		}
+	}
+}
+
+/**
+  * @brief  割り込み待ち
+  * @param  None
+  * @retval None
+  */
+void __WFI(void)
+{
+	__WFE();
+}
+
+/**
+  * @brief  BASEPRI取得
+  * @param  None
+  * @retval BASEPRI
+  */
+uint32_t __get_BASEPRI(void)
+{
+	return u32s_Basepri;
+}
+
+/**
+  * @brief  BASEPRI設定
+  * @param  basePri: BASEPRI(0:マスクしない)
+  * @retval None
+  * @note   マスクを下げた時に保留となった割り込みをここで実行する
+  */
+void __set_BASEPRI(uint32_t basePri)
+{
+	__atomic_signal_fence(__ATOMIC_SEQ_CST);
+	u32s_Basepri = basePri & 0xFFU;
+	if ((u32s_Primask == 0) && (u32s_Active == 0)) {
+		sim_dispatch();
+	}
+}
+
+/**
+  * @brief  BASEPRI設定(マスクを上げる方向のみ)
+  * @param  basePri: BASEPRI
+  * @retval None
+  */
+void __set_BASEPRI_MAX(uint32_t basePri)
+{
+	basePri &= 0xFFU;
+	if ((basePri != 0) && ((u32s_Basepri == 0) || (basePri < u32s_Basepri))) {
+		u32s_Basepri = basePri;
+	}
+	__atomic_signal_fence(__ATOMIC_SEQ_CST);
+}
+
+/**
+  * @brief  NVIC割り込み許可
+  * @param  IRQn: 割り込み番号
+  * @retval None
+  */
+void NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+	if ((IRQn >= 0) && (IRQn < SIM_IRQ_NUM)) {
+		__atomic_fetch_or(&u64s_Enable, 1ULL << IRQn, __ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&u64s_Pending, __ATOMIC_ACQUIRE) & (1ULL << IRQn)) {
+			pthread_kill(sts_CpuThread, SIGUSR1);
+		}
+	}
+}
+
+/**
+  * @brief  NVIC割り込み禁止
+  * @param  IRQn: 割り込み番号
+  * @retval None
+  */
+void NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+	if ((IRQn >= 0) && (IRQn < SIM_IRQ_NUM)) {
+		__atomic_fetch_and(&u64s_Enable, ~(1ULL << IRQn), __ATOMIC_SEQ_CST);
+	}
+}
+
+/**
+  * @brief  NVIC保留解除
+  * @param  IRQn: 割り込み番号
+  * @retval None
+  */
+void NVIC_ClearPendingIRQ(IRQn_Type IRQn)
+{
+	if ((IRQn >= 0) && (IRQn < SIM_IRQ_NUM)) {
+		__atomic_fetch_and(&u64s_Pending, ~(1ULL << IRQn), __ATOMIC_SEQ_CST);
+	}
+}
+
+/**
+  * @brief  NVIC保留設定
+  * @param  IRQn: 割り込み番号
+  * @retval None
+  */
+void NVIC_SetPendingIRQ(IRQn_Type IRQn)
+{
+	if ((IRQn >= 0) && (IRQn < SIM_IRQ_NUM)) {
+		sim_raise_irq((uint32_t)IRQn, simGetTime());
+	}
+}
+
+/**
+  * @brief  NVIC保留状態取得
+  * @param  IRQn: 割り込み番号
+  * @retval 1:保留中 0:保留なし
+  */
+uint32_t NVIC_GetPendingIRQ(IRQn_Type IRQn)
+{
+	if ((IRQn >= 0) && (IRQn < SIM_IRQ_NUM)) {
+		return (uint32_t)((__atomic_load_n(&u64s_Pending, __ATOMIC_ACQUIRE) >> IRQn) & 1U);
+	}
+	return 0;
+}
+
+/**
+  * @brief  割り込み優先度設定
+  * @param  IRQn: 割り込み番号
+  * @param  priority: 優先度(0が最高)
+  * @retval None
+  */
+void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority)
+{
+	if (IRQn == SysTick_IRQn) {
+		u8s_Priority[SIM_IRQ_SYSTICK] = (uint8_t)priority;
+	}
+	else if ((IRQn >= 0) && (IRQn < SIM_IRQ_NUM)) {
+		u8s_Priority[IRQn] = (uint8_t)priority;
+	}
+}
+
+/**
+  * @brief  割り込み優先度取得
+  * @param  IRQn: 割り込み番号
+  * @retval 優先度
+  */
+uint32_t NVIC_GetPriority(IRQn_Type IRQn)
+{
+	if (IRQn == SysTick_IRQn) {
+		return u8s_Priority[SIM_IRQ_SYSTICK];
+	}
+	if ((IRQn >= 0) && (IRQn < SIM_IRQ_NUM)) {
+		return u8s_Priority[IRQn];
+	}
+	return 0;
+}
+
+/**
+  * @brief  割り込みベクター設定
+  * @param  IRQn: 割り込み番号
+  * @param  vector: ハンドラーのアドレス
+  * @retval None
+  * @note   ベクターテーブルは32bitのため、ハンドラーは下位4GBに配置すること(-no-pie)
+  */
+void NVIC_SetVector(IRQn_Type IRQn, uintptr_t vector)
+{
+	uint32_t *pu32_Vectors = (uint32_t *)(uintptr_t)SCB->VTOR;
+
+	if (vector > UINT32_MAX) {
+		fprintf(stderr, "[sim] vector %p of IRQ %d is above 4GB (build with -no-pie)\n", (void *)vector, (int)IRQn);
+		exit(1);
+	}
+	pu32_Vectors[(int32_t)IRQn + (int32_t)BSP_CORTEX_VECTOR_TABLE_ENTRIES] = (uint32_t)vector;
+}
+
+/**
+  * @brief  MSP取得
+  * @param  None
+  * @retval メインスタックの先頭(ホストではMSPを使用しない)
+  */
+uint32_t __get_MSP(void)
+{
+	return (uint32_t)(uintptr_t)&g_sim_ram.u32_vector[0];
+}
+
+/**
+  * @brief  PSP取得
+  * @param  None
+  * @retval PSP
+  */
+uint32_t __get_PSP(void)
+{
+	return u32s_Psp;
+}
+
+/**
+  * @brief  PSP設定
+  * @param  topOfProcStack: PSP
+  * @retval None
+  */
+void __set_PSP(uint32_t topOfProcStack)
+{
+	u32s_Psp = topOfProcStack;
+}
+
+/**
+  * @brief  CONTROL取得
+  * @param  None
+  * @retval CONTROL
+  */
+uint32_t __get_CONTROL(void)
+{
+	return u32s_Control;
+}
+
+/**
+  * @brief  CONTROL設定
+  * @param  control: CONTROL
+  * @retval None
+  * @note   値を保持するだけで、ホストのスタックは切り替えない
+  */
+void __set_CONTROL(uint32_t control)
+{
+	u32s_Control = control;
+}
+
+/**
+  * @brief  セミホスティング要求
+  * @param  op: 操作番号
+  * @param  arg: パラメーター
+  * @retval 戻り値(未対応の操作は-1)
+  * @note   SYS_WRITE0は標準エラー出力(標準出力はSCI1)に出力する。
+  *         SYS_EXITは終了理由がApplicationExitなら0,それ以外は1で終了する。
+  */
+int __semihost(int op, const void *arg)
+{
+	const char *pc_Str;
+
+	switch (op) {
+	case SIM_SEMIHOST_WRITE0:
+		pc_Str = (const char *)arg;
+		(void)!write(STDERR_FILENO, pc_Str, strlen(pc_Str));
+		return 0;
+	case SIM_SEMIHOST_EXIT:
+		simFinish(((uintptr_t)arg == SIM_SEMIHOST_EXIT_OK) ? 0 : 1);
+	default:
+		return -1;
+	}
+}
+
+/**
+  * @brief  割り込みベクター取得
+  * @param  IRQn: 割り込み番号
+  * @retval ハンドラーのアドレス
+  */
+uint32_t NVIC_GetVector(IRQn_Type IRQn)
+{
+	uint32_t *pu32_Vectors = (uint32_t *)(uintptr_t)SCB->VTOR;
+
+	return pu32_Vectors[(int32_t)IRQn + (int32_t)BSP_CORTEX_VECTOR_TABLE_ENTRIES];
+}
+
+/**
+  * @brief  システムリセット
+  * @param  None
+  * @retval None
+  * @note   ホストではリセットの代わりに終了する
+  */
+void NVIC_SystemReset(void)
+{
+	sim_log("NVIC_SystemReset");
+	simFinish(0);
+}
+
+/**
+  * @brief  SysTick設定
+  * @param  ticks: 割り込み周期[クロック数]
+  * @retval 0:正常 1:設定範囲外
+  */
+uint32_t SysTick_Config(uint32_t ticks)
+{
+	if ((ticks - 1UL) > SysTick_LOAD_RELOAD_Msk) {
+		return 1UL;
+	}
+	SysTick->LOAD = ticks - 1UL;
+	NVIC_SetPriority(SysTick_IRQn, (1UL << __NVIC_PRIO_BITS) - 1UL);
+	SysTick->VAL = 0UL;
+	SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+	return 0UL;
+}
+
+/* FSP互換関数 ---------------------------------------------------------------*/
+
+/**
+  * @brief  端子設定(PFS)の書き込み許可
+  * @param  None
+  * @retval None
+  */
+void R_BSP_PinAccessEnable(void)
+{
+}
+
+/**
+  * @brief  端子設定(PFS)の書き込み禁止
+  * @param  None
+  * @retval None
+  */
+void R_BSP_PinAccessDisable(void)
+{
+}
+
+/**
+  * @brief  NMIコールバック登録
+  * @param  irq: NMI要因
+  * @param  p_callback: コールバック
+  * @retval FSP_SUCCESS
+  * @note   スタックモニターは模擬しないため、コールバックは呼び出されない
+  */
+fsp_err_t R_BSP_GroupIrqWrite(bsp_grp_irq_t irq, void (*p_callback)(bsp_grp_irq_t irq))
+{
+	(void)irq;
+	(void)p_callback;
+	return FSP_SUCCESS;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  実時間[ns]を取得する
+  * @param  None
+  * @retval 実時間[ns]
+  */
+static uint64_t sim_real_time(void)
+{
+	struct timespec st_Time;
+
+	clock_gettime(CLOCK_MONOTONIC, &st_Time);
+	return ((uint64_t)st_Time.tv_sec * SIM_NS_PER_SEC) + (uint64_t)st_Time.tv_nsec;
+}
+
+/**
+  * @brief  HWモデルの排他開始
+  * @param  None
+  * @retval None
+  * @note   シグナルハンドラーからも使うためスピンロックとする
+  */
+void sim_lock(void)
+{
+	while (__atomic_test_and_set(&u8s_Lock, __ATOMIC_ACQUIRE)) {
+		sched_yield();
+	}
+}
+
+/**
+  * @brief  HWモデルの排他終了
+  * @param  None
+  * @retval None
+  */
+void sim_unlock(void)
+{
+	__atomic_clear(&u8s_Lock, __ATOMIC_RELEASE);
+}
+
+/**
+  * @brief  ファームウェアからのHWモデルの排他開始
+  * @param  pst_Saved: 元のシグナルマスクの格納先
+  * @retval None
+  * @note   CPUスレッドのハンドラー(SIGALRM/SIGUSR1)も排他を取るため、保留してから
+  *         ロックする(同じスレッドのハンドラーがロックを待ち続けないように)
+  */
+void sim_lock_fw(sigset_t *pst_Saved)
+{
+	sigset_t st_Mask;
+
+	sigemptyset(&st_Mask);
+	sigaddset(&st_Mask, SIGUSR1);
+	sigaddset(&st_Mask, SIGALRM);
+	pthread_sigmask(SIG_BLOCK, &st_Mask, pst_Saved);
+	sim_lock();
+}
+
+/**
+  * @brief  ファームウェアからのHWモデルの排他終了
+  * @param  pst_Saved: sim_lock_fw()で保存したシグナルマスク
+  * @retval None
+  */
+void sim_unlock_fw(const sigset_t *pst_Saved)
+{
+	sim_unlock();
+	pthread_sigmask(SIG_SETMASK, pst_Saved, NULL);
+}
+
+/**
+  * @brief  割り込みを保留にしてCPUスレッドへ通知する
+  * @param  u32_Irq: 割り込み番号(SIM_IRQ_SYSTICK:SysTick)
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+void sim_raise_irq(uint32_t u32_Irq, uint64_t u64_Now)
+{
+	uint64_t u64_Bit = 1ULL << u32_Irq;
+
+	if (__atomic_load_n(&u64s_Pending, __ATOMIC_ACQUIRE) & u64_Bit) {
+		/* 保留中の再発生は実機同様にまとめられる */
+		sts_IrqStat[u32_Irq].u64_lost++;
+		return;
+	}
+	u64s_RaiseTime[u32_Irq] = u64_Now;
+	__atomic_fetch_or(&u64s_Pending, u64_Bit, __ATOMIC_RELEASE);
+	if (__atomic_load_n(&u64s_Enable, __ATOMIC_ACQUIRE) & u64_Bit) {
+		pthread_kill(sts_CpuThread, SIGUSR1);
+	}
+}
+
+/**
+  * @brief  保留中の割り込みを優先度順に実行する
+  * @param  None
+  * @retval None
+  */
+static void sim_dispatch(void)
+{
+	uint64_t u64_Now;
+	uint64_t u64_Latency;
+	int32_t i32_Irq;
+	uint32_t u32_Irq;
+	fsp_vector_t pfn_Handler;
+
+	while (u32s_Primask == 0) {
+		i32_Irq = sim_next_irq();
+		if ((i32_Irq < 0) || sim_irq_masked((uint32_t)i32_Irq)) {
+			break;
+		}
+		u32_Irq = (uint32_t)i32_Irq;
+		if ((__atomic_fetch_and(&u64s_Pending, ~(1ULL << u32_Irq), __ATOMIC_ACQ_REL) & (1ULL << u32_Irq)) == 0) {
+			continue;
+		}
+
+		u64_Now = simGetTime();
+		u64_Latency = (u64_Now > u64s_RaiseTime[u32_Irq]) ? (u64_Now - u64s_RaiseTime[u32_Irq]) : 0;
+		sts_IrqStat[u32_Irq].u64_count++;
+		sts_IrqStat[u32_Irq].u64_lat_sum += u64_Latency;
+		if (u64_Latency > sts_IrqStat[u32_Irq].u64_lat_max) {
+			sts_IrqStat[u32_Irq].u64_lat_max = u64_Latency;
+		}
+
+		pfn_Handler = sim_get_handler(u32_Irq);
+		if (pfn_Handler != NULL) {
+			u32s_Active++;
+			pfn_Handler();
+			u32s_Active--;
+		}
+		u64s_WakeCount++;
+	}
+}
+
+/**
+  * @brief  次に実行する割り込みを選ぶ
+  * @param  None
+  * @retval 割り込み番号(SIM_IRQ_SYSTICK:SysTick) / -1:保留なし
+  * @note   優先度が最も高い割り込みを選ぶ(同じ優先度はSysTick,番号の小さい順)
+  */
+static int32_t sim_next_irq(void)
+{
+	uint64_t u64_Ready;
+	uint32_t u32_Irq;
+	uint32_t _i;
+
+	u64_Ready = __atomic_load_n(&u64s_Pending, __ATOMIC_ACQUIRE) & __atomic_load_n(&u64s_Enable, __ATOMIC_ACQUIRE);
+	if (u64_Ready == 0) {
+		return -1;
+	}
+	u32_Irq = SIM_IRQ_SYSTICK;
+	if ((u64_Ready & (1ULL << SIM_IRQ_SYSTICK)) == 0) {
+		u32_Irq = (uint32_t)__builtin_ctzll(u64_Ready);
+	}
+	for (_i=0; _i<SIM_IRQ_NUM; _i++) {
+		if ((u64_Ready & (1ULL << _i)) && (u8s_Priority[_i] < u8s_Priority[u32_Irq])) {
+			u32_Irq = _i;
+		}
+	}
+	return (int32_t)u32_Irq;
+}
+
+/**
+  * @brief  割り込みがBASEPRIでマスクされているか確認する
+  * @param  u32_Irq: 割り込み番号(SIM_IRQ_SYSTICK:SysTick)
+  * @retval true:マスク中 / false:実行できる
+  */
+static bool sim_irq_masked(uint32_t u32_Irq)
+{
+	uint32_t u32_Basepri = u32s_Basepri;
+
+	return ((u32_Basepri != 0)
+		 && (((uint32_t)u8s_Priority[u32_Irq] << (8U - __NVIC_PRIO_BITS)) >= u32_Basepri));
+}
+
+/**
+  * @brief  割り込みハンドラーを取得する
+  * @param  u32_Irq: 割り込み番号(SIM_IRQ_SYSTICK:SysTick)
+  * @retval ハンドラー(未登録はNULL)
+  */
+static fsp_vector_t sim_get_handler(uint32_t u32_Irq)
+{
+	uint32_t *pu32_Vectors = (uint32_t *)(uintptr_t)SCB->VTOR;
+	uint32_t u32_Index = (u32_Irq == SIM_IRQ_SYSTICK) ? 15 : (u32_Irq + BSP_CORTEX_VECTOR_TABLE_ENTRIES);
+
+	if (pu32_Vectors == NULL) {
+		return (u32_Irq == SIM_IRQ_SYSTICK) ? __VECTOR_TABLE[15] : NULL;
+	}
+	return (fsp_vector_t)(uintptr_t)pu32_Vectors[u32_Index];
+}
+
+/**
+  * @brief  割り込み通知(SIGUSR1)ハンドラー
+  * @param  i32_Sig: シグナル番号
+  * @retval None
+  */
+static void sim_usr1_handler(int i32_Sig)
+{
+	int i32_Errno = errno;
+
+	(void)i32_Sig;
+	if ((u32s_Primask == 0) && (u32s_Active == 0)) {
+		sim_dispatch();
+	}
+	errno = i32_Errno;
+}
+
+/**
+  * @brief  レジスタアクセス捕捉(SIGSEGV)ハンドラー
+  * @param  i32_Sig: シグナル番号
+  * @param  pst_Info: シグナル情報
+  * @param  pv_Context: 中断したコンテキスト
+  * @retval None
+  * @note   ページ保護を解除し、トラップフラグを立てて1命令だけ実行させる
+  */
+static void sim_segv_handler(int i32_Sig, siginfo_t *pst_Info, void *pv_Context)
+{
+	ucontext_t *pst_Context = (ucontext_t *)pv_Context;
+	uintptr_t u32_Addr = (uintptr_t)pst_Info->si_addr;
+	uintptr_t u32_Base = (uintptr_t)g_sim_trap;
+	size_t u32_Offset;
+
+	(void)i32_Sig;
+	if ((u32_Addr < u32_Base) || (u32_Addr >= (u32_Base + sizeof(SimTrapRegs)))) {
+		/* 本来の不正アクセスは既定動作(異常終了)とする */
+		signal(SIGSEGV, SIG_DFL);
+		return;
+	}
+	u32_Offset = u32_Addr - u32_Base;
+
+	sts_Trap.bl_write = ((pst_Context->uc_mcontext.gregs[REG_ERR] & 0x2) != 0);
+	sts_Trap.u32_offset = u32_Offset;
+	sts_Trap.st_mask = pst_Context->uc_sigmask;
+	sts_Trap.bl_active = true;
+	u64s_TrapCount++;
+
+	sim_lock();
+	sim_pre_access(u32_Offset, sts_Trap.bl_write, simGetTime());
+	sim_unlock();
+
+	mprotect((uint8_t *)g_sim_trap + ((u32_Offset / SIM_PAGE_SIZE) * SIM_PAGE_SIZE), SIM_PAGE_SIZE, PROT_READ | PROT_WRITE);
+	/* ステップ実行中は割り込み通知/HWタイマーを保留する */
+	sigaddset(&pst_Context->uc_sigmask, SIGUSR1);
+	sigaddset(&pst_Context->uc_sigmask, SIGALRM);
+	pst_Context->uc_mcontext.gregs[REG_EFL] |= SIM_TRAP_TF;
+}
+
+/**
+  * @brief  ステップ実行(SIGTRAP)ハンドラー
+  * @param  i32_Sig: シグナル番号
+  * @param  pst_Info: シグナル情報
+  * @param  pv_Context: 中断したコンテキスト
+  * @retval None
+  */
+static void sim_trap_handler(int i32_Sig, siginfo_t *pst_Info, void *pv_Context)
+{
+	ucontext_t *pst_Context = (ucontext_t *)pv_Context;
+	uint64_t u64_Now;
+
+	(void)i32_Sig;
+	(void)pst_Info;
+	pst_Context->uc_mcontext.gregs[REG_EFL] &= ~SIM_TRAP_TF;
+	if (!sts_Trap.bl_active) {
+		return;
+	}
+	sts_Trap.bl_active = false;
+
+	sim_lock();
+	u64_Now = simGetTime();
+	sim_post_access(sts_Trap.u32_offset, sts_Trap.bl_write, u64_Now);
+	sim_schedule(u64_Now);
+	sim_unlock();
+
+	sim_page_protect(sts_Trap.u32_offset / SIM_PAGE_SIZE);
+	pst_Context->uc_sigmask = sts_Trap.st_mask;
+
+	if (bls_FwTimerRequest) {
+		bls_FwTimerRequest = false;
+		sim_fw_timer_preset();
+	}
+}
+
+/**
+  * @brief  アクセス前のモデル更新(読み出し値の準備)
+  * @param  u32_Offset: 捕捉領域内のオフセット
+  * @param  bl_Write: 書き込みアクセス
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+void sim_pre_access(size_t u32_Offset, bool bl_Write, uint64_t u64_Now)
+{
+	if (bl_Write) {
+		return;
+	}
+	if ((u32_Offset / SIM_PAGE_SIZE) == SIM_PAGE_CORE) {
+		sim_clock_read(u32_Offset, u64_Now);
+	}
+	else if (u32_Offset == offsetof(SimTrapRegs, faci.FSTATR1)) {
+		/* 書き込み/消去の完了 */
+		sim_flash_update(u64_Now);
+	}
+	else if ((u32_Offset / SIM_PAGE_SIZE) == SIM_PAGE_USB) {
+		sim_usb_read(u32_Offset - offsetof(SimTrapRegs, usbfs));
+	}
+	else if ((u32_Offset / SIM_PAGE_SIZE) == SIM_PAGE_IIC) {
+		/* SCLI/SDAIとフラグを現在の時刻に合わせる */
+		sim_iic_update(u64_Now);
+	}
+	else if ((u32_Offset / SIM_PAGE_SIZE) == SIM_PAGE_SPI) {
+		/* フラグと受信バッファを現在の時刻に合わせる */
+		sim_spi_update(u64_Now);
+	}
+	else if ((u32_Offset / SIM_PAGE_SIZE) == SIM_PAGE_CAN) {
+		/* 状態,FIFO,エラーカウンターを現在の時刻に合わせる */
+		sim_can_update(u64_Now);
+	}
+	else if ((u32_Offset / SIM_PAGE_SIZE) == SIM_PAGE_GPT) {
+		sim_gpt_access(u32_Offset - offsetof(SimTrapRegs, gpt), false, u64_Now);
+	}
+}
+
+/**
+  * @brief  アクセス後のモデル更新(書き込み/読み出しの副作用)
+  * @param  u32_Offset: 捕捉領域内のオフセット
+  * @param  bl_Write: 書き込みアクセス
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+void sim_post_access(size_t u32_Offset, bool bl_Write, uint64_t u64_Now)
+{
+	size_t u32_Member;
+
+	switch (u32_Offset / SIM_PAGE_SIZE) {
+	case SIM_PAGE_SCI:
+		sim_sci_access(u32_Offset - offsetof(SimTrapRegs, sci), bl_Write, u64_Now);
+		break;
+	case SIM_PAGE_PORT:
+		if (bl_Write) {
+			sim_port_write((uint32_t)((u32_Offset - (SIM_PAGE_PORT * SIM_PAGE_SIZE)) / sizeof(R_PORT0_Type)), u64_Now);
+		}
+		break;
+	case SIM_PAGE_CORE:
+		sim_clock_access(u32_Offset, bl_Write, u64_Now);
+		break;
+	case SIM_PAGE_FLASH:
+		if (bl_Write) {
+			sim_flash_write(u32_Offset, u64_Now);
+		}
+		break;
+	case SIM_PAGE_USB:
+		if (bl_Write) {
+			sim_usb_write(u32_Offset - offsetof(SimTrapRegs, usbfs), u64_Now);
+		}
+		break;
+	case SIM_PAGE_IIC:
+		u32_Member = u32_Offset - offsetof(SimTrapRegs, iic);
+		if ((u32_Member / sizeof(R_IIC0_Type)) == 1) {
+			sim_iic_access(u32_Member % sizeof(R_IIC0_Type), bl_Write, u64_Now);
+		}
+		break;
+	case SIM_PAGE_SPI:
+		u32_Member = u32_Offset - offsetof(SimTrapRegs, spi);
+		if ((u32_Member / sizeof(R_SPI0_Type)) == 0) {
+			sim_spi_access(u32_Member, bl_Write, u64_Now);
+		}
+		break;
+	case SIM_PAGE_CAN:
+		sim_can_access(u32_Offset - offsetof(SimTrapRegs, can0), bl_Write, u64_Now);
+		break;
+	case SIM_PAGE_GPT:
+		if (bl_Write) {
+			sim_gpt_access(u32_Offset - offsetof(SimTrapRegs, gpt), true, u64_Now);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+  * @brief  ページ保護を設定する
+  * @param  u32_Page: ページ番号
+  * @retval None
+  * @note   SCI/SysTick/DWT/SYSTEM/FACI/USBFS/IIC/SPI/CAN/GPTは読み出しにも副作用があるため読み書きとも捕捉する
+  */
+static void sim_page_protect(size_t u32_Page)
+{
+	mprotect((uint8_t *)g_sim_trap + (u32_Page * SIM_PAGE_SIZE), SIM_PAGE_SIZE,
+		(u32_Page == SIM_PAGE_PORT) ? PROT_READ : PROT_NONE);
+}
+
+/**
+  * @brief  ログ出力(標準エラー出力)
+  * @param  pc_Format: 書式
+  * @retval None
+  * @note   シグナルハンドラーから呼ぶためwrite()で出力する
+  */
+void sim_log(const char *pc_Format, ...)
+{
+	char c_Buffer[128];
+	va_list st_Args;
+	int i32_Len;
+
+	memcpy(c_Buffer, "[sim] ", 6);
+	va_start(st_Args, pc_Format);
+	i32_Len = vsnprintf(&c_Buffer[6], sizeof(c_Buffer) - 7, pc_Format, st_Args);
+	va_end(st_Args);
+	if (i32_Len < 0) {
+		return;
+	}
+	i32_Len += 6;
+	if (i32_Len > (int)sizeof(c_Buffer) - 1) {
+		i32_Len = (int)sizeof(c_Buffer) - 1;
+	}
+	c_Buffer[i32_Len++] = '\n';
+	(void)!write(STDERR_FILENO, c_Buffer, (size_t)i32_Len);
+}
+
+/**
+  * @brief  早送りの仮想時間を進める
+  * @param  u_Pc: HWタイマーで中断した位置
+  * @retval 仮想時間[ns]
+  * @note   u8s_Lockの取得中にCPUスレッドから呼ぶこと。
+  *         前回と同じ位置(SIM_ACCEL_PC_RANGE以内)で中断し、その間にレジスタ
+  *         アクセスが無く、割り込み許可中かつISR外で実行待ちの割り込みも
+  *         無ければアイドルとみなし、
+  *         次のイベント時刻まで進める。それ以外は実時間の経過分
+  *         (×速度倍率)だけ進める(次のイベント時刻は越えない)。
+  */
+static uint64_t sim_accel_advance(uintptr_t u_Pc)
+{
+	uint64_t u64_Real = sim_real_time();
+	uint64_t u64_Now;
+	uintptr_t u_Distance = (u_Pc > us_AccelPc) ? (u_Pc - us_AccelPc) : (us_AccelPc - u_Pc);
+
+	if ((u64s_TrapCount == u64s_AccelTraps) && (u_Distance < SIM_ACCEL_PC_RANGE)
+	 && (u32s_Primask == 0) && (u32s_Active == 0) && (u32s_Basepri == 0)
+	 && ((__atomic_load_n(&u64s_Pending, __ATOMIC_ACQUIRE) & u64s_Enable) == 0)) {
+		u64_Now = u64s_AccelNext;
+		u64s_AccelSkips++;
+	}
+	else {
+		u64_Now = u64s_AccelNow + (uint64_t)((double)(u64_Real - u64s_AccelReal) * dbs_Speedup);
+		if (u64_Now > u64s_AccelNext) {
+			u64_Now = u64s_AccelNext;
+		}
+	}
+	if (u64_Now < u64s_AccelNow) {
+		u64_Now = u64s_AccelNow;
+	}
+	u64s_AccelTraps = u64s_TrapCount;
+	us_AccelPc = u_Pc;
+	u64s_AccelReal = u64_Real;
+	u64s_AccelNow = u64_Now;
+	return u64_Now;
+}
+
+/**
+  * @brief  早送りのHWタイマーを設定する
+  * @param  None
+  * @retval None
+  * @note   ハンドラーの終了からSIM_ACCEL_PERIODの間はCPUスレッドを実行させる
+  *         (周期タイマーではシグナル処理が追いつかず割り込みを実行できない)
+  */
+static void sim_accel_arm(void)
+{
+	struct itimerspec st_Timer;
+
+	if (!bls_Accel) {
+		return;
+	}
+	memset(&st_Timer, 0, sizeof(st_Timer));
+	st_Timer.it_value.tv_nsec = SIM_ACCEL_PERIOD;
+	timer_settime(sts_Timer, 0, &st_Timer, NULL);
+}
+
+/**
+  * @brief  lib_timerのシステムタイマーの先送りを要求する
+  * @param  None
+  * @retval None
+  * @note   SysTickの開始時に呼ぶ。初回の開始時(taskTimerInit()の後)だけ要求し、
+  *         先送りはアクセスの捕捉の完了後に行う(sim_fw_timer_preset())。
+  */
+void sim_fw_timer_request(void)
+{
+	if (bls_FwTimerPreset) {
+		bls_FwTimerPreset = false;
+		bls_FwTimerRequest = true;
+	}
+}
+
+/**
+  * @brief  lib_timerのシステムタイマーを先送りする
+  * @param  None
+  * @retval None
+  * @note   taskTimerUpdate()を繰り返し呼び出して-wの値(を越えない位置)まで進める。
+  *         先送りにかかった実時間は仮想時間に含めない。
+  */
+static void sim_fw_timer_preset(void)
+{
+	SimFwTimer st_Timer;
+	uint64_t u64_Start = sim_real_time();
+	uint64_t u64_Count;
+	uint64_t _i;
+	uint32_t u32_Step;
+
+	if ((taskTimerUpdate == NULL) || (startTimer == NULL)) {
+		sim_log("timer preset: lib_timer not linked");
+		return;
+	}
+	/* 1回の更新で進む時間(SYS_CYCLE_TIME)を求める */
+	startTimer(&st_Timer);
+	u32_Step = st_Timer.u32_time;
+	taskTimerUpdate();
+	startTimer(&st_Timer);
+	u32_Step = st_Timer.u32_time - u32_Step;
+	if (u32_Step == 0) {
+		return;
+	}
+	u64_Count = (uint32_t)(u32s_FwTimerPreset - st_Timer.u32_time) / u32_Step;
+	for (_i=0; _i<u64_Count; _i++) {
+		taskTimerUpdate();
+	}
+	startTimer(&st_Timer);
+
+	u64_Start = sim_real_time() - u64_Start;
+	u64s_StartReal += u64_Start;
+	u64s_AccelReal += u64_Start;
+	sim_log("timer preset: %u ms (%llu updates, %.3f s)", st_Timer.u32_time,
+		(unsigned long long)(u64_Count + 1), (double)u64_Start / SIM_NS_PER_SEC);
+}
+
+/**
+  * @brief  HWタイマー(SIGALRM)ハンドラー
+  * @param  i32_Sig: シグナル番号
+  * @param  pst_Info: シグナル情報
+  * @param  pv_Context: 中断したコンテキスト
+  * @retval None
+  * @note   CPUスレッドで実行し、仮想時間を進めて周辺機能を動かす。
+  *         発生した割り込みはSIGUSR1でこのハンドラーの終了後に実行する。
+  */
+static void sim_timer_handler(int i32_Sig, siginfo_t *pst_Info, void *pv_Context)
+{
+	int i32_Errno = errno;
+	ucontext_t *pst_Context = (ucontext_t *)pv_Context;
+	uint64_t u64_Now;
+	uint64_t u64_InputEnd;
+
+	(void)i32_Sig;
+	(void)pst_Info;
+	sim_lock();
+	u64_Now = bls_Accel ? sim_accel_advance((uintptr_t)pst_Context->uc_mcontext.gregs[REG_RIP]) : simGetTime();
+	sim_systick_update(u64_Now);
+	sim_script_update(u64_Now);
+	sim_sci_update(u64_Now);
+	sim_esp_update(u64_Now);
+	sim_gpt_update(u64_Now);
+	sim_usb_update(u64_Now);
+	sim_iic_update(u64_Now);
+	sim_spi_update(u64_Now);
+	sim_can_update(u64_Now);
+	u64_InputEnd = sim_sci_input_end(u64_Now);
+	sim_schedule(u64_Now);
+	sim_unlock();
+
+	/* ---- 終了判定 ---- */
+	if ((u64s_TimeLimit != 0) && (u64_Now >= u64s_TimeLimit)) {
+		simFinish(0);
+	}
+	if ((u64s_ExitAfterInput != 0) && (u64_InputEnd != 0)
+	 && (u64_Now >= (u64_InputEnd + u64s_ExitAfterInput))) {
+		simFinish(0);
+	}
+	sim_accel_arm();
+	errno = i32_Errno;
+}
+
+/**
+  * @brief  次のイベント時刻にHWタイマーを設定する
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   u8s_Lockの取得中に呼ぶこと
+  */
+static void sim_schedule(uint64_t u64_Now)
+{
+	uint64_t u64_Next = u64_Now + (uint64_t)((double)SIM_TIMER_MAX * dbs_Speedup);
+	uint64_t u64_Wait;
+	struct itimerspec st_Timer;
+
+	sim_systick_schedule(&u64_Next);
+	sim_gpt_schedule(&u64_Next);
+	sim_sci_schedule(u64_Now, &u64_Next);
+	sim_esp_schedule(&u64_Next);
+	sim_usb_schedule(&u64_Next);
+	sim_iic_schedule(&u64_Next);
+	sim_spi_schedule(&u64_Next);
+	sim_can_schedule(&u64_Next);
+	if ((u64s_TimeLimit != 0) && (u64s_TimeLimit < u64_Next)) {
+		u64_Next = u64s_TimeLimit;
+	}
+	if (bls_Accel) {
+		/* 早送りは次のイベント時刻だけを記録する(HWタイマーはsim_accel_arm()) */
+		u64s_AccelNext = u64_Next;
+		return;
+	}
+
+	u64_Wait = (u64_Next > u64_Now) ? (uint64_t)((double)(u64_Next - u64_Now) / dbs_Speedup) : 0;
+	if (u64_Wait < SIM_TIMER_MIN) {
+		u64_Wait = SIM_TIMER_MIN;
+	}
+	memset(&st_Timer, 0, sizeof(st_Timer));
+	st_Timer.it_value.tv_nsec = (long)u64_Wait;
+	timer_settime(sts_Timer, 0, &st_Timer, NULL);
+}
+
+/**
+  * @brief  使い方を表示して終了する
+  * @param  pc_Name: プログラム名
+  * @retval None
+  */
+static void sim_usage(const char *pc_Name)
+{
+	fprintf(stderr, "usage: %s [-s speedup] [-t ms] [-e ms] [-i rxfile] [-o txfile] [-f flashfile] [-c count] [-b none|echo]\n"
+		"       [-x] [-I rxscript] [-O txlog] [-w ms] [-v]\n"
+		"  -w ms  advance only the lib_timer system timer to ms at SysTick start.\n"
+		"         Virtual time is not advanced, so timers outside lib_timer\n"
+		"         (coroutine timers, KVS delay, UART idle timeouts) never wrap.\n", pc_Name);
+	exit(2);
+}
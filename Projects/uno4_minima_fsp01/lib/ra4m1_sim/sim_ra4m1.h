@@ -0,0 +1,40 @@
+/**
+  ******************************************************************************
+  * @file           : sim_ra4m1.h
+  * @brief          : RA4M1レジスタモデル シミュレーター制御
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SIM_RA4M1_H
+#define __SIM_RA4M1_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "bsp_api.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/* Exported constants --------------------------------------------------------*/
+#define SIM_CPU_CLOCK		(48000000UL)	/* 模擬するCPUクロック[Hz]			*/
+#define SIM_IRQ_NUM			(32)			/* ICU割り込み数					*/
+#define SIM_IRQ_SYSTICK		(SIM_IRQ_NUM)	/* SysTick例外の管理番号			*/
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+extern uint64_t simGetTime(void);									/* 仮想時間[ns]を取得する				*/
+extern void simRaiseEvent(elc_event_t en_Event);					/* ELCイベントを発生させる				*/
+extern void simSetPinInput(uint8_t u8_Port, uint8_t u8_Pin, uint8_t u8_Level);	/* 入力端子レベルを設定する	*/
+extern uint16_t simSciReceive(const uint8_t *pu8_Data, uint16_t u16_Size);	/* SCI1の受信データを積む	*/
+extern void simFlashPowerCut(uint32_t u32_Count);					/* データフラッシュを電源断/復電させる	*/
+extern void simFinish(int i32_Code) __attribute__((noreturn));		/* 統計を出力して終了する				*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_RA4M1_H */
@@ -0,0 +1,681 @@
+/**
+  ******************************************************************************
+  * @file           : sim_sci.c
+  * @brief          : RA4M1レジスタモデル SCI1(UART)
+  ******************************************************************************
+  * @note   SCI1の送受信をバイト単位の時間(SMR/BRR/SEMRとPCLKAから求める)で
+  *         模擬する。送信データは出力(-o,既定:標準出力)に書き出し、受信データは
+  *         入力スレッドが入力(-i,既定:標準入力)から受信キューに積む。前の受信
+  *         データが読まれていなければオーバーラン(ORER)にする。
+  *         入力スクリプト(-I)は受信データを仮想時刻付きで与え、送信ログ(-O)は
+  *         送信データを行単位で仮想時刻付きで記録する。ファームウェア(テスト)からは
+  *         simSciReceive()で受信データを積める。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim_local.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* 入力スクリプトの1行 */
+typedef struct {
+	uint64_t u64_time;							/* 送信開始の仮想時刻[ns]			*/
+	uint32_t u32_offset;						/* データの位置(pu8s_ScriptData)		*/
+	uint32_t u32_length;						/* データ長[byte]					*/
+	uint32_t u32_repeat;						/* 繰り返し回数						*/
+} SimScript;
+
+/* Private define ------------------------------------------------------------*/
+#define SIM_RXQ_SIZE		(4096)				/* 受信キューのサイズ				*/
+#define SIM_SCRIPT_LINE		(1024)				/* 入力スクリプトの1行の最大長		*/
+#define SIM_TXLOG_LINE		(256)				/* 送信ログの1行の最大長			*/
+
+/* SCIレジスタのビット */
+#define SCI_SSR_ORER		(0x20)
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* SCI1(sim_lock()で排他) */
+static uint8_t u8s_SciScr;
+static bool bls_SciTxBusy;
+static uint8_t u8s_SciTxByte;
+static uint64_t u64s_SciTxEnd;
+static uint64_t u64s_SciRxNext;
+static uint64_t u64s_SciByteTime = SIM_NS_PER_SEC / 960;
+static uint64_t u64s_SciTxCount;
+static uint64_t u64s_SciRxCount;
+static uint64_t u64s_SciOverrun;
+
+/* 受信キュー(u8s_Lockで排他) */
+static uint8_t u8s_RxQueue[SIM_RXQ_SIZE];
+static uint32_t u32s_RxHead;
+static uint32_t u32s_RxTail;
+static bool bls_RxEof;
+static uint64_t u64s_RxEofTime;
+
+/* 入力スクリプト(u8s_Lockで排他) */
+static SimScript *psts_Script;
+static uint32_t u32s_ScriptNum;
+static uint8_t *pu8s_ScriptData;
+static uint32_t u32s_ScriptIndex;					/* 送信中の行						*/
+static uint64_t u64s_ScriptPos;						/* 送信中の行の送信済み[byte]		*/
+
+/* 入出力 */
+static int i32s_InFd = STDIN_FILENO;
+static int i32s_OutFd = STDOUT_FILENO;
+static int i32s_TxLogFd = -1;						/* 送信ログ(-1:無し)				*/
+static char cs_TxLogLine[SIM_TXLOG_LINE + 8];		/* 送信ログの作成中の行				*/
+static uint32_t u32s_TxLogLen;
+
+/* Private function prototypes -----------------------------------------------*/
+static void sim_sci_scr_write(uint64_t u64_Now);
+static void sim_sci_tdr_write(uint64_t u64_Now);
+static void sim_txlog_put(uint8_t u8_Data, uint64_t u64_Time);
+static void sim_txlog_flush(void);
+static void *sim_input_thread(void *pv_Arg);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  SCIの1バイトの時間を求める
+  * @param  pst_Sci: SCIのレジスタ
+  * @retval 1バイト(スタート/ストップビットを含む)の時間[ns]
+  * @note   B = PCLKA / (64 * 2^(2n-1) * (BRR+1)), SEMR.ABCS/BGDMで2倍速
+  */
+uint64_t sim_sci_byte_time(const R_SCI0_Type *pst_Sci)
+{
+	uint64_t u64_Divider = 32ULL << (2 * (pst_Sci->SMR & 0x03));
+	uint64_t u64_Bits = 10;
+
+	if (pst_Sci->SEMR & 0x10) {							// ABCS
+		u64_Divider /= 2;
+	}
+	if (pst_Sci->SEMR & 0x40) {							// BGDM
+		u64_Divider /= 2;
+	}
+	u64_Divider *= ((uint64_t)pst_Sci->BRR + 1);
+	if (pst_Sci->SMR & 0x40) {							// 7bitデータ
+		u64_Bits--;
+	}
+	if (pst_Sci->SMR & 0x20) {							// パリティあり
+		u64_Bits++;
+	}
+	if (pst_Sci->SMR & 0x08) {							// 2ストップビット
+		u64_Bits++;
+	}
+	return (u64_Bits * u64_Divider * SIM_NS_PER_SEC) / R_FSP_SystemClockHzGet(FSP_PRIV_CLOCK_PCLKA);
+}
+
+/**
+  * @brief  SCI1の通信速度を求める
+  * @param  None
+  * @retval None
+  */
+void sim_sci_config(void)
+{
+	u64s_SciByteTime = sim_sci_byte_time(&g_sim_hw->sci[1]);
+}
+
+/**
+  * @brief  SCI1 SCR書き込み
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+static void sim_sci_scr_write(uint64_t u64_Now)
+{
+	R_SCI0_Type *pst_Sci = &g_sim_hw->sci[1];
+	uint8_t u8_Scr = pst_Sci->SCR;
+	uint8_t u8_TxOn = SCI_SCR_TE | SCI_SCR_TIE;
+
+	if ((u8_Scr & SCI_SCR_TE) == 0) {
+		/* 送信停止で送信部を初期化する */
+		bls_SciTxBusy = false;
+		pst_Sci->SSR |= (SCI_SSR_TDRE | SCI_SSR_TEND);
+	}
+	if (((u8_Scr & u8_TxOn) == u8_TxOn) && ((u8s_SciScr & u8_TxOn) != u8_TxOn)
+	 && (pst_Sci->SSR & SCI_SSR_TDRE)) {
+		/* TEとTIEの同時許可で送信データエンプティ割り込みが発生する */
+		simRaiseEvent(ELC_EVENT_SCI1_TXI);
+	}
+	if ((u8_Scr & SCI_SCR_RE) && !(u8s_SciScr & SCI_SCR_RE)) {
+		u64s_SciRxNext = u64_Now;
+	}
+	u8s_SciScr = u8_Scr;
+}
+
+/**
+  * @brief  SCI1 TDR書き込み
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+static void sim_sci_tdr_write(uint64_t u64_Now)
+{
+	R_SCI0_Type *pst_Sci = &g_sim_hw->sci[1];
+
+	if ((pst_Sci->SCR & SCI_SCR_TE) == 0) {
+		return;
+	}
+	if (!bls_SciTxBusy) {
+		/* 送信シフトレジスタへ即時転送し、TDRは再び空になる */
+		u8s_SciTxByte = pst_Sci->TDR;
+		bls_SciTxBusy = true;
+		u64s_SciTxEnd = u64_Now + u64s_SciByteTime;
+		pst_Sci->SSR = (uint8_t)((pst_Sci->SSR | SCI_SSR_TDRE) & ~SCI_SSR_TEND);
+		if (pst_Sci->SCR & SCI_SCR_TIE) {
+			simRaiseEvent(ELC_EVENT_SCI1_TXI);
+		}
+	}
+	else {
+		pst_Sci->SSR &= (uint8_t)~SCI_SSR_TDRE;
+	}
+}
+
+/**
+  * @brief  SCI1の時間経過処理
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+void sim_sci_update(uint64_t u64_Now)
+{
+	R_SCI0_Type *pst_Sci = &g_sim_hw->sci[1];
+	uint8_t u8_Data;
+
+	/* ---- 送信 ---- */
+	while (bls_SciTxBusy && (u64_Now >= u64s_SciTxEnd)) {
+		u8_Data = u8s_SciTxByte;
+		if (write(i32s_OutFd, &u8_Data, 1) == 1) {
+			u64s_SciTxCount++;
+		}
+		sim_txlog_put(u8_Data, u64s_SciTxEnd);
+		if ((pst_Sci->SSR & SCI_SSR_TDRE) == 0) {
+			u8s_SciTxByte = pst_Sci->TDR;
+			u64s_SciTxEnd += u64s_SciByteTime;
+			pst_Sci->SSR |= SCI_SSR_TDRE;
+			if (pst_Sci->SCR & SCI_SCR_TIE) {
+				simRaiseEvent(ELC_EVENT_SCI1_TXI);
+			}
+		}
+		else {
+			bls_SciTxBusy = false;
+			pst_Sci->SSR |= SCI_SSR_TEND;
+			if (pst_Sci->SCR & SCI_SCR_TEIE) {
+				simRaiseEvent(ELC_EVENT_SCI1_TEI);
+			}
+		}
+	}
+
+	/* ---- 受信 ---- */
+	if ((pst_Sci->SCR & SCI_SCR_RE) && (u32s_RxHead != u32s_RxTail) && (u64_Now >= u64s_SciRxNext)) {
+		u8_Data = u8s_RxQueue[u32s_RxTail];
+		u32s_RxTail = (u32s_RxTail + 1) % SIM_RXQ_SIZE;
+		u64s_SciRxCount++;
+		u64s_SciRxNext = u64_Now + u64s_SciByteTime;
+		if (pst_Sci->SSR & SCI_SSR_RDRF) {
+			/* 前のデータが読まれていない */
+			u64s_SciOverrun++;
+			pst_Sci->SSR |= SCI_SSR_ORER;
+			if (pst_Sci->SCR & SCI_SCR_RIE) {
+				simRaiseEvent(ELC_EVENT_SCI1_ERI);
+			}
+		}
+		else {
+			*(volatile uint8_t *)&pst_Sci->RDR = u8_Data;
+			pst_Sci->SSR |= SCI_SSR_RDRF;
+			if (pst_Sci->SCR & SCI_SCR_RIE) {
+				simRaiseEvent(ELC_EVENT_SCI1_RXI);
+			}
+		}
+	}
+}
+
+/**
+  * @brief  SCIのレジスタ初期値を設定する
+  * @param  None
+  * @retval None
+  * @note   クロックの初期化(sim_clock_init())の後に呼ぶこと
+  */
+void sim_sci_init(void)
+{
+	uint32_t _i;
+
+	for (_i=0; _i<10; _i++) {
+		g_sim_hw->sci[_i].SSR = SCI_SSR_TDRE | SCI_SSR_TEND;
+		g_sim_hw->sci[_i].BRR = 0xFF;
+		g_sim_hw->sci[_i].SCMR = 0xF2;
+	}
+	sim_sci_config();
+}
+
+/**
+  * @brief  SCIのアクセス後のモデル更新
+  * @param  u32_Offset: SCI0からのオフセット
+  * @param  bl_Write: 書き込みアクセス
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   SCI9はESP32-S3との接続として模擬する(sim_esp_access())
+  */
+void sim_sci_access(size_t u32_Offset, bool bl_Write, uint64_t u64_Now)
+{
+	size_t u32_Member = u32_Offset % sizeof(R_SCI0_Type);
+
+	if ((u32_Offset / sizeof(R_SCI0_Type)) == 9) {
+		sim_esp_access(u32_Member, bl_Write, u64_Now);
+		return;
+	}
+	if ((u32_Offset / sizeof(R_SCI0_Type)) != 1) {
+		return;
+	}
+	if (bl_Write) {
+		if (u32_Member == offsetof(R_SCI0_Type, TDR)) {
+			sim_sci_tdr_write(u64_Now);
+		}
+		else if (u32_Member == offsetof(R_SCI0_Type, SCR)) {
+			sim_sci_scr_write(u64_Now);
+		}
+		else if ((u32_Member == offsetof(R_SCI0_Type, SMR)) || (u32_Member == offsetof(R_SCI0_Type, BRR))
+		 || (u32_Member == offsetof(R_SCI0_Type, SEMR))) {
+			sim_sci_config();
+		}
+	}
+	else if (u32_Member == offsetof(R_SCI0_Type, RDR)) {
+		/* RDRの読み出しで受信データフルを解除する */
+		g_sim_hw->sci[1].SSR &= (uint8_t)~SCI_SSR_RDRF;
+	}
+}
+
+/**
+  * @brief  SCI1の次のイベント時刻を反映する
+  * @param  u64_Now: 仮想時間[ns]
+  * @param  pu64_Next: 次のイベント時刻[ns](より早ければ更新する)
+  * @retval None
+  */
+void sim_sci_schedule(uint64_t u64_Now, uint64_t *pu64_Next)
+{
+	if (bls_SciTxBusy && (u64s_SciTxEnd < *pu64_Next)) {
+		*pu64_Next = u64s_SciTxEnd;
+	}
+	if ((u32s_RxHead != u32s_RxTail) && (u64s_SciRxNext < *pu64_Next)) {
+		*pu64_Next = u64s_SciRxNext;
+	}
+	if ((u32s_ScriptIndex < u32s_ScriptNum) && (psts_Script[u32s_ScriptIndex].u64_time > u64_Now)
+	 && (psts_Script[u32s_ScriptIndex].u64_time < *pu64_Next)) {
+		*pu64_Next = psts_Script[u32s_ScriptIndex].u64_time;
+	}
+}
+
+/**
+  * @brief  SCI1の受信データのファイルを開く
+  * @param  pc_Path: ファイル名
+  * @retval true:成功 false:失敗
+  */
+bool sim_sci_open_input(const char *pc_Path)
+{
+	i32s_InFd = open(pc_Path, O_RDONLY);
+	if (i32s_InFd < 0) {
+		perror(pc_Path);
+		return false;
+	}
+	return true;
+}
+
+/**
+  * @brief  SCI1の送信データのファイルを開く
+  * @param  pc_Path: ファイル名
+  * @retval true:成功 false:失敗
+  */
+bool sim_sci_open_output(const char *pc_Path)
+{
+	i32s_OutFd = open(pc_Path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (i32s_OutFd < 0) {
+		perror(pc_Path);
+		return false;
+	}
+	return true;
+}
+
+/**
+  * @brief  SCI1の入力を開始する
+  * @param  None
+  * @retval None
+  * @note   入力スクリプト(-I)が無ければ入力スレッドを開始する。
+  *         シグナルはCPUスレッドのみで受けるため、SIGUSR1/SIGALRMを
+  *         ブロックした状態で呼ぶこと。
+  */
+void sim_sci_start(void)
+{
+	pthread_t st_Thread;
+
+	if (psts_Script == NULL) {
+		pthread_create(&st_Thread, NULL, sim_input_thread, NULL);
+	}
+}
+
+/**
+  * @brief  SCI1の入力の終端の時刻を求める
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval 入力の終端に達して受信キューが空になった時刻[ns](0:未到達)
+  */
+uint64_t sim_sci_input_end(uint64_t u64_Now)
+{
+	if (bls_RxEof && (u64s_RxEofTime == 0) && (u32s_RxHead == u32s_RxTail)) {
+		u64s_RxEofTime = u64_Now;
+	}
+	return u64s_RxEofTime;
+}
+
+/**
+  * @brief  SCI1の受信データを積む
+  * @param  pu8_Data: 受信データ
+  * @param  u16_Size: 受信データ数
+  * @retval 積んだデータ数(受信キューが一杯なら残りは積まない)
+  * @note   ファームウェア(ホスト実行版のテスト)から呼ぶ。受信キューが空の時は
+  *         呼び出しから1文字分の時間で受信させる。
+  */
+uint16_t simSciReceive(const uint8_t *pu8_Data, uint16_t u16_Size)
+{
+	sigset_t st_Saved;
+	uint64_t u64_Now;
+	uint16_t _i;
+
+	sim_lock_fw(&st_Saved);
+	u64_Now = simGetTime();
+	if ((u32s_RxHead == u32s_RxTail) && (u64s_SciRxNext < (u64_Now + u64s_SciByteTime))) {
+		u64s_SciRxNext = u64_Now + u64s_SciByteTime;
+	}
+	for (_i=0; _i<u16_Size; _i++) {
+		if (((u32s_RxHead + 1) % SIM_RXQ_SIZE) == u32s_RxTail) {
+			break;
+		}
+		u8s_RxQueue[u32s_RxHead] = pu8_Data[_i];
+		u32s_RxHead = (u32s_RxHead + 1) % SIM_RXQ_SIZE;
+	}
+	sim_unlock_fw(&st_Saved);
+	return _i;
+}
+
+/**
+  * @brief  送信ログのファイルを開く
+  * @param  pc_Path: ファイル名
+  * @retval true:成功 false:失敗
+  */
+bool sim_txlog_open(const char *pc_Path)
+{
+	i32s_TxLogFd = open(pc_Path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (i32s_TxLogFd < 0) {
+		perror(pc_Path);
+		return false;
+	}
+	return true;
+}
+
+/**
+  * @brief  SCI1の統計を出力する
+  * @param  None
+  * @retval None
+  * @note   作成中の送信ログの行を書き出してから出力する
+  */
+void sim_sci_report(void)
+{
+	sim_txlog_flush();
+	fprintf(stderr, "[sim] SCI1 tx %llu bytes, rx %llu bytes, overrun %llu\n",
+		(unsigned long long)u64s_SciTxCount, (unsigned long long)u64s_SciRxCount, (unsigned long long)u64s_SciOverrun);
+}
+
+/**
+  * @brief  入力スクリプトを読み込む
+  * @param  pc_Path: ファイル名
+  * @retval None
+  * @note   1行に1つ、時刻と送信データを書く(#以降はコメント)。
+  *           @ms "データ" [*回数]  : 仮想時刻ms(小数可)に送信を開始する
+  *           +ms "データ" [*回数]  : 前の行の時刻+msに送信を開始する
+  *         データは\n \r \t \0 \\ \" \xHHのエスケープが使える。*回数は
+  *         データを続けて繰り返す(バースト)。各行の送信はボーレートの間隔で
+  *         行い、前の行が送信中なら続けて送信する。誤りがあれば終了する。
+  */
+void sim_script_load(const char *pc_Path)
+{
+	FILE *pst_File = fopen(pc_Path, "r");
+	char c_Line[SIM_SCRIPT_LINE];
+	char *pc_Pos;
+	char *pc_End;
+	uint32_t u32_LineNo = 0;
+	uint32_t u32_DataSize = 0;
+	uint64_t u64_Time = 0;
+	double db_Ms;
+	SimScript *pst_Entry;
+	unsigned long u32_Value;
+
+	if (pst_File == NULL) {
+		perror(pc_Path);
+		exit(1);
+	}
+	while (fgets(c_Line, sizeof(c_Line), pst_File) != NULL) {
+		u32_LineNo++;
+		pc_Pos = c_Line;
+		while ((*pc_Pos == ' ') || (*pc_Pos == '\t')) {
+			pc_Pos++;
+		}
+		if ((*pc_Pos == '\0') || (*pc_Pos == '\r') || (*pc_Pos == '\n') || (*pc_Pos == '#')) {
+			continue;
+		}
+
+		/* ---- 時刻 ---- */
+		if ((*pc_Pos != '@') && (*pc_Pos != '+')) {
+			goto error;
+		}
+		db_Ms = strtod(pc_Pos + 1, &pc_End);
+		if ((pc_End == (pc_Pos + 1)) || (db_Ms < 0.0)) {
+			goto error;
+		}
+		u64_Time = ((*pc_Pos == '@') ? 0 : u64_Time) + (uint64_t)(db_Ms * 1000000.0);
+		pc_Pos = pc_End;
+
+		/* ---- データ ---- */
+		while ((*pc_Pos == ' ') || (*pc_Pos == '\t')) {
+			pc_Pos++;
+		}
+		if (*pc_Pos++ != '"') {
+			goto error;
+		}
+		psts_Script = realloc(psts_Script, (u32s_ScriptNum + 1) * sizeof(SimScript));
+		pu8s_ScriptData = realloc(pu8s_ScriptData, u32_DataSize + SIM_SCRIPT_LINE);
+		if ((psts_Script == NULL) || (pu8s_ScriptData == NULL)) {
+			perror("realloc");
+			exit(1);
+		}
+		pst_Entry = &psts_Script[u32s_ScriptNum];
+		pst_Entry->u64_time = u64_Time;
+		pst_Entry->u32_offset = u32_DataSize;
+		pst_Entry->u32_repeat = 1;
+		while (*pc_Pos != '"') {
+			if ((*pc_Pos == '\0') || (*pc_Pos == '\n')) {
+				goto error;
+			}
+			if (*pc_Pos != '\\') {
+				pu8s_ScriptData[u32_DataSize++] = (uint8_t)*pc_Pos++;
+				continue;
+			}
+			pc_Pos++;
+			switch (*pc_Pos) {
+			case 'n':  pu8s_ScriptData[u32_DataSize++] = '\n'; pc_Pos++; break;
+			case 'r':  pu8s_ScriptData[u32_DataSize++] = '\r'; pc_Pos++; break;
+			case 't':  pu8s_ScriptData[u32_DataSize++] = '\t'; pc_Pos++; break;
+			case '0':  pu8s_ScriptData[u32_DataSize++] = 0x00; pc_Pos++; break;
+			case '\\': pu8s_ScriptData[u32_DataSize++] = '\\'; pc_Pos++; break;
+			case '"':  pu8s_ScriptData[u32_DataSize++] = '"'; pc_Pos++; break;
+			case 'x':
+				u32_Value = strtoul(pc_Pos + 1, &pc_End, 16);
+				if ((pc_End == (pc_Pos + 1)) || (pc_End > (pc_Pos + 3))) {
+					goto error;
+				}
+				pu8s_ScriptData[u32_DataSize++] = (uint8_t)u32_Value;
+				pc_Pos = pc_End;
+				break;
+			default:
+				goto error;
+			}
+		}
+		pc_Pos++;
+		pst_Entry->u32_length = u32_DataSize - pst_Entry->u32_offset;
+
+		/* ---- 繰り返し回数 ---- */
+		while ((*pc_Pos == ' ') || (*pc_Pos == '\t')) {
+			pc_Pos++;
+		}
+		if (*pc_Pos == '*') {
+			u32_Value = strtoul(pc_Pos + 1, &pc_End, 0);
+			if ((pc_End == (pc_Pos + 1)) || (u32_Value == 0)) {
+				goto error;
+			}
+			pst_Entry->u32_repeat = (uint32_t)u32_Value;
+			pc_Pos = pc_End;
+		}
+		while ((*pc_Pos == ' ') || (*pc_Pos == '\t') || (*pc_Pos == '\r') || (*pc_Pos == '\n')) {
+			pc_Pos++;
+		}
+		if ((*pc_Pos != '\0') && (*pc_Pos != '#')) {
+			goto error;
+		}
+		if (pst_Entry->u32_length > 0) {
+			u32s_ScriptNum++;
+		}
+	}
+	fclose(pst_File);
+	if (u32s_ScriptNum == 0) {
+		bls_RxEof = true;
+	}
+	return;
+
+error:
+	fprintf(stderr, "%s:%u: syntax error\n", pc_Path, u32_LineNo);
+	exit(1);
+}
+
+/**
+  * @brief  入力スクリプトの時間経過処理(受信キューに積む)
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   sim_lock()の取得中に呼ぶこと。キューが満杯なら空いてから続ける。
+  *         受信キューが空の時は送信開始から1文字分の時間で受信させる。
+  */
+void sim_script_update(uint64_t u64_Now)
+{
+	SimScript *pst_Entry;
+	uint64_t u64_Total;
+
+	while ((u32s_ScriptIndex < u32s_ScriptNum) && (psts_Script[u32s_ScriptIndex].u64_time <= u64_Now)) {
+		pst_Entry = &psts_Script[u32s_ScriptIndex];
+		u64_Total = (uint64_t)pst_Entry->u32_length * pst_Entry->u32_repeat;
+		if ((u32s_RxHead == u32s_RxTail) && (u64s_SciRxNext < (pst_Entry->u64_time + u64s_SciByteTime))) {
+			u64s_SciRxNext = pst_Entry->u64_time + u64s_SciByteTime;
+		}
+		while (u64s_ScriptPos < u64_Total) {
+			if (((u32s_RxHead + 1) % SIM_RXQ_SIZE) == u32s_RxTail) {
+				return;
+			}
+			u8s_RxQueue[u32s_RxHead] = pu8s_ScriptData[pst_Entry->u32_offset + (u64s_ScriptPos % pst_Entry->u32_length)];
+			u32s_RxHead = (u32s_RxHead + 1) % SIM_RXQ_SIZE;
+			u64s_ScriptPos++;
+		}
+		u64s_ScriptPos = 0;
+		u32s_ScriptIndex++;
+		if (u32s_ScriptIndex == u32s_ScriptNum) {
+			bls_RxEof = true;
+		}
+	}
+}
+
+/**
+  * @brief  送信ログに1文字追加する
+  * @param  u8_Data: 送信データ
+  * @param  u64_Time: 送信完了の仮想時刻[ns]
+  * @retval None
+  * @note   行頭に先頭文字の時刻[s]を付け、LFで1行を出力する。CRは除き、
+  *         制御文字は\xHHで記録する。
+  */
+static void sim_txlog_put(uint8_t u8_Data, uint64_t u64_Time)
+{
+	if (i32s_TxLogFd < 0) {
+		return;
+	}
+	if (u32s_TxLogLen == 0) {
+		u32s_TxLogLen = (uint32_t)snprintf(cs_TxLogLine, sizeof(cs_TxLogLine), "[%6llu.%06llu] ",
+			(unsigned long long)(u64_Time / SIM_NS_PER_SEC), (unsigned long long)((u64_Time % SIM_NS_PER_SEC) / 1000));
+	}
+	if (u8_Data == '\r') {
+		return;
+	}
+	if (u8_Data == '\n') {
+		sim_txlog_flush();
+		return;
+	}
+	if ((u8_Data < 0x20) || (u8_Data == 0x7F)) {
+		u32s_TxLogLen += (uint32_t)snprintf(&cs_TxLogLine[u32s_TxLogLen], sizeof(cs_TxLogLine) - u32s_TxLogLen, "\\x%02X", u8_Data);
+	}
+	else {
+		cs_TxLogLine[u32s_TxLogLen++] = (char)u8_Data;
+	}
+	if (u32s_TxLogLen >= SIM_TXLOG_LINE) {
+		sim_txlog_flush();
+	}
+}
+
+/**
+  * @brief  送信ログの作成中の行を出力する
+  * @param  None
+  * @retval None
+  */
+static void sim_txlog_flush(void)
+{
+	if ((i32s_TxLogFd < 0) || (u32s_TxLogLen == 0)) {
+		return;
+	}
+	cs_TxLogLine[u32s_TxLogLen++] = '\n';
+	(void)!write(i32s_TxLogFd, cs_TxLogLine, u32s_TxLogLen);
+	u32s_TxLogLen = 0;
+}
+
+/**
+  * @brief  入力スレッド(受信データをキューに積む)
+  * @param  pv_Arg: 未使用
+  * @retval None
+  */
+static void *sim_input_thread(void *pv_Arg)
+{
+	uint8_t u8_Buffer[256];
+	ssize_t i32_Len;
+	ssize_t _i;
+	struct timespec st_Wait = {0, SIM_TIMER_MAX};
+
+	(void)pv_Arg;
+	for (;;) {
+		i32_Len = read(i32s_InFd, u8_Buffer, sizeof(u8_Buffer));
+		if (i32_Len <= 0) {
+			if ((i32_Len < 0) && (errno == EINTR)) {
+				continue;
+			}
+			break;
+		}
+		for (_i=0; _i<i32_Len; _i++) {
+			/* キューが満杯の場合は空くまで待つ */
+			for (;;) {
+				sim_lock();
+				if (((u32s_RxHead + 1) % SIM_RXQ_SIZE) != u32s_RxTail) {
+					u8s_RxQueue[u32s_RxHead] = u8_Buffer[_i];
+					u32s_RxHead = (u32s_RxHead + 1) % SIM_RXQ_SIZE;
+					sim_unlock();
+					break;
+				}
+				sim_unlock();
+				nanosleep(&st_Wait, NULL);
+			}
+		}
+	}
+	sim_lock();
+	bls_RxEof = true;
+	sim_unlock();
+	return NULL;
+}
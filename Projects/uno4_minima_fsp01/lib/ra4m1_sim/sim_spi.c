@@ -0,0 +1,430 @@
+/**
+  ******************************************************************************
+  * @file           : sim_spi.c
+  * @brief          : RA4M1レジスタモデル RSPI0
+  ******************************************************************************
+  * @note   RSPI0はマスター動作をフレーム単位(データ長+1クロック)の時間で模擬し、
+  *         DTCが書き込んだ次のフレームは前のフレームの完了時刻から続ける。
+  *         MISOは未接続(全bit 1)で、SPPCRのループバックでは送信データを受信する。
+  *         ループバック以外でRSPCKA(P111)/MOSIA(P109)が周辺機能に割り当てられて
+  *         いない間に開始したフレームは端子に出ないため、数えて終了時に出力する。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim_local.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* SPI0 */
+#define SPI_SPCR_SPRIE		(0x80)
+#define SPI_SPCR_SPE		(0x40)
+#define SPI_SPCR_SPTIE		(0x20)
+#define SPI_SPCR_SPEIE		(0x10)
+#define SPI_SPCR_TXMD		(0x02)
+#define SPI_SPPCR_SPLP2		(0x02)				/* ループバック(非反転)				*/
+#define SPI_SPPCR_SPLP		(0x01)				/* ループバック(反転)				*/
+#define SPI_SPSR_SPRF		(0x80)
+#define SPI_SPSR_SPTEF		(0x20)
+#define SPI_SPSR_IDLNF		(0x02)
+#define SPI_SPSR_OVRF		(0x01)
+#define SPI_SPSR_ERRORS		(0x1D)				/* 0書き込みで解除するフラグ(ERI要因)	*/
+#define SPI_SPCR2_SCKASE	(0x10)
+#define SPI_SPCR2_SPIIE		(0x04)
+#define SPI_PFS_PSEL		(0x06)				/* PmnPFS.PSEL(SPI)					*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* SPI0(u8s_Lockで排他) */
+static uint8_t u8s_SpiSpcr;							/* SPCR								*/
+static uint8_t u8s_SpiSpsr = SPI_SPSR_SPTEF;		/* SPSR								*/
+static uint8_t u8s_SpiCr2;							/* SPCR2							*/
+static uint32_t u32s_SpiTxData;						/* 送信バッファ						*/
+static bool bls_SpiTxFull;							/* 送信バッファにデータがある		*/
+static uint32_t u32s_SpiShift;						/* 送信中のデータ					*/
+static bool bls_SpiShifting;						/* フレームの転送中					*/
+static uint32_t u32s_SpiRxData;						/* 受信バッファ						*/
+static uint64_t u64s_SpiFrameEnd;					/* フレームの完了時刻[ns](0:無し)	*/
+static uint64_t u64s_SpiTime;						/* 処理中のフレームの完了時刻[ns]	*/
+static bool bls_SpiUpdating;						/* 時間経過の処理中					*/
+static uint8_t u8s_SpiRaise;						/* 発生させる割り込み要因			*/
+static bool bls_SpiFlushing;						/* 割り込み要因の発生中				*/
+static uint64_t u64s_SpiFrames;
+static uint64_t u64s_SpiBytes;
+static uint64_t u64s_SpiOverrun;
+static uint64_t u64s_SpiNoPin;						/* 端子未割り当てで開始したフレーム数	*/
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t sim_spi_bits(void);
+static uint64_t sim_spi_frame_time(void);
+static void sim_spi_event(uint64_t u64_Time);
+static void sim_spi_kick(uint64_t u64_Now);
+static void sim_spi_reset(void);
+static void sim_spi_sync(void);
+static uint8_t sim_spi_enabled(uint8_t u8_Spcr, uint8_t u8_Cr2);
+static uint8_t sim_spi_status(void);
+static void sim_spi_raise(uint8_t u8_Flags);
+static void sim_spi_flush(void);
+static bool sim_spi_pin_ok(uint8_t u8_Port, uint8_t u8_Pin);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  RSPI0のフレーム長
+  * @param  None
+  * @retval データ長[bit](SPCMD0.SPB)
+  */
+static uint32_t sim_spi_bits(void)
+{
+	uint32_t u32_Spb = (g_sim_hw->spi[0].SPCMD0 >> 8) & 0xF;
+
+	if (u32_Spb >= 8) {
+		return u32_Spb + 1;
+	}
+	if (u32_Spb >= 4) {
+		return 8;
+	}
+	return (u32_Spb == 0) ? 20 : ((u32_Spb == 1) ? 24 : 32);
+}
+
+/**
+  * @brief  RSPI0の1フレームの時間
+  * @param  None
+  * @retval 時間[ns]
+  * @note   (データ長 + 次アクセス遅延1RSPCK) × 2(SPBR+1)×2^BRDV / PCLKA
+  */
+static uint64_t sim_spi_frame_time(void)
+{
+	const R_SPI0_Type *pst_Spi = &g_sim_hw->spi[0];
+	uint64_t u64_Counts = (uint64_t)(sim_spi_bits() + 1) * 2 * ((uint64_t)pst_Spi->SPBR + 1);
+
+	u64_Counts <<= (pst_Spi->SPCMD0 >> 2) & 0x3;
+	return (u64_Counts * SIM_NS_PER_SEC) / R_FSP_SystemClockHzGet(FSP_PRIV_CLOCK_PCLKA);
+}
+
+/**
+  * @brief  RSPI0レジスタのアクセス
+  * @param  u32_Member: R_SPI0_Type内のオフセット
+  * @param  bl_Write: 書き込みアクセス
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   SPSRのエラーフラグは0の書き込みでだけ解除でき、SPTEF/SPRF/IDLNFは
+  *         書き込んでもモデルの値に戻す
+  */
+void sim_spi_access(size_t u32_Member, bool bl_Write, uint64_t u64_Now)
+{
+	/* 書き込み値はモデルの反映(sim_spi_sync)で上書きされる前に取り出す */
+	uint32_t u32_Data = g_sim_hw->spi[0].SPDR;
+	uint8_t u8_Data = ((const volatile uint8_t *)&g_sim_hw->spi[0])[u32_Member];
+	uint8_t u8_Enable;
+	uint64_t u64_Time;
+
+	sim_spi_update(u64_Now);
+	/* DTCがフレームの完了で転送した場合はその時刻から続ける */
+	u64_Time = bls_SpiUpdating ? u64s_SpiTime : u64_Now;
+	if (bl_Write) {
+		switch (u32_Member) {
+		case offsetof(R_SPI0_Type, SPCR):
+			if (!(u8_Data & SPI_SPCR_SPE)) {
+				sim_spi_reset();
+			}
+			/* 許可した時点で立っている要因は割り込みにする */
+			u8_Enable = (u8s_SpiSpcr & SPI_SPCR_SPE) ? u8s_SpiSpcr : 0x00;
+			u8s_SpiSpcr = u8_Data;
+			if (u8_Data & SPI_SPCR_SPE) {
+				sim_spi_raise(sim_spi_status() & (uint8_t)~sim_spi_enabled(u8_Enable, u8s_SpiCr2));
+			}
+			break;
+		case offsetof(R_SPI0_Type, SPSR):
+			u8s_SpiSpsr &= (uint8_t)(u8_Data | ~SPI_SPSR_ERRORS);
+			break;
+		case offsetof(R_SPI0_Type, SPCR2):
+			sim_spi_raise(sim_spi_status() & (uint8_t)~sim_spi_enabled(u8s_SpiSpcr, u8s_SpiCr2));
+			u8s_SpiCr2 = u8_Data;
+			break;
+		case offsetof(R_SPI0_Type, SPDR):
+			if (u8s_SpiSpcr & SPI_SPCR_SPE) {
+				u32s_SpiTxData = u32_Data;
+				bls_SpiTxFull = true;
+				u8s_SpiSpsr &= (uint8_t)~SPI_SPSR_SPTEF;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+	else if (u32_Member == offsetof(R_SPI0_Type, SPDR)) {
+		u8s_SpiSpsr &= (uint8_t)~SPI_SPSR_SPRF;
+	}
+	sim_spi_kick(u64_Time);
+	sim_spi_sync();
+	sim_spi_flush();
+}
+
+/**
+  * @brief  RSPI0の時間経過処理
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   フレーム毎に割り込み要因(DTC転送)を処理し、DTCが書き込んだ次の
+  *         フレームを前のフレームの完了時刻から開始する
+  */
+void sim_spi_update(uint64_t u64_Now)
+{
+	if (bls_SpiUpdating) {
+		return;
+	}
+	bls_SpiUpdating = true;
+	while ((u64s_SpiFrameEnd != 0) && (u64_Now >= u64s_SpiFrameEnd)) {
+		u64s_SpiTime = u64s_SpiFrameEnd;
+		u64s_SpiFrameEnd = 0;
+		sim_spi_event(u64s_SpiTime);
+		sim_spi_sync();
+		sim_spi_flush();
+	}
+	bls_SpiUpdating = false;
+	sim_spi_sync();
+}
+
+/**
+  * @brief  RSPI0のフレームの完了
+  * @param  u64_Time: 完了時刻[ns]
+  * @retval None
+  */
+static void sim_spi_event(uint64_t u64_Time)
+{
+	uint8_t u8_Loop = g_sim_hw->spi[0].SPPCR;
+	uint32_t u32_Bits = sim_spi_bits();
+	uint32_t u32_Mask = (u32_Bits >= 32) ? 0xFFFFFFFFUL : ((1UL << u32_Bits) - 1);
+
+	bls_SpiShifting = false;
+	u64s_SpiFrames++;
+	u64s_SpiBytes += (u32_Bits + 7) / 8;
+	if (!(u8s_SpiSpcr & SPI_SPCR_TXMD)) {
+		if (u8s_SpiSpsr & SPI_SPSR_SPRF) {
+			/* 前のデータが読まれていない */
+			u64s_SpiOverrun++;
+			u8s_SpiSpsr |= SPI_SPSR_OVRF;
+			sim_spi_raise(SPI_SPSR_OVRF);
+		}
+		else {
+			/* MISOは未接続(プルアップ相当),ループバックは送信データ(SPLPは反転) */
+			if (u8_Loop & SPI_SPPCR_SPLP2) {
+				u32s_SpiRxData = u32s_SpiShift;
+			}
+			else if (u8_Loop & SPI_SPPCR_SPLP) {
+				u32s_SpiRxData = ~u32s_SpiShift & u32_Mask;
+			}
+			else {
+				u32s_SpiRxData = u32_Mask;
+			}
+			u8s_SpiSpsr |= SPI_SPSR_SPRF;
+			sim_spi_raise(SPI_SPSR_SPRF);
+		}
+	}
+	sim_spi_kick(u64_Time);
+}
+
+/**
+  * @brief  送信バッファのデータをシフトレジスタに移して次のフレームを開始する
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   SCKASE=1で受信バッファがフルの間は開始しない。送信するデータが
+  *         無ければアイドル(IDLNF=0)になる
+  */
+static void sim_spi_kick(uint64_t u64_Now)
+{
+	uint32_t u32_Bits;
+
+	if (!(u8s_SpiSpcr & SPI_SPCR_SPE) || bls_SpiShifting) {
+		return;
+	}
+	if (!bls_SpiTxFull) {
+		if (u8s_SpiSpsr & SPI_SPSR_IDLNF) {
+			u8s_SpiSpsr &= (uint8_t)~SPI_SPSR_IDLNF;
+			sim_spi_raise(SPI_SPSR_IDLNF);
+		}
+		return;
+	}
+	if ((u8s_SpiCr2 & SPI_SPCR2_SCKASE) && !(u8s_SpiSpcr & SPI_SPCR_TXMD) && (u8s_SpiSpsr & SPI_SPSR_SPRF)) {
+		return;
+	}
+	u32_Bits = sim_spi_bits();
+	u32s_SpiShift = u32s_SpiTxData & ((u32_Bits >= 32) ? 0xFFFFFFFFUL : ((1UL << u32_Bits) - 1));
+	bls_SpiTxFull = false;
+	bls_SpiShifting = true;
+	if (!(g_sim_hw->spi[0].SPPCR & (SPI_SPPCR_SPLP2 | SPI_SPPCR_SPLP))
+	 && (!sim_spi_pin_ok(1, 11) || !sim_spi_pin_ok(1, 9))) {
+		u64s_SpiNoPin++;
+	}
+	u8s_SpiSpsr |= SPI_SPSR_SPTEF | SPI_SPSR_IDLNF;
+	sim_spi_raise(SPI_SPSR_SPTEF);
+	u64s_SpiFrameEnd = u64_Now + sim_spi_frame_time();
+}
+
+/**
+  * @brief  RSPI0の停止(SPCR.SPE=0)
+  * @param  None
+  * @retval None
+  * @note   送受信バッファとシフトレジスタを初期化する。エラーフラグは保持する
+  */
+static void sim_spi_reset(void)
+{
+	bls_SpiTxFull = false;
+	bls_SpiShifting = false;
+	u64s_SpiFrameEnd = 0;
+	u8s_SpiRaise = 0;
+	u8s_SpiSpsr = (uint8_t)((u8s_SpiSpsr & SPI_SPSR_ERRORS) | SPI_SPSR_SPTEF);
+}
+
+/**
+  * @brief  モデルの値をレジスタに反映する
+  * @param  None
+  * @retval None
+  */
+static void sim_spi_sync(void)
+{
+	R_SPI0_Type *pst_Spi = &g_sim_hw->spi[0];
+
+	pst_Spi->SPCR = u8s_SpiSpcr;
+	pst_Spi->SPSR = u8s_SpiSpsr;
+	pst_Spi->SPCR2 = u8s_SpiCr2;
+	pst_Spi->SPDR = u32s_SpiRxData;
+}
+
+/**
+  * @brief  許可している割り込み要因
+  * @param  u8_Spcr: SPCR
+  * @param  u8_Cr2: SPCR2
+  * @retval sim_spi_status()のbit(IDLNFはアイドル割り込み(TEI))
+  */
+static uint8_t sim_spi_enabled(uint8_t u8_Spcr, uint8_t u8_Cr2)
+{
+	uint8_t u8_Enable = 0;
+
+	if (!(u8_Spcr & SPI_SPCR_SPE)) {
+		return 0;
+	}
+	if (u8_Spcr & SPI_SPCR_SPTIE) {
+		u8_Enable |= SPI_SPSR_SPTEF;
+	}
+	if (u8_Spcr & SPI_SPCR_SPRIE) {
+		u8_Enable |= SPI_SPSR_SPRF;
+	}
+	if (u8_Spcr & SPI_SPCR_SPEIE) {
+		u8_Enable |= SPI_SPSR_ERRORS;
+	}
+	if (u8_Cr2 & SPI_SPCR2_SPIIE) {
+		u8_Enable |= SPI_SPSR_IDLNF;
+	}
+	return u8_Enable;
+}
+
+/**
+  * @brief  現在立っている割り込み要因
+  * @param  None
+  * @retval SPSRのbit(IDLNFはアイドル(IDLNF=0)を表す)
+  */
+static uint8_t sim_spi_status(void)
+{
+	return (uint8_t)(u8s_SpiSpsr ^ SPI_SPSR_IDLNF);
+}
+
+/**
+  * @brief  割り込み要因を記録する
+  * @param  u8_Flags: 発生した要因(sim_spi_status()のbit)
+  * @retval None
+  * @note   許可している要因だけをsim_spi_flush()で発生させる
+  */
+static void sim_spi_raise(uint8_t u8_Flags)
+{
+	u8s_SpiRaise |= u8_Flags;
+}
+
+/**
+  * @brief  記録した割り込み要因を発生させる
+  * @param  None
+  * @retval None
+  * @note   DTCの転送で再びRSPI0のレジスタをアクセスするため、モデルの更新が
+  *         済んでから発生させる。DTC転送で発生した要因も続けて処理する
+  */
+static void sim_spi_flush(void)
+{
+	uint8_t u8_Raise;
+
+	if (bls_SpiFlushing) {
+		return;
+	}
+	bls_SpiFlushing = true;
+	while ((u8_Raise = (uint8_t)(u8s_SpiRaise & sim_spi_enabled(u8s_SpiSpcr, u8s_SpiCr2))) != 0) {
+		u8s_SpiRaise = 0;
+		if (u8_Raise & SPI_SPSR_SPTEF) {
+			simRaiseEvent(ELC_EVENT_SPI0_TXI);
+		}
+		if (u8_Raise & SPI_SPSR_SPRF) {
+			simRaiseEvent(ELC_EVENT_SPI0_RXI);
+		}
+		if (u8_Raise & SPI_SPSR_IDLNF) {
+			simRaiseEvent(ELC_EVENT_SPI0_TEI);
+		}
+		if (u8_Raise & SPI_SPSR_ERRORS) {
+			simRaiseEvent(ELC_EVENT_SPI0_ERI);
+		}
+	}
+	u8s_SpiRaise = 0;
+	bls_SpiFlushing = false;
+}
+
+/**
+  * @brief  端子がRSPI0に割り当てられているかを判定する
+  * @param  u8_Port: ポート番号
+  * @param  u8_Pin: 端子番号
+  * @retval true:周辺機能(PMR=1)でPSELがSPI
+  */
+static bool sim_spi_pin_ok(uint8_t u8_Port, uint8_t u8_Pin)
+{
+	const R_PFS_PIN_Type *pst_Pin = &g_sim_pfs.PORT[u8_Port].PIN[u8_Pin];
+
+	return (pst_Pin->PmnPFS_b.PMR == 1) && (pst_Pin->PmnPFS_b.PSEL == SPI_PFS_PSEL);
+}
+
+/**
+  * @brief  SPI0のレジスタ初期値を設定する
+  * @param  None
+  * @retval None
+  */
+void sim_spi_init(void)
+{
+	g_sim_hw->spi[0].SPBR = 0xFF;
+	g_sim_hw->spi[0].SPCMD0 = 0x070D;
+	sim_spi_sync();
+}
+
+/**
+  * @brief  SPI0の次のイベント時刻を反映する
+  * @param  pu64_Next: 次のイベント時刻[ns](より早ければ更新する)
+  * @retval None
+  */
+void sim_spi_schedule(uint64_t *pu64_Next)
+{
+	if ((u64s_SpiFrameEnd != 0) && (u64s_SpiFrameEnd < *pu64_Next)) {
+		*pu64_Next = u64s_SpiFrameEnd;
+	}
+}
+
+/**
+  * @brief  SPI0の統計を出力する
+  * @param  None
+  * @retval None
+  */
+void sim_spi_report(void)
+{
+	if (u64s_SpiFrames > 0) {
+		fprintf(stderr, "[sim] SPI0 frames %llu, bytes %llu, overrun %llu, no pin %llu\n",
+			(unsigned long long)u64s_SpiFrames, (unsigned long long)u64s_SpiBytes, (unsigned long long)u64s_SpiOverrun,
+			(unsigned long long)u64s_SpiNoPin);
+	}
+}
@@ -0,0 +1,960 @@
+/**
+  ******************************************************************************
+  * @file           : sim_usb.c
+  * @brief          : RA4M1レジスタモデル USBFS
+  ******************************************************************************
+  * @note   USBFSはCFIFOとDCP/パイプ1～9のバッファ(ダブルバッファ)を模擬し、
+  *         接続(SYSCFG.DPRPU)すると模擬ホストがバスリセット,列挙(ディスクリプタの
+  *         確認を含む),SET_CONFIGURATION,SET_LINE_CODINGを行う。列挙後は
+  *         バルクIN/OUTを疑似端末(/dev/pts/N)に中継し、疑似端末を開くとDTRを送る。
+  *         ホストは1フレーム(1ms)に19パケットまで転送する。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim_local.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* USBパイプのバッファ */
+typedef struct {
+	uint8_t u8_data[2][64];						/* バッファ(面毎)					*/
+	uint16_t u16_len[2];						/* 確定したデータ長(面毎)			*/
+	uint8_t u8_first;							/* 最も古い確定済みの面				*/
+	uint8_t u8_fill;							/* 確定済みの面数					*/
+	uint16_t u16_pos;							/* CPUのアクセス位置				*/
+	uint16_t u16_cfg;							/* PIPECFG							*/
+	uint16_t u16_maxp;							/* PIPEMAXP							*/
+} SimUsbPipe;
+
+/* 模擬ホストのコントロール転送 */
+typedef struct {
+	uint8_t u8_type;							/* bmRequestType					*/
+	uint8_t u8_request;							/* bRequest							*/
+	uint16_t u16_value;							/* wValue							*/
+	uint16_t u16_index;							/* wIndex							*/
+	uint16_t u16_length;						/* wLength							*/
+	const uint8_t *pu8_data;					/* 送信データ(コントロールライト)	*/
+	uint8_t u8_check;							/* 応答の確認(SIM_USB_CHECK_xxx)	*/
+} SimUsbRequest;
+
+/* Private define ------------------------------------------------------------*/
+
+/* USBFS */
+#define SIM_USB_PIPE_NUM	(10)				/* DCP+パイプ1～9					*/
+#define SIM_USB_PACKET		(64)				/* バッファサイズ[byte]				*/
+#define SIM_USB_SLOT		(SIM_NS_PER_SEC / 1000 / 19)	/* 1パケットの転送周期[ns]	*/
+#define SIM_USB_ATTACH		(10000000)			/* 接続からバスリセットまで[ns]		*/
+#define SIM_USB_RESET		(1000000)			/* バスリセットから列挙開始まで[ns]	*/
+#define SIM_USB_HOST_BUFF	(256)				/* ホストの受信バッファ[byte]		*/
+#define SIM_USB_SCRIPT_NUM	(sizeof(sts_UsbScript) / sizeof(sts_UsbScript[0]))
+#define SIM_USB_CHECK_NONE	(0)
+#define SIM_USB_CHECK_DEVICE	(1)				/* デバイスディスクリプタ			*/
+#define SIM_USB_CHECK_CONFIG	(2)				/* コンフィグレーションディスクリプタ	*/
+#define SIM_USB_CHECK_STRING	(3)				/* 文字列ディスクリプタ(製品名)		*/
+#define SIM_USB_CHECK_STALL	(4)					/* STALL応答を期待する				*/
+#define SIM_USBH_IDLE		(0)					/* ホスト: 転送なし					*/
+#define SIM_USBH_DATA_IN	(1)					/* ホスト: データステージ(IN)		*/
+#define SIM_USBH_DATA_OUT	(2)					/* ホスト: データステージ(OUT)		*/
+#define SIM_USBH_STATUS		(3)					/* ホスト: ステータスステージ		*/
+#define USB_SYSCFG_USBE		(0x0001)
+#define USB_SYSCFG_DPRPU	(0x0010)
+#define USB_CFIFOSEL_CURPIPE	(0x000F)
+#define USB_CFIFOSEL_ISEL	(0x0020)
+#define USB_CFIFOSEL_MBW	(0x0400)
+#define USB_CFIFOCTR_FRDY	(0x2000)
+#define USB_CFIFOCTR_BCLR	(0x4000)
+#define USB_CFIFOCTR_BVAL	(0x8000)
+#define USB_INTSTS0_VALID	(0x0008)
+#define USB_INTSTS0_BRDY	(0x0100)
+#define USB_INTSTS0_BEMP	(0x0400)
+#define USB_INTSTS0_CTRT	(0x0800)
+#define USB_INTSTS0_DVST	(0x1000)
+#define USB_INTSTS0_W0C		(USB_INTSTS0_VALID | USB_INTSTS0_CTRT | USB_INTSTS0_DVST)
+#define USB_INTSTS0_IRQ		(USB_INTSTS0_BRDY | USB_INTSTS0_BEMP | USB_INTSTS0_CTRT | USB_INTSTS0_DVST)
+#define USB_DVSQ_DEFAULT	(0x0010)
+#define USB_DVSQ_ADDRESS	(0x0020)
+#define USB_DVSQ_CONFIGURED	(0x0030)
+#define USB_CTSQ_IDST		(0)
+#define USB_CTSQ_RDDS		(1)
+#define USB_CTSQ_RDSS		(2)
+#define USB_CTSQ_WRDS		(3)
+#define USB_CTSQ_WRSS		(4)
+#define USB_CTSQ_WRND		(5)
+#define USB_PID_MASK		(0x0003)
+#define USB_PID_BUF			(0x0001)
+#define USB_PID_STALL		(0x0002)
+#define USB_DCPCTR_CCPL		(0x0004)
+#define USB_PIPECTR_ACLRM	(0x0200)
+#define USB_PIPECTR_BSTS	(0x8000)
+#define USB_PIPECFG_EPNUM	(0x000F)
+#define USB_PIPECFG_DIR		(0x0010)
+#define USB_PIPECFG_DBLB	(0x0200)
+#define USB_PIPECFG_TYPE	(0xC000)
+#define USB_REQ_SET_ADDRESS	(0x05)
+#define USB_REQ_SET_CONFIGURATION	(0x09)
+#define USB_REQ_SET_CONTROL_LINE_STATE	(0x22)
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* USBFS(u8s_Lockで排他) */
+static SimUsbPipe sts_UsbPipe[SIM_USB_PIPE_NUM];
+static uint16_t u16s_UsbIntSts;						/* INTSTS0(DVST/CTRT/VALID)			*/
+static uint16_t u16s_UsbBrdySts;
+static uint16_t u16s_UsbBempSts;
+static uint16_t u16s_UsbDvsq;						/* デバイスステート(0:未接続)		*/
+static uint16_t u16s_UsbCtsq;						/* コントロール転送ステージ			*/
+static bool bls_UsbIrqLevel;						/* USBFS_INTの要求					*/
+static bool bls_UsbAttached;						/* 接続中(D+プルアップ)				*/
+static uint64_t u64s_UsbResetTime;					/* バスリセットの時刻[ns](0:無し)	*/
+static uint64_t u64s_UsbSlotNext;					/* 次の転送の時刻[ns]				*/
+static uint64_t u64s_UsbHostNext;					/* 列挙開始の時刻[ns]				*/
+static uint8_t u8s_UsbHostState;					/* 模擬ホストの状態(SIM_USBH_xxx)	*/
+static uint8_t u8s_UsbHostStep;						/* 列挙の実行位置					*/
+static uint8_t u8s_UsbHostLine;						/* 送信済みのDTR/RTS				*/
+static SimUsbRequest sts_UsbHostReq;				/* 実行中のリクエスト				*/
+static uint8_t u8s_UsbHostData[SIM_USB_HOST_BUFF];	/* 受信データ(コントロールリード)	*/
+static uint16_t u16s_UsbHostLen;					/* 転送済みのデータ長				*/
+static bool bls_UsbEnumerated;						/* 列挙完了							*/
+static bool bls_UsbEnumFailed;						/* 列挙失敗							*/
+static uint16_t u16s_UsbVid;
+static uint16_t u16s_UsbPid;
+static uint8_t u8s_UsbEpIn;							/* バルクINエンドポイント			*/
+static uint8_t u8s_UsbEpOut;						/* バルクOUTエンドポイント			*/
+static uint8_t u8s_UsbEpNotify;						/* 通知エンドポイント				*/
+static uint16_t u16s_UsbEpSize;
+static char cs_UsbProduct[48];
+static int i32s_UsbPty = -1;						/* 疑似端末(マスター)				*/
+static char cs_UsbPtyName[64];
+static bool bls_UsbPtyOpen;							/* 疑似端末のスレーブ側が開いている	*/
+static bool bls_UsbOutReady;						/* 疑似端末に入力がある				*/
+static uint8_t u8s_UsbInPending[SIM_USB_PACKET];	/* 疑似端末へ書き込めなかったデータ	*/
+static uint16_t u16s_UsbInLen;
+static uint16_t u16s_UsbInPos;
+static uint64_t u64s_UsbOutBytes;
+static uint64_t u64s_UsbInBytes;
+static uint64_t u64s_UsbNak;
+static uint64_t u64s_UsbSetups;
+
+/* 模擬ホストの列挙手順(Linuxのusbcore/cdc-acmに準じる) */
+static const uint8_t u8s_UsbLineCoding[7] = {0x00, 0xC2, 0x01, 0x00, 0x00, 0x00, 0x08};	/* 115200bps 8N1	*/
+static const SimUsbRequest sts_UsbScript[] = {
+	{0x80, 0x06, 0x0100, 0x0000, 64, NULL, SIM_USB_CHECK_NONE},			/* GET_DESCRIPTOR(デバイス,先頭)	*/
+	{0x00, 0x05, 0x0005, 0x0000, 0, NULL, SIM_USB_CHECK_NONE},			/* SET_ADDRESS					*/
+	{0x80, 0x06, 0x0100, 0x0000, 18, NULL, SIM_USB_CHECK_DEVICE},		/* GET_DESCRIPTOR(デバイス)		*/
+	{0x80, 0x06, 0x0200, 0x0000, 9, NULL, SIM_USB_CHECK_NONE},			/* GET_DESCRIPTOR(コンフィグ,先頭)	*/
+	{0x80, 0x06, 0x0200, 0x0000, 255, NULL, SIM_USB_CHECK_CONFIG},		/* GET_DESCRIPTOR(コンフィグ)	*/
+	{0x80, 0x06, 0x0300, 0x0000, 255, NULL, SIM_USB_CHECK_NONE},		/* GET_DESCRIPTOR(言語ID)		*/
+	{0x80, 0x06, 0x0302, 0x0409, 255, NULL, SIM_USB_CHECK_STRING},		/* GET_DESCRIPTOR(製品名)		*/
+	{0x80, 0x06, 0x0600, 0x0000, 10, NULL, SIM_USB_CHECK_STALL},		/* GET_DESCRIPTOR(デバイスクオリファイア)	*/
+	{0x00, 0x09, 0x0001, 0x0000, 0, NULL, SIM_USB_CHECK_NONE},			/* SET_CONFIGURATION			*/
+	{0xA1, 0x21, 0x0000, 0x0000, 7, NULL, SIM_USB_CHECK_NONE},			/* GET_LINE_CODING				*/
+	{0x21, 0x20, 0x0000, 0x0000, 7, u8s_UsbLineCoding, SIM_USB_CHECK_NONE},	/* SET_LINE_CODING			*/
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static uint16_t sim_usb_intsts(void);
+static void sim_usb_irq(void);
+static uint32_t sim_usb_banks(uint32_t u32_Pipe);
+static uint16_t sim_usb_maxp(uint32_t u32_Pipe);
+static bool sim_usb_cpu_writes(uint32_t u32_Pipe);
+static void sim_usb_fifo(size_t u32_Member, bool bl_Write);
+static void sim_usb_bus_reset(void);
+static void sim_usb_host_setup(const SimUsbRequest *pst_Req);
+static void sim_usb_host_control(uint64_t u64_Now);
+static void sim_usb_host_finish(bool bl_Stall);
+static void sim_usb_host_check(bool bl_Stall);
+static uint32_t sim_usb_find_pipe(uint8_t u8_Ep);
+static void sim_usb_host_bulk(void);
+static bool sim_usb_busy(void);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  USB仮想COMポート(疑似端末)を作成する
+  * @param  None
+  * @retval None
+  * @note   スレーブ側を一度開いてrawモードにしておく。ホストのポートオープン(DTR)は
+  *         スレーブ側を開いているプロセスの有無(マスター側のPOLLHUP)で判定する
+  */
+void sim_usb_open_pty(void)
+{
+	struct termios st_Term;
+	int i32_Slave;
+
+	i32s_UsbPty = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if (i32s_UsbPty < 0) {
+		return;
+	}
+	if ((grantpt(i32s_UsbPty) != 0) || (unlockpt(i32s_UsbPty) != 0)
+	 || (ptsname_r(i32s_UsbPty, cs_UsbPtyName, sizeof(cs_UsbPtyName)) != 0)) {
+		close(i32s_UsbPty);
+		i32s_UsbPty = -1;
+		return;
+	}
+	i32_Slave = open(cs_UsbPtyName, O_RDWR | O_NOCTTY);
+	if (i32_Slave >= 0) {
+		if (tcgetattr(i32_Slave, &st_Term) == 0) {
+			cfmakeraw(&st_Term);
+			(void)tcsetattr(i32_Slave, TCSANOW, &st_Term);
+		}
+		close(i32_Slave);
+	}
+}
+
+/**
+  * @brief  USBFS INTSTS0の読み出し値を求める
+  * @param  None
+  * @retval INTSTS0
+  * @note   BRDY/BEMPは許可しているパイプの要求の論理和とする
+  */
+static uint16_t sim_usb_intsts(void)
+{
+	const R_USB_FS0_Type *pst_Usb = &g_sim_hw->usbfs;
+	uint16_t u16_Sts = (uint16_t)(u16s_UsbIntSts | u16s_UsbDvsq | u16s_UsbCtsq);
+
+	if (u16s_UsbBrdySts & pst_Usb->BRDYENB) {
+		u16_Sts |= USB_INTSTS0_BRDY;
+	}
+	if (u16s_UsbBempSts & pst_Usb->BEMPENB) {
+		u16_Sts |= USB_INTSTS0_BEMP;
+	}
+	return u16_Sts;
+}
+
+/**
+  * @brief  USBFS_INTの要求を更新する
+  * @param  None
+  * @retval None
+  * @note   許可している要因が無い状態から有る状態になった時にイベントを発生させる
+  */
+static void sim_usb_irq(void)
+{
+	bool bl_Level = (sim_usb_intsts() & g_sim_hw->usbfs.INTENB0 & USB_INTSTS0_IRQ) != 0;
+
+	if (bl_Level && !bls_UsbIrqLevel) {
+		simRaiseEvent(ELC_EVENT_USBFS_INT);
+	}
+	bls_UsbIrqLevel = bl_Level;
+}
+
+/**
+  * @brief  USBFSパイプのバッファ面数を取得する
+  * @param  u32_Pipe: パイプ番号
+  * @retval 面数(1/2)
+  */
+static uint32_t sim_usb_banks(uint32_t u32_Pipe)
+{
+	return ((u32_Pipe != 0) && (sts_UsbPipe[u32_Pipe].u16_cfg & USB_PIPECFG_DBLB)) ? 2 : 1;
+}
+
+/**
+  * @brief  USBFSパイプの最大パケットサイズを取得する
+  * @param  u32_Pipe: パイプ番号
+  * @retval 最大パケットサイズ[byte]
+  */
+static uint16_t sim_usb_maxp(uint32_t u32_Pipe)
+{
+	uint16_t u16_Maxp = (u32_Pipe == 0) ? (g_sim_hw->usbfs.DCPMAXP & 0x007F) : (sts_UsbPipe[u32_Pipe].u16_maxp & 0x01FF);
+
+	return ((u16_Maxp == 0) || (u16_Maxp > SIM_USB_PACKET)) ? SIM_USB_PACKET : u16_Maxp;
+}
+
+/**
+  * @brief  CPUがFIFOへ書き込む方向か
+  * @param  u32_Pipe: パイプ番号
+  * @retval true:書き込み(送信方向)
+  * @note   DCPはCFIFOSEL.ISEL、その他はPIPECFG.DIRで決まる
+  */
+static bool sim_usb_cpu_writes(uint32_t u32_Pipe)
+{
+	if (u32_Pipe == 0) {
+		return (g_sim_hw->usbfs.CFIFOSEL & USB_CFIFOSEL_ISEL) != 0;
+	}
+	return (sts_UsbPipe[u32_Pipe].u16_cfg & USB_PIPECFG_DIR) != 0;
+}
+
+/**
+  * @brief  USBFSのCFIFOアクセス(CFIFO/CFIFOCTR)
+  * @param  u32_Member: R_USB_FS0_Type内のオフセット
+  * @param  bl_Write: 書き込みアクセス
+  * @retval None
+  * @note   読み出しは実行前(値の準備)、書き込みは実行後に呼ぶ。
+  *         アクセス幅はCFIFOSEL.MBWで判定する
+  */
+static void sim_usb_fifo(size_t u32_Member, bool bl_Write)
+{
+	R_USB_FS0_Type *pst_Usb = &g_sim_hw->usbfs;
+	uint32_t u32_Pipe = pst_Usb->CFIFOSEL & USB_CFIFOSEL_CURPIPE;
+	SimUsbPipe *pst_Pipe;
+	uint32_t u32_Banks;
+	uint32_t u32_Bank;
+	uint32_t u32_Bytes = (pst_Usb->CFIFOSEL & USB_CFIFOSEL_MBW) ? 2 : 1;
+	uint16_t u16_Data = 0;
+	bool bl_CpuWrites;
+	uint32_t _i;
+
+	if (u32_Pipe >= SIM_USB_PIPE_NUM) {
+		return;
+	}
+	pst_Pipe = &sts_UsbPipe[u32_Pipe];
+	u32_Banks = sim_usb_banks(u32_Pipe);
+	bl_CpuWrites = sim_usb_cpu_writes(u32_Pipe);
+	/* 送信方向はCPUが書き込み中の面、受信方向は最も古い受信済みの面 */
+	u32_Bank = bl_CpuWrites ? ((pst_Pipe->u8_first + pst_Pipe->u8_fill) % u32_Banks) : pst_Pipe->u8_first;
+
+	if (u32_Member == offsetof(R_USB_FS0_Type, CFIFOCTR)) {
+		if (!bl_Write) {
+			if (bl_CpuWrites) {
+				u16_Data = (pst_Pipe->u8_fill < u32_Banks) ? (USB_CFIFOCTR_FRDY | pst_Pipe->u16_pos) : 0;
+			}
+			else if (pst_Pipe->u8_fill > 0) {
+				u16_Data = USB_CFIFOCTR_FRDY | pst_Pipe->u16_len[u32_Bank];
+			}
+			pst_Usb->CFIFOCTR = u16_Data;
+			return;
+		}
+		u16_Data = pst_Usb->CFIFOCTR;
+		pst_Usb->CFIFOCTR = 0;
+		if (bl_CpuWrites && (pst_Pipe->u8_fill < u32_Banks)) {
+			if (u16_Data & USB_CFIFOCTR_BVAL) {
+				/* 書き込んだ分(0byteを含む)を短パケットとして確定する */
+				pst_Pipe->u16_len[u32_Bank] = pst_Pipe->u16_pos;
+				pst_Pipe->u8_fill++;
+				pst_Pipe->u16_pos = 0;
+			}
+			else if (u16_Data & USB_CFIFOCTR_BCLR) {
+				pst_Pipe->u16_pos = 0;
+			}
+		}
+		else if (!bl_CpuWrites && (u16_Data & USB_CFIFOCTR_BCLR) && (pst_Pipe->u8_fill > 0)) {
+			pst_Pipe->u8_first = (uint8_t)((pst_Pipe->u8_first + 1) % u32_Banks);
+			pst_Pipe->u8_fill--;
+			pst_Pipe->u16_pos = 0;
+		}
+		return;
+	}
+
+	if (bl_Write) {
+		/* 書き込める面が無い(FRDY=0)場合は捨てる */
+		if (!bl_CpuWrites || (pst_Pipe->u8_fill >= u32_Banks)) {
+			return;
+		}
+		u16_Data = pst_Usb->CFIFO;
+		for (_i=0; (_i<u32_Bytes) && (pst_Pipe->u16_pos<SIM_USB_PACKET); _i++) {
+			pst_Pipe->u8_data[u32_Bank][pst_Pipe->u16_pos++] = (uint8_t)(u16_Data >> (8 * _i));
+		}
+		/* 最大パケットサイズに達すると確定する */
+		if (pst_Pipe->u16_pos >= sim_usb_maxp(u32_Pipe)) {
+			pst_Pipe->u16_len[u32_Bank] = pst_Pipe->u16_pos;
+			pst_Pipe->u8_fill++;
+			pst_Pipe->u16_pos = 0;
+		}
+	}
+	else {
+		if (!bl_CpuWrites && (pst_Pipe->u8_fill > 0)) {
+			for (_i=0; _i<u32_Bytes; _i++) {
+				if (pst_Pipe->u16_pos < pst_Pipe->u16_len[u32_Bank]) {
+					u16_Data |= (uint16_t)(pst_Pipe->u8_data[u32_Bank][pst_Pipe->u16_pos] << (8 * _i));
+				}
+				pst_Pipe->u16_pos++;
+			}
+			/* 全て読み出すと次の面へ切り替わる */
+			if (pst_Pipe->u16_pos >= pst_Pipe->u16_len[u32_Bank]) {
+				pst_Pipe->u8_first = (uint8_t)((pst_Pipe->u8_first + 1) % u32_Banks);
+				pst_Pipe->u8_fill--;
+				pst_Pipe->u16_pos = 0;
+			}
+		}
+		pst_Usb->CFIFO = u16_Data;
+	}
+}
+
+/**
+  * @brief  USBFSレジスタの読み出し値を準備する
+  * @param  u32_Member: R_USB_FS0_Type内のオフセット
+  * @retval None
+  */
+void sim_usb_read(size_t u32_Member)
+{
+	R_USB_FS0_Type *pst_Usb = &g_sim_hw->usbfs;
+	const SimUsbPipe *pst_Pipe;
+	uint32_t u32_Pipe;
+	bool bl_Ready;
+
+	if ((u32_Member == offsetof(R_USB_FS0_Type, CFIFO)) || (u32_Member == offsetof(R_USB_FS0_Type, CFIFOCTR))) {
+		sim_usb_fifo(u32_Member, false);
+	}
+	else if (u32_Member == offsetof(R_USB_FS0_Type, INTSTS0)) {
+		pst_Usb->INTSTS0 = sim_usb_intsts();
+	}
+	else if (u32_Member == offsetof(R_USB_FS0_Type, BRDYSTS)) {
+		pst_Usb->BRDYSTS = u16s_UsbBrdySts;
+	}
+	else if (u32_Member == offsetof(R_USB_FS0_Type, BEMPSTS)) {
+		pst_Usb->BEMPSTS = u16s_UsbBempSts;
+	}
+	else if ((u32_Member >= offsetof(R_USB_FS0_Type, PIPE_CTR)) && (u32_Member < offsetof(R_USB_FS0_Type, RESERVED12))) {
+		/* BSTS: 送信方向は書き込める面、受信方向は受信済みの面がある */
+		u32_Pipe = (uint32_t)((u32_Member - offsetof(R_USB_FS0_Type, PIPE_CTR)) / sizeof(uint16_t)) + 1;
+		pst_Pipe = &sts_UsbPipe[u32_Pipe];
+		bl_Ready = (pst_Pipe->u16_cfg & USB_PIPECFG_DIR) ? (pst_Pipe->u8_fill < sim_usb_banks(u32_Pipe)) : (pst_Pipe->u8_fill > 0);
+		pst_Usb->PIPE_CTR[u32_Pipe - 1] = (uint16_t)((pst_Usb->PIPE_CTR[u32_Pipe - 1] & ~USB_PIPECTR_BSTS) | (bl_Ready ? USB_PIPECTR_BSTS : 0));
+	}
+}
+
+/**
+  * @brief  USBFSレジスタ書き込み
+  * @param  u32_Member: R_USB_FS0_Type内のオフセット
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+void sim_usb_write(size_t u32_Member, uint64_t u64_Now)
+{
+	R_USB_FS0_Type *pst_Usb = &g_sim_hw->usbfs;
+	uint32_t u32_Pipe = pst_Usb->PIPESEL & 0x000F;
+	bool bl_Attach;
+
+	switch (u32_Member) {
+	case offsetof(R_USB_FS0_Type, SYSCFG):
+		/* USBE=1かつDPRPU=1で接続し、ホストがバスリセットを送る */
+		bl_Attach = ((pst_Usb->SYSCFG & (USB_SYSCFG_USBE | USB_SYSCFG_DPRPU)) == (USB_SYSCFG_USBE | USB_SYSCFG_DPRPU));
+		if (bl_Attach && !bls_UsbAttached) {
+			bls_UsbAttached = true;
+			u16s_UsbDvsq = 0;
+			u64s_UsbResetTime = u64_Now + SIM_USB_ATTACH;
+			sim_log("USB CDC-ACM: %s", (i32s_UsbPty >= 0) ? cs_UsbPtyName : "(no pty)");
+		}
+		else if (!bl_Attach && bls_UsbAttached) {
+			bls_UsbAttached = false;
+			bls_UsbEnumerated = false;
+			u64s_UsbResetTime = 0;
+			sim_log("USB detached");
+		}
+		break;
+	case offsetof(R_USB_FS0_Type, CFIFO):
+	case offsetof(R_USB_FS0_Type, CFIFOCTR):
+		sim_usb_fifo(u32_Member, true);
+		break;
+	case offsetof(R_USB_FS0_Type, INTSTS0):
+		u16s_UsbIntSts &= (uint16_t)(pst_Usb->INTSTS0 | ~USB_INTSTS0_W0C);
+		sim_usb_irq();
+		break;
+	case offsetof(R_USB_FS0_Type, BRDYSTS):
+		u16s_UsbBrdySts &= pst_Usb->BRDYSTS;
+		sim_usb_irq();
+		break;
+	case offsetof(R_USB_FS0_Type, BEMPSTS):
+		u16s_UsbBempSts &= pst_Usb->BEMPSTS;
+		sim_usb_irq();
+		break;
+	case offsetof(R_USB_FS0_Type, INTENB0):
+	case offsetof(R_USB_FS0_Type, BRDYENB):
+	case offsetof(R_USB_FS0_Type, BEMPENB):
+		sim_usb_irq();
+		break;
+	case offsetof(R_USB_FS0_Type, PIPESEL):
+		/* PIPECFG/PIPEMAXPは選択したパイプの設定を示す */
+		if ((u32_Pipe > 0) && (u32_Pipe < SIM_USB_PIPE_NUM)) {
+			pst_Usb->PIPECFG = sts_UsbPipe[u32_Pipe].u16_cfg;
+			pst_Usb->PIPEMAXP = sts_UsbPipe[u32_Pipe].u16_maxp;
+		}
+		break;
+	case offsetof(R_USB_FS0_Type, PIPECFG):
+		if ((u32_Pipe > 0) && (u32_Pipe < SIM_USB_PIPE_NUM)) {
+			sts_UsbPipe[u32_Pipe].u16_cfg = pst_Usb->PIPECFG;
+		}
+		break;
+	case offsetof(R_USB_FS0_Type, PIPEMAXP):
+		if ((u32_Pipe > 0) && (u32_Pipe < SIM_USB_PIPE_NUM)) {
+			sts_UsbPipe[u32_Pipe].u16_maxp = pst_Usb->PIPEMAXP;
+		}
+		break;
+	default:
+		if ((u32_Member >= offsetof(R_USB_FS0_Type, PIPE_CTR)) && (u32_Member < offsetof(R_USB_FS0_Type, RESERVED12))) {
+			u32_Pipe = (uint32_t)((u32_Member - offsetof(R_USB_FS0_Type, PIPE_CTR)) / sizeof(uint16_t)) + 1;
+			if (pst_Usb->PIPE_CTR[u32_Pipe - 1] & USB_PIPECTR_ACLRM) {
+				/* バッファを初期化する */
+				sts_UsbPipe[u32_Pipe].u8_first = 0;
+				sts_UsbPipe[u32_Pipe].u8_fill = 0;
+				sts_UsbPipe[u32_Pipe].u16_pos = 0;
+			}
+		}
+		break;
+	}
+}
+
+/**
+  * @brief  USBバスリセット
+  * @param  None
+  * @retval None
+  * @note   全パイプのバッファを空にしてNAK応答とし、デフォルトステートへ遷移する
+  */
+static void sim_usb_bus_reset(void)
+{
+	R_USB_FS0_Type *pst_Usb = &g_sim_hw->usbfs;
+	uint32_t _i;
+
+	for (_i=0; _i<SIM_USB_PIPE_NUM; _i++) {
+		sts_UsbPipe[_i].u8_first = 0;
+		sts_UsbPipe[_i].u8_fill = 0;
+		sts_UsbPipe[_i].u16_pos = 0;
+	}
+	for (_i=0; _i<(SIM_USB_PIPE_NUM - 1); _i++) {
+		pst_Usb->PIPE_CTR[_i] &= (uint16_t)~USB_PID_MASK;
+	}
+	pst_Usb->DCPCTR &= (uint16_t)~(USB_PID_MASK | USB_DCPCTR_CCPL);
+	u16s_UsbBrdySts = 0;
+	u16s_UsbBempSts = 0;
+	u16s_UsbCtsq = USB_CTSQ_IDST;
+	u16s_UsbDvsq = USB_DVSQ_DEFAULT;
+	u16s_UsbIntSts |= USB_INTSTS0_DVST;
+	u8s_UsbHostState = SIM_USBH_IDLE;
+	u8s_UsbHostStep = 0;
+	u8s_UsbHostLine = 0;
+	bls_UsbEnumerated = false;
+	bls_UsbEnumFailed = false;
+	sim_usb_irq();
+}
+
+/**
+  * @brief  ホスト: セットアップを送る
+  * @param  pst_Req: リクエスト
+  * @retval None
+  * @note   SET_ADDRESSはUSBFSが自動で応答する(CPUへの割り込みはDVSTだけ)
+  */
+static void sim_usb_host_setup(const SimUsbRequest *pst_Req)
+{
+	R_USB_FS0_Type *pst_Usb = &g_sim_hw->usbfs;
+
+	sts_UsbHostReq = *pst_Req;
+	u16s_UsbHostLen = 0;
+	u64s_UsbSetups++;
+	if ((pst_Req->u8_type == 0x00) && (pst_Req->u8_request == USB_REQ_SET_ADDRESS)) {
+		u16s_UsbDvsq = USB_DVSQ_ADDRESS;
+		u16s_UsbIntSts |= USB_INTSTS0_DVST;
+		sim_usb_irq();
+		sim_usb_host_finish(false);
+		return;
+	}
+	*(volatile uint16_t *)&pst_Usb->USBREQ = (uint16_t)(pst_Req->u8_type | (pst_Req->u8_request << 8));
+	*(volatile uint16_t *)&pst_Usb->USBVAL = pst_Req->u16_value;
+	*(volatile uint16_t *)&pst_Usb->USBINDX = pst_Req->u16_index;
+	*(volatile uint16_t *)&pst_Usb->USBLENG = pst_Req->u16_length;
+	/* セットアップを受信するとDCPはNAK応答になり、バッファは空になる */
+	pst_Usb->DCPCTR &= (uint16_t)~(USB_PID_MASK | USB_DCPCTR_CCPL);
+	sts_UsbPipe[0].u8_first = 0;
+	sts_UsbPipe[0].u8_fill = 0;
+	sts_UsbPipe[0].u16_pos = 0;
+	if ((pst_Req->u8_type == 0x00) && (pst_Req->u8_request == USB_REQ_SET_CONFIGURATION) && (pst_Req->u16_value != 0)) {
+		u16s_UsbDvsq = USB_DVSQ_CONFIGURED;
+		u16s_UsbIntSts |= USB_INTSTS0_DVST;
+	}
+	if (pst_Req->u16_length == 0) {
+		u16s_UsbCtsq = USB_CTSQ_WRND;
+		u8s_UsbHostState = SIM_USBH_STATUS;
+	}
+	else if (pst_Req->u8_type & 0x80) {
+		u16s_UsbCtsq = USB_CTSQ_RDDS;
+		u8s_UsbHostState = SIM_USBH_DATA_IN;
+	}
+	else {
+		u16s_UsbCtsq = USB_CTSQ_WRDS;
+		u8s_UsbHostState = SIM_USBH_DATA_OUT;
+	}
+	u16s_UsbIntSts |= (USB_INTSTS0_VALID | USB_INTSTS0_CTRT);
+	sim_usb_irq();
+}
+
+/**
+  * @brief  ホスト: コントロール転送を1ステップ進める
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  */
+static void sim_usb_host_control(uint64_t u64_Now)
+{
+	R_USB_FS0_Type *pst_Usb = &g_sim_hw->usbfs;
+	SimUsbPipe *pst_Dcp = &sts_UsbPipe[0];
+	uint16_t u16_Pid = pst_Usb->DCPCTR & USB_PID_MASK;
+	uint16_t u16_Size;
+	SimUsbRequest st_Req;
+
+	if ((u8s_UsbHostState != SIM_USBH_IDLE) && (u16_Pid & USB_PID_STALL)) {
+		sim_usb_host_finish(true);
+		return;
+	}
+	switch (u8s_UsbHostState) {
+	case SIM_USBH_IDLE:
+		if ((u16s_UsbDvsq == 0) || (u64_Now < u64s_UsbHostNext)) {
+			break;
+		}
+		if (u8s_UsbHostStep < SIM_USB_SCRIPT_NUM) {
+			sim_usb_host_setup(&sts_UsbScript[u8s_UsbHostStep]);
+		}
+		else if (bls_UsbEnumerated && (u8s_UsbHostLine != (bls_UsbPtyOpen ? 0x03 : 0x00))) {
+			/* 仮想COMポートのオープン/クローズをDTR/RTSで通知する */
+			memset(&st_Req, 0, sizeof(st_Req));
+			st_Req.u8_type = 0x21;
+			st_Req.u8_request = USB_REQ_SET_CONTROL_LINE_STATE;
+			st_Req.u16_value = bls_UsbPtyOpen ? 0x03 : 0x00;
+			sim_usb_host_setup(&st_Req);
+		}
+		break;
+	case SIM_USBH_DATA_IN:
+		if ((u16_Pid != USB_PID_BUF) || (pst_Dcp->u8_fill == 0)) {
+			break;
+		}
+		u16_Size = pst_Dcp->u16_len[pst_Dcp->u8_first];
+		if (u16_Size > (SIM_USB_HOST_BUFF - u16s_UsbHostLen)) {
+			u16_Size = (uint16_t)(SIM_USB_HOST_BUFF - u16s_UsbHostLen);
+		}
+		memcpy(&u8s_UsbHostData[u16s_UsbHostLen], pst_Dcp->u8_data[pst_Dcp->u8_first], u16_Size);
+		u16s_UsbHostLen += u16_Size;
+		pst_Dcp->u8_fill = 0;
+		u16s_UsbBempSts |= 0x0001;
+		/* 短パケットか要求サイズに達したらステータスステージへ進む */
+		if ((pst_Dcp->u16_len[pst_Dcp->u8_first] < sim_usb_maxp(0)) || (u16s_UsbHostLen >= sts_UsbHostReq.u16_length)) {
+			u16s_UsbCtsq = USB_CTSQ_RDSS;
+			u16s_UsbIntSts |= USB_INTSTS0_CTRT;
+			u8s_UsbHostState = SIM_USBH_STATUS;
+		}
+		sim_usb_irq();
+		break;
+	case SIM_USBH_DATA_OUT:
+		if ((u16_Pid != USB_PID_BUF) || (pst_Dcp->u8_fill != 0)) {
+			break;
+		}
+		if (u16s_UsbHostLen < sts_UsbHostReq.u16_length) {
+			u16_Size = (uint16_t)(sts_UsbHostReq.u16_length - u16s_UsbHostLen);
+			if (u16_Size > sim_usb_maxp(0)) {
+				u16_Size = sim_usb_maxp(0);
+			}
+			memcpy(pst_Dcp->u8_data[0], &sts_UsbHostReq.pu8_data[u16s_UsbHostLen], u16_Size);
+			pst_Dcp->u16_len[0] = u16_Size;
+			pst_Dcp->u8_first = 0;
+			pst_Dcp->u8_fill = 1;
+			pst_Dcp->u16_pos = 0;
+			u16s_UsbHostLen += u16_Size;
+			u16s_UsbBrdySts |= 0x0001;
+		}
+		else {
+			u16s_UsbCtsq = USB_CTSQ_WRSS;
+			u16s_UsbIntSts |= USB_INTSTS0_CTRT;
+			u8s_UsbHostState = SIM_USBH_STATUS;
+		}
+		sim_usb_irq();
+		break;
+	case SIM_USBH_STATUS:
+		/* CCPL=1で正常終了する */
+		if ((u16_Pid == USB_PID_BUF) && (pst_Usb->DCPCTR & USB_DCPCTR_CCPL)) {
+			pst_Usb->DCPCTR &= (uint16_t)~USB_DCPCTR_CCPL;
+			sim_usb_host_finish(false);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+  * @brief  ホスト: コントロール転送の終了
+  * @param  bl_Stall: STALL応答で終了した
+  * @retval None
+  * @note   列挙中は応答を確認し、全て終わると列挙の結果をログ出力する
+  */
+static void sim_usb_host_finish(bool bl_Stall)
+{
+	u16s_UsbCtsq = USB_CTSQ_IDST;
+	u8s_UsbHostState = SIM_USBH_IDLE;
+	if (sts_UsbHostReq.u8_request == USB_REQ_SET_CONTROL_LINE_STATE) {
+		if (!bl_Stall) {
+			u8s_UsbHostLine = (uint8_t)sts_UsbHostReq.u16_value;
+		}
+		return;
+	}
+	if (u8s_UsbHostStep >= SIM_USB_SCRIPT_NUM) {
+		return;
+	}
+	sim_usb_host_check(bl_Stall);
+	u8s_UsbHostStep++;
+	if ((u8s_UsbHostStep == SIM_USB_SCRIPT_NUM) && !bls_UsbEnumFailed) {
+		bls_UsbEnumerated = true;
+		sim_log("USB enumerated: %04x:%04x \"%s\", bulk IN 0x%02x OUT 0x%02x (%u bytes), notify 0x%02x",
+			u16s_UsbVid, u16s_UsbPid, cs_UsbProduct, u8s_UsbEpIn, u8s_UsbEpOut, u16s_UsbEpSize, u8s_UsbEpNotify);
+	}
+}
+
+/**
+  * @brief  ホスト: 列挙中の応答を確認する
+  * @param  bl_Stall: STALL応答で終了した
+  * @retval None
+  */
+static void sim_usb_host_check(bool bl_Stall)
+{
+	const uint8_t *pu8_Data = &u8s_UsbHostData[0];
+	uint16_t u16_Len = u16s_UsbHostLen;
+	const char *pc_Error = NULL;
+	uint16_t _i;
+
+	switch (sts_UsbHostReq.u8_check) {
+	case SIM_USB_CHECK_STALL:
+		if (!bl_Stall) {
+			pc_Error = "unsupported request not stalled";
+		}
+		break;
+	case SIM_USB_CHECK_DEVICE:
+		if (bl_Stall || (u16_Len != 18) || (pu8_Data[0] != 18) || (pu8_Data[1] != 0x01) || (pu8_Data[7] != SIM_USB_PACKET)) {
+			pc_Error = "bad device descriptor";
+			break;
+		}
+		u16s_UsbVid = (uint16_t)(pu8_Data[8] | (pu8_Data[9] << 8));
+		u16s_UsbPid = (uint16_t)(pu8_Data[10] | (pu8_Data[11] << 8));
+		break;
+	case SIM_USB_CHECK_CONFIG:
+		if (bl_Stall || (u16_Len < 9) || (pu8_Data[1] != 0x02) || ((pu8_Data[2] | (pu8_Data[3] << 8)) != u16_Len)) {
+			pc_Error = "bad configuration descriptor";
+			break;
+		}
+		/* エンドポイントディスクリプタを探す */
+		for (_i=0; (_i + 2)<=u16_Len; _i+=pu8_Data[_i]) {
+			if ((pu8_Data[_i] < 2) || ((_i + pu8_Data[_i]) > u16_Len)) {
+				pc_Error = "broken descriptor chain";
+				break;
+			}
+			if ((pu8_Data[_i + 1] != 0x05) || (pu8_Data[_i] < 7)) {
+				continue;
+			}
+			if ((pu8_Data[_i + 3] & 0x03) == 0x02) {
+				if (pu8_Data[_i + 2] & 0x80) {
+					u8s_UsbEpIn = pu8_Data[_i + 2];
+				}
+				else {
+					u8s_UsbEpOut = pu8_Data[_i + 2];
+				}
+				u16s_UsbEpSize = (uint16_t)(pu8_Data[_i + 4] | (pu8_Data[_i + 5] << 8));
+			}
+			else if ((pu8_Data[_i + 3] & 0x03) == 0x03) {
+				u8s_UsbEpNotify = pu8_Data[_i + 2];
+			}
+		}
+		if ((pc_Error == NULL) && ((u8s_UsbEpIn == 0) || (u8s_UsbEpOut == 0))) {
+			pc_Error = "no bulk endpoints";
+		}
+		break;
+	case SIM_USB_CHECK_STRING:
+		if (bl_Stall || (u16_Len < 2) || (pu8_Data[0] != u16_Len) || (pu8_Data[1] != 0x03)) {
+			pc_Error = "bad string descriptor";
+			break;
+		}
+		/* UTF-16LEのASCII部分だけを取り出す */
+		for (_i=0; ((2 + (_i * 2)) < u16_Len) && (_i < (sizeof(cs_UsbProduct) - 1)); _i++) {
+			cs_UsbProduct[_i] = (char)pu8_Data[2 + (_i * 2)];
+		}
+		cs_UsbProduct[_i] = '\0';
+		break;
+	default:
+		if (bl_Stall) {
+			pc_Error = "request stalled";
+		}
+		break;
+	}
+	if (pc_Error != NULL) {
+		bls_UsbEnumFailed = true;
+		sim_log("USB enumeration failed at request %02x:%02x: %s",
+			sts_UsbHostReq.u8_type, sts_UsbHostReq.u8_request, pc_Error);
+	}
+}
+
+/**
+  * @brief  ホスト: エンドポイントに対応するパイプを探す
+  * @param  u8_Ep: エンドポイントアドレス
+  * @retval パイプ番号(0:無し)
+  */
+static uint32_t sim_usb_find_pipe(uint8_t u8_Ep)
+{
+	uint16_t u16_Cfg;
+	uint32_t _i;
+
+	for (_i=1; _i<SIM_USB_PIPE_NUM; _i++) {
+		u16_Cfg = sts_UsbPipe[_i].u16_cfg;
+		if (((u16_Cfg & USB_PIPECFG_TYPE) != 0) && ((u16_Cfg & USB_PIPECFG_EPNUM) == (u8_Ep & 0x0F))
+		 && (((u16_Cfg & USB_PIPECFG_DIR) != 0) == ((u8_Ep & 0x80) != 0))) {
+			return _i;
+		}
+	}
+	return 0;
+}
+
+/**
+  * @brief  ホスト: バルク転送を1パケットずつ行う
+  * @param  None
+  * @retval None
+  * @note   OUTは疑似端末の入力を送り、INは疑似端末へ出力する。デバイスがNAK
+  *         (PID≠BUF,バッファ無し)の間や疑似端末が書き込めない間は転送しない
+  */
+static void sim_usb_host_bulk(void)
+{
+	R_USB_FS0_Type *pst_Usb = &g_sim_hw->usbfs;
+	SimUsbPipe *pst_Pipe;
+	uint32_t u32_Pipe;
+	uint32_t u32_Banks;
+	uint32_t u32_Bank;
+	ssize_t i32_Len;
+
+	/* ---- OUT(ホスト→デバイス) ---- */
+	u32_Pipe = sim_usb_find_pipe(u8s_UsbEpOut);
+	if ((u32_Pipe != 0) && bls_UsbOutReady) {
+		pst_Pipe = &sts_UsbPipe[u32_Pipe];
+		u32_Banks = sim_usb_banks(u32_Pipe);
+		if (((pst_Usb->PIPE_CTR[u32_Pipe - 1] & USB_PID_MASK) == USB_PID_BUF) && (pst_Pipe->u8_fill < u32_Banks)) {
+			u32_Bank = (pst_Pipe->u8_first + pst_Pipe->u8_fill) % u32_Banks;
+			i32_Len = read(i32s_UsbPty, pst_Pipe->u8_data[u32_Bank], sim_usb_maxp(u32_Pipe));
+			if (i32_Len > 0) {
+				pst_Pipe->u16_len[u32_Bank] = (uint16_t)i32_Len;
+				pst_Pipe->u8_fill++;
+				u16s_UsbBrdySts |= (uint16_t)(1U << u32_Pipe);
+				u64s_UsbOutBytes += (uint64_t)i32_Len;
+				bls_UsbOutReady = (i32_Len == sim_usb_maxp(u32_Pipe));
+				sim_usb_irq();
+			}
+			else {
+				bls_UsbOutReady = false;
+			}
+		}
+		else {
+			u64s_UsbNak++;
+		}
+	}
+
+	/* ---- IN(デバイス→ホスト) ---- */
+	u32_Pipe = sim_usb_find_pipe(u8s_UsbEpIn);
+	if ((u32_Pipe == 0) || !bls_UsbPtyOpen) {
+		return;
+	}
+	if (u16s_UsbInPos < u16s_UsbInLen) {
+		/* 前回書き込めなかった残り */
+		i32_Len = write(i32s_UsbPty, &u8s_UsbInPending[u16s_UsbInPos], u16s_UsbInLen - u16s_UsbInPos);
+		if (i32_Len > 0) {
+			u16s_UsbInPos += (uint16_t)i32_Len;
+		}
+		if (u16s_UsbInPos < u16s_UsbInLen) {
+			return;
+		}
+	}
+	pst_Pipe = &sts_UsbPipe[u32_Pipe];
+	u32_Banks = sim_usb_banks(u32_Pipe);
+	if (((pst_Usb->PIPE_CTR[u32_Pipe - 1] & USB_PID_MASK) != USB_PID_BUF) || (pst_Pipe->u8_fill == 0)) {
+		return;
+	}
+	u32_Bank = pst_Pipe->u8_first;
+	u16s_UsbInLen = pst_Pipe->u16_len[u32_Bank];
+	memcpy(u8s_UsbInPending, pst_Pipe->u8_data[u32_Bank], u16s_UsbInLen);
+	i32_Len = (u16s_UsbInLen > 0) ? write(i32s_UsbPty, u8s_UsbInPending, u16s_UsbInLen) : 0;
+	u16s_UsbInPos = (i32_Len > 0) ? (uint16_t)i32_Len : 0;
+	u64s_UsbInBytes += u16s_UsbInLen;
+	/* 送信した面は再び書き込めるようになる(BRDY)。全て空になるとBEMP */
+	pst_Pipe->u8_first = (uint8_t)((pst_Pipe->u8_first + 1) % u32_Banks);
+	pst_Pipe->u8_fill--;
+	u16s_UsbBrdySts |= (uint16_t)(1U << u32_Pipe);
+	if (pst_Pipe->u8_fill == 0) {
+		u16s_UsbBempSts |= (uint16_t)(1U << u32_Pipe);
+	}
+	sim_usb_irq();
+}
+
+/**
+  * @brief  USBFSの時間経過処理
+  * @param  u64_Now: 仮想時間[ns]
+  * @retval None
+  * @note   ホストはSIM_USB_SLOT毎にコントロール転送を1ステップ、バルク転送を
+  *         OUT/IN各1パケット行う(フルスピードの1フレームに19パケット相当)
+  */
+void sim_usb_update(uint64_t u64_Now)
+{
+	struct pollfd st_Poll;
+
+	if (!bls_UsbAttached) {
+		return;
+	}
+	if ((u64s_UsbResetTime != 0) && (u64_Now >= u64s_UsbResetTime)) {
+		u64s_UsbResetTime = 0;
+		u64s_UsbHostNext = u64_Now + SIM_USB_RESET;
+		sim_usb_bus_reset();
+	}
+	if (i32s_UsbPty >= 0) {
+		st_Poll.fd = i32s_UsbPty;
+		st_Poll.events = POLLIN;
+		st_Poll.revents = 0;
+		if (poll(&st_Poll, 1, 0) >= 0) {
+			bls_UsbPtyOpen = ((st_Poll.revents & POLLHUP) == 0);
+			if (bls_UsbPtyOpen && (st_Poll.revents & POLLIN)) {
+				bls_UsbOutReady = true;
+			}
+		}
+	}
+	if (u64_Now < u64s_UsbSlotNext) {
+		return;
+	}
+	u64s_UsbSlotNext = u64_Now + SIM_USB_SLOT;
+	sim_usb_host_control(u64_Now);
+	if (bls_UsbEnumerated) {
+		sim_usb_host_bulk();
+	}
+}
+
+/**
+  * @brief  USBのホストに転送待ちがあるか
+  * @param  None
+  * @retval true:次のスロットで転送する
+  * @note   転送が無い間はSIM_USB_SLOT毎のタイマーを設定しない
+  */
+static bool sim_usb_busy(void)
+{
+	uint32_t u32_Pipe;
+
+	if (!bls_UsbAttached || (u16s_UsbDvsq == 0)) {
+		return false;
+	}
+	if ((u8s_UsbHostState != SIM_USBH_IDLE) || (u8s_UsbHostStep < SIM_USB_SCRIPT_NUM)) {
+		return true;
+	}
+	if (!bls_UsbEnumerated) {
+		return false;
+	}
+	if (bls_UsbOutReady || (u8s_UsbHostLine != (bls_UsbPtyOpen ? 0x03 : 0x00))) {
+		return true;
+	}
+	u32_Pipe = sim_usb_find_pipe(u8s_UsbEpIn);
+	return bls_UsbPtyOpen && (u32_Pipe != 0) && ((sts_UsbPipe[u32_Pipe].u8_fill > 0) || (u16s_UsbInPos < u16s_UsbInLen));
+}
+
+/**
+  * @brief  USBFSの次のイベント時刻を反映する
+  * @param  pu64_Next: 次のイベント時刻[ns](より早ければ更新する)
+  * @retval None
+  */
+void sim_usb_schedule(uint64_t *pu64_Next)
+{
+	if ((u64s_UsbResetTime != 0) && (u64s_UsbResetTime < *pu64_Next)) {
+		*pu64_Next = u64s_UsbResetTime;
+	}
+	if (sim_usb_busy() && (u64s_UsbSlotNext < *pu64_Next)) {
+		*pu64_Next = u64s_UsbSlotNext;
+	}
+}
+
+/**
+  * @brief  USBFSの統計を出力する
+  * @param  None
+  * @retval None
+  */
+void sim_usb_report(void)
+{
+	if (u64s_UsbSetups > 0) {
+		fprintf(stderr, "[sim] USB bulk out %llu bytes, in %llu bytes, nak %llu, setup %llu\n",
+			(unsigned long long)u64s_UsbOutBytes, (unsigned long long)u64s_UsbInBytes,
+			(unsigned long long)u64s_UsbNak, (unsigned long long)u64s_UsbSetups);
+	}
+}
@@ -0,0 +1,12 @@
+#
+# ホスト実行(native)設定スクリプト
+#   ベクターテーブルに32bitでアドレスを格納するため、非PIEで
+#   下位4GBに配置する。割り込み模擬にスレッドを使用する。
+#
+Import("env")
+
+env.Append(
+    CCFLAGS=["-fno-pie"],
+    LINKFLAGS=["-no-pie", "-pthread"],
+    LIBS=["m", "pthread"],
+)
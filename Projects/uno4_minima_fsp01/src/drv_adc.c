@@ -0,0 +1,507 @@
+/**
+  ******************************************************************************
+  * @file           : drv_adc.c
+  * @brief          : ADCドライバー(GPT→ELCトリガー, DTC転送, ダブルバッファ)
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "drv.h"
+#include "lib.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* アナログ入力端子情報 */
+typedef struct _AdcPinInfo {
+	uint8_t u8_port;				/* ポート番号							*/
+	uint8_t u8_pin;					/* 端子番号								*/
+	uint8_t u8_an;					/* アナログチャネル(ANxxx)				*/
+} AdcPinInfo;
+
+/* Private define ------------------------------------------------------------*/
+#define ADC_STAT_TIME		(1000)					/* 統計更新周期[ms]				*/
+#define ADC_GPT_PERIOD_MAX	(0x10000)				/* GPT(16bit)周期の上限			*/
+#define ADC_GPT_TPCS_MAX	(5)						/* GPTプリスケーラ最大(1/1024)	*/
+#define ADC_CEILING			(IRQ_PRIO_ADC0)			/* 統計/完了面/コールバックのシーリング(ADC0_ADI)	*/
+
+/* ストリーミングフレーム */
+#define ADC_FRAME_SYNC1		(0xA5)					/* 同期コード1					*/
+#define ADC_FRAME_SYNC2		(0x5A)					/* 同期コード2					*/
+#define ADC_FRAME_HDR_SIZE	(6)						/* ヘッダーサイズ				*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+/* アナログ入力端子(A0～A5) */
+static const AdcPinInfo csts_AdcPinTable[ADC_CH_MAX] = {
+	{0, 14,  9},									/* A0: P014 = AN009		*/
+	{0,  0,  0},									/* A1: P000 = AN000		*/
+	{0,  1,  1},									/* A2: P001 = AN001		*/
+	{0,  2,  2},									/* A3: P002 = AN002		*/
+	{1,  1, 21},									/* A4: P101 = AN021		*/
+	{1,  0, 22},									/* A5: P100 = AN022		*/
+};
+
+/* サンプリングバッファ[面][チャネル][スキャン] */
+static uint16_t u16s_AdcBuffer[2][ADC_CH_MAX][ADC_BLOCK_SCANS];
+/* DTC転送情報[面][チャネル](チャネル数分をチェーン転送する) */
+static DtcTransferInfo sts_AdcDtcInfo[2][ADC_CH_MAX];
+/* ストリーミング送信バッファ */
+static uint8_t u8s_AdcStreamFrame[ADC_FRAME_HDR_SIZE + (ADC_CH_MAX * ADC_BLOCK_SCANS * 2)];
+
+static uint8_t u8s_AdcChCount;							/* 有効チャネル数				*/
+static AdcBlockCallback pfs_AdcCallback;				/* ブロック完了コールバック		*/
+volatile static uint8_t u8s_AdcActiveHalf;				/* DTC転送中の面				*/
+volatile static uint8_t u8s_AdcReadyMask;				/* 送信待ちの面(bit0:前半, bit1:後半)	*/
+volatile static bool bls_AdcRunning;					/* 変換動作中					*/
+static uint32_t u32s_AdcSampleRate;						/* 指定されたサンプリング周波数[Hz]	*/
+static bool bls_AdcStreaming;							/* ストリーミング動作中			*/
+static uint16_t u16s_AdcStreamSize;						/* 送信中フレームのサイズ		*/
+static uint16_t u16s_AdcStreamSent;						/* 送信中フレームの送信済みサイズ	*/
+static uint8_t u8s_AdcStreamSeq;						/* フレームシーケンス番号		*/
+
+/* 統計情報 */
+volatile static uint32_t u32s_AdcScanCount;				/* 統計周期内のスキャン数		*/
+volatile static uint32_t u32s_AdcBusyCycle;				/* 統計周期内の割り込み処理サイクル	*/
+static uint32_t u32s_AdcStatStartCycle;					/* 統計周期の開始サイクル		*/
+static Timer sts_AdcStatTimer;							/* 統計更新タイマー				*/
+static AdcStatistics sts_AdcStatistics;					/* 統計情報						*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void adcSetupTransferInfo(uint8_t u8_Half);		/* DTC転送情報を設定する				*/
+static void adcSetupTrigger(uint32_t u32_SampleRate);	/* GPTトリガー周期を設定する			*/
+static void adcUpdateStatistics(void);					/* 統計情報を更新する					*/
+static void adcUpdateStream(void);						/* ストリーミング送信を進める			*/
+static uint8_t adcClockCallback(uint8_t u8_Event, uint8_t u8_Mode);	/* クロック変更コールバック	*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  ADC0スキャン終了割り込みハンドラ
+  * @param  None
+  * @retval None
+  * @note   DTCがブロック(ADC_BLOCK_SCANS回分)の転送を完了した時のみ発生する。
+  *         DTCEの再設定はIRクリア後に行う(IR=1のままDTCEを立てると完了済みの
+  *         要求で余分なDTC転送が起動する)。IRクリアからDTCE再設定までの間に
+  *         スキャンが終了した場合はCPU割り込みとなり、そのスキャンは転送されない。
+  *         この場合は転送中の面のCRAが残っているため、取りこぼしとして計上して面は切り替えない
+  */
+void ADC0_ADI_Handler(void)
+{
+	uint32_t u32_StartCycle = LL_DWT_GetCycle();
+	uint8_t u8_Half = u8s_AdcActiveHalf;
+
+	/* 割り込み要求フラグ クリア */
+	R_ICU->IELSR_b[IRQ_ADC0_ADI].IR = 0;
+
+	/* ブロック途中の要求はDTCE再設定前のスキャン終了のため取りこぼしとする */
+	if (sts_AdcDtcInfo[u8_Half][u8s_AdcChCount - 1].u16_cra != 0) {
+		sts_AdcStatistics.u32_missed++;
+		u32s_AdcBusyCycle += LL_DWT_GetCycle() - u32_StartCycle;
+		return;
+	}
+
+	/* もう一方の面へ切り替えてDTC起動を再開する */
+	LL_DTC_SetVector(IRQ_ADC0_ADI, &sts_AdcDtcInfo[u8_Half ^ 1][0]);
+	LL_DTC_EnableIT(IRQ_ADC0_ADI);
+	u8s_AdcActiveHalf = u8_Half ^ 1;
+
+	/* 完了した面の転送情報を次回用に再設定する */
+	adcSetupTransferInfo(u8_Half);
+
+	/* 送信待ちのまま上書きされた場合はオーバーランとする */
+	if (u8s_AdcReadyMask & (1 << u8_Half)) {
+		sts_AdcStatistics.u32_overruns++;
+	}
+	u8s_AdcReadyMask |= (1 << u8_Half);
+	u32s_AdcScanCount += ADC_BLOCK_SCANS;
+	sts_AdcStatistics.u32_blocks++;
+
+	/* ブロック完了コールバック */
+	if (pfs_AdcCallback != NULL) {
+		pfs_AdcCallback(u8_Half, &u16s_AdcBuffer[u8_Half][0][0], u8s_AdcChCount);
+	}
+
+	u32s_AdcBusyCycle += LL_DWT_GetCycle() - u32_StartCycle;
+}
+
+/**
+  * @brief  ADCドライバー初期化処理
+  * @param  None
+  * @retval None
+  */
+void taskAdcDriverInit(void)
+{
+	uint32_t u32_Mask;
+
+	mem_set16(&u16s_AdcBuffer[0][0][0], 0x0000, sizeof(u16s_AdcBuffer) / sizeof(uint16_t));
+	mem_set08((uint8_t *)&sts_AdcDtcInfo[0][0], 0x00, sizeof(sts_AdcDtcInfo));
+	mem_set08((uint8_t *)&sts_AdcStatistics, 0x00, sizeof(sts_AdcStatistics));
+	u8s_AdcChCount = 0;
+	pfs_AdcCallback = NULL;
+	u8s_AdcActiveHalf = 0;
+	u8s_AdcReadyMask = 0;
+	bls_AdcRunning = false;
+	bls_AdcStreaming = false;
+	u16s_AdcStreamSize = 0;
+	u16s_AdcStreamSent = 0;
+	u8s_AdcStreamSeq = 0;
+
+	/* DTC初期化処理 */
+	LL_DTC_Init();
+
+	/* ---- ベクターテーブル登録 ---- */
+	u32_Mask = LL_IRQ_Lock(ADC_CEILING);
+	NVIC_SetVector((IRQn_Type)IRQ_ADC0_ADI, (uintptr_t)ADC0_ADI_Handler);
+	LL_IRQ_Unlock(u32_Mask);
+
+	/* ---- ADC0_ADI 無効 ---- */
+	R_ICU->IELSR[IRQ_ADC0_ADI] = 0x00000000;
+
+	/* ---- モジュールストップ解除 ---- */
+	R_MSTP->MSTPCRD_b.MSTPD16 = 0;					// ADC140 ON
+	R_MSTP->MSTPCRD_b.MSTPD6 = 0;					// GPT162～GPT167 ON
+	R_MSTP->MSTPCRC_b.MSTPC14 = 0;					// ELC ON
+
+	/* ---- ADC 停止 ---- */
+	R_ADC0->ADCSR = 0x0000;
+
+	/* ---- 変換条件設定 ---- */
+	R_ADC0->ADCER = 0x0006;							// 14bit精度, 右詰め
+	R_ADC0->ADSTRGR = 0x0900;						// TRSA = ELC(ELC_AD00)
+
+	/* ---- ELC 設定 (GPT4オーバーフロー → ADC0変換開始) ---- */
+	R_ELC->ELSR[ELC_PERIPHERAL_ADC0].HA = ELC_EVENT_GPT4_COUNTER_OVERFLOW;
+	R_ELC->ELCR = 0x80;								// ELC有効
+
+	/* ---- NVIC 設定 (ADC0_ADI) ---- */
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_ADC0_ADI);
+	NVIC_SetPriority((IRQn_Type)IRQ_ADC0_ADI, IRQ_PRIO_ADC0);
+	NVIC_EnableIRQ((IRQn_Type)IRQ_ADC0_ADI);
+
+	/* タイマーを開始する */
+	startTimer(&sts_AdcStatTimer);
+	u32s_AdcStatStartCycle = LL_DWT_GetCycle();
+
+	/* ---- クロック変更の通知先を登録する ---- */
+	if (clockRegisterCallback(adcClockCallback) != OK) {
+		Error_Handler();
+	}
+}
+
+/**
+  * @brief  ADCドライバー出力処理
+  * @param  None
+  * @retval None
+  */
+void taskAdcDriverOutput(void)
+{
+	/* ストリーミング送信を進める */
+	if (bls_AdcStreaming) {
+		adcUpdateStream();
+	}
+
+	/* 統計更新周期が満了した場合 */
+	if (checkTimer(&sts_AdcStatTimer, ADC_STAT_TIME)) {
+		/* 統計情報を更新する */
+		adcUpdateStatistics();
+		/* タイマーを再開する */
+		startTimer(&sts_AdcStatTimer);
+	}
+}
+
+/**
+  * @brief  ADC連続変換を開始する
+  * @param  u8_ChMask: 変換するチャネル(bit0:A0 ～ bit5:A5)
+  * @param  u32_SampleRate: サンプリング周波数[Hz]
+  * @retval OK/NG
+  */
+uint8_t adcStart(uint8_t u8_ChMask, uint32_t u32_SampleRate)
+{
+	uint16_t u16_AnMask[2] = {0, 0};
+	uint8_t u8_Ch;
+
+	if ((u8_ChMask == 0) || (u32_SampleRate == 0) || bls_AdcRunning) {
+		return NG;
+	}
+
+	/* ---- ポート設定 ---- */
+	// 書き込みプロテクト解除
+	R_BSP_PinAccessEnable();
+	u8s_AdcChCount = 0;
+	for (u8_Ch=0; u8_Ch<ADC_CH_MAX; u8_Ch++) {
+		if (u8_ChMask & (1 << u8_Ch)) {
+			const AdcPinInfo *pst_Pin = &csts_AdcPinTable[u8_Ch];
+			R_PFS->PORT[pst_Pin->u8_port].PIN[pst_Pin->u8_pin].PmnPFS_b.PMR = 0;
+			R_PFS->PORT[pst_Pin->u8_port].PIN[pst_Pin->u8_pin].PmnPFS_b.PDR = 0;
+			R_PFS->PORT[pst_Pin->u8_port].PIN[pst_Pin->u8_pin].PmnPFS_b.ASEL = 1;	// アナログ入力
+			u16_AnMask[pst_Pin->u8_an / 16] |= (uint16_t)(1 << (pst_Pin->u8_an % 16));
+			/* 有効チャネルを詰めて転送元に割り当てる */
+			sts_AdcDtcInfo[0][u8s_AdcChCount].pv_src = &R_ADC0->ADDR[pst_Pin->u8_an];
+			sts_AdcDtcInfo[1][u8s_AdcChCount].pv_src = &R_ADC0->ADDR[pst_Pin->u8_an];
+			u8s_AdcChCount++;
+		}
+	}
+	// 書き込みプロテクト施錠
+	R_BSP_PinAccessDisable();
+
+	/* ---- スキャン対象チャネル設定 ---- */
+	R_ADC0->ADANSA[0] = u16_AnMask[0];
+	R_ADC0->ADANSA[1] = u16_AnMask[1];
+
+	/* ---- DTC 設定 ---- */
+	adcSetupTransferInfo(0);
+	adcSetupTransferInfo(1);
+	u8s_AdcActiveHalf = 0;
+	u8s_AdcReadyMask = 0;
+	LL_DTC_SetVector(IRQ_ADC0_ADI, &sts_AdcDtcInfo[0][0]);
+
+	/* ---- ICU → NVIC 割り込み割り当て (ADC0_ADI) ---- */
+	R_ICU->IELSR_b[IRQ_ADC0_ADI].IR = 0;			// 割り込み要求フラグ クリア
+	R_ICU->IELSR_b[IRQ_ADC0_ADI].IELS = ELC_EVENT_ADC0_SCAN_END;
+	LL_DTC_EnableIT(IRQ_ADC0_ADI);					// スキャン終了でDTC起動
+
+	/* ---- ADC 変換開始待ち ---- */
+	R_ADC0->ADCSR = 0x1200;							// シングルスキャン, ADIE=1, TRGE=1
+
+	/* ---- GPT 設定 ---- */
+	u32s_AdcSampleRate = u32_SampleRate;
+	adcSetupTrigger(u32_SampleRate);
+
+	bls_AdcRunning = true;
+	return OK;
+}
+
+/**
+  * @brief  ADC連続変換を停止する
+  * @param  None
+  * @retval None
+  */
+void adcStop(void)
+{
+	/* ---- GPT 停止 ---- */
+	R_GPT4->GTCR_b.CST = 0;
+
+	/* ---- ADC 停止 ---- */
+	R_ADC0->ADCSR = 0x0000;
+	LL_DTC_DisableIT(IRQ_ADC0_ADI);
+	R_ICU->IELSR[IRQ_ADC0_ADI] = 0x00000000;
+
+	bls_AdcRunning = false;
+	bls_AdcStreaming = false;
+	u16s_AdcStreamSize = 0;
+	u16s_AdcStreamSent = 0;
+}
+
+/**
+  * @brief  ブロック完了コールバックを登録する
+  * @param  pf_Callback: コールバック関数(割り込みから呼ばれる, NULLで解除)
+  * @retval None
+  */
+void adcSetCallback(AdcBlockCallback pf_Callback)
+{
+	uint32_t u32_Mask;
+
+	u32_Mask = LL_IRQ_Lock(ADC_CEILING);
+	pfs_AdcCallback = pf_Callback;
+	LL_IRQ_Unlock(u32_Mask);
+}
+
+/**
+  * @brief  ストリーミング送信を設定する
+  * @param  bl_Enable: true=開始, false=停止
+  * @retval None
+  */
+void adcSetStreaming(bool bl_Enable)
+{
+	uint32_t u32_Mask;
+
+	u32_Mask = LL_IRQ_Lock(ADC_CEILING);
+	u8s_AdcReadyMask = 0;
+	LL_IRQ_Unlock(u32_Mask);
+	u16s_AdcStreamSize = 0;
+	u16s_AdcStreamSent = 0;
+	bls_AdcStreaming = bl_Enable;
+}
+
+/**
+  * @brief  ストリーミング送信の動作状態を取得する
+  * @param  None
+  * @retval bool
+  */
+bool adcIsStreaming(void)
+{
+	return bls_AdcStreaming;
+}
+
+/**
+  * @brief  ADC統計情報を取得する
+  * @param  pst_Stat: 統計情報のポインタ
+  * @retval None
+  */
+void adcGetStatistics(AdcStatistics *pst_Stat)
+{
+	uint32_t u32_Mask;
+
+	u32_Mask = LL_IRQ_Lock(ADC_CEILING);
+	*pst_Stat = sts_AdcStatistics;
+	LL_IRQ_Unlock(u32_Mask);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  DTC転送情報を設定する
+  * @param  u8_Half: 面(0:前半, 1:後半)
+  * @retval None
+  * @note   スキャン終了毎に有効チャネル数分をチェーン転送し、
+  *         ADC_BLOCK_SCANS回でCPUへ割り込みを通知する
+  */
+static void adcSetupTransferInfo(uint8_t u8_Half)
+{
+	uint8_t u8_Ch;
+	DtcTransferInfo *pst_Info;
+
+	for (u8_Ch=0; u8_Ch<u8s_AdcChCount; u8_Ch++) {
+		pst_Info = &sts_AdcDtcInfo[u8_Half][u8_Ch];
+		pst_Info->u32_mode = DTC_MD_NORMAL | DTC_SZ_HALF | DTC_SM_FIXED | DTC_DM_INC;
+		/* 最終チャネル以外はチェーン転送する */
+		if (u8_Ch < (u8s_AdcChCount - 1)) {
+			pst_Info->u32_mode |= DTC_CHNE;
+		}
+		pst_Info->pv_dst = &u16s_AdcBuffer[u8_Half][u8_Ch][0];
+		pst_Info->u16_cra = ADC_BLOCK_SCANS;
+		pst_Info->u16_crb = 0;
+	}
+}
+
+/**
+  * @brief  GPTトリガー周期を設定する
+  * @param  u32_SampleRate: サンプリング周波数[Hz]
+  * @retval None
+  */
+static void adcSetupTrigger(uint32_t u32_SampleRate)
+{
+	uint32_t u32_Period = R_FSP_SystemClockHzGet(FSP_PRIV_CLOCK_PCLKD) / u32_SampleRate;
+	uint32_t u32_Tpcs = 0;
+
+	/* 16bitに収まるまで分周する(1/1, 1/4, 1/16, 1/64, 1/256, 1/1024) */
+	while ((u32_Period >= ADC_GPT_PERIOD_MAX) && (u32_Tpcs < ADC_GPT_TPCS_MAX)) {
+		u32_Period >>= 2;
+		u32_Tpcs++;
+	}
+	if (u32_Period >= ADC_GPT_PERIOD_MAX) {
+		u32_Period = ADC_GPT_PERIOD_MAX - 1;
+	}
+
+	R_GPT4->GTCR = (u32_Tpcs << 24);				// 停止, のこぎり波, PCLKD/(4^TPCS)
+	R_GPT4->GTUDDTYC = 0x00000001;					// アップカウント
+	R_GPT4->GTPR = u32_Period - 1;
+	R_GPT4->GTCNT = 0;
+	R_GPT4->GTCR_b.CST = 1;							// カウント開始
+}
+
+/**
+  * @brief  統計情報を更新する
+  * @param  None
+  * @retval None
+  */
+static void adcUpdateStatistics(void)
+{
+	uint32_t u32_NowCycle = LL_DWT_GetCycle();
+	uint32_t u32_Elapsed = u32_NowCycle - u32s_AdcStatStartCycle;
+	uint32_t u32_Scans;
+	uint32_t u32_Busy;
+	uint32_t u32_Mask;
+
+	/* シーリング以下の優先度の割り込みを保留(BASEPRI) */
+	u32_Mask = LL_IRQ_Lock(ADC_CEILING);
+	u32_Scans = u32s_AdcScanCount;
+	u32_Busy = u32s_AdcBusyCycle;
+	u32s_AdcScanCount = 0;
+	u32s_AdcBusyCycle = 0;
+	/* BASEPRIを元に戻す */
+	LL_IRQ_Unlock(u32_Mask);
+	u32s_AdcStatStartCycle = u32_NowCycle;
+
+	if (u32_Elapsed > 0) {
+		/* 実サンプリング周波数[Hz] = スキャン数 × CPUクロック / 経過サイクル */
+		sts_AdcStatistics.u32_sample_rate = (uint32_t)(((uint64_t)u32_Scans * SystemCoreClock) / u32_Elapsed);
+		/* CPU負荷[0.1%] = 割り込み処理サイクル / 経過サイクル */
+		sts_AdcStatistics.u16_cpu_load = (uint16_t)(((uint64_t)u32_Busy * 1000) / u32_Elapsed);
+	}
+}
+
+/**
+  * @brief  クロック変更コールバック
+  * @param  u8_Event: CLOCK_EVENT_xxx
+  * @param  u8_Mode: 切り替え先の動作モード
+  * @retval OK
+  * @note   変換中はPCLKDからGPTトリガー周期を求め直す。統計周期はサイクル数で
+  *         計測しているため、切り替え時点から計測し直す
+  */
+static uint8_t adcClockCallback(uint8_t u8_Event, uint8_t u8_Mode)
+{
+	(void)u8_Mode;
+	if (u8_Event == CLOCK_EVENT_POST) {
+		if (bls_AdcRunning) {
+			adcSetupTrigger(u32s_AdcSampleRate);
+		}
+		u32s_AdcScanCount = 0;
+		u32s_AdcBusyCycle = 0;
+		u32s_AdcStatStartCycle = LL_DWT_GetCycle();
+	}
+	return OK;
+}
+
+/**
+  * @brief  ストリーミング送信を進める
+  * @param  None
+  * @retval None
+  * @note   完了した面をフレームにコピーし、UART送信Queueの空き分ずつ送信する
+  */
+static void adcUpdateStream(void)
+{
+	uint8_t u8_Half;
+	uint16_t u16_Payload;
+	uint8_t u8_Ch;
+	uint32_t u32_Mask;
+
+	/* 送信中のフレームが無い場合は、送信待ちの面からフレームを作成する */
+	if (u16s_AdcStreamSent >= u16s_AdcStreamSize) {
+		if (u8s_AdcReadyMask == 0) {
+			return;
+		}
+		/* DTC転送中でない面を優先する */
+		u8_Half = u8s_AdcActiveHalf ^ 1;
+		if ((u8s_AdcReadyMask & (1 << u8_Half)) == 0) {
+			u8_Half ^= 1;
+		}
+
+		u16_Payload = (uint16_t)(u8s_AdcChCount * ADC_BLOCK_SCANS * 2);
+		u8s_AdcStreamFrame[0] = ADC_FRAME_SYNC1;
+		u8s_AdcStreamFrame[1] = ADC_FRAME_SYNC2;
+		u8s_AdcStreamFrame[2] = u8s_AdcStreamSeq++;
+		u8s_AdcStreamFrame[3] = u8s_AdcChCount;
+		u8s_AdcStreamFrame[4] = (uint8_t)(ADC_BLOCK_SCANS & 0xFF);
+		u8s_AdcStreamFrame[5] = (uint8_t)((ADC_BLOCK_SCANS >> 8) & 0xFF);
+		for (u8_Ch=0; u8_Ch<u8s_AdcChCount; u8_Ch++) {
+			mem_cpy08(&u8s_AdcStreamFrame[ADC_FRAME_HDR_SIZE + (u8_Ch * ADC_BLOCK_SCANS * 2)],
+					  (const uint8_t *)&u16s_AdcBuffer[u8_Half][u8_Ch][0], ADC_BLOCK_SCANS * 2);
+		}
+
+		/* シーリング以下の優先度の割り込みを保留(BASEPRI) */
+		u32_Mask = LL_IRQ_Lock(ADC_CEILING);
+		u8s_AdcReadyMask &= (uint8_t)~(1 << u8_Half);
+		/* BASEPRIを元に戻す */
+		LL_IRQ_Unlock(u32_Mask);
+
+		u16s_AdcStreamSize = ADC_FRAME_HDR_SIZE + u16_Payload;
+		u16s_AdcStreamSent = 0;
+	}
+
+	/* UART送信データを登録する(登録できた分だけ進める) */
+	u16s_AdcStreamSent += uartSetTxData(&u8s_AdcStreamFrame[u16s_AdcStreamSent],
+										u16s_AdcStreamSize - u16s_AdcStreamSent);
+}
@@ -0,0 +1,788 @@
+/**
+  ******************************************************************************
+  * @file           : drv_can.c
+  * @brief          : CANドライバー(CAN0)
+  ******************************************************************************
+  * @note   CAN0(CTX0:P103/D4, CRX0:P102/D5)をFIFOメールボックスモードで動作させる。
+  *         トランシーバーは外付けとし、内部ループバックでは不要。
+  *         - 受信はハードウェアのアクセプタンスフィルターで選別する。フィルター
+  *           0,1は受信FIFO(FIDCR0/1,MKR6/7)、2以降は受信メールボックス
+  *           (0,4,…,20番,MKR0～5)に割り当てる。IDは混在(標準/拡張)モード。
+  *         - 受信FIFOは3フレーム溜まった時点(バッファワーニング)で割り込み、
+  *           受信メールボックスはフレーム毎に割り込む。割り込みで受信リングに
+  *           移し、周期処理(canReceive)から取り出す。受信リングの書き込みは
+  *           割り込みだけが行うため、取り出し側は割り込みを禁止しない。
+  *           3フレームに満たない受信FIFOは周期処理で割り込みを保留にして
+  *           取り出させる(書き込み側を割り込みに限るため)。
+  *         - 送信は送信FIFO(4段)に書き込み、溢れた分は送信リングに置いて
+  *           送信完了の割り込みで補充する。
+  *         - バスオフはISO11898-1の手順で自動復帰し、canRecover()で強制復帰
+  *           できる。エラーカウンターと状態はcanGetStatus()で取得する。
+  *           エラーパッシブ中はバスエラー割り込みを止め、ACKの無いバスでの
+  *           再送毎の割り込みを避ける(エラーアクティブに戻れば再開する)。
+  *         ビットタイミングはPCLKBから求め、クロック変更後にCANリセット
+  *         モードで設定し直す(エラーカウンターは0に戻る)。送信待ちのフレームが
+  *         ある間はクロック変更を拒否する。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "drv.h"
+#include "lib.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define CAN_CEILING			(IRQ_PRIO_CAN0)			/* 送信リング/状態のシーリング(CAN0_ERS/RXF/TXF/RXM)	*/
+#define CAN_MODE_WAIT		(100000)				/* 動作モード遷移待ちの最大回数	*/
+#define CAN_TQ_MAX			(25)					/* 1bitのTq数(最大)				*/
+#define CAN_TQ_MIN			(8)						/* 1bitのTq数(最小)				*/
+#define CAN_TSEG1_MAX		(16)					/* TSEG1のTq数(最大)			*/
+#define CAN_SJW_MAX			(4)						/* SJWのTq数(最大)				*/
+#define CAN_BRP_MAX			(1024)					/* ボーレートプリスケーラ(最大)	*/
+#define CAN_MB_TX_FIFO		(24)					/* 送信FIFOのメールボックス		*/
+#define CAN_MB_RX_FIFO		(28)					/* 受信FIFOのメールボックス		*/
+#define CAN_MB_GROUP		(4)						/* マスクを共有するメールボックス数	*/
+#define CAN_FIFO_FILTERS	(2)						/* 受信FIFOのフィルター数		*/
+
+/* CTLR */
+#define CAN_CTLR_MBM		(0x0001)				/* FIFOメールボックスモード		*/
+#define CAN_CTLR_IDFM_MIXED	(0x0004)				/* ID混在モード					*/
+#define CAN_CTLR_MLM		(0x0008)				/* オーバーランモード(新しいメッセージを捨てる)	*/
+#define CAN_CTLR_CANM		(0x0300)				/* CAN動作モード				*/
+#define CAN_CTLR_CANM_OPER	(0x0000)				/* CAN動作モード				*/
+#define CAN_CTLR_CANM_RESET	(0x0100)				/* CANリセットモード			*/
+#define CAN_CTLR_CANM_HALT	(0x0200)				/* CAN Haltモード				*/
+#define CAN_CTLR_CANM_FORCE	(0x0300)				/* CANリセットモード(強制)		*/
+#define CAN_CTLR_SLPM		(0x0400)				/* CANスリープモード			*/
+#define CAN_CTLR_RBOC		(0x2000)				/* バスオフ強制復帰				*/
+/* STR */
+#define CAN_STR_EST			(0x0080)				/* エラー発生					*/
+#define CAN_STR_RSTST		(0x0100)				/* CANリセットモード中			*/
+#define CAN_STR_HLTST		(0x0200)				/* CAN Haltモード中				*/
+#define CAN_STR_SLPST		(0x0400)				/* CANスリープモード中			*/
+#define CAN_STR_EPST		(0x0800)				/* エラーパッシブ				*/
+#define CAN_STR_BOST		(0x1000)				/* バスオフ						*/
+/* MCTL */
+#define CAN_MCTL_NEWDATA	(0x01)					/* 受信完了						*/
+#define CAN_MCTL_INVALDATA	(0x02)					/* 受信データ更新中				*/
+#define CAN_MCTL_MSGLOST	(0x04)					/* メッセージロスト				*/
+#define CAN_MCTL_RECREQ		(0x40)					/* 受信要求						*/
+/* RFCR/TFCR */
+#define CAN_RFCR_RFE		(0x01)					/* 受信FIFO許可					*/
+#define CAN_RFCR_RFMLF		(0x10)					/* 受信FIFOメッセージロスト		*/
+#define CAN_RFCR_RFEST		(0x80)					/* 受信FIFO空					*/
+#define CAN_TFCR_TFE		(0x01)					/* 送信FIFO許可					*/
+#define CAN_TFCR_TFUST		(0x0E)					/* 送信FIFO未送信数				*/
+#define CAN_TFCR_TFUST_POS	(1)
+#define CAN_TFCR_TFFST		(0x40)					/* 送信FIFOフル					*/
+#define CAN_TFCR_TFEST		(0x80)					/* 送信FIFO空					*/
+#define CAN_FIFO_NEXT		(0xFF)					/* RFPCR/TFPCR: ポインター更新	*/
+/* EIER/EIFR */
+#define CAN_EI_BE			(0x01)					/* バスエラー					*/
+#define CAN_EI_EW			(0x02)					/* エラーワーニング				*/
+#define CAN_EI_EP			(0x04)					/* エラーパッシブ				*/
+#define CAN_EI_BOE			(0x08)					/* バスオフ開始					*/
+#define CAN_EI_BOR			(0x10)					/* バスオフ復帰					*/
+#define CAN_EI_OR			(0x20)					/* 受信オーバーラン				*/
+#define CAN_EI_ALL			(CAN_EI_BE | CAN_EI_EW | CAN_EI_EP | CAN_EI_BOE | CAN_EI_BOR | CAN_EI_OR)
+#define CAN_ECSR_ERRORS		(0x7F)					/* エラーコード(スタッフ～ADエラー)	*/
+/* MSSR */
+#define CAN_MSSR_MBNST		(0x1F)					/* 検索結果のメールボックス番号	*/
+#define CAN_MSSR_SEST		(0x80)					/* 検索結果なし					*/
+/* MIER(FIFOメールボックスモード) */
+#define CAN_MIER_TX_FIFO	(0x01000000UL)			/* 送信FIFO割り込み許可(送信完了毎)	*/
+#define CAN_MIER_RX_FIFO	(0x10000000UL)			/* 受信FIFO割り込み許可			*/
+#define CAN_MIER_RX_WARN	(0x20000000UL)			/* 受信FIFOはバッファワーニングで割り込み	*/
+/* TCR */
+#define CAN_TCR_LISTEN		(0x03)					/* TSTE + リッスンオンリー		*/
+#define CAN_TCR_LOOPBACK	(0x07)					/* TSTE + 内部ループバック		*/
+/* BCR */
+#define CAN_BCR_TSEG1_POS	(28)
+#define CAN_BCR_BRP_POS		(16)
+#define CAN_BCR_SJW_POS		(12)
+#define CAN_BCR_TSEG2_POS	(8)
+/* メールボックスのID */
+#define CAN_MB_IDE			(0x80000000UL)			/* 拡張ID						*/
+#define CAN_MB_RTR			(0x40000000UL)			/* リモートフレーム				*/
+#define CAN_MB_SID_POS		(18)					/* 標準IDの位置					*/
+/* PmnPFS */
+#define CAN_PFS_PSEL		(0b10000)				/* CAN							*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static CanFrame sts_CanRxRing[CAN_RX_RING_SIZE];			/* 受信リング					*/
+volatile static uint8_t u8s_CanRxHead;						/* 次に書き込む位置(割り込みだけが更新)	*/
+volatile static uint8_t u8s_CanRxTail;						/* 次に取り出す位置(周期処理だけが更新)	*/
+static CanFrame sts_CanTxRing[CAN_TX_RING_SIZE];			/* 送信リング(送信FIFOの待ち)	*/
+volatile static uint8_t u8s_CanTxHead;						/* 次に登録する位置				*/
+volatile static uint8_t u8s_CanTxTail;						/* 次に送信FIFOへ移す位置		*/
+volatile static uint8_t u8s_CanTxInFifo;					/* 送信FIFOに書き込んだ未完了数	*/
+static CanConfig sts_CanConfig;								/* 動作中の設定					*/
+static CanFilter sts_CanFilters[CAN_FILTER_MAX];			/* 動作中のフィルター			*/
+static uint32_t u32s_CanRxMailboxes;						/* 受信に使うメールボックス(bit)	*/
+static bool bls_CanStarted;									/* 通信中						*/
+static CanStatus sts_CanStatus;								/* 統計情報						*/
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t can_configure(void);							/* 設定をレジスタに反映して通信を開始する	*/
+static uint8_t can_set_mode(uint16_t u16_Mode);				/* CAN動作モードを切り替える	*/
+static uint32_t can_calc_timing(uint32_t u32_Pclkb, uint32_t u32_Bitrate);	/* ビットタイミングを求める	*/
+static uint32_t can_to_mb_id(uint32_t u32_Id);				/* IDをメールボックスの形式にする	*/
+static uint32_t can_to_mb_mask(const CanFilter *pst_Filter);	/* マスクをMKRの形式にする	*/
+static void can_write_mb(uint8_t u8_Mb, const CanFrame *pst_Frame);	/* メールボックスに書き込む	*/
+static void can_read_mb(uint8_t u8_Mb, CanFrame *pst_Frame);	/* メールボックスから読み出す	*/
+static void can_rx_push(const CanFrame *pst_Frame);			/* 受信リングに書き込む			*/
+static void can_tx_refill(void);							/* 送信リングから送信FIFOへ移す	*/
+static uint8_t can_clock_callback(uint8_t u8_Event, uint8_t u8_Mode);	/* クロック変更コールバック	*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  CAN0エラー割り込みハンドラ
+  * @param  None
+  * @retval None
+  */
+void CAN0_ERS_Handler(void)
+{
+	uint8_t u8_Flags;
+	uint8_t u8_Code;
+
+	/* 割り込み要求フラグ クリア */
+	R_ICU->IELSR_b[IRQ_CAN0_ERS].IR = 0;
+	sts_CanStatus.u32_irqs++;
+
+	u8_Flags = R_CAN0->EIFR;
+	R_CAN0->EIFR = (uint8_t)~u8_Flags;					// 0の書き込みで解除
+	u8_Code = R_CAN0->ECSR & CAN_ECSR_ERRORS;
+	R_CAN0->ECSR = (uint8_t)~u8_Code;
+	sts_CanStatus.u8_error_code |= u8_Code;
+	if (u8_Flags & CAN_EI_BE) {
+		sts_CanStatus.u32_bus_errors++;
+	}
+	if (u8_Flags & CAN_EI_EP) {
+		sts_CanStatus.u32_passives++;
+	}
+	if (R_CAN0->STR & (CAN_STR_EPST | CAN_STR_BOST)) {
+		R_CAN0->EIER = CAN_EI_ALL & (uint8_t)~CAN_EI_BE;
+	}
+	if (u8_Flags & CAN_EI_BOE) {
+		sts_CanStatus.u32_busoffs++;
+	}
+	if (u8_Flags & CAN_EI_BOR) {
+		sts_CanStatus.u32_recoveries++;
+	}
+	if (u8_Flags & CAN_EI_OR) {
+		sts_CanStatus.u32_rx_lost++;
+	}
+}
+
+/**
+  * @brief  CAN0受信FIFO割り込みハンドラ
+  * @param  None
+  * @retval None
+  * @note   受信FIFOが空になるまで受信リングに移す
+  */
+void CAN0_RXF_Handler(void)
+{
+	CanFrame st_Frame;
+
+	/* 割り込み要求フラグ クリア */
+	R_ICU->IELSR_b[IRQ_CAN0_RXF].IR = 0;
+	sts_CanStatus.u32_irqs++;
+
+	while ((R_CAN0->RFCR & CAN_RFCR_RFEST) == 0) {
+		can_read_mb(CAN_MB_RX_FIFO, &st_Frame);
+		R_CAN0->RFPCR = CAN_FIFO_NEXT;
+		can_rx_push(&st_Frame);
+	}
+	if (R_CAN0->RFCR & CAN_RFCR_RFMLF) {
+		/* 受信FIFOが一杯で捨てられた */
+		sts_CanStatus.u32_rx_lost++;
+		R_CAN0->RFCR = CAN_RFCR_RFE;
+	}
+}
+
+/**
+  * @brief  CAN0送信FIFO割り込みハンドラ
+  * @param  None
+  * @retval None
+  * @note   送信完了毎に発生し、送信リングから送信FIFOを補充する
+  */
+void CAN0_TXF_Handler(void)
+{
+	uint8_t u8_Unsent;
+
+	/* 割り込み要求フラグ クリア */
+	R_ICU->IELSR_b[IRQ_CAN0_TXF].IR = 0;
+	sts_CanStatus.u32_irqs++;
+
+	/* 割り込みがまとまった場合も未送信数の差で完了数を数える */
+	u8_Unsent = (uint8_t)((R_CAN0->TFCR & CAN_TFCR_TFUST) >> CAN_TFCR_TFUST_POS);
+	sts_CanStatus.u32_tx_frames += (uint32_t)(u8s_CanTxInFifo - u8_Unsent);
+	u8s_CanTxInFifo = u8_Unsent;
+	can_tx_refill();
+}
+
+/**
+  * @brief  CAN0メールボックス受信割り込みハンドラ
+  * @param  None
+  * @retval None
+  * @note   受信メールボックス検索(MSSR)で新しいデータのあるメールボックスを
+  *         番号順に受信リングに移す
+  */
+void CAN0_RXM_Handler(void)
+{
+	CanFrame st_Frame;
+	uint8_t u8_Search;
+	uint8_t u8_Mb;
+
+	/* 割り込み要求フラグ クリア */
+	R_ICU->IELSR_b[IRQ_CAN0_RXM].IR = 0;
+	sts_CanStatus.u32_irqs++;
+
+	while (((u8_Search = R_CAN0->MSSR) & CAN_MSSR_SEST) == 0) {
+		u8_Mb = u8_Search & CAN_MSSR_MBNST;
+		if (R_CAN0->MCTL_RX[u8_Mb] & CAN_MCTL_MSGLOST) {
+			sts_CanStatus.u32_rx_lost++;
+		}
+		/* NEWDATAを解除してから読み出し、読み出し中に更新されていれば読み直す */
+		R_CAN0->MCTL_RX[u8_Mb] = CAN_MCTL_RECREQ;
+		can_read_mb(u8_Mb, &st_Frame);
+		if ((R_CAN0->MCTL_RX[u8_Mb] & (CAN_MCTL_NEWDATA | CAN_MCTL_INVALDATA)) == 0) {
+			can_rx_push(&st_Frame);
+		}
+	}
+}
+
+/**
+  * @brief  CANドライバー初期化処理
+  * @param  None
+  * @retval None
+  * @note   端子とCAN0を準備してCANリセットモードで待機する(canStart()で開始)
+  */
+void taskCanDriverInit(void)
+{
+	uint32_t u32_Mask;
+
+	mem_set08((uint8_t *)&sts_CanStatus, 0x00, sizeof(sts_CanStatus));
+	u8s_CanRxHead = 0;
+	u8s_CanRxTail = 0;
+	u8s_CanTxHead = 0;
+	u8s_CanTxTail = 0;
+	u8s_CanTxInFifo = 0;
+	bls_CanStarted = false;
+
+	/* ---- ベクターテーブル登録 ---- */
+	u32_Mask = LL_IRQ_Lock(CAN_CEILING);
+	NVIC_SetVector((IRQn_Type)IRQ_CAN0_ERS, (uintptr_t)CAN0_ERS_Handler);
+	NVIC_SetVector((IRQn_Type)IRQ_CAN0_RXF, (uintptr_t)CAN0_RXF_Handler);
+	NVIC_SetVector((IRQn_Type)IRQ_CAN0_TXF, (uintptr_t)CAN0_TXF_Handler);
+	NVIC_SetVector((IRQn_Type)IRQ_CAN0_RXM, (uintptr_t)CAN0_RXM_Handler);
+	LL_IRQ_Unlock(u32_Mask);
+
+	/* ---- CAN0_ERS/RXF/TXF/RXM 無効 ---- */
+	R_ICU->IELSR[IRQ_CAN0_ERS] = 0x00000000;
+	R_ICU->IELSR[IRQ_CAN0_RXF] = 0x00000000;
+	R_ICU->IELSR[IRQ_CAN0_TXF] = 0x00000000;
+	R_ICU->IELSR[IRQ_CAN0_RXM] = 0x00000000;
+
+	/* ---- CAN0 モジュールストップ解除 ---- */
+	R_MSTP->MSTPCRB_b.MSTPB2 = 0;					// CAN0 ON
+
+	/* ---- ポート設定 ---- */
+	// 書き込みプロテクト解除
+	R_BSP_PinAccessEnable();
+	// P103 = CTX0, P102 = CRX0
+	R_PFS->PORT[1].PIN[3].PmnPFS_b.PSEL = CAN_PFS_PSEL;		// CTX0
+	R_PFS->PORT[1].PIN[2].PmnPFS_b.PSEL = CAN_PFS_PSEL;		// CRX0
+	R_PFS->PORT[1].PIN[3].PmnPFS_b.PMR = 1;
+	R_PFS->PORT[1].PIN[2].PmnPFS_b.PMR = 1;
+	// 書き込みプロテクト施錠
+	R_BSP_PinAccessDisable();
+
+	/* ---- CANスリープモード解除 → CANリセットモード ---- */
+	R_CAN0->CTLR = CAN_CTLR_CANM_RESET;
+	(void)can_set_mode(CAN_CTLR_CANM_RESET);
+
+	/* ---- ICU → NVIC 割り込み割り当て ---- */
+	R_ICU->IELSR_b[IRQ_CAN0_ERS].IR = 0;			// 割り込み要求フラグ クリア
+	R_ICU->IELSR_b[IRQ_CAN0_ERS].IELS = ELC_EVENT_CAN0_ERROR;
+	R_ICU->IELSR_b[IRQ_CAN0_RXF].IR = 0;
+	R_ICU->IELSR_b[IRQ_CAN0_RXF].IELS = ELC_EVENT_CAN0_FIFO_RX;
+	R_ICU->IELSR_b[IRQ_CAN0_TXF].IR = 0;
+	R_ICU->IELSR_b[IRQ_CAN0_TXF].IELS = ELC_EVENT_CAN0_FIFO_TX;
+	R_ICU->IELSR_b[IRQ_CAN0_RXM].IR = 0;
+	R_ICU->IELSR_b[IRQ_CAN0_RXM].IELS = ELC_EVENT_CAN0_MAILBOX_RX;
+
+	/* ---- NVIC 設定 ---- */
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_CAN0_ERS);
+	NVIC_SetPriority((IRQn_Type)IRQ_CAN0_ERS, IRQ_PRIO_CAN0);
+	NVIC_EnableIRQ((IRQn_Type)IRQ_CAN0_ERS);
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_CAN0_RXF);
+	NVIC_SetPriority((IRQn_Type)IRQ_CAN0_RXF, IRQ_PRIO_CAN0);
+	NVIC_EnableIRQ((IRQn_Type)IRQ_CAN0_RXF);
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_CAN0_TXF);
+	NVIC_SetPriority((IRQn_Type)IRQ_CAN0_TXF, IRQ_PRIO_CAN0);
+	NVIC_EnableIRQ((IRQn_Type)IRQ_CAN0_TXF);
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_CAN0_RXM);
+	NVIC_SetPriority((IRQn_Type)IRQ_CAN0_RXM, IRQ_PRIO_CAN0);
+	NVIC_EnableIRQ((IRQn_Type)IRQ_CAN0_RXM);
+
+	/* ---- クロック変更の通知先を登録する ---- */
+	if (clockRegisterCallback(can_clock_callback) != OK) {
+		Error_Handler();
+	}
+}
+
+/**
+  * @brief  CANドライバー入力処理
+  * @param  None
+  * @retval None
+  * @note   バッファワーニングに達していない受信FIFOのフレームを取り出すため
+  *         受信FIFO割り込みを保留にする。エラーアクティブに戻っていれば
+  *         バスエラー割り込みを再開する
+  */
+void taskCanDriverInput(void)
+{
+	if (!bls_CanStarted) {
+		return;
+	}
+	if ((R_CAN0->RFCR & CAN_RFCR_RFEST) == 0) {
+		NVIC_SetPendingIRQ((IRQn_Type)IRQ_CAN0_RXF);
+	}
+	if (((R_CAN0->EIER & CAN_EI_BE) == 0) && ((R_CAN0->STR & (CAN_STR_EPST | CAN_STR_BOST)) == 0)) {
+		R_CAN0->EIER = CAN_EI_ALL;
+	}
+}
+
+/**
+  * @brief  CAN通信を開始する
+  * @param  pst_Config: 設定(フィルターは内容をコピーする)
+  * @retval OK/NG(設定不正,ビットタイミングを作れない,動作モードの遷移失敗)
+  */
+uint8_t canStart(const CanConfig *pst_Config)
+{
+	uint8_t _i;
+
+	if ((pst_Config->u32_bitrate == 0) || (pst_Config->u8_mode > CAN_MODE_LOOPBACK)
+	 || (pst_Config->u8_filter_num > CAN_FILTER_MAX)
+	 || ((pst_Config->u8_filter_num > 0) && (pst_Config->pst_filters == NULL))) {
+		return NG;
+	}
+	canStop();
+	sts_CanConfig = *pst_Config;
+	for (_i=0; _i<pst_Config->u8_filter_num; _i++) {
+		sts_CanFilters[_i] = pst_Config->pst_filters[_i];
+	}
+	sts_CanConfig.pst_filters = &sts_CanFilters[0];
+	return can_configure();
+}
+
+/**
+  * @brief  CAN通信を停止する
+  * @param  None
+  * @retval None
+  * @note   送信待ちのフレームは破棄する。受信リングのフレームは取り出せる
+  */
+void canStop(void)
+{
+	uint32_t u32_Mask;
+
+	u32_Mask = LL_IRQ_Lock(CAN_CEILING);
+	bls_CanStarted = false;
+	sts_CanConfig.u32_bitrate = 0;						// クロック変更後も再開しない
+	(void)can_set_mode(CAN_CTLR_CANM_FORCE);
+	u8s_CanTxTail = u8s_CanTxHead;
+	u8s_CanTxInFifo = 0;
+	LL_IRQ_Unlock(u32_Mask);
+}
+
+/**
+  * @brief  CANフレームを送信する
+  * @param  pst_Frame: フレーム
+  * @retval OK/NG(停止中,リッスンオンリー,送信リングが一杯)
+  */
+uint8_t canSend(const CanFrame *pst_Frame)
+{
+	uint8_t u8_Result = OK;
+	uint32_t u32_Mask;
+
+	if (!bls_CanStarted || (sts_CanConfig.u8_mode == CAN_MODE_LISTEN) || (pst_Frame->u8_dlc > 8)) {
+		return NG;
+	}
+	u32_Mask = LL_IRQ_Lock(CAN_CEILING);
+	if ((uint8_t)(u8s_CanTxHead - u8s_CanTxTail) >= CAN_TX_RING_SIZE) {
+		u8_Result = NG;
+	}
+	else {
+		sts_CanTxRing[u8s_CanTxHead % CAN_TX_RING_SIZE] = *pst_Frame;
+		u8s_CanTxHead++;
+		can_tx_refill();
+	}
+	LL_IRQ_Unlock(u32_Mask);
+	return u8_Result;
+}
+
+/**
+  * @brief  受信したCANフレームを取り出す
+  * @param  pst_Frame: フレームの格納先
+  * @retval OK/NG(受信フレームなし)
+  */
+uint8_t canReceive(CanFrame *pst_Frame)
+{
+	uint8_t u8_Tail = u8s_CanRxTail;
+
+	if (u8_Tail == u8s_CanRxHead) {
+		return NG;
+	}
+	*pst_Frame = sts_CanRxRing[u8_Tail % CAN_RX_RING_SIZE];
+	__DMB();											// 読み出してから領域を返す
+	u8s_CanRxTail = (uint8_t)(u8_Tail + 1);
+	return OK;
+}
+
+/**
+  * @brief  バスオフから強制復帰する
+  * @param  None
+  * @retval OK/NG(バスオフではない)
+  * @note   128×11bitのレセシブ検出を待たずにエラーアクティブに戻る
+  */
+uint8_t canRecover(void)
+{
+	if (!bls_CanStarted || ((R_CAN0->STR & CAN_STR_BOST) == 0)) {
+		return NG;
+	}
+	R_CAN0->CTLR |= CAN_CTLR_RBOC;
+	return OK;
+}
+
+/**
+  * @brief  CAN状態と統計情報を取得する
+  * @param  pst_Status: 格納先
+  * @retval None
+  */
+void canGetStatus(CanStatus *pst_Status)
+{
+	uint16_t u16_Str;
+	uint32_t u32_Mask;
+
+	u32_Mask = LL_IRQ_Lock(CAN_CEILING);
+	*pst_Status = sts_CanStatus;
+	pst_Status->u8_tx_pending = (uint8_t)((uint8_t)(u8s_CanTxHead - u8s_CanTxTail) + u8s_CanTxInFifo);
+	LL_IRQ_Unlock(u32_Mask);
+	pst_Status->u8_tec = R_CAN0->TECR;
+	pst_Status->u8_rec = R_CAN0->RECR;
+	u16_Str = R_CAN0->STR;
+	if (!bls_CanStarted) {
+		pst_Status->u8_state = CAN_STATE_STOPPED;
+	}
+	else if (u16_Str & CAN_STR_BOST) {
+		pst_Status->u8_state = CAN_STATE_BUSOFF;
+	}
+	else if (u16_Str & CAN_STR_EPST) {
+		pst_Status->u8_state = CAN_STATE_PASSIVE;
+	}
+	else if ((pst_Status->u8_tec >= 96) || (pst_Status->u8_rec >= 96)) {
+		pst_Status->u8_state = CAN_STATE_WARNING;
+	}
+	else {
+		pst_Status->u8_state = CAN_STATE_ACTIVE;
+	}
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  設定をレジスタに反映して通信を開始する
+  * @param  None
+  * @retval OK/NG
+  * @note   CANリセットモードで設定し、テストモードはCAN Haltモードで設定する
+  */
+static uint8_t can_configure(void)
+{
+	const CanFilter *pst_Filter;
+	CanFilter st_Any[CAN_FIFO_FILTERS] = {{0, 0}, {CAN_ID_EXT, 0}};
+	uint32_t u32_Bcr;
+	uint32_t u32_Mier = CAN_MIER_TX_FIFO | CAN_MIER_RX_FIFO | CAN_MIER_RX_WARN;
+	uint8_t u8_Mb;
+	uint8_t _i;
+
+	bls_CanStarted = false;
+	sts_CanStatus.u32_bitrate = 0;
+	u32_Bcr = can_calc_timing(R_FSP_SystemClockHzGet(FSP_PRIV_CLOCK_PCLKB), sts_CanConfig.u32_bitrate);
+	if ((u32_Bcr == 0) || (can_set_mode(CAN_CTLR_CANM_RESET) != OK)) {
+		return NG;
+	}
+
+	/* ---- CANリセットモードで設定する ---- */
+	R_CAN0->CTLR = CAN_CTLR_CANM_RESET | CAN_CTLR_MBM | CAN_CTLR_IDFM_MIXED | CAN_CTLR_MLM;
+	R_CAN0->BCR = u32_Bcr;
+	R_CAN0->MKIVLR = 0x00000000;						// 全てのマスクを有効
+	// 受信FIFO: フィルター0,1(1つだけの場合は同じ条件,無ければ全て受信)
+	for (_i=0; _i<CAN_FIFO_FILTERS; _i++) {
+		if (sts_CanConfig.u8_filter_num == 0) {
+			pst_Filter = &st_Any[_i];
+		}
+		else {
+			pst_Filter = &sts_CanConfig.pst_filters[(_i < sts_CanConfig.u8_filter_num) ? _i : 0];
+		}
+		R_CAN0->FIDCR[_i] = can_to_mb_id(pst_Filter->u32_id);
+		R_CAN0->MKR[6 + _i] = can_to_mb_mask(pst_Filter);
+	}
+	// 受信メールボックス: フィルター2以降(マスクを共有する組の先頭を使う)
+	u32s_CanRxMailboxes = 0;
+	for (_i=CAN_FIFO_FILTERS; _i<sts_CanConfig.u8_filter_num; _i++) {
+		pst_Filter = &sts_CanConfig.pst_filters[_i];
+		u8_Mb = (uint8_t)((_i - CAN_FIFO_FILTERS) * CAN_MB_GROUP);
+		R_CAN0->MB[u8_Mb].ID = can_to_mb_id(pst_Filter->u32_id);
+		R_CAN0->MKR[u8_Mb / CAN_MB_GROUP] = can_to_mb_mask(pst_Filter);
+		u32s_CanRxMailboxes |= 1UL << u8_Mb;
+	}
+	R_CAN0->MIER = u32_Mier | u32s_CanRxMailboxes;
+	R_CAN0->MSMR = 0x00;								// 受信メールボックス検索
+	R_CAN0->EIER = CAN_EI_ALL;
+
+	/* ---- テストモード(CAN Haltモードで設定する) ---- */
+	if (sts_CanConfig.u8_mode != CAN_MODE_NORMAL) {
+		if (can_set_mode(CAN_CTLR_CANM_HALT) != OK) {
+			return NG;
+		}
+		R_CAN0->TCR = (sts_CanConfig.u8_mode == CAN_MODE_LOOPBACK) ? CAN_TCR_LOOPBACK : CAN_TCR_LISTEN;
+	}
+	else {
+		R_CAN0->TCR = 0x00;
+	}
+
+	/* ---- CAN動作モードで受信/送信を許可する ---- */
+	if (can_set_mode(CAN_CTLR_CANM_OPER) != OK) {
+		return NG;
+	}
+	R_CAN0->EIFR = 0x00;
+	R_CAN0->ECSR = 0x00;
+	for (u8_Mb=0; u8_Mb<CAN_MB_TX_FIFO; u8_Mb++) {
+		if (u32s_CanRxMailboxes & (1UL << u8_Mb)) {
+			R_CAN0->MCTL_RX[u8_Mb] = CAN_MCTL_RECREQ;
+		}
+	}
+	R_CAN0->RFCR = CAN_RFCR_RFE;
+	R_CAN0->TFCR = CAN_TFCR_TFE;
+	sts_CanStatus.u32_bitrate = sts_CanConfig.u32_bitrate;
+	u8s_CanTxInFifo = 0;
+	bls_CanStarted = true;
+	can_tx_refill();
+	return OK;
+}
+
+/**
+  * @brief  CAN動作モードを切り替える
+  * @param  u16_Mode: CAN_CTLR_CANM_xxx
+  * @retval OK/NG(遷移しない)
+  * @note   CAN Haltモードへはバスが空くまで遷移しない
+  */
+static uint8_t can_set_mode(uint16_t u16_Mode)
+{
+	uint16_t u16_Expect;
+	uint16_t u16_Str;
+	uint32_t _i;
+
+	R_CAN0->CTLR = (uint16_t)((R_CAN0->CTLR & (uint16_t)~(CAN_CTLR_CANM | CAN_CTLR_SLPM)) | u16_Mode);
+	switch (u16_Mode) {
+	case CAN_CTLR_CANM_OPER:
+		u16_Expect = 0;
+		break;
+	case CAN_CTLR_CANM_HALT:
+		u16_Expect = CAN_STR_HLTST;
+		break;
+	default:
+		u16_Expect = CAN_STR_RSTST;
+		break;
+	}
+	for (_i=0; _i<CAN_MODE_WAIT; _i++) {
+		u16_Str = R_CAN0->STR;
+		if ((u16_Str & (CAN_STR_RSTST | CAN_STR_HLTST | CAN_STR_SLPST)) == u16_Expect) {
+			return OK;
+		}
+	}
+	return NG;
+}
+
+/**
+  * @brief  ビットタイミングを求める
+  * @param  u32_Pclkb: CANクロック(PCLKB)[Hz]
+  * @param  u32_Bitrate: 通信速度[bps]
+  * @retval BCRの値(0:作れない)
+  * @note   割り切れる組み合わせのうちTq数の多いものを選び、サンプル点を
+  *         約80%にする(TSEG1 ≦ 16Tq, TSEG2 ≧ 2Tq, SJW ≦ min(4, TSEG2))
+  */
+static uint32_t can_calc_timing(uint32_t u32_Pclkb, uint32_t u32_Bitrate)
+{
+	uint32_t u32_Tq;
+	uint32_t u32_Brp;
+	uint32_t u32_Tseg1;
+	uint32_t u32_Tseg2;
+	uint32_t u32_Sjw;
+
+	for (u32_Tq=CAN_TQ_MAX; u32_Tq>=CAN_TQ_MIN; u32_Tq--) {
+		if ((u32_Pclkb % (u32_Bitrate * u32_Tq)) != 0) {
+			continue;
+		}
+		u32_Brp = u32_Pclkb / (u32_Bitrate * u32_Tq);
+		u32_Tseg2 = (u32_Tq + 2) / 5;
+		if (u32_Tseg2 < 2) {
+			u32_Tseg2 = 2;
+		}
+		u32_Tseg1 = u32_Tq - 1 - u32_Tseg2;
+		if ((u32_Brp == 0) || (u32_Brp > CAN_BRP_MAX) || (u32_Tseg1 > CAN_TSEG1_MAX)) {
+			continue;
+		}
+		u32_Sjw = (u32_Tseg2 < CAN_SJW_MAX) ? u32_Tseg2 : CAN_SJW_MAX;
+		return ((u32_Tseg1 - 1) << CAN_BCR_TSEG1_POS) | ((u32_Brp - 1) << CAN_BCR_BRP_POS)
+			| ((u32_Sjw - 1) << CAN_BCR_SJW_POS) | ((u32_Tseg2 - 1) << CAN_BCR_TSEG2_POS);
+	}
+	return 0;
+}
+
+/**
+  * @brief  IDをメールボックスの形式にする
+  * @param  u32_Id: ID(CAN_ID_EXTで拡張ID)
+  * @retval メールボックスのID(IDE/SID/EID)
+  */
+static uint32_t can_to_mb_id(uint32_t u32_Id)
+{
+	if (u32_Id & CAN_ID_EXT) {
+		return CAN_MB_IDE | (u32_Id & CAN_ID_EXT_MASK);
+	}
+	return (u32_Id & CAN_ID_STD_MASK) << CAN_MB_SID_POS;
+}
+
+/**
+  * @brief  マスクをMKRの形式にする
+  * @param  pst_Filter: フィルター
+  * @retval MKRの値(IDと同じ種類のbit配置)
+  */
+static uint32_t can_to_mb_mask(const CanFilter *pst_Filter)
+{
+	return can_to_mb_id((pst_Filter->u32_id & CAN_ID_EXT) | pst_Filter->u32_mask) & (uint32_t)~CAN_MB_IDE;
+}
+
+/**
+  * @brief  メールボックスに書き込む
+  * @param  u8_Mb: メールボックス番号
+  * @param  pst_Frame: フレーム
+  * @retval None
+  */
+static void can_write_mb(uint8_t u8_Mb, const CanFrame *pst_Frame)
+{
+	volatile R_CAN0_MB_Type *pst_Mb = &R_CAN0->MB[u8_Mb];
+	uint8_t _i;
+
+	pst_Mb->ID = can_to_mb_id(pst_Frame->u32_id) | ((pst_Frame->u8_flags & CAN_FLAG_RTR) ? CAN_MB_RTR : 0);
+	pst_Mb->DL = pst_Frame->u8_dlc;
+	for (_i=0; _i<pst_Frame->u8_dlc; _i++) {
+		pst_Mb->D[_i] = pst_Frame->u8_data[_i];
+	}
+}
+
+/**
+  * @brief  メールボックスから読み出す
+  * @param  u8_Mb: メールボックス番号
+  * @param  pst_Frame: 格納先
+  * @retval None
+  */
+static void can_read_mb(uint8_t u8_Mb, CanFrame *pst_Frame)
+{
+	volatile R_CAN0_MB_Type *pst_Mb = &R_CAN0->MB[u8_Mb];
+	uint32_t u32_Id = pst_Mb->ID;
+	uint8_t _i;
+
+	if (u32_Id & CAN_MB_IDE) {
+		pst_Frame->u32_id = CAN_ID_EXT | (u32_Id & CAN_ID_EXT_MASK);
+	}
+	else {
+		pst_Frame->u32_id = (u32_Id >> CAN_MB_SID_POS) & CAN_ID_STD_MASK;
+	}
+	pst_Frame->u8_flags = (u32_Id & CAN_MB_RTR) ? CAN_FLAG_RTR : 0;
+	pst_Frame->u8_dlc = (uint8_t)(pst_Mb->DL & 0x0F);
+	if (pst_Frame->u8_dlc > 8) {
+		pst_Frame->u8_dlc = 8;
+	}
+	for (_i=0; _i<8; _i++) {
+		pst_Frame->u8_data[_i] = pst_Mb->D[_i];
+	}
+	pst_Frame->u16_timestamp = pst_Mb->TS;
+}
+
+/**
+  * @brief  受信リングに書き込む
+  * @param  pst_Frame: フレーム
+  * @retval None
+  * @note   割り込みからだけ呼び出す(単一の書き込み側)
+  */
+static void can_rx_push(const CanFrame *pst_Frame)
+{
+	uint8_t u8_Head = u8s_CanRxHead;
+	uint8_t u8_Used = (uint8_t)(u8_Head - u8s_CanRxTail);
+
+	if (u8_Used >= CAN_RX_RING_SIZE) {
+		sts_CanStatus.u32_rx_dropped++;
+		return;
+	}
+	sts_CanRxRing[u8_Head % CAN_RX_RING_SIZE] = *pst_Frame;
+	__DMB();											// 書き込んでから公開する
+	u8s_CanRxHead = (uint8_t)(u8_Head + 1);
+	sts_CanStatus.u32_rx_frames++;
+	if ((uint8_t)(u8_Used + 1) > sts_CanStatus.u8_rx_peak) {
+		sts_CanStatus.u8_rx_peak = (uint8_t)(u8_Used + 1);
+	}
+}
+
+/**
+  * @brief  送信リングから送信FIFOへ移す
+  * @param  None
+  * @retval None
+  * @note   CAN_CEILINGの禁止区間または割り込みから呼び出す
+  */
+static void can_tx_refill(void)
+{
+	if (!bls_CanStarted) {
+		return;
+	}
+	while ((u8s_CanTxTail != u8s_CanTxHead) && ((R_CAN0->TFCR & CAN_TFCR_TFFST) == 0)) {
+		can_write_mb(CAN_MB_TX_FIFO, &sts_CanTxRing[u8s_CanTxTail % CAN_TX_RING_SIZE]);
+		R_CAN0->TFPCR = CAN_FIFO_NEXT;
+		u8s_CanTxTail++;
+		u8s_CanTxInFifo++;
+	}
+}
+
+/**
+  * @brief  クロック変更コールバック
+  * @param  u8_Event: CLOCK_EVENT_xxx
+  * @param  u8_Mode: 切り替え先の動作モード
+  * @retval OK/NG(送信待ちのフレームがある)
+  * @note   切り替え後はPCLKBに合わせてビットタイミングを設定し直す。
+  *         作れない場合は停止し(u32_bitrate=0)、次の切り替えで再開する
+  */
+static uint8_t can_clock_callback(uint8_t u8_Event, uint8_t u8_Mode)
+{
+	(void)u8_Mode;
+	switch (u8_Event) {
+	case CLOCK_EVENT_PRE:
+		if (bls_CanStarted
+		 && ((u8s_CanTxTail != u8s_CanTxHead) || ((R_CAN0->TFCR & CAN_TFCR_TFEST) == 0))) {
+			return NG;
+		}
+		break;
+	case CLOCK_EVENT_POST:
+		if (sts_CanConfig.u32_bitrate != 0) {
+			(void)can_configure();
+		}
+		break;
+	default:
+		break;
+	}
+	return OK;
+}
@@ -0,0 +1,416 @@
+/**
+  ******************************************************************************
+  * @file           : drv_clock.c
+  * @brief          : クロック管理ドライバー
+  ******************************************************************************
+  * @note   システムクロック(ICLK)と周辺クロック(PCLKA～PCLKD,FCLK)を
+  *         動作モード(CLOCK_MODE_xxx)単位で切り替える。
+  *         - 切り替えの前に登録ドライバーへ確認(CLOCK_EVENT_PRE)し、1つでも
+  *           NGなら中止する。切り替えは割り込み禁止で行い、動作電力モード
+  *           (OPCCR),メモリウェイト(MEMWAIT),フラッシュキャッシュを
+  *           周波数の上げ下げに合わせた順序で変更した後、登録ドライバーへ
+  *           通知(CLOCK_EVENT_POST)して分周比等を設定し直させる。
+  *         - 自動(CLOCK_MODE_AUTO)では周期処理の負荷を毎周期計測し、高負荷で
+  *           すぐに高速モードへ戻し、低速でも余裕がある状態が続けば1段下げる。
+  *         - HOCOはUSBのクロック源のため停止しない。UNO R4 Minimaは
+  *           メイン発振子が無いためPLLは使用せず、LOCO(32.768kHz)は
+  *           SCIの9600bpsと5msの周期処理を維持できないため使用しない。
+  *         - 消費電流はデータシートの代表値からの目安(要実測)とし、
+  *           常に高速モードで動作した場合との比で省電力効果を示す。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "drv.h"
+#include "lib.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* 動作モード設定 */
+typedef struct _ClockModeInfo {
+	uint8_t u8_sckscr;				/* クロックソース(SCKSCR)				*/
+	uint32_t u32_sckdivcr;			/* 分周比(SCKDIVCR)						*/
+	uint8_t u8_opccr;				/* 動作電力モード(OPCCR)				*/
+	uint8_t u8_memwait;				/* メモリウェイト(MEMWAIT)				*/
+	uint32_t u32_iclk;				/* ICLK[Hz]								*/
+	uint16_t u16_current_ua;		/* 消費電流の目安[uA]					*/
+} ClockModeInfo;
+
+/* Private define ------------------------------------------------------------*/
+#define CLOCK_SRC_HOCO		(0x00)					/* SCKSCR: HOCO					*/
+#define CLOCK_SRC_MOCO		(0x01)					/* SCKSCR: MOCO					*/
+#define CLOCK_OPCCR_HIGH	(0x00)					/* OPCCR: 高速モード			*/
+#define CLOCK_OPCCR_MIDDLE	(0x01)					/* OPCCR: 中速モード(ICLK 12MHz以下)	*/
+#define CLOCK_OPCCR_OPCM	(0x03)					/* OPCCR.OPCM					*/
+#define CLOCK_OPCCR_OPCMTSF	(0x10)					/* OPCCR: 遷移中				*/
+#define CLOCK_OSCSF_HOCOSF	(0x01)					/* OSCSF: HOCO発振安定			*/
+#define CLOCK_MOCO_WAIT_US	(15)					/* MOCO発振安定待ち[us]			*/
+#define CLOCK_LOAD_UP		(700)					/* 高速モードへ戻す負荷[0.1%]	*/
+#define CLOCK_LOAD_DOWN		(500)					/* 1段下げる予測負荷[0.1%]		*/
+#define CLOCK_DOWN_CYCLES	(20)					/* 1段下げるまでの継続周期数	*/
+
+/* 登録ドライバー数(SysTick,WDT,UART,ADC,EXTI,IIC,SPI,CAN,LAT,ESP,MATRIX) */
+/* 通知先を登録するドライバーを追加した場合はこの数も増やすこと */
+#define CLOCK_CALLBACK_USERS	(11)
+
+_Static_assert(CLOCK_CALLBACK_USERS <= CLOCK_CALLBACK_MAX, "CLOCK_CALLBACK_MAX is less than the registered drivers");
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+/* 動作モード設定(ICLKの高い順) */
+static const ClockModeInfo csts_ClockModeTable[CLOCK_MODE_NUM] = {
+	// HIGH  : HOCO 48MHz, ICLK/PCLKA/PCLKC/PCLKD=48MHz, PCLKB/FCLK=24MHz
+	{CLOCK_SRC_HOCO, 0x10010100UL, CLOCK_OPCCR_HIGH,   1, 48000000UL, 6000},
+	// MIDDLE: HOCO/4, 全て12MHz
+	{CLOCK_SRC_HOCO, 0x22022222UL, CLOCK_OPCCR_MIDDLE, 0, 12000000UL, 2000},
+	// LOW   : MOCO 8MHz, 全て8MHz
+	{CLOCK_SRC_MOCO, 0x00000000UL, CLOCK_OPCCR_MIDDLE, 0,  8000000UL, 1600},
+};
+
+static ClockCallback pfs_ClockCallback[CLOCK_CALLBACK_MAX];	/* 登録ドライバーのコールバック	*/
+static uint8_t u8s_ClockCallbackNum;						/* 登録数						*/
+static uint8_t u8s_ClockMode;								/* 現在の動作モード				*/
+static uint8_t u8s_ClockTarget;								/* 指定された動作モード			*/
+static bool bls_ClockAuto;									/* 負荷による自動切り替え		*/
+static uint8_t u8s_ClockDownCount;							/* 1段下げる条件の継続周期数	*/
+static uint32_t u32s_ClockCycleStart;						/* 周期処理の開始サイクル		*/
+static uint32_t u32s_ClockSwitchCycle;						/* 切り替え時点のサイクル		*/
+static ClockStatistics sts_ClockStatistics;					/* 統計情報						*/
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t clock_apply(uint8_t u8_Mode);				/* 動作モードを切り替える(通知あり)	*/
+static void clock_switch(const ClockModeInfo *pst_Mode);	/* クロックのレジスタを切り替える	*/
+static void clock_set_opccr(uint8_t u8_Opccr);				/* 動作電力モードを変更する			*/
+static void clock_wait_us(uint32_t u32_Time);				/* 時間待ち処理(us指定)				*/
+static uint8_t clock_governor(void);						/* 負荷から動作モードを決める		*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  クロック管理ドライバー初期化処理
+  * @param  None
+  * @retval None
+  * @note   DWT初期化後、他のドライバーより先に呼び出す。高速モードに設定して
+  *         自動切り替えを開始する
+  */
+void taskClockDriverInit(void)
+{
+	u8s_ClockCallbackNum = 0;
+	mem_set08((uint8_t *)&sts_ClockStatistics, 0, sizeof(ClockStatistics));
+
+	/* 登録ドライバーが無いうちに高速モードの設定を確定させる */
+	__disable_irq();
+	clock_switch(&csts_ClockModeTable[CLOCK_MODE_HIGH]);
+	__enable_irq();
+
+	u8s_ClockMode = CLOCK_MODE_HIGH;
+	u8s_ClockTarget = CLOCK_MODE_HIGH;
+	bls_ClockAuto = true;
+	u8s_ClockDownCount = 0;
+	u32s_ClockSwitchCycle = LL_DWT_GetCycle();
+	u32s_ClockCycleStart = u32s_ClockSwitchCycle;
+}
+
+/**
+  * @brief  クロック管理ドライバー入力処理
+  * @param  None
+  * @retval None
+  * @note   周期処理の最初に呼び出し、負荷計測を開始する
+  */
+void taskClockDriverInput(void)
+{
+	u32s_ClockCycleStart = LL_DWT_GetCycle();
+}
+
+/**
+  * @brief  クロック管理ドライバー出力処理
+  * @param  None
+  * @retval None
+  * @note   周期処理の最後に呼び出し、負荷と滞在時間を更新して動作モードを切り替える。
+  *         登録ドライバーに拒否された場合は次の周期で再度切り替える
+  */
+void taskClockDriverOutput(void)
+{
+	uint32_t u32_Busy = LL_DWT_GetCycle() - u32s_ClockCycleStart;
+	uint32_t u32_Period = (SystemCoreClock / 1000) * SYS_CYCLE_TIME;
+	uint32_t u32_Load;
+	uint8_t u8_Mode;
+
+	/* ---- 負荷[0.1%] = 周期処理の実行サイクル / 周期時間のサイクル ---- */
+	u32_Load = (uint32_t)(((uint64_t)u32_Busy * 1000) / u32_Period);
+	sts_ClockStatistics.u16_load = (uint16_t)((u32_Load > 1000) ? 1000 : u32_Load);
+	sts_ClockStatistics.u32_residency_ms[u8s_ClockMode] += SYS_CYCLE_TIME;
+
+	u8_Mode = bls_ClockAuto ? clock_governor() : u8s_ClockTarget;
+	if (u8_Mode != u8s_ClockMode) {
+		(void)clock_apply(u8_Mode);
+	}
+}
+
+/**
+  * @brief  クロック変更の通知先を登録する
+  * @param  pf_Callback: コールバック
+  * @retval OK/NG(登録数の上限)
+  * @note   各ドライバーの初期化処理から呼び出す。登録順に呼び出される。
+  *         登録できないとクロック切り替え後に分周比が合わなくなるため、
+  *         呼び出し元はNGでError_Handler()を呼ぶこと
+  */
+uint8_t clockRegisterCallback(ClockCallback pf_Callback)
+{
+	if ((pf_Callback == NULL) || (u8s_ClockCallbackNum >= CLOCK_CALLBACK_MAX)) {
+		return NG;
+	}
+	pfs_ClockCallback[u8s_ClockCallbackNum] = pf_Callback;
+	u8s_ClockCallbackNum++;
+	return OK;
+}
+
+/**
+  * @brief  動作モードを指定する
+  * @param  u8_Mode: 動作モード(CLOCK_MODE_xxx, CLOCK_MODE_AUTO:負荷で自動切り替え)
+  * @retval OK/NG(設定値異常)
+  * @note   切り替えは周期処理の最後(taskClockDriverOutput)で行う
+  */
+uint8_t clockSetMode(uint8_t u8_Mode)
+{
+	if (u8_Mode == CLOCK_MODE_AUTO) {
+		u8s_ClockDownCount = 0;
+		bls_ClockAuto = true;
+		return OK;
+	}
+	if (u8_Mode >= CLOCK_MODE_NUM) {
+		return NG;
+	}
+	u8s_ClockTarget = u8_Mode;
+	bls_ClockAuto = false;
+	return OK;
+}
+
+/**
+  * @brief  現在の動作モードを取得する
+  * @param  None
+  * @retval 動作モード(CLOCK_MODE_xxx)
+  */
+uint8_t clockGetMode(void)
+{
+	return u8s_ClockMode;
+}
+
+/**
+  * @brief  切り替え時点のサイクル数を取得する
+  * @param  None
+  * @retval DWTサイクルカウンター(これより前は切り替え前のクロックで計数)
+  * @note   CLOCK_EVENT_POSTの通知中に経過時間を換算し直す場合に使用する
+  */
+uint32_t clockGetSwitchCycle(void)
+{
+	return u32s_ClockSwitchCycle;
+}
+
+/**
+  * @brief  統計情報を取得する
+  * @param  pst_Stat: 統計情報の格納先
+  * @retval None
+  */
+void clockGetStatistics(ClockStatistics *pst_Stat)
+{
+	uint64_t u64_Energy = 0;
+	uint64_t u64_Base = 0;
+	uint8_t _i;
+
+	/* 消費電荷の目安 = Σ(滞在時間 × 消費電流)を常に高速モードの場合と比べる */
+	for (_i=0; _i<CLOCK_MODE_NUM; _i++) {
+		u64_Energy += (uint64_t)sts_ClockStatistics.u32_residency_ms[_i] * csts_ClockModeTable[_i].u16_current_ua;
+		u64_Base += (uint64_t)sts_ClockStatistics.u32_residency_ms[_i] * csts_ClockModeTable[CLOCK_MODE_HIGH].u16_current_ua;
+	}
+	sts_ClockStatistics.u16_energy = (u64_Base > 0) ? (uint16_t)((u64_Energy * 1000) / u64_Base) : 1000;
+	sts_ClockStatistics.u8_mode = u8s_ClockMode;
+	sts_ClockStatistics.bl_auto = bls_ClockAuto;
+	*pst_Stat = sts_ClockStatistics;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  動作モードを切り替える(通知あり)
+  * @param  u8_Mode: 動作モード
+  * @retval OK/NG(登録ドライバーが拒否,データフラッシュP/E中)
+  * @note   切り替え時間は切り替え前後のサイクル数をそれぞれのクロックで換算する
+  */
+static uint8_t clock_apply(uint8_t u8_Mode)
+{
+	uint32_t u32_OldMhz = SystemCoreClock / 1000000;
+	uint32_t u32_NewMhz = csts_ClockModeTable[u8_Mode].u32_iclk / 1000000;
+	uint32_t u32_Start;
+	uint32_t u32_End;
+	uint32_t u32_Latency;
+	uint8_t u8_Accepted;
+	uint8_t _i;
+
+	/* データフラッシュのP/E中はFCLKを変更できない(FISRはP/E開始時に設定済み) */
+	if (LL_FLASH_IsPeMode()) {
+		sts_ClockStatistics.u32_vetoes++;
+		return NG;
+	}
+
+	/* ---- 登録ドライバーへ確認(NGなら確認済みのドライバーへ中止を通知) ---- */
+	for (u8_Accepted=0; u8_Accepted<u8s_ClockCallbackNum; u8_Accepted++) {
+		if (pfs_ClockCallback[u8_Accepted](CLOCK_EVENT_PRE, u8_Mode) != OK) {
+			break;
+		}
+	}
+	if (u8_Accepted < u8s_ClockCallbackNum) {
+		for (_i=0; _i<u8_Accepted; _i++) {
+			(void)pfs_ClockCallback[_i](CLOCK_EVENT_ABORT, u8_Mode);
+		}
+		sts_ClockStatistics.u32_vetoes++;
+		return NG;
+	}
+
+	/* ---- 切り替え(全ての割り込みの時間基準が変わるため、シーリングではなく全て禁止する) ---- */
+	__disable_irq();
+	u32_Start = LL_DWT_GetCycle();
+	clock_switch(&csts_ClockModeTable[u8_Mode]);
+	u32s_ClockSwitchCycle = LL_DWT_GetCycle();
+	u8s_ClockMode = u8_Mode;
+	u8s_ClockDownCount = 0;
+	/* 登録ドライバーへ通知(分周比等の再設定) */
+	for (_i=0; _i<u8s_ClockCallbackNum; _i++) {
+		(void)pfs_ClockCallback[_i](CLOCK_EVENT_POST, u8_Mode);
+	}
+	u32_End = LL_DWT_GetCycle();
+	__enable_irq();
+
+	u32_Latency = (((u32s_ClockSwitchCycle - u32_Start) * 1000) / u32_OldMhz)
+				+ (((u32_End - u32s_ClockSwitchCycle) * 1000) / u32_NewMhz);
+	sts_ClockStatistics.u32_transitions++;
+	sts_ClockStatistics.u32_last_ns = u32_Latency;
+	if (u32_Latency > sts_ClockStatistics.u32_max_ns) {
+		sts_ClockStatistics.u32_max_ns = u32_Latency;
+	}
+	return OK;
+}
+
+/**
+  * @brief  クロックのレジスタを切り替える
+  * @param  pst_Mode: 動作モード設定
+  * @retval None
+  * @note   割り込み禁止で呼び出す。周波数を上げる場合は動作電力モードと
+  *         メモリウェイトを先に、下げる場合は後に変更する。
+  *         フラッシュキャッシュは変更中は無効にし、無効化してから再開する
+  */
+static void clock_switch(const ClockModeInfo *pst_Mode)
+{
+	bool bl_Faster = (pst_Mode->u32_iclk > SystemCoreClock);
+
+	R_BSP_RegisterProtectDisable(BSP_REG_PROTECT_CGC);
+	R_BSP_RegisterProtectDisable(BSP_REG_PROTECT_OM_LPC_BATT);
+
+	/* ---- 切り替え先のクロックソースを発振させる ---- */
+	if (pst_Mode->u8_sckscr == CLOCK_SRC_MOCO) {
+		if (R_SYSTEM->MOCOCR != 0) {
+			R_SYSTEM->MOCOCR = 0;						// MOCO発振開始(安定フラグが無いため時間で待つ)
+			clock_wait_us(CLOCK_MOCO_WAIT_US);
+		}
+	}
+	else {
+		while ((R_SYSTEM->OSCSF & CLOCK_OSCSF_HOCOSF) == 0) {
+		}
+	}
+
+	/* ---- フラッシュキャッシュ無効 ---- */
+	R_FCACHE->FCACHEE = 0;
+
+	if (bl_Faster) {
+		clock_set_opccr(pst_Mode->u8_opccr);
+		R_SYSTEM->MEMWAIT = pst_Mode->u8_memwait;		// ICLK > 32MHzの前に1
+		R_SYSTEM->SCKDIVCR = pst_Mode->u32_sckdivcr;
+		R_SYSTEM->SCKSCR = pst_Mode->u8_sckscr;
+	}
+	else {
+		R_SYSTEM->SCKSCR = pst_Mode->u8_sckscr;
+		R_SYSTEM->SCKDIVCR = pst_Mode->u32_sckdivcr;
+		R_SYSTEM->MEMWAIT = pst_Mode->u8_memwait;
+		clock_set_opccr(pst_Mode->u8_opccr);
+	}
+
+	/* ---- 使わないMOCOは停止する(HOCOはUSBで使用するため停止しない) ---- */
+	if (pst_Mode->u8_sckscr != CLOCK_SRC_MOCO) {
+		R_SYSTEM->MOCOCR = 1;
+	}
+
+	/* ---- フラッシュキャッシュを無効化して再開する ---- */
+	R_FCACHE->FCACHEIV = 1;
+	while (R_FCACHE->FCACHEIV != 0) {
+	}
+	R_FCACHE->FCACHEE = 1;
+
+	R_BSP_RegisterProtectEnable(BSP_REG_PROTECT_OM_LPC_BATT);
+	R_BSP_RegisterProtectEnable(BSP_REG_PROTECT_CGC);
+	SystemCoreClockUpdate();
+}
+
+/**
+  * @brief  動作電力モードを変更する
+  * @param  u8_Opccr: 動作電力モード(OPCCR)
+  * @retval None
+  */
+static void clock_set_opccr(uint8_t u8_Opccr)
+{
+	if ((R_SYSTEM->OPCCR & CLOCK_OPCCR_OPCM) == u8_Opccr) {
+		return;
+	}
+	while (R_SYSTEM->OPCCR & CLOCK_OPCCR_OPCMTSF) {
+	}
+	R_SYSTEM->OPCCR = u8_Opccr;
+	while (R_SYSTEM->OPCCR & CLOCK_OPCCR_OPCMTSF) {
+	}
+}
+
+/**
+  * @brief  時間待ち処理(us指定)
+  * @param  u32_Time: 待ち時間[us]
+  * @retval None
+  */
+static void clock_wait_us(uint32_t u32_Time)
+{
+	uint32_t u32_Start = LL_DWT_GetCycle();
+	uint32_t u32_Cycles = (SystemCoreClock / 1000000) * u32_Time;
+
+	while ((LL_DWT_GetCycle() - u32_Start) < u32_Cycles) {
+	}
+}
+
+/**
+  * @brief  負荷から動作モードを決める
+  * @param  None
+  * @retval 動作モード
+  * @note   高負荷ならすぐに高速モードへ戻す。1段下げた場合の予測負荷
+  *         (負荷 × 現在のICLK / 1段下のICLK)が低い状態が続けば1段下げる
+  */
+static uint8_t clock_governor(void)
+{
+	uint32_t u32_Load = sts_ClockStatistics.u16_load;
+	uint32_t u32_Predict;
+
+	if (u32_Load > CLOCK_LOAD_UP) {
+		u8s_ClockDownCount = 0;
+		return CLOCK_MODE_HIGH;
+	}
+	if ((u8s_ClockMode + 1) >= CLOCK_MODE_NUM) {
+		return u8s_ClockMode;
+	}
+	u32_Predict = (uint32_t)(((uint64_t)u32_Load * csts_ClockModeTable[u8s_ClockMode].u32_iclk)
+				/ csts_ClockModeTable[u8s_ClockMode + 1].u32_iclk);
+	if (u32_Predict >= CLOCK_LOAD_DOWN) {
+		u8s_ClockDownCount = 0;
+		return u8s_ClockMode;
+	}
+	if (u8s_ClockDownCount < CLOCK_DOWN_CYCLES) {
+		u8s_ClockDownCount++;
+		return u8s_ClockMode;
+	}
+	return u8s_ClockMode + 1;
+}
@@ -0,0 +1,1029 @@
+/**
+  ******************************************************************************
+  * @file           : drv_esp.c
+  * @brief          : ESP32-S3リンクドライバー(SCI9)
+  ******************************************************************************
+  * @note   UNO R4 WiFiのRA4M1とESP32-S3の間のUART(TXD9:P109, RXD9:P110)を
+  *         3Mbpsで動作させ、フレーム化した双方向の通信路にする。
+  *         Minimaでは同じ端子がSPI0(MOSI/MISO)のため、espOpen()はWiFiボード
+  *         (BOARD_UNO_R4_WIFI)でだけ呼び出すこと。
+  *         - フレーム: A5h 5Ah | 種別(上位4bit)+チャネル(下位4bit) | 送信番号 |
+  *           応答番号 | データ長 | データ(0～ESP_PAYLOAD_MAX) | CRC16(下位,上位)
+  *           CRCはCRC-16/CCITT(初期値FFFFh)で、種別からデータの最後までを対象とする。
+  *         - データフレームは送信番号(8bit)の順に受け取り、応答番号には次に
+  *           受け取る送信番号を入れる(累積応答)。応答はデータフレームに
+  *           載せ、送るデータが無い周期だけ応答フレームを送る。
+  *         - 送信はGo-Back-N。応答を待たずにESP_WINDOWフレームまで送り、
+  *           ESP_RTO_CYCLES周期の間応答が進まなければ未応答のフレームから
+  *           送り直す。ESP_RETRY_MAX回続けて失敗すると同期からやり直す。
+  *           同期要求(SYNC)を受けると双方の番号を0に戻して同期応答を返す。
+  *         - 送信はフレーム毎にDTC(SCI9_TXI→TDR)で転送し、割り込みは
+  *           フレームの最後のbyteを書き込んだ時の1回だけ。受信はDTC
+  *           (SCI9_RXI→受信リング)で転送し続け、割り込みは受信リング1周毎の
+  *           再設定だけ。周期処理は受信リングのDTC転送回数から書き込み位置を
+  *           求めてフレームを組み立てる。
+  *         - 受信コールバックがfalseを返したフレームは応答せず、相手の再送で
+  *           もう一度受け取る(受け取り側が一杯の間の流量制御)。
+  *         ボーレートはPCLKA 48MHz(高速モード)が前提のため、通信中は他の
+  *         動作モードへのクロック変更を拒否する。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "drv.h"
+#include "lib.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* DTC送信待ちのフレーム */
+typedef struct _EspTxJob {
+	const uint8_t *pu8_data;		/* フレームの先頭						*/
+	uint16_t u16_size;				/* フレーム長[byte]						*/
+	uint8_t u8_slot;				/* 送信フレームの番号(ESP_SLOT_CTL:制御フレーム)	*/
+} EspTxJob;
+
+/* Private define ------------------------------------------------------------*/
+#define ESP_CEILING			(IRQ_PRIO_SCI9)			/* 送信待ち/受信リングのシーリング(SCI9_RXI/TXI/ERI)	*/
+#define ESP_BAUDRATE		(3000000UL)				/* 通信速度[bps]				*/
+#define ESP_BAUD_TOLERANCE	(50)					/* 通信速度の許容誤差(1/50=2%)	*/
+#define ESP_BRR_MAX			(256)					/* BRR+1の最大値				*/
+#define ESP_RTO_CYCLES		(4)						/* 再送までの周期数(20ms)		*/
+#define ESP_RETRY_MAX		(8)						/* 続けて再送する回数(超えると同期からやり直す)	*/
+#define ESP_SYNC_CYCLES		(20)					/* 同期要求の送信周期(100ms)	*/
+#define ESP_TX_JOBS			(8)						/* DTC送信待ちの数(2のべき乗, ESP_WINDOW+制御1以上)	*/
+#define ESP_WINDOW_MASK		(ESP_WINDOW - 1)
+#define ESP_SLOT_CTL		(ESP_WINDOW)			/* 制御フレームの番号			*/
+#define ESP_SLOT_NUM		(ESP_WINDOW + 1)
+
+/* フレーム */
+#define ESP_SOF1			(0xA5)					/* 同期パターン(1byte目)		*/
+#define ESP_SOF2			(0x5A)					/* 同期パターン(2byte目)		*/
+#define ESP_POS_TYPE		(2)						/* 種別+チャネル				*/
+#define ESP_POS_SEQ			(3)						/* 送信番号						*/
+#define ESP_POS_ACK			(4)						/* 応答番号(次に受け取る送信番号)	*/
+#define ESP_POS_LEN			(5)						/* データ長						*/
+#define ESP_HEADER_SIZE		(6)
+#define ESP_CRC_SIZE		(2)
+#define ESP_FRAME_MAX		(ESP_HEADER_SIZE + ESP_PAYLOAD_MAX + ESP_CRC_SIZE)
+#define ESP_CTL_SIZE		(ESP_HEADER_SIZE + ESP_CRC_SIZE)
+#define ESP_TYPE_MASK		(0xF0)
+#define ESP_CH_MASK			(0x0F)
+#define ESP_TYPE_DATA		(0x00)					/* データ						*/
+#define ESP_TYPE_ACK		(0x10)					/* 応答のみ						*/
+#define ESP_TYPE_SYNC		(0x20)					/* 同期要求(番号を0に戻す)		*/
+#define ESP_TYPE_SYNC_ACK	(0x30)					/* 同期応答						*/
+
+/* SCR/SSR/SEMR */
+#define ESP_SCR_ON			(0xF0)					/* TIE=1, RIE=1, TE=1, RE=1		*/
+#define ESP_SSR_ERRORS		(0x38)					/* ORER/FER/PER					*/
+#define ESP_SEMR_ABCS_BGDM	(0x50)					/* 基本クロック8サイクル/1bit	*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t u8s_EspTxFrame[ESP_WINDOW][ESP_FRAME_MAX];	/* 送信フレーム(送信番号の下位bitで選ぶ)	*/
+static uint8_t u8s_EspCtlFrame[ESP_CTL_SIZE];				/* 制御フレーム(応答/同期)		*/
+static EspTxJob sts_EspTxJob[ESP_TX_JOBS];					/* DTC送信待ち					*/
+volatile static uint8_t u8s_EspJobHead;						/* 次に登録する位置(周期処理だけが更新)	*/
+volatile static uint8_t u8s_EspJobTail;						/* 送信中の位置(割り込みだけが更新)	*/
+volatile static uint8_t u8s_EspTxQueued[ESP_SLOT_NUM];		/* フレーム毎のDTC送信待ちの数	*/
+volatile static bool bls_EspTxActive;						/* DTC送信中					*/
+static DtcTransferInfo sts_EspDtcTx;						/* DTC転送情報(SCI9_TXI)		*/
+static DtcTransferInfo sts_EspDtcRx;						/* DTC転送情報(SCI9_RXI)		*/
+static uint8_t u8s_EspRxRing[ESP_RX_RING_SIZE];				/* 受信リング(DTCが書き込む)	*/
+volatile static uint32_t u32s_EspRxWraps;					/* 受信リングの周回数(割り込みだけが更新)	*/
+static uint32_t u32s_EspRxRead;								/* 次に解析する位置(通算)		*/
+static uint8_t u8s_EspRxFrame[ESP_FRAME_MAX];				/* 組み立て中の受信フレーム		*/
+static uint16_t u16s_EspRxPos;								/* 組み立て中の位置				*/
+static uint8_t u8s_EspLink;									/* リンク状態(ESP_LINK_xxx)		*/
+static uint8_t u8s_EspTxBase;								/* 応答を待つ最初の送信番号		*/
+static uint8_t u8s_EspTxNext;								/* 次に送る送信番号				*/
+static uint8_t u8s_EspTxEnd;								/* 書き込み中のフレームの次の送信番号	*/
+static uint8_t u8s_EspTxHigh;								/* 送ったことのある最後の送信番号+1	*/
+static uint8_t u8s_EspRxExpect;								/* 次に受け取る送信番号			*/
+static bool bls_EspAckPending;								/* 応答を送っていない受信がある	*/
+static bool bls_EspSyncAckPending;							/* 同期応答を送る				*/
+static uint8_t u8s_EspRtoCycles;							/* 応答が進まない周期数			*/
+static uint8_t u8s_EspRetries;								/* 続けて再送した回数			*/
+static uint8_t u8s_EspSyncCycles;							/* 同期要求の送信周期のカウンター	*/
+static EspRxCallback pfs_EspRxCallback[ESP_CH_NUM];			/* チャネル毎の受信コールバック	*/
+static EspStatistics sts_EspStatistics;						/* 統計情報						*/
+
+/* CRC-16/CCITT(多項式1021h)のテーブル */
+static const uint16_t u16s_EspCrcTable[256] = {
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+	0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+	0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+	0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+	0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+	0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+	0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+	0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+	0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+	0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+	0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+	0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+	0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+	0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+	0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+	0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+	0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+	0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+	0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+	0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+	0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+	0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+	0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+	0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+	0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+	0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+	0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+	0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+	0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+	0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+	0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t esp_set_baudrate(void);						/* ボーレートを設定する			*/
+static uint16_t esp_crc16(const uint8_t *pu8_Data, uint16_t u16_Size);	/* CRC-16/CCITTを求める	*/
+static void esp_link_reset(void);							/* 送信番号/受信番号を0に戻す	*/
+static void esp_link_sync(void);							/* 同期からやり直す				*/
+static uint8_t *esp_tx_slot(uint8_t u8_Ch);					/* 書き込む送信フレームを用意する	*/
+static uint8_t esp_tx_queue(uint8_t *pu8_Frame, uint8_t u8_Slot);	/* フレームを封じてDTC送信待ちに登録する	*/
+static bool esp_tx_control(uint8_t u8_Type);				/* 制御フレームを送る			*/
+static void esp_tx_seal(void);								/* 未送信のデータフレームを送る	*/
+static void esp_tx_timeout(void);							/* 応答待ちのタイムアウトを確認する	*/
+static void esp_tx_flush(void);								/* 開始前のDTC送信待ちを捨てる	*/
+static void esp_tx_start(void);								/* 次のフレームのDTC転送を開始する	*/
+static void esp_tx_put(void);								/* 1byteをCPUで送信する			*/
+static void esp_rx_arm(void);								/* 受信リングへの転送を設定する	*/
+static void esp_rx_parse(void);								/* 受信リングを解析する			*/
+static void esp_rx_byte(uint8_t u8_Data);					/* 受信データでフレームを組み立てる	*/
+static void esp_rx_frame(void);								/* 受信フレームを処理する		*/
+static void esp_rx_ack(uint8_t u8_Ack);						/* 応答番号を処理する			*/
+static void esp_rx_data(uint8_t u8_Ch, uint8_t u8_Seq, const uint8_t *pu8_Data, uint8_t u8_Size);	/* データフレームを受け取る	*/
+static uint8_t esp_clock_callback(uint8_t u8_Event, uint8_t u8_Mode);	/* クロック変更コールバック	*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  SCI9受信データフル割り込みハンドラ
+  * @param  None
+  * @retval None
+  * @note   DTCが受信リングの最後まで転送した時(DTCEは解除されている)と、
+  *         DTC起動を禁止していた間の受信で発生する
+  */
+void SCI9_RXI_Handler(void)
+{
+	/* 割り込み要求フラグ クリア */
+	R_ICU->IELSR_b[IRQ_SCI9_RXI].IR = 0;
+	sts_EspStatistics.u32_rx_irqs++;
+
+	/* 受信リングの先頭から転送し直す */
+	if (sts_EspDtcRx.u16_cra == 0) {
+		esp_rx_arm();
+		u32s_EspRxWraps++;
+	}
+	/* DTC起動を禁止していた間に受信したデータはCPUで格納する */
+	if (R_SCI9->SSR_b.RDRF) {
+		*(volatile uint8_t *)sts_EspDtcRx.pv_dst = R_SCI9->RDR;
+		sts_EspDtcRx.pv_dst = (volatile uint8_t *)sts_EspDtcRx.pv_dst + 1;
+		sts_EspDtcRx.u16_cra--;
+	}
+	LL_DTC_EnableIT(IRQ_SCI9_RXI);
+}
+
+/**
+  * @brief  SCI9送信データエンプティ割り込みハンドラ
+  * @param  None
+  * @retval None
+  * @note   DTCがフレームの最後のbyteを書き込んだ時(DTCEは解除されている)と、
+  *         DTC起動を許可する前に送信データが空になった時に発生する
+  */
+void SCI9_TXI_Handler(void)
+{
+	/* 割り込み要求フラグ クリア */
+	R_ICU->IELSR_b[IRQ_SCI9_TXI].IR = 0;
+
+	if (!bls_EspTxActive) {
+		return;
+	}
+	if (sts_EspDtcTx.u16_cra > 0) {
+		if (R_SCI9->SSR_b.TDRE) {
+			esp_tx_put();
+		}
+		if (sts_EspDtcTx.u16_cra > 0) {
+			LL_DTC_EnableIT(IRQ_SCI9_TXI);
+			return;
+		}
+		LL_DTC_DisableIT(IRQ_SCI9_TXI);
+	}
+
+	/* フレームを書き終えたので次のフレームへ */
+	sts_EspStatistics.u32_tx_irqs++;
+	u8s_EspTxQueued[sts_EspTxJob[u8s_EspJobTail & (ESP_TX_JOBS - 1)].u8_slot]--;
+	u8s_EspJobTail++;
+	esp_tx_start();
+}
+
+/**
+  * @brief  SCI9受信エラー割り込みハンドラ
+  * @param  None
+  * @retval None
+  * @note   欠けたフレームはCRC/送信番号の確認で捨て、相手の再送で回復するため
+  *         エラーを数えて受信を続ける
+  */
+void SCI9_ERI_Handler(void)
+{
+	/* 割り込み要求フラグ クリア */
+	R_ICU->IELSR_b[IRQ_SCI9_ERI].IR = 0;
+
+	sts_EspStatistics.u32_line_errors++;
+	R_SCI9->SSR = (uint8_t)(R_SCI9->SSR & ~ESP_SSR_ERRORS);	// 0の書き込みで解除
+}
+
+/**
+  * @brief  ESP32-S3リンクドライバー初期化処理
+  * @param  None
+  * @retval None
+  * @note   SCI9/端子はespOpen()で設定する
+  */
+void taskEspDriverInit(void)
+{
+	uint32_t u32_Mask;
+	uint8_t _i;
+
+	mem_set08((uint8_t *)&sts_EspStatistics, 0x00, sizeof(sts_EspStatistics));
+	for (_i=0; _i<ESP_CH_NUM; _i++) {
+		pfs_EspRxCallback[_i] = NULL;
+	}
+	u8s_EspLink = ESP_LINK_CLOSED;
+
+	/* ---- ベクターテーブル登録 ---- */
+	u32_Mask = LL_IRQ_Lock(ESP_CEILING);
+	NVIC_SetVector((IRQn_Type)IRQ_SCI9_RXI, (uintptr_t)SCI9_RXI_Handler);
+	NVIC_SetVector((IRQn_Type)IRQ_SCI9_TXI, (uintptr_t)SCI9_TXI_Handler);
+	NVIC_SetVector((IRQn_Type)IRQ_SCI9_ERI, (uintptr_t)SCI9_ERI_Handler);
+	LL_IRQ_Unlock(u32_Mask);
+
+	/* ---- SCI9_RXI/TXI/ERI 無効 ---- */
+	R_ICU->IELSR[IRQ_SCI9_RXI] = 0x00000000;
+	R_ICU->IELSR[IRQ_SCI9_TXI] = 0x00000000;
+	R_ICU->IELSR[IRQ_SCI9_ERI] = 0x00000000;
+
+	/* ---- クロック変更の通知先を登録する ---- */
+	if (clockRegisterCallback(esp_clock_callback) != OK) {
+		Error_Handler();
+	}
+}
+
+/**
+  * @brief  ESP32-S3リンクドライバー入力処理
+  * @param  None
+  * @retval None
+  */
+void taskEspDriverInput(void)
+{
+	if (u8s_EspLink == ESP_LINK_CLOSED) {
+		return;
+	}
+	esp_rx_parse();
+}
+
+/**
+  * @brief  ESP32-S3リンクドライバー出力処理
+  * @param  None
+  * @retval None
+  * @note   書き込まれたデータをフレームにして送り、送るデータが無ければ
+  *         応答フレームを送る
+  */
+void taskEspDriverOutput(void)
+{
+	if (u8s_EspLink == ESP_LINK_CLOSED) {
+		return;
+	}
+	if (bls_EspSyncAckPending && esp_tx_control(ESP_TYPE_SYNC_ACK)) {
+		bls_EspSyncAckPending = false;
+	}
+	if (u8s_EspLink == ESP_LINK_SYNC) {
+		/* 相手の応答まで同期要求を繰り返す */
+		if (u8s_EspSyncCycles == 0) {
+			(void)esp_tx_control(ESP_TYPE_SYNC);
+		}
+		if (++u8s_EspSyncCycles >= ESP_SYNC_CYCLES) {
+			u8s_EspSyncCycles = 0;
+		}
+		return;
+	}
+	esp_tx_timeout();
+	esp_tx_seal();
+	if (bls_EspAckPending && esp_tx_control(ESP_TYPE_ACK)) {
+		bls_EspAckPending = false;
+	}
+}
+
+/**
+  * @brief  リンクを開始する
+  * @param  None
+  * @retval OK/NG(開始済み,PCLKAで通信速度を作れない)
+  * @note   相手の同期応答(または同期要求)を受けると通信中になる
+  */
+uint8_t espOpen(void)
+{
+	if (u8s_EspLink != ESP_LINK_CLOSED) {
+		return NG;
+	}
+
+	/* ---- SCI9 モジュールストップ解除 ---- */
+	R_MSTP->MSTPCRB_b.MSTPB22 = 0;					// SCI9 ON
+
+	/* ---- SCI 停止 ---- */
+	R_SCI9->SCR = 0x00;
+
+	/* ---- 通信条件設定 ---- */
+	R_SCI9->SMR = 0x00;								// 8bit, no parity, 1 stop
+	R_SCI9->SCMR = 0xF2;							// 通常モード
+
+	/* ---- ボーレート設定 ---- */
+	if (esp_set_baudrate() != OK) {
+		R_MSTP->MSTPCRB_b.MSTPB22 = 1;				// SCI9 OFF
+		return NG;
+	}
+
+	/* ---- ポート設定 ---- */
+	// 書き込みプロテクト解除
+	R_BSP_PinAccessEnable();
+	// P109 = TXD9, P110 = RXD9
+	R_PFS->PORT[1].PIN[9].PmnPFS_b.PSEL = 0b00101;	// SCI9 TX
+	R_PFS->PORT[1].PIN[10].PmnPFS_b.PSEL = 0b00101;	// SCI9 RX
+	R_PFS->PORT[1].PIN[9].PmnPFS_b.PMR = 1;
+	R_PFS->PORT[1].PIN[10].PmnPFS_b.PMR = 1;
+	// 書き込みプロテクト施錠
+	R_BSP_PinAccessDisable();
+
+	/* ---- 送受信の状態を初期化 ---- */
+	mem_set08((uint8_t *)&u8s_EspTxQueued[0], 0x00, sizeof(u8s_EspTxQueued));
+	u8s_EspJobHead = 0;
+	u8s_EspJobTail = 0;
+	bls_EspTxActive = false;
+	u32s_EspRxWraps = 0;
+	u32s_EspRxRead = 0;
+	u16s_EspRxPos = 0;
+	bls_EspSyncAckPending = false;
+	esp_link_reset();
+
+	/* ---- DTC 設定 (SCI9_RXI → RDRを受信リングへ, SCI9_TXI → フレームをTDRへ) ---- */
+	LL_DTC_Init();
+	esp_rx_arm();
+	LL_DTC_SetVector(IRQ_SCI9_RXI, &sts_EspDtcRx);
+	LL_DTC_SetVector(IRQ_SCI9_TXI, &sts_EspDtcTx);
+
+	/* ---- ICU → NVIC 割り込み割り当て ---- */
+	R_ICU->IELSR_b[IRQ_SCI9_RXI].IR = 0;			// 割り込み要求フラグ クリア
+	R_ICU->IELSR_b[IRQ_SCI9_RXI].IELS = ELC_EVENT_SCI9_RXI;
+	R_ICU->IELSR_b[IRQ_SCI9_TXI].IR = 0;
+	R_ICU->IELSR_b[IRQ_SCI9_TXI].IELS = ELC_EVENT_SCI9_TXI;
+	R_ICU->IELSR_b[IRQ_SCI9_ERI].IR = 0;
+	R_ICU->IELSR_b[IRQ_SCI9_ERI].IELS = ELC_EVENT_SCI9_ERI;
+
+	/* ---- NVIC 設定 ---- */
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_SCI9_RXI);
+	NVIC_SetPriority((IRQn_Type)IRQ_SCI9_RXI, IRQ_PRIO_SCI9);
+	NVIC_EnableIRQ((IRQn_Type)IRQ_SCI9_RXI);
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_SCI9_TXI);
+	NVIC_SetPriority((IRQn_Type)IRQ_SCI9_TXI, IRQ_PRIO_SCI9);
+	NVIC_EnableIRQ((IRQn_Type)IRQ_SCI9_TXI);
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_SCI9_ERI);
+	NVIC_SetPriority((IRQn_Type)IRQ_SCI9_ERI, IRQ_PRIO_SCI9);
+	NVIC_EnableIRQ((IRQn_Type)IRQ_SCI9_ERI);
+
+	/* ---- 送受信有効 ---- */
+	LL_DTC_EnableIT(IRQ_SCI9_RXI);
+	R_SCI9->SCR = ESP_SCR_ON;
+
+	u8s_EspLink = ESP_LINK_SYNC;
+	u8s_EspSyncCycles = 0;
+	return OK;
+}
+
+/**
+  * @brief  リンクを停止する
+  * @param  None
+  * @retval None
+  * @note   送信中/未応答のデータは捨てる
+  */
+void espClose(void)
+{
+	if (u8s_EspLink == ESP_LINK_CLOSED) {
+		return;
+	}
+	NVIC_DisableIRQ((IRQn_Type)IRQ_SCI9_RXI);
+	NVIC_DisableIRQ((IRQn_Type)IRQ_SCI9_TXI);
+	NVIC_DisableIRQ((IRQn_Type)IRQ_SCI9_ERI);
+
+	/* ---- SCI 停止 ---- */
+	R_SCI9->SCR = 0x00;
+
+	/* ---- DTC 停止 ---- */
+	R_ICU->IELSR[IRQ_SCI9_RXI] = 0x00000000;
+	R_ICU->IELSR[IRQ_SCI9_TXI] = 0x00000000;
+	R_ICU->IELSR[IRQ_SCI9_ERI] = 0x00000000;
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_SCI9_RXI);
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_SCI9_TXI);
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_SCI9_ERI);
+
+	R_MSTP->MSTPCRB_b.MSTPB22 = 1;					// SCI9 OFF
+	bls_EspTxActive = false;
+	u8s_EspLink = ESP_LINK_CLOSED;
+}
+
+/**
+  * @brief  チャネルの受信コールバックを登録する
+  * @param  u8_Ch: チャネル(0～ESP_CH_NUM-1)
+  * @param  pf_Callback: 受信コールバック(NULL:受信データを捨てる)
+  * @retval None
+  */
+void espSetReceiver(uint8_t u8_Ch, EspRxCallback pf_Callback)
+{
+	if (u8_Ch < ESP_CH_NUM) {
+		pfs_EspRxCallback[u8_Ch] = pf_Callback;
+	}
+}
+
+/**
+  * @brief  チャネルへ送信する
+  * @param  u8_Ch: チャネル(0～ESP_CH_NUM-1)
+  * @param  pu8_Data: 送信データ
+  * @param  u16_Size: 送信データ数
+  * @retval 受け付けたデータ数(通信中でない,ウィンドウが一杯の場合は少なくなる)
+  * @note   同じチャネルの未送信のフレームに追記し、出力処理でまとめて送る
+  */
+uint16_t espWrite(uint8_t u8_Ch, const uint8_t *pu8_Data, uint16_t u16_Size)
+{
+	uint8_t *pu8_Frame;
+	uint16_t u16_Done = 0;
+	uint16_t u16_Len;
+
+	if ((u8s_EspLink != ESP_LINK_UP) || (u8_Ch >= ESP_CH_NUM)) {
+		return 0;
+	}
+	while (u16_Done < u16_Size) {
+		pu8_Frame = esp_tx_slot(u8_Ch);
+		if (pu8_Frame == NULL) {
+			break;
+		}
+		u16_Len = (uint16_t)(ESP_PAYLOAD_MAX - pu8_Frame[ESP_POS_LEN]);
+		if (u16_Len > (u16_Size - u16_Done)) {
+			u16_Len = (uint16_t)(u16_Size - u16_Done);
+		}
+		mem_cpy08(&pu8_Frame[ESP_HEADER_SIZE + pu8_Frame[ESP_POS_LEN]], &pu8_Data[u16_Done], u16_Len);
+		pu8_Frame[ESP_POS_LEN] = (uint8_t)(pu8_Frame[ESP_POS_LEN] + u16_Len);
+		u16_Done += u16_Len;
+	}
+	return u16_Done;
+}
+
+/**
+  * @brief  すぐに送信できるデータ数を取得する
+  * @param  u8_Ch: チャネル(0～ESP_CH_NUM-1)
+  * @retval espWrite()が全て受け付けるデータ数
+  */
+uint16_t espGetTxFree(uint8_t u8_Ch)
+{
+	const uint8_t *pu8_Frame;
+	uint16_t u16_Free = 0;
+	uint8_t u8_Seq;
+
+	if ((u8s_EspLink != ESP_LINK_UP) || (u8_Ch >= ESP_CH_NUM)) {
+		return 0;
+	}
+	if (u8s_EspTxHigh != u8s_EspTxEnd) {
+		pu8_Frame = u8s_EspTxFrame[(uint8_t)(u8s_EspTxEnd - 1) & ESP_WINDOW_MASK];
+		if ((pu8_Frame[ESP_POS_TYPE] & ESP_CH_MASK) == u8_Ch) {
+			u16_Free = (uint16_t)(ESP_PAYLOAD_MAX - pu8_Frame[ESP_POS_LEN]);
+		}
+	}
+	for (u8_Seq=u8s_EspTxEnd; (uint8_t)(u8_Seq - u8s_EspTxBase) < ESP_WINDOW; u8_Seq++) {
+		if (u8s_EspTxQueued[u8_Seq & ESP_WINDOW_MASK] != 0) {
+			break;
+		}
+		u16_Free += ESP_PAYLOAD_MAX;
+	}
+	return u16_Free;
+}
+
+/**
+  * @brief  通信中かを取得する
+  * @param  None
+  * @retval true:通信中 / false:停止中,同期中
+  */
+bool espIsConnected(void)
+{
+	return (u8s_EspLink == ESP_LINK_UP);
+}
+
+/**
+  * @brief  ESP32-S3リンク統計情報を取得する
+  * @param  pst_Stat: 統計情報の格納先
+  * @retval None
+  */
+void espGetStatistics(EspStatistics *pst_Stat)
+{
+	uint32_t u32_Mask;
+
+	u32_Mask = LL_IRQ_Lock(ESP_CEILING);
+	*pst_Stat = sts_EspStatistics;
+	LL_IRQ_Unlock(u32_Mask);
+	pst_Stat->u8_link = u8s_EspLink;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  ボーレートを設定する
+  * @param  None
+  * @retval OK/NG(許容誤差を超える)
+  * @note   SCR.TE=0, SCR.RE=0の状態で呼び出すこと
+  *         B = PCLKA / (8 * (BRR+1)) (SMR.CKS=0, SEMR.ABCS=1, SEMR.BGDM=1)
+  *         PCLKA 48MHzで3Mbps(BRR=1)
+  */
+static uint8_t esp_set_baudrate(void)
+{
+	uint32_t u32_Pclka = R_FSP_SystemClockHzGet(FSP_PRIV_CLOCK_PCLKA);
+	uint32_t u32_Divider = 8 * ESP_BAUDRATE;
+	uint32_t u32_Brr = (u32_Pclka + (u32_Divider / 2)) / u32_Divider;
+	uint32_t u32_Bitrate;
+
+	if ((u32_Brr == 0) || (u32_Brr > ESP_BRR_MAX)) {
+		return NG;
+	}
+	u32_Bitrate = u32_Pclka / (8 * u32_Brr);
+	if (((u32_Bitrate > ESP_BAUDRATE) ? (u32_Bitrate - ESP_BAUDRATE) : (ESP_BAUDRATE - u32_Bitrate))
+	 > (ESP_BAUDRATE / ESP_BAUD_TOLERANCE)) {
+		return NG;
+	}
+
+	R_SCI9->SMR = (uint8_t)(R_SCI9->SMR & ~0x03);	// CKS: PCLKA/1
+	R_SCI9->SEMR = ESP_SEMR_ABCS_BGDM;
+	R_SCI9->BRR = (uint8_t)(u32_Brr - 1);
+	sts_EspStatistics.u32_bitrate = u32_Bitrate;
+	return OK;
+}
+
+/**
+  * @brief  CRC-16/CCITTを求める
+  * @param  pu8_Data: データ
+  * @param  u16_Size: データ数
+  * @retval CRC(初期値FFFFh)
+  */
+static uint16_t esp_crc16(const uint8_t *pu8_Data, uint16_t u16_Size)
+{
+	uint16_t u16_Crc = 0xFFFF;
+	uint16_t _i;
+
+	for (_i=0; _i<u16_Size; _i++) {
+		u16_Crc = (uint16_t)((u16_Crc << 8) ^ u16s_EspCrcTable[(uint8_t)(u16_Crc >> 8) ^ pu8_Data[_i]]);
+	}
+	return u16_Crc;
+}
+
+/**
+  * @brief  送信番号/受信番号を0に戻す
+  * @param  None
+  * @retval None
+  * @note   未送信/未応答のデータは捨てる。DTC送信待ちに残っているフレームは
+  *         u8s_EspTxQueuedが0になるまで書き換えない
+  */
+static void esp_link_reset(void)
+{
+	u8s_EspTxBase = 0;
+	u8s_EspTxNext = 0;
+	u8s_EspTxEnd = 0;
+	u8s_EspTxHigh = 0;
+	u8s_EspRxExpect = 0;
+	bls_EspAckPending = false;
+	u8s_EspRtoCycles = 0;
+	u8s_EspRetries = 0;
+}
+
+/**
+  * @brief  同期からやり直す
+  * @param  None
+  * @retval None
+  */
+static void esp_link_sync(void)
+{
+	esp_tx_flush();
+	esp_link_reset();
+	u8s_EspLink = ESP_LINK_SYNC;
+	u8s_EspSyncCycles = 0;
+}
+
+/**
+  * @brief  書き込む送信フレームを用意する
+  * @param  u8_Ch: チャネル
+  * @retval 送信フレーム / NULL:ウィンドウが一杯
+  * @note   一度も送っていない最後のフレームが同じチャネルで空きがあれば追記する
+  */
+static uint8_t *esp_tx_slot(uint8_t u8_Ch)
+{
+	uint8_t *pu8_Frame;
+	uint8_t u8_Slot;
+
+	if (u8s_EspTxHigh != u8s_EspTxEnd) {
+		pu8_Frame = u8s_EspTxFrame[(uint8_t)(u8s_EspTxEnd - 1) & ESP_WINDOW_MASK];
+		if (((pu8_Frame[ESP_POS_TYPE] & ESP_CH_MASK) == u8_Ch) && (pu8_Frame[ESP_POS_LEN] < ESP_PAYLOAD_MAX)) {
+			return pu8_Frame;
+		}
+	}
+	/* 応答済みでも前の送信がDTC送信待ちに残っているフレームは使わない */
+	u8_Slot = u8s_EspTxEnd & ESP_WINDOW_MASK;
+	if (((uint8_t)(u8s_EspTxEnd - u8s_EspTxBase) >= ESP_WINDOW) || (u8s_EspTxQueued[u8_Slot] != 0)) {
+		return NULL;
+	}
+	pu8_Frame = u8s_EspTxFrame[u8_Slot];
+	pu8_Frame[ESP_POS_TYPE] = (uint8_t)(ESP_TYPE_DATA | u8_Ch);
+	pu8_Frame[ESP_POS_LEN] = 0;
+	u8s_EspTxEnd++;
+	return pu8_Frame;
+}
+
+/**
+  * @brief  フレームを封じてDTC送信待ちに登録する
+  * @param  pu8_Frame: フレーム(種別/送信番号/応答番号/データ長/データを設定済み)
+  * @param  u8_Slot: 送信フレームの番号(ESP_SLOT_CTL:制御フレーム)
+  * @retval OK/NG(DTC送信待ちが一杯)
+  */
+static uint8_t esp_tx_queue(uint8_t *pu8_Frame, uint8_t u8_Slot)
+{
+	EspTxJob *pst_Job;
+	uint16_t u16_Size = (uint16_t)(ESP_HEADER_SIZE + pu8_Frame[ESP_POS_LEN]);
+	uint16_t u16_Crc;
+	uint32_t u32_Mask;
+
+	if ((uint8_t)(u8s_EspJobHead - u8s_EspJobTail) >= ESP_TX_JOBS) {
+		return NG;
+	}
+	pu8_Frame[0] = ESP_SOF1;
+	pu8_Frame[1] = ESP_SOF2;
+	u16_Crc = esp_crc16(&pu8_Frame[ESP_POS_TYPE], (uint16_t)(u16_Size - ESP_POS_TYPE));
+	pu8_Frame[u16_Size] = (uint8_t)u16_Crc;
+	pu8_Frame[u16_Size + 1] = (uint8_t)(u16_Crc >> 8);
+
+	pst_Job = &sts_EspTxJob[u8s_EspJobHead & (ESP_TX_JOBS - 1)];
+	pst_Job->pu8_data = pu8_Frame;
+	pst_Job->u16_size = (uint16_t)(u16_Size + ESP_CRC_SIZE);
+	pst_Job->u8_slot = u8_Slot;
+
+	u32_Mask = LL_IRQ_Lock(ESP_CEILING);
+	u8s_EspTxQueued[u8_Slot]++;
+	u8s_EspJobHead++;
+	if (!bls_EspTxActive) {
+		esp_tx_start();
+	}
+	LL_IRQ_Unlock(u32_Mask);
+	return OK;
+}
+
+/**
+  * @brief  制御フレームを送る
+  * @param  u8_Type: ESP_TYPE_ACK/SYNC/SYNC_ACK
+  * @retval true:登録した / false:前の制御フレームが送信待ち
+  */
+static bool esp_tx_control(uint8_t u8_Type)
+{
+	if (u8s_EspTxQueued[ESP_SLOT_CTL] != 0) {
+		return false;
+	}
+	u8s_EspCtlFrame[ESP_POS_TYPE] = u8_Type;
+	u8s_EspCtlFrame[ESP_POS_SEQ] = u8s_EspTxNext;
+	u8s_EspCtlFrame[ESP_POS_ACK] = u8s_EspRxExpect;
+	u8s_EspCtlFrame[ESP_POS_LEN] = 0;
+	return (esp_tx_queue(&u8s_EspCtlFrame[0], ESP_SLOT_CTL) == OK);
+}
+
+/**
+  * @brief  未送信のデータフレームを送る
+  * @param  None
+  * @retval None
+  * @note   送る直前の応答番号を載せる(送ったフレームが応答を兼ねる)
+  */
+static void esp_tx_seal(void)
+{
+	uint8_t *pu8_Frame;
+	uint8_t u8_Slot;
+
+	while (u8s_EspTxNext != u8s_EspTxEnd) {
+		u8_Slot = u8s_EspTxNext & ESP_WINDOW_MASK;
+		pu8_Frame = u8s_EspTxFrame[u8_Slot];
+		pu8_Frame[ESP_POS_SEQ] = u8s_EspTxNext;
+		pu8_Frame[ESP_POS_ACK] = u8s_EspRxExpect;
+		if (esp_tx_queue(pu8_Frame, u8_Slot) != OK) {
+			break;
+		}
+		if (u8s_EspTxNext == u8s_EspTxHigh) {
+			sts_EspStatistics.u32_tx_frames++;
+			sts_EspStatistics.u32_tx_bytes += pu8_Frame[ESP_POS_LEN];
+			u8s_EspTxHigh++;
+		}
+		else {
+			sts_EspStatistics.u32_retransmits++;
+		}
+		u8s_EspTxNext++;
+		bls_EspAckPending = false;
+	}
+}
+
+/**
+  * @brief  応答待ちのタイムアウトを確認する
+  * @param  None
+  * @retval None
+  * @note   DTC送信待ちが無くなってから未応答のフレームを全て送り直す
+  *         (送信中のフレームを書き換えないため)
+  */
+static void esp_tx_timeout(void)
+{
+	if (u8s_EspTxBase == u8s_EspTxHigh) {
+		u8s_EspRtoCycles = 0;
+		return;
+	}
+	if (u8s_EspRtoCycles < ESP_RTO_CYCLES) {
+		u8s_EspRtoCycles++;
+	}
+	if ((u8s_EspRtoCycles < ESP_RTO_CYCLES) || bls_EspTxActive) {
+		return;
+	}
+	u8s_EspRtoCycles = 0;
+	sts_EspStatistics.u32_timeouts++;
+	if (++u8s_EspRetries > ESP_RETRY_MAX) {
+		esp_link_sync();
+		return;
+	}
+	u8s_EspTxNext = u8s_EspTxBase;
+}
+
+/**
+  * @brief  開始前のDTC送信待ちを捨てる
+  * @param  None
+  * @retval None
+  * @note   同期で番号を0に戻す時、前の番号のフレームを後から送らないため
+  */
+static void esp_tx_flush(void)
+{
+	uint32_t u32_Mask;
+
+	u32_Mask = LL_IRQ_Lock(ESP_CEILING);
+	while ((uint8_t)(u8s_EspJobHead - u8s_EspJobTail) > (bls_EspTxActive ? 1 : 0)) {
+		u8s_EspJobHead--;
+		u8s_EspTxQueued[sts_EspTxJob[u8s_EspJobHead & (ESP_TX_JOBS - 1)].u8_slot]--;
+	}
+	LL_IRQ_Unlock(u32_Mask);
+}
+
+/**
+  * @brief  次のフレームのDTC転送を開始する
+  * @param  None
+  * @retval None
+  * @note   割り込み禁止区間(ESP_CEILING)またはSCI9_TXI_Handlerから呼び出す。
+  *         送信データエンプティ割り込みは空になった時だけ発生するため、
+  *         既に空なら先頭の1byteをCPUで書き込む(フレームは8byte以上)
+  */
+static void esp_tx_start(void)
+{
+	const EspTxJob *pst_Job;
+
+	if (u8s_EspJobTail == u8s_EspJobHead) {
+		bls_EspTxActive = false;
+		return;
+	}
+	pst_Job = &sts_EspTxJob[u8s_EspJobTail & (ESP_TX_JOBS - 1)];
+	sts_EspDtcTx.u32_mode = DTC_MD_NORMAL | DTC_SZ_BYTE | DTC_SM_INC | DTC_DM_FIXED;
+	sts_EspDtcTx.pv_src = pst_Job->pu8_data;
+	sts_EspDtcTx.pv_dst = &R_SCI9->TDR;
+	sts_EspDtcTx.u16_crb = 0;
+	sts_EspDtcTx.u16_cra = pst_Job->u16_size;
+	bls_EspTxActive = true;
+	LL_DTC_EnableIT(IRQ_SCI9_TXI);
+	if (R_SCI9->SSR_b.TDRE) {
+		esp_tx_put();
+	}
+}
+
+/**
+  * @brief  1byteをCPUで送信する
+  * @param  None
+  * @retval None
+  * @note   DTC転送情報を1byte分進める
+  */
+static void esp_tx_put(void)
+{
+	const volatile uint8_t *pu8_Src = (const volatile uint8_t *)sts_EspDtcTx.pv_src;
+
+	sts_EspDtcTx.pv_src = pu8_Src + 1;
+	sts_EspDtcTx.u16_cra--;
+	R_SCI9->TDR = *pu8_Src;
+}
+
+/**
+  * @brief  受信リングへの転送を設定する
+  * @param  None
+  * @retval None
+  */
+static void esp_rx_arm(void)
+{
+	sts_EspDtcRx.u32_mode = DTC_MD_NORMAL | DTC_SZ_BYTE | DTC_SM_FIXED | DTC_DM_INC;
+	sts_EspDtcRx.pv_src = &R_SCI9->RDR;
+	sts_EspDtcRx.pv_dst = &u8s_EspRxRing[0];
+	sts_EspDtcRx.u16_crb = 0;
+	sts_EspDtcRx.u16_cra = ESP_RX_RING_SIZE;
+}
+
+/**
+  * @brief  受信リングを解析する
+  * @param  None
+  * @retval None
+  * @note   書き込み位置はDTCの残り転送回数と周回数から求める(通算)。
+  *         解析が1周以上遅れた場合は未解析のデータを捨てて同期パターンから探す
+  */
+static void esp_rx_parse(void)
+{
+	uint32_t u32_Head;
+	uint32_t u32_Mask;
+
+	u32_Mask = LL_IRQ_Lock(ESP_CEILING);
+	u32_Head = (u32s_EspRxWraps * ESP_RX_RING_SIZE) + (ESP_RX_RING_SIZE - sts_EspDtcRx.u16_cra);
+	LL_IRQ_Unlock(u32_Mask);
+
+	if ((u32_Head - u32s_EspRxRead) > ESP_RX_RING_SIZE) {
+		sts_EspStatistics.u32_rx_overruns++;
+		u32s_EspRxRead = u32_Head;
+		u16s_EspRxPos = 0;
+	}
+	while (u32s_EspRxRead != u32_Head) {
+		esp_rx_byte(u8s_EspRxRing[u32s_EspRxRead & (ESP_RX_RING_SIZE - 1)]);
+		u32s_EspRxRead++;
+	}
+}
+
+/**
+  * @brief  受信データでフレームを組み立てる
+  * @param  u8_Data: 受信データ
+  * @retval None
+  */
+static void esp_rx_byte(uint8_t u8_Data)
+{
+	uint16_t u16_Size;
+	uint16_t u16_Crc;
+
+	/* 同期パターンを探す */
+	if ((u16s_EspRxPos == 0) && (u8_Data != ESP_SOF1)) {
+		return;
+	}
+	if ((u16s_EspRxPos == 1) && (u8_Data != ESP_SOF2)) {
+		u16s_EspRxPos = (u8_Data == ESP_SOF1) ? 1 : 0;
+		return;
+	}
+	u8s_EspRxFrame[u16s_EspRxPos++] = u8_Data;
+	if (u16s_EspRxPos < ESP_HEADER_SIZE) {
+		return;
+	}
+	if (u8s_EspRxFrame[ESP_POS_LEN] > ESP_PAYLOAD_MAX) {
+		sts_EspStatistics.u32_frame_errors++;
+		u16s_EspRxPos = 0;
+		return;
+	}
+	u16_Size = (uint16_t)(ESP_HEADER_SIZE + u8s_EspRxFrame[ESP_POS_LEN]);
+	if (u16s_EspRxPos < (u16_Size + ESP_CRC_SIZE)) {
+		return;
+	}
+
+	/* フレームの終わり */
+	u16s_EspRxPos = 0;
+	u16_Crc = (uint16_t)(u8s_EspRxFrame[u16_Size] | ((uint16_t)u8s_EspRxFrame[u16_Size + 1] << 8));
+	if (esp_crc16(&u8s_EspRxFrame[ESP_POS_TYPE], (uint16_t)(u16_Size - ESP_POS_TYPE)) != u16_Crc) {
+		sts_EspStatistics.u32_crc_errors++;
+		return;
+	}
+	esp_rx_frame();
+}
+
+/**
+  * @brief  受信フレームを処理する
+  * @param  None
+  * @retval None
+  */
+static void esp_rx_frame(void)
+{
+	uint8_t u8_Type = u8s_EspRxFrame[ESP_POS_TYPE] & ESP_TYPE_MASK;
+
+	switch (u8_Type) {
+	case ESP_TYPE_SYNC:
+		/* 相手が(再)起動した: 番号を0に戻して同期応答を返す */
+		esp_tx_flush();
+		esp_link_reset();
+		u8s_EspLink = ESP_LINK_UP;
+		bls_EspSyncAckPending = true;
+		sts_EspStatistics.u32_syncs++;
+		break;
+	case ESP_TYPE_SYNC_ACK:
+		if (u8s_EspLink == ESP_LINK_SYNC) {
+			u8s_EspLink = ESP_LINK_UP;
+			sts_EspStatistics.u32_syncs++;
+		}
+		break;
+	case ESP_TYPE_DATA:
+	case ESP_TYPE_ACK:
+		if (u8s_EspLink != ESP_LINK_UP) {
+			break;
+		}
+		esp_rx_ack(u8s_EspRxFrame[ESP_POS_ACK]);
+		if (u8_Type == ESP_TYPE_DATA) {
+			esp_rx_data(u8s_EspRxFrame[ESP_POS_TYPE] & ESP_CH_MASK, u8s_EspRxFrame[ESP_POS_SEQ],
+				&u8s_EspRxFrame[ESP_HEADER_SIZE], u8s_EspRxFrame[ESP_POS_LEN]);
+		}
+		break;
+	default:
+		sts_EspStatistics.u32_frame_errors++;
+		break;
+	}
+}
+
+/**
+  * @brief  応答番号を処理する
+  * @param  u8_Ack: 応答番号(相手が次に受け取る送信番号)
+  * @retval None
+  */
+static void esp_rx_ack(uint8_t u8_Ack)
+{
+	uint8_t u8_Acked = (uint8_t)(u8_Ack - u8s_EspTxBase);
+
+	/* 古い応答/送っていない番号への応答は無視する */
+	if ((u8_Acked == 0) || (u8_Acked > (uint8_t)(u8s_EspTxHigh - u8s_EspTxBase))) {
+		return;
+	}
+	u8s_EspTxBase = u8_Ack;
+	/* 送り直しの途中で応答された分は送らない */
+	if ((uint8_t)(u8s_EspTxNext - u8s_EspTxBase) > (uint8_t)(u8s_EspTxHigh - u8s_EspTxBase)) {
+		u8s_EspTxNext = u8s_EspTxBase;
+	}
+	u8s_EspRtoCycles = 0;
+	u8s_EspRetries = 0;
+}
+
+/**
+  * @brief  データフレームを受け取る
+  * @param  u8_Ch: チャネル
+  * @param  u8_Seq: 送信番号
+  * @param  pu8_Data: データ
+  * @param  u8_Size: データ数
+  * @retval None
+  * @note   順序外のフレームは捨てて、受け取った位置を応答し直す
+  */
+static void esp_rx_data(uint8_t u8_Ch, uint8_t u8_Seq, const uint8_t *pu8_Data, uint8_t u8_Size)
+{
+	bls_EspAckPending = true;
+	if (u8_Seq != u8s_EspRxExpect) {
+		sts_EspStatistics.u32_seq_errors++;
+		return;
+	}
+	if ((u8_Ch < ESP_CH_NUM) && (pfs_EspRxCallback[u8_Ch] != NULL) && (u8_Size > 0)) {
+		if (!pfs_EspRxCallback[u8_Ch](u8_Ch, pu8_Data, u8_Size)) {
+			sts_EspStatistics.u32_rx_refused++;
+			return;
+		}
+	}
+	u8s_EspRxExpect++;
+	sts_EspStatistics.u32_rx_frames++;
+	sts_EspStatistics.u32_rx_bytes += u8_Size;
+}
+
+/**
+  * @brief  クロック変更コールバック
+  * @param  u8_Event: CLOCK_EVENT_xxx
+  * @param  u8_Mode: 切り替え先の動作モード
+  * @retval OK/NG(通信中に高速モード以外へ切り替える)
+  * @note   切り替え後はボーレートを設定し直す(送信中のフレームは再送で回復する)
+  */
+static uint8_t esp_clock_callback(uint8_t u8_Event, uint8_t u8_Mode)
+{
+	switch (u8_Event) {
+	case CLOCK_EVENT_PRE:
+		if ((u8s_EspLink != ESP_LINK_CLOSED) && (u8_Mode != CLOCK_MODE_HIGH)) {
+			return NG;
+		}
+		break;
+	case CLOCK_EVENT_POST:
+		if (u8s_EspLink != ESP_LINK_CLOSED) {
+			R_SCI9->SCR = 0x00;
+			(void)esp_set_baudrate();
+			R_SCI9->SCR = ESP_SCR_ON;
+		}
+		break;
+	default:
+		break;
+	}
+	return OK;
+}
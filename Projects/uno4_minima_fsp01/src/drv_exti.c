@@ -0,0 +1,446 @@
+/**
+  ******************************************************************************
+  * @file           : drv_exti.c
+  * @brief          : 外部端子割り込み(IRQ0～IRQ15)ドライバー
+  ******************************************************************************
+  * @note   割り込み処理ではエッジの時刻[us]と端子レベルをイベントFIFOに
+  *         登録するだけとし、デバウンスとパルス幅/周期の計測は
+  *         extiGetEvent()でイベントを取り出す時にタイムスタンプから求める。
+  *         イベントFIFOは割り込み処理が書き込み、周期処理が読み出す
+  *         1対1のリングバッファのため割り込み禁止は不要。
+  *         (全チャネルを同じ優先度にして割り込み処理同士の多重を防ぐ)
+  *         クロック変更時は切り替え時点までを変更前のクロックで換算して
+  *         時刻の基準を更新し、時刻が跳ばないようにする。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "drv.h"
+#include "lib.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* チャネル情報 */
+typedef struct _ExtiChannel {
+	ExtiConfig st_config;			/* 設定									*/
+	uint8_t u8_slot;				/* 割り当てたICUスロット(EXTI_SLOT_NONE:未使用)	*/
+	bool bl_accepted;				/* デバウンス後のエッジ受付済み			*/
+	uint32_t u32_accept_us;			/* 最後に受け付けたエッジの時刻[us]		*/
+	bool bl_rise;					/* 立ち上がりエッジの時刻が有効			*/
+	uint32_t u32_rise_us;			/* 最後の立ち上がりエッジの時刻[us]		*/
+	bool bl_fall;					/* 立ち下がりエッジの時刻が有効			*/
+	uint32_t u32_fall_us;			/* 最後の立ち下がりエッジの時刻[us]		*/
+	ExtiMeasure st_measure;			/* 計測結果								*/
+} ExtiChannel;
+
+/* Private define ------------------------------------------------------------*/
+#define EXTI_FIFO_SIZE		(32)					/* イベントFIFOサイズ(2のべき乗)	*/
+#define EXTI_SLOT_NONE		(0xFF)					/* ICUスロット未割り当て			*/
+/* 時刻の基準のシーリング(extiGetTimeUsを呼ぶPORT_IRQn/SCI1/IIC1/SPI0の割り込み) */
+#define EXTI_TIME_CEILING	(IRQ_PRIO_HIGHER(IRQ_PRIO_HIGHER(IRQ_PRIO_PORT_IRQ, IRQ_PRIO_SCI1), \
+							 IRQ_PRIO_HIGHER(IRQ_PRIO_IIC1, IRQ_PRIO_SPI0)))
+
+/* IRQCR */
+#define EXTI_IRQCR_FLTEN	(0x80)					/* デジタルフィルタ有効				*/
+#define EXTI_IRQCR_FCLKSEL(n)	((uint8_t)((n) << 4))	/* フィルタクロック選択			*/
+
+/* PmnPFS */
+#define EXTI_PFS_PCR		(0x00000010UL)			/* 入力プルアップ					*/
+#define EXTI_PFS_ISEL		(0x00004000UL)			/* IRQ入力端子						*/
+
+/* Private macro -------------------------------------------------------------*/
+/* ポートのレジスタ(PORTnのアドレス間隔から求める) */
+#define EXTI_PORT(port)		((R_PORT0_Type *)((uintptr_t)R_PORT0 + (((uintptr_t)R_PORT1 - (uintptr_t)R_PORT0) * (port))))
+
+/* Private variables ---------------------------------------------------------*/
+static ExtiChannel sts_ExtiChannel[EXTI_CH_NUM];			/* チャネル情報					*/
+static uint8_t u8s_ExtiSlotChannel[IRQ_PORT_IRQ_NUM];		/* ICUスロット毎のチャネル		*/
+
+/* イベントFIFO(割り込み処理→周期処理) */
+static ExtiEvent sts_ExtiFifo[EXTI_FIFO_SIZE];
+volatile static uint16_t u16s_ExtiFifoHead;					/* 書き込み位置(割り込み処理)	*/
+volatile static uint16_t u16s_ExtiFifoTail;					/* 読み出し位置(周期処理)		*/
+volatile static uint32_t u32s_ExtiOverflow;					/* FIFOあふれで捨てたイベント数	*/
+
+/* 時刻[us]の基準(周期処理で更新し、DWTサイクルカウンターの一周を跨がないようにする) */
+volatile static uint32_t u32s_ExtiBaseCycle;				/* 基準のサイクル数				*/
+volatile static uint32_t u32s_ExtiBaseUs;					/* 基準の時刻[us]				*/
+volatile static uint32_t u32s_ExtiCycleMhz;					/* サイクルカウンターの周波数[MHz]	*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void exti_isr(uint8_t u8_Slot);						/* 外部端子割り込み共通処理				*/
+static void exti_process(ExtiChannel *pst_Ch, const ExtiEvent *pst_Event);	/* デバウンスと計測	*/
+static uint8_t exti_clock_callback(uint8_t u8_Event, uint8_t u8_Mode);	/* クロック変更コールバック	*/
+static void PORT_IRQ_Slot0_Handler(void);
+static void PORT_IRQ_Slot1_Handler(void);
+static void PORT_IRQ_Slot2_Handler(void);
+static void PORT_IRQ_Slot3_Handler(void);
+
+/* ICUスロット毎の割り込みハンドラ */
+static void (*const cpfs_ExtiHandler[IRQ_PORT_IRQ_NUM])(void) = {
+	PORT_IRQ_Slot0_Handler,
+	PORT_IRQ_Slot1_Handler,
+	PORT_IRQ_Slot2_Handler,
+	PORT_IRQ_Slot3_Handler,
+};
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  外部端子割り込みドライバー初期化処理
+  * @param  None
+  * @retval None
+  */
+void taskExtiDriverInit(void)
+{
+	uint8_t _i;
+
+	for (_i=0; _i<EXTI_CH_NUM; _i++) {
+		mem_set08((uint8_t *)&sts_ExtiChannel[_i], 0, sizeof(ExtiChannel));
+		sts_ExtiChannel[_i].u8_slot = EXTI_SLOT_NONE;
+	}
+	for (_i=0; _i<IRQ_PORT_IRQ_NUM; _i++) {
+		u8s_ExtiSlotChannel[_i] = EXTI_CH_NUM;
+	}
+	u16s_ExtiFifoHead = 0;
+	u16s_ExtiFifoTail = 0;
+	u32s_ExtiOverflow = 0;
+	u32s_ExtiCycleMhz = SystemCoreClock / 1000000;
+	u32s_ExtiBaseCycle = LL_DWT_GetCycle();
+	u32s_ExtiBaseUs = 0;
+
+	/* ---- クロック変更の通知先を登録する ---- */
+	if (clockRegisterCallback(exti_clock_callback) != OK) {
+		Error_Handler();
+	}
+}
+
+/**
+  * @brief  外部端子割り込みドライバー入力処理
+  * @param  None
+  * @retval None
+  * @note   時刻[us]の基準を更新する(DWTサイクルカウンターは48MHzで約89秒で一周する)
+  */
+void taskExtiDriverInput(void)
+{
+	uint32_t u32_Now = extiGetTimeUs();
+	uint32_t u32_Mask;
+
+	/* シーリング以下の優先度の割り込みを保留(BASEPRI) */
+	u32_Mask = LL_IRQ_Lock(EXTI_TIME_CEILING);
+	u32s_ExtiBaseCycle = LL_DWT_GetCycle();
+	u32s_ExtiBaseUs = u32_Now;
+	/* BASEPRIを元に戻す */
+	LL_IRQ_Unlock(u32_Mask);
+}
+
+/**
+  * @brief  外部端子割り込みを開始する
+  * @param  u8_Ch: チャネル(IRQ0～IRQ15)
+  * @param  pst_Config: 設定
+  * @retval OK/NG(チャネル使用中,ICUスロット不足,設定値異常)
+  * @note   端子がIRQnに対応しているかはハードウェアマニュアルの端子機能表で
+  *         確認すること(例: IRQ0 = P105(D2))
+  */
+uint8_t extiOpen(uint8_t u8_Ch, const ExtiConfig *pst_Config)
+{
+	ExtiChannel *pst_Ch;
+	uint8_t u8_Slot;
+	uint8_t u8_Irq;
+	uint8_t u8_Irqcr;
+	uint32_t u32_Pfs;
+	uint32_t u32_Mask;
+
+	if ((u8_Ch >= EXTI_CH_NUM) || (pst_Config->u8_port >= GPIO_PORT_NUM) || (pst_Config->u8_pin >= 16)
+	 || (pst_Config->u8_edge > EXTI_EDGE_BOTH) || (pst_Config->u8_filter > EXTI_FILTER_OFF)) {
+		return NG;
+	}
+	pst_Ch = &sts_ExtiChannel[u8_Ch];
+	if (pst_Ch->u8_slot != EXTI_SLOT_NONE) {
+		return NG;
+	}
+	/* 空いているICUスロットを割り当てる */
+	for (u8_Slot=0; u8_Slot<IRQ_PORT_IRQ_NUM; u8_Slot++) {
+		if (u8s_ExtiSlotChannel[u8_Slot] >= EXTI_CH_NUM) {
+			break;
+		}
+	}
+	if (u8_Slot >= IRQ_PORT_IRQ_NUM) {
+		return NG;
+	}
+	u8_Irq = (uint8_t)(IRQ_PORT_IRQ_FIRST + u8_Slot);
+
+	mem_set08((uint8_t *)pst_Ch, 0, sizeof(ExtiChannel));
+	pst_Ch->st_config = *pst_Config;
+	pst_Ch->u8_slot = u8_Slot;
+	u8s_ExtiSlotChannel[u8_Slot] = u8_Ch;
+
+	/* ---- ベクターテーブル登録 ---- */
+	u32_Mask = LL_IRQ_Lock(IRQ_PRIO_PORT_IRQ);
+	NVIC_SetVector((IRQn_Type)u8_Irq, (uintptr_t)cpfs_ExtiHandler[u8_Slot]);
+	LL_IRQ_Unlock(u32_Mask);
+
+	/* ---- PORT_IRQn 無効 ---- */
+	R_ICU->IELSR[u8_Irq] = 0x00000000;
+	R_ICU->IRQCR[u8_Ch] = 0x00;
+
+	/* ---- ポート設定 ---- */
+	// 汎用入力端子, IRQn入力端子(入力プルアップは設定による)
+	u32_Pfs = EXTI_PFS_ISEL;
+	if (pst_Config->bl_pullup) {
+		u32_Pfs |= EXTI_PFS_PCR;
+	}
+	R_BSP_PinAccessEnable();
+	R_PFS->PORT[pst_Config->u8_port].PIN[pst_Config->u8_pin].PmnPFS = u32_Pfs;
+	R_BSP_PinAccessDisable();
+
+	/* ---- PORT_IRQn 設定 ---- */
+	u8_Irqcr = pst_Config->u8_edge;
+	if (pst_Config->u8_filter != EXTI_FILTER_OFF) {
+		u8_Irqcr |= EXTI_IRQCR_FCLKSEL(pst_Config->u8_filter) | EXTI_IRQCR_FLTEN;
+	}
+	R_ICU->IRQCR[u8_Ch] = u8_Irqcr;
+
+	/* ---- ICU → NVIC 割り込み割り当て ---- */
+	R_ICU->IELSR_b[u8_Irq].IR = 0;						// 割り込み要求フラグ クリア
+	R_ICU->IELSR_b[u8_Irq].IELS = (uint32_t)(ELC_EVENT_ICU_IRQ0 + u8_Ch);	// PORT_IRQn
+
+	/* ---- NVIC 設定 ---- */
+	NVIC_ClearPendingIRQ((IRQn_Type)u8_Irq);
+	NVIC_SetPriority((IRQn_Type)u8_Irq, IRQ_PRIO_PORT_IRQ);
+	NVIC_EnableIRQ((IRQn_Type)u8_Irq);
+	return OK;
+}
+
+/**
+  * @brief  外部端子割り込みを停止する
+  * @param  u8_Ch: チャネル(IRQ0～IRQ15)
+  * @retval None
+  * @note   FIFOに残っている当該チャネルのイベントは読み出し時に捨てる
+  */
+void extiClose(uint8_t u8_Ch)
+{
+	ExtiChannel *pst_Ch;
+	uint8_t u8_Irq;
+
+	if (u8_Ch >= EXTI_CH_NUM) {
+		return;
+	}
+	pst_Ch = &sts_ExtiChannel[u8_Ch];
+	if (pst_Ch->u8_slot == EXTI_SLOT_NONE) {
+		return;
+	}
+	u8_Irq = (uint8_t)(IRQ_PORT_IRQ_FIRST + pst_Ch->u8_slot);
+
+	NVIC_DisableIRQ((IRQn_Type)u8_Irq);
+	R_ICU->IELSR[u8_Irq] = 0x00000000;
+	R_ICU->IRQCR[u8_Ch] = 0x00;
+	NVIC_ClearPendingIRQ((IRQn_Type)u8_Irq);
+
+	u8s_ExtiSlotChannel[pst_Ch->u8_slot] = EXTI_CH_NUM;
+	pst_Ch->u8_slot = EXTI_SLOT_NONE;
+}
+
+/**
+  * @brief  デバウンス後のエッジイベントを取得する
+  * @param  pst_Event: イベントの格納先
+  * @retval true:取得 / false:イベント無し
+  * @note   デバウンス時間内のエッジ(チャタリング)は計測結果の
+  *         u32_bounces に数えて捨てる
+  */
+bool extiGetEvent(ExtiEvent *pst_Event)
+{
+	ExtiChannel *pst_Ch;
+	uint16_t u16_Tail = u16s_ExtiFifoTail;
+
+	while (u16_Tail != u16s_ExtiFifoHead) {
+		/* 割り込み処理が書き込んだイベントを読み出してから読み出し位置を進める */
+		__DMB();
+		*pst_Event = sts_ExtiFifo[u16_Tail % EXTI_FIFO_SIZE];
+		__DMB();
+		u16_Tail++;
+		u16s_ExtiFifoTail = u16_Tail;
+
+		pst_Ch = &sts_ExtiChannel[pst_Event->u8_channel];
+		if (pst_Ch->u8_slot == EXTI_SLOT_NONE) {
+			continue;
+		}
+		if (pst_Ch->bl_accepted
+		 && ((pst_Event->u32_time_us - pst_Ch->u32_accept_us) < pst_Ch->st_config.u32_debounce_us)) {
+			pst_Ch->st_measure.u32_bounces++;
+			continue;
+		}
+		exti_process(pst_Ch, pst_Event);
+		return true;
+	}
+	return false;
+}
+
+/**
+  * @brief  パルス幅/周期の計測結果を取得する
+  * @param  u8_Ch: チャネル(IRQ0～IRQ15)
+  * @param  pst_Measure: 計測結果の格納先
+  * @retval OK/NG
+  * @note   extiGetEvent()で取り出したエッジから求めるため、イベントを
+  *         読み出していない間は更新されない
+  */
+uint8_t extiGetMeasure(uint8_t u8_Ch, ExtiMeasure *pst_Measure)
+{
+	if (u8_Ch >= EXTI_CH_NUM) {
+		return NG;
+	}
+	*pst_Measure = sts_ExtiChannel[u8_Ch].st_measure;
+	return OK;
+}
+
+/**
+  * @brief  イベントFIFOのあふれで捨てたイベント数を取得する
+  * @param  None
+  * @retval イベント数
+  */
+uint32_t extiGetOverflowCount(void)
+{
+	return u32s_ExtiOverflow;
+}
+
+/**
+  * @brief  現在時刻[us]を取得する
+  * @param  None
+  * @retval 時刻[us](extiイベントのタイムスタンプと同じ基準)
+  */
+uint32_t extiGetTimeUs(void)
+{
+	return u32s_ExtiBaseUs + ((LL_DWT_GetCycle() - u32s_ExtiBaseCycle) / u32s_ExtiCycleMhz);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  クロック変更コールバック
+  * @param  u8_Event: CLOCK_EVENT_xxx
+  * @param  u8_Mode: 切り替え先の動作モード
+  * @retval OK
+  * @note   割り込み禁止中に呼ばれる
+  */
+static uint8_t exti_clock_callback(uint8_t u8_Event, uint8_t u8_Mode)
+{
+	uint32_t u32_Switch = clockGetSwitchCycle();
+
+	(void)u8_Mode;
+	if (u8_Event == CLOCK_EVENT_POST) {
+		u32s_ExtiBaseUs += (u32_Switch - u32s_ExtiBaseCycle) / u32s_ExtiCycleMhz;
+		u32s_ExtiBaseCycle = u32_Switch;
+		u32s_ExtiCycleMhz = SystemCoreClock / 1000000;
+	}
+	return OK;
+}
+
+/**
+  * @brief  外部端子割り込みハンドラ(ICUスロット0～3)
+  * @param  None
+  * @retval None
+  */
+static void PORT_IRQ_Slot0_Handler(void)
+{
+	exti_isr(0);
+}
+
+static void PORT_IRQ_Slot1_Handler(void)
+{
+	exti_isr(1);
+}
+
+static void PORT_IRQ_Slot2_Handler(void)
+{
+	exti_isr(2);
+}
+
+static void PORT_IRQ_Slot3_Handler(void)
+{
+	exti_isr(3);
+}
+
+/**
+  * @brief  外部端子割り込み共通処理
+  * @param  u8_Slot: ICUスロット
+  * @retval None
+  */
+static void exti_isr(uint8_t u8_Slot)
+{
+	uint8_t u8_Ch = u8s_ExtiSlotChannel[u8_Slot];
+	uint32_t u32_Time = extiGetTimeUs();
+	uint16_t u16_Head = u16s_ExtiFifoHead;
+	const ExtiConfig *pst_Config;
+	ExtiEvent *pst_Event;
+
+	/* 割り込み要求フラグ クリア */
+	R_ICU->IELSR_b[IRQ_PORT_IRQ_FIRST + u8_Slot].IR = 0;
+
+	if (u8_Ch >= EXTI_CH_NUM) {
+		return;
+	}
+	/* FIFOが満杯の場合は新しいイベントを捨てる */
+	if ((uint16_t)(u16_Head - u16s_ExtiFifoTail) >= EXTI_FIFO_SIZE) {
+		u32s_ExtiOverflow++;
+		return;
+	}
+	pst_Config = &sts_ExtiChannel[u8_Ch].st_config;
+	pst_Event = &sts_ExtiFifo[u16_Head % EXTI_FIFO_SIZE];
+	pst_Event->u32_time_us = u32_Time;
+	pst_Event->u8_channel = u8_Ch;
+	pst_Event->u8_level = (uint8_t)((EXTI_PORT(pst_Config->u8_port)->PIDR >> pst_Config->u8_pin) & 0x01);
+	/* イベントを書き込んでから書き込み位置を進める */
+	__DMB();
+	u16s_ExtiFifoHead = (uint16_t)(u16_Head + 1);
+}
+
+/**
+  * @brief  受け付けたエッジでパルス幅/周期を更新する
+  * @param  pst_Ch: チャネル情報
+  * @param  pst_Event: イベント
+  * @retval None
+  * @note   両エッジ検出ではHigh/Low幅と立ち上がり間隔を、片エッジ検出では
+  *         同じエッジの間隔を周期とする
+  */
+static void exti_process(ExtiChannel *pst_Ch, const ExtiEvent *pst_Event)
+{
+	ExtiMeasure *pst_Measure = &pst_Ch->st_measure;
+	uint32_t u32_Time = pst_Event->u32_time_us;
+	bool bl_Rising;
+
+	/* 両エッジ検出ではエッジ後の端子レベルで向きを判定する */
+	if (pst_Ch->st_config.u8_edge == EXTI_EDGE_BOTH) {
+		bl_Rising = (pst_Event->u8_level != LOW);
+	}
+	else {
+		bl_Rising = (pst_Ch->st_config.u8_edge == EXTI_EDGE_RISING);
+	}
+
+	if (bl_Rising) {
+		if (pst_Ch->bl_rise) {
+			pst_Measure->u32_period_us = u32_Time - pst_Ch->u32_rise_us;
+		}
+		if (pst_Ch->bl_fall && (pst_Ch->st_config.u8_edge == EXTI_EDGE_BOTH)) {
+			pst_Measure->u32_low_us = u32_Time - pst_Ch->u32_fall_us;
+		}
+		pst_Ch->bl_rise = true;
+		pst_Ch->u32_rise_us = u32_Time;
+	}
+	else {
+		if (pst_Ch->bl_fall && (pst_Ch->st_config.u8_edge != EXTI_EDGE_BOTH)) {
+			pst_Measure->u32_period_us = u32_Time - pst_Ch->u32_fall_us;
+		}
+		if (pst_Ch->bl_rise && (pst_Ch->st_config.u8_edge == EXTI_EDGE_BOTH)) {
+			pst_Measure->u32_high_us = u32_Time - pst_Ch->u32_rise_us;
+		}
+		pst_Ch->bl_fall = true;
+		pst_Ch->u32_fall_us = u32_Time;
+	}
+	if (pst_Measure->u32_period_us != 0) {
+		pst_Measure->u32_freq_mhz = 1000000000UL / pst_Measure->u32_period_us;
+	}
+	pst_Measure->u32_edges++;
+	pst_Ch->bl_accepted = true;
+	pst_Ch->u32_accept_us = u32_Time;
+}
@@ -0,0 +1,284 @@
+/**
+  ******************************************************************************
+  * @file           : drv_gpio.c
+  * @brief          : GPIOドライバー
+  ******************************************************************************
+  * @note   出力はPCNTR3(上位16bit:PORR,下位16bit:POSR)への1回の書き込みで
+  *         行うため、割り込み禁止無しで他の端子(割り込み処理で操作する端子を
+  *         含む)を壊さない。PODRのビットフィールド操作は使用しないこと。
+  *         エッジ検出(gpioEdgeWatch/gpioGetEdge)は周期処理(SYS_CYCLE_TIME毎)と
+  *         gpioGetEdge()の呼び出し時にPIDRをサンプリングして前回との差で求めるため、
+  *         サンプリングの間に戻るパルス(1周期より短いパルス)は検出できない。
+  *         短いパルスは外部端子割り込み(drv_exti.c)を使用すること。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "drv.h"
+#include "lib.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* エッジ検出情報 */
+typedef struct _GpioEdge {
+	uint16_t u16_watch;				/* 検出対象の端子						*/
+	uint16_t u16_level;				/* 前回の入力レベル						*/
+	uint16_t u16_rise;				/* 立ち上がりエッジ(未読み出し)			*/
+	uint16_t u16_fall;				/* 立ち下がりエッジ(未読み出し)			*/
+} GpioEdge;
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+/* ポートのレジスタ(PORTnのアドレス間隔から求める) */
+#define GPIO_PORT(port)		((R_PORT0_Type *)((uintptr_t)R_PORT0 + (((uintptr_t)R_PORT1 - (uintptr_t)R_PORT0) * (port))))
+/* PCNTR3 設定値 */
+#define GPIO_PCNTR3(set, clear)	(((uint32_t)(uint16_t)(clear) << 16) | (uint16_t)(set))
+
+/* Private variables ---------------------------------------------------------*/
+static GpioEdge sts_GpioEdge[GPIO_PORT_NUM];				/* エッジ検出情報				*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void gpio_sample_edge(uint8_t u8_Port);				/* 入力レベルを取得してエッジを検出する	*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  GPIOドライバー初期化処理
+  * @param  None
+  * @retval None
+  */
+void taskGpioDriverInit(void)
+{
+	mem_set08((uint8_t *)&sts_GpioEdge[0], 0, sizeof(sts_GpioEdge));
+}
+
+/**
+  * @brief  GPIOドライバー入力処理
+  * @param  None
+  * @retval None
+  * @note   エッジ検出対象の端子を周期毎にサンプリングする
+  */
+void taskGpioDriverInput(void)
+{
+	uint8_t _i;
+
+	for (_i=0; _i<GPIO_PORT_NUM; _i++) {
+		if (sts_GpioEdge[_i].u16_watch != 0) {
+			gpio_sample_edge(_i);
+		}
+	}
+}
+
+/**
+  * @brief  端子を出力方向にする
+  * @param  u8_Port: ポート番号
+  * @param  u16_Mask: 端子のマスク
+  * @retval None
+  * @note   PDRはセット/リセットレジスタが無いため割り込みを禁止(GPIO_PDR_CEILING)して更新する
+  */
+void gpioSetOutput(uint8_t u8_Port, uint16_t u16_Mask)
+{
+	uint32_t u32_Mask;
+
+	/* シーリング以下の優先度の割り込みを保留(BASEPRI) */
+	u32_Mask = LL_IRQ_Lock(GPIO_PDR_CEILING);
+	GPIO_PORT(u8_Port)->PDR |= u16_Mask;
+	/* BASEPRIを元に戻す */
+	LL_IRQ_Unlock(u32_Mask);
+}
+
+/**
+  * @brief  端子を入力方向にする
+  * @param  u8_Port: ポート番号
+  * @param  u16_Mask: 端子のマスク
+  * @retval None
+  */
+void gpioSetInput(uint8_t u8_Port, uint16_t u16_Mask)
+{
+	uint32_t u32_Mask;
+
+	/* シーリング以下の優先度の割り込みを保留(BASEPRI) */
+	u32_Mask = LL_IRQ_Lock(GPIO_PDR_CEILING);
+	GPIO_PORT(u8_Port)->PDR &= (uint16_t)~u16_Mask;
+	/* BASEPRIを元に戻す */
+	LL_IRQ_Unlock(u32_Mask);
+}
+
+/**
+  * @brief  端子をHigh出力する
+  * @param  u8_Port: ポート番号
+  * @param  u16_Mask: 端子のマスク
+  * @retval None
+  */
+void gpioSet(uint8_t u8_Port, uint16_t u16_Mask)
+{
+	GPIO_PORT(u8_Port)->POSR = u16_Mask;
+}
+
+/**
+  * @brief  端子をLow出力する
+  * @param  u8_Port: ポート番号
+  * @param  u16_Mask: 端子のマスク
+  * @retval None
+  */
+void gpioClear(uint8_t u8_Port, uint16_t u16_Mask)
+{
+	GPIO_PORT(u8_Port)->PORR = u16_Mask;
+}
+
+/**
+  * @brief  端子のHigh/Low出力を同時に行う
+  * @param  u8_Port: ポート番号
+  * @param  u16_SetMask: High出力する端子のマスク
+  * @param  u16_ClearMask: Low出力する端子のマスク
+  * @retval None
+  * @note   両方に指定した端子はLow出力になる
+  */
+void gpioWrite(uint8_t u8_Port, uint16_t u16_SetMask, uint16_t u16_ClearMask)
+{
+	GPIO_PORT(u8_Port)->PCNTR3 = GPIO_PCNTR3(u16_SetMask & ~u16_ClearMask, u16_ClearMask);
+}
+
+/**
+  * @brief  端子の出力を反転する
+  * @param  u8_Port: ポート番号
+  * @param  u16_Mask: 端子のマスク
+  * @retval None
+  * @note   PODRの読み出しから書き込みまでの間に他の端子が変化しても、
+  *         書き込みはマスクの端子だけに作用する
+  */
+void gpioToggle(uint8_t u8_Port, uint16_t u16_Mask)
+{
+	R_PORT0_Type *pst_Port = GPIO_PORT(u8_Port);
+	uint16_t u16_Output = pst_Port->PODR;
+
+	pst_Port->PCNTR3 = GPIO_PCNTR3(~u16_Output & u16_Mask, u16_Output & u16_Mask);
+}
+
+/**
+  * @brief  端子の入力レベルを取得する
+  * @param  u8_Port: ポート番号
+  * @retval 入力レベル(PIDR)
+  */
+uint16_t gpioRead(uint8_t u8_Port)
+{
+	return GPIO_PORT(u8_Port)->PIDR;
+}
+
+/**
+  * @brief  一括更新情報を初期化する
+  * @param  pst_Batch: 一括更新情報
+  * @retval None
+  */
+void gpioBatchInit(GpioBatch *pst_Batch)
+{
+	mem_set08((uint8_t *)pst_Batch, 0, sizeof(GpioBatch));
+}
+
+/**
+  * @brief  一括更新にHigh出力を登録する
+  * @param  pst_Batch: 一括更新情報
+  * @param  u8_Port: ポート番号
+  * @param  u16_Mask: 端子のマスク
+  * @retval None
+  * @note   同じ端子に対しては後から登録した出力が有効になる
+  */
+void gpioBatchSet(GpioBatch *pst_Batch, uint8_t u8_Port, uint16_t u16_Mask)
+{
+	pst_Batch->u16_set[u8_Port] |= u16_Mask;
+	pst_Batch->u16_clear[u8_Port] &= (uint16_t)~u16_Mask;
+	pst_Batch->u16_dirty |= (uint16_t)(1U << u8_Port);
+}
+
+/**
+  * @brief  一括更新にLow出力を登録する
+  * @param  pst_Batch: 一括更新情報
+  * @param  u8_Port: ポート番号
+  * @param  u16_Mask: 端子のマスク
+  * @retval None
+  */
+void gpioBatchClear(GpioBatch *pst_Batch, uint8_t u8_Port, uint16_t u16_Mask)
+{
+	pst_Batch->u16_clear[u8_Port] |= u16_Mask;
+	pst_Batch->u16_set[u8_Port] &= (uint16_t)~u16_Mask;
+	pst_Batch->u16_dirty |= (uint16_t)(1U << u8_Port);
+}
+
+/**
+  * @brief  一括更新を出力する
+  * @param  pst_Batch: 一括更新情報
+  * @retval None
+  * @note   登録のあったポートだけ、ポート毎に1回PCNTR3を書き込む
+  */
+void gpioBatchApply(const GpioBatch *pst_Batch)
+{
+	uint16_t u16_Dirty = pst_Batch->u16_dirty;
+	uint8_t _i;
+
+	for (_i=0; u16_Dirty!=0; _i++, u16_Dirty>>=1) {
+		if (u16_Dirty & 0x0001) {
+			GPIO_PORT(_i)->PCNTR3 = GPIO_PCNTR3(pst_Batch->u16_set[_i], pst_Batch->u16_clear[_i]);
+		}
+	}
+}
+
+/**
+  * @brief  エッジ検出対象の端子を設定する
+  * @param  u8_Port: ポート番号
+  * @param  u16_Mask: 端子のマスク(0:検出しない)
+  * @retval None
+  */
+void gpioEdgeWatch(uint8_t u8_Port, uint16_t u16_Mask)
+{
+	GpioEdge *pst_Edge = &sts_GpioEdge[u8_Port];
+
+	pst_Edge->u16_watch = u16_Mask;
+	pst_Edge->u16_level = GPIO_PORT(u8_Port)->PIDR;
+	pst_Edge->u16_rise = 0;
+	pst_Edge->u16_fall = 0;
+}
+
+/**
+  * @brief  検出したエッジを取得する
+  * @param  u8_Port: ポート番号
+  * @param  u16_Mask: 端子のマスク
+  * @param  u8_Edge: GPIO_EDGE_RISING/GPIO_EDGE_FALLING/GPIO_EDGE_BOTH
+  * @retval エッジを検出した端子(取得した端子のエッジはクリアする)
+  * @note   前回の周期処理以降の変化も取得のため入力レベルを再サンプリングする
+  */
+uint16_t gpioGetEdge(uint8_t u8_Port, uint16_t u16_Mask, uint8_t u8_Edge)
+{
+	GpioEdge *pst_Edge = &sts_GpioEdge[u8_Port];
+	uint16_t u16_Result = 0;
+
+	gpio_sample_edge(u8_Port);
+	if (u8_Edge & GPIO_EDGE_RISING) {
+		u16_Result |= pst_Edge->u16_rise & u16_Mask;
+		pst_Edge->u16_rise &= (uint16_t)~u16_Mask;
+	}
+	if (u8_Edge & GPIO_EDGE_FALLING) {
+		u16_Result |= pst_Edge->u16_fall & u16_Mask;
+		pst_Edge->u16_fall &= (uint16_t)~u16_Mask;
+	}
+	return u16_Result;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  入力レベルを取得してエッジを検出する
+  * @param  u8_Port: ポート番号
+  * @retval None
+  */
+static void gpio_sample_edge(uint8_t u8_Port)
+{
+	GpioEdge *pst_Edge = &sts_GpioEdge[u8_Port];
+	uint16_t u16_Level = GPIO_PORT(u8_Port)->PIDR;
+	uint16_t u16_Changed = (uint16_t)((u16_Level ^ pst_Edge->u16_level) & pst_Edge->u16_watch);
+
+	pst_Edge->u16_rise |= u16_Changed & u16_Level;
+	pst_Edge->u16_fall |= u16_Changed & (uint16_t)~u16_Level;
+	pst_Edge->u16_level = u16_Level;
+}
@@ -0,0 +1,807 @@
+/**
+  ******************************************************************************
+  * @file           : drv_iic.c
+  * @brief          : IICドライバー(IIC1 マスター)
+  ******************************************************************************
+  * @note   IIC1(SCL1:P100/A5, SDA1:P101/A4)をマスターとして動作させる。
+  *         転送要求(書き込み,読み出し,書き込み後の再スタート読み出し)は
+  *         Queueに登録し、割り込みで順番に実行する。呼び出し元は転送の完了を
+  *         待たず、完了コールバックは周期処理(taskIicDriverInput)から呼ばれる。
+  *         - スタート/再スタートはSTART検出(EEI)でスレーブアドレスを送信する。
+  *         - IIC_DTC_MIN 以上の送信データはTXI起動のDTCで、受信データは
+  *           最後の3byteを除いてRXI起動のDTCで転送する。最後の3byteはWAIT
+  *           (9クロック目でSCL Low保持)とACKBT(最後のNACK)の設定のためCPUで読む。
+  *         - タイムアウト検出(ICFER.TMOE)でSCLの固定(クロックストレッチ等)を
+  *           検出し、周期数による転送全体のタイムアウトも監視する。
+  *         - タイムアウト/アービトレーションロスト後は内部リセットを行い、
+  *           SDAがLowのままならSCLを1周期に1クロックずつ追加出力して
+  *           スレーブを解放させる(バス復旧)。
+  *         A4/A5をアナログ入力(adcStart)と同時に使用することはできない。
+  *         外付けのプルアップ抵抗を推奨する(内蔵プルアップも有効にする)。
+  *         クロック変更時は転送速度を設定し直す。転送中の変更は拒否する。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "drv.h"
+#include "lib.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* 転送要求Queueの要素 */
+typedef struct _IicSlot {
+	IicTransfer st_xfer;			/* 転送要求								*/
+	uint8_t u8_result;				/* 結果(IIC_RESULT_xxx)					*/
+	volatile bool bl_done;			/* 転送終了(完了通知待ち)				*/
+	uint32_t u32_time_us;			/* 転送時間[us]							*/
+} IicSlot;
+
+/* Private define ------------------------------------------------------------*/
+#define IIC_BITRATE			(100000)				/* 転送速度[bps](標準モード)	*/
+#define IIC_RISE_FALL_NS	(1300)					/* SCL立ち上がり+立ち下がり時間[ns]	*/
+#define IIC_BR_MAX			(32)					/* ICBRH/ICBRL+1の上限			*/
+#define IIC_CKS_MAX			(7)						/* ICMR1.CKS最大(IICφ=PCLKB/128)	*/
+#define IIC_DTC_MIN			(4)						/* DTCで転送する最小データ数	*/
+#define IIC_RX_CPU_BYTES	(3)						/* CPUで読む受信データ数(最後)	*/
+#define IIC_XFER_TIMEOUT	(10)					/* 転送のタイムアウト[周期]		*/
+#define IIC_RECOVERY_CLOCKS	(9)						/* バス復旧で追加出力するSCLの上限	*/
+#define IIC_RECOVERY_CYCLES	(40)					/* バス復旧を諦めるまでの周期数	*/
+#define IIC_CEILING			(IRQ_PRIO_IIC1)			/* 転送Queue/状態のシーリング(IIC1_RXI/TXI/TEI/EEI)	*/
+
+/* 転送の段階 */
+#define IIC_PHASE_IDLE		(0)						/* 停止中						*/
+#define IIC_PHASE_START		(1)						/* スタート条件の発行中			*/
+#define IIC_PHASE_TX		(2)						/* 送信中(アドレス+W,データ)	*/
+#define IIC_PHASE_RESTART	(3)						/* 再スタート条件の発行中		*/
+#define IIC_PHASE_ADDR_R	(4)						/* アドレス+R送信中				*/
+#define IIC_PHASE_RX		(5)						/* 受信中						*/
+#define IIC_PHASE_STOP		(6)						/* ストップ条件の発行中			*/
+#define IIC_PHASE_RECOVER	(7)						/* バス復旧中					*/
+
+/* ICCR1 */
+#define IIC_ICCR1_ICE		(0x80)					/* IIC動作許可					*/
+#define IIC_ICCR1_IICRST	(0x40)					/* 内部リセット					*/
+#define IIC_ICCR1_CLO		(0x20)					/* SCL追加出力					*/
+#define IIC_ICCR1_RELEASE	(0x1F)					/* SCL/SDAを駆動しない(SOWP=1)	*/
+#define IIC_ICCR1_SCLI		(0x02)					/* SCL端子レベル				*/
+#define IIC_ICCR1_SDAI		(0x01)					/* SDA端子レベル				*/
+/* ICCR2 */
+#define IIC_ICCR2_BBSY		(0x80)					/* バスビジー					*/
+#define IIC_ICCR2_ST		(0x02)					/* スタート条件発行要求			*/
+#define IIC_ICCR2_RS		(0x04)					/* 再スタート条件発行要求		*/
+#define IIC_ICCR2_SP		(0x08)					/* ストップ条件発行要求			*/
+/* ICMR1 */
+#define IIC_ICMR1_CKS_POS	(4)						/* 内部基準クロック選択			*/
+/* ICMR2 */
+#define IIC_ICMR2_TMOH		(0x04)					/* SCL High中のタイムアウト検出	*/
+#define IIC_ICMR2_TMOL		(0x02)					/* SCL Low中のタイムアウト検出	*/
+/* ICMR3 */
+#define IIC_ICMR3_WAIT		(0x40)					/* 9クロック目でSCL Low保持		*/
+#define IIC_ICMR3_ACKWP		(0x10)					/* ACKBT書き込みプロテクト解除	*/
+#define IIC_ICMR3_ACKBT		(0x08)					/* NACK送信						*/
+#define IIC_ICMR3_NF_1		(0x00)					/* ノイズフィルタ1段			*/
+/* ICFER */
+#define IIC_ICFER_SCLE		(0x40)					/* SCL同期回路有効				*/
+#define IIC_ICFER_NFE		(0x20)					/* ノイズフィルタ有効			*/
+#define IIC_ICFER_NACKE		(0x10)					/* NACK受信で転送中断			*/
+#define IIC_ICFER_MALE		(0x02)					/* マスターアービトレーションロスト検出	*/
+#define IIC_ICFER_TMOE		(0x01)					/* タイムアウト検出				*/
+/* ICIER/ICSR2 */
+#define IIC_TXI				(0x80)					/* TIE/TDRE						*/
+#define IIC_TEI				(0x40)					/* TEIE/TEND					*/
+#define IIC_RXI				(0x20)					/* RIE/RDRF						*/
+#define IIC_NACK			(0x10)					/* NAKIE/NACKF					*/
+#define IIC_STOP			(0x08)					/* SPIE/STOP					*/
+#define IIC_START			(0x04)					/* STIE/START					*/
+#define IIC_AL				(0x02)					/* ALIE/AL						*/
+#define IIC_TMO				(0x01)					/* TMOIE/TMOF					*/
+/* PmnPFS */
+#define IIC_PFS_PSEL		(0b00111)				/* IIC							*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static IicSlot sts_IicQueue[IIC_QUEUE_SIZE];				/* 転送要求Queue				*/
+volatile static uint8_t u8s_IicHead;						/* 次に完了通知する要素			*/
+volatile static uint8_t u8s_IicNext;						/* 次に開始する要素				*/
+volatile static uint8_t u8s_IicTail;						/* 次に登録する要素				*/
+volatile static uint8_t u8s_IicCount;						/* 登録数(完了通知前を含む)		*/
+volatile static uint8_t u8s_IicWaiting;						/* 未開始の要求数				*/
+volatile static uint8_t u8s_IicPhase = IIC_PHASE_IDLE;		/* 転送の段階					*/
+volatile static uint8_t u8s_IicActive;						/* 実行中の要素					*/
+static uint16_t u16s_IicIndex;								/* 送受信済みのデータ数			*/
+static bool bls_IicDtc;										/* DTC転送中					*/
+static uint16_t u16s_IicDtcCount;							/* DTCの転送数					*/
+static DtcTransferInfo sts_IicDtcTx;						/* 送信のDTC転送情報			*/
+static DtcTransferInfo sts_IicDtcRx;						/* 受信のDTC転送情報			*/
+static uint32_t u32s_IicStartUs;							/* 転送開始時刻[us]				*/
+volatile static uint32_t u32s_IicSequence;					/* 開始した転送の通し番号		*/
+static uint32_t u32s_IicWatchSequence;						/* 監視中の転送の通し番号		*/
+static uint8_t u8s_IicWatchCycles;							/* 監視中の転送の経過周期数		*/
+static uint8_t u8s_IicRecoverClocks;						/* バス復旧で出力したSCL数		*/
+static uint8_t u8s_IicRecoverCycles;						/* バス復旧の経過周期数			*/
+static uint64_t u64s_IicTimeSum;							/* 正常終了した転送時間の合計[us]	*/
+static IicStatistics sts_IicStatistics;						/* IIC統計情報					*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void iic_setup(void);								/* IIC1を設定する(内部リセット中に呼ぶ)	*/
+static void iic_set_bitrate(void);							/* 転送速度を設定する			*/
+static void iic_start_next(void);							/* 次の転送を開始する			*/
+static void iic_send_address(bool bl_Read);					/* スレーブアドレスを送信する	*/
+static void iic_read_data(void);							/* 受信データを読み出す			*/
+static uint8_t iic_nack_result(void);						/* NACKを受けたのがアドレスかを判定する	*/
+static void iic_issue_stop(uint8_t u8_Result);				/* ストップ条件を発行する		*/
+static void iic_finish(uint8_t u8_Result);					/* 転送を終了する				*/
+static void iic_abort(uint8_t u8_Result);					/* 転送を中止してバス復旧へ移る	*/
+static void iic_recover(void);								/* バス復旧を進める				*/
+static uint8_t iic_clock_callback(uint8_t u8_Event, uint8_t u8_Mode);	/* クロック変更コールバック	*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  IIC1受信データフル割り込みハンドラ
+  * @param  None
+  * @retval None
+  */
+void IIC1_RXI_Handler(void)
+{
+	/* 割り込み要求フラグ クリア */
+	R_ICU->IELSR_b[IRQ_IIC1_RXI].IR = 0;
+	sts_IicStatistics.u32_irqs++;
+
+	/* DTC転送の完了(最後の転送の後にCPU割り込みになる) */
+	if (bls_IicDtc) {
+		if (sts_IicDtcRx.u16_cra != 0) {
+			return;										// DTC起動前の要求
+		}
+		bls_IicDtc = false;
+		u16s_IicIndex += u16s_IicDtcCount;
+		sts_IicStatistics.u32_dtc_bytes += u16s_IicDtcCount;
+	}
+	if ((R_IIC1->ICSR2 & IIC_RXI) == 0) {
+		return;
+	}
+	if ((u8s_IicPhase == IIC_PHASE_ADDR_R) || (u8s_IicPhase == IIC_PHASE_RX)) {
+		iic_read_data();
+	}
+}
+
+/**
+  * @brief  IIC1送信データエンプティ割り込みハンドラ
+  * @param  None
+  * @retval None
+  */
+void IIC1_TXI_Handler(void)
+{
+	const IicTransfer *pst_Xfer = &sts_IicQueue[u8s_IicActive].st_xfer;
+
+	/* 割り込み要求フラグ クリア */
+	R_ICU->IELSR_b[IRQ_IIC1_TXI].IR = 0;
+	sts_IicStatistics.u32_irqs++;
+
+	if (u8s_IicPhase != IIC_PHASE_TX) {
+		return;
+	}
+	/* DTC転送の完了(最後のデータを書き込んだ後にCPU割り込みになる) */
+	if (bls_IicDtc) {
+		if (sts_IicDtcTx.u16_cra != 0) {
+			return;										// DTC起動前の要求
+		}
+		bls_IicDtc = false;
+		u16s_IicIndex += u16s_IicDtcCount;
+		sts_IicStatistics.u32_dtc_bytes += u16s_IicDtcCount;
+	}
+	if (u16s_IicIndex < pst_Xfer->u16_tx_size) {
+		R_IIC1->ICDRT = pst_Xfer->pu8_tx[u16s_IicIndex];
+		u16s_IicIndex++;
+	}
+	else {
+		/* 最後のデータの送信完了(TEND)を待つ */
+		R_IIC1->ICIER |= IIC_TEI;
+	}
+}
+
+/**
+  * @brief  IIC1送信終了割り込みハンドラ
+  * @param  None
+  * @retval None
+  */
+void IIC1_TEI_Handler(void)
+{
+	/* 割り込み要求フラグ クリア */
+	R_ICU->IELSR_b[IRQ_IIC1_TEI].IR = 0;
+	sts_IicStatistics.u32_irqs++;
+
+	R_IIC1->ICIER &= (uint8_t)~IIC_TEI;
+	if (u8s_IicPhase != IIC_PHASE_TX) {
+		return;
+	}
+	if (sts_IicQueue[u8s_IicActive].st_xfer.u16_rx_size > 0) {
+		/* 再スタート条件の検出(EEI)でアドレス+Rを送信する */
+		u8s_IicPhase = IIC_PHASE_RESTART;
+		R_IIC1->ICSR2 &= (uint8_t)~IIC_START;
+		R_IIC1->ICIER |= IIC_START;
+		R_IIC1->ICCR2 = IIC_ICCR2_RS;
+	}
+	else {
+		iic_issue_stop(IIC_RESULT_OK);
+	}
+}
+
+/**
+  * @brief  IIC1通信エラー/イベント発生割り込みハンドラ
+  * @param  None
+  * @retval None
+  * @note   START/STOP検出,NACK受信,アービトレーションロスト,タイムアウト
+  */
+void IIC1_EEI_Handler(void)
+{
+	const IicTransfer *pst_Xfer;
+	uint8_t u8_Status;
+
+	/* 割り込み要求フラグ クリア */
+	R_ICU->IELSR_b[IRQ_IIC1_EEI].IR = 0;
+	sts_IicStatistics.u32_irqs++;
+
+	u8_Status = R_IIC1->ICSR2 & R_IIC1->ICIER;
+	if (u8_Status & (IIC_AL | IIC_TMO)) {
+		/* バスを使用できない/SCLが固定されている */
+		iic_abort((u8_Status & IIC_TMO) ? IIC_RESULT_TIMEOUT : IIC_RESULT_BUS_ERROR);
+		return;
+	}
+	if (u8_Status & IIC_NACK) {
+		/* スレーブ無し/受け付け不可 */
+		R_IIC1->ICSR2 &= (uint8_t)~IIC_NACK;
+		iic_issue_stop(iic_nack_result());
+		return;
+	}
+	if (u8_Status & IIC_START) {
+		R_IIC1->ICSR2 &= (uint8_t)~IIC_START;
+		R_IIC1->ICIER &= (uint8_t)~IIC_START;
+		if (u8s_IicPhase == IIC_PHASE_START) {
+			pst_Xfer = &sts_IicQueue[u8s_IicActive].st_xfer;
+			iic_send_address((pst_Xfer->u16_tx_size == 0) && (pst_Xfer->u16_rx_size > 0));
+		}
+		else if (u8s_IicPhase == IIC_PHASE_RESTART) {
+			iic_send_address(true);
+		}
+	}
+	if (u8_Status & IIC_STOP) {
+		R_IIC1->ICSR2 &= (uint8_t)~IIC_STOP;
+		if (u8s_IicPhase == IIC_PHASE_STOP) {
+			iic_finish(sts_IicQueue[u8s_IicActive].u8_result);
+			iic_start_next();
+		}
+	}
+}
+
+/**
+  * @brief  IICドライバー初期化処理
+  * @param  None
+  * @retval None
+  */
+void taskIicDriverInit(void)
+{
+	uint32_t u32_Mask;
+
+	mem_set08((uint8_t *)&sts_IicQueue[0], 0x00, sizeof(sts_IicQueue));
+	mem_set08((uint8_t *)&sts_IicStatistics, 0x00, sizeof(sts_IicStatistics));
+	u8s_IicHead = 0;
+	u8s_IicNext = 0;
+	u8s_IicTail = 0;
+	u8s_IicCount = 0;
+	u8s_IicWaiting = 0;
+	u8s_IicPhase = IIC_PHASE_IDLE;
+	u64s_IicTimeSum = 0;
+
+	/* ---- ベクターテーブル登録 ---- */
+	u32_Mask = LL_IRQ_Lock(IIC_CEILING);
+	NVIC_SetVector((IRQn_Type)IRQ_IIC1_RXI, (uintptr_t)IIC1_RXI_Handler);
+	NVIC_SetVector((IRQn_Type)IRQ_IIC1_TXI, (uintptr_t)IIC1_TXI_Handler);
+	NVIC_SetVector((IRQn_Type)IRQ_IIC1_TEI, (uintptr_t)IIC1_TEI_Handler);
+	NVIC_SetVector((IRQn_Type)IRQ_IIC1_EEI, (uintptr_t)IIC1_EEI_Handler);
+	LL_IRQ_Unlock(u32_Mask);
+
+	/* ---- IIC1_RXI/TXI/TEI/EEI 無効 ---- */
+	R_ICU->IELSR[IRQ_IIC1_RXI] = 0x00000000;
+	R_ICU->IELSR[IRQ_IIC1_TXI] = 0x00000000;
+	R_ICU->IELSR[IRQ_IIC1_TEI] = 0x00000000;
+	R_ICU->IELSR[IRQ_IIC1_EEI] = 0x00000000;
+
+	/* ---- IIC1 モジュールストップ解除 ---- */
+	R_MSTP->MSTPCRB_b.MSTPB8 = 0;					// IIC1 ON
+
+	/* ---- ポート設定 ---- */
+	// 書き込みプロテクト解除
+	R_BSP_PinAccessEnable();
+	// P100 = SCL1, P101 = SDA1
+	R_PFS->PORT[1].PIN[0].PmnPFS_b.PCR = 1;			// 内蔵プルアップ
+	R_PFS->PORT[1].PIN[1].PmnPFS_b.PCR = 1;
+	R_PFS->PORT[1].PIN[0].PmnPFS_b.PSEL = IIC_PFS_PSEL;	// IIC1 SCL
+	R_PFS->PORT[1].PIN[1].PmnPFS_b.PSEL = IIC_PFS_PSEL;	// IIC1 SDA
+	R_PFS->PORT[1].PIN[0].PmnPFS_b.PMR = 1;
+	R_PFS->PORT[1].PIN[1].PmnPFS_b.PMR = 1;
+	// 書き込みプロテクト施錠
+	R_BSP_PinAccessDisable();
+
+	/* ---- IIC1 設定(内部リセット中に行う) ---- */
+	R_IIC1->ICCR1 = IIC_ICCR1_RELEASE;				// ICE=0(端子を非駆動)
+	R_IIC1->ICCR1 = IIC_ICCR1_IICRST | IIC_ICCR1_RELEASE;	// IIC全体リセット
+	R_IIC1->ICCR1 = IIC_ICCR1_ICE | IIC_ICCR1_IICRST | IIC_ICCR1_RELEASE;	// 内部リセット
+	iic_setup();
+	R_IIC1->ICCR1 = IIC_ICCR1_ICE | IIC_ICCR1_RELEASE;	// 内部リセット解除
+
+	/* ---- DTC ---- */
+	LL_DTC_Init();
+	LL_DTC_SetVector(IRQ_IIC1_TXI, &sts_IicDtcTx);
+	LL_DTC_SetVector(IRQ_IIC1_RXI, &sts_IicDtcRx);
+
+	/* ---- ICU → NVIC 割り込み割り当て ---- */
+	R_ICU->IELSR_b[IRQ_IIC1_RXI].IR = 0;			// 割り込み要求フラグ クリア
+	R_ICU->IELSR_b[IRQ_IIC1_RXI].IELS = ELC_EVENT_IIC1_RXI;
+	R_ICU->IELSR_b[IRQ_IIC1_TXI].IR = 0;
+	R_ICU->IELSR_b[IRQ_IIC1_TXI].IELS = ELC_EVENT_IIC1_TXI;
+	R_ICU->IELSR_b[IRQ_IIC1_TEI].IR = 0;
+	R_ICU->IELSR_b[IRQ_IIC1_TEI].IELS = ELC_EVENT_IIC1_TEI;
+	R_ICU->IELSR_b[IRQ_IIC1_EEI].IR = 0;
+	R_ICU->IELSR_b[IRQ_IIC1_EEI].IELS = ELC_EVENT_IIC1_EEI;
+
+	/* ---- NVIC 設定 ---- */
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_IIC1_RXI);
+	NVIC_SetPriority((IRQn_Type)IRQ_IIC1_RXI, IRQ_PRIO_IIC1);
+	NVIC_EnableIRQ((IRQn_Type)IRQ_IIC1_RXI);
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_IIC1_TXI);
+	NVIC_SetPriority((IRQn_Type)IRQ_IIC1_TXI, IRQ_PRIO_IIC1);
+	NVIC_EnableIRQ((IRQn_Type)IRQ_IIC1_TXI);
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_IIC1_TEI);
+	NVIC_SetPriority((IRQn_Type)IRQ_IIC1_TEI, IRQ_PRIO_IIC1);
+	NVIC_EnableIRQ((IRQn_Type)IRQ_IIC1_TEI);
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_IIC1_EEI);
+	NVIC_SetPriority((IRQn_Type)IRQ_IIC1_EEI, IRQ_PRIO_IIC1);
+	NVIC_EnableIRQ((IRQn_Type)IRQ_IIC1_EEI);
+
+	/* ---- クロック変更の通知先を登録する ---- */
+	if (clockRegisterCallback(iic_clock_callback) != OK) {
+		Error_Handler();
+	}
+}
+
+/**
+  * @brief  IICドライバー入力処理
+  * @param  None
+  * @retval None
+  * @note   完了した転送のコールバックを登録順に呼び出し、転送のタイムアウトと
+  *         バス復旧を処理する
+  */
+void taskIicDriverInput(void)
+{
+	IicSlot *pst_Slot;
+	IicSlot st_Done;
+	uint32_t u32_Mask;
+
+	/* ---- 転送全体のタイムアウト監視 ---- */
+	u32_Mask = LL_IRQ_Lock(IIC_CEILING);
+	if ((u8s_IicPhase != IIC_PHASE_IDLE) && (u8s_IicPhase != IIC_PHASE_RECOVER)) {
+		if (u32s_IicWatchSequence != u32s_IicSequence) {
+			u32s_IicWatchSequence = u32s_IicSequence;
+			u8s_IicWatchCycles = 0;
+		}
+		else if (++u8s_IicWatchCycles >= IIC_XFER_TIMEOUT) {
+			iic_abort(IIC_RESULT_TIMEOUT);
+		}
+	}
+	LL_IRQ_Unlock(u32_Mask);
+
+	/* ---- バス復旧 ---- */
+	if (u8s_IicPhase == IIC_PHASE_RECOVER) {
+		iic_recover();
+	}
+
+	/* ---- 完了通知 ---- */
+	while ((u8s_IicCount > 0) && sts_IicQueue[u8s_IicHead].bl_done) {
+		pst_Slot = &sts_IicQueue[u8s_IicHead];
+		st_Done = *pst_Slot;
+		u32_Mask = LL_IRQ_Lock(IIC_CEILING);
+		pst_Slot->bl_done = false;
+		u8s_IicHead = (uint8_t)((u8s_IicHead + 1) % IIC_QUEUE_SIZE);
+		u8s_IicCount--;
+		LL_IRQ_Unlock(u32_Mask);
+		if (st_Done.st_xfer.pf_callback != NULL) {
+			st_Done.st_xfer.pf_callback(&st_Done.st_xfer, st_Done.u8_result, st_Done.u32_time_us);
+		}
+	}
+}
+
+/**
+  * @brief  IIC転送を登録する
+  * @param  pst_Xfer: 転送要求(内容はコピーする,データ領域は完了まで保持すること)
+  * @retval OK/NG(Queueが一杯,サイズ不正)
+  * @note   送信サイズ0,受信サイズ0の要求はアドレスの応答確認になる
+  */
+uint8_t iicSubmit(const IicTransfer *pst_Xfer)
+{
+	uint32_t u32_Mask;
+
+	if (((pst_Xfer->u16_tx_size > 0) && (pst_Xfer->pu8_tx == NULL))
+	 || ((pst_Xfer->u16_rx_size > 0) && (pst_Xfer->pu8_rx == NULL))
+	 || (pst_Xfer->u8_addr > 0x7F)) {
+		return NG;
+	}
+	u32_Mask = LL_IRQ_Lock(IIC_CEILING);
+	if (u8s_IicCount >= IIC_QUEUE_SIZE) {
+		LL_IRQ_Unlock(u32_Mask);
+		return NG;
+	}
+	sts_IicQueue[u8s_IicTail].st_xfer = *pst_Xfer;
+	sts_IicQueue[u8s_IicTail].u8_result = IIC_RESULT_OK;
+	sts_IicQueue[u8s_IicTail].u32_time_us = 0;
+	sts_IicQueue[u8s_IicTail].bl_done = false;
+	u8s_IicTail = (uint8_t)((u8s_IicTail + 1) % IIC_QUEUE_SIZE);
+	u8s_IicCount++;
+	u8s_IicWaiting++;
+	if (u8s_IicCount > sts_IicStatistics.u8_queue_peak) {
+		sts_IicStatistics.u8_queue_peak = u8s_IicCount;
+	}
+	iic_start_next();
+	LL_IRQ_Unlock(u32_Mask);
+	return OK;
+}
+
+/**
+  * @brief  転送中または未完了の要求があるかを取得する
+  * @param  None
+  * @retval true:あり
+  */
+bool iicIsBusy(void)
+{
+	return (u8s_IicCount > 0) || (u8s_IicPhase != IIC_PHASE_IDLE);
+}
+
+/**
+  * @brief  IIC統計情報を取得する
+  * @param  pst_Stat: 統計情報の格納先
+  * @retval None
+  */
+void iicGetStatistics(IicStatistics *pst_Stat)
+{
+	uint32_t u32_Mask;
+
+	u32_Mask = LL_IRQ_Lock(IIC_CEILING);
+	*pst_Stat = sts_IicStatistics;
+	LL_IRQ_Unlock(u32_Mask);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  IIC1を設定する
+  * @param  None
+  * @retval None
+  * @note   内部リセット中(ICCR1.IICRST=1)に呼び出す
+  */
+static void iic_setup(void)
+{
+	R_IIC1->ICSER = 0x00;							// スレーブアドレス無効
+	R_IIC1->ICMR2 = IIC_ICMR2_TMOH | IIC_ICMR2_TMOL;	// ロングモード,High/Low両方で検出
+	R_IIC1->ICMR3 = IIC_ICMR3_NF_1;
+	R_IIC1->ICFER = IIC_ICFER_SCLE | IIC_ICFER_NFE | IIC_ICFER_NACKE | IIC_ICFER_MALE | IIC_ICFER_TMOE;
+	R_IIC1->ICIER = 0x00;
+	iic_set_bitrate();
+}
+
+/**
+  * @brief  転送速度を設定する
+  * @param  None
+  * @retval None
+  * @note   IICφ = PCLKB / 2^CKS
+  *         転送速度 = 1 / {(ICBRH+1 + ICBRL+1) / IICφ + tr + tf}
+  *         ICBRH/ICBRLが5bitに収まる最小のCKSを選び、デューティは50%とする
+  */
+static void iic_set_bitrate(void)
+{
+	uint32_t u32_Pclkb = R_FSP_SystemClockHzGet(FSP_PRIV_CLOCK_PCLKB);
+	uint32_t u32_Phi = u32_Pclkb;
+	uint32_t u32_Counts = 0;
+	uint8_t u8_Cks;
+
+	for (u8_Cks=0; u8_Cks<=IIC_CKS_MAX; u8_Cks++) {
+		u32_Phi = u32_Pclkb >> u8_Cks;
+		u32_Counts = ((u32_Phi + (IIC_BITRATE / 2)) / IIC_BITRATE)
+			- (uint32_t)(((uint64_t)u32_Phi * IIC_RISE_FALL_NS) / 1000000000ULL);
+		if (u32_Counts <= (2 * IIC_BR_MAX)) {
+			break;
+		}
+	}
+	if (u8_Cks > IIC_CKS_MAX) {
+		u8_Cks = IIC_CKS_MAX;
+		u32_Counts = 2 * IIC_BR_MAX;
+	}
+	if (u32_Counts < 4) {
+		u32_Counts = 4;
+	}
+	R_IIC1->ICMR1 = (uint8_t)(u8_Cks << IIC_ICMR1_CKS_POS);
+	R_IIC1->ICBRH = (uint8_t)(0xE0 | ((u32_Counts / 2) - 1));
+	R_IIC1->ICBRL = (uint8_t)(0xE0 | ((u32_Counts - (u32_Counts / 2)) - 1));
+	sts_IicStatistics.u32_bitrate = (uint32_t)(1000000000ULL / (((uint64_t)u32_Counts * 1000000000ULL / u32_Phi) + IIC_RISE_FALL_NS));
+}
+
+/**
+  * @brief  次の転送を開始する
+  * @param  None
+  * @retval None
+  * @note   IIC_CEILINGの禁止区間または割り込みから呼び出す
+  */
+static void iic_start_next(void)
+{
+	if ((u8s_IicPhase != IIC_PHASE_IDLE) || (u8s_IicWaiting == 0)) {
+		return;
+	}
+	u8s_IicActive = u8s_IicNext;
+	u8s_IicNext = (uint8_t)((u8s_IicNext + 1) % IIC_QUEUE_SIZE);
+	u8s_IicWaiting--;
+	u16s_IicIndex = 0;
+	bls_IicDtc = false;
+	u32s_IicSequence++;
+	u32s_IicStartUs = extiGetTimeUs();
+
+	if (R_IIC1->ICCR2 & IIC_ICCR2_BBSY) {
+		/* 他のマスター/スレーブがバスを使用中 */
+		u8s_IicPhase = IIC_PHASE_START;
+		iic_abort(IIC_RESULT_BUS_ERROR);
+		return;
+	}
+	u8s_IicPhase = IIC_PHASE_START;
+	R_IIC1->ICSR2 &= (uint8_t)~(IIC_NACK | IIC_STOP | IIC_START | IIC_AL | IIC_TMO);
+	R_IIC1->ICMR3 = IIC_ICMR3_NF_1 | IIC_ICMR3_ACKWP;	// ACKBT=0, WAIT=0
+	R_IIC1->ICIER = IIC_TXI | IIC_RXI | IIC_NACK | IIC_STOP | IIC_START | IIC_AL | IIC_TMO;
+	R_IIC1->ICCR2 = IIC_ICCR2_ST;
+}
+
+/**
+  * @brief  スレーブアドレスを送信する
+  * @param  bl_Read: true:読み出し(R) false:書き込み(W)
+  * @retval None
+  */
+static void iic_send_address(bool bl_Read)
+{
+	const IicTransfer *pst_Xfer = &sts_IicQueue[u8s_IicActive].st_xfer;
+
+	if (bl_Read) {
+		u8s_IicPhase = IIC_PHASE_ADDR_R;
+		u16s_IicIndex = 0;
+		R_IIC1->ICDRT = (uint8_t)((pst_Xfer->u8_addr << 1) | 0x01);
+		return;
+	}
+	u8s_IicPhase = IIC_PHASE_TX;
+	if (pst_Xfer->u16_tx_size >= IIC_DTC_MIN) {
+		/* 送信データはTXI(アドレスの送信開始後)からDTCで書き込む */
+		sts_IicDtcTx.u32_mode = DTC_MD_NORMAL | DTC_SZ_BYTE | DTC_SM_INC | DTC_DM_FIXED;
+		sts_IicDtcTx.pv_src = pst_Xfer->pu8_tx;
+		sts_IicDtcTx.pv_dst = &R_IIC1->ICDRT;
+		sts_IicDtcTx.u16_crb = 0;
+		sts_IicDtcTx.u16_cra = pst_Xfer->u16_tx_size;
+		u16s_IicDtcCount = pst_Xfer->u16_tx_size;
+		bls_IicDtc = true;
+		LL_DTC_EnableIT(IRQ_IIC1_TXI);
+	}
+	R_IIC1->ICDRT = (uint8_t)(pst_Xfer->u8_addr << 1);
+}
+
+/**
+  * @brief  受信データを読み出す
+  * @param  None
+  * @retval None
+  * @note   最後の3byteは次のように扱う
+  *         - 残り2byte: WAIT=1(最後の1つ前の9クロック目でSCLをLowに保持)
+  *         - 残り1byte: ACKBT=1(最後のデータにNACKを返す)
+  *         - 最後: ストップ条件を要求してから読み出し、WAITを解除する
+  */
+static void iic_read_data(void)
+{
+	IicSlot *pst_Slot = &sts_IicQueue[u8s_IicActive];
+	uint16_t u16_Size = pst_Slot->st_xfer.u16_rx_size;
+	uint16_t u16_Remain;
+	uint8_t u8_Data;
+
+	if (u8s_IicPhase == IIC_PHASE_ADDR_R) {
+		/* アドレス送信完了: ダミーリードで受信を開始する */
+		u8s_IicPhase = IIC_PHASE_RX;
+		if (u16_Size <= 2) {
+			R_IIC1->ICMR3 |= IIC_ICMR3_WAIT;
+		}
+		if (u16_Size == 1) {
+			R_IIC1->ICMR3 |= (IIC_ICMR3_ACKWP | IIC_ICMR3_ACKBT);
+		}
+		if (u16_Size >= (IIC_DTC_MIN + IIC_RX_CPU_BYTES)) {
+			sts_IicDtcRx.u32_mode = DTC_MD_NORMAL | DTC_SZ_BYTE | DTC_SM_FIXED | DTC_DM_INC;
+			sts_IicDtcRx.pv_src = &R_IIC1->ICDRR;
+			sts_IicDtcRx.pv_dst = pst_Slot->st_xfer.pu8_rx;
+			sts_IicDtcRx.u16_crb = 0;
+			sts_IicDtcRx.u16_cra = (uint16_t)(u16_Size - IIC_RX_CPU_BYTES);
+			u16s_IicDtcCount = (uint16_t)(u16_Size - IIC_RX_CPU_BYTES);
+			bls_IicDtc = true;
+			LL_DTC_EnableIT(IRQ_IIC1_RXI);
+		}
+		(void)R_IIC1->ICDRR;
+		return;
+	}
+
+	u16_Remain = (uint16_t)(u16_Size - u16s_IicIndex - 1);		// 読み出し後の残り
+	if (u16_Remain == 0) {
+		R_IIC1->ICSR2 &= (uint8_t)~IIC_STOP;
+		u8s_IicPhase = IIC_PHASE_STOP;
+		R_IIC1->ICCR2 = IIC_ICCR2_SP;
+		u8_Data = R_IIC1->ICDRR;
+		R_IIC1->ICMR3 &= (uint8_t)~IIC_ICMR3_WAIT;
+	}
+	else {
+		if (u16_Remain == 2) {
+			R_IIC1->ICMR3 |= IIC_ICMR3_WAIT;
+		}
+		else if (u16_Remain == 1) {
+			R_IIC1->ICMR3 |= (IIC_ICMR3_ACKWP | IIC_ICMR3_ACKBT);
+		}
+		u8_Data = R_IIC1->ICDRR;
+	}
+	pst_Slot->st_xfer.pu8_rx[u16s_IicIndex] = u8_Data;
+	u16s_IicIndex++;
+}
+
+/**
+  * @brief  NACKを受けたのがアドレスかデータかを判定する
+  * @param  None
+  * @retval IIC_RESULT_NACK_ADDR/IIC_RESULT_NACK_DATA
+  * @note   ICDRTに書き込んだデータ数から、ICDRTに残っている(TDRE=0)1byteを
+  *         除いた数がバス上に出たデータ数になる。0ならアドレスへのNACK
+  */
+static uint8_t iic_nack_result(void)
+{
+	uint16_t u16_Loaded = u16s_IicIndex;
+
+	if (u8s_IicPhase != IIC_PHASE_TX) {
+		return IIC_RESULT_NACK_ADDR;
+	}
+	if (bls_IicDtc) {
+		u16_Loaded += (uint16_t)(u16s_IicDtcCount - sts_IicDtcTx.u16_cra);
+	}
+	if ((u16_Loaded > 0) && ((R_IIC1->ICSR2 & IIC_TXI) == 0)) {
+		u16_Loaded--;
+	}
+	return (u16_Loaded == 0) ? IIC_RESULT_NACK_ADDR : IIC_RESULT_NACK_DATA;
+}
+
+/**
+  * @brief  ストップ条件を発行する
+  * @param  u8_Result: ストップ条件の検出後に通知する結果
+  * @retval None
+  */
+static void iic_issue_stop(uint8_t u8_Result)
+{
+	LL_DTC_DisableIT(IRQ_IIC1_TXI);
+	LL_DTC_DisableIT(IRQ_IIC1_RXI);
+	bls_IicDtc = false;
+	sts_IicQueue[u8s_IicActive].u8_result = u8_Result;
+	u8s_IicPhase = IIC_PHASE_STOP;
+	R_IIC1->ICIER &= (uint8_t)~(IIC_TXI | IIC_TEI | IIC_RXI);
+	R_IIC1->ICSR2 &= (uint8_t)~IIC_STOP;
+	R_IIC1->ICCR2 = IIC_ICCR2_SP;
+	R_IIC1->ICMR3 &= (uint8_t)~IIC_ICMR3_WAIT;
+}
+
+/**
+  * @brief  転送を終了する
+  * @param  u8_Result: 結果(IIC_RESULT_xxx)
+  * @retval None
+  */
+static void iic_finish(uint8_t u8_Result)
+{
+	IicSlot *pst_Slot = &sts_IicQueue[u8s_IicActive];
+	uint32_t u32_Time = extiGetTimeUs() - u32s_IicStartUs;
+
+	R_IIC1->ICIER = 0x00;
+	pst_Slot->u8_result = u8_Result;
+	pst_Slot->u32_time_us = u32_Time;
+	pst_Slot->bl_done = true;
+	u8s_IicPhase = IIC_PHASE_IDLE;
+
+	sts_IicStatistics.u32_last_us = u32_Time;
+	if (u32_Time > sts_IicStatistics.u32_max_us) {
+		sts_IicStatistics.u32_max_us = u32_Time;
+	}
+	switch (u8_Result) {
+	case IIC_RESULT_OK:
+		sts_IicStatistics.u32_transfers++;
+		u64s_IicTimeSum += u32_Time;
+		sts_IicStatistics.u32_avg_us = (uint32_t)(u64s_IicTimeSum / sts_IicStatistics.u32_transfers);
+		break;
+	case IIC_RESULT_NACK_ADDR:
+	case IIC_RESULT_NACK_DATA:
+		sts_IicStatistics.u32_nacks++;
+		break;
+	case IIC_RESULT_TIMEOUT:
+		sts_IicStatistics.u32_timeouts++;
+		break;
+	default:
+		sts_IicStatistics.u32_bus_errors++;
+		break;
+	}
+}
+
+/**
+  * @brief  転送を中止してバス復旧へ移る
+  * @param  u8_Result: 結果(IIC_RESULT_xxx)
+  * @retval None
+  * @note   IIC_CEILINGの禁止区間または割り込みから呼び出す。内部リセットで
+  *         送受信を止め、以降は周期処理(iic_recover)で復旧を進める
+  */
+static void iic_abort(uint8_t u8_Result)
+{
+	LL_DTC_DisableIT(IRQ_IIC1_TXI);
+	LL_DTC_DisableIT(IRQ_IIC1_RXI);
+	bls_IicDtc = false;
+	R_IIC1->ICIER = 0x00;
+	R_IIC1->ICCR1 = IIC_ICCR1_ICE | IIC_ICCR1_IICRST | IIC_ICCR1_RELEASE;
+	iic_finish(u8_Result);
+	u8s_IicPhase = IIC_PHASE_RECOVER;
+	u8s_IicRecoverClocks = 0;
+	u8s_IicRecoverCycles = 0;
+}
+
+/**
+  * @brief  バス復旧を進める
+  * @param  None
+  * @retval None
+  * @note   周期処理から呼び出す。SCL/SDAが共にHighになれば内部リセットを
+  *         解除して次の転送を開始する。SDAがLowの間はSCLを1周期に1クロック
+  *         追加出力し、スレーブが送信途中のデータを出し切るのを待つ
+  */
+static void iic_recover(void)
+{
+	uint8_t u8_Lines = R_IIC1->ICCR1 & (IIC_ICCR1_SCLI | IIC_ICCR1_SDAI);
+	uint32_t u32_Mask;
+
+	if (R_IIC1->ICCR1 & IIC_ICCR1_CLO) {
+		return;											// 追加クロック出力中
+	}
+	if ((u8_Lines == (IIC_ICCR1_SCLI | IIC_ICCR1_SDAI)) || (++u8s_IicRecoverCycles >= IIC_RECOVERY_CYCLES)) {
+		/* 復旧(または断念): 設定し直して次の転送へ */
+		if (u8s_IicRecoverClocks > 0) {
+			sts_IicStatistics.u32_recoveries++;
+		}
+		R_IIC1->ICCR1 = IIC_ICCR1_ICE | IIC_ICCR1_IICRST | IIC_ICCR1_RELEASE;
+		iic_setup();
+		R_IIC1->ICCR1 = IIC_ICCR1_ICE | IIC_ICCR1_RELEASE;
+		u32_Mask = LL_IRQ_Lock(IIC_CEILING);
+		u8s_IicPhase = IIC_PHASE_IDLE;
+		iic_start_next();
+		LL_IRQ_Unlock(u32_Mask);
+		return;
+	}
+	if ((u8_Lines == IIC_ICCR1_SCLI) && (u8s_IicRecoverClocks < IIC_RECOVERY_CLOCKS)) {
+		/* SDAがLow: SCLを1クロック出力する(内部リセット解除中に行う) */
+		R_IIC1->ICCR1 = IIC_ICCR1_ICE | IIC_ICCR1_RELEASE;
+		R_IIC1->ICCR1 = IIC_ICCR1_ICE | IIC_ICCR1_CLO | IIC_ICCR1_RELEASE;
+		u8s_IicRecoverClocks++;
+	}
+}
+
+/**
+  * @brief  クロック変更コールバック
+  * @param  u8_Event: CLOCK_EVENT_xxx
+  * @param  u8_Mode: 切り替え先の動作モード
+  * @retval OK/NG(転送中または未開始の要求がある)
+  */
+static uint8_t iic_clock_callback(uint8_t u8_Event, uint8_t u8_Mode)
+{
+	(void)u8_Mode;
+	if (u8_Event == CLOCK_EVENT_PRE) {
+		return ((u8s_IicPhase == IIC_PHASE_IDLE) && (u8s_IicWaiting == 0)) ? OK : NG;
+	}
+	if (u8_Event == CLOCK_EVENT_POST) {
+		R_IIC1->ICCR1 = IIC_ICCR1_ICE | IIC_ICCR1_IICRST | IIC_ICCR1_RELEASE;
+		iic_set_bitrate();
+		R_IIC1->ICCR1 = IIC_ICCR1_ICE | IIC_ICCR1_RELEASE;
+	}
+	return OK;
+}
@@ -0,0 +1,727 @@
+/**
+  ******************************************************************************
+  * @file           : drv_kvs.c
+  * @brief          : キー・バリューストア ドライバー(データフラッシュ)
+  ******************************************************************************
+  * @note   データフラッシュ(1KB×8ブロック)にログ形式で記録する。
+  *         - 全キーの値をRAMに持ち、読み出しはRAMから行う。更新はRAM上で
+  *           まとめ(KVS_WRITE_DELAY),周期処理の中で時間を区切って書き込む。
+  *         - ブロック = ヘッダー(通し番号,CRC) + レコードの追記。
+  *           レコード = キー,長さ,値,CRC16(4byte境界に配置)。削除は長さ0の
+  *           レコード(bit7:削除)で記録する。
+  *         - 空きブロックが KVS_RESERVE_BLOCKS 以下になったら最古のブロックの
+  *           有効なレコードを追記し直し、ヘッダーを無効化(退役)してから解放する。
+  *           ブロックは順番に使うため書き換え回数が平準化される。
+  *         - 電源断: 書きかけのレコードはCRCで検出して読み飛ばし、4byte境界で
+  *           次のレコードを探す。最古のブロックは退役するまで有効なので、
+  *           追記し直しの途中で電源が切れても値は失われない。
+  *         消去したデータフラッシュは FFh を読み出すことが前提。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "drv.h"
+#include "lib.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* キーの情報 */
+typedef struct _KvsEntry {
+	uint8_t u8_len;					/* 値の長さ(0:値無し)					*/
+	uint8_t u8_dirty;				/* 未書き込み							*/
+	uint8_t u8_block;				/* 最新のレコードがあるブロック			*/
+	uint8_t u8_value[KVS_VALUE_MAX];	/* 値								*/
+} KvsEntry;
+
+/* 書き込み/消去処理 */
+typedef struct _KvsJob {
+	uint8_t u8_type;				/* 処理の種類(KVS_JOB_xxx)				*/
+	uint8_t u8_block;				/* 対象ブロック							*/
+	uint8_t u8_key;					/* 書き込み中のキー(レコードのみ)		*/
+	bool bl_wait;					/* 1byteの書き込み完了待ち				*/
+	bool bl_error;					/* エラー発生							*/
+	uint16_t u16_size;				/* 書き込みサイズ						*/
+	uint16_t u16_pos;				/* 書き込み位置							*/
+	uint32_t u32_offset;			/* 書き込み先オフセット					*/
+	uint8_t u8_data[KVS_VALUE_MAX + 4];	/* 書き込みデータ					*/
+} KvsJob;
+
+/* Private define ------------------------------------------------------------*/
+#ifndef KVS_WRITE_DELAY
+#define KVS_WRITE_DELAY		(10000)					/* 更新をまとめる時間[ms]	*/
+#endif
+#define KVS_STEP_BUDGET_US	(1000)					/* 1周期の処理時間[us]		*/
+#define KVS_RESERVE_BLOCKS	(2)						/* 追記し直し用の予備ブロック	*/
+#define KVS_BLOCK_NUM		(LL_FLASH_DATA_SIZE / LL_FLASH_BLOCK_SIZE)
+#define KVS_BLOCK_NONE		(0xFF)
+#define KVS_HEADER_SIZE		(8)						/* ブロックヘッダーサイズ	*/
+#define KVS_HEADER_MAGIC0	(0x4B)					/* 'K'(退役時に00hを書き込む)	*/
+#define KVS_HEADER_MAGIC1	(0x56)					/* 'V'						*/
+#define KVS_RECORD_DELETE	(0x80)					/* 削除レコード(キーのbit7)	*/
+#define KVS_RECORD_ALIGN	(4)						/* レコードの配置境界		*/
+
+/* ブロックの状態 */
+#define KVS_BLOCK_FREE		(0)						/* 空き(消去が必要)			*/
+#define KVS_BLOCK_ERASED	(1)						/* 空き(消去済み)			*/
+#define KVS_BLOCK_USED		(2)						/* 使用中					*/
+#define KVS_BLOCK_BAD		(3)						/* 書き込み/消去エラー		*/
+
+/* 書き込み/消去処理の種類 */
+#define KVS_JOB_NONE		(0)
+#define KVS_JOB_ERASE		(1)						/* ブロック消去				*/
+#define KVS_JOB_HEADER		(2)						/* ブロックヘッダー書き込み	*/
+#define KVS_JOB_RECORD		(3)						/* レコード書き込み			*/
+#define KVS_JOB_RETIRE		(4)						/* ブロック退役				*/
+
+/* 1ステップの結果 */
+#define KVS_STEP_IDLE		(0)						/* 処理無し					*/
+#define KVS_STEP_RUN		(1)						/* 続けて処理できる			*/
+#define KVS_STEP_WAIT		(2)						/* 消去完了待ち				*/
+
+_Static_assert(KVS_KEY_MAX <= KVS_RECORD_DELETE, "KVS_KEY_MAX out of range");
+_Static_assert(KVS_VALUE_MAX < 0xFF, "KVS_VALUE_MAX out of range");
+
+/* Private macro -------------------------------------------------------------*/
+#define KVS_RECORD_SIZE(len)	(((len) + 4 + (KVS_RECORD_ALIGN - 1)) & ~(KVS_RECORD_ALIGN - 1))
+
+/* Private variables ---------------------------------------------------------*/
+static KvsEntry sts_KvsEntry[KVS_KEY_MAX];			/* キーの情報					*/
+static KvsJob sts_KvsJob;							/* 書き込み/消去処理			*/
+static KvsStatistics sts_KvsStat;					/* 統計情報						*/
+static Timer sts_KvsTimer;							/* 更新をまとめるタイマー		*/
+static uint8_t u8s_KvsBlockState[KVS_BLOCK_NUM];	/* ブロックの状態				*/
+static uint32_t u32s_KvsBlockSeq[KVS_BLOCK_NUM];	/* ブロックの通し番号			*/
+static uint32_t u32s_KvsNextSeq;					/* 次のブロックの通し番号		*/
+static uint8_t u8s_KvsHead;							/* 追記中のブロック				*/
+static uint16_t u16s_KvsHeadPos;					/* 追記位置						*/
+static uint8_t u8s_KvsCompact;						/* 追記し直し中のブロック		*/
+static bool bls_KvsFlush;							/* 即時書き込み要求				*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void kvs_mount(void);								/* データフラッシュから値を復元する	*/
+static void kvs_mount_block(uint8_t u8_Block);				/* 1ブロックのレコードを復元する	*/
+static uint8_t kvs_step(void);								/* 書き込み/消去を1ステップ進める	*/
+static uint8_t kvs_schedule(void);							/* 次の書き込み/消去を開始する		*/
+static void kvs_start_record(uint8_t u8_Key);				/* レコード書き込みを開始する		*/
+static void kvs_start_program(uint8_t u8_Type, uint32_t u32_Offset, uint16_t u16_Size);	/* 書き込みを開始する	*/
+static void kvs_job_done(void);								/* 書き込み/消去の完了処理			*/
+static uint8_t kvs_find_block(uint8_t u8_State, bool bl_Oldest);	/* ブロックを探す			*/
+static uint8_t kvs_count_free(void);						/* 空きブロック数を取得する			*/
+static void kvs_set_dirty(KvsEntry *pst_Entry);				/* 未書き込みにする					*/
+static uint16_t kvs_crc16(const uint8_t *pu8_Data, uint16_t u16_Size, uint16_t u16_Crc);	/* CRC-16/CCITT	*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  キー・バリューストア ドライバー初期化処理
+  * @param  None
+  * @retval None
+  * @note   データフラッシュを走査して全キーの値をRAMに復元する
+  */
+void taskKvsDriverInit(void)
+{
+	uint8_t _i;
+
+	mem_set08((uint8_t *)&sts_KvsJob, 0, sizeof(KvsJob));
+	mem_set08((uint8_t *)&sts_KvsStat, 0, sizeof(KvsStatistics));
+	mem_set08((uint8_t *)&sts_KvsEntry[0], 0, sizeof(sts_KvsEntry));
+	for (_i=0; _i<KVS_KEY_MAX; _i++) {
+		sts_KvsEntry[_i].u8_block = KVS_BLOCK_NONE;
+	}
+	u8s_KvsHead = KVS_BLOCK_NONE;
+	u16s_KvsHeadPos = 0;
+	u8s_KvsCompact = KVS_BLOCK_NONE;
+	bls_KvsFlush = false;
+	stopTimer(&sts_KvsTimer);
+
+	LL_FLASH_Init();
+	kvs_mount();
+}
+
+/**
+  * @brief  キー・バリューストア ドライバー出力処理
+  * @param  None
+  * @retval None
+  * @note   書き込み/消去を KVS_STEP_BUDGET_US の間だけ進める。
+  *         消去の完了待ちは次の周期に持ち越す。
+  */
+void taskKvsDriverOutput(void)
+{
+	uint32_t u32_Start = LL_DWT_GetCycle();
+	uint32_t u32_Budget = (SystemCoreClock / 1000000) * KVS_STEP_BUDGET_US;
+	uint32_t u32_Elapsed;
+
+	while (kvs_step() == KVS_STEP_RUN) {
+		if ((LL_DWT_GetCycle() - u32_Start) >= u32_Budget) {
+			break;
+		}
+	}
+	u32_Elapsed = (LL_DWT_GetCycle() - u32_Start) / (SystemCoreClock / 1000000);
+	if (u32_Elapsed > sts_KvsStat.u32_max_step_us) {
+		sts_KvsStat.u32_max_step_us = u32_Elapsed;
+	}
+}
+
+/**
+  * @brief  値を設定する
+  * @param  u8_Key: キー(0～KVS_KEY_MAX-1)
+  * @param  pu8_Data: 値
+  * @param  u8_Len: 値の長さ(1～KVS_VALUE_MAX)
+  * @retval OK/NG
+  * @note   データフラッシュへはKVS_WRITE_DELAY後(kvsFlush()で即時)に書き込む
+  */
+uint8_t kvsSet(uint8_t u8_Key, const uint8_t *pu8_Data, uint8_t u8_Len)
+{
+	KvsEntry *pst_Entry;
+
+	if ((u8_Key >= KVS_KEY_MAX) || (u8_Len == 0) || (u8_Len > KVS_VALUE_MAX)) {
+		return NG;
+	}
+	pst_Entry = &sts_KvsEntry[u8_Key];
+	/* 値が変わらなければ書き込まない */
+	if ((pst_Entry->u8_len == u8_Len) && (mem_cmp08(&pst_Entry->u8_value[0], pu8_Data, u8_Len) == 0)) {
+		return OK;
+	}
+	mem_cpy08(&pst_Entry->u8_value[0], pu8_Data, u8_Len);
+	pst_Entry->u8_len = u8_Len;
+	kvs_set_dirty(pst_Entry);
+	return OK;
+}
+
+/**
+  * @brief  値を取得する
+  * @param  u8_Key: キー
+  * @param  pu8_Data: 値の格納先
+  * @param  u8_Size: 格納先のサイズ
+  * @retval 値の長さ(0:値無し)。格納するのは u8_Size までとする。
+  */
+uint8_t kvsGet(uint8_t u8_Key, uint8_t *pu8_Data, uint8_t u8_Size)
+{
+	const KvsEntry *pst_Entry;
+
+	if (u8_Key >= KVS_KEY_MAX) {
+		return 0;
+	}
+	pst_Entry = &sts_KvsEntry[u8_Key];
+	mem_cpy08(pu8_Data, &pst_Entry->u8_value[0], (pst_Entry->u8_len < u8_Size) ? pst_Entry->u8_len : u8_Size);
+	return pst_Entry->u8_len;
+}
+
+/**
+  * @brief  値を削除する
+  * @param  u8_Key: キー
+  * @retval OK/NG(値無し)
+  */
+uint8_t kvsDelete(uint8_t u8_Key)
+{
+	KvsEntry *pst_Entry;
+
+	if ((u8_Key >= KVS_KEY_MAX) || (sts_KvsEntry[u8_Key].u8_len == 0)) {
+		return NG;
+	}
+	pst_Entry = &sts_KvsEntry[u8_Key];
+	pst_Entry->u8_len = 0;
+	if (pst_Entry->u8_block == KVS_BLOCK_NONE) {
+		/* データフラッシュに記録が無ければ削除の記録も不要 */
+		pst_Entry->u8_dirty = 0;
+	}
+	else {
+		kvs_set_dirty(pst_Entry);
+	}
+	return OK;
+}
+
+/**
+  * @brief  未書き込みの値をすぐに書き込む
+  * @param  None
+  * @retval None
+  * @note   書き込みは周期処理の中で進むため、完了はkvsIsBusy()で確認する
+  */
+void kvsFlush(void)
+{
+	bls_KvsFlush = true;
+}
+
+/**
+  * @brief  書き込み/消去の実行状態を取得する
+  * @param  None
+  * @retval true:未書き込みの値または実行中の処理がある
+  */
+bool kvsIsBusy(void)
+{
+	uint8_t _i;
+
+	if ((sts_KvsJob.u8_type != KVS_JOB_NONE) || (u8s_KvsCompact != KVS_BLOCK_NONE)) {
+		return true;
+	}
+	for (_i=0; _i<KVS_KEY_MAX; _i++) {
+		if (sts_KvsEntry[_i].u8_dirty) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+  * @brief  統計情報を取得する
+  * @param  pst_Stat: 統計情報の格納先
+  * @retval None
+  */
+void kvsGetStatistics(KvsStatistics *pst_Stat)
+{
+	uint8_t _i;
+
+	sts_KvsStat.u8_used_blocks = 0;
+	for (_i=0; _i<KVS_BLOCK_NUM; _i++) {
+		if (u8s_KvsBlockState[_i] == KVS_BLOCK_USED) {
+			sts_KvsStat.u8_used_blocks++;
+		}
+	}
+	sts_KvsStat.u8_free_blocks = kvs_count_free();
+	*pst_Stat = sts_KvsStat;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  データフラッシュから値を復元する
+  * @param  None
+  * @retval None
+  * @note   有効なヘッダーのブロックを通し番号の順に再生する。
+  *         最新のブロックは書き込み済みの末尾から追記を続ける。
+  */
+static void kvs_mount(void)
+{
+	uint8_t u8_Header[KVS_HEADER_SIZE];
+	uint8_t u8_Data;
+	uint8_t u8_Block;
+	uint32_t u32_Seq;
+	uint32_t u32_Last = 0;
+	uint16_t _j;
+	uint8_t _i;
+
+	/* ---- ブロックの状態を判定する ---- */
+	u32s_KvsNextSeq = 1;
+	for (_i=0; _i<KVS_BLOCK_NUM; _i++) {
+		LL_FLASH_Read((uint32_t)_i * LL_FLASH_BLOCK_SIZE, &u8_Header[0], KVS_HEADER_SIZE);
+		u32_Seq = (uint32_t)u8_Header[0] | ((uint32_t)u8_Header[1] << 8) | ((uint32_t)u8_Header[2] << 16) | ((uint32_t)u8_Header[3] << 24);
+		if ((u8_Header[4] == KVS_HEADER_MAGIC0) && (u8_Header[5] == KVS_HEADER_MAGIC1)
+		 && (kvs_crc16(&u8_Header[0], 6, 0xFFFF) == ((uint16_t)u8_Header[6] | ((uint16_t)u8_Header[7] << 8)))) {
+			u8s_KvsBlockState[_i] = KVS_BLOCK_USED;
+			u32s_KvsBlockSeq[_i] = u32_Seq;
+			if (u32_Seq >= u32s_KvsNextSeq) {
+				u32s_KvsNextSeq = u32_Seq + 1;
+			}
+			continue;
+		}
+		/* 全て FFh なら消去済み */
+		u8s_KvsBlockState[_i] = KVS_BLOCK_ERASED;
+		for (_j=0; _j<LL_FLASH_BLOCK_SIZE; _j++) {
+			LL_FLASH_Read(((uint32_t)_i * LL_FLASH_BLOCK_SIZE) + _j, &u8_Data, 1);
+			if (u8_Data != 0xFF) {
+				u8s_KvsBlockState[_i] = KVS_BLOCK_FREE;
+				break;
+			}
+		}
+	}
+
+	/* ---- 通し番号の順に再生する ---- */
+	while (true) {
+		u8_Block = KVS_BLOCK_NONE;
+		for (_i=0; _i<KVS_BLOCK_NUM; _i++) {
+			if ((u8s_KvsBlockState[_i] == KVS_BLOCK_USED) && (u32s_KvsBlockSeq[_i] > u32_Last)
+			 && ((u8_Block == KVS_BLOCK_NONE) || (u32s_KvsBlockSeq[_i] < u32s_KvsBlockSeq[u8_Block]))) {
+				u8_Block = _i;
+			}
+		}
+		if (u8_Block == KVS_BLOCK_NONE) {
+			break;
+		}
+		kvs_mount_block(u8_Block);
+		u32_Last = u32s_KvsBlockSeq[u8_Block];
+	}
+}
+
+/**
+  * @brief  1ブロックのレコードを復元する
+  * @param  u8_Block: ブロック番号
+  * @retval None
+  * @note   不正なレコード(書きかけ)は4byte単位で読み飛ばす。
+  *         追記位置は最後の FFh 以外のデータの後ろとする。
+  */
+static void kvs_mount_block(uint8_t u8_Block)
+{
+	uint32_t u32_Base = (uint32_t)u8_Block * LL_FLASH_BLOCK_SIZE;
+	uint8_t u8_Record[KVS_VALUE_MAX + 4];
+	KvsEntry *pst_Entry;
+	uint16_t u16_Tail;
+	uint16_t u16_Pos;
+	uint8_t u8_Key;
+	uint8_t u8_Len;
+	bool bl_Valid;
+
+	/* 書き込み済みの末尾 */
+	for (u16_Tail=LL_FLASH_BLOCK_SIZE; u16_Tail>KVS_HEADER_SIZE; u16_Tail--) {
+		LL_FLASH_Read(u32_Base + u16_Tail - 1, &u8_Record[0], 1);
+		if (u8_Record[0] != 0xFF) {
+			break;
+		}
+	}
+
+	u16_Pos = KVS_HEADER_SIZE;
+	while (u16_Pos < u16_Tail) {
+		LL_FLASH_Read(u32_Base + u16_Pos, &u8_Record[0], 2);
+		u8_Key = u8_Record[0] & (uint8_t)~KVS_RECORD_DELETE;
+		u8_Len = u8_Record[1];
+		bl_Valid = (u8_Key < KVS_KEY_MAX) && (u8_Len <= KVS_VALUE_MAX)
+				&& (((u8_Record[0] & KVS_RECORD_DELETE) != 0) == (u8_Len == 0))
+				&& ((u16_Pos + u8_Len + 4) <= LL_FLASH_BLOCK_SIZE);
+		if (bl_Valid) {
+			LL_FLASH_Read(u32_Base + u16_Pos + 2, &u8_Record[2], (uint32_t)u8_Len + 2);
+			bl_Valid = (kvs_crc16(&u8_Record[0], (uint16_t)(u8_Len + 2), 0xFFFF)
+					== ((uint16_t)u8_Record[u8_Len + 2] | ((uint16_t)u8_Record[u8_Len + 3] << 8)));
+		}
+		if (!bl_Valid) {
+			sts_KvsStat.u32_torn++;
+			u16_Pos += KVS_RECORD_ALIGN;
+			continue;
+		}
+		pst_Entry = &sts_KvsEntry[u8_Key];
+		mem_cpy08(&pst_Entry->u8_value[0], &u8_Record[2], u8_Len);
+		pst_Entry->u8_len = u8_Len;
+		pst_Entry->u8_block = u8_Block;
+		u16_Pos += KVS_RECORD_SIZE(u8_Len);
+	}
+
+	/* 通し番号が最新のブロックに追記を続ける */
+	u8s_KvsHead = u8_Block;
+	u16s_KvsHeadPos = u16_Pos;
+}
+
+/**
+  * @brief  書き込み/消去を1ステップ進める
+  * @param  None
+  * @retval KVS_STEP_IDLE/KVS_STEP_RUN/KVS_STEP_WAIT
+  */
+static uint8_t kvs_step(void)
+{
+	KvsJob *pst_Job = &sts_KvsJob;
+	uint8_t u8_Result;
+
+	if (pst_Job->u8_type == KVS_JOB_NONE) {
+		return kvs_schedule();
+	}
+
+	/* ---- 完了待ち ---- */
+	if (pst_Job->bl_wait) {
+		u8_Result = LL_FLASH_Poll();
+		if (u8_Result == LL_FLASH_BUSY) {
+			return (pst_Job->u8_type == KVS_JOB_ERASE) ? KVS_STEP_WAIT : KVS_STEP_RUN;
+		}
+		pst_Job->bl_wait = false;
+		if (u8_Result == LL_FLASH_ERROR) {
+			pst_Job->bl_error = true;
+			sts_KvsStat.u32_errors++;
+		}
+		if ((pst_Job->u8_type == KVS_JOB_ERASE) || pst_Job->bl_error) {
+			kvs_job_done();
+			return KVS_STEP_RUN;
+		}
+	}
+
+	/* ---- 1byteずつ書き込む(FFhは消去状態のまま) ---- */
+	while ((pst_Job->u16_pos < pst_Job->u16_size) && (pst_Job->u8_data[pst_Job->u16_pos] == 0xFF)) {
+		pst_Job->u16_pos++;
+	}
+	if (pst_Job->u16_pos < pst_Job->u16_size) {
+		LL_FLASH_ProgramStart(pst_Job->u32_offset + pst_Job->u16_pos, pst_Job->u8_data[pst_Job->u16_pos]);
+		pst_Job->u16_pos++;
+		pst_Job->bl_wait = true;
+	}
+	else {
+		kvs_job_done();
+	}
+	return KVS_STEP_RUN;
+}
+
+/**
+  * @brief  次の書き込み/消去を開始する
+  * @param  None
+  * @retval KVS_STEP_IDLE/KVS_STEP_RUN
+  * @note   追記し直し中は最古のブロックのレコードだけを書き込む
+  */
+static uint8_t kvs_schedule(void)
+{
+	KvsEntry *pst_Entry;
+	bool bl_Dirty = false;
+	uint8_t _i;
+
+	/* ---- 追記し直し ---- */
+	if (u8s_KvsCompact != KVS_BLOCK_NONE) {
+		for (_i=0; _i<KVS_KEY_MAX; _i++) {
+			pst_Entry = &sts_KvsEntry[_i];
+			if (pst_Entry->u8_block != u8s_KvsCompact) {
+				continue;
+			}
+			if (pst_Entry->u8_len == 0) {
+				/* 最古のブロックの削除レコードは不要(これより古い記録は無い) */
+				pst_Entry->u8_block = KVS_BLOCK_NONE;
+				pst_Entry->u8_dirty = 0;
+				continue;
+			}
+			kvs_start_record(_i);
+			return KVS_STEP_RUN;
+		}
+		/* 有効なレコードが無くなったらヘッダーを無効化する */
+		sts_KvsJob.u8_data[0] = 0x00;
+		kvs_start_program(KVS_JOB_RETIRE, ((uint32_t)u8s_KvsCompact * LL_FLASH_BLOCK_SIZE) + 4, 1);
+		return KVS_STEP_RUN;
+	}
+
+	/* ---- 更新の書き込み ---- */
+	for (_i=0; _i<KVS_KEY_MAX; _i++) {
+		if (sts_KvsEntry[_i].u8_dirty) {
+			bl_Dirty = true;
+			if (bls_KvsFlush || checkTimer(&sts_KvsTimer, KVS_WRITE_DELAY)) {
+				kvs_start_record(_i);
+				return KVS_STEP_RUN;
+			}
+			break;
+		}
+	}
+	if (!bl_Dirty) {
+		stopTimer(&sts_KvsTimer);
+		bls_KvsFlush = false;
+	}
+	LL_FLASH_ExitPE();
+	return KVS_STEP_IDLE;
+}
+
+/**
+  * @brief  レコード書き込みを開始する
+  * @param  u8_Key: キー
+  * @retval None
+  * @note   追記するブロックに空きが無ければ、先に新しいブロックを用意する
+  *         (空きブロックが少なければ追記し直しを始める)
+  */
+static void kvs_start_record(uint8_t u8_Key)
+{
+	KvsEntry *pst_Entry = &sts_KvsEntry[u8_Key];
+	KvsJob *pst_Job = &sts_KvsJob;
+	uint8_t u8_Block;
+	uint16_t u16_Crc;
+
+	if ((u8s_KvsHead == KVS_BLOCK_NONE) || ((u16s_KvsHeadPos + KVS_RECORD_SIZE(pst_Entry->u8_len)) > LL_FLASH_BLOCK_SIZE)) {
+		u8s_KvsHead = KVS_BLOCK_NONE;
+		if ((u8s_KvsCompact == KVS_BLOCK_NONE) && (kvs_count_free() <= KVS_RESERVE_BLOCKS)) {
+			u8s_KvsCompact = kvs_find_block(KVS_BLOCK_USED, true);
+			if (u8s_KvsCompact != KVS_BLOCK_NONE) {
+				sts_KvsStat.u32_compactions++;
+				return;
+			}
+		}
+		/* 消去済みのブロックを優先し、無ければ消去する */
+		u8_Block = kvs_find_block(KVS_BLOCK_ERASED, false);
+		if (u8_Block == KVS_BLOCK_NONE) {
+			u8_Block = kvs_find_block(KVS_BLOCK_FREE, false);
+		}
+		if (u8_Block == KVS_BLOCK_NONE) {
+			return;
+		}
+		LL_FLASH_EnterPE();
+		pst_Job->u8_block = u8_Block;
+		if (u8s_KvsBlockState[u8_Block] == KVS_BLOCK_FREE) {
+			pst_Job->u8_type = KVS_JOB_ERASE;
+			pst_Job->bl_error = false;
+			pst_Job->bl_wait = true;
+			LL_FLASH_EraseStart((uint32_t)u8_Block * LL_FLASH_BLOCK_SIZE);
+			return;
+		}
+		pst_Job->u8_data[0] = (uint8_t)u32s_KvsNextSeq;
+		pst_Job->u8_data[1] = (uint8_t)(u32s_KvsNextSeq >> 8);
+		pst_Job->u8_data[2] = (uint8_t)(u32s_KvsNextSeq >> 16);
+		pst_Job->u8_data[3] = (uint8_t)(u32s_KvsNextSeq >> 24);
+		pst_Job->u8_data[4] = KVS_HEADER_MAGIC0;
+		pst_Job->u8_data[5] = KVS_HEADER_MAGIC1;
+		u16_Crc = kvs_crc16(&pst_Job->u8_data[0], 6, 0xFFFF);
+		pst_Job->u8_data[6] = (uint8_t)u16_Crc;
+		pst_Job->u8_data[7] = (uint8_t)(u16_Crc >> 8);
+		kvs_start_program(KVS_JOB_HEADER, (uint32_t)u8_Block * LL_FLASH_BLOCK_SIZE, KVS_HEADER_SIZE);
+		return;
+	}
+
+	/* キー,長さ,値,CRC16 */
+	pst_Job->u8_key = u8_Key;
+	pst_Job->u8_data[0] = (uint8_t)(u8_Key | ((pst_Entry->u8_len == 0) ? KVS_RECORD_DELETE : 0));
+	pst_Job->u8_data[1] = pst_Entry->u8_len;
+	mem_cpy08(&pst_Job->u8_data[2], &pst_Entry->u8_value[0], pst_Entry->u8_len);
+	u16_Crc = kvs_crc16(&pst_Job->u8_data[0], (uint16_t)(pst_Entry->u8_len + 2), 0xFFFF);
+	pst_Job->u8_data[pst_Entry->u8_len + 2] = (uint8_t)u16_Crc;
+	pst_Job->u8_data[pst_Entry->u8_len + 3] = (uint8_t)(u16_Crc >> 8);
+	pst_Entry->u8_dirty = 0;
+	kvs_start_program(KVS_JOB_RECORD, ((uint32_t)u8s_KvsHead * LL_FLASH_BLOCK_SIZE) + u16s_KvsHeadPos, (uint16_t)(pst_Entry->u8_len + 4));
+}
+
+/**
+  * @brief  書き込みを開始する
+  * @param  u8_Type: 処理の種類
+  * @param  u32_Offset: 書き込み先オフセット
+  * @param  u16_Size: 書き込みサイズ(データはsts_KvsJob.u8_dataに用意する)
+  * @retval None
+  */
+static void kvs_start_program(uint8_t u8_Type, uint32_t u32_Offset, uint16_t u16_Size)
+{
+	KvsJob *pst_Job = &sts_KvsJob;
+
+	LL_FLASH_EnterPE();
+	pst_Job->u8_type = u8_Type;
+	pst_Job->u32_offset = u32_Offset;
+	pst_Job->u16_size = u16_Size;
+	pst_Job->u16_pos = 0;
+	pst_Job->bl_wait = false;
+	pst_Job->bl_error = false;
+}
+
+/**
+  * @brief  書き込み/消去の完了処理
+  * @param  None
+  * @retval None
+  */
+static void kvs_job_done(void)
+{
+	KvsJob *pst_Job = &sts_KvsJob;
+	KvsEntry *pst_Entry;
+
+	switch (pst_Job->u8_type) {
+	case KVS_JOB_ERASE:
+		sts_KvsStat.u32_erases++;
+		u8s_KvsBlockState[pst_Job->u8_block] = pst_Job->bl_error ? KVS_BLOCK_BAD : KVS_BLOCK_ERASED;
+		break;
+	case KVS_JOB_HEADER:
+		if (pst_Job->bl_error) {
+			u8s_KvsBlockState[pst_Job->u8_block] = KVS_BLOCK_BAD;
+			break;
+		}
+		u8s_KvsBlockState[pst_Job->u8_block] = KVS_BLOCK_USED;
+		u32s_KvsBlockSeq[pst_Job->u8_block] = u32s_KvsNextSeq++;
+		u8s_KvsHead = pst_Job->u8_block;
+		u16s_KvsHeadPos = KVS_HEADER_SIZE;
+		break;
+	case KVS_JOB_RECORD:
+		pst_Entry = &sts_KvsEntry[pst_Job->u8_key];
+		if (pst_Job->bl_error) {
+			/* 残りの領域は使わず、新しいブロックに書き直す */
+			kvs_set_dirty(pst_Entry);
+			u8s_KvsHead = KVS_BLOCK_NONE;
+			break;
+		}
+		pst_Entry->u8_block = u8s_KvsHead;
+		u16s_KvsHeadPos += KVS_RECORD_SIZE(pst_Job->u16_size - 4);
+		sts_KvsStat.u32_records++;
+		break;
+	case KVS_JOB_RETIRE:
+		/* 消去は新しいブロックとして使うときに行う */
+		u8s_KvsBlockState[u8s_KvsCompact] = KVS_BLOCK_FREE;
+		u8s_KvsCompact = KVS_BLOCK_NONE;
+		break;
+	default:
+		break;
+	}
+	pst_Job->u8_type = KVS_JOB_NONE;
+}
+
+/**
+  * @brief  ブロックを探す
+  * @param  u8_State: ブロックの状態
+  * @param  bl_Oldest: true:通し番号が最古のもの / false:追記中のブロックの次から順に
+  * @retval ブロック番号(KVS_BLOCK_NONE:無し)
+  */
+static uint8_t kvs_find_block(uint8_t u8_State, bool bl_Oldest)
+{
+	uint8_t u8_Found = KVS_BLOCK_NONE;
+	uint8_t u8_Block;
+	uint8_t u8_Newest = 0;
+	uint8_t _i;
+
+	if (bl_Oldest) {
+		for (_i=0; _i<KVS_BLOCK_NUM; _i++) {
+			if ((u8s_KvsBlockState[_i] == u8_State)
+			 && ((u8_Found == KVS_BLOCK_NONE) || (u32s_KvsBlockSeq[_i] < u32s_KvsBlockSeq[u8_Found]))) {
+				u8_Found = _i;
+			}
+		}
+		return u8_Found;
+	}
+
+	/* 最新のブロックの次から順に使う(書き換え回数の平準化) */
+	for (_i=0; _i<KVS_BLOCK_NUM; _i++) {
+		if ((u8s_KvsBlockState[_i] == KVS_BLOCK_USED) && (u32s_KvsBlockSeq[_i] >= u32s_KvsBlockSeq[u8_Newest])) {
+			u8_Newest = _i;
+		}
+	}
+	for (_i=1; _i<=KVS_BLOCK_NUM; _i++) {
+		u8_Block = (uint8_t)((u8_Newest + _i) % KVS_BLOCK_NUM);
+		if (u8s_KvsBlockState[u8_Block] == u8_State) {
+			return u8_Block;
+		}
+	}
+	return KVS_BLOCK_NONE;
+}
+
+/**
+  * @brief  空きブロック数を取得する
+  * @param  None
+  * @retval 空きブロック数
+  */
+static uint8_t kvs_count_free(void)
+{
+	uint8_t u8_Count = 0;
+	uint8_t _i;
+
+	for (_i=0; _i<KVS_BLOCK_NUM; _i++) {
+		if ((u8s_KvsBlockState[_i] == KVS_BLOCK_FREE) || (u8s_KvsBlockState[_i] == KVS_BLOCK_ERASED)) {
+			u8_Count++;
+		}
+	}
+	return u8_Count;
+}
+
+/**
+  * @brief  未書き込みにする
+  * @param  pst_Entry: キーの情報
+  * @retval None
+  */
+static void kvs_set_dirty(KvsEntry *pst_Entry)
+{
+	if (pst_Entry->u8_dirty) {
+		/* 書き込み前の更新はまとめる */
+		sts_KvsStat.u32_coalesced++;
+	}
+	pst_Entry->u8_dirty = 1;
+	if (!isRunTimer(&sts_KvsTimer)) {
+		startTimer(&sts_KvsTimer);
+	}
+}
+
+/**
+  * @brief  CRC-16/CCITT(多項式1021h)を計算する
+  * @param  pu8_Data: データ
+  * @param  u16_Size: サイズ[byte]
+  * @param  u16_Crc: 初期値
+  * @retval CRC
+  */
+static uint16_t kvs_crc16(const uint8_t *pu8_Data, uint16_t u16_Size, uint16_t u16_Crc)
+{
+	uint16_t _i;
+	uint8_t _j;
+
+	for (_i=0; _i<u16_Size; _i++) {
+		u16_Crc ^= (uint16_t)pu8_Data[_i] << 8;
+		for (_j=0; _j<8; _j++) {
+			u16_Crc = (u16_Crc & 0x8000) ? (uint16_t)((u16_Crc << 1) ^ 0x1021) : (uint16_t)(u16_Crc << 1);
+		}
+	}
+	return u16_Crc;
+}
+
@@ -0,0 +1,417 @@
+/**
+  ******************************************************************************
+  * @file           : drv_lat.c
+  * @brief          : 割り込み遅延計測ドライバー
+  ******************************************************************************
+  * @note   GPTの周期オーバーフロー割り込み(プローブ)はカウンタが0に戻った時刻が
+  *         発生時刻となるため、ハンドラー入口で読んだGTCNTが割り込み遅延となる
+  *         (CPUクロックのサイクル数に換算する)。入口のDWTサイクル数から求めた
+  *         発生時刻の間隔で、周期を超えてまとまったオーバーフローを検出する。
+  *         プローブはSCI1_RXI/PORT_IRQn(drv_exti)と同じ優先度で動かし、割り込み
+  *         禁止区間や同じ優先度以上のハンドラーによる待ちを同じ条件で受ける
+  *         (実際の受信やエッジは発生時刻が分からないため代わりに計測する)。
+  *         周期はSysTick(1ms)と同期しない値とし、発生位置を周期処理の全体に散らす。
+  *
+  *         遅延はサイクル数の対数ヒストグラム(1オクターブを4分割)に記録し、
+  *         最小/最大は正確な値を、p50/p99は該当する区間の上限を返す。
+  *         周期を超えた遅延はオーバーフローが1回にまとまるため、欠落数として数え、
+  *         遅延には最初のオーバーフローからの時間を記録する。
+  *         ヒストグラムは割り込みだけが書き込み、周期処理からは計測中も
+  *         割り込みを禁止せずに読み出す(読み出し中の1回分の不一致は許容する)。
+  *         DWTとGPTは同じクロック源のため、計測中はクロック変更を拒否する。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "drv.h"
+#include "lib.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* プローブ設定 */
+typedef struct _LatProbeConfig {
+	const char *pc_name;			/* 表示名(対象の割り込み)				*/
+	uint8_t u8_irq;					/* IRQ番号								*/
+	uint8_t u8_priority;			/* 割り込み優先度(対象と同じ)			*/
+	uint16_t u16_period_us;			/* 周期[us]								*/
+	elc_event_t en_event;			/* オーバーフローのイベント				*/
+} LatProbeConfig;
+
+/* プローブ情報 */
+typedef struct _LatProbe {
+	uint32_t u32_event;				/* 直前のオーバーフローのサイクル数		*/
+	uint32_t u32_period;			/* 周期[サイクル]						*/
+	bool bl_event;					/* u32_eventが有効						*/
+	uint32_t u32_count;				/* 計測回数								*/
+	uint32_t u32_missed;			/* 欠落したオーバーフロー数				*/
+	uint32_t u32_min;				/* 最小遅延[サイクル]					*/
+	uint32_t u32_max;				/* 最大遅延[サイクル]					*/
+	uint32_t u32_hist[LAT_HIST_BUCKETS];	/* ヒストグラム					*/
+} LatProbe;
+
+/* Private define ------------------------------------------------------------*/
+#define LAT_HIST_SUB_BITS	(2)						/* 1オクターブの分割(2^n)		*/
+#define LAT_HIST_SUB		(1UL << LAT_HIST_SUB_BITS)
+#define LAT_GPT_PERIOD_MAX	(0x10000)				/* GPT(16bit)周期の上限			*/
+#define LAT_CEILING			(IRQ_PRIO_HIGHER(IRQ_PRIO_SCI1, IRQ_PRIO_PORT_IRQ))	/* プローブのシーリング	*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static LatProbe sts_LatProbe[LAT_PROBE_NUM];		/* プローブ情報				*/
+static bool bls_LatRunning;							/* 計測中					*/
+static uint32_t u32s_LatRatio;						/* GPTの1カウントのサイクル数	*/
+
+/* プローブ設定(周期は互いに素,SysTickの1msと同期しない) */
+static const LatProbeConfig csts_LatProbeConfig[LAT_PROBE_NUM] = {
+	{"sci1_rxi",	IRQ_GPT6_OVF,	IRQ_PRIO_SCI1,		997,	ELC_EVENT_GPT6_COUNTER_OVERFLOW},	// SCI1_RXIと同じ優先度
+	{"port_irq",	IRQ_GPT7_OVF,	IRQ_PRIO_PORT_IRQ,	1013,	ELC_EVENT_GPT7_COUNTER_OVERFLOW},	// PORT_IRQn(drv_exti)と同じ優先度
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static R_GPT0_Type *lat_gpt(uint8_t u8_Probe);				/* プローブのGPTを取得する		*/
+static void lat_isr(uint8_t u8_Probe);						/* プローブ割り込み共通処理		*/
+static uint8_t lat_bucket(uint32_t u32_Cycles);				/* ヒストグラムの区間を求める	*/
+static uint32_t lat_bucket_upper(uint8_t u8_Bucket);		/* 区間の上限を求める			*/
+static uint32_t lat_percentile(const LatProbe *pst_Probe, uint8_t u8_Percent);	/* パーセンタイルを求める	*/
+static void lat_clear_probe(LatProbe *pst_Probe);			/* 計測結果を消去する			*/
+static uint8_t lat_clock_callback(uint8_t u8_Event, uint8_t u8_Mode);	/* クロック変更コールバック	*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  GPT6オーバーフロー割り込みハンドラ(SCI1_RXI優先度のプローブ)
+  * @param  None
+  * @retval None
+  */
+void GPT6_OVF_Handler(void)
+{
+	lat_isr(LAT_PROBE_SCI1_RXI);
+}
+
+/**
+  * @brief  GPT7オーバーフロー割り込みハンドラ(PORT_IRQn優先度のプローブ)
+  * @param  None
+  * @retval None
+  */
+void GPT7_OVF_Handler(void)
+{
+	lat_isr(LAT_PROBE_PORT_IRQ);
+}
+
+/**
+  * @brief  割り込み遅延計測ドライバー初期化処理
+  * @param  None
+  * @retval None
+  */
+void taskLatDriverInit(void)
+{
+	uint8_t _i;
+	uint32_t u32_Mask;
+
+	bls_LatRunning = false;
+	u32s_LatRatio = 1;
+	for (_i=0; _i<LAT_PROBE_NUM; _i++) {
+		lat_clear_probe(&sts_LatProbe[_i]);
+		sts_LatProbe[_i].u32_period = 0;
+	}
+
+	/* ---- ベクターテーブル登録 ---- */
+	u32_Mask = LL_IRQ_Lock(LAT_CEILING);
+	NVIC_SetVector((IRQn_Type)IRQ_GPT6_OVF, (uintptr_t)GPT6_OVF_Handler);
+	NVIC_SetVector((IRQn_Type)IRQ_GPT7_OVF, (uintptr_t)GPT7_OVF_Handler);
+	LL_IRQ_Unlock(u32_Mask);
+
+	/* ---- クロック変更の通知先を登録する ---- */
+	if (clockRegisterCallback(lat_clock_callback) != OK) {
+		Error_Handler();
+	}
+}
+
+/**
+  * @brief  割り込み遅延の計測を開始する
+  * @param  None
+  * @retval OK/NG(計測中,ICLKがPCLKDの整数倍でない)
+  * @note   計測結果は消去しない(latClear)
+  */
+uint8_t latStart(void)
+{
+	const LatProbeConfig *pst_Config;
+	R_GPT0_Type *pst_Gpt;
+	uint32_t u32_Pclkd = R_FSP_SystemClockHzGet(FSP_PRIV_CLOCK_PCLKD);
+	uint32_t u32_Counts;
+	uint8_t _i;
+
+	if (bls_LatRunning || (u32_Pclkd == 0) || ((SystemCoreClock % u32_Pclkd) != 0)) {
+		return NG;
+	}
+	u32s_LatRatio = SystemCoreClock / u32_Pclkd;
+
+	/* ---- モジュールストップ解除 ---- */
+	R_MSTP->MSTPCRD_b.MSTPD6 = 0;					// GPT162～GPT167 ON
+
+	for (_i=0; _i<LAT_PROBE_NUM; _i++) {
+		pst_Config = &csts_LatProbeConfig[_i];
+		pst_Gpt = lat_gpt(_i);
+		u32_Counts = (u32_Pclkd / 1000000) * pst_Config->u16_period_us;
+		if (u32_Counts > LAT_GPT_PERIOD_MAX) {
+			u32_Counts = LAT_GPT_PERIOD_MAX;
+		}
+
+		/* ---- GPT 設定 ---- */
+		pst_Gpt->GTCR = 0x00000000;					// 停止, のこぎり波, PCLKD/1
+		pst_Gpt->GTUDDTYC = 0x00000001;				// アップカウント
+		pst_Gpt->GTPR = u32_Counts - 1;
+		pst_Gpt->GTCNT = 0;
+		sts_LatProbe[_i].u32_period = u32_Counts * u32s_LatRatio;
+		sts_LatProbe[_i].bl_event = false;
+
+		/* ---- ICU → NVIC 割り込み割り当て (GPTn_OVF) ---- */
+		R_ICU->IELSR_b[pst_Config->u8_irq].IR = 0;	// 割り込み要求フラグ クリア
+		R_ICU->IELSR_b[pst_Config->u8_irq].IELS = (uint32_t)pst_Config->en_event;
+		NVIC_ClearPendingIRQ((IRQn_Type)pst_Config->u8_irq);
+		NVIC_SetPriority((IRQn_Type)pst_Config->u8_irq, pst_Config->u8_priority);
+		NVIC_EnableIRQ((IRQn_Type)pst_Config->u8_irq);
+	}
+
+	/* ---- カウント開始 ---- */
+	bls_LatRunning = true;
+	for (_i=0; _i<LAT_PROBE_NUM; _i++) {
+		lat_gpt(_i)->GTCR_b.CST = 1;
+	}
+	return OK;
+}
+
+/**
+  * @brief  割り込み遅延の計測を停止する
+  * @param  None
+  * @retval None
+  * @note   計測結果は保持する
+  */
+void latStop(void)
+{
+	uint8_t _i;
+
+	if (!bls_LatRunning) {
+		return;
+	}
+	for (_i=0; _i<LAT_PROBE_NUM; _i++) {
+		NVIC_DisableIRQ((IRQn_Type)csts_LatProbeConfig[_i].u8_irq);
+		R_ICU->IELSR[csts_LatProbeConfig[_i].u8_irq] = 0x00000000;
+		lat_gpt(_i)->GTCR_b.CST = 0;
+	}
+	bls_LatRunning = false;
+}
+
+/**
+  * @brief  計測中かを取得する
+  * @param  None
+  * @retval true:計測中
+  */
+bool latIsRunning(void)
+{
+	return bls_LatRunning;
+}
+
+/**
+  * @brief  計測結果を消去する
+  * @param  None
+  * @retval None
+  * @note   計測中は各プローブの割り込みだけを止めて消去する
+  */
+void latClear(void)
+{
+	uint8_t _i;
+
+	for (_i=0; _i<LAT_PROBE_NUM; _i++) {
+		if (bls_LatRunning) {
+			NVIC_DisableIRQ((IRQn_Type)csts_LatProbeConfig[_i].u8_irq);
+		}
+		lat_clear_probe(&sts_LatProbe[_i]);
+		if (bls_LatRunning) {
+			NVIC_EnableIRQ((IRQn_Type)csts_LatProbeConfig[_i].u8_irq);
+		}
+	}
+}
+
+/**
+  * @brief  計測結果を取得する
+  * @param  u8_Probe: プローブ(LAT_PROBE_xxx)
+  * @param  pst_Result: 計測結果の格納先
+  * @retval OK/NG(プローブ番号異常)
+  * @note   遅延はCPUクロックのサイクル数(計測0回の間は全て0)
+  */
+uint8_t latGetResult(uint8_t u8_Probe, LatResult *pst_Result)
+{
+	const LatProbe *pst_Probe;
+
+	if (u8_Probe >= LAT_PROBE_NUM) {
+		return NG;
+	}
+	pst_Probe = &sts_LatProbe[u8_Probe];
+	pst_Result->pc_name = csts_LatProbeConfig[u8_Probe].pc_name;
+	pst_Result->u32_period = pst_Probe->u32_period;
+	pst_Result->u32_count = pst_Probe->u32_count;
+	pst_Result->u32_missed = pst_Probe->u32_missed;
+	if (pst_Result->u32_count == 0) {
+		pst_Result->u32_min = 0;
+		pst_Result->u32_max = 0;
+		pst_Result->u32_p50 = 0;
+		pst_Result->u32_p99 = 0;
+		return OK;
+	}
+	pst_Result->u32_min = pst_Probe->u32_min;
+	pst_Result->u32_max = pst_Probe->u32_max;
+	pst_Result->u32_p50 = lat_percentile(pst_Probe, 50);
+	pst_Result->u32_p99 = lat_percentile(pst_Probe, 99);
+	return OK;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  プローブのGPTを取得する
+  * @param  u8_Probe: プローブ(LAT_PROBE_xxx)
+  * @retval GPTのレジスタ
+  */
+static R_GPT0_Type *lat_gpt(uint8_t u8_Probe)
+{
+	return (u8_Probe == LAT_PROBE_SCI1_RXI) ? (R_GPT0_Type *)R_GPT6 : (R_GPT0_Type *)R_GPT7;
+}
+
+/**
+  * @brief  プローブ割り込み共通処理
+  * @param  u8_Probe: プローブ(LAT_PROBE_xxx)
+  * @retval None
+  * @note   GTCNTはハンドラーの最初に読み出す
+  */
+static void lat_isr(uint8_t u8_Probe)
+{
+	uint32_t u32_Latency = lat_gpt(u8_Probe)->GTCNT * u32s_LatRatio;
+	uint32_t u32_Now = LL_DWT_GetCycle();
+	LatProbe *pst_Probe = &sts_LatProbe[u8_Probe];
+	uint32_t u32_Event = u32_Now - u32_Latency;
+	uint32_t u32_Periods;
+
+	/* 割り込み要求フラグ クリア */
+	R_ICU->IELSR_b[csts_LatProbeConfig[u8_Probe].u8_irq].IR = 0;
+
+	/* 前回の発生時刻から周期の何倍か(四捨五入)でまとまったオーバーフローを求める */
+	if (pst_Probe->bl_event) {
+		u32_Periods = (u32_Event - pst_Probe->u32_event + (pst_Probe->u32_period / 2)) / pst_Probe->u32_period;
+		if (u32_Periods > 1) {
+			pst_Probe->u32_missed += u32_Periods - 1;
+			u32_Latency += (u32_Periods - 1) * pst_Probe->u32_period;
+		}
+	}
+	pst_Probe->u32_event = u32_Event;
+	pst_Probe->bl_event = true;
+
+	if (pst_Probe->u32_count == 0) {
+		pst_Probe->u32_min = u32_Latency;
+		pst_Probe->u32_max = u32_Latency;
+	}
+	else if (u32_Latency < pst_Probe->u32_min) {
+		pst_Probe->u32_min = u32_Latency;
+	}
+	else if (u32_Latency > pst_Probe->u32_max) {
+		pst_Probe->u32_max = u32_Latency;
+	}
+	pst_Probe->u32_hist[lat_bucket(u32_Latency)]++;
+	pst_Probe->u32_count++;
+}
+
+/**
+  * @brief  ヒストグラムの区間を求める
+  * @param  u32_Cycles: 遅延[サイクル]
+  * @retval 区間(0～LAT_HIST_BUCKETS-1)
+  * @note   4未満はそのまま、4以上は最上位bitと続く2bitで区間を決める
+  */
+static uint8_t lat_bucket(uint32_t u32_Cycles)
+{
+	uint32_t u32_Msb;
+	uint32_t u32_Bucket;
+
+	if (u32_Cycles < LAT_HIST_SUB) {
+		return (uint8_t)u32_Cycles;
+	}
+	u32_Msb = 31 - (uint32_t)__builtin_clz(u32_Cycles);
+	u32_Bucket = ((u32_Msb - LAT_HIST_SUB_BITS + 1) << LAT_HIST_SUB_BITS)
+			   | ((u32_Cycles >> (u32_Msb - LAT_HIST_SUB_BITS)) & (LAT_HIST_SUB - 1));
+	return (u32_Bucket < LAT_HIST_BUCKETS) ? (uint8_t)u32_Bucket : (LAT_HIST_BUCKETS - 1);
+}
+
+/**
+  * @brief  区間の上限を求める
+  * @param  u8_Bucket: 区間
+  * @retval 区間に含まれる最大の遅延[サイクル](最後の区間は上限なし)
+  */
+static uint32_t lat_bucket_upper(uint8_t u8_Bucket)
+{
+	uint32_t u32_Shift;
+	uint32_t u32_Lower;
+
+	if (u8_Bucket >= (LAT_HIST_BUCKETS - 1)) {
+		return 0xFFFFFFFFUL;
+	}
+	if (u8_Bucket < LAT_HIST_SUB) {
+		return u8_Bucket;
+	}
+	u32_Shift = (uint32_t)(u8_Bucket >> LAT_HIST_SUB_BITS) - 1;
+	u32_Lower = (LAT_HIST_SUB + (u8_Bucket & (LAT_HIST_SUB - 1))) << u32_Shift;
+	return u32_Lower + (1UL << u32_Shift) - 1;
+}
+
+/**
+  * @brief  パーセンタイルを求める
+  * @param  pst_Probe: プローブ情報
+  * @param  u8_Percent: パーセント(1～100)
+  * @retval 該当する区間の上限(最大値で頭打ち)[サイクル]
+  */
+static uint32_t lat_percentile(const LatProbe *pst_Probe, uint8_t u8_Percent)
+{
+	uint32_t u32_Rank = (uint32_t)(((uint64_t)pst_Probe->u32_count * u8_Percent + 99) / 100);
+	uint32_t u32_Sum = 0;
+	uint32_t u32_Upper;
+	uint8_t _i;
+
+	for (_i=0; _i<LAT_HIST_BUCKETS; _i++) {
+		u32_Sum += pst_Probe->u32_hist[_i];
+		if (u32_Sum >= u32_Rank) {
+			break;
+		}
+	}
+	u32_Upper = lat_bucket_upper(_i);
+	return (u32_Upper < pst_Probe->u32_max) ? u32_Upper : pst_Probe->u32_max;
+}
+
+/**
+  * @brief  計測結果を消去する
+  * @param  pst_Probe: プローブ情報
+  * @retval None
+  * @note   周期と直前の発生時刻は残す
+  */
+static void lat_clear_probe(LatProbe *pst_Probe)
+{
+	pst_Probe->u32_count = 0;
+	pst_Probe->u32_missed = 0;
+	pst_Probe->u32_min = 0;
+	pst_Probe->u32_max = 0;
+	mem_set08((uint8_t *)&pst_Probe->u32_hist[0], 0, sizeof(pst_Probe->u32_hist));
+}
+
+/**
+  * @brief  クロック変更コールバック
+  * @param  u8_Event: CLOCK_EVENT_xxx
+  * @param  u8_Mode: 切り替え先の動作モード
+  * @retval OK/NG(計測中は切り替えを拒否する)
+  */
+static uint8_t lat_clock_callback(uint8_t u8_Event, uint8_t u8_Mode)
+{
+	(void)u8_Mode;
+	if ((u8_Event == CLOCK_EVENT_PRE) && bls_LatRunning) {
+		return NG;
+	}
+	return OK;
+}
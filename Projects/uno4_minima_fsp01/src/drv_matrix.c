@@ -0,0 +1,436 @@
+/**
+  ******************************************************************************
+  * @file           : drv_matrix.c
+  * @brief          : LEDマトリクスドライバー(UNO R4 WiFi 12×8)
+  ******************************************************************************
+  * @note   UNO R4 WiFiのLEDマトリクスは11本のライン(P205,P012,P013,P003,P004,
+  *         P011,P015,P204,P206,P212,P213)によるチャーリープレクシングで、
+  *         LEDはアノード側のラインをHigh、カソード側をLow、他をHi-Zにすると
+  *         点灯する。アノードのライン毎に走査し、同じアノードのLEDをまとめて
+  *         点灯する(1フレーム11ライン)。
+  *         輝度は各ラインの表示時間を4枚のビットプレーン(時間比1:2:4:8)に分けた
+  *         16段階のBCM(Binary Code Modulation)とし、GPT0オーバーフロー割り込みで
+  *         44ステップを走査する。割り込みはGTPRに次の表示時間を設定し、
+  *         ステップ毎のポート0/2の値(PCNTR1形式)を書き込むだけにする。
+  *         DTCでは共用のポートレジスタを読み出し変更書き込みできないため、
+  *         PDR/PODRの書き換えは割り込みで行う(GPIO_PDR_CEILINGはGPT0の優先度を
+  *         含めており、gpioドライバーの書き換えとは競合しない)。
+  *
+  *         描画はmatrixGetBuffer()の画素(行×列,0～255)に書き込み、matrixSwap()で
+  *         裏面の走査テーブルに変換して、次のフレームの先頭で表示面と入れ替える。
+  *         入れ替え待ちの間のmatrixSwap()はNGを返す(描画は続けてよい)。
+  *         Minimaでは同じ端子が汎用端子やTX/RX LEDのため、matrixOpen()は
+  *         WiFiボード(BOARD_UNO_R4_WIFI)でだけ呼び出すこと。
+  *         LEDとラインの対応はArduino UNO R4コア(Arduino_LED_Matrix)の表による。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "drv.h"
+#include "lib.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* ライン端子 */
+typedef struct _MatrixLinePin {
+	uint8_t u8_port;				/* ポート番号(0 or 2)					*/
+	uint8_t u8_pin;					/* 端子番号								*/
+} MatrixLinePin;
+
+/* 走査ステップ(PCNTR1形式: 上位16bit=PODR, 下位16bit=PDR) */
+typedef struct _MatrixStep {
+	uint32_t u32_port0;				/* ポート0のライン端子の値				*/
+	uint32_t u32_port2;				/* ポート2のライン端子の値				*/
+} MatrixStep;
+
+/* Private define ------------------------------------------------------------*/
+#define MATRIX_LINES		(11)							/* ライン数					*/
+#define MATRIX_PLANES		(4)								/* ビットプレーン数			*/
+#define MATRIX_STEPS		(MATRIX_LINES * MATRIX_PLANES)	/* 1フレームのステップ数	*/
+#define MATRIX_LED_NUM		(MATRIX_ROWS * MATRIX_COLS)		/* LED数					*/
+#define MATRIX_FRAME_UNITS	(MATRIX_LINES * ((1 << MATRIX_PLANES) - 1))	/* 1フレームの時間単位数	*/
+#define MATRIX_PORT0_PINS	(0xB818)						/* P003,P004,P011,P012,P013,P015	*/
+#define MATRIX_PORT2_PINS	(0x3070)						/* P204,P205,P206,P212,P213			*/
+#define MATRIX_PORT0_MASK	((MATRIX_PORT0_PINS << 16) | MATRIX_PORT0_PINS)
+#define MATRIX_PORT2_MASK	((MATRIX_PORT2_PINS << 16) | MATRIX_PORT2_PINS)
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t u8s_MatrixPixel[MATRIX_LED_NUM];				/* 描画用の画素				*/
+static MatrixStep sts_MatrixStep[2][MATRIX_STEPS];			/* 走査テーブル(表/裏)		*/
+static volatile uint8_t u8s_MatrixFront;					/* 表示中の走査テーブル		*/
+static volatile bool bls_MatrixPending;						/* 裏面の入れ替え待ち		*/
+static uint8_t u8s_MatrixStepNo;							/* 次に表示するステップ		*/
+static volatile uint32_t u32s_MatrixUnit;					/* 表示時間の単位[GPTカウント]	*/
+static bool bls_MatrixRunning;								/* 表示中					*/
+static bool bls_MatrixFrameValid;							/* u32s_MatrixFrameStartが有効	*/
+static uint32_t u32s_MatrixFrameStart;						/* フレーム先頭のサイクル数	*/
+static uint32_t u32s_MatrixBusyCycle;						/* フレーム内の割り込み処理サイクル	*/
+static uint32_t u32s_MatrixFramePeriod;						/* 直前のフレーム周期[サイクル]	*/
+static MatrixStatistics sts_MatrixStatistics;				/* 統計情報					*/
+
+/* ライン端子(ライン番号順) */
+static const MatrixLinePin csts_MatrixLinePin[MATRIX_LINES] = {
+	{2, 5}, {0, 12}, {0, 13}, {0, 3}, {0, 4}, {0, 11}, {0, 15}, {2, 4}, {2, 6}, {2, 12}, {2, 13},
+};
+
+/* LED毎のライン番号(アノード,カソード)。行0の左端から行毎に並べる */
+static const uint8_t cu8s_MatrixLed[MATRIX_LED_NUM][2] = {
+	{ 7, 3}, { 3, 7}, { 7, 4}, { 4, 7}, { 3, 4}, { 4, 3}, { 7, 8}, { 8, 7}, { 3, 8}, { 8, 3}, { 4, 8}, { 8, 4},	// 行0
+	{ 7, 0}, { 0, 7}, { 3, 0}, { 0, 3}, { 4, 0}, { 0, 4}, { 8, 0}, { 0, 8}, { 7, 6}, { 6, 7}, { 3, 6}, { 6, 3},	// 行1
+	{ 4, 6}, { 6, 4}, { 8, 6}, { 6, 8}, { 0, 6}, { 6, 0}, { 7, 5}, { 5, 7}, { 3, 5}, { 5, 3}, { 4, 5}, { 5, 4},	// 行2
+	{ 8, 5}, { 5, 8}, { 0, 5}, { 5, 0}, { 6, 5}, { 5, 6}, { 7, 1}, { 1, 7}, { 3, 1}, { 1, 3}, { 4, 1}, { 1, 4},	// 行3
+	{ 8, 1}, { 1, 8}, { 0, 1}, { 1, 0}, { 6, 1}, { 1, 6}, { 5, 1}, { 1, 5}, { 7, 2}, { 2, 7}, { 3, 2}, { 2, 3},	// 行4
+	{ 4, 2}, { 2, 4}, { 8, 2}, { 2, 8}, { 0, 2}, { 2, 0}, { 6, 2}, { 2, 6}, { 5, 2}, { 2, 5}, { 1, 2}, { 2, 1},	// 行5
+	{ 7,10}, {10, 7}, { 3,10}, {10, 3}, { 4,10}, {10, 4}, { 8,10}, {10, 8}, { 0,10}, {10, 0}, { 6,10}, {10, 6},	// 行6
+	{ 5,10}, {10, 5}, { 1,10}, {10, 1}, { 2,10}, {10, 2}, { 7, 9}, { 9, 7}, { 3, 9}, { 9, 3}, { 4, 9}, { 9, 4},	// 行7
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static void matrix_clear_table(MatrixStep *pst_Table);		/* 走査テーブルを全消灯にする	*/
+static void matrix_compile(MatrixStep *pst_Table);			/* 画素を走査テーブルに変換する	*/
+static void matrix_set_line(MatrixStep *pst_Step, uint8_t u8_Line, bool bl_High);	/* ラインを出力にする	*/
+static uint32_t matrix_unit(void);							/* 表示時間の単位を求める		*/
+static uint8_t matrix_clock_callback(uint8_t u8_Event, uint8_t u8_Mode);	/* クロック変更コールバック	*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  GPT0オーバーフロー割り込みハンドラ(LEDマトリクス走査)
+  * @param  None
+  * @retval None
+  * @note   カウンタは0から数え直しているため、GTPRの変更は今回の表示時間になる
+  */
+void GPT0_OVF_Handler(void)
+{
+	uint32_t u32_StartCycle = LL_DWT_GetCycle();
+	uint8_t u8_Step = u8s_MatrixStepNo;
+	const MatrixStep *pst_Step;
+
+	/* 割り込み要求フラグ クリア */
+	R_ICU->IELSR_b[IRQ_GPT0_OVF].IR = 0;
+
+	/* フレームの先頭: 前のフレームを計測し、入れ替え待ちの面を表示する */
+	if (u8_Step == 0) {
+		if (bls_MatrixFrameValid) {
+			u32s_MatrixFramePeriod = u32_StartCycle - u32s_MatrixFrameStart;
+			sts_MatrixStatistics.u32_frame_cycles = u32s_MatrixBusyCycle;
+			if (u32s_MatrixBusyCycle > sts_MatrixStatistics.u32_frame_cycles_max) {
+				sts_MatrixStatistics.u32_frame_cycles_max = u32s_MatrixBusyCycle;
+			}
+			sts_MatrixStatistics.u32_frames++;
+		}
+		u32s_MatrixFrameStart = u32_StartCycle;
+		u32s_MatrixBusyCycle = 0;
+		bls_MatrixFrameValid = true;
+
+		if (bls_MatrixPending) {
+			u8s_MatrixFront ^= 1;
+			bls_MatrixPending = false;
+			sts_MatrixStatistics.u32_swaps++;
+		}
+	}
+
+	/* ライン端子だけを書き換え、ポートの他の端子は保持する */
+	pst_Step = &sts_MatrixStep[u8s_MatrixFront][u8_Step];
+	R_PORT0->PCNTR1 = (R_PORT0->PCNTR1 & ~MATRIX_PORT0_MASK) | pst_Step->u32_port0;
+	R_PORT2->PCNTR1 = (R_PORT2->PCNTR1 & ~MATRIX_PORT2_MASK) | pst_Step->u32_port2;
+	R_GPT0->GTPR = (u32s_MatrixUnit << (u8_Step % MATRIX_PLANES)) - 1;
+
+	u8_Step++;
+	u8s_MatrixStepNo = (u8_Step < MATRIX_STEPS) ? u8_Step : 0;
+
+	u32s_MatrixBusyCycle += LL_DWT_GetCycle() - u32_StartCycle;
+}
+
+/**
+  * @brief  LEDマトリクスドライバー初期化処理
+  * @param  None
+  * @retval None
+  */
+void taskMatrixDriverInit(void)
+{
+	uint32_t u32_Mask;
+	uint8_t _i;
+
+	bls_MatrixRunning = false;
+	bls_MatrixPending = false;
+	u8s_MatrixFront = 0;
+	u8s_MatrixStepNo = 0;
+	u32s_MatrixUnit = 1;
+	u32s_MatrixFramePeriod = 0;
+	for (_i=0; _i<MATRIX_LED_NUM; _i++) {
+		u8s_MatrixPixel[_i] = 0;
+	}
+	matrix_clear_table(&sts_MatrixStep[0][0]);
+	matrix_clear_table(&sts_MatrixStep[1][0]);
+	sts_MatrixStatistics.u32_frames = 0;
+	sts_MatrixStatistics.u32_swaps = 0;
+	sts_MatrixStatistics.u32_busy = 0;
+	sts_MatrixStatistics.u32_frame_cycles = 0;
+	sts_MatrixStatistics.u32_frame_cycles_max = 0;
+
+	/* ---- ベクターテーブル登録 ---- */
+	u32_Mask = LL_IRQ_Lock(IRQ_PRIO_GPT0);
+	NVIC_SetVector((IRQn_Type)IRQ_GPT0_OVF, (uintptr_t)GPT0_OVF_Handler);
+	LL_IRQ_Unlock(u32_Mask);
+
+	/* ---- クロック変更の通知先を登録する ---- */
+	if (clockRegisterCallback(matrix_clock_callback) != OK) {
+		Error_Handler();
+	}
+}
+
+/**
+  * @brief  表示を開始する
+  * @param  None
+  * @retval OK/NG(表示中)
+  * @note   表示は全消灯から始める。描画用の画素は消去しない
+  */
+uint8_t matrixOpen(void)
+{
+	uint32_t u32_Mask;
+	uint8_t _i;
+
+	if (bls_MatrixRunning) {
+		return NG;
+	}
+
+	/* ---- モジュールストップ解除 ---- */
+	R_MSTP->MSTPCRD_b.MSTPD5 = 0;					// GPT320～GPT323 ON
+
+	/* ---- ライン端子: 汎用入出力(Hi-Z) ---- */
+	u32_Mask = LL_IRQ_Lock(GPIO_PDR_CEILING);
+	R_PORT0->PCNTR1 &= ~MATRIX_PORT0_MASK;
+	R_PORT2->PCNTR1 &= ~MATRIX_PORT2_MASK;
+	LL_IRQ_Unlock(u32_Mask);
+	R_BSP_PinAccessEnable();
+	for (_i=0; _i<MATRIX_LINES; _i++) {
+		R_PFS->PORT[csts_MatrixLinePin[_i].u8_port].PIN[csts_MatrixLinePin[_i].u8_pin].PmnPFS = 0x00000000;
+	}
+	R_BSP_PinAccessDisable();
+
+	/* ---- 走査状態 ---- */
+	matrix_clear_table(&sts_MatrixStep[0][0]);
+	matrix_clear_table(&sts_MatrixStep[1][0]);
+	u8s_MatrixFront = 0;
+	u8s_MatrixStepNo = 0;
+	bls_MatrixPending = false;
+	bls_MatrixFrameValid = false;
+	u32s_MatrixUnit = matrix_unit();
+
+	/* ---- GPT 設定 ---- */
+	R_GPT0->GTCR = 0x00000000;						// 停止, のこぎり波, PCLKD/1
+	R_GPT0->GTUDDTYC = 0x00000001;					// アップカウント
+	R_GPT0->GTPR = u32s_MatrixUnit - 1;
+	R_GPT0->GTCNT = 0;
+
+	/* ---- ICU → NVIC 割り込み割り当て (GPT0_OVF) ---- */
+	R_ICU->IELSR_b[IRQ_GPT0_OVF].IR = 0;			// 割り込み要求フラグ クリア
+	R_ICU->IELSR_b[IRQ_GPT0_OVF].IELS = ELC_EVENT_GPT0_COUNTER_OVERFLOW;
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_GPT0_OVF);
+	NVIC_SetPriority((IRQn_Type)IRQ_GPT0_OVF, IRQ_PRIO_GPT0);
+	NVIC_EnableIRQ((IRQn_Type)IRQ_GPT0_OVF);
+
+	/* ---- カウント開始 ---- */
+	bls_MatrixRunning = true;
+	R_GPT0->GTCR_b.CST = 1;
+	return OK;
+}
+
+/**
+  * @brief  表示を停止する
+  * @param  None
+  * @retval None
+  * @note   ライン端子は全てHi-Zに戻す
+  */
+void matrixClose(void)
+{
+	uint32_t u32_Mask;
+
+	if (!bls_MatrixRunning) {
+		return;
+	}
+	NVIC_DisableIRQ((IRQn_Type)IRQ_GPT0_OVF);
+	R_ICU->IELSR[IRQ_GPT0_OVF] = 0x00000000;
+	R_GPT0->GTCR_b.CST = 0;
+
+	u32_Mask = LL_IRQ_Lock(GPIO_PDR_CEILING);
+	R_PORT0->PCNTR1 &= ~MATRIX_PORT0_MASK;
+	R_PORT2->PCNTR1 &= ~MATRIX_PORT2_MASK;
+	LL_IRQ_Unlock(u32_Mask);
+	bls_MatrixRunning = false;
+}
+
+/**
+  * @brief  描画用のフレームバッファを取得する
+  * @param  None
+  * @retval 画素(MATRIX_ROWS×MATRIX_COLS, 行0の左端から行毎, 輝度0～255)
+  * @note   表示には使わないため、matrixSwap()までいつ書き換えてもよい
+  */
+uint8_t *matrixGetBuffer(void)
+{
+	return u8s_MatrixPixel;
+}
+
+/**
+  * @brief  描画した内容を次のフレームから表示する
+  * @param  None
+  * @retval OK/NG(前回の入れ替えを待っている)
+  * @note   輝度はMATRIX_LEVELS段階に丸める
+  */
+uint8_t matrixSwap(void)
+{
+	uint32_t u32_Mask;
+
+	/* 入れ替え待ちの間は割り込みが裏面を表示面にする可能性がある */
+	if (bls_MatrixPending) {
+		sts_MatrixStatistics.u32_busy++;
+		return NG;
+	}
+	matrix_compile(&sts_MatrixStep[u8s_MatrixFront ^ 1][0]);
+
+	/* シーリング以下の優先度の割り込みを保留(BASEPRI) */
+	u32_Mask = LL_IRQ_Lock(IRQ_PRIO_GPT0);
+	bls_MatrixPending = true;
+	/* BASEPRIを元に戻す */
+	LL_IRQ_Unlock(u32_Mask);
+
+	/* 表示していなければすぐに入れ替える */
+	if (!bls_MatrixRunning) {
+		u8s_MatrixFront ^= 1;
+		bls_MatrixPending = false;
+		sts_MatrixStatistics.u32_swaps++;
+	}
+	return OK;
+}
+
+/**
+  * @brief  LEDマトリクス統計情報を取得する
+  * @param  pst_Stat: 統計情報の格納先
+  * @retval None
+  * @note   フレーム周期とCPU負荷は直前のフレームの値
+  */
+void matrixGetStatistics(MatrixStatistics *pst_Stat)
+{
+	uint32_t u32_Mask;
+	uint32_t u32_Period;
+	uint32_t u32_Cycles;
+
+	/* シーリング以下の優先度の割り込みを保留(BASEPRI) */
+	u32_Mask = LL_IRQ_Lock(IRQ_PRIO_GPT0);
+	*pst_Stat = sts_MatrixStatistics;
+	u32_Period = u32s_MatrixFramePeriod;
+	/* BASEPRIを元に戻す */
+	LL_IRQ_Unlock(u32_Mask);
+
+	u32_Cycles = pst_Stat->u32_frame_cycles;
+	pst_Stat->u32_frame_us = (uint32_t)(((uint64_t)u32_Period * 1000000) / SystemCoreClock);
+	pst_Stat->u16_cpu_load = (u32_Period > 0) ? (uint16_t)(((uint64_t)u32_Cycles * 1000) / u32_Period) : 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  走査テーブルを全消灯(全ラインHi-Z)にする
+  * @param  pst_Table: 走査テーブル(MATRIX_STEPS)
+  * @retval None
+  */
+static void matrix_clear_table(MatrixStep *pst_Table)
+{
+	uint8_t _i;
+
+	for (_i=0; _i<MATRIX_STEPS; _i++) {
+		pst_Table[_i].u32_port0 = 0;
+		pst_Table[_i].u32_port2 = 0;
+	}
+}
+
+/**
+  * @brief  画素を走査テーブルに変換する
+  * @param  pst_Table: 走査テーブル(MATRIX_STEPS)
+  * @retval None
+  * @note   ステップはライン毎にビットプレーン0～3を並べる。点灯するLEDの
+  *         あるステップだけアノードをHigh、カソードをLowにする
+  */
+static void matrix_compile(MatrixStep *pst_Table)
+{
+	uint8_t u8_Level;
+	uint8_t u8_Plane;
+	MatrixStep *pst_Step;
+	uint8_t _i;
+
+	matrix_clear_table(pst_Table);
+	for (_i=0; _i<MATRIX_LED_NUM; _i++) {
+		/* 0～255をMATRIX_LEVELS段階(0～15)に丸める */
+		u8_Level = (uint8_t)(((uint16_t)u8s_MatrixPixel[_i] * (MATRIX_LEVELS - 1) + 127) / 255);
+		for (u8_Plane=0; u8_Plane<MATRIX_PLANES; u8_Plane++) {
+			if (u8_Level & (1 << u8_Plane)) {
+				pst_Step = &pst_Table[(cu8s_MatrixLed[_i][0] * MATRIX_PLANES) + u8_Plane];
+				matrix_set_line(pst_Step, cu8s_MatrixLed[_i][0], true);
+				matrix_set_line(pst_Step, cu8s_MatrixLed[_i][1], false);
+			}
+		}
+	}
+}
+
+/**
+  * @brief  ラインを出力にする
+  * @param  pst_Step: 走査ステップ
+  * @param  u8_Line: ライン番号
+  * @param  bl_High: true:High(アノード), false:Low(カソード)
+  * @retval None
+  */
+static void matrix_set_line(MatrixStep *pst_Step, uint8_t u8_Line, bool bl_High)
+{
+	const MatrixLinePin *pst_Pin = &csts_MatrixLinePin[u8_Line];
+	uint32_t u32_Value = (1UL << pst_Pin->u8_pin);	// PDR
+
+	if (bl_High) {
+		u32_Value |= (1UL << (pst_Pin->u8_pin + 16));	// PODR
+	}
+	if (pst_Pin->u8_port == 0) {
+		pst_Step->u32_port0 |= u32_Value;
+	}
+	else {
+		pst_Step->u32_port2 |= u32_Value;
+	}
+}
+
+/**
+  * @brief  表示時間の単位を求める
+  * @param  None
+  * @retval 表示時間の単位[GPTカウント](ビットプレーン0の表示時間)
+  */
+static uint32_t matrix_unit(void)
+{
+	uint32_t u32_Unit = R_FSP_SystemClockHzGet(FSP_PRIV_CLOCK_PCLKD) / (MATRIX_FRAME_HZ * MATRIX_FRAME_UNITS);
+
+	return (u32_Unit > 0) ? u32_Unit : 1;
+}
+
+/**
+  * @brief  クロック変更コールバック
+  * @param  u8_Event: CLOCK_EVENT_xxx
+  * @param  u8_Mode: 切り替え先の動作モード
+  * @retval OK
+  * @note   表示中はPCLKDから表示時間の単位を求め直す(次のステップから反映)。
+  *         フレーム周期はサイクル数で計測しているため、次のフレームから計測し直す
+  */
+static uint8_t matrix_clock_callback(uint8_t u8_Event, uint8_t u8_Mode)
+{
+	uint32_t u32_Mask;
+
+	(void)u8_Mode;
+	if ((u8_Event == CLOCK_EVENT_POST) && bls_MatrixRunning) {
+		/* シーリング以下の優先度の割り込みを保留(BASEPRI) */
+		u32_Mask = LL_IRQ_Lock(IRQ_PRIO_GPT0);
+		u32s_MatrixUnit = matrix_unit();
+		bls_MatrixFrameValid = false;
+		/* BASEPRIを元に戻す */
+		LL_IRQ_Unlock(u32_Mask);
+	}
+	return OK;
+}
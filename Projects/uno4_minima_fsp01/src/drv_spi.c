@@ -0,0 +1,669 @@
+/**
+  ******************************************************************************
+  * @file           : drv_spi.c
+  * @brief          : SPIドライバー(RSPI0 マスター)
+  ******************************************************************************
+  * @note   RSPI0(RSPCKA:P111/D13, MOSIA:P109/D11, MISOA:P110/D12)をクロック同期
+  *         (3線)のマスターとして動作させ、チップセレクトはデバイス毎のGPIOで
+  *         選択する。転送要求はQueueに登録し、割り込みで順番に実行する。
+  *         呼び出し元は転送の完了を待たず、完了コールバックは周期処理
+  *         (taskSpiDriverInput)から呼ばれる。
+  *         - フレーム長は8/16/32bitとし、SPDRのアクセス幅(SPDCR.SPBYT/SPLW)を
+  *           フレーム長に合わせてDTCで1フレームずつ転送する。
+  *         - 送受信はTXI起動のDTCで送信、RXI起動のDTCで受信し、最後の受信
+  *           (RXIのCPU割り込み)で完了する。受信バッファがフルの間はRSPCKを
+  *           止める(SPCR2.SCKASE)ため、DTCが遅れてもオーバーランしない。
+  *         - 送信のみ(表示器への転送等)は送信専用モード(SPCR.TXMD)で受信を
+  *           行わず、最後の送信後の送信完了(TEI)で完了する。
+  *         - 転送時間から求めた周期数で転送のタイムアウトを監視する。
+  *         転送速度はデバイスの上限以下で、転送の開始毎にPCLKAから求める。
+  *         クロック変更は転送中または未開始の要求がある間は拒否する。
+  *         D13(P111)はSCK LEDと共用のため、RSPI0の端子は転送の登録時に周辺機能へ
+  *         切り替え、転送が無くなった(チップセレクトの保持も無い)周期処理で
+  *         汎用入出力に戻す。転送中以外のP111はSCK LEDとして動作する。
+  *         UNO R4 WiFiではP109/P110がSCI9(ESP32-S3リンク)の端子のため、
+  *         本ドライバーはMinimaでだけ呼び出すこと(WiFiボードでは使用しない)。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "drv.h"
+#include "lib.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* 転送要求Queueの要素 */
+typedef struct _SpiSlot {
+	SpiTransfer st_xfer;			/* 転送要求								*/
+	uint8_t u8_result;				/* 結果(SPI_RESULT_xxx)					*/
+	volatile bool bl_done;			/* 転送終了(完了通知待ち)				*/
+	uint32_t u32_time_us;			/* 転送時間[us]							*/
+} SpiSlot;
+
+/* Private define ------------------------------------------------------------*/
+#define SPI_SPBR_MAX		(256)					/* SPBR+1の上限					*/
+#define SPI_BRDV_MAX		(3)						/* SPCMD0.BRDV最大(1/8)			*/
+#define SPI_TIMEOUT_MARGIN	(2)						/* タイムアウトの余裕[周期]		*/
+#define SPI_CEILING			(IRQ_PRIO_SPI0)			/* 転送Queue/状態のシーリング(SPI0_RXI/TXI/TEI/ERI)	*/
+
+/* 転送の段階 */
+#define SPI_PHASE_IDLE		(0)						/* 停止中						*/
+#define SPI_PHASE_XFER		(1)						/* 転送中(DTC)					*/
+#define SPI_PHASE_TX_END	(2)						/* 送信完了待ち(送信のみ)		*/
+
+/* SPCR */
+#define SPI_SPCR_SPRIE		(0x80)					/* 受信バッファフル割り込み許可	*/
+#define SPI_SPCR_SPE		(0x40)					/* SPI機能許可					*/
+#define SPI_SPCR_SPTIE		(0x20)					/* 送信バッファエンプティ割り込み許可	*/
+#define SPI_SPCR_SPEIE		(0x10)					/* エラー割り込み許可			*/
+#define SPI_SPCR_MSTR		(0x08)					/* マスターモード				*/
+#define SPI_SPCR_TXMD		(0x02)					/* 送信専用モード				*/
+#define SPI_SPCR_SPMS		(0x01)					/* クロック同期(SSL端子を使わない)	*/
+/* SPPCR */
+#define SPI_SPPCR_SPLP2		(0x02)					/* ループバック(非反転)			*/
+/* SPSR */
+#define SPI_SPSR_SPRF		(0x80)					/* 受信バッファフル				*/
+#define SPI_SPSR_SPTEF		(0x20)					/* 送信バッファエンプティ		*/
+#define SPI_SPSR_UDRF		(0x10)					/* アンダーラン					*/
+#define SPI_SPSR_PERF		(0x08)					/* パリティエラー				*/
+#define SPI_SPSR_MODF		(0x04)					/* モードフォルト				*/
+#define SPI_SPSR_IDLNF		(0x02)					/* 転送中(0:アイドル)			*/
+#define SPI_SPSR_OVRF		(0x01)					/* オーバーラン					*/
+#define SPI_SPSR_ERRORS		(SPI_SPSR_UDRF | SPI_SPSR_PERF | SPI_SPSR_MODF | SPI_SPSR_OVRF)
+/* SPDCR */
+#define SPI_SPDCR_SPBYT		(0x40)					/* SPDRをバイトアクセス			*/
+#define SPI_SPDCR_SPLW		(0x20)					/* SPDRをロングワードアクセス	*/
+/* SPCR2 */
+#define SPI_SPCR2_SCKASE	(0x10)					/* 受信バッファフルでRSPCK停止	*/
+#define SPI_SPCR2_SPIIE		(0x04)					/* アイドル割り込み(TEI)許可		*/
+/* SPCMD0 */
+#define SPI_SPCMD_LSBF		(0x1000)				/* LSBファースト				*/
+#define SPI_SPCMD_SPB_POS	(8)						/* データ長						*/
+#define SPI_SPCMD_BRDV_POS	(2)						/* ビットレート分周				*/
+#define SPI_SPCMD_CPOL		(0x0002)				/* アイドル時RSPCK High			*/
+#define SPI_SPCMD_CPHA		(0x0001)				/* 偶数エッジでサンプル			*/
+#define SPI_SPB_8			(0x7)					/* 8bit							*/
+#define SPI_SPB_16			(0xF)					/* 16bit						*/
+#define SPI_SPB_32			(0x2)					/* 32bit						*/
+/* PmnPFS */
+#define SPI_PFS_PSEL		(0b00110)				/* SPI							*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static SpiSlot sts_SpiQueue[SPI_QUEUE_SIZE];				/* 転送要求Queue				*/
+volatile static uint8_t u8s_SpiHead;						/* 次に完了通知する要素			*/
+volatile static uint8_t u8s_SpiNext;						/* 次に開始する要素				*/
+volatile static uint8_t u8s_SpiTail;						/* 次に登録する要素				*/
+volatile static uint8_t u8s_SpiCount;						/* 登録数(完了通知前を含む)		*/
+volatile static uint8_t u8s_SpiWaiting;						/* 未開始の要求数				*/
+volatile static uint8_t u8s_SpiPhase = SPI_PHASE_IDLE;		/* 転送の段階					*/
+volatile static uint8_t u8s_SpiActive;						/* 実行中の要素					*/
+static const SpiDevice *psts_SpiHeld;						/* チップセレクトを保持中のデバイス	*/
+static DtcTransferInfo sts_SpiDtcTx;						/* 送信のDTC転送情報			*/
+static DtcTransferInfo sts_SpiDtcRx;						/* 受信のDTC転送情報			*/
+static const uint32_t u32s_SpiDummy = SPI_DUMMY_DATA;		/* 受信のみの転送の送信データ	*/
+static uint32_t u32s_SpiStartUs;							/* 転送開始時刻[us]				*/
+volatile static uint32_t u32s_SpiSequence;					/* 開始した転送の通し番号		*/
+static uint32_t u32s_SpiWatchSequence;						/* 監視中の転送の通し番号		*/
+static uint16_t u16s_SpiWatchCycles;						/* 監視中の転送の経過周期数		*/
+static uint16_t u16s_SpiWatchLimit;							/* 実行中の転送のタイムアウト[周期]	*/
+static SpiStatistics sts_SpiStatistics;						/* SPI統計情報					*/
+static bool bls_SpiPinAttached;								/* 端子を周辺機能に割り当て中	*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void spi_start_next(void);							/* 次の転送を開始する			*/
+static uint16_t spi_set_bitrate(uint32_t u32_Bitrate);		/* 転送速度を設定する			*/
+static bool spi_is_idle(void);								/* 最後のフレームまで送信したかを判定する	*/
+static void spi_finish(uint8_t u8_Result);					/* 転送を終了する				*/
+static uint8_t spi_clock_callback(uint8_t u8_Event, uint8_t u8_Mode);	/* クロック変更コールバック	*/
+static void spi_attach_pins(bool bl_Attach);				/* 端子を周辺機能/汎用入出力に切り替える	*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  SPI0受信バッファフル割り込みハンドラ
+  * @param  None
+  * @retval None
+  * @note   受信はDTCで行い、最後のフレームの受信後にCPU割り込みになる
+  */
+void SPI0_RXI_Handler(void)
+{
+	uint32_t u32_Start = LL_DWT_GetCycle();
+
+	/* 割り込み要求フラグ クリア */
+	R_ICU->IELSR_b[IRQ_SPI0_RXI].IR = 0;
+	sts_SpiStatistics.u32_irqs++;
+
+	if ((u8s_SpiPhase == SPI_PHASE_XFER) && (sts_SpiDtcRx.u16_cra == 0)) {
+		spi_finish(SPI_RESULT_OK);
+		spi_start_next();
+	}
+	sts_SpiStatistics.u32_cpu_cycles += LL_DWT_GetCycle() - u32_Start;
+}
+
+/**
+  * @brief  SPI0送信バッファエンプティ割り込みハンドラ
+  * @param  None
+  * @retval None
+  * @note   送信はDTCで行い、最後のフレームを書き込んだ後にCPU割り込みになる
+  */
+void SPI0_TXI_Handler(void)
+{
+	uint32_t u32_Start = LL_DWT_GetCycle();
+
+	/* 割り込み要求フラグ クリア */
+	R_ICU->IELSR_b[IRQ_SPI0_TXI].IR = 0;
+	sts_SpiStatistics.u32_irqs++;
+
+	if ((u8s_SpiPhase == SPI_PHASE_XFER) && (sts_SpiDtcTx.u16_cra == 0)) {
+		/* 全フレームを書き込んだ: 以降のTXIを止める */
+		R_SPI0->SPCR &= (uint8_t)~SPI_SPCR_SPTIE;
+		if (sts_SpiQueue[u8s_SpiActive].st_xfer.pv_rx == NULL) {
+			/* 送信のみ: 最後のフレームの送信完了(アイドル)をTEIで待つ */
+			u8s_SpiPhase = SPI_PHASE_TX_END;
+			R_SPI0->SPCR2 |= SPI_SPCR2_SPIIE;
+		}
+	}
+	sts_SpiStatistics.u32_cpu_cycles += LL_DWT_GetCycle() - u32_Start;
+}
+
+/**
+  * @brief  SPI0送信完了割り込みハンドラ
+  * @param  None
+  * @retval None
+  */
+void SPI0_TEI_Handler(void)
+{
+	uint32_t u32_Start = LL_DWT_GetCycle();
+
+	/* 割り込み要求フラグ クリア */
+	R_ICU->IELSR_b[IRQ_SPI0_TEI].IR = 0;
+	sts_SpiStatistics.u32_irqs++;
+
+	if ((u8s_SpiPhase == SPI_PHASE_TX_END) && spi_is_idle()) {
+		spi_finish(SPI_RESULT_OK);
+		spi_start_next();
+	}
+	sts_SpiStatistics.u32_cpu_cycles += LL_DWT_GetCycle() - u32_Start;
+}
+
+/**
+  * @brief  SPI0エラー割り込みハンドラ
+  * @param  None
+  * @retval None
+  * @note   オーバーラン,モードフォルト,アンダーラン,パリティエラー
+  */
+void SPI0_ERI_Handler(void)
+{
+	uint32_t u32_Start = LL_DWT_GetCycle();
+	uint8_t u8_Error;
+
+	/* 割り込み要求フラグ クリア */
+	R_ICU->IELSR_b[IRQ_SPI0_ERI].IR = 0;
+	sts_SpiStatistics.u32_irqs++;
+
+	u8_Error = R_SPI0->SPSR & SPI_SPSR_ERRORS;
+	R_SPI0->SPSR &= (uint8_t)~u8_Error;
+	if ((u8_Error != 0) && (u8s_SpiPhase != SPI_PHASE_IDLE)) {
+		spi_finish(SPI_RESULT_ERROR);
+		spi_start_next();
+	}
+	sts_SpiStatistics.u32_cpu_cycles += LL_DWT_GetCycle() - u32_Start;
+}
+
+/**
+  * @brief  SPIドライバー初期化処理
+  * @param  None
+  * @retval None
+  */
+void taskSpiDriverInit(void)
+{
+	uint32_t u32_Mask;
+
+	mem_set08((uint8_t *)&sts_SpiQueue[0], 0x00, sizeof(sts_SpiQueue));
+	mem_set08((uint8_t *)&sts_SpiStatistics, 0x00, sizeof(sts_SpiStatistics));
+	u8s_SpiHead = 0;
+	u8s_SpiNext = 0;
+	u8s_SpiTail = 0;
+	u8s_SpiCount = 0;
+	u8s_SpiWaiting = 0;
+	u8s_SpiPhase = SPI_PHASE_IDLE;
+	psts_SpiHeld = NULL;
+	bls_SpiPinAttached = false;
+
+	/* ---- ベクターテーブル登録 ---- */
+	u32_Mask = LL_IRQ_Lock(SPI_CEILING);
+	NVIC_SetVector((IRQn_Type)IRQ_SPI0_RXI, (uintptr_t)SPI0_RXI_Handler);
+	NVIC_SetVector((IRQn_Type)IRQ_SPI0_TXI, (uintptr_t)SPI0_TXI_Handler);
+	NVIC_SetVector((IRQn_Type)IRQ_SPI0_TEI, (uintptr_t)SPI0_TEI_Handler);
+	NVIC_SetVector((IRQn_Type)IRQ_SPI0_ERI, (uintptr_t)SPI0_ERI_Handler);
+	LL_IRQ_Unlock(u32_Mask);
+
+	/* ---- SPI0_RXI/TXI/TEI/ERI 無効 ---- */
+	R_ICU->IELSR[IRQ_SPI0_RXI] = 0x00000000;
+	R_ICU->IELSR[IRQ_SPI0_TXI] = 0x00000000;
+	R_ICU->IELSR[IRQ_SPI0_TEI] = 0x00000000;
+	R_ICU->IELSR[IRQ_SPI0_ERI] = 0x00000000;
+
+	/* ---- SPI0 モジュールストップ解除 ---- */
+	R_MSTP->MSTPCRB_b.MSTPB19 = 0;					// SPI0 ON
+
+	/* ---- ポート設定(PMRは転送の登録時に設定する) ---- */
+	// 書き込みプロテクト解除
+	R_BSP_PinAccessEnable();
+	// P111 = RSPCKA(SCK LEDと共用), P109 = MOSIA, P110 = MISOA
+	R_PFS->PORT[1].PIN[11].PmnPFS_b.DSCR = 1;		// 中駆動(RSPCK/MOSIは高速)
+	R_PFS->PORT[1].PIN[9].PmnPFS_b.DSCR = 1;
+	R_PFS->PORT[1].PIN[11].PmnPFS_b.PSEL = SPI_PFS_PSEL;	// RSPCKA
+	R_PFS->PORT[1].PIN[9].PmnPFS_b.PSEL = SPI_PFS_PSEL;		// MOSIA
+	R_PFS->PORT[1].PIN[10].PmnPFS_b.PSEL = SPI_PFS_PSEL;	// MISOA
+	// 書き込みプロテクト施錠
+	R_BSP_PinAccessDisable();
+
+	/* ---- SPI0 設定(停止中) ---- */
+	R_SPI0->SPCR = 0x00;
+	R_SPI0->SSLP = 0x00;
+	R_SPI0->SPPCR = 0x00;
+	R_SPI0->SPSCR = 0x00;							// SPCMD0のみ使用
+	R_SPI0->SPCKD = 0x00;
+	R_SPI0->SSLND = 0x00;
+	R_SPI0->SPND = 0x00;
+	R_SPI0->SPSR &= (uint8_t)~SPI_SPSR_ERRORS;
+
+	/* ---- DTC ---- */
+	LL_DTC_Init();
+	LL_DTC_SetVector(IRQ_SPI0_TXI, &sts_SpiDtcTx);
+	LL_DTC_SetVector(IRQ_SPI0_RXI, &sts_SpiDtcRx);
+
+	/* ---- ICU → NVIC 割り込み割り当て ---- */
+	R_ICU->IELSR_b[IRQ_SPI0_RXI].IR = 0;			// 割り込み要求フラグ クリア
+	R_ICU->IELSR_b[IRQ_SPI0_RXI].IELS = ELC_EVENT_SPI0_RXI;
+	R_ICU->IELSR_b[IRQ_SPI0_TXI].IR = 0;
+	R_ICU->IELSR_b[IRQ_SPI0_TXI].IELS = ELC_EVENT_SPI0_TXI;
+	R_ICU->IELSR_b[IRQ_SPI0_TEI].IR = 0;
+	R_ICU->IELSR_b[IRQ_SPI0_TEI].IELS = ELC_EVENT_SPI0_TEI;
+	R_ICU->IELSR_b[IRQ_SPI0_ERI].IR = 0;
+	R_ICU->IELSR_b[IRQ_SPI0_ERI].IELS = ELC_EVENT_SPI0_ERI;
+
+	/* ---- NVIC 設定 ---- */
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_SPI0_RXI);
+	NVIC_SetPriority((IRQn_Type)IRQ_SPI0_RXI, IRQ_PRIO_SPI0);
+	NVIC_EnableIRQ((IRQn_Type)IRQ_SPI0_RXI);
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_SPI0_TXI);
+	NVIC_SetPriority((IRQn_Type)IRQ_SPI0_TXI, IRQ_PRIO_SPI0);
+	NVIC_EnableIRQ((IRQn_Type)IRQ_SPI0_TXI);
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_SPI0_TEI);
+	NVIC_SetPriority((IRQn_Type)IRQ_SPI0_TEI, IRQ_PRIO_SPI0);
+	NVIC_EnableIRQ((IRQn_Type)IRQ_SPI0_TEI);
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_SPI0_ERI);
+	NVIC_SetPriority((IRQn_Type)IRQ_SPI0_ERI, IRQ_PRIO_SPI0);
+	NVIC_EnableIRQ((IRQn_Type)IRQ_SPI0_ERI);
+
+	/* ---- クロック変更の通知先を登録する ---- */
+	if (clockRegisterCallback(spi_clock_callback) != OK) {
+		Error_Handler();
+	}
+}
+
+/**
+  * @brief  SPIドライバー入力処理
+  * @param  None
+  * @retval None
+  * @note   完了した転送のコールバックを登録順に呼び出し、転送のタイムアウトを
+  *         監視する。転送が無くなれば端子を汎用入出力に戻す
+  */
+void taskSpiDriverInput(void)
+{
+	SpiSlot *pst_Slot;
+	SpiSlot st_Done;
+	uint32_t u32_Mask;
+
+	/* ---- 転送のタイムアウト監視 ---- */
+	u32_Mask = LL_IRQ_Lock(SPI_CEILING);
+	if (u8s_SpiPhase != SPI_PHASE_IDLE) {
+		if (u32s_SpiWatchSequence != u32s_SpiSequence) {
+			u32s_SpiWatchSequence = u32s_SpiSequence;
+			u16s_SpiWatchCycles = 0;
+		}
+		else if (++u16s_SpiWatchCycles >= u16s_SpiWatchLimit) {
+			spi_finish(SPI_RESULT_TIMEOUT);
+			spi_start_next();
+		}
+	}
+	LL_IRQ_Unlock(u32_Mask);
+
+	/* ---- 完了通知 ---- */
+	while ((u8s_SpiCount > 0) && sts_SpiQueue[u8s_SpiHead].bl_done) {
+		pst_Slot = &sts_SpiQueue[u8s_SpiHead];
+		st_Done = *pst_Slot;
+		u32_Mask = LL_IRQ_Lock(SPI_CEILING);
+		pst_Slot->bl_done = false;
+		u8s_SpiHead = (uint8_t)((u8s_SpiHead + 1) % SPI_QUEUE_SIZE);
+		u8s_SpiCount--;
+		LL_IRQ_Unlock(u32_Mask);
+		if (st_Done.st_xfer.pf_callback != NULL) {
+			st_Done.st_xfer.pf_callback(&st_Done.st_xfer, st_Done.u8_result, st_Done.u32_time_us);
+		}
+	}
+
+	/* ---- 端子の返却(コールバックで次の転送を登録した場合は保持する) ---- */
+	if (bls_SpiPinAttached && (u8s_SpiCount == 0) && (u8s_SpiPhase == SPI_PHASE_IDLE) && (psts_SpiHeld == NULL)) {
+		spi_attach_pins(false);
+	}
+}
+
+/**
+  * @brief  SPI転送を登録する
+  * @param  pst_Xfer: 転送要求(内容はコピーする,データ領域とデバイス設定は完了まで保持すること)
+  * @retval OK/NG(Queueが一杯,フレーム長/サイズ/アライメント不正)
+  * @note   端子の切り替え(PFS書き込み)を行うため、割り込みからは呼び出さないこと
+  */
+uint8_t spiSubmit(const SpiTransfer *pst_Xfer)
+{
+	uint32_t u32_Start = LL_DWT_GetCycle();
+	uint32_t u32_Align = (uint32_t)(pst_Xfer->u8_bits / 8) - 1;
+	uint32_t u32_Mask;
+
+	if ((pst_Xfer->pst_dev == NULL) || (pst_Xfer->u16_frames == 0)
+	 || ((pst_Xfer->u8_bits != 8) && (pst_Xfer->u8_bits != 16) && (pst_Xfer->u8_bits != 32))
+	 || ((uint32_t)(uintptr_t)pst_Xfer->pv_tx & u32_Align) || ((uint32_t)(uintptr_t)pst_Xfer->pv_rx & u32_Align)) {
+		return NG;
+	}
+	if (!bls_SpiPinAttached) {
+		spi_attach_pins(true);
+	}
+	u32_Mask = LL_IRQ_Lock(SPI_CEILING);
+	if (u8s_SpiCount >= SPI_QUEUE_SIZE) {
+		LL_IRQ_Unlock(u32_Mask);
+		return NG;
+	}
+	sts_SpiQueue[u8s_SpiTail].st_xfer = *pst_Xfer;
+	sts_SpiQueue[u8s_SpiTail].u8_result = SPI_RESULT_OK;
+	sts_SpiQueue[u8s_SpiTail].u32_time_us = 0;
+	sts_SpiQueue[u8s_SpiTail].bl_done = false;
+	u8s_SpiTail = (uint8_t)((u8s_SpiTail + 1) % SPI_QUEUE_SIZE);
+	u8s_SpiCount++;
+	u8s_SpiWaiting++;
+	if (u8s_SpiCount > sts_SpiStatistics.u8_queue_peak) {
+		sts_SpiStatistics.u8_queue_peak = u8s_SpiCount;
+	}
+	spi_start_next();
+	sts_SpiStatistics.u32_cpu_cycles += LL_DWT_GetCycle() - u32_Start;
+	LL_IRQ_Unlock(u32_Mask);
+	return OK;
+}
+
+/**
+  * @brief  転送中または未完了の要求があるかを取得する
+  * @param  None
+  * @retval true:あり
+  */
+bool spiIsBusy(void)
+{
+	return (u8s_SpiCount > 0) || (u8s_SpiPhase != SPI_PHASE_IDLE);
+}
+
+/**
+  * @brief  SPI統計情報を取得する
+  * @param  pst_Stat: 統計情報の格納先
+  * @retval None
+  */
+void spiGetStatistics(SpiStatistics *pst_Stat)
+{
+	uint32_t u32_Mask;
+
+	u32_Mask = LL_IRQ_Lock(SPI_CEILING);
+	*pst_Stat = sts_SpiStatistics;
+	LL_IRQ_Unlock(u32_Mask);
+}
+
+/**
+  * @brief  端子を汎用入出力に戻す
+  * @param  None
+  * @retval None
+  * @note   エラー停止(Error_Handler)でSCK LED(P111)を点滅させる前に呼び出す。
+  *         転送中であれば以降のフレームは端子に出ない。
+  *         周辺機能に切り替えていなければ何もしない
+  */
+void spiReleasePins(void)
+{
+	if (bls_SpiPinAttached) {
+		spi_attach_pins(false);
+	}
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  次の転送を開始する
+  * @param  None
+  * @retval None
+  * @note   SPI_CEILINGの禁止区間または割り込みから呼び出す。
+  *         SPEとSPTIEを同時に設定して最初のTXI(DTC起動)を発生させる
+  */
+static void spi_start_next(void)
+{
+	const SpiTransfer *pst_Xfer;
+	const SpiDevice *pst_Dev;
+	volatile void *pv_Data;
+	uint32_t u32_Size;
+	uint16_t u16_Command;
+	uint8_t u8_Dcr;
+	uint64_t u64_Us;
+
+	if ((u8s_SpiPhase != SPI_PHASE_IDLE) || (u8s_SpiWaiting == 0)) {
+		return;
+	}
+	u8s_SpiActive = u8s_SpiNext;
+	u8s_SpiNext = (uint8_t)((u8s_SpiNext + 1) % SPI_QUEUE_SIZE);
+	u8s_SpiWaiting--;
+	u32s_SpiSequence++;
+	pst_Xfer = &sts_SpiQueue[u8s_SpiActive].st_xfer;
+	pst_Dev = pst_Xfer->pst_dev;
+
+	/* ---- 別のデバイスのチップセレクトを保持していれば解除する ---- */
+	if ((psts_SpiHeld != NULL) && (psts_SpiHeld != pst_Dev)) {
+		gpioSet(psts_SpiHeld->u8_cs_port, psts_SpiHeld->u16_cs_mask);
+	}
+	psts_SpiHeld = NULL;
+
+	/* ---- フレーム長(SPDRのアクセス幅を合わせる) ---- */
+	switch (pst_Xfer->u8_bits) {
+	case 8:
+		u16_Command = (uint16_t)(SPI_SPB_8 << SPI_SPCMD_SPB_POS);
+		u8_Dcr = SPI_SPDCR_SPBYT;
+		u32_Size = DTC_SZ_BYTE;
+		pv_Data = &R_SPI0->SPDR_BY;
+		break;
+	case 16:
+		u16_Command = (uint16_t)(SPI_SPB_16 << SPI_SPCMD_SPB_POS);
+		u8_Dcr = 0x00;
+		u32_Size = DTC_SZ_HALF;
+		pv_Data = &R_SPI0->SPDR_HA;
+		break;
+	default:
+		u16_Command = (uint16_t)(SPI_SPB_32 << SPI_SPCMD_SPB_POS);
+		u8_Dcr = SPI_SPDCR_SPLW;
+		u32_Size = DTC_SZ_WORD;
+		pv_Data = &R_SPI0->SPDR;
+		break;
+	}
+	if (pst_Dev->u8_mode & 0x01) {
+		u16_Command |= SPI_SPCMD_CPHA;
+	}
+	if (pst_Dev->u8_mode & 0x02) {
+		u16_Command |= SPI_SPCMD_CPOL;
+	}
+	if (pst_Dev->u8_options & SPI_OPT_LSB_FIRST) {
+		u16_Command |= SPI_SPCMD_LSBF;
+	}
+
+	/* ---- RSPI0 設定(停止中に行う) ---- */
+	R_SPI0->SPCR = 0x00;
+	R_SPI0->SPPCR = (pst_Dev->u8_options & SPI_OPT_LOOPBACK) ? SPI_SPPCR_SPLP2 : 0x00;
+	R_SPI0->SPCMD0 = u16_Command | spi_set_bitrate(pst_Dev->u32_bitrate);
+	R_SPI0->SPDCR = u8_Dcr;
+	R_SPI0->SPCR2 = (pst_Xfer->pv_rx != NULL) ? SPI_SPCR2_SCKASE : 0x00;
+	R_SPI0->SPSR &= (uint8_t)~SPI_SPSR_ERRORS;
+
+	/* ---- DTC(送信: TXI起動, 受信: RXI起動) ---- */
+	sts_SpiDtcTx.u32_mode = DTC_MD_NORMAL | u32_Size | DTC_DM_FIXED | ((pst_Xfer->pv_tx != NULL) ? DTC_SM_INC : DTC_SM_FIXED);
+	sts_SpiDtcTx.pv_src = (pst_Xfer->pv_tx != NULL) ? pst_Xfer->pv_tx : &u32s_SpiDummy;
+	sts_SpiDtcTx.pv_dst = pv_Data;
+	sts_SpiDtcTx.u16_crb = 0;
+	sts_SpiDtcTx.u16_cra = pst_Xfer->u16_frames;
+	LL_DTC_EnableIT(IRQ_SPI0_TXI);
+	if (pst_Xfer->pv_rx != NULL) {
+		sts_SpiDtcRx.u32_mode = DTC_MD_NORMAL | u32_Size | DTC_SM_FIXED | DTC_DM_INC;
+		sts_SpiDtcRx.pv_src = pv_Data;
+		sts_SpiDtcRx.pv_dst = pst_Xfer->pv_rx;
+		sts_SpiDtcRx.u16_crb = 0;
+		sts_SpiDtcRx.u16_cra = pst_Xfer->u16_frames;
+		LL_DTC_EnableIT(IRQ_SPI0_RXI);
+	}
+
+	/* ---- タイムアウト(転送時間の周期数+余裕) ---- */
+	u64_Us = ((uint64_t)pst_Xfer->u16_frames * (pst_Xfer->u8_bits + 1) * 1000000ULL) / sts_SpiStatistics.u32_bitrate;
+	u16s_SpiWatchLimit = (uint16_t)((u64_Us / (SYS_CYCLE_TIME * 1000)) + SPI_TIMEOUT_MARGIN);
+
+	/* ---- チップセレクトを選択して開始する ---- */
+	gpioClear(pst_Dev->u8_cs_port, pst_Dev->u16_cs_mask);
+	u32s_SpiStartUs = extiGetTimeUs();
+	u8s_SpiPhase = SPI_PHASE_XFER;
+	R_SPI0->SPCR = SPI_SPCR_SPMS | SPI_SPCR_MSTR | SPI_SPCR_SPE | SPI_SPCR_SPTIE | SPI_SPCR_SPEIE
+		| ((pst_Xfer->pv_rx != NULL) ? SPI_SPCR_SPRIE : SPI_SPCR_TXMD);
+}
+
+/**
+  * @brief  転送速度を設定する
+  * @param  u32_Bitrate: 転送速度の上限[bps]
+  * @retval SPCMD0のBRDV
+  * @note   転送速度 = PCLKA / (2 × (SPBR+1) × 2^BRDV)
+  *         上限を超えない最も速い設定を選ぶ(最大はPCLKA/2)
+  */
+static uint16_t spi_set_bitrate(uint32_t u32_Bitrate)
+{
+	uint32_t u32_Pclka = R_FSP_SystemClockHzGet(FSP_PRIV_CLOCK_PCLKA);
+	uint32_t u32_Div = SPI_SPBR_MAX;
+	uint32_t u32_Unit;
+	uint8_t u8_Brdv;
+
+	if (u32_Bitrate == 0) {
+		u32_Bitrate = 1;
+	}
+	for (u8_Brdv=0; u8_Brdv<=SPI_BRDV_MAX; u8_Brdv++) {
+		u32_Unit = (2UL << u8_Brdv) * u32_Bitrate;
+		u32_Div = (u32_Pclka + u32_Unit - 1) / u32_Unit;
+		if (u32_Div <= SPI_SPBR_MAX) {
+			break;
+		}
+	}
+	if (u8_Brdv > SPI_BRDV_MAX) {
+		u8_Brdv = SPI_BRDV_MAX;
+		u32_Div = SPI_SPBR_MAX;
+	}
+	if (u32_Div == 0) {
+		u32_Div = 1;
+	}
+	R_SPI0->SPBR = (uint8_t)(u32_Div - 1);
+	sts_SpiStatistics.u32_bitrate = u32_Pclka / ((2UL << u8_Brdv) * u32_Div);
+	return (uint16_t)(u8_Brdv << SPI_SPCMD_BRDV_POS);
+}
+
+/**
+  * @brief  最後のフレームまで送信したかを判定する
+  * @param  None
+  * @retval true:送信バッファが空でアイドル
+  */
+static bool spi_is_idle(void)
+{
+	return (R_SPI0->SPSR & (SPI_SPSR_SPTEF | SPI_SPSR_IDLNF)) == SPI_SPSR_SPTEF;
+}
+
+/**
+  * @brief  転送を終了する
+  * @param  u8_Result: 結果(SPI_RESULT_xxx)
+  * @retval None
+  * @note   SPI_CEILINGの禁止区間または割り込みから呼び出す
+  */
+static void spi_finish(uint8_t u8_Result)
+{
+	SpiSlot *pst_Slot = &sts_SpiQueue[u8s_SpiActive];
+	const SpiTransfer *pst_Xfer = &pst_Slot->st_xfer;
+	uint32_t u32_Time = extiGetTimeUs() - u32s_SpiStartUs;
+
+	LL_DTC_DisableIT(IRQ_SPI0_TXI);
+	LL_DTC_DisableIT(IRQ_SPI0_RXI);
+	R_SPI0->SPCR = 0x00;							// 停止(送受信バッファも初期化される)
+	R_SPI0->SPCR2 = 0x00;
+	sts_SpiStatistics.u32_dtc_frames += (uint32_t)(pst_Xfer->u16_frames - sts_SpiDtcTx.u16_cra);
+
+	/* ---- チップセレクト(正常終了で保持の指定があれば次の転送まで保持する) ---- */
+	if ((u8_Result == SPI_RESULT_OK) && pst_Xfer->bl_keep_cs) {
+		psts_SpiHeld = pst_Xfer->pst_dev;
+	}
+	else {
+		gpioSet(pst_Xfer->pst_dev->u8_cs_port, pst_Xfer->pst_dev->u16_cs_mask);
+	}
+
+	pst_Slot->u8_result = u8_Result;
+	pst_Slot->u32_time_us = u32_Time;
+	pst_Slot->bl_done = true;
+	u8s_SpiPhase = SPI_PHASE_IDLE;
+
+	sts_SpiStatistics.u32_last_us = u32_Time;
+	if (u32_Time > sts_SpiStatistics.u32_max_us) {
+		sts_SpiStatistics.u32_max_us = u32_Time;
+	}
+	switch (u8_Result) {
+	case SPI_RESULT_OK:
+		sts_SpiStatistics.u32_transfers++;
+		sts_SpiStatistics.u32_bytes += (uint32_t)pst_Xfer->u16_frames * (pst_Xfer->u8_bits / 8);
+		break;
+	case SPI_RESULT_TIMEOUT:
+		sts_SpiStatistics.u32_timeouts++;
+		break;
+	default:
+		sts_SpiStatistics.u32_errors++;
+		break;
+	}
+}
+
+/**
+  * @brief  クロック変更コールバック
+  * @param  u8_Event: CLOCK_EVENT_xxx
+  * @param  u8_Mode: 切り替え先の動作モード
+  * @retval OK/NG(転送中または未開始の要求がある)
+  * @note   転送速度は転送の開始毎に求めるため、切り替え後の処理は無い
+  */
+static uint8_t spi_clock_callback(uint8_t u8_Event, uint8_t u8_Mode)
+{
+	(void)u8_Mode;
+	if (u8_Event == CLOCK_EVENT_PRE) {
+		return ((u8s_SpiPhase == SPI_PHASE_IDLE) && (u8s_SpiWaiting == 0)) ? OK : NG;
+	}
+	return OK;
+}
+
+/**
+  * @brief  端子を周辺機能/汎用入出力に切り替える
+  * @param  bl_Attach: true:RSPI0(RSPCKA/MOSIA/MISOA), false:汎用入出力
+  * @retval None
+  * @note   PSELは初期化時に設定済みのため、PMRだけを切り替える。
+  *         汎用入出力に戻したP111はPODR/PDRに従う(SCK LED)
+  */
+static void spi_attach_pins(bool bl_Attach)
+{
+	uint32_t u32_Pmr = bl_Attach ? 1 : 0;
+
+	// 書き込みプロテクト解除
+	R_BSP_PinAccessEnable();
+	R_PFS->PORT[1].PIN[11].PmnPFS_b.PMR = u32_Pmr;	// RSPCKA
+	R_PFS->PORT[1].PIN[9].PmnPFS_b.PMR = u32_Pmr;	// MOSIA
+	R_PFS->PORT[1].PIN[10].PmnPFS_b.PMR = u32_Pmr;	// MISOA
+	// 書き込みプロテクト施錠
+	R_BSP_PinAccessDisable();
+	bls_SpiPinAttached = bl_Attach;
+}
@@ -0,0 +1,244 @@
+/**
+  ******************************************************************************
+  * @file           : drv_stack.c
+  * @brief          : スタック監視ドライバー
+  ******************************************************************************
+  * @note   周期処理(スレッド)はメインスタック(PSP)、割り込みは割り込みスタック
+  *         (MSP,リンカースクリプトの__StackLimit～__StackTop)を使用し、
+  *         コンテキスト毎の使用量を分けて計測する。
+  *         - 起動時に未使用領域を STACK_PAINT_PATTERN で塗りつぶし、周期毎に
+  *           STACK_SCAN_WORDS ずつ下端から走査して最大使用量を更新する。
+  *         - スタックポインタモニター(SPMON)で両スタックの範囲を監視する。
+  *           下端の STACK_GUARD_SIZE はNMIの処理に使うため監視範囲から除く。
+  *           範囲外を検出するとNMIで診断情報をno-init RAMに記録してリセットする。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "drv.h"
+#include "lib.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* スタック領域 */
+typedef struct _StackRegion {
+	uint32_t *pu32_base;			/* 下端									*/
+	uint32_t u32_words;				/* サイズ[word]							*/
+	uint32_t u32_mark;				/* 使用済みの下端(塗りつぶし以外)[word]	*/
+	uint32_t u32_scan;				/* 次の走査位置[word]					*/
+} StackRegion;
+
+/* スタックオーバーフロー記録(no-init RAM) */
+typedef struct _StackRecord {
+	uint32_t u32_magic;				/* 記録の有効判定						*/
+	uint32_t u32_magic_inv;			/* 記録の有効判定(反転値)				*/
+	StackOverflowInfo st_info;		/* 診断情報								*/
+} StackRecord;
+
+/* Private define ------------------------------------------------------------*/
+#define STACK_PAINT_PATTERN	(0xCDCDCDCDUL)			/* 塗りつぶしパターン		*/
+#define STACK_PAINT_MARGIN	(32)					/* 塗りつぶさない領域(MSP)[word]	*/
+#define STACK_SCAN_WORDS	(16)					/* 1周期の走査数[word]		*/
+#define STACK_GUARD_SIZE	(256)					/* NMI処理用の領域[byte]	*/
+#define STACK_RECORD_MAGIC	(0x53544B52UL)			/* 記録の有効判定値("STKR")	*/
+#define STACK_SPMON_OAD_NMI	(0xA500)				/* 検出時NMI(キー:A5h)		*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+extern const uint32_t __StackLimit[];
+extern const uint32_t __StackTop[];
+
+static uint32_t u32s_StackMain[STACK_MAIN_SIZE / 4] BSP_ALIGN_VARIABLE(8);	/* メインスタック(PSP)	*/
+static StackRegion sts_StackRegion[STACK_CTX_NUM];			/* スタック領域					*/
+static StackRecord sts_StackRecord BSP_PLACE_IN_SECTION(BSP_SECTION_NOINIT);	/* スタックオーバーフロー記録	*/
+static StackOverflowInfo sts_StackOverflow;					/* 起動時に確定した診断情報		*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void stack_paint(StackRegion *pst_Region, uint32_t *pu32_Base, uint32_t *pu32_Top, uint32_t *pu32_PaintEnd);	/* スタックを塗りつぶす	*/
+static void stack_scan(StackRegion *pst_Region);			/* 最大使用量を更新する			*/
+static void stack_overflow_callback(bsp_grp_irq_t e_Irq);	/* スタックオーバーフロー(NMI)	*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  スタック監視ドライバー初期化処理
+  * @param  None
+  * @retval None
+  * @note   起動直後(MSPで実行中)に呼び出し、続けてstackStartMain()を呼び出す
+  */
+void taskStackDriverInit(void)
+{
+	uint32_t *pu32_MspLimit = (uint32_t *)(uintptr_t)__StackLimit;
+	uint32_t *pu32_MspTop = (uint32_t *)(uintptr_t)__StackTop;
+	uint32_t *pu32_PspTop = &u32s_StackMain[STACK_MAIN_SIZE / 4];
+
+	/* ---- 前回のスタックオーバーフロー記録を取り出す ---- */
+	mem_set08((uint8_t *)&sts_StackOverflow, 0, sizeof(StackOverflowInfo));
+	if ((sts_StackRecord.u32_magic == STACK_RECORD_MAGIC) && (sts_StackRecord.u32_magic_inv == (uint32_t)~STACK_RECORD_MAGIC)) {
+		sts_StackOverflow = sts_StackRecord.st_info;
+	}
+	sts_StackRecord.u32_magic = 0;
+
+	/* ---- 未使用領域を塗りつぶす(MSPは実行中の位置より下だけ) ---- */
+	stack_paint(&sts_StackRegion[STACK_CTX_ISR], pu32_MspLimit, pu32_MspTop, (uint32_t *)(uintptr_t)__get_MSP() - STACK_PAINT_MARGIN);
+	stack_paint(&sts_StackRegion[STACK_CTX_MAIN], &u32s_StackMain[0], pu32_PspTop, pu32_PspTop);
+
+	/* ---- スタックポインタモニターを設定する ---- */
+	__set_PSP((uint32_t)(uintptr_t)pu32_PspTop);
+	(void)R_BSP_GroupIrqWrite(BSP_GRP_IRQ_MPU_STACK, stack_overflow_callback);
+	// MSP(割り込みスタック)
+	R_MPU_SPMON->SP[0].CTL = 0;
+	R_MPU_SPMON->SP[0].OAD = STACK_SPMON_OAD_NMI;
+	R_MPU_SPMON->SP[0].SA = (uint32_t)(uintptr_t)pu32_MspLimit + STACK_GUARD_SIZE;
+	R_MPU_SPMON->SP[0].EA = (uint32_t)(uintptr_t)pu32_MspTop;
+	// PSP(メインスタック)
+	R_MPU_SPMON->SP[1].CTL = 0;
+	R_MPU_SPMON->SP[1].OAD = STACK_SPMON_OAD_NMI;
+	R_MPU_SPMON->SP[1].SA = (uint32_t)(uintptr_t)&u32s_StackMain[0] + STACK_GUARD_SIZE;
+	R_MPU_SPMON->SP[1].EA = (uint32_t)(uintptr_t)pu32_PspTop;
+	// NMI許可(NMIERは1回だけ書き込める)
+	R_ICU->NMIER = R_ICU_NMIER_SPEEN_Msk;
+	R_MPU_SPMON->SP[0].CTL = R_MPU_SPMON_SP_CTL_ENABLE_Msk;
+	R_MPU_SPMON->SP[1].CTL = R_MPU_SPMON_SP_CTL_ENABLE_Msk;
+}
+
+/**
+  * @brief  メインスタック(PSP)に切り替えて実行する
+  * @param  pf_Main: 実行する関数(戻らないこと)
+  * @retval None
+  * @note   呼び出し元のローカル変数はこれ以降使用できない
+  */
+void stackStartMain(void (*pf_Main)(void))
+{
+	__set_CONTROL(__get_CONTROL() | CONTROL_SPSEL_Msk);
+	__ISB();
+	pf_Main();
+	while (true) {
+	}
+}
+
+/**
+  * @brief  スタック監視ドライバー出力処理
+  * @param  None
+  * @retval None
+  * @note   両スタックを STACK_SCAN_WORDS ずつ走査する
+  */
+void taskStackDriverOutput(void)
+{
+	uint8_t _i;
+
+	for (_i=0; _i<STACK_CTX_NUM; _i++) {
+		stack_scan(&sts_StackRegion[_i]);
+	}
+}
+
+/**
+  * @brief  スタック使用量を取得する
+  * @param  u8_Ctx: コンテキスト(STACK_CTX_xxx)
+  * @param  pst_Usage: 使用量の格納先
+  * @retval OK/NG
+  */
+uint8_t stackGetUsage(uint8_t u8_Ctx, StackUsage *pst_Usage)
+{
+	const StackRegion *pst_Region;
+
+	if (u8_Ctx >= STACK_CTX_NUM) {
+		return NG;
+	}
+	pst_Region = &sts_StackRegion[u8_Ctx];
+	pst_Usage->u32_size = pst_Region->u32_words * 4;
+	pst_Usage->u32_peak = (pst_Region->u32_words - pst_Region->u32_mark) * 4;
+	return OK;
+}
+
+/**
+  * @brief  前回のリセット前のスタックオーバーフロー診断情報を取得する
+  * @param  pst_Info: 診断情報の格納先
+  * @retval true:記録あり
+  */
+bool stackGetOverflowInfo(StackOverflowInfo *pst_Info)
+{
+	*pst_Info = sts_StackOverflow;
+	return (sts_StackOverflow.u8_monitor != 0);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  スタックを塗りつぶす
+  * @param  pst_Region: スタック領域
+  * @param  pu32_Base: 下端
+  * @param  pu32_Top: 上端
+  * @param  pu32_PaintEnd: 塗りつぶしの上端(これより上は使用済みとする)
+  * @retval None
+  */
+static void stack_paint(StackRegion *pst_Region, uint32_t *pu32_Base, uint32_t *pu32_Top, uint32_t *pu32_PaintEnd)
+{
+	uint32_t *pu32_Ptr;
+
+	if ((pu32_PaintEnd < pu32_Base) || (pu32_PaintEnd > pu32_Top)) {
+		pu32_PaintEnd = pu32_Base;
+	}
+	for (pu32_Ptr=pu32_Base; pu32_Ptr<pu32_PaintEnd; pu32_Ptr++) {
+		*(volatile uint32_t *)pu32_Ptr = STACK_PAINT_PATTERN;
+	}
+	pst_Region->pu32_base = pu32_Base;
+	pst_Region->u32_words = (uint32_t)(pu32_Top - pu32_Base);
+	pst_Region->u32_mark = (uint32_t)(pu32_PaintEnd - pu32_Base);
+	pst_Region->u32_scan = 0;
+}
+
+/**
+  * @brief  最大使用量を更新する
+  * @param  pst_Region: スタック領域
+  * @retval None
+  * @note   下端から使用済みの下端まで走査し、塗りつぶしと異なるワードが
+  *         あれば使用済みの下端を更新して下端から走査し直す
+  */
+static void stack_scan(StackRegion *pst_Region)
+{
+	const volatile uint32_t *pu32_Base = pst_Region->pu32_base;
+	uint8_t _i;
+
+	for (_i=0; _i<STACK_SCAN_WORDS; _i++) {
+		if (pst_Region->u32_scan >= pst_Region->u32_mark) {
+			pst_Region->u32_scan = 0;
+			break;
+		}
+		if (pu32_Base[pst_Region->u32_scan] != STACK_PAINT_PATTERN) {
+			pst_Region->u32_mark = pst_Region->u32_scan;
+			pst_Region->u32_scan = 0;
+			break;
+		}
+		pst_Region->u32_scan++;
+	}
+}
+
+/**
+  * @brief  スタックオーバーフロー(NMI)
+  * @param  e_Irq: NMI要因
+  * @retval None
+  * @note   NMIはMSPの監視範囲の下(STACK_GUARD_SIZE)で実行される
+  */
+static void stack_overflow_callback(bsp_grp_irq_t e_Irq)
+{
+	StackOverflowInfo *pst_Info = &sts_StackRecord.st_info;
+
+	(void)e_Irq;
+	pst_Info->u8_monitor = 0;
+	if (R_MPU_SPMON->SP[0].CTL & R_MPU_SPMON_SP_CTL_ERROR_Msk) {
+		pst_Info->u8_monitor |= (1U << STACK_CTX_ISR);
+	}
+	if (R_MPU_SPMON->SP[1].CTL & R_MPU_SPMON_SP_CTL_ERROR_Msk) {
+		pst_Info->u8_monitor |= (1U << STACK_CTX_MAIN);
+	}
+	pst_Info->u32_msp = __get_MSP();
+	pst_Info->u32_psp = __get_PSP();
+	sts_StackRecord.u32_magic = STACK_RECORD_MAGIC;
+	sts_StackRecord.u32_magic_inv = (uint32_t)~STACK_RECORD_MAGIC;
+	/* リセット要因を記録してリセットする */
+	wdtStackOverflowReset();
+}
+
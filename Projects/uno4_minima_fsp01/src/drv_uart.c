@@ -3,6 +3,20 @@
   * @file           : drv_uart.c
   * @brief          : UARTドライバー
   ******************************************************************************
+  * @note   通常は受信データ毎の割り込みで受信Queueに登録する。
+  *         パケット受信モード(uartPacketStart)では、受信データをDTCで
+  *         パケットバッファへ直接転送し、1パケットに1回だけCPUで処理する。
+  *         - SCI1_RXIをELC経由でGPT5の開始/クリア要因とし、受信データ毎に
+  *           カウントをやり直す。指定文字時間の無受信でGPT5がオーバーフローし、
+  *           パケットの終端とする。
+  *         - パケットバッファは2面を交互に使用する。コールバックに渡した
+  *           バッファは次のパケットが完了するまで有効。
+  *         - バッファが一杯になった場合はその時点でパケットを区切る。
+  *         クロック変更時はボーレートとアイドル検出の周期を設定し直す。
+  *         送信中とパケット受信中はクロック変更を拒否する。
+  *         送信データは1回の登録(uartSetTxData, uartEchoXxx)毎に1回の割り込み
+  *         禁止で送信Queueへまとめて書き込む。
+  ******************************************************************************
   */
 
 /* Includes ------------------------------------------------------------------*/
@@ -15,6 +29,14 @@
 /* Private define ------------------------------------------------------------*/
 #define TX_QUEUE_SIZE		(128)			/* UART送信Queueサイズ			*/
 #define RX_QUEUE_SIZE		(128)			/* UART受信Queueサイズ			*/
+#define UART_BAUDRATE		(9600)			/* ボーレート[bps]				*/
+#define UART_CHAR_BITS		(10)			/* 1文字のビット数(start+8bit+stop)	*/
+#define UART_GPT_PERIOD_MAX	(0x10000)		/* GPT(16bit)周期の上限			*/
+#define UART_GPT_TPCS_MAX	(5)				/* GPTプリスケーラ最大(1/1024)	*/
+#define UART_GPT_SSELCA		(0x00010000UL)	/* GTSSR/GTCSR: ELC_GPTAイベント	*/
+#define UART_BRR_MAX		(256)			/* BRR+1の上限					*/
+#define UART_CKS_MAX		(3)				/* SMR.CKS最大(PCLKA/64)		*/
+#define UART_CEILING		(IRQ_PRIO_SCI1)	/* 送受信Queue/統計のシーリング(SCI1_RXI/TXI/ERI, GPT5_OVF)	*/
 
 /* Private macro -------------------------------------------------------------*/
 
@@ -23,12 +45,29 @@ volatile static uint8_t u8s_UartTxBuffer[TX_QUEUE_SIZE];	/* UART送信Queueデ
 volatile static uint8_t u8s_UartRxBuffer[RX_QUEUE_SIZE];	/* UART受信Queueデータ			*/
 volatile static QueueControl sts_UartTxQueue;				/* UART送信Queue情報			*/
 volatile static QueueControl sts_UartRxQueue;				/* UART受信Queue情報			*/
+static uint8_t u8s_UartPacketBuffer[2][UART_PACKET_SIZE];	/* パケットバッファ(2面)		*/
+static DtcTransferInfo sts_UartDtcInfo;						/* パケット受信のDTC転送情報	*/
+static uint8_t u8s_UartPacketActive;						/* DTC転送中の面				*/
+volatile static bool bls_UartPacketMode = false;			/* パケット受信モード			*/
+static uint8_t u8s_UartIdleChars;							/* 終端とする無受信の文字数		*/
+static UartPacketCallback pfs_UartPacketCallback = NULL;	/* パケット受信コールバック		*/
+static UartPacketStatistics sts_UartPacketStatistics;		/* パケット受信統計情報			*/
+
+/* 16進数の表示文字 */
+static const char cs_UartHexTable[16] = {
+	'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
 
 /* Private function prototypes -----------------------------------------------*/
-static uint8_t setUartTxQueue(const uint8_t u8_Data);		/* UART送信Queueに登録する				*/
 static uint8_t getUartTxQueue(uint8_t *pu8_Data);			/* UART送信Queueから取得する			*/
 static uint8_t setUartRxQueue(const uint8_t u8_Data);		/* UART受信Queueに登録する				*/
 static uint8_t getUartRxQueue(uint8_t *pu8_Data);			/* UART受信Queueから取得する			*/
+static void uartPacketArm(uint8_t u8_Half);					/* パケットバッファへの転送を設定する	*/
+static void uartPacketComplete(void);						/* パケットを確定して次の面へ切り替える	*/
+static void uartSetupIdleTimer(uint8_t u8_IdleChars);		/* アイドル検出の周期を設定する			*/
+static void uartSetBaudrate(void);							/* ボーレートを設定する					*/
+static uint8_t uartClockCallback(uint8_t u8_Event, uint8_t u8_Mode);	/* クロック変更コールバック	*/
+static char *uartFormatHex(char *pc_Dst, uint32_t u32_Value, uint8_t u8_Digits);	/* 16進数の表示文字を作成する	*/
 
 /* Exported functions --------------------------------------------------------*/
 
@@ -39,11 +78,34 @@ static uint8_t getUartRxQueue(uint8_t *pu8_Data);			/* UART受信Queueから取
   */
 void SCI1_RXI_Handler(void)
 {
+	uint8_t u8_Data;
+
 	/* 割り込み要求フラグ クリア */
 	R_ICU->IELSR_b[IRQ_SCI1_RXI].IR = 0;
 
-	/* UART受信Queueに登録する */
-	setUartRxQueue(R_SCI1->RDR);
+	if (!bls_UartPacketMode) {
+		/* UART受信Queueに登録する */
+		setUartRxQueue(R_SCI1->RDR);
+		return;
+	}
+
+	/* ---- パケット受信モード ---- */
+	sts_UartPacketStatistics.u32_rx_irqs++;
+	/* DTC起動を禁止していた間に受信したデータはCPUで格納する */
+	if (R_SCI1->SSR_b.RDRF) {
+		u8_Data = R_SCI1->RDR;
+		if (sts_UartDtcInfo.u16_cra > 0) {
+			*(volatile uint8_t *)sts_UartDtcInfo.pv_dst = u8_Data;
+			sts_UartDtcInfo.pv_dst = (volatile uint8_t *)sts_UartDtcInfo.pv_dst + 1;
+			sts_UartDtcInfo.u16_cra--;
+		}
+	}
+	/* バッファが一杯(DTCは転送回数に達するとDTCEを解除してCPU割り込みにする) */
+	if (sts_UartDtcInfo.u16_cra == 0) {
+		LL_DTC_DisableIT(IRQ_SCI1_RXI);
+		sts_UartPacketStatistics.u32_splits++;
+		uartPacketComplete();
+	}
 }
 
 /**
@@ -78,6 +140,32 @@ void SCI1_ERI_Handler(void)
 	Error_Handler();
 }
 
+/**
+  * @brief  SCI1受信アイドル検出割り込みハンドラ(GPT5オーバーフロー)
+  * @param  None
+  * @retval None
+  * @note   最後の受信から指定文字時間が経過した時に発生する
+  */
+void GPT5_OVF_Handler(void)
+{
+	/* 割り込み要求フラグ クリア */
+	R_ICU->IELSR_b[IRQ_GPT5_OVF].IR = 0;
+
+	/* 次の受信(ELC)まで停止する */
+	R_GPT5->GTCR_b.CST = 0;
+	R_GPT5->GTCNT = 0;
+	sts_UartPacketStatistics.u32_idle_irqs++;
+
+	/* 確定中に受信したデータはSCI1_RXI_HandlerでCPUが格納する */
+	LL_DTC_DisableIT(IRQ_SCI1_RXI);
+	if (sts_UartDtcInfo.u16_cra == UART_PACKET_SIZE) {
+		/* 一杯で区切った直後等、受信データ無し */
+		LL_DTC_EnableIT(IRQ_SCI1_RXI);
+		return;
+	}
+	uartPacketComplete();
+}
+
 /**
   * @brief  UARTドライバー初期化処理
   * @param  None
@@ -85,17 +173,20 @@ void SCI1_ERI_Handler(void)
   */
 void taskUartDriverInit(void)
 {
+	uint32_t u32_Mask;
+
 	mem_set08((uint8_t *)&u8s_UartTxBuffer[0], 0x00, TX_QUEUE_SIZE);
 	mem_set08((uint8_t *)&u8s_UartRxBuffer[0], 0x00, RX_QUEUE_SIZE);
 	mem_set08((uint8_t *)&sts_UartTxQueue, 0x00, sizeof(sts_UartTxQueue));
 	mem_set08((uint8_t *)&sts_UartRxQueue, 0x00, sizeof(sts_UartRxQueue));
 
 	/* ---- ベクターテーブル登録 ---- */
-	__disable_irq();
-	NVIC_SetVector((IRQn_Type)IRQ_SCI1_RXI, (uint32_t)SCI1_RXI_Handler);
-	NVIC_SetVector((IRQn_Type)IRQ_SCI1_TXI, (uint32_t)SCI1_TXI_Handler);
-	NVIC_SetVector((IRQn_Type)IRQ_SCI1_ERI, (uint32_t)SCI1_ERI_Handler);
-	__enable_irq();
+	u32_Mask = LL_IRQ_Lock(UART_CEILING);
+	NVIC_SetVector((IRQn_Type)IRQ_SCI1_RXI, (uintptr_t)SCI1_RXI_Handler);
+	NVIC_SetVector((IRQn_Type)IRQ_SCI1_TXI, (uintptr_t)SCI1_TXI_Handler);
+	NVIC_SetVector((IRQn_Type)IRQ_SCI1_ERI, (uintptr_t)SCI1_ERI_Handler);
+	NVIC_SetVector((IRQn_Type)IRQ_GPT5_OVF, (uintptr_t)GPT5_OVF_Handler);
+	LL_IRQ_Unlock(u32_Mask);
 
 	/* ---- SCI1_RXI 無効 ---- */
 	R_ICU->IELSR[IRQ_SCI1_RXI] = 0x00000000;
@@ -103,6 +194,8 @@ void taskUartDriverInit(void)
 	R_ICU->IELSR[IRQ_SCI1_TXI] = 0x00000000;
 	/* ---- SCI1_ERI 無効 ---- */
 	R_ICU->IELSR[IRQ_SCI1_ERI] = 0x00000000;
+	/* ---- GPT5_OVF(アイドル検出) 無効 ---- */
+	R_ICU->IELSR[IRQ_GPT5_OVF] = 0x00000000;
 
 	/* ---- SCI1 モジュールストップ解除 ---- */
 	R_MSTP->MSTPCRB_b.MSTPB30 = 0;					// SCI1 ON
@@ -115,12 +208,7 @@ void taskUartDriverInit(void)
 	R_SCI1->SCMR = 0xF2;							// 通常モード
 
 	/* ---- ボーレート設定 ---- */
-	// PCLKA = 48MHz
-	// BBR = 48MHz / (64 * 2^(-1) * 9600bps) - 1 = 155.25
-	// 前提条件1 [SMR.CKS=00b (n=0)]
-	// 前提条件2 [SEMR.ABCS=0b, SEMR.ABCSE=0b, SEMR.BGDM=0b]
-	// 9600bps → BRR = 155
-	R_SCI1->BRR = 155;
+	uartSetBaudrate();
 
 	/* ---- ポート設定 ---- */
 	// 書き込みプロテクト解除
@@ -148,16 +236,21 @@ void taskUartDriverInit(void)
 
 	/* ---- NVIC 設定 (SCI1_RXI) ---- */
 	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_SCI1_RXI);
-	NVIC_SetPriority((IRQn_Type)IRQ_SCI1_RXI, 11);	// 優先度 11
+	NVIC_SetPriority((IRQn_Type)IRQ_SCI1_RXI, IRQ_PRIO_SCI1);
 	NVIC_EnableIRQ((IRQn_Type)IRQ_SCI1_RXI);
 	/* ---- NVIC 設定 (SCI1_TXI) ---- */
 	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_SCI1_TXI);
-	NVIC_SetPriority((IRQn_Type)IRQ_SCI1_TXI, 11);	// 優先度 11
+	NVIC_SetPriority((IRQn_Type)IRQ_SCI1_TXI, IRQ_PRIO_SCI1);
 	NVIC_EnableIRQ((IRQn_Type)IRQ_SCI1_TXI);
 	/* ---- NVIC 設定 (SCI1_ERI) ---- */
 	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_SCI1_ERI);
-	NVIC_SetPriority((IRQn_Type)IRQ_SCI1_ERI, 11);	// 優先度 11
+	NVIC_SetPriority((IRQn_Type)IRQ_SCI1_ERI, IRQ_PRIO_SCI1);
 	NVIC_EnableIRQ((IRQn_Type)IRQ_SCI1_ERI);
+
+	/* ---- クロック変更の通知先を登録する ---- */
+	if (clockRegisterCallback(uartClockCallback) != OK) {
+		Error_Handler();
+	}
 }
 
 /**
@@ -192,20 +285,35 @@ void taskUartDriverOutput(void)
   * @param  pu8_Data: データのポインタ
   * @param  u16_Size: データのサイズ
   * @retval 登録した数
+  * @note   空きに収まる分を1回の割り込み禁止でまとめて登録する。
+  *         割り込みから呼び出す場合は優先度がIRQ_PRIO_SCI1以下のISRに限る
   */
 uint16_t uartSetTxData(const uint8_t *pu8_Data, uint16_t u16_Size)
 {
-	uint16_t RetValue = 0;
+	uint16_t u16_Head;
+	uint16_t u16_First;
+	uint32_t u32_Mask;
 
-	while (u16_Size > 0) {
-		/* UART送信Queueに登録する */
-		if (setUartTxQueue(pu8_Data[RetValue]) != OK) {
-			break;
-		}
-		RetValue++;
-		u16_Size--;
+	/* シーリング以下の優先度の割り込みを保留(BASEPRI) */
+	u32_Mask = LL_IRQ_Lock(UART_CEILING);
+	/* 上限を超えるQueueデータの登録は破棄する */
+	if (u16_Size > (TX_QUEUE_SIZE - sts_UartTxQueue.u16_count)) {
+		u16_Size = TX_QUEUE_SIZE - sts_UartTxQueue.u16_count;
 	}
-	return RetValue;
+	/* 末尾で折り返す場合は2回に分けて書き込む */
+	u16_Head = sts_UartTxQueue.u16_head;
+	u16_First = TX_QUEUE_SIZE - u16_Head;
+	if (u16_First > u16_Size) {
+		u16_First = u16_Size;
+	}
+	mem_cpy08((uint8_t *)&u8s_UartTxBuffer[u16_Head], pu8_Data, u16_First);
+	mem_cpy08((uint8_t *)&u8s_UartTxBuffer[0], &pu8_Data[u16_First], u16_Size - u16_First);
+	sts_UartTxQueue.u16_head = (u16_Head + u16_Size) % TX_QUEUE_SIZE;
+	sts_UartTxQueue.u16_count += u16_Size;
+	/* BASEPRIを元に戻す */
+	LL_IRQ_Unlock(u32_Mask);
+
+	return u16_Size;
 }
 
 /**
@@ -240,17 +348,132 @@ uint16_t uartGetRxCount(void)
 	return sts_UartRxQueue.u16_count;
 }
 
+/**
+  * @brief  UART送信データの数を取得する
+  * @param  None
+  * @retval データの数
+  */
+uint16_t uartGetTxCount(void)
+{
+	/* UART送信Queueデータの登録数 */
+	return sts_UartTxQueue.u16_count;
+}
+
+/**
+  * @brief  UART送信Queueの空き数を取得する
+  * @param  None
+  * @retval 空き数
+  */
+uint16_t uartGetTxFree(void)
+{
+	return TX_QUEUE_SIZE - sts_UartTxQueue.u16_count;
+}
+
+/**
+  * @brief  パケット受信モードを開始する
+  * @param  pf_Callback: パケット受信コールバック(割り込みから呼ばれる)
+  * @param  u8_IdleChars: パケットの終端とする無受信の文字数(1～)
+  * @retval OK/NG(開始済み,設定値異常)
+  * @note   開始後はuartGetRxData()で受信データを取得できない
+  */
+uint8_t uartPacketStart(UartPacketCallback pf_Callback, uint8_t u8_IdleChars)
+{
+	if (bls_UartPacketMode || (pf_Callback == NULL) || (u8_IdleChars == 0)) {
+		return NG;
+	}
+	NVIC_DisableIRQ((IRQn_Type)IRQ_SCI1_RXI);
+
+	pfs_UartPacketCallback = pf_Callback;
+	u8s_UartIdleChars = u8_IdleChars;
+	mem_set08((uint8_t *)&sts_UartPacketStatistics, 0x00, sizeof(sts_UartPacketStatistics));
+
+	/* ---- DTC 設定 (SCI1_RXI → RDRをパケットバッファへ転送) ---- */
+	LL_DTC_Init();
+	uartPacketArm(0);
+	LL_DTC_SetVector(IRQ_SCI1_RXI, &sts_UartDtcInfo);
+
+	/* ---- モジュールストップ解除 ---- */
+	R_MSTP->MSTPCRD_b.MSTPD6 = 0;					// GPT162～GPT167 ON
+	R_MSTP->MSTPCRC_b.MSTPC14 = 0;					// ELC ON
+
+	/* ---- GPT 設定 (ELC_GPTAで開始/クリア) ---- */
+	R_GPT5->GTCR_b.CST = 0;
+	uartSetupIdleTimer(u8_IdleChars);
+	R_GPT5->GTSSR = UART_GPT_SSELCA;				// ELC_GPTAでカウント開始
+	R_GPT5->GTCSR = UART_GPT_SSELCA;				// ELC_GPTAでカウンタクリア
+
+	/* ---- ELC 設定 (SCI1受信データフル → GPT5開始/クリア) ---- */
+	R_ELC->ELSR[ELC_PERIPHERAL_GPT_A].HA = ELC_EVENT_SCI1_RXI;
+	R_ELC->ELCR = 0x80;								// ELC有効
+
+	/* ---- ICU → NVIC 割り込み割り当て (GPT5_OVF) ---- */
+	R_ICU->IELSR_b[IRQ_GPT5_OVF].IR = 0;			// 割り込み要求フラグ クリア
+	R_ICU->IELSR_b[IRQ_GPT5_OVF].IELS = ELC_EVENT_GPT5_COUNTER_OVERFLOW;
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_GPT5_OVF);
+	NVIC_SetPriority((IRQn_Type)IRQ_GPT5_OVF, IRQ_PRIO_SCI1);	// SCI1_RXIと同じ
+	NVIC_EnableIRQ((IRQn_Type)IRQ_GPT5_OVF);
+
+	bls_UartPacketMode = true;
+	LL_DTC_EnableIT(IRQ_SCI1_RXI);
+	NVIC_EnableIRQ((IRQn_Type)IRQ_SCI1_RXI);
+	return OK;
+}
+
+/**
+  * @brief  パケット受信モードを停止する
+  * @param  None
+  * @retval None
+  * @note   受信途中のパケットは破棄する
+  */
+void uartPacketStop(void)
+{
+	if (!bls_UartPacketMode) {
+		return;
+	}
+	NVIC_DisableIRQ((IRQn_Type)IRQ_SCI1_RXI);
+
+	/* ---- GPT/ELC 停止 ---- */
+	NVIC_DisableIRQ((IRQn_Type)IRQ_GPT5_OVF);
+	R_ICU->IELSR[IRQ_GPT5_OVF] = 0x00000000;
+	R_GPT5->GTCR_b.CST = 0;
+	R_GPT5->GTSSR = 0;
+	R_GPT5->GTCSR = 0;
+	R_ELC->ELSR[ELC_PERIPHERAL_GPT_A].HA = ELC_EVENT_NONE;
+
+	/* ---- DTC 停止 (受信Queueへ戻す) ---- */
+	LL_DTC_DisableIT(IRQ_SCI1_RXI);
+	bls_UartPacketMode = false;
+	R_ICU->IELSR_b[IRQ_SCI1_RXI].IR = 0;
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_SCI1_RXI);
+	NVIC_EnableIRQ((IRQn_Type)IRQ_SCI1_RXI);
+}
+
+/**
+  * @brief  パケット受信統計情報を取得する
+  * @param  pst_Stat: 統計情報の格納先
+  * @retval None
+  */
+void uartGetPacketStatistics(UartPacketStatistics *pst_Stat)
+{
+	uint32_t u32_Mask;
+
+	/* シーリング以下の優先度の割り込みを保留(BASEPRI) */
+	u32_Mask = LL_IRQ_Lock(UART_CEILING);
+	*pst_Stat = sts_UartPacketStatistics;
+	/* BASEPRIを元に戻す */
+	LL_IRQ_Unlock(u32_Mask);
+}
+
 /**
   * @brief  Hex1Byte表示処理
   * @param  u8_Data: データ
   * @retval None
   */
 void uartEchoHex8(uint8_t u8_Data) {
-	const uint8_t HexTable[] = {
-		'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
-	};
-	setUartTxQueue(HexTable[(u8_Data >> 4) & 0x0F]);
-	setUartTxQueue(HexTable[u8_Data & 0x0F]);
+	char c_Hex[2];
+
+	(void)uartFormatHex(&c_Hex[0], u8_Data, 2);
+	(void)uartSetTxData((const uint8_t *)&c_Hex[0], 2);
 }
 
 /**
@@ -259,8 +482,10 @@ void uartEchoHex8(uint8_t u8_Data) {
   * @retval None
   */
 void uartEchoHex16(uint16_t u16_Data) {
-	uartEchoHex8((u16_Data >> 8) & 0xFF);
-	uartEchoHex8(u16_Data & 0xFF);
+	char c_Hex[4];
+
+	(void)uartFormatHex(&c_Hex[0], u16_Data, 4);
+	(void)uartSetTxData((const uint8_t *)&c_Hex[0], 4);
 }
 
 /**
@@ -269,8 +494,10 @@ void uartEchoHex16(uint16_t u16_Data) {
   * @retval None
   */
 void uartEchoHex32(uint32_t u32_Data) {
-	uartEchoHex16((u32_Data >> 16) & 0xFFFF);
-	uartEchoHex16(u32_Data & 0xFFFF);
+	char c_Hex[8];
+
+	(void)uartFormatHex(&c_Hex[0], u32_Data, 8);
+	(void)uartSetTxData((const uint8_t *)&c_Hex[0], 8);
 }
 
 /**
@@ -279,10 +506,12 @@ void uartEchoHex32(uint32_t u32_Data) {
   * @retval None
   */
 void uartEchoStr(const char *ps8_Data) {
-	while (*ps8_Data != 0x00) {
-		setUartTxQueue(*ps8_Data);
-		ps8_Data++;
+	uint16_t u16_Size = 0;
+
+	while (ps8_Data[u16_Size] != 0x00) {
+		u16_Size++;
 	}
+	(void)uartSetTxData((const uint8_t *)ps8_Data, u16_Size);
 }
 
 /**
@@ -295,31 +524,75 @@ void uartEchoStrln(const char *ps8_Data) {
 	uartEchoStr("\r\n");
 }
 
-/* Private functions ---------------------------------------------------------*/
-
 /**
-  * @brief  UART送信Queueに登録する
-  * @param  u8_Data: データ
-  * @retval OK/NG
+  * @brief  ダンプ1行表示処理
+  * @param  pv_Addr: 先頭アドレス
+  * @param  u8_Size: データ数[byte](1～UART_DUMP_BYTES, u8_Widthの倍数)
+  * @param  u8_Width: 読み出し幅[byte](1/2/4)
+  * @retval OK/NG(送信Queueの空き不足,引数異常)
+  * @note   "AAAAAAAA: XX XX .. |ascii|"の1行を作成して送信Queueへ一度に登録する。
+  *         空きが足りない場合は読み出さずにNGを返す(次の周期で呼び出し直す)。
+  *         指定した幅で1回ずつ読み出すため、周辺レジスターにも使用できる
   */
-static uint8_t setUartTxQueue(const uint8_t u8_Data)
+uint8_t uartEchoDump(const volatile void *pv_Addr, uint8_t u8_Size, uint8_t u8_Width)
 {
-	uint8_t u8_RetCode = NG;
+	char c_Line[UART_DUMP_LINE_MAX];
+	uint8_t u8_Byte[UART_DUMP_BYTES];
+	const volatile uint8_t *pu8_Src = (const volatile uint8_t *)pv_Addr;
+	uint32_t u32_Value;
+	char *pc_Dst;
+	uint8_t _i;
+	uint8_t _j;
+
+	if (((u8_Width != 1) && (u8_Width != 2) && (u8_Width != 4))
+	 || (u8_Size == 0) || (u8_Size > UART_DUMP_BYTES) || ((u8_Size % u8_Width) != 0)) {
+		return NG;
+	}
+	/* 行の長さは幅によらず最大でUART_DUMP_LINE_MAX */
+	if (uartGetTxFree() < UART_DUMP_LINE_MAX) {
+		return NG;
+	}
 
-	/* 上限を超えるQueueデータの登録は破棄する */
-	if (sts_UartTxQueue.u16_count < TX_QUEUE_SIZE) {
-		/* Disable Interrupts */
-		__disable_irq();
-		u8s_UartTxBuffer[sts_UartTxQueue.u16_head] = u8_Data;
-		sts_UartTxQueue.u16_head = (sts_UartTxQueue.u16_head + 1) % TX_QUEUE_SIZE;
-		sts_UartTxQueue.u16_count++;
-		/* Enable Interrupts */
-		__enable_irq();
-		u8_RetCode = OK;
+	pc_Dst = uartFormatHex(&c_Line[0], (uint32_t)(uintptr_t)pv_Addr, 8);
+	*pc_Dst++ = ':';
+	*pc_Dst++ = ' ';
+	for (_i=0; _i<UART_DUMP_BYTES; _i+=u8_Width) {
+		/* 最終行の不足分は空白で埋めてASCII表示の位置を揃える */
+		if (_i >= u8_Size) {
+			for (_j=0; _j<=(u8_Width * 2); _j++) {
+				*pc_Dst++ = ' ';
+			}
+			continue;
+		}
+		if (u8_Width == 4) {
+			u32_Value = *(const volatile uint32_t *)&pu8_Src[_i];
+		}
+		else if (u8_Width == 2) {
+			u32_Value = *(const volatile uint16_t *)&pu8_Src[_i];
+		}
+		else {
+			u32_Value = pu8_Src[_i];
+		}
+		pc_Dst = uartFormatHex(pc_Dst, u32_Value, u8_Width * 2);
+		*pc_Dst++ = ' ';
+		for (_j=0; _j<u8_Width; _j++) {
+			u8_Byte[_i + _j] = (uint8_t)(u32_Value >> (_j * 8));
+		}
 	}
-	return u8_RetCode;
+	*pc_Dst++ = ' ';
+	*pc_Dst++ = '|';
+	for (_i=0; _i<u8_Size; _i++) {
+		*pc_Dst++ = ((u8_Byte[_i] >= 0x20) && (u8_Byte[_i] < 0x7F)) ? (char)u8_Byte[_i] : '.';
+	}
+	*pc_Dst++ = '|';
+	*pc_Dst++ = '\r';
+	*pc_Dst++ = '\n';
+	(void)uartSetTxData((const uint8_t *)&c_Line[0], (uint16_t)(pc_Dst - &c_Line[0]));
+	return OK;
 }
 
+/* Private functions ---------------------------------------------------------*/
+
 /**
   * @brief  UART送信Queueから取得する
   * @param  pu8_Data: データのポインタ
@@ -328,16 +601,17 @@ static uint8_t setUartTxQueue(const uint8_t u8_Data)
 static uint8_t getUartTxQueue(uint8_t *pu8_Data)
 {
 	uint8_t u8_RetCode = NG;
+	uint32_t u32_Mask;
 
 	/* 登録済のQueueデータが存在する場合 */
 	if (sts_UartTxQueue.u16_count > 0) {
-		/* Disable Interrupts */
-		__disable_irq();
+		/* シーリング以下の優先度の割り込みを保留(BASEPRI) */
+		u32_Mask = LL_IRQ_Lock(UART_CEILING);
 		*pu8_Data = u8s_UartTxBuffer[sts_UartTxQueue.u16_tail];
 		sts_UartTxQueue.u16_tail = (sts_UartTxQueue.u16_tail + 1) % TX_QUEUE_SIZE;
 		sts_UartTxQueue.u16_count--;
-		/* Enable Interrupts */
-		__enable_irq();
+		/* BASEPRIを元に戻す */
+		LL_IRQ_Unlock(u32_Mask);
 		u8_RetCode = OK;
 	}
 	return u8_RetCode;
@@ -350,8 +624,10 @@ static uint8_t getUartTxQueue(uint8_t *pu8_Data)
   */
 static uint8_t setUartRxQueue(const uint8_t u8_Data)
 {
-	/* Disable Interrupts */
-	__disable_irq();
+	uint32_t u32_Mask;
+
+	/* シーリング以下の優先度の割り込みを保留(BASEPRI) */
+	u32_Mask = LL_IRQ_Lock(UART_CEILING);
 	/* 上限を超えるQueueデータの登録は上書きする */
 	u8s_UartRxBuffer[sts_UartRxQueue.u16_head] = u8_Data;
 	sts_UartRxQueue.u16_head = (sts_UartRxQueue.u16_head + 1) % RX_QUEUE_SIZE;
@@ -361,8 +637,8 @@ static uint8_t setUartRxQueue(const uint8_t u8_Data)
 		sts_UartRxQueue.u16_count = RX_QUEUE_SIZE;
 		sts_UartRxQueue.u16_tail = (sts_UartRxQueue.u16_tail + 1) % RX_QUEUE_SIZE;
 	}
-	/* Enable Interrupts */
-	__enable_irq();
+	/* BASEPRIを元に戻す */
+	LL_IRQ_Unlock(u32_Mask);
 
 	return OK;
 }
@@ -375,17 +651,170 @@ static uint8_t setUartRxQueue(const uint8_t u8_Data)
 static uint8_t getUartRxQueue(uint8_t *pu8_Data)
 {
 	uint8_t u8_RetCode = NG;
+	uint32_t u32_Mask;
 
 	/* 登録済のQueueデータが存在する場合 */
 	if (sts_UartRxQueue.u16_count > 0) {
-		/* Disable Interrupts */
-		__disable_irq();
+		/* シーリング以下の優先度の割り込みを保留(BASEPRI) */
+		u32_Mask = LL_IRQ_Lock(UART_CEILING);
 		*pu8_Data = u8s_UartRxBuffer[sts_UartRxQueue.u16_tail];
 		sts_UartRxQueue.u16_tail = (sts_UartRxQueue.u16_tail + 1) % RX_QUEUE_SIZE;
 		sts_UartRxQueue.u16_count--;
-		/* Enable Interrupts */
-		__enable_irq();
+		/* BASEPRIを元に戻す */
+		LL_IRQ_Unlock(u32_Mask);
 		u8_RetCode = OK;
 	}
 	return u8_RetCode;
 }
+
+/**
+  * @brief  パケットバッファへの転送を設定する
+  * @param  u8_Half: 転送先の面
+  * @retval None
+  * @note   DTC起動を禁止した状態で呼び出すこと
+  */
+static void uartPacketArm(uint8_t u8_Half)
+{
+	sts_UartDtcInfo.u32_mode = DTC_MD_NORMAL | DTC_SZ_BYTE | DTC_SM_FIXED | DTC_DM_INC;
+	sts_UartDtcInfo.pv_src = &R_SCI1->RDR;
+	sts_UartDtcInfo.pv_dst = &u8s_UartPacketBuffer[u8_Half][0];
+	sts_UartDtcInfo.u16_crb = 0;
+	sts_UartDtcInfo.u16_cra = UART_PACKET_SIZE;
+	u8s_UartPacketActive = u8_Half;
+}
+
+/**
+  * @brief  パケットを確定して次の面へ切り替える
+  * @param  None
+  * @retval None
+  * @note   DTC起動を禁止した状態で割り込みから呼び出す。DTC起動を再開してから
+  *         コールバックを呼び出す
+  */
+static void uartPacketComplete(void)
+{
+	uint8_t u8_Half = u8s_UartPacketActive;
+	uint16_t u16_Size = UART_PACKET_SIZE - sts_UartDtcInfo.u16_cra;
+
+	uartPacketArm(u8_Half ^ 1);
+	LL_DTC_EnableIT(IRQ_SCI1_RXI);
+
+	sts_UartPacketStatistics.u32_packets++;
+	sts_UartPacketStatistics.u32_bytes += u16_Size;
+	if (pfs_UartPacketCallback != NULL) {
+		pfs_UartPacketCallback(&u8s_UartPacketBuffer[u8_Half][0], u16_Size, extiGetTimeUs());
+	}
+}
+
+/**
+  * @brief  アイドル検出の周期を設定する
+  * @param  u8_IdleChars: 無受信の文字数
+  * @retval None
+  */
+static void uartSetupIdleTimer(uint8_t u8_IdleChars)
+{
+	uint32_t u32_Period = (uint32_t)(((uint64_t)R_FSP_SystemClockHzGet(FSP_PRIV_CLOCK_PCLKD) * UART_CHAR_BITS * u8_IdleChars) / UART_BAUDRATE);
+	uint32_t u32_Tpcs = 0;
+
+	/* 16bitに収まるまで分周する(1/1, 1/4, 1/16, 1/64, 1/256, 1/1024) */
+	while ((u32_Period >= UART_GPT_PERIOD_MAX) && (u32_Tpcs < UART_GPT_TPCS_MAX)) {
+		u32_Period >>= 2;
+		u32_Tpcs++;
+	}
+	if (u32_Period >= UART_GPT_PERIOD_MAX) {
+		u32_Period = UART_GPT_PERIOD_MAX - 1;
+	}
+
+	R_GPT5->GTCR = (u32_Tpcs << 24);				// 停止, のこぎり波, PCLKD/(4^TPCS)
+	R_GPT5->GTUDDTYC = 0x00000001;					// アップカウント
+	R_GPT5->GTPR = u32_Period - 1;
+	R_GPT5->GTCNT = 0;
+}
+
+/**
+  * @brief  ボーレートを設定する
+  * @param  None
+  * @retval None
+  * @note   SCR.TE=0, SCR.RE=0の状態で呼び出すこと
+  *         BRR = PCLKA / (64 * 2^(2n-1) * B) - 1 (SEMR.ABCS=0, SEMR.BGDM=0)
+  *         BRRが255以下となる最小のn(SMR.CKS)を選び、BRRは四捨五入する
+  *         例: PCLKA=48MHz → n=0, BRR=155 / 12MHz → 38 / 8MHz → 25
+  */
+static void uartSetBaudrate(void)
+{
+	uint32_t u32_Pclka = R_FSP_SystemClockHzGet(FSP_PRIV_CLOCK_PCLKA);
+	uint32_t u32_Divider = 32 * UART_BAUDRATE;		// 64 * 2^(2n-1) * B (n=0)
+	uint32_t u32_Brr = (u32_Pclka + (u32_Divider / 2)) / u32_Divider;
+	uint8_t u8_Cks = 0;
+
+	while ((u32_Brr > UART_BRR_MAX) && (u8_Cks < UART_CKS_MAX)) {
+		u8_Cks++;
+		u32_Divider <<= 2;
+		u32_Brr = (u32_Pclka + (u32_Divider / 2)) / u32_Divider;
+	}
+	if (u32_Brr > UART_BRR_MAX) {
+		u32_Brr = UART_BRR_MAX;
+	}
+	if (u32_Brr == 0) {
+		u32_Brr = 1;
+	}
+
+	R_SCI1->SMR = (uint8_t)((R_SCI1->SMR & ~0x03) | u8_Cks);	// CKS: PCLKA/4^n
+	R_SCI1->SEMR = 0x00;
+	R_SCI1->BRR = (uint8_t)(u32_Brr - 1);
+}
+
+/**
+  * @brief  クロック変更コールバック
+  * @param  u8_Event: CLOCK_EVENT_xxx
+  * @param  u8_Mode: 切り替え先の動作モード
+  * @retval OK/NG(送信中,パケット受信中)
+  * @note   ボーレートの変更は送受信を停止して行うため、送信中(送信Queueにデータが
+  *         あるか送信終了前)とパケット受信中(アイドル検出のカウント中)は拒否する
+  */
+static uint8_t uartClockCallback(uint8_t u8_Event, uint8_t u8_Mode)
+{
+	uint8_t u8_Scr;
+
+	(void)u8_Mode;
+	switch (u8_Event) {
+	case CLOCK_EVENT_PRE:
+		if ((sts_UartTxQueue.u16_count > 0) || (R_SCI1->SSR_b.TEND == 0)) {
+			return NG;
+		}
+		if (bls_UartPacketMode && R_GPT5->GTCR_b.CST) {
+			return NG;
+		}
+		break;
+	case CLOCK_EVENT_POST:
+		/* 送受信を停止してボーレートを設定し直す */
+		u8_Scr = R_SCI1->SCR;
+		R_SCI1->SCR = 0x00;
+		uartSetBaudrate();
+		if (bls_UartPacketMode) {
+			uartSetupIdleTimer(u8s_UartIdleChars);
+		}
+		R_SCI1->SCR = u8_Scr;
+		break;
+	default:
+		break;
+	}
+	return OK;
+}
+
+/**
+  * @brief  16進数の表示文字を作成する
+  * @param  pc_Dst: 格納先
+  * @param  u32_Value: 値
+  * @param  u8_Digits: 桁数(1～8)
+  * @retval 格納した文字の次の位置
+  */
+static char *uartFormatHex(char *pc_Dst, uint32_t u32_Value, uint8_t u8_Digits)
+{
+	uint8_t _i;
+
+	for (_i=u8_Digits; _i>0; _i--) {
+		pc_Dst[_i - 1] = cs_UartHexTable[u32_Value & 0x0F];
+		u32_Value >>= 4;
+	}
+	return &pc_Dst[u8_Digits];
+}
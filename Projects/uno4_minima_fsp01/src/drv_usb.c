@@ -0,0 +1,983 @@
+/**
+  ******************************************************************************
+  * @file           : drv_usb.c
+  * @brief          : USBドライバー(USBFS ファンクション, CDC-ACM)
+  ******************************************************************************
+  * @note   USBFS(フルスピード 12Mbps)を仮想COMポート(CDC-ACM)として動作させる。
+  *         送受信はUARTドライバーと同じ形の関数(usbSetTxData/usbGetRxData等)で
+  *         行い、アプリケーションは呼び出す関数を替えるだけで経路を切り替えられる。
+  *         - バルクIN(EP1,PIPE1)/バルクOUT(EP2,PIPE2)はダブルバッファ(64byte×2)。
+  *           送信は片面の送信中にもう一方の面へ書き込み、受信は片面の読み出し中に
+  *           もう一方の面で次のパケットを受け付ける。
+  *         - 受信Queueに1パケット分の空きが無い場合は読み出しを保留する。
+  *           バッファが埋まるとホストへNAKを返すため、データは失われない。
+  *         - コントロール転送(EP0)は割り込みで処理する。SET_ADDRESSは
+  *           ハードウェアが処理する。
+  *         - FIFOポートはCFIFOだけを使用し、割り込みと周期処理の両方から
+  *           使用するため、周期処理側は割り込み禁止で使用する。
+  *         UCLK(48MHz)はBSPのクロック設定を使用する。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "drv.h"
+#include "lib.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define USB_RX_QUEUE_SIZE	(USB_QUEUE_SIZE)		/* USB受信Queueサイズ			*/
+#define USB_TX_QUEUE_SIZE	(USB_QUEUE_SIZE)		/* USB送信Queueサイズ			*/
+#define USB_EP0_SIZE		(64)					/* EP0最大パケットサイズ		*/
+#define USB_BULK_SIZE		(64)					/* バルク最大パケットサイズ		*/
+#define USB_NOTIFY_SIZE		(8)						/* 通知(インタラプト)最大パケットサイズ	*/
+#define USB_FIFO_WAIT		(32)					/* FIFOポート切り替え待ち回数	*/
+#define USB_VID				(0x2341)				/* ベンダーID(Arduinoコアと同じ)	*/
+#define USB_PID				(0x0069)				/* プロダクトID(UNO R4 Minima)	*/
+#define USB_CEILING			(IRQ_PRIO_USBFS)		/* 送受信Queue/FIFOのシーリング(USBFS_INT)	*/
+
+/* パイプの割り当て */
+#define USB_PIPE_DCP		(0)						/* EP0(コントロール)			*/
+#define USB_PIPE_TX			(1)						/* EP1 IN(バルク)				*/
+#define USB_PIPE_RX			(2)						/* EP2 OUT(バルク)				*/
+#define USB_PIPE_NOTIFY		(6)						/* EP3 IN(インタラプト)			*/
+#define USB_EP_TX			(0x81)
+#define USB_EP_RX			(0x02)
+#define USB_EP_NOTIFY		(0x83)
+
+/* SYSCFG */
+#define USB_SYSCFG_USBE		(0x0001)				/* USB動作許可					*/
+#define USB_SYSCFG_DPRPU	(0x0010)				/* D+プルアップ					*/
+#define USB_SYSCFG_DCFM		(0x0040)				/* ホスト機能選択				*/
+#define USB_SYSCFG_SCKE		(0x0400)				/* クロック供給					*/
+/* CFIFOSEL */
+#define USB_CURPIPE			(0x000F)				/* 選択パイプ					*/
+#define USB_ISEL			(0x0020)				/* DCPの書き込み方向			*/
+#define USB_MBW_16			(0x0400)				/* 16bitアクセス				*/
+/* CFIFOCTR */
+#define USB_DTLN			(0x01FF)				/* 受信データ長					*/
+#define USB_FRDY			(0x2000)				/* FIFOポートアクセス可			*/
+#define USB_BCLR			(0x4000)				/* バッファクリア				*/
+#define USB_BVAL			(0x8000)				/* バッファ有効(短パケット送信)	*/
+/* INTENB0/INTSTS0 */
+#define USB_CTSQ			(0x0007)				/* コントロール転送ステージ		*/
+#define USB_VALID			(0x0008)				/* セットアップ受信				*/
+#define USB_DVSQ			(0x0070)				/* デバイスステート				*/
+#define USB_BRDY			(0x0100)				/* バッファレディ				*/
+#define USB_BEMP			(0x0400)				/* バッファエンプティ			*/
+#define USB_CTRT			(0x0800)				/* コントロール転送ステージ遷移	*/
+#define USB_DVST			(0x1000)				/* デバイスステート遷移			*/
+/* INTSTS0.CTSQ */
+#define USB_CS_IDST			(0)						/* アイドル/セットアップステージ	*/
+#define USB_CS_RDDS			(1)						/* コントロールリード データステージ	*/
+#define USB_CS_RDSS			(2)						/* コントロールリード ステータスステージ	*/
+#define USB_CS_WRDS			(3)						/* コントロールライト データステージ	*/
+#define USB_CS_WRSS			(4)						/* コントロールライト ステータスステージ	*/
+#define USB_CS_WRND			(5)						/* データ無し ステータスステージ	*/
+/* INTSTS0.DVSQ */
+#define USB_DS_DFLT			(0x0010)				/* デフォルトステート(バスリセット)	*/
+#define USB_DS_CNFG			(0x0030)				/* コンフィグードステート		*/
+/* DCPCTR/PIPEnCTR */
+#define USB_PID_MASK		(0x0003)
+#define USB_PID_NAK			(0x0000)
+#define USB_PID_BUF			(0x0001)
+#define USB_PID_STALL		(0x0002)
+#define USB_CCPL			(0x0004)				/* コントロール転送完了			*/
+#define USB_SQCLR			(0x0100)				/* トグルビットクリア			*/
+#define USB_ACLRM			(0x0200)				/* バッファ自動クリア			*/
+#define USB_BSTS			(0x8000)				/* バッファアクセス可			*/
+/* PIPECFG */
+#define USB_TYPE_BULK		(0x4000)
+#define USB_TYPE_INT		(0x8000)
+#define USB_DBLB			(0x0200)				/* ダブルバッファ				*/
+#define USB_DIR_IN			(0x0010)				/* 送信方向						*/
+/* USBMC */
+#define USB_USBMC_VDCEN		(0x0080)				/* USBレギュレーター許可		*/
+
+/* 標準リクエスト */
+#define USB_REQ_GET_STATUS			(0x00)
+#define USB_REQ_CLEAR_FEATURE		(0x01)
+#define USB_REQ_SET_FEATURE			(0x03)
+#define USB_REQ_GET_DESCRIPTOR		(0x06)
+#define USB_REQ_GET_CONFIGURATION	(0x08)
+#define USB_REQ_SET_CONFIGURATION	(0x09)
+#define USB_REQ_GET_INTERFACE		(0x0A)
+#define USB_REQ_SET_INTERFACE		(0x0B)
+/* CDCクラスリクエスト */
+#define USB_REQ_SET_LINE_CODING		(0x20)
+#define USB_REQ_GET_LINE_CODING		(0x21)
+#define USB_REQ_SET_CONTROL_LINE_STATE	(0x22)
+/* bmRequestType */
+#define USB_RT_TYPE_MASK	(0x60)
+#define USB_RT_STANDARD		(0x00)
+#define USB_RT_CLASS		(0x20)
+#define USB_RT_RECIP_MASK	(0x1F)
+#define USB_RT_ENDPOINT		(0x02)
+/* ディスクリプタ */
+#define USB_DT_DEVICE		(0x01)
+#define USB_DT_CONFIG		(0x02)
+#define USB_DT_STRING		(0x03)
+#define USB_STRING_NUM		(3)						/* 文字列ディスクリプタ数		*/
+#define USB_LINE_CODING_SIZE	(7)					/* ラインコーディングのサイズ	*/
+#define USB_CTRL_BUFF_SIZE	(64)					/* コントロール転送バッファサイズ	*/
+
+/* Private macro -------------------------------------------------------------*/
+#define USB_PIPE_BIT(P)		((uint16_t)(1U << (P)))
+
+/* Private variables ---------------------------------------------------------*/
+volatile static uint8_t u8s_UsbTxBuffer[USB_TX_QUEUE_SIZE];	/* USB送信Queueデータ			*/
+volatile static uint8_t u8s_UsbRxBuffer[USB_RX_QUEUE_SIZE];	/* USB受信Queueデータ			*/
+volatile static QueueControl sts_UsbTxQueue;				/* USB送信Queue情報				*/
+volatile static QueueControl sts_UsbRxQueue;				/* USB受信Queue情報				*/
+volatile static bool bls_UsbRxPaused;						/* 受信の読み出しを保留中		*/
+volatile static uint8_t u8s_UsbConfig;						/* 選択中のコンフィグレーション	*/
+volatile static bool bls_UsbDtr;							/* ホストのポートオープン(DTR)	*/
+static UsbStatistics sts_UsbStatistics;						/* USB統計情報					*/
+
+/* コントロール転送 */
+static uint8_t u8s_UsbCtrlBuffer[USB_CTRL_BUFF_SIZE];		/* 応答/受信データ				*/
+static const uint8_t *pu8s_UsbCtrlData;						/* 送信中のデータ				*/
+static uint16_t u16s_UsbCtrlRemain;							/* 送信残りサイズ				*/
+static bool bls_UsbCtrlZlp;									/* 長さ0のパケットで終端する	*/
+static uint8_t u8s_UsbCtrlRequest;							/* データステージ中のリクエスト	*/
+static uint8_t u8s_UsbLineCoding[USB_LINE_CODING_SIZE] = {	/* ラインコーディング			*/
+	0x00, 0xC2, 0x01, 0x00,									// 115200bps
+	0x00, 0x00, 0x08										// 1stop, パリティ無し, 8bit
+};
+
+/* デバイスディスクリプタ */
+static const uint8_t u8s_UsbDeviceDesc[] = {
+	18, USB_DT_DEVICE,
+	0x00, 0x02,												// bcdUSB 2.00
+	0x02, 0x00, 0x00,										// CDC
+	USB_EP0_SIZE,
+	(uint8_t)USB_VID, (uint8_t)(USB_VID >> 8),
+	(uint8_t)USB_PID, (uint8_t)(USB_PID >> 8),
+	0x00, 0x01,												// bcdDevice 1.00
+	1, 2, 0,												// 製造者,製品,シリアル番号(無し)
+	1														// コンフィグレーション数
+};
+
+/* コンフィグレーションディスクリプタ(インターフェース,エンドポイントを含む) */
+static const uint8_t u8s_UsbConfigDesc[] = {
+	9, USB_DT_CONFIG, 67, 0, 2, 1, 0, 0x80, 50,				// 2インターフェース, バスパワー100mA
+	/* 通信クラス インターフェース */
+	9, 0x04, 0, 0, 1, 0x02, 0x02, 0x01, 0,					// CDC, ACM, AT命令
+	5, 0x24, 0x00, 0x10, 0x01,								// Header(CDC 1.10)
+	5, 0x24, 0x01, 0x00, 1,									// Call Management
+	4, 0x24, 0x02, 0x02,									// ACM(Line Coding/Control Line State)
+	5, 0x24, 0x06, 0, 1,									// Union(通信:0, データ:1)
+	7, 0x05, USB_EP_NOTIFY, 0x03, USB_NOTIFY_SIZE, 0, 16,	// 通知 インタラプトIN
+	/* データクラス インターフェース */
+	9, 0x04, 1, 0, 2, 0x0A, 0x00, 0x00, 0,
+	7, 0x05, USB_EP_RX, 0x02, USB_BULK_SIZE, 0, 0,			// バルクOUT
+	7, 0x05, USB_EP_TX, 0x02, USB_BULK_SIZE, 0, 0			// バルクIN
+};
+
+/* 文字列ディスクリプタ(0:言語ID, 1:製造者, 2:製品) */
+static const char *const ps8s_UsbString[USB_STRING_NUM] = {
+	"", "uno4_ws", "UNO R4 Minima CDC (fsp01)"
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t setUsbTxQueue(const uint8_t u8_Data);		/* USB送信Queueに登録する				*/
+static uint8_t getUsbTxQueue(uint8_t *pu8_Data);			/* USB送信Queueから取得する				*/
+static uint8_t setUsbRxQueue(const uint8_t u8_Data);		/* USB受信Queueに登録する				*/
+static uint8_t getUsbRxQueue(uint8_t *pu8_Data);			/* USB受信Queueから取得する				*/
+static bool usbFifoSelect(uint16_t u16_Sel);				/* FIFOポートを選択する					*/
+static void usbFifoWrite(uint16_t u16_Sel, const uint8_t *pu8_Data, uint16_t u16_Size, uint16_t u16_MaxPacket);	/* FIFOへ1パケット書き込む	*/
+static uint16_t usbFifoRead(uint16_t u16_Sel, uint8_t *pu8_Data, uint16_t u16_Size);	/* FIFOから1パケット読み出す	*/
+static void usbBusReset(void);								/* バスリセット処理						*/
+static void usbSetupPipes(void);							/* バルク/インタラプトパイプを設定する	*/
+static void usbSetDcpPid(uint16_t u16_Pid);					/* EP0の応答を設定する					*/
+static void usbControlStage(uint16_t u16_Stage, bool bl_Setup);	/* コントロール転送ステージ処理		*/
+static bool usbControlRead(uint8_t u8_Type, uint8_t u8_Request, uint16_t u16_Value, uint16_t u16_Index);	/* データ送信のリクエスト	*/
+static bool usbControlNoData(uint8_t u8_Type, uint8_t u8_Request, uint16_t u16_Value, uint16_t u16_Index);	/* データ無しのリクエスト	*/
+static void usbControlSend(const uint8_t *pu8_Data, uint16_t u16_Size, uint16_t u16_Length);	/* 応答データの送信を開始する	*/
+static void usbControlSendNext(void);						/* 応答データの次のパケットを送信する	*/
+static void usbTxFill(void);								/* 送信Queueからバッファへ書き込む		*/
+static void usbRxDrain(void);								/* バッファから受信Queueへ読み出す		*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  USBFS割り込みハンドラ
+  * @param  None
+  * @retval None
+  * @note   要因が残っている間は処理を繰り返す
+  */
+void USBFS_INT_Handler(void)
+{
+	uint16_t u16_Sts;
+	uint16_t u16_Pipe;
+
+	/* 割り込み要求フラグ クリア */
+	R_ICU->IELSR_b[IRQ_USBFS_INT].IR = 0;
+
+	while (true) {
+		u16_Sts = R_USB_FS0->INTSTS0;
+		if ((u16_Sts & R_USB_FS0->INTENB0 & (USB_DVST | USB_CTRT | USB_BEMP | USB_BRDY)) == 0) {
+			break;
+		}
+		/* ---- デバイスステート遷移 ---- */
+		if (u16_Sts & USB_DVST) {
+			R_USB_FS0->INTSTS0 = (uint16_t)~USB_DVST;
+			if ((u16_Sts & USB_DVSQ) == USB_DS_DFLT) {
+				usbBusReset();
+			}
+		}
+		/* ---- コントロール転送ステージ遷移 ---- */
+		if (u16_Sts & USB_CTRT) {
+			R_USB_FS0->INTSTS0 = (uint16_t)~USB_CTRT;
+			if (u16_Sts & USB_VALID) {
+				R_USB_FS0->INTSTS0 = (uint16_t)~USB_VALID;
+			}
+			usbControlStage(u16_Sts & USB_CTSQ, (u16_Sts & USB_VALID) != 0);
+		}
+		/* ---- バッファエンプティ(EP0の応答データ送信完了) ---- */
+		if (u16_Sts & USB_BEMP) {
+			u16_Pipe = R_USB_FS0->BEMPSTS & R_USB_FS0->BEMPENB;
+			R_USB_FS0->BEMPSTS = (uint16_t)~u16_Pipe;
+			if (u16_Pipe & USB_PIPE_BIT(USB_PIPE_DCP)) {
+				usbControlSendNext();
+			}
+		}
+		/* ---- バッファレディ ---- */
+		if (u16_Sts & USB_BRDY) {
+			u16_Pipe = R_USB_FS0->BRDYSTS & R_USB_FS0->BRDYENB;
+			R_USB_FS0->BRDYSTS = (uint16_t)~u16_Pipe;
+			if (u16_Pipe & USB_PIPE_BIT(USB_PIPE_DCP)) {
+				/* コントロールライトのデータ(SET_LINE_CODING) */
+				(void)usbFifoRead(USB_PIPE_DCP, &u8s_UsbCtrlBuffer[0], USB_CTRL_BUFF_SIZE);
+			}
+			if (u16_Pipe & USB_PIPE_BIT(USB_PIPE_RX)) {
+				usbRxDrain();
+			}
+			if (u16_Pipe & USB_PIPE_BIT(USB_PIPE_TX)) {
+				usbTxFill();
+			}
+		}
+	}
+}
+
+/**
+  * @brief  USBドライバー初期化処理
+  * @param  None
+  * @retval None
+  */
+void taskUsbDriverInit(void)
+{
+	uint32_t u32_Mask;
+
+	mem_set08((uint8_t *)&u8s_UsbTxBuffer[0], 0x00, USB_TX_QUEUE_SIZE);
+	mem_set08((uint8_t *)&u8s_UsbRxBuffer[0], 0x00, USB_RX_QUEUE_SIZE);
+	mem_set08((uint8_t *)&sts_UsbTxQueue, 0x00, sizeof(sts_UsbTxQueue));
+	mem_set08((uint8_t *)&sts_UsbRxQueue, 0x00, sizeof(sts_UsbRxQueue));
+	mem_set08((uint8_t *)&sts_UsbStatistics, 0x00, sizeof(sts_UsbStatistics));
+	bls_UsbRxPaused = false;
+	u8s_UsbConfig = 0;
+	bls_UsbDtr = false;
+
+	/* ---- ベクターテーブル登録 ---- */
+	u32_Mask = LL_IRQ_Lock(USB_CEILING);
+	NVIC_SetVector((IRQn_Type)IRQ_USBFS_INT, (uintptr_t)USBFS_INT_Handler);
+	LL_IRQ_Unlock(u32_Mask);
+
+	/* ---- USBFS_INT 無効 ---- */
+	R_ICU->IELSR[IRQ_USBFS_INT] = 0x00000000;
+
+	/* ---- USBFS モジュールストップ解除 ---- */
+	R_MSTP->MSTPCRB_b.MSTPB11 = 0;					// USBFS ON
+
+	/* ---- USBFS 設定 ---- */
+	// VCC=5V(UNO R4 Minima)のため、USB端子はUSBレギュレーターから給電する
+	R_USB_FS0->USBMC = USB_USBMC_VDCEN;
+	R_USB_FS0->SYSCFG = USB_SYSCFG_SCKE;				// クロック供給
+	R_USB_FS0->SYSCFG = USB_SYSCFG_SCKE | USB_SYSCFG_USBE;	// ファンクション, USB動作許可
+	R_USB_FS0->CFIFOSEL = USB_MBW_16;
+	R_USB_FS0->DCPMAXP = USB_EP0_SIZE;
+	R_USB_FS0->BRDYENB = USB_PIPE_BIT(USB_PIPE_DCP);
+	R_USB_FS0->BEMPENB = USB_PIPE_BIT(USB_PIPE_DCP);
+	R_USB_FS0->INTENB0 = USB_DVST | USB_CTRT | USB_BEMP | USB_BRDY;
+
+	/* ---- ICU → NVIC 割り込み割り当て (USBFS_INT) ---- */
+	R_ICU->IELSR_b[IRQ_USBFS_INT].IR = 0;			// 割り込み要求フラグ クリア
+	R_ICU->IELSR_b[IRQ_USBFS_INT].IELS = ELC_EVENT_USBFS_INT;
+	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_USBFS_INT);
+	NVIC_SetPriority((IRQn_Type)IRQ_USBFS_INT, IRQ_PRIO_USBFS);
+	NVIC_EnableIRQ((IRQn_Type)IRQ_USBFS_INT);
+
+	/* ---- 接続(D+プルアップ) ---- */
+	// バスパワーのため、VBUSは常に供給されているものとする
+	R_USB_FS0->SYSCFG = USB_SYSCFG_SCKE | USB_SYSCFG_USBE | USB_SYSCFG_DPRPU;
+}
+
+/**
+  * @brief  USBドライバー入力処理
+  * @param  None
+  * @retval None
+  * @note   保留していた受信を受信Queueに空きができたら再開する
+  */
+void taskUsbDriverInput(void)
+{
+	uint32_t u32_Mask;
+
+	if (bls_UsbRxPaused && ((USB_RX_QUEUE_SIZE - sts_UsbRxQueue.u16_count) >= USB_BULK_SIZE)) {
+		/* シーリング以下の優先度の割り込みを保留(BASEPRI) */
+		u32_Mask = LL_IRQ_Lock(USB_CEILING);
+		bls_UsbRxPaused = false;
+		usbRxDrain();
+		if (!bls_UsbRxPaused) {
+			R_USB_FS0->BRDYENB |= USB_PIPE_BIT(USB_PIPE_RX);
+		}
+		/* BASEPRIを元に戻す */
+		LL_IRQ_Unlock(u32_Mask);
+	}
+}
+
+/**
+  * @brief  USBドライバー出力処理
+  * @param  None
+  * @retval None
+  * @note   送信Queueのデータをバッファへ書き込む(以降はBRDY割り込みで継続する)
+  */
+void taskUsbDriverOutput(void)
+{
+	uint32_t u32_Mask;
+
+	if ((u8s_UsbConfig != 0) && (sts_UsbTxQueue.u16_count > 0)) {
+		/* シーリング以下の優先度の割り込みを保留(BASEPRI) */
+		u32_Mask = LL_IRQ_Lock(USB_CEILING);
+		usbTxFill();
+		/* BASEPRIを元に戻す */
+		LL_IRQ_Unlock(u32_Mask);
+	}
+}
+
+/**
+  * @brief  USB送信データを登録する
+  * @param  pu8_Data: データのポインタ
+  * @param  u16_Size: データのサイズ
+  * @retval 登録した数
+  */
+uint16_t usbSetTxData(const uint8_t *pu8_Data, uint16_t u16_Size)
+{
+	uint16_t RetValue = 0;
+
+	while (u16_Size > 0) {
+		/* USB送信Queueに登録する */
+		if (setUsbTxQueue(pu8_Data[RetValue]) != OK) {
+			break;
+		}
+		RetValue++;
+		u16_Size--;
+	}
+	return RetValue;
+}
+
+/**
+  * @brief  USB受信データを取得する
+  * @param  pu8_Data: データのポインタ
+  * @param  u16_Size: データのサイズ
+  * @retval 取得した数
+  */
+uint16_t usbGetRxData(uint8_t *pu8_Data, uint16_t u16_Size)
+{
+	uint16_t RetValue = 0;
+
+	while (u16_Size > 0) {
+		/* USB受信Queueから取得する */
+		if (getUsbRxQueue(&pu8_Data[RetValue]) != OK) {
+			break;
+		}
+		RetValue++;
+		u16_Size--;
+	}
+	return RetValue;
+}
+
+/**
+  * @brief  USB受信データの数を取得する
+  * @param  None
+  * @retval データの数
+  */
+uint16_t usbGetRxCount(void)
+{
+	/* USB受信Queueデータの登録数 */
+	return sts_UsbRxQueue.u16_count;
+}
+
+/**
+  * @brief  USB送信データの数を取得する
+  * @param  None
+  * @retval データの数
+  */
+uint16_t usbGetTxCount(void)
+{
+	/* USB送信Queueデータの登録数 */
+	return sts_UsbTxQueue.u16_count;
+}
+
+/**
+  * @brief  ホストがポートを開いているかを取得する
+  * @param  None
+  * @retval true:コンフィグレーション済みかつDTR=1
+  */
+bool usbIsConnected(void)
+{
+	return (u8s_UsbConfig != 0) && bls_UsbDtr;
+}
+
+/**
+  * @brief  USB統計情報を取得する
+  * @param  pst_Stat: 統計情報の格納先
+  * @retval None
+  */
+void usbGetStatistics(UsbStatistics *pst_Stat)
+{
+	uint32_t u32_Mask;
+
+	/* シーリング以下の優先度の割り込みを保留(BASEPRI) */
+	u32_Mask = LL_IRQ_Lock(USB_CEILING);
+	*pst_Stat = sts_UsbStatistics;
+	/* BASEPRIを元に戻す */
+	LL_IRQ_Unlock(u32_Mask);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  USB送信Queueに登録する
+  * @param  u8_Data: データ
+  * @retval OK/NG
+  */
+static uint8_t setUsbTxQueue(const uint8_t u8_Data)
+{
+	uint8_t u8_RetCode = NG;
+	uint32_t u32_Mask;
+
+	/* 上限を超えるQueueデータの登録は破棄する */
+	if (sts_UsbTxQueue.u16_count < USB_TX_QUEUE_SIZE) {
+		/* シーリング以下の優先度の割り込みを保留(BASEPRI) */
+		u32_Mask = LL_IRQ_Lock(USB_CEILING);
+		u8s_UsbTxBuffer[sts_UsbTxQueue.u16_head] = u8_Data;
+		sts_UsbTxQueue.u16_head = (sts_UsbTxQueue.u16_head + 1) % USB_TX_QUEUE_SIZE;
+		sts_UsbTxQueue.u16_count++;
+		/* BASEPRIを元に戻す */
+		LL_IRQ_Unlock(u32_Mask);
+		u8_RetCode = OK;
+	}
+	return u8_RetCode;
+}
+
+/**
+  * @brief  USB送信Queueから取得する
+  * @param  pu8_Data: データのポインタ
+  * @retval OK/NG
+  * @note   USB_CEILINGの禁止区間(または割り込み)から呼び出す
+  */
+static uint8_t getUsbTxQueue(uint8_t *pu8_Data)
+{
+	uint8_t u8_RetCode = NG;
+
+	/* 登録済のQueueデータが存在する場合 */
+	if (sts_UsbTxQueue.u16_count > 0) {
+		*pu8_Data = u8s_UsbTxBuffer[sts_UsbTxQueue.u16_tail];
+		sts_UsbTxQueue.u16_tail = (sts_UsbTxQueue.u16_tail + 1) % USB_TX_QUEUE_SIZE;
+		sts_UsbTxQueue.u16_count--;
+		u8_RetCode = OK;
+	}
+	return u8_RetCode;
+}
+
+/**
+  * @brief  USB受信Queueに登録する
+  * @param  u8_Data: データ
+  * @retval OK/NG
+  * @note   USB_CEILINGの禁止区間(または割り込み)から呼び出す。空きは呼び出し元で確認する
+  */
+static uint8_t setUsbRxQueue(const uint8_t u8_Data)
+{
+	uint8_t u8_RetCode = NG;
+
+	if (sts_UsbRxQueue.u16_count < USB_RX_QUEUE_SIZE) {
+		u8s_UsbRxBuffer[sts_UsbRxQueue.u16_head] = u8_Data;
+		sts_UsbRxQueue.u16_head = (sts_UsbRxQueue.u16_head + 1) % USB_RX_QUEUE_SIZE;
+		sts_UsbRxQueue.u16_count++;
+		u8_RetCode = OK;
+	}
+	return u8_RetCode;
+}
+
+/**
+  * @brief  USB受信Queueから取得する
+  * @param  pu8_Data: データのポインタ
+  * @retval OK/NG
+  */
+static uint8_t getUsbRxQueue(uint8_t *pu8_Data)
+{
+	uint8_t u8_RetCode = NG;
+	uint32_t u32_Mask;
+
+	/* 登録済のQueueデータが存在する場合 */
+	if (sts_UsbRxQueue.u16_count > 0) {
+		/* シーリング以下の優先度の割り込みを保留(BASEPRI) */
+		u32_Mask = LL_IRQ_Lock(USB_CEILING);
+		*pu8_Data = u8s_UsbRxBuffer[sts_UsbRxQueue.u16_tail];
+		sts_UsbRxQueue.u16_tail = (sts_UsbRxQueue.u16_tail + 1) % USB_RX_QUEUE_SIZE;
+		sts_UsbRxQueue.u16_count--;
+		/* BASEPRIを元に戻す */
+		LL_IRQ_Unlock(u32_Mask);
+		u8_RetCode = OK;
+	}
+	return u8_RetCode;
+}
+
+/**
+  * @brief  FIFOポートを選択する
+  * @param  u16_Sel: CFIFOSELの設定値(パイプ番号,ISEL)
+  * @retval true:アクセス可(FRDY=1)
+  */
+static bool usbFifoSelect(uint16_t u16_Sel)
+{
+	uint16_t _i;
+
+	R_USB_FS0->CFIFOSEL = u16_Sel | USB_MBW_16;
+	for (_i=0; _i<USB_FIFO_WAIT; _i++) {
+		if (((R_USB_FS0->CFIFOSEL & (USB_CURPIPE | USB_ISEL)) == u16_Sel)
+		 && (R_USB_FS0->CFIFOCTR & USB_FRDY)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+  * @brief  FIFOへ1パケット書き込む
+  * @param  u16_Sel: CFIFOSELの設定値(パイプ番号,ISEL)
+  * @param  pu8_Data: データ
+  * @param  u16_Size: サイズ(u16_MaxPacket以下)
+  * @param  u16_MaxPacket: 最大パケットサイズ
+  * @retval None
+  * @note   最大パケットサイズに満たない場合は短パケットとして送信する
+  */
+static void usbFifoWrite(uint16_t u16_Sel, const uint8_t *pu8_Data, uint16_t u16_Size, uint16_t u16_MaxPacket)
+{
+	uint16_t _i;
+
+	if (!usbFifoSelect(u16_Sel)) {
+		return;
+	}
+	for (_i=0; (_i + 1)<u16_Size; _i+=2) {
+		R_USB_FS0->CFIFO = (uint16_t)(pu8_Data[_i] | (pu8_Data[_i + 1] << 8));
+	}
+	if (u16_Size & 1) {
+		/* 奇数バイトの最後は8bitアクセスで書き込む */
+		R_USB_FS0->CFIFOSEL = u16_Sel;
+		R_USB_FS0->CFIFOL = pu8_Data[u16_Size - 1];
+	}
+	if (u16_Size < u16_MaxPacket) {
+		R_USB_FS0->CFIFOCTR = USB_BVAL;
+	}
+}
+
+/**
+  * @brief  FIFOから1パケット読み出す
+  * @param  u16_Sel: CFIFOSELの設定値(パイプ番号)
+  * @param  pu8_Data: 格納先
+  * @param  u16_Size: 格納先のサイズ
+  * @retval 読み出した数
+  * @note   格納先を超える分は捨てる。全て読み出すとバッファは受信側へ戻る
+  */
+static uint16_t usbFifoRead(uint16_t u16_Sel, uint8_t *pu8_Data, uint16_t u16_Size)
+{
+	uint16_t u16_Length;
+	uint16_t u16_Word;
+	uint16_t _i;
+
+	if (!usbFifoSelect(u16_Sel)) {
+		return 0;
+	}
+	u16_Length = R_USB_FS0->CFIFOCTR & USB_DTLN;
+	if (u16_Length == 0) {
+		/* 長さ0のパケット */
+		R_USB_FS0->CFIFOCTR = USB_BCLR;
+		return 0;
+	}
+	for (_i=0; _i<u16_Length; _i+=2) {
+		u16_Word = R_USB_FS0->CFIFO;
+		if (_i < u16_Size) {
+			pu8_Data[_i] = (uint8_t)u16_Word;
+		}
+		if (((_i + 1) < u16_Length) && ((_i + 1) < u16_Size)) {
+			pu8_Data[_i + 1] = (uint8_t)(u16_Word >> 8);
+		}
+	}
+	return (u16_Length < u16_Size) ? u16_Length : u16_Size;
+}
+
+/**
+  * @brief  バスリセット処理
+  * @param  None
+  * @retval None
+  */
+static void usbBusReset(void)
+{
+	uint8_t u8_Pipe;
+
+	u8s_UsbConfig = 0;
+	bls_UsbDtr = false;
+	bls_UsbRxPaused = false;
+	u16s_UsbCtrlRemain = 0;
+	bls_UsbCtrlZlp = false;
+	sts_UsbStatistics.u32_resets++;
+
+	R_USB_FS0->DCPMAXP = USB_EP0_SIZE;
+	for (u8_Pipe=1; u8_Pipe<=9; u8_Pipe++) {
+		R_USB_FS0->PIPE_CTR[u8_Pipe - 1] = USB_PID_NAK;
+	}
+	R_USB_FS0->BRDYENB = USB_PIPE_BIT(USB_PIPE_DCP);
+	R_USB_FS0->BEMPENB = USB_PIPE_BIT(USB_PIPE_DCP);
+}
+
+/**
+  * @brief  バルク/インタラプトパイプを設定する
+  * @param  None
+  * @retval None
+  */
+static void usbSetupPipes(void)
+{
+	static const uint16_t u16_Config[][3] = {
+		/* パイプ, PIPECFG, 最大パケットサイズ */
+		{USB_PIPE_TX, USB_TYPE_BULK | USB_DBLB | USB_DIR_IN | (USB_EP_TX & 0x0F), USB_BULK_SIZE},
+		{USB_PIPE_RX, USB_TYPE_BULK | USB_DBLB | (USB_EP_RX & 0x0F), USB_BULK_SIZE},
+		{USB_PIPE_NOTIFY, USB_TYPE_INT | USB_DIR_IN | (USB_EP_NOTIFY & 0x0F), USB_NOTIFY_SIZE},
+	};
+	uint8_t _i;
+
+	for (_i=0; _i<(sizeof(u16_Config) / sizeof(u16_Config[0])); _i++) {
+		R_USB_FS0->PIPESEL = u16_Config[_i][0];
+		R_USB_FS0->PIPECFG = u16_Config[_i][1];
+		R_USB_FS0->PIPEMAXP = u16_Config[_i][2];
+		R_USB_FS0->PIPESEL = 0;
+		/* トグルビットとバッファを初期化する */
+		R_USB_FS0->PIPE_CTR[u16_Config[_i][0] - 1] = USB_SQCLR;
+		R_USB_FS0->PIPE_CTR[u16_Config[_i][0] - 1] = USB_ACLRM;
+		R_USB_FS0->PIPE_CTR[u16_Config[_i][0] - 1] = 0;
+	}
+	/* 送受信を許可する(通知は使用しないためNAKのまま) */
+	R_USB_FS0->PIPE_CTR[USB_PIPE_TX - 1] = USB_PID_BUF;
+	R_USB_FS0->PIPE_CTR[USB_PIPE_RX - 1] = USB_PID_BUF;
+	R_USB_FS0->BRDYENB = USB_PIPE_BIT(USB_PIPE_DCP) | USB_PIPE_BIT(USB_PIPE_TX) | USB_PIPE_BIT(USB_PIPE_RX);
+}
+
+/**
+  * @brief  EP0の応答を設定する
+  * @param  u16_Pid: USB_PID_xxx(USB_CCPLを含めてよい)
+  * @retval None
+  */
+static void usbSetDcpPid(uint16_t u16_Pid)
+{
+	R_USB_FS0->DCPCTR = (uint16_t)((R_USB_FS0->DCPCTR & ~(USB_PID_MASK | USB_CCPL)) | (u16_Pid & USB_PID_MASK));
+	if (u16_Pid & USB_CCPL) {
+		R_USB_FS0->DCPCTR |= USB_CCPL;
+	}
+	if ((u16_Pid & USB_PID_MASK) == USB_PID_STALL) {
+		sts_UsbStatistics.u32_stalls++;
+	}
+}
+
+/**
+  * @brief  コントロール転送ステージ処理
+  * @param  u16_Stage: 遷移したステージ(USB_CS_xxx)
+  * @param  bl_Setup: セットアップを受信した
+  * @retval None
+  */
+static void usbControlStage(uint16_t u16_Stage, bool bl_Setup)
+{
+	uint16_t u16_Req = R_USB_FS0->USBREQ;
+	uint8_t u8_Type = (uint8_t)u16_Req;
+	uint8_t u8_Request = (uint8_t)(u16_Req >> 8);
+	uint16_t u16_Value = R_USB_FS0->USBVAL;
+	uint16_t u16_Index = R_USB_FS0->USBINDX;
+	bool bl_Ok = false;
+
+	if (bl_Setup) {
+		sts_UsbStatistics.u32_setups++;
+		u16s_UsbCtrlRemain = 0;
+		bls_UsbCtrlZlp = false;
+	}
+
+	switch (u16_Stage) {
+	case USB_CS_RDDS:
+		/* データ送信のリクエスト */
+		if (bl_Setup) {
+			bl_Ok = usbControlRead(u8_Type, u8_Request, u16_Value, u16_Index);
+			if (!bl_Ok) {
+				usbSetDcpPid(USB_PID_STALL);
+			}
+		}
+		break;
+	case USB_CS_WRDS:
+		/* データ受信のリクエスト(SET_LINE_CODINGのみ) */
+		if (bl_Setup) {
+			if (((u8_Type & USB_RT_TYPE_MASK) == USB_RT_CLASS) && (u8_Request == USB_REQ_SET_LINE_CODING)) {
+				u8s_UsbCtrlRequest = u8_Request;
+				usbSetDcpPid(USB_PID_BUF);
+			}
+			else {
+				usbSetDcpPid(USB_PID_STALL);
+			}
+		}
+		break;
+	case USB_CS_WRND:
+		/* データ無しのリクエスト */
+		if (bl_Setup) {
+			bl_Ok = usbControlNoData(u8_Type, u8_Request, u16_Value, u16_Index);
+			usbSetDcpPid(bl_Ok ? (USB_PID_BUF | USB_CCPL) : USB_PID_STALL);
+		}
+		break;
+	case USB_CS_RDSS:
+		/* ホストが応答データを受け取った */
+		usbSetDcpPid(USB_PID_BUF | USB_CCPL);
+		break;
+	case USB_CS_WRSS:
+		/* 受信したデータを反映する */
+		if (u8s_UsbCtrlRequest == USB_REQ_SET_LINE_CODING) {
+			mem_cpy08(&u8s_UsbLineCoding[0], &u8s_UsbCtrlBuffer[0], USB_LINE_CODING_SIZE);
+		}
+		u8s_UsbCtrlRequest = 0;
+		usbSetDcpPid(USB_PID_BUF | USB_CCPL);
+		break;
+	default:
+		/* アイドル(転送完了), シーケンスエラー */
+		break;
+	}
+}
+
+/**
+  * @brief  データ送信のリクエスト
+  * @param  u8_Type: bmRequestType
+  * @param  u8_Request: bRequest
+  * @param  u16_Value: wValue
+  * @param  u16_Index: wIndex
+  * @retval true:応答した / false:未対応(STALL)
+  */
+static bool usbControlRead(uint8_t u8_Type, uint8_t u8_Request, uint16_t u16_Value, uint16_t u16_Index)
+{
+	uint16_t u16_Length = R_USB_FS0->USBLENG;
+	const char *ps8_String;
+	uint8_t u8_Size;
+
+	(void)u16_Index;
+	if ((u8_Type & USB_RT_TYPE_MASK) == USB_RT_CLASS) {
+		if (u8_Request != USB_REQ_GET_LINE_CODING) {
+			return false;
+		}
+		usbControlSend(&u8s_UsbLineCoding[0], USB_LINE_CODING_SIZE, u16_Length);
+		return true;
+	}
+	if ((u8_Type & USB_RT_TYPE_MASK) != USB_RT_STANDARD) {
+		return false;
+	}
+
+	switch (u8_Request) {
+	case USB_REQ_GET_DESCRIPTOR:
+		switch (u16_Value >> 8) {
+		case USB_DT_DEVICE:
+			usbControlSend(&u8s_UsbDeviceDesc[0], sizeof(u8s_UsbDeviceDesc), u16_Length);
+			return true;
+		case USB_DT_CONFIG:
+			usbControlSend(&u8s_UsbConfigDesc[0], sizeof(u8s_UsbConfigDesc), u16_Length);
+			return true;
+		case USB_DT_STRING:
+			if ((u16_Value & 0xFF) >= USB_STRING_NUM) {
+				return false;
+			}
+			u8s_UsbCtrlBuffer[1] = USB_DT_STRING;
+			if ((u16_Value & 0xFF) == 0) {
+				/* 言語ID(英語 0x0409) */
+				u8s_UsbCtrlBuffer[2] = 0x09;
+				u8s_UsbCtrlBuffer[3] = 0x04;
+				u8_Size = 4;
+			}
+			else {
+				/* ASCIIをUTF-16LEに変換する */
+				ps8_String = ps8s_UsbString[u16_Value & 0xFF];
+				for (u8_Size=2; (*ps8_String != 0x00) && (u8_Size < USB_CTRL_BUFF_SIZE); u8_Size+=2) {
+					u8s_UsbCtrlBuffer[u8_Size] = (uint8_t)*ps8_String++;
+					u8s_UsbCtrlBuffer[u8_Size + 1] = 0x00;
+				}
+			}
+			u8s_UsbCtrlBuffer[0] = u8_Size;
+			usbControlSend(&u8s_UsbCtrlBuffer[0], u8_Size, u16_Length);
+			return true;
+		default:
+			/* デバイスクオリファイア等(フルスピード専用のため未対応) */
+			return false;
+		}
+	case USB_REQ_GET_CONFIGURATION:
+		u8s_UsbCtrlBuffer[0] = u8s_UsbConfig;
+		usbControlSend(&u8s_UsbCtrlBuffer[0], 1, u16_Length);
+		return true;
+	case USB_REQ_GET_STATUS:
+		/* バスパワー, リモートウェイクアップ無し, エンドポイントは停止無し */
+		u8s_UsbCtrlBuffer[0] = 0x00;
+		u8s_UsbCtrlBuffer[1] = 0x00;
+		usbControlSend(&u8s_UsbCtrlBuffer[0], 2, u16_Length);
+		return true;
+	case USB_REQ_GET_INTERFACE:
+		u8s_UsbCtrlBuffer[0] = 0x00;
+		usbControlSend(&u8s_UsbCtrlBuffer[0], 1, u16_Length);
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+  * @brief  データ無しのリクエスト
+  * @param  u8_Type: bmRequestType
+  * @param  u8_Request: bRequest
+  * @param  u16_Value: wValue
+  * @param  u16_Index: wIndex
+  * @retval true:処理した / false:未対応(STALL)
+  */
+static bool usbControlNoData(uint8_t u8_Type, uint8_t u8_Request, uint16_t u16_Value, uint16_t u16_Index)
+{
+	if ((u8_Type & USB_RT_TYPE_MASK) == USB_RT_CLASS) {
+		if (u8_Request != USB_REQ_SET_CONTROL_LINE_STATE) {
+			return false;
+		}
+		/* bit0:DTR(ポートオープン), bit1:RTS */
+		bls_UsbDtr = ((u16_Value & 0x0001) != 0);
+		return true;
+	}
+	if ((u8_Type & USB_RT_TYPE_MASK) != USB_RT_STANDARD) {
+		return false;
+	}
+
+	switch (u8_Request) {
+	case USB_REQ_SET_CONFIGURATION:
+		if (u16_Value > 1) {
+			return false;
+		}
+		u8s_UsbConfig = (uint8_t)u16_Value;
+		if (u8s_UsbConfig != 0) {
+			usbSetupPipes();
+		}
+		return true;
+	case USB_REQ_SET_INTERFACE:
+		return (u16_Value == 0);
+	case USB_REQ_CLEAR_FEATURE:
+		/* ENDPOINT_HALT の解除(トグルビットを初期化する) */
+		if ((u8_Type & USB_RT_RECIP_MASK) == USB_RT_ENDPOINT) {
+			if ((u16_Index & 0xFF) == USB_EP_TX) {
+				R_USB_FS0->PIPE_CTR[USB_PIPE_TX - 1] = USB_SQCLR | USB_PID_BUF;
+			}
+			else if ((u16_Index & 0xFF) == USB_EP_RX) {
+				R_USB_FS0->PIPE_CTR[USB_PIPE_RX - 1] = USB_SQCLR | USB_PID_BUF;
+			}
+		}
+		return true;
+	case USB_REQ_SET_FEATURE:
+		/* リモートウェイクアップ/テストモードは未対応 */
+		return false;
+	default:
+		return false;
+	}
+}
+
+/**
+  * @brief  応答データの送信を開始する
+  * @param  pu8_Data: データ
+  * @param  u16_Size: データのサイズ
+  * @param  u16_Length: ホストの要求サイズ(wLength)
+  * @retval None
+  * @note   要求サイズより短く、最大パケットサイズの倍数の場合は長さ0のパケットで終端する
+  */
+static void usbControlSend(const uint8_t *pu8_Data, uint16_t u16_Size, uint16_t u16_Length)
+{
+	if (u16_Size > u16_Length) {
+		u16_Size = u16_Length;
+	}
+	pu8s_UsbCtrlData = pu8_Data;
+	u16s_UsbCtrlRemain = u16_Size;
+	bls_UsbCtrlZlp = (u16_Size < u16_Length) && ((u16_Size % USB_EP0_SIZE) == 0);
+	usbControlSendNext();
+	usbSetDcpPid(USB_PID_BUF);
+}
+
+/**
+  * @brief  応答データの次のパケットを送信する
+  * @param  None
+  * @retval None
+  * @note   送信完了(BEMP)毎に呼び出す
+  */
+static void usbControlSendNext(void)
+{
+	uint16_t u16_Size = (u16s_UsbCtrlRemain > USB_EP0_SIZE) ? USB_EP0_SIZE : u16s_UsbCtrlRemain;
+
+	if ((u16_Size == 0) && !bls_UsbCtrlZlp) {
+		return;
+	}
+	if (u16_Size == 0) {
+		bls_UsbCtrlZlp = false;
+	}
+	usbFifoWrite(USB_ISEL | USB_PIPE_DCP, pu8s_UsbCtrlData, u16_Size, USB_EP0_SIZE);
+	pu8s_UsbCtrlData += u16_Size;
+	u16s_UsbCtrlRemain -= u16_Size;
+}
+
+/**
+  * @brief  送信Queueからバッファへ書き込む
+  * @param  None
+  * @retval None
+  * @note   空いている面(最大2面)へ1パケットずつ書き込む
+  */
+static void usbTxFill(void)
+{
+	uint8_t u8_Packet[USB_BULK_SIZE];
+	uint16_t u16_Size;
+
+	while ((sts_UsbTxQueue.u16_count > 0) && (R_USB_FS0->PIPE_CTR[USB_PIPE_TX - 1] & USB_BSTS)) {
+		for (u16_Size=0; u16_Size<USB_BULK_SIZE; u16_Size++) {
+			if (getUsbTxQueue(&u8_Packet[u16_Size]) != OK) {
+				break;
+			}
+		}
+		usbFifoWrite(USB_PIPE_TX, &u8_Packet[0], u16_Size, USB_BULK_SIZE);
+		sts_UsbStatistics.u32_tx_packets++;
+		sts_UsbStatistics.u32_tx_bytes += u16_Size;
+	}
+}
+
+/**
+  * @brief  バッファから受信Queueへ読み出す
+  * @param  None
+  * @retval None
+  * @note   受信Queueに1パケット分の空きが無ければ保留し、BRDY割り込みを止める
+  */
+static void usbRxDrain(void)
+{
+	uint8_t u8_Packet[USB_BULK_SIZE];
+	uint16_t u16_Size;
+	uint16_t _i;
+
+	while (R_USB_FS0->PIPE_CTR[USB_PIPE_RX - 1] & USB_BSTS) {
+		if ((USB_RX_QUEUE_SIZE - sts_UsbRxQueue.u16_count) < USB_BULK_SIZE) {
+			bls_UsbRxPaused = true;
+			R_USB_FS0->BRDYENB &= (uint16_t)~USB_PIPE_BIT(USB_PIPE_RX);
+			sts_UsbStatistics.u32_rx_paused++;
+			break;
+		}
+		u16_Size = usbFifoRead(USB_PIPE_RX, &u8_Packet[0], USB_BULK_SIZE);
+		for (_i=0; _i<u16_Size; _i++) {
+			(void)setUsbRxQueue(u8_Packet[_i]);
+		}
+		sts_UsbStatistics.u32_rx_packets++;
+		sts_UsbStatistics.u32_rx_bytes += u16_Size;
+	}
+}
+
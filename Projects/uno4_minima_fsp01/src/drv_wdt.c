@@ -0,0 +1,319 @@
+/**
+  ******************************************************************************
+  * @file           : drv_wdt.c
+  * @brief          : ウォッチドッグドライバー
+  ******************************************************************************
+  * @note   周期処理の全タスクがチェックイン(wdtCheckin)した周期だけWDTを
+  *         更新する。タスクの停止や割り込みの暴走で周期処理が進まなければ
+  *         WDTのタイムアウトでリセットされる。
+  *         リセット要因はリセット前にno-init RAMへ記録し、起動時にRSTSRの
+  *         フラグと照合して確定する(wdtGetResetInfo)。
+  *         IWDTはOFS0(オプション設定メモリ)でしか起動できないため使用しない。
+  *         WDTはOFS0.WDTSTRT=1(レジスタスタートモード,消去値)が前提。
+  *         WDTの設定はリセット後に1回しか書き込めないため、クロック切り替えで
+  *         PCLKBが下がるとタイムアウトは延びる(統計情報の値だけ換算し直す)。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "drv.h"
+#include "lib.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* リセット要因記録(no-init RAM) */
+typedef struct _WdtRecord {
+	uint32_t u32_magic;				/* 記録の有効判定						*/
+	uint32_t u32_magic_inv;			/* 記録の有効判定(反転値)				*/
+	uint32_t u32_boot_count;		/* 電源投入後のリセット回数				*/
+	uint32_t u32_cause;				/* リセット前に記録した要因				*/
+	uint32_t u32_stalled;			/* 停止したタスク						*/
+	Supervisor st_sup;				/* タスク監視情報						*/
+} WdtRecord;
+
+/* Private define ------------------------------------------------------------*/
+#define WDT_RECORD_MAGIC	(0x57445452UL)			/* 記録の有効判定値("WDTR")	*/
+#define WDT_CAUSE_NONE		(0xFFFFFFFFUL)			/* リセット前の記録無し		*/
+
+/* リセットステータスレジスタ */
+#define WDT_RSTSR0_PORF		(0x01)					/* パワーオンリセット		*/
+#define WDT_RSTSR1_IWDTRF	(0x0001)				/* IWDTリセット				*/
+#define WDT_RSTSR1_WDTRF	(0x0002)				/* WDTリセット				*/
+#define WDT_RSTSR1_SWRF		(0x0004)				/* ソフトウェアリセット		*/
+
+/* WDT設定値 */
+#define WDT_WDTCR_NO_WINDOW	(0x3300)				/* RPSS=100%,RPES=0%(ウィンドウ無し)	*/
+#define WDT_WDTRCR_RESET	(0x80)					/* アンダーフロー時リセット	*/
+#define WDT_WDTCSTPR_SLCSTP	(0x80)					/* スリープ中はカウント停止	*/
+#define WDT_CKS_NUM			(6)						/* クロック分周比の種類		*/
+#define WDT_TOPS_NUM		(4)						/* タイムアウト期間の種類	*/
+
+_Static_assert(TASK_ID_NUM <= SUP_TASK_MAX, "TASK_ID_NUM exceeds SUP_TASK_MAX");
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static WdtRecord sts_WdtRecord BSP_PLACE_IN_SECTION(BSP_SECTION_NOINIT);	/* リセット要因記録	*/
+static WdtResetInfo sts_WdtResetInfo;						/* 起動時に確定したリセット要因	*/
+static bool bls_WdtRefresh;									/* WDT更新許可					*/
+static uint32_t u32s_WdtCount;								/* タイムアウトのPCLKBカウント数	*/
+
+/* WDTCR.CKS と分周比 */
+static const uint8_t u8s_WdtCks[WDT_CKS_NUM] = { 0x1, 0x4, 0xF, 0x6, 0x7, 0x8 };
+static const uint16_t u16s_WdtDiv[WDT_CKS_NUM] = { 4, 64, 128, 512, 2048, 8192 };
+/* WDTCR.TOPS のカウント数 */
+static const uint16_t u16s_WdtTops[WDT_TOPS_NUM] = { 1024, 4096, 8192, 16384 };
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t wdt_get_cause(uint8_t u8_Rstsr0, uint16_t u16_Rstsr1);	/* リセット要因を確定する	*/
+static void wdt_start(void);								/* WDTを開始する				*/
+static void wdt_refresh(void);								/* WDTを更新する				*/
+static void wdt_reset(uint32_t u32_Cause);					/* 要因を記録してリセットする	*/
+static uint8_t wdt_clock_callback(uint8_t u8_Event, uint8_t u8_Mode);	/* クロック変更コールバック	*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  ウォッチドッグドライバー初期化処理
+  * @param  None
+  * @retval None
+  * @note   リセット要因を確定してからWDTを開始する
+  */
+void taskWdtDriverInit(void)
+{
+	uint8_t u8_Rstsr0 = R_SYSTEM->RSTSR0;
+	uint16_t u16_Rstsr1 = R_SYSTEM->RSTSR1;
+	uint8_t _i;
+
+	/* ---- リセット要因を確定する ---- */
+	mem_set08((uint8_t *)&sts_WdtResetInfo, 0, sizeof(WdtResetInfo));
+	sts_WdtResetInfo.u8_cause = wdt_get_cause(u8_Rstsr0, u16_Rstsr1);
+	if (sts_WdtResetInfo.u8_cause != WDT_RESET_POWER_ON) {
+		sts_WdtResetInfo.u32_boot_count = sts_WdtRecord.u32_boot_count + 1;
+	}
+	/* リセットステータスフラグをクリアする(1を読んだ後の0書き込み) */
+	R_SYSTEM->RSTSR0 = 0;
+	R_SYSTEM->RSTSR1 = 0;
+
+	/* ---- リセット要因記録とタスク監視を初期化する ---- */
+	sts_WdtRecord.u32_magic = WDT_RECORD_MAGIC;
+	sts_WdtRecord.u32_magic_inv = (uint32_t)~WDT_RECORD_MAGIC;
+	sts_WdtRecord.u32_boot_count = sts_WdtResetInfo.u32_boot_count;
+	sts_WdtRecord.u32_cause = WDT_CAUSE_NONE;
+	sts_WdtRecord.u32_stalled = 0;
+	supInit(&sts_WdtRecord.st_sup);
+	for (_i=0; _i<TASK_ID_NUM; _i++) {
+		/* 実行しないタスクは登録しない(チェックインも呼ばない) */
+		if ((TASK_ID_MASK & (1UL << _i)) == 0) {
+			continue;
+		}
+		if (supRegister(&sts_WdtRecord.st_sup, _i, 1) != OK) {
+			/* 監視できないタスクを残したまま動作させない */
+			Error_Handler();
+		}
+	}
+
+	/* ---- WDTを開始する ---- */
+	wdt_start();
+	bls_WdtRefresh = true;
+
+	/* ---- クロック変更の通知先を登録する ---- */
+	if (clockRegisterCallback(wdt_clock_callback) != OK) {
+		Error_Handler();
+	}
+}
+
+/**
+  * @brief  ウォッチドッグドライバー出力処理
+  * @param  None
+  * @retval None
+  * @note   周期処理の最後に呼び出す。全タスクがチェックインした場合だけ
+  *         WDTを更新し、停止したタスクがあれば記録して更新を止める。
+  */
+void taskWdtDriverOutput(void)
+{
+	if (!bls_WdtRefresh) {
+		return;
+	}
+	if (supEvaluate(&sts_WdtRecord.st_sup)) {
+		wdt_refresh();
+	}
+	else {
+		sts_WdtRecord.u32_stalled = supGetFailed(&sts_WdtRecord.st_sup);
+		sts_WdtRecord.u32_cause = WDT_RESET_WATCHDOG;
+		bls_WdtRefresh = false;
+	}
+}
+
+/**
+  * @brief  タスクの進行を報告する
+  * @param  u8_Task: タスク番号(TASK_ID_xxx)
+  * @retval None
+  */
+void wdtCheckin(uint8_t u8_Task)
+{
+	supCheckin(&sts_WdtRecord.st_sup, u8_Task);
+}
+
+/**
+  * @brief  ソフトウェアリセットする
+  * @param  None
+  * @retval None
+  */
+void wdtSystemReset(void)
+{
+	wdt_reset(WDT_RESET_SOFTWARE);
+}
+
+/**
+  * @brief  スタックオーバーフローでリセットする
+  * @param  None
+  * @retval None
+  * @note   スタックモニターのNMIから呼び出す
+  */
+void wdtStackOverflowReset(void)
+{
+	wdt_reset(WDT_RESET_STACK);
+}
+
+/**
+  * @brief  エラー停止を記録する
+  * @param  None
+  * @retval None
+  * @note   以降はWDTを更新しないため、WDTのタイムアウトでリセットされる
+  */
+void wdtNotifyError(void)
+{
+	sts_WdtRecord.u32_cause = WDT_RESET_ERROR;
+	sts_WdtRecord.u32_stalled = 0;
+	bls_WdtRefresh = false;
+}
+
+/**
+  * @brief  起動時に確定したリセット要因を取得する
+  * @param  pst_Info: リセット要因の格納先
+  * @retval None
+  */
+void wdtGetResetInfo(WdtResetInfo *pst_Info)
+{
+	*pst_Info = sts_WdtResetInfo;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  リセット要因を確定する
+  * @param  u8_Rstsr0: RSTSR0の値
+  * @param  u16_Rstsr1: RSTSR1の値
+  * @retval WDT_RESET_xxx
+  * @note   リセット前の記録は、対応するRSTSRのフラグがある場合だけ採用する
+  */
+static uint8_t wdt_get_cause(uint8_t u8_Rstsr0, uint16_t u16_Rstsr1)
+{
+	const WdtRecord *pst_Record = &sts_WdtRecord;
+	const Supervisor *pst_Sup = &pst_Record->st_sup;
+	bool bl_WdtReset = ((u16_Rstsr1 & (WDT_RSTSR1_WDTRF | WDT_RSTSR1_IWDTRF)) != 0);
+
+	/* 電源投入時(no-init RAMは不定) */
+	if ((u8_Rstsr0 & WDT_RSTSR0_PORF)
+	 || (pst_Record->u32_magic != WDT_RECORD_MAGIC) || (pst_Record->u32_magic_inv != (uint32_t)~WDT_RECORD_MAGIC)) {
+		return WDT_RESET_POWER_ON;
+	}
+	/* 停止検出/エラー停止によるWDTリセット */
+	if (bl_WdtReset && ((pst_Record->u32_cause == WDT_RESET_WATCHDOG) || (pst_Record->u32_cause == WDT_RESET_ERROR))) {
+		sts_WdtResetInfo.u32_stalled = pst_Record->u32_stalled;
+		return (uint8_t)pst_Record->u32_cause;
+	}
+	/* 周期処理の途中で止まったWDTリセット(チェックインの無いタスクが停止) */
+	if (bl_WdtReset) {
+		sts_WdtResetInfo.u32_stalled = pst_Sup->u32_registered & ~pst_Sup->u32_checkin;
+		return WDT_RESET_WATCHDOG;
+	}
+	if (u16_Rstsr1 & WDT_RSTSR1_SWRF) {
+		return (pst_Record->u32_cause == WDT_RESET_STACK) ? WDT_RESET_STACK : WDT_RESET_SOFTWARE;
+	}
+	/* RES端子リセット等 */
+	return WDT_RESET_PIN;
+}
+
+/**
+  * @brief  WDTを開始する
+  * @param  None
+  * @retval None
+  * @note   WDT_TIMEOUT_TIME以上で最小のタイムアウト期間を選択する。
+  *         WDTCR/WDTRCR/WDTCSTPRは最初の更新までに1回だけ書き込める。
+  */
+static void wdt_start(void)
+{
+	uint32_t u32_Pclkb = R_FSP_SystemClockHzGet(FSP_PRIV_CLOCK_PCLKB);
+	uint64_t u64_Target = ((uint64_t)u32_Pclkb * WDT_TIMEOUT_TIME) / 1000;
+	uint64_t u64_Best = 0;
+	uint64_t u64_Count;
+	uint8_t u8_Cks = 0;
+	uint8_t u8_Tops = 0;
+	uint8_t _i;
+	uint8_t _j;
+
+	for (_i=0; _i<WDT_CKS_NUM; _i++) {
+		for (_j=0; _j<WDT_TOPS_NUM; _j++) {
+			u64_Count = (uint64_t)u16s_WdtDiv[_i] * u16s_WdtTops[_j];
+			/* 目標以上で最小のもの(目標に届かなければ最大のもの) */
+			if ((u64_Best < u64_Target) ? (u64_Count > u64_Best) : ((u64_Count >= u64_Target) && (u64_Count < u64_Best))) {
+				u64_Best = u64_Count;
+				u8_Cks = _i;
+				u8_Tops = _j;
+			}
+		}
+	}
+	u32s_WdtCount = (uint32_t)u64_Best;
+	sts_WdtResetInfo.u32_timeout_ms = (uint32_t)((u64_Best * 1000) / u32_Pclkb);
+
+	R_WDT->WDTCR = (uint16_t)(WDT_WDTCR_NO_WINDOW | (u8s_WdtCks[u8_Cks] << 4) | u8_Tops);
+	R_WDT->WDTRCR = WDT_WDTRCR_RESET;
+	R_WDT->WDTCSTPR = WDT_WDTCSTPR_SLCSTP;
+	/* 最初の更新でカウントを開始する */
+	wdt_refresh();
+}
+
+/**
+  * @brief  WDTを更新する
+  * @param  None
+  * @retval None
+  */
+static void wdt_refresh(void)
+{
+	R_WDT->WDTRR = 0x00;
+	R_WDT->WDTRR = 0xFF;
+}
+
+/**
+  * @brief  要因を記録してリセットする
+  * @param  u32_Cause: リセット要因(WDT_RESET_xxx)
+  * @retval None
+  */
+static void wdt_reset(uint32_t u32_Cause)
+{
+	sts_WdtRecord.u32_cause = u32_Cause;
+	sts_WdtRecord.u32_stalled = 0;
+	__DSB();
+	NVIC_SystemReset();
+}
+
+/**
+  * @brief  クロック変更コールバック
+  * @param  u8_Event: CLOCK_EVENT_xxx
+  * @param  u8_Mode: 切り替え先の動作モード
+  * @retval OK
+  * @note   WDTの設定は変更できないため、切り替え後のPCLKBでタイムアウト時間を
+  *         換算し直すだけにする(割り込み禁止中に呼ばれる)
+  */
+static uint8_t wdt_clock_callback(uint8_t u8_Event, uint8_t u8_Mode)
+{
+	(void)u8_Mode;
+	if (u8_Event == CLOCK_EVENT_POST) {
+		sts_WdtResetInfo.u32_timeout_ms = (uint32_t)(((uint64_t)u32s_WdtCount * 1000) / R_FSP_SystemClockHzGet(FSP_PRIV_CLOCK_PCLKB));
+	}
+	return OK;
+}
+
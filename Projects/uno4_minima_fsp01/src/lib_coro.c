@@ -0,0 +1,208 @@
+/**
+  ******************************************************************************
+  * @file           : lib_coro.c
+  * @brief          : スタックレス コルーチン
+  ******************************************************************************
+  * @note   周期処理の中で動く協調型のコルーチン。再開位置(行番号)と待ち条件だけを
+  *         保持し、スタックもヒープも使わない(1個あたり16byte)。
+  *         coroRun()は待ち条件(時間/UART受信/イベント)の成立したコルーチンだけを
+  *         再開し、条件の確認はコルーチンを呼び出さずにスケジューラーが行う。
+  *         イベントは割り込みハンドラーからcoroSetEvent()で通知でき、待っている
+  *         コルーチンが再開する時に消費する(待つ前に通知されたイベントも残る)。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "drv.h"
+#include "lib.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static CoroFunc pfs_CoroFunc[CORO_MAX];				/* コルーチン関数(NULL:空き)	*/
+static Coro sts_Coro[CORO_MAX];						/* コルーチン情報			*/
+volatile static uint32_t u32s_CoroEvent;			/* 未消費のイベント(割り込みで更新)	*/
+static CoroStatistics sts_CoroStat;					/* 統計情報					*/
+
+/* Private function prototypes -----------------------------------------------*/
+static bool coro_ready(Coro *pst_Coro);				/* 待ち条件の成立を確認する	*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  コルーチン初期化処理
+  * @param  None
+  * @retval None
+  */
+void coroInit(void)
+{
+	uint8_t _i;
+
+	for (_i=0; _i<CORO_MAX; _i++) {
+		pfs_CoroFunc[_i] = NULL;
+	}
+	mem_set08((uint8_t *)&sts_Coro[0], 0, sizeof(sts_Coro));
+	mem_set08((uint8_t *)&sts_CoroStat, 0, sizeof(sts_CoroStat));
+	u32s_CoroEvent = 0;
+}
+
+/**
+  * @brief  コルーチンを開始する
+  * @param  pf_Func: コルーチン関数
+  * @retval コルーチン番号 / CORO_ID_NONE:登録できない
+  * @note   次のcoroRun()で先頭から実行する
+  */
+uint8_t coroStart(CoroFunc pf_Func)
+{
+	uint8_t _i;
+
+	if (pf_Func == NULL) {
+		return CORO_ID_NONE;
+	}
+	for (_i=0; _i<CORO_MAX; _i++) {
+		if (pfs_CoroFunc[_i] == NULL) {
+			mem_set08((uint8_t *)&sts_Coro[_i], 0, sizeof(Coro));
+			sts_Coro[_i].u8_wait = CORO_WAIT_YIELD;
+			pfs_CoroFunc[_i] = pf_Func;
+			sts_CoroStat.u8_active++;
+			if (sts_CoroStat.u8_active > sts_CoroStat.u8_high_water) {
+				sts_CoroStat.u8_high_water = sts_CoroStat.u8_active;
+			}
+			return _i;
+		}
+	}
+	return CORO_ID_NONE;
+}
+
+/**
+  * @brief  コルーチンを停止する
+  * @param  u8_Id: コルーチン番号
+  * @retval None
+  * @note   コルーチン自身から呼び出してもよい(以降は再開しない)
+  */
+void coroStop(uint8_t u8_Id)
+{
+	if ((u8_Id < CORO_MAX) && (pfs_CoroFunc[u8_Id] != NULL)) {
+		pfs_CoroFunc[u8_Id] = NULL;
+		sts_CoroStat.u8_active--;
+	}
+}
+
+/**
+  * @brief  コルーチンの動作状態を取得する
+  * @param  u8_Id: コルーチン番号
+  * @retval true:動作中 / false:終了,停止
+  */
+bool coroIsRunning(uint8_t u8_Id)
+{
+	return ((u8_Id < CORO_MAX) && (pfs_CoroFunc[u8_Id] != NULL));
+}
+
+/**
+  * @brief  イベントを通知する
+  * @param  u32_Event: イベント(bit)
+  * @retval None
+  * @note   割り込みハンドラーからも呼び出し可能
+  */
+void coroSetEvent(uint32_t u32_Event)
+{
+	__atomic_fetch_or(&u32s_CoroEvent, u32_Event, __ATOMIC_RELAXED);
+}
+
+/**
+  * @brief  待ち条件の成立したコルーチンを再開する(周期毎に1回呼び出す)
+  * @param  None
+  * @retval None
+  * @note   登録順に確認し、1回の呼び出しで各コルーチンを最大1回再開する
+  */
+void coroRun(void)
+{
+	Coro *pst_Coro;
+	uint8_t _i;
+
+	for (_i=0; _i<CORO_MAX; _i++) {
+		if (pfs_CoroFunc[_i] == NULL) {
+			continue;
+		}
+		pst_Coro = &sts_Coro[_i];
+		sts_CoroStat.u32_check++;
+		if (!coro_ready(pst_Coro)) {
+			continue;
+		}
+		sts_CoroStat.u32_resume++;
+		pfs_CoroFunc[_i](pst_Coro);
+		/* 最後まで実行したコルーチンを解放する */
+		if (pst_Coro->u8_wait == CORO_WAIT_END) {
+			coroStop(_i);
+		}
+	}
+}
+
+/**
+  * @brief  待ち条件を設定する(CORO_AWAIT_xxx用)
+  * @param  pst_Coro: コルーチン情報
+  * @param  u8_Wait: 待ち種別(CORO_WAIT_xxx)
+  * @param  u32_Arg: 時間待ち:待ち時間[ms] / イベント待ち:待つイベント(bit)
+  * @retval None
+  */
+void coroWait(Coro *pst_Coro, uint8_t u8_Wait, uint32_t u32_Arg)
+{
+	pst_Coro->u8_wait = u8_Wait;
+	pst_Coro->u32_arg = u32_Arg;
+	if (u8_Wait == CORO_WAIT_TIMER) {
+		startTimer(&pst_Coro->st_timer);
+	}
+}
+
+/**
+  * @brief  統計情報を取得する
+  * @param  pst_Stat: 統計情報の格納先
+  * @retval None
+  */
+void coroGetStatistics(CoroStatistics *pst_Stat)
+{
+	*pst_Stat = sts_CoroStat;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  待ち条件の成立を確認する
+  * @param  pst_Coro: コルーチン情報
+  * @retval true:再開する / false:待ちを続ける
+  * @note   イベント待ちは成立したイベントを消費し、u32_argに格納する
+  */
+static bool coro_ready(Coro *pst_Coro)
+{
+	uint32_t u32_Fired;
+	bool bl_Ready;
+
+	switch (pst_Coro->u8_wait) {
+	case CORO_WAIT_TIMER:
+		bl_Ready = checkTimer(&pst_Coro->st_timer, pst_Coro->u32_arg);
+		break;
+	case CORO_WAIT_UART_RX:
+		bl_Ready = (uartGetRxCount() > 0);
+		break;
+	case CORO_WAIT_EVENT:
+		u32_Fired = u32s_CoroEvent & pst_Coro->u32_arg;
+		if (u32_Fired != 0) {
+			__atomic_fetch_and(&u32s_CoroEvent, ~u32_Fired, __ATOMIC_RELAXED);
+			pst_Coro->u32_arg = u32_Fired;
+		}
+		bl_Ready = (u32_Fired != 0);
+		break;
+	case CORO_WAIT_END:
+		bl_Ready = false;
+		break;
+	default:
+		bl_Ready = true;
+		break;
+	}
+	return bl_Ready;
+}
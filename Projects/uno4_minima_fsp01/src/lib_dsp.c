@@ -0,0 +1,1170 @@
+/**
+  ******************************************************************************
+  * @file           : lib_dsp.c
+  * @brief          : 固定小数点DSPライブラリー(Cortex-M4 DSP命令対応)
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <math.h>
+#include "main.h"
+#include "lib.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define DSP_BENCH_SIZE		(256)					/* ベンチマークのサンプル数		*/
+#define DSP_BENCH_TAPS		(32)					/* ベンチマークのFIRタップ数	*/
+#define DSP_BENCH_STAGES	(2)						/* ベンチマークのBiquad段数		*/
+#define DSP_BENCH_DECIM		(4)						/* ベンチマークの間引き率		*/
+#define DSP_BENCH_AVERAGE	(16)					/* ベンチマークの移動平均長		*/
+#define DSP_BENCH_REPEAT	(3)						/* ベンチマークの繰り返し回数	*/
+#define DSP_BIQUAD_F32_COEF_NUM	(5)					/* Biquad(float)1段あたりの係数の数	*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+/* ベンチマーク/セルフテスト用バッファ */
+static q15_t q15s_DspIn[DSP_BENCH_SIZE];
+static q15_t q15s_DspIn2[DSP_BENCH_SIZE];
+static q15_t q15s_DspOut[DSP_BENCH_SIZE];
+static q15_t q15s_DspSave[DSP_BENCH_SIZE];
+static q15_t q15s_DspCoef[DSP_BENCH_TAPS];
+static q15_t q15s_DspState[DSP_BENCH_TAPS - 1 + DSP_BENCH_SIZE];
+static q15_t q15s_DspBiquadCoef[DSP_BENCH_STAGES * DSP_BIQUAD_COEF_NUM];
+static q15_t q15s_DspBiquadState[DSP_BENCH_STAGES * DSP_BIQUAD_STATE_NUM];
+static q15_t q15s_DspAverage[DSP_BENCH_AVERAGE];
+static float f32s_DspIn[DSP_BENCH_SIZE];
+static float f32s_DspOut[DSP_BENCH_SIZE];
+static float f32s_DspCoef[DSP_BENCH_TAPS];
+static float f32s_DspState[DSP_BENCH_TAPS - 1 + DSP_BENCH_SIZE];
+static float f32s_DspBiquadCoef[DSP_BENCH_STAGES * DSP_BIQUAD_F32_COEF_NUM];
+static float f32s_DspBiquadState[DSP_BENCH_STAGES * DSP_BIQUAD_STATE_NUM];
+static uint32_t u32s_DspRandom;							/* 擬似乱数の状態				*/
+
+/* ベンチマーク対象のカーネル名 */
+static const char * const cps8s_DspBenchName[DSP_BENCH_KERNEL_NUM] = {
+	"fir_q15", "biquad_q15", "movavg_q15", "decim_q15", "rms_q15", "peak_q15", "add_q15",
+	"fir_f32", "biquad_f32", "mag_f32",
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static int16_t dspSat16(int64_t s64_Value);			/* 16bit飽和処理						*/
+static int32_t dspSat32(int64_t s64_Value);			/* 32bit飽和処理						*/
+static uint32_t dspSqrt64(uint64_t u64_Value);		/* 整数平方根							*/
+static uint32_t dspRead2(const q15_t *pq15_Data);	/* q15を2サンプル分まとめて読み込む		*/
+static void dspWrite2(q15_t *pq15_Data, uint32_t u32_Value);	/* q15を2サンプル分まとめて書き込む	*/
+static int64_t dspSmlald(uint32_t u32_X, uint32_t u32_Y, int64_t s64_Acc);	/* SMLALD			*/
+static int32_t dspSmlad(uint32_t u32_X, uint32_t u32_Y, int32_t s32_Acc);	/* SMLAD			*/
+static int32_t dspSmuad(uint32_t u32_X, uint32_t u32_Y);		/* SMUAD						*/
+static uint32_t dspQadd16(uint32_t u32_X, uint32_t u32_Y);		/* QADD16						*/
+static uint32_t dspAbs2(uint32_t u32_X);			/* 2サンプルの絶対値(飽和)				*/
+static uint32_t dspMax2(uint32_t u32_X, uint32_t u32_Y);		/* 2サンプルの最大値			*/
+static int16_t dspRandom(void);						/* 擬似乱数を取得する					*/
+static void dspSetupBench(void);					/* ベンチマーク入力を作成する			*/
+static uint32_t dspRunKernel(uint8_t u8_Kernel, bool bl_Ref);	/* カーネルを1回実行する		*/
+static uint32_t dspMeasureKernel(uint8_t u8_Kernel, bool bl_Ref);	/* 1サンプルあたりのサイクル数を計測する	*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  FIRフィルター初期化処理(q15)
+  * @param  pst_Fir: FIRフィルター情報のポインタ
+  * @param  pq15_Coef: 係数(時間反転順: b[N-1], ..., b[0])
+  * @param  u16_Taps: タップ数
+  * @param  pq15_State: 状態バッファ(タップ数 - 1 + 最大ブロック長)
+  * @param  u16_BlockMax: 最大ブロック長
+  * @retval None
+  */
+void dspFirInitQ15(DspFirQ15 *pst_Fir, const q15_t *pq15_Coef, uint16_t u16_Taps, q15_t *pq15_State, uint16_t u16_BlockMax)
+{
+	pst_Fir->pq15_coef = pq15_Coef;
+	pst_Fir->pq15_state = pq15_State;
+	pst_Fir->u16_taps = u16_Taps;
+	pst_Fir->u16_block_max = u16_BlockMax;
+	mem_set16((uint16_t *)pq15_State, 0x0000, (size_t)(u16_Taps - 1 + u16_BlockMax));
+}
+
+/**
+  * @brief  FIRフィルター処理(q15, SMLALD)
+  * @param  pst_Fir: FIRフィルター情報のポインタ
+  * @param  pq15_In: 入力データ
+  * @param  pq15_Out: 出力データ
+  * @param  u16_Size: サンプル数
+  * @retval None
+  * @note   累積は64bitで行い、出力は(acc >> 15)を16bitに飽和させる
+  */
+void dspFirQ15(DspFirQ15 *pst_Fir, const q15_t *pq15_In, q15_t *pq15_Out, uint16_t u16_Size)
+{
+	q15_t *pq15_State = pst_Fir->pq15_state;
+	uint16_t u16_Taps = pst_Fir->u16_taps;
+	uint16_t u16_Block;
+	uint16_t u16_N;
+	uint16_t u16_K;
+
+	while (u16_Size > 0) {
+		u16_Block = (u16_Size < pst_Fir->u16_block_max) ? u16_Size : pst_Fir->u16_block_max;
+		/* 新しいサンプルを過去サンプルの後ろに連結する */
+		mem_cpy16((uint16_t *)&pq15_State[u16_Taps - 1], (const uint16_t *)pq15_In, u16_Block);
+
+		/* 2出力ずつ処理し、係数の読み込みを共有する */
+		for (u16_N=0; (u16_N + 1)<u16_Block; u16_N+=2) {
+			const q15_t *pq15_X = &pq15_State[u16_N];
+			const q15_t *pq15_C = pst_Fir->pq15_coef;
+			int64_t s64_Acc0 = 0;
+			int64_t s64_Acc1 = 0;
+			for (u16_K=0; (u16_K + 1)<u16_Taps; u16_K+=2) {
+				uint32_t u32_Coef = dspRead2(&pq15_C[u16_K]);
+				s64_Acc0 = dspSmlald(dspRead2(&pq15_X[u16_K]), u32_Coef, s64_Acc0);
+				s64_Acc1 = dspSmlald(dspRead2(&pq15_X[u16_K + 1]), u32_Coef, s64_Acc1);
+			}
+			if (u16_Taps & 1) {
+				s64_Acc0 += (int32_t)pq15_X[u16_K] * pq15_C[u16_K];
+				s64_Acc1 += (int32_t)pq15_X[u16_K + 1] * pq15_C[u16_K];
+			}
+			pq15_Out[u16_N] = dspSat16(s64_Acc0 >> 15);
+			pq15_Out[u16_N + 1] = dspSat16(s64_Acc1 >> 15);
+		}
+		/* 奇数ブロックの最終サンプル */
+		if (u16_N < u16_Block) {
+			const q15_t *pq15_X = &pq15_State[u16_N];
+			int64_t s64_Acc0 = 0;
+			for (u16_K=0; (u16_K + 1)<u16_Taps; u16_K+=2) {
+				s64_Acc0 = dspSmlald(dspRead2(&pq15_X[u16_K]), dspRead2(&pst_Fir->pq15_coef[u16_K]), s64_Acc0);
+			}
+			if (u16_Taps & 1) {
+				s64_Acc0 += (int32_t)pq15_X[u16_K] * pst_Fir->pq15_coef[u16_K];
+			}
+			pq15_Out[u16_N] = dspSat16(s64_Acc0 >> 15);
+		}
+
+		/* 過去サンプルを先頭へ移動する */
+		mem_cpy16((uint16_t *)&pq15_State[0], (const uint16_t *)&pq15_State[u16_Block], (size_t)(u16_Taps - 1));
+		pq15_In += u16_Block;
+		pq15_Out += u16_Block;
+		u16_Size -= u16_Block;
+	}
+}
+
+/**
+  * @brief  FIRフィルター処理(q15, C参照実装)
+  * @param  pst_Fir: FIRフィルター情報のポインタ
+  * @param  pq15_In: 入力データ
+  * @param  pq15_Out: 出力データ
+  * @param  u16_Size: サンプル数
+  * @retval None
+  */
+void dspFirQ15Ref(DspFirQ15 *pst_Fir, const q15_t *pq15_In, q15_t *pq15_Out, uint16_t u16_Size)
+{
+	q15_t *pq15_State = pst_Fir->pq15_state;
+	uint16_t u16_Taps = pst_Fir->u16_taps;
+	uint16_t u16_Block;
+	uint16_t u16_N;
+	uint16_t u16_K;
+	int64_t s64_Acc;
+
+	while (u16_Size > 0) {
+		u16_Block = (u16_Size < pst_Fir->u16_block_max) ? u16_Size : pst_Fir->u16_block_max;
+		for (u16_N=0; u16_N<u16_Block; u16_N++) {
+			pq15_State[u16_Taps - 1 + u16_N] = pq15_In[u16_N];
+		}
+		for (u16_N=0; u16_N<u16_Block; u16_N++) {
+			s64_Acc = 0;
+			for (u16_K=0; u16_K<u16_Taps; u16_K++) {
+				s64_Acc += (int32_t)pq15_State[u16_N + u16_K] * pst_Fir->pq15_coef[u16_K];
+			}
+			pq15_Out[u16_N] = dspSat16(s64_Acc >> 15);
+		}
+		for (u16_K=0; (u16_K + 1)<u16_Taps; u16_K++) {
+			pq15_State[u16_K] = pq15_State[u16_Block + u16_K];
+		}
+		pq15_In += u16_Block;
+		pq15_Out += u16_Block;
+		u16_Size -= u16_Block;
+	}
+}
+
+/**
+  * @brief  FIRフィルター初期化処理(q31)
+  * @param  pst_Fir: FIRフィルター情報のポインタ
+  * @param  pq31_Coef: 係数(時間反転順: b[N-1], ..., b[0])
+  * @param  u16_Taps: タップ数
+  * @param  pq31_State: 状態バッファ(タップ数 - 1 + 最大ブロック長)
+  * @param  u16_BlockMax: 最大ブロック長
+  * @retval None
+  */
+void dspFirInitQ31(DspFirQ31 *pst_Fir, const q31_t *pq31_Coef, uint16_t u16_Taps, q31_t *pq31_State, uint16_t u16_BlockMax)
+{
+	pst_Fir->pq31_coef = pq31_Coef;
+	pst_Fir->pq31_state = pq31_State;
+	pst_Fir->u16_taps = u16_Taps;
+	pst_Fir->u16_block_max = u16_BlockMax;
+	mem_set32((uint32_t *)pq31_State, 0x00000000, (size_t)(u16_Taps - 1 + u16_BlockMax));
+}
+
+/**
+  * @brief  FIRフィルター処理(q31)
+  * @param  pst_Fir: FIRフィルター情報のポインタ
+  * @param  pq31_In: 入力データ
+  * @param  pq31_Out: 出力データ
+  * @param  u16_Size: サンプル数
+  * @retval None
+  * @note   32bitデータはSIMD化できないため、SMLAL(64bit積和)で処理する
+  */
+void dspFirQ31(DspFirQ31 *pst_Fir, const q31_t *pq31_In, q31_t *pq31_Out, uint16_t u16_Size)
+{
+	q31_t *pq31_State = pst_Fir->pq31_state;
+	uint16_t u16_Taps = pst_Fir->u16_taps;
+	uint16_t u16_Block;
+	uint16_t u16_N;
+	uint16_t u16_K;
+	int64_t s64_Acc;
+
+	while (u16_Size > 0) {
+		u16_Block = (u16_Size < pst_Fir->u16_block_max) ? u16_Size : pst_Fir->u16_block_max;
+		mem_cpy32((uint32_t *)&pq31_State[u16_Taps - 1], (const uint32_t *)pq31_In, u16_Block);
+		for (u16_N=0; u16_N<u16_Block; u16_N++) {
+			s64_Acc = 0;
+			for (u16_K=0; u16_K<u16_Taps; u16_K++) {
+				s64_Acc += (int64_t)pq31_State[u16_N + u16_K] * pst_Fir->pq31_coef[u16_K];
+			}
+			pq31_Out[u16_N] = dspSat32(s64_Acc >> 31);
+		}
+		mem_cpy32((uint32_t *)&pq31_State[0], (const uint32_t *)&pq31_State[u16_Block], (size_t)(u16_Taps - 1));
+		pq31_In += u16_Block;
+		pq31_Out += u16_Block;
+		u16_Size -= u16_Block;
+	}
+}
+
+/**
+  * @brief  Biquad IIRフィルター処理(q15, 直接形I, SMUAD/SMLAD)
+  * @param  pq15_Coef: 係数(1段あたり {b0, 0, b1, b2, a1, a2}, q14)
+  * @param  pq15_State: 状態(1段あたり {x1, x2, y1, y2})
+  * @param  u8_Stages: 段数
+  * @param  pq15_Data: 入出力データ(上書き)
+  * @param  u16_Size: サンプル数
+  * @retval None
+  * @note   y = b0*x0 + b1*x1 + b2*x2 + a1*y1 + a2*y2 (a1,a2は符号反転済み)
+  *         32bit累積のため、係数の絶対値の総和は2.0未満とすること
+  */
+void dspBiquadQ15(const q15_t *pq15_Coef, q15_t *pq15_State, uint8_t u8_Stages, q15_t *pq15_Data, uint16_t u16_Size)
+{
+	uint8_t u8_Stage;
+	uint16_t u16_N;
+
+	for (u8_Stage=0; u8_Stage<u8_Stages; u8_Stage++) {
+		const q15_t *pq15_C = &pq15_Coef[u8_Stage * DSP_BIQUAD_COEF_NUM];
+		q15_t *pq15_S = &pq15_State[u8_Stage * DSP_BIQUAD_STATE_NUM];
+		int32_t s32_B0 = pq15_C[0];
+		uint32_t u32_B12 = dspRead2(&pq15_C[2]);
+		uint32_t u32_A12 = dspRead2(&pq15_C[4]);
+		/* 状態をレジスタに保持する({x1,x2}, {y1,y2}をパック) */
+		uint32_t u32_X12 = dspRead2(&pq15_S[0]);
+		uint32_t u32_Y12 = dspRead2(&pq15_S[2]);
+
+		for (u16_N=0; u16_N<u16_Size; u16_N++) {
+			int32_t s32_X0 = pq15_Data[u16_N];
+			int32_t s32_Acc = dspSmuad(u32_B12, u32_X12);
+			s32_Acc = dspSmlad(u32_A12, u32_Y12, s32_Acc);
+			s32_Acc += s32_B0 * s32_X0;
+			q15_t q15_Y0 = dspSat16((int64_t)(s32_Acc >> 14));
+			/* x2 ← x1, x1 ← x0, y2 ← y1, y1 ← y0 */
+			u32_X12 = (u32_X12 << 16) | (uint16_t)s32_X0;
+			u32_Y12 = (u32_Y12 << 16) | (uint16_t)q15_Y0;
+			pq15_Data[u16_N] = q15_Y0;
+		}
+		dspWrite2(&pq15_S[0], u32_X12);
+		dspWrite2(&pq15_S[2], u32_Y12);
+	}
+}
+
+/**
+  * @brief  Biquad IIRフィルター処理(q15, C参照実装)
+  * @param  pq15_Coef: 係数(1段あたり {b0, 0, b1, b2, a1, a2}, q14)
+  * @param  pq15_State: 状態(1段あたり {x1, x2, y1, y2})
+  * @param  u8_Stages: 段数
+  * @param  pq15_Data: 入出力データ(上書き)
+  * @param  u16_Size: サンプル数
+  * @retval None
+  */
+void dspBiquadQ15Ref(const q15_t *pq15_Coef, q15_t *pq15_State, uint8_t u8_Stages, q15_t *pq15_Data, uint16_t u16_Size)
+{
+	uint8_t u8_Stage;
+	uint16_t u16_N;
+	int64_t s64_Acc;
+
+	for (u8_Stage=0; u8_Stage<u8_Stages; u8_Stage++) {
+		const q15_t *pq15_C = &pq15_Coef[u8_Stage * DSP_BIQUAD_COEF_NUM];
+		q15_t *pq15_S = &pq15_State[u8_Stage * DSP_BIQUAD_STATE_NUM];
+		for (u16_N=0; u16_N<u16_Size; u16_N++) {
+			q15_t q15_X0 = pq15_Data[u16_N];
+			s64_Acc = (int32_t)pq15_C[0] * q15_X0
+					+ (int32_t)pq15_C[2] * pq15_S[0] + (int32_t)pq15_C[3] * pq15_S[1]
+					+ (int32_t)pq15_C[4] * pq15_S[2] + (int32_t)pq15_C[5] * pq15_S[3];
+			q15_t q15_Y0 = dspSat16(s64_Acc >> 14);
+			pq15_S[1] = pq15_S[0];
+			pq15_S[0] = q15_X0;
+			pq15_S[3] = pq15_S[2];
+			pq15_S[2] = q15_Y0;
+			pq15_Data[u16_N] = q15_Y0;
+		}
+	}
+}
+
+/**
+  * @brief  Biquad IIRフィルター処理(q31, 直接形I)
+  * @param  pq31_Coef: 係数(1段あたり {b0, b1, b2, a1, a2}, q30)
+  * @param  pq31_State: 状態(1段あたり {x1, x2, y1, y2})
+  * @param  u8_Stages: 段数
+  * @param  pq31_Data: 入出力データ(上書き)
+  * @param  u16_Size: サンプル数
+  * @retval None
+  */
+void dspBiquadQ31(const q31_t *pq31_Coef, q31_t *pq31_State, uint8_t u8_Stages, q31_t *pq31_Data, uint16_t u16_Size)
+{
+	uint8_t u8_Stage;
+	uint16_t u16_N;
+	int64_t s64_Acc;
+
+	for (u8_Stage=0; u8_Stage<u8_Stages; u8_Stage++) {
+		const q31_t *pq31_C = &pq31_Coef[u8_Stage * (DSP_BIQUAD_COEF_NUM - 1)];
+		q31_t *pq31_S = &pq31_State[u8_Stage * DSP_BIQUAD_STATE_NUM];
+		q31_t q31_X1 = pq31_S[0];
+		q31_t q31_X2 = pq31_S[1];
+		q31_t q31_Y1 = pq31_S[2];
+		q31_t q31_Y2 = pq31_S[3];
+		for (u16_N=0; u16_N<u16_Size; u16_N++) {
+			q31_t q31_X0 = pq31_Data[u16_N];
+			s64_Acc = (int64_t)pq31_C[0] * q31_X0
+					+ (int64_t)pq31_C[1] * q31_X1 + (int64_t)pq31_C[2] * q31_X2
+					+ (int64_t)pq31_C[3] * q31_Y1 + (int64_t)pq31_C[4] * q31_Y2;
+			q31_X2 = q31_X1;
+			q31_X1 = q31_X0;
+			q31_Y2 = q31_Y1;
+			q31_Y1 = dspSat32(s64_Acc >> 30);
+			pq31_Data[u16_N] = q31_Y1;
+		}
+		pq31_S[0] = q31_X1;
+		pq31_S[1] = q31_X2;
+		pq31_S[2] = q31_Y1;
+		pq31_S[3] = q31_Y2;
+	}
+}
+
+/**
+  * @brief  移動平均初期化処理(q15)
+  * @param  pst_Avg: 移動平均情報のポインタ
+  * @param  pq15_History: 履歴バッファ(平均長)
+  * @param  u8_Shift: 平均長 = 2^u8_Shift (1以上)
+  * @retval None
+  */
+void dspMovAvgInitQ15(DspMovAvgQ15 *pst_Avg, q15_t *pq15_History, uint8_t u8_Shift)
+{
+	pst_Avg->pq15_history = pq15_History;
+	pst_Avg->u16_length = (uint16_t)(1 << u8_Shift);
+	pst_Avg->u8_shift = u8_Shift;
+	pst_Avg->u16_pos = 0;
+	pst_Avg->s32_sum = 0;
+	mem_set16((uint16_t *)pq15_History, 0x0000, pst_Avg->u16_length);
+}
+
+/**
+  * @brief  移動平均処理(q15)
+  * @param  pst_Avg: 移動平均情報のポインタ
+  * @param  pq15_In: 入力データ
+  * @param  pq15_Out: 出力データ
+  * @param  u16_Size: サンプル数
+  * @retval None
+  * @note   累積和の差分更新により、平均長に依らず1サンプル1加減算で処理する
+  *         履歴は2サンプル単位でパックして読み書きする
+  */
+void dspMovAvgQ15(DspMovAvgQ15 *pst_Avg, const q15_t *pq15_In, q15_t *pq15_Out, uint16_t u16_Size)
+{
+	q15_t *pq15_Hist = pst_Avg->pq15_history;
+	uint16_t u16_Mask = pst_Avg->u16_length - 1;
+	uint16_t u16_Pos = pst_Avg->u16_pos;
+	int32_t s32_Sum = pst_Avg->s32_sum;
+	uint8_t u8_Shift = pst_Avg->u8_shift;
+	uint16_t u16_N = 0;
+
+	/* 履歴位置が偶数の間は2サンプルずつ処理する */
+	if ((u16_Pos & 1) == 0) {
+		for (; (u16_N + 1)<u16_Size; u16_N+=2) {
+			uint32_t u32_New = dspRead2(&pq15_In[u16_N]);
+			uint32_t u32_Old = dspRead2(&pq15_Hist[u16_Pos]);
+			dspWrite2(&pq15_Hist[u16_Pos], u32_New);
+			s32_Sum += (int16_t)u32_New - (int16_t)u32_Old;
+			pq15_Out[u16_N] = (q15_t)(s32_Sum >> u8_Shift);
+			s32_Sum += (int16_t)(u32_New >> 16) - (int16_t)(u32_Old >> 16);
+			pq15_Out[u16_N + 1] = (q15_t)(s32_Sum >> u8_Shift);
+			u16_Pos = (u16_Pos + 2) & u16_Mask;
+		}
+	}
+	for (; u16_N<u16_Size; u16_N++) {
+		s32_Sum += pq15_In[u16_N] - pq15_Hist[u16_Pos];
+		pq15_Hist[u16_Pos] = pq15_In[u16_N];
+		pq15_Out[u16_N] = (q15_t)(s32_Sum >> u8_Shift);
+		u16_Pos = (u16_Pos + 1) & u16_Mask;
+	}
+
+	pst_Avg->u16_pos = u16_Pos;
+	pst_Avg->s32_sum = s32_Sum;
+}
+
+/**
+  * @brief  移動平均処理(q15, C参照実装)
+  * @param  pst_Avg: 移動平均情報のポインタ
+  * @param  pq15_In: 入力データ
+  * @param  pq15_Out: 出力データ
+  * @param  u16_Size: サンプル数
+  * @retval None
+  */
+void dspMovAvgQ15Ref(DspMovAvgQ15 *pst_Avg, const q15_t *pq15_In, q15_t *pq15_Out, uint16_t u16_Size)
+{
+	uint16_t u16_N;
+	uint16_t u16_K;
+	int32_t s32_Sum;
+
+	for (u16_N=0; u16_N<u16_Size; u16_N++) {
+		pst_Avg->pq15_history[pst_Avg->u16_pos] = pq15_In[u16_N];
+		pst_Avg->u16_pos = (pst_Avg->u16_pos + 1) & (pst_Avg->u16_length - 1);
+		s32_Sum = 0;
+		for (u16_K=0; u16_K<pst_Avg->u16_length; u16_K++) {
+			s32_Sum += pst_Avg->pq15_history[u16_K];
+		}
+		pst_Avg->s32_sum = s32_Sum;
+		pq15_Out[u16_N] = (q15_t)(s32_Sum >> pst_Avg->u8_shift);
+	}
+}
+
+/**
+  * @brief  間引きFIRフィルター処理(q15, SMLALD)
+  * @param  pst_Fir: FIRフィルター情報のポインタ
+  * @param  u8_Factor: 間引き率
+  * @param  pq15_In: 入力データ
+  * @param  pq15_Out: 出力データ(サンプル数 / 間引き率)
+  * @param  u16_Size: 入力サンプル数(間引き率と最大ブロック長の倍数)
+  * @retval None
+  * @note   出力するサンプルのみ積和演算する
+  */
+void dspDecimateQ15(DspFirQ15 *pst_Fir, uint8_t u8_Factor, const q15_t *pq15_In, q15_t *pq15_Out, uint16_t u16_Size)
+{
+	q15_t *pq15_State = pst_Fir->pq15_state;
+	uint16_t u16_Taps = pst_Fir->u16_taps;
+	uint16_t u16_Block;
+	uint16_t u16_N;
+	uint16_t u16_K;
+
+	while (u16_Size > 0) {
+		u16_Block = (u16_Size < pst_Fir->u16_block_max) ? u16_Size : pst_Fir->u16_block_max;
+		mem_cpy16((uint16_t *)&pq15_State[u16_Taps - 1], (const uint16_t *)pq15_In, u16_Block);
+		for (u16_N=0; u16_N<u16_Block; u16_N+=u8_Factor) {
+			const q15_t *pq15_X = &pq15_State[u16_N + u8_Factor - 1];
+			int64_t s64_Acc = 0;
+			for (u16_K=0; (u16_K + 1)<u16_Taps; u16_K+=2) {
+				s64_Acc = dspSmlald(dspRead2(&pq15_X[u16_K]), dspRead2(&pst_Fir->pq15_coef[u16_K]), s64_Acc);
+			}
+			if (u16_Taps & 1) {
+				s64_Acc += (int32_t)pq15_X[u16_K] * pst_Fir->pq15_coef[u16_K];
+			}
+			*pq15_Out++ = dspSat16(s64_Acc >> 15);
+		}
+		mem_cpy16((uint16_t *)&pq15_State[0], (const uint16_t *)&pq15_State[u16_Block], (size_t)(u16_Taps - 1));
+		pq15_In += u16_Block;
+		u16_Size -= u16_Block;
+	}
+}
+
+/**
+  * @brief  間引きFIRフィルター処理(q15, C参照実装)
+  * @param  pst_Fir: FIRフィルター情報のポインタ
+  * @param  u8_Factor: 間引き率
+  * @param  pq15_In: 入力データ
+  * @param  pq15_Out: 出力データ(サンプル数 / 間引き率)
+  * @param  u16_Size: 入力サンプル数(間引き率と最大ブロック長の倍数)
+  * @retval None
+  */
+void dspDecimateQ15Ref(DspFirQ15 *pst_Fir, uint8_t u8_Factor, const q15_t *pq15_In, q15_t *pq15_Out, uint16_t u16_Size)
+{
+	q15_t *pq15_State = pst_Fir->pq15_state;
+	uint16_t u16_Taps = pst_Fir->u16_taps;
+	uint16_t u16_Block;
+	uint16_t u16_N;
+	uint16_t u16_K;
+	int64_t s64_Acc;
+
+	while (u16_Size > 0) {
+		u16_Block = (u16_Size < pst_Fir->u16_block_max) ? u16_Size : pst_Fir->u16_block_max;
+		for (u16_N=0; u16_N<u16_Block; u16_N++) {
+			pq15_State[u16_Taps - 1 + u16_N] = pq15_In[u16_N];
+		}
+		for (u16_N=(uint16_t)(u8_Factor - 1); u16_N<u16_Block; u16_N+=u8_Factor) {
+			s64_Acc = 0;
+			for (u16_K=0; u16_K<u16_Taps; u16_K++) {
+				s64_Acc += (int32_t)pq15_State[u16_N + u16_K] * pst_Fir->pq15_coef[u16_K];
+			}
+			*pq15_Out++ = dspSat16(s64_Acc >> 15);
+		}
+		for (u16_K=0; (u16_K + 1)<u16_Taps; u16_K++) {
+			pq15_State[u16_K] = pq15_State[u16_Block + u16_K];
+		}
+		pq15_In += u16_Block;
+		u16_Size -= u16_Block;
+	}
+}
+
+/**
+  * @brief  実効値を算出する(q15, SMLALD)
+  * @param  pq15_In: 入力データ
+  * @param  u16_Size: サンプル数(1以上)
+  * @retval 実効値(q15)
+  */
+q15_t dspRmsQ15(const q15_t *pq15_In, uint16_t u16_Size)
+{
+	int64_t s64_Acc = 0;
+	uint16_t u16_N;
+
+	for (u16_N=0; (u16_N + 1)<u16_Size; u16_N+=2) {
+		uint32_t u32_X = dspRead2(&pq15_In[u16_N]);
+		s64_Acc = dspSmlald(u32_X, u32_X, s64_Acc);
+	}
+	if (u16_N < u16_Size) {
+		s64_Acc += (int32_t)pq15_In[u16_N] * pq15_In[u16_N];
+	}
+	/* 平均(q30)の平方根 → q15 */
+	return (q15_t)dspSat16((int64_t)dspSqrt64((uint64_t)s64_Acc / u16_Size));
+}
+
+/**
+  * @brief  実効値を算出する(q15, C参照実装)
+  * @param  pq15_In: 入力データ
+  * @param  u16_Size: サンプル数(1以上)
+  * @retval 実効値(q15)
+  */
+q15_t dspRmsQ15Ref(const q15_t *pq15_In, uint16_t u16_Size)
+{
+	uint64_t u64_Acc = 0;
+	uint16_t u16_N;
+
+	for (u16_N=0; u16_N<u16_Size; u16_N++) {
+		u64_Acc += (uint64_t)((int32_t)pq15_In[u16_N] * pq15_In[u16_N]);
+	}
+	return (q15_t)dspSat16((int64_t)dspSqrt64(u64_Acc / u16_Size));
+}
+
+/**
+  * @brief  実効値を算出する(q31)
+  * @param  pq31_In: 入力データ
+  * @param  u16_Size: サンプル数(1以上)
+  * @retval 実効値(q31)
+  */
+q31_t dspRmsQ31(const q31_t *pq31_In, uint16_t u16_Size)
+{
+	uint64_t u64_Acc = 0;
+	uint16_t u16_N;
+
+	/* 2乗(q62)をq31に丸めて累積する */
+	for (u16_N=0; u16_N<u16_Size; u16_N++) {
+		u64_Acc += (uint64_t)(((int64_t)pq31_In[u16_N] * pq31_In[u16_N]) >> 31);
+	}
+	/* 平均(q31)をq62に戻して平方根 → q31 */
+	return dspSat32((int64_t)dspSqrt64((u64_Acc / u16_Size) << 31));
+}
+
+/**
+  * @brief  ピーク値(絶対値の最大)を算出する(q15, QSUB16/SEL)
+  * @param  pq15_In: 入力データ
+  * @param  u16_Size: サンプル数
+  * @retval ピーク値(q15, -32768は32767に飽和)
+  */
+q15_t dspPeakQ15(const q15_t *pq15_In, uint16_t u16_Size)
+{
+	uint32_t u32_Max = 0;
+	uint16_t u16_N;
+	q15_t q15_Lo;
+	q15_t q15_Hi;
+
+	for (u16_N=0; (u16_N + 1)<u16_Size; u16_N+=2) {
+		u32_Max = dspMax2(dspAbs2(dspRead2(&pq15_In[u16_N])), u32_Max);
+	}
+	if (u16_N < u16_Size) {
+		u32_Max = dspMax2(dspAbs2((uint16_t)pq15_In[u16_N]), u32_Max);
+	}
+	q15_Lo = (q15_t)(u32_Max & 0xFFFF);
+	q15_Hi = (q15_t)(u32_Max >> 16);
+	return (q15_Lo > q15_Hi) ? q15_Lo : q15_Hi;
+}
+
+/**
+  * @brief  ピーク値(絶対値の最大)を算出する(q15, C参照実装)
+  * @param  pq15_In: 入力データ
+  * @param  u16_Size: サンプル数
+  * @retval ピーク値(q15, -32768は32767に飽和)
+  */
+q15_t dspPeakQ15Ref(const q15_t *pq15_In, uint16_t u16_Size)
+{
+	q15_t q15_Max = 0;
+	q15_t q15_Abs;
+	uint16_t u16_N;
+
+	for (u16_N=0; u16_N<u16_Size; u16_N++) {
+		q15_Abs = dspSat16(-(int32_t)pq15_In[u16_N]);
+		if (pq15_In[u16_N] > q15_Abs) {
+			q15_Abs = pq15_In[u16_N];
+		}
+		if (q15_Abs > q15_Max) {
+			q15_Max = q15_Abs;
+		}
+	}
+	return q15_Max;
+}
+
+/**
+  * @brief  ピーク値(絶対値の最大)を算出する(q31)
+  * @param  pq31_In: 入力データ
+  * @param  u16_Size: サンプル数
+  * @retval ピーク値(q31, 最小値は最大値に飽和)
+  */
+q31_t dspPeakQ31(const q31_t *pq31_In, uint16_t u16_Size)
+{
+	q31_t q31_Max = 0;
+	q31_t q31_Abs;
+	uint16_t u16_N;
+
+	for (u16_N=0; u16_N<u16_Size; u16_N++) {
+		q31_Abs = dspSat32(((int64_t)pq31_In[u16_N] < 0) ? -(int64_t)pq31_In[u16_N] : (int64_t)pq31_In[u16_N]);
+		if (q31_Abs > q31_Max) {
+			q31_Max = q31_Abs;
+		}
+	}
+	return q31_Max;
+}
+
+/**
+  * @brief  飽和加算(q15, QADD16)
+  * @param  pq15_In1: 入力データ1
+  * @param  pq15_In2: 入力データ2
+  * @param  pq15_Out: 出力データ
+  * @param  u16_Size: サンプル数
+  * @retval None
+  */
+void dspAddQ15(const q15_t *pq15_In1, const q15_t *pq15_In2, q15_t *pq15_Out, uint16_t u16_Size)
+{
+	uint16_t u16_N;
+
+	for (u16_N=0; (u16_N + 1)<u16_Size; u16_N+=2) {
+		dspWrite2(&pq15_Out[u16_N], dspQadd16(dspRead2(&pq15_In1[u16_N]), dspRead2(&pq15_In2[u16_N])));
+	}
+	if (u16_N < u16_Size) {
+		pq15_Out[u16_N] = dspSat16((int32_t)pq15_In1[u16_N] + pq15_In2[u16_N]);
+	}
+}
+
+/**
+  * @brief  飽和加算(q15, C参照実装)
+  * @param  pq15_In1: 入力データ1
+  * @param  pq15_In2: 入力データ2
+  * @param  pq15_Out: 出力データ
+  * @param  u16_Size: サンプル数
+  * @retval None
+  */
+void dspAddQ15Ref(const q15_t *pq15_In1, const q15_t *pq15_In2, q15_t *pq15_Out, uint16_t u16_Size)
+{
+	uint16_t u16_N;
+
+	for (u16_N=0; u16_N<u16_Size; u16_N++) {
+		pq15_Out[u16_N] = dspSat16((int32_t)pq15_In1[u16_N] + pq15_In2[u16_N]);
+	}
+}
+
+/**
+  * @brief  FIRフィルター初期化処理(float)
+  * @param  pst_Fir: FIRフィルター情報のポインタ
+  * @param  pf32_Coef: 係数(時間反転順: b[N-1], ..., b[0])
+  * @param  u16_Taps: タップ数
+  * @param  pf32_State: 状態バッファ(タップ数 - 1 + 最大ブロック長)
+  * @param  u16_BlockMax: 最大ブロック長
+  * @retval None
+  */
+void dspFirInitF32(DspFirF32 *pst_Fir, const float *pf32_Coef, uint16_t u16_Taps, float *pf32_State, uint16_t u16_BlockMax)
+{
+	pst_Fir->pf32_coef = pf32_Coef;
+	pst_Fir->pf32_state = pf32_State;
+	pst_Fir->u16_taps = u16_Taps;
+	pst_Fir->u16_block_max = u16_BlockMax;
+	mem_set32((uint32_t *)pf32_State, 0x00000000, (size_t)(u16_Taps - 1 + u16_BlockMax));
+}
+
+/**
+  * @brief  FIRフィルター処理(float)
+  * @param  pst_Fir: FIRフィルター情報のポインタ
+  * @param  pf32_In: 入力データ
+  * @param  pf32_Out: 出力データ
+  * @param  u16_Size: サンプル数
+  * @retval None
+  */
+void dspFirF32(DspFirF32 *pst_Fir, const float *pf32_In, float *pf32_Out, uint16_t u16_Size)
+{
+	float *pf32_State = pst_Fir->pf32_state;
+	uint16_t u16_Taps = pst_Fir->u16_taps;
+	uint16_t u16_Block;
+	uint16_t u16_N;
+	uint16_t u16_K;
+	float f32_Acc;
+
+	while (u16_Size > 0) {
+		u16_Block = (u16_Size < pst_Fir->u16_block_max) ? u16_Size : pst_Fir->u16_block_max;
+		mem_cpy32((uint32_t *)&pf32_State[u16_Taps - 1], (const uint32_t *)pf32_In, u16_Block);
+		for (u16_N=0; u16_N<u16_Block; u16_N++) {
+			f32_Acc = 0.0f;
+			for (u16_K=0; u16_K<u16_Taps; u16_K++) {
+				f32_Acc += pf32_State[u16_N + u16_K] * pst_Fir->pf32_coef[u16_K];
+			}
+			pf32_Out[u16_N] = f32_Acc;
+		}
+		mem_cpy32((uint32_t *)&pf32_State[0], (const uint32_t *)&pf32_State[u16_Block], (size_t)(u16_Taps - 1));
+		pf32_In += u16_Block;
+		pf32_Out += u16_Block;
+		u16_Size -= u16_Block;
+	}
+}
+
+/**
+  * @brief  Biquad IIRフィルター処理(float, 直接形I)
+  * @param  pf32_Coef: 係数(1段あたり {b0, b1, b2, a1, a2})
+  * @param  pf32_State: 状態(1段あたり {x1, x2, y1, y2})
+  * @param  u8_Stages: 段数
+  * @param  pf32_Data: 入出力データ(上書き)
+  * @param  u16_Size: サンプル数
+  * @retval None
+  */
+void dspBiquadF32(const float *pf32_Coef, float *pf32_State, uint8_t u8_Stages, float *pf32_Data, uint16_t u16_Size)
+{
+	uint8_t u8_Stage;
+	uint16_t u16_N;
+
+	for (u8_Stage=0; u8_Stage<u8_Stages; u8_Stage++) {
+		const float *pf32_C = &pf32_Coef[u8_Stage * DSP_BIQUAD_F32_COEF_NUM];
+		float *pf32_S = &pf32_State[u8_Stage * DSP_BIQUAD_STATE_NUM];
+		float f32_X1 = pf32_S[0];
+		float f32_X2 = pf32_S[1];
+		float f32_Y1 = pf32_S[2];
+		float f32_Y2 = pf32_S[3];
+		for (u16_N=0; u16_N<u16_Size; u16_N++) {
+			float f32_X0 = pf32_Data[u16_N];
+			float f32_Y0 = (pf32_C[0] * f32_X0) + (pf32_C[1] * f32_X1) + (pf32_C[2] * f32_X2)
+						 + (pf32_C[3] * f32_Y1) + (pf32_C[4] * f32_Y2);
+			f32_X2 = f32_X1;
+			f32_X1 = f32_X0;
+			f32_Y2 = f32_Y1;
+			f32_Y1 = f32_Y0;
+			pf32_Data[u16_N] = f32_Y0;
+		}
+		pf32_S[0] = f32_X1;
+		pf32_S[1] = f32_X2;
+		pf32_S[2] = f32_Y1;
+		pf32_S[3] = f32_Y2;
+	}
+}
+
+/**
+  * @brief  複素数の大きさを算出する(float)
+  * @param  pf32_In: 入力データ({re, im} × サンプル数)
+  * @param  pf32_Out: 出力データ
+  * @param  u16_Size: サンプル数
+  * @retval None
+  */
+void dspMagF32(const float *pf32_In, float *pf32_Out, uint16_t u16_Size)
+{
+	uint16_t u16_N;
+
+	for (u16_N=0; u16_N<u16_Size; u16_N++) {
+		float f32_Re = pf32_In[u16_N * 2];
+		float f32_Im = pf32_In[(u16_N * 2) + 1];
+		pf32_Out[u16_N] = sqrtf((f32_Re * f32_Re) + (f32_Im * f32_Im));
+	}
+}
+
+/**
+  * @brief  浮動小数点ABI名を取得する
+  * @param  None
+  * @retval "hard"(FPUレジスタ渡し), "softfp"(FPU命令のみ), "soft"(ソフトウェアエミュレーション)
+  */
+const char *dspGetFloatAbi(void)
+{
+#if defined(__ARM_PCS_VFP)
+	return "hard";
+#elif defined(__ARM_FP)
+	return "softfp";
+#else
+	return "soft";
+#endif
+}
+
+/**
+  * @brief  DSPカーネルのセルフテスト(最適化版とC参照実装のビット一致確認)
+  * @param  None
+  * @retval 不一致のカーネル(bit0:fir_q15 ～ bit6:add_q15), 0=全一致
+  * @note   浮動小数点カーネルは参照実装を持たないため対象外
+  */
+uint32_t dspSelfTest(void)
+{
+	uint32_t u32_Result = 0;
+	uint8_t u8_Kernel;
+	uint8_t u8_Pass;
+
+	/* 通常の乱数入力と、飽和が起きる極端な入力の2パターンで確認する */
+	for (u8_Pass=0; u8_Pass<2; u8_Pass++) {
+		u32s_DspRandom = 0x12345678 + u8_Pass;
+		dspSetupBench();
+		if (u8_Pass == 1) {
+			q15s_DspIn[0] = -32768;
+			q15s_DspIn[1] = -32768;
+			q15s_DspIn[2] = 32767;
+			q15s_DspIn2[0] = -32768;
+			q15s_DspIn2[2] = 32767;
+		}
+		for (u8_Kernel=0; u8_Kernel<DSP_BENCH_FIXED_NUM; u8_Kernel++) {
+			uint32_t u32_Opt = dspRunKernel(u8_Kernel, false);
+			mem_cpy16((uint16_t *)q15s_DspSave, (const uint16_t *)q15s_DspOut, DSP_BENCH_SIZE);
+			uint32_t u32_Ref = dspRunKernel(u8_Kernel, true);
+			if ((u32_Opt != u32_Ref) || (mem_cmp16((const uint16_t *)q15s_DspSave, (const uint16_t *)q15s_DspOut, DSP_BENCH_SIZE) != 0)) {
+				u32_Result |= (1UL << u8_Kernel);
+			}
+		}
+	}
+	return u32_Result;
+}
+
+/**
+  * @brief  DSPカーネルのベンチマーク
+  * @param  pst_Result: 計測結果(DSP_BENCH_KERNEL_NUM個)
+  * @retval None
+  * @note   DWTサイクルカウンターで計測し、割り込みの影響を除くため最小値を採る。
+  *         固定小数点カーネルはC参照実装(*Ref)も同じ入力で計測する
+  */
+void dspBenchmark(DspBenchResult *pst_Result)
+{
+	uint8_t u8_Kernel;
+
+	u32s_DspRandom = 0x12345678;
+	dspSetupBench();
+	for (u8_Kernel=0; u8_Kernel<DSP_BENCH_KERNEL_NUM; u8_Kernel++) {
+		pst_Result[u8_Kernel].ps8_name = cps8s_DspBenchName[u8_Kernel];
+		pst_Result[u8_Kernel].u32_cycles_x100 = dspMeasureKernel(u8_Kernel, false);
+		pst_Result[u8_Kernel].u32_ref_cycles_x100 = 0;
+		if (u8_Kernel < DSP_BENCH_FIXED_NUM) {
+			pst_Result[u8_Kernel].u32_ref_cycles_x100 = dspMeasureKernel(u8_Kernel, true);
+		}
+	}
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  16bit飽和処理
+  * @param  s64_Value: 値
+  * @retval 飽和後の値
+  */
+static int16_t dspSat16(int64_t s64_Value)
+{
+	if (s64_Value > INT16_MAX) {
+		return INT16_MAX;
+	}
+	if (s64_Value < INT16_MIN) {
+		return INT16_MIN;
+	}
+	return (int16_t)s64_Value;
+}
+
+/**
+  * @brief  32bit飽和処理
+  * @param  s64_Value: 値
+  * @retval 飽和後の値
+  */
+static int32_t dspSat32(int64_t s64_Value)
+{
+	if (s64_Value > INT32_MAX) {
+		return INT32_MAX;
+	}
+	if (s64_Value < INT32_MIN) {
+		return INT32_MIN;
+	}
+	return (int32_t)s64_Value;
+}
+
+/**
+  * @brief  整数平方根
+  * @param  u64_Value: 値
+  * @retval floor(sqrt(値))
+  */
+static uint32_t dspSqrt64(uint64_t u64_Value)
+{
+	uint64_t u64_Root = 0;
+	uint64_t u64_Bit = 1ULL << 62;
+
+	while (u64_Bit > u64_Value) {
+		u64_Bit >>= 2;
+	}
+	while (u64_Bit != 0) {
+		if (u64_Value >= (u64_Root + u64_Bit)) {
+			u64_Value -= u64_Root + u64_Bit;
+			u64_Root = (u64_Root >> 1) + u64_Bit;
+		}
+		else {
+			u64_Root >>= 1;
+		}
+		u64_Bit >>= 2;
+	}
+	return (uint32_t)u64_Root;
+}
+
+/**
+  * @brief  q15を2サンプル分まとめて読み込む(非整列可)
+  * @param  pq15_Data: データのポインタ
+  * @retval 下位16bit=pq15_Data[0], 上位16bit=pq15_Data[1]
+  */
+static inline uint32_t dspRead2(const q15_t *pq15_Data)
+{
+	uint32_t u32_Value;
+
+	memcpy(&u32_Value, pq15_Data, sizeof(u32_Value));
+	return u32_Value;
+}
+
+/**
+  * @brief  q15を2サンプル分まとめて書き込む(非整列可)
+  * @param  pq15_Data: データのポインタ
+  * @param  u32_Value: 下位16bit=pq15_Data[0], 上位16bit=pq15_Data[1]
+  * @retval None
+  */
+static inline void dspWrite2(q15_t *pq15_Data, uint32_t u32_Value)
+{
+	memcpy(pq15_Data, &u32_Value, sizeof(u32_Value));
+}
+
+#if defined(__ARM_FEATURE_DSP)
+/* Cortex-M4 DSP命令 */
+
+static inline int64_t dspSmlald(uint32_t u32_X, uint32_t u32_Y, int64_t s64_Acc)
+{
+	return (int64_t)__SMLALD(u32_X, u32_Y, (uint64_t)s64_Acc);
+}
+
+static inline int32_t dspSmlad(uint32_t u32_X, uint32_t u32_Y, int32_t s32_Acc)
+{
+	return (int32_t)__SMLAD(u32_X, u32_Y, (uint32_t)s32_Acc);
+}
+
+static inline int32_t dspSmuad(uint32_t u32_X, uint32_t u32_Y)
+{
+	return (int32_t)__SMUAD(u32_X, u32_Y);
+}
+
+static inline uint32_t dspQadd16(uint32_t u32_X, uint32_t u32_Y)
+{
+	return __QADD16(u32_X, u32_Y);
+}
+
+static inline uint32_t dspAbs2(uint32_t u32_X)
+{
+	uint32_t u32_Neg = __QSUB16(0, u32_X);
+	/* x >= -x のレーンでGEフラグを立て、x/-xを選択する */
+	(void)__SSUB16(u32_X, u32_Neg);
+	return __SEL(u32_X, u32_Neg);
+}
+
+static inline uint32_t dspMax2(uint32_t u32_X, uint32_t u32_Y)
+{
+	(void)__SSUB16(u32_X, u32_Y);
+	return __SEL(u32_X, u32_Y);
+}
+
+#else
+/* DSP命令のC言語エミュレーション(ホストでのビット一致確認用) */
+
+static inline int64_t dspSmlald(uint32_t u32_X, uint32_t u32_Y, int64_t s64_Acc)
+{
+	return s64_Acc + ((int32_t)(int16_t)u32_X * (int16_t)u32_Y)
+				   + ((int32_t)(int16_t)(u32_X >> 16) * (int16_t)(u32_Y >> 16));
+}
+
+static inline int32_t dspSmlad(uint32_t u32_X, uint32_t u32_Y, int32_t s32_Acc)
+{
+	return (int32_t)((uint32_t)s32_Acc + (uint32_t)dspSmuad(u32_X, u32_Y));
+}
+
+static inline int32_t dspSmuad(uint32_t u32_X, uint32_t u32_Y)
+{
+	return (int32_t)((uint32_t)((int32_t)(int16_t)u32_X * (int16_t)u32_Y)
+				   + (uint32_t)((int32_t)(int16_t)(u32_X >> 16) * (int16_t)(u32_Y >> 16)));
+}
+
+static inline uint32_t dspQadd16(uint32_t u32_X, uint32_t u32_Y)
+{
+	uint16_t u16_Lo = (uint16_t)dspSat16((int32_t)(int16_t)u32_X + (int16_t)u32_Y);
+	uint16_t u16_Hi = (uint16_t)dspSat16((int32_t)(int16_t)(u32_X >> 16) + (int16_t)(u32_Y >> 16));
+	return ((uint32_t)u16_Hi << 16) | u16_Lo;
+}
+
+static inline uint32_t dspAbs2(uint32_t u32_X)
+{
+	int16_t s16_Lo = (int16_t)u32_X;
+	int16_t s16_Hi = (int16_t)(u32_X >> 16);
+	uint16_t u16_Lo = (uint16_t)((s16_Lo >= 0) ? s16_Lo : dspSat16(-(int32_t)s16_Lo));
+	uint16_t u16_Hi = (uint16_t)((s16_Hi >= 0) ? s16_Hi : dspSat16(-(int32_t)s16_Hi));
+	return ((uint32_t)u16_Hi << 16) | u16_Lo;
+}
+
+static inline uint32_t dspMax2(uint32_t u32_X, uint32_t u32_Y)
+{
+	uint16_t u16_Lo = ((int16_t)u32_X >= (int16_t)u32_Y) ? (uint16_t)u32_X : (uint16_t)u32_Y;
+	uint16_t u16_Hi = ((int16_t)(u32_X >> 16) >= (int16_t)(u32_Y >> 16)) ? (uint16_t)(u32_X >> 16) : (uint16_t)(u32_Y >> 16);
+	return ((uint32_t)u16_Hi << 16) | u16_Lo;
+}
+
+#endif /* __ARM_FEATURE_DSP */
+
+/**
+  * @brief  擬似乱数を取得する(LCG)
+  * @param  None
+  * @retval 乱数
+  */
+static int16_t dspRandom(void)
+{
+	u32s_DspRandom = (u32s_DspRandom * 1664525UL) + 1013904223UL;
+	return (int16_t)(u32s_DspRandom >> 16);
+}
+
+/**
+  * @brief  ベンチマーク入力を作成する
+  * @param  None
+  * @retval None
+  */
+static void dspSetupBench(void)
+{
+	uint16_t u16_N;
+	uint8_t u8_Stage;
+
+	for (u16_N=0; u16_N<DSP_BENCH_SIZE; u16_N++) {
+		q15s_DspIn[u16_N] = dspRandom();
+		q15s_DspIn2[u16_N] = dspRandom();
+	}
+	/* 係数の絶対値の総和が1.0未満となるようにする */
+	for (u16_N=0; u16_N<DSP_BENCH_TAPS; u16_N++) {
+		q15s_DspCoef[u16_N] = (q15_t)(dspRandom() / DSP_BENCH_TAPS);
+	}
+	/* Biquad係数(q14): 絶対値の総和が2.0未満 */
+	for (u8_Stage=0; u8_Stage<DSP_BENCH_STAGES; u8_Stage++) {
+		q15_t *pq15_C = &q15s_DspBiquadCoef[u8_Stage * DSP_BIQUAD_COEF_NUM];
+		pq15_C[0] = 3000;							// b0
+		pq15_C[1] = 0;
+		pq15_C[2] = 6000;							// b1
+		pq15_C[3] = 3000;							// b2
+		pq15_C[4] = 9000;							// a1
+		pq15_C[5] = -4000;							// a2
+	}
+	/* 浮動小数点カーネルは同じ入力・係数を実数に変換して使う */
+	for (u16_N=0; u16_N<DSP_BENCH_SIZE; u16_N++) {
+		f32s_DspIn[u16_N] = (float)q15s_DspIn[u16_N] / 32768.0f;
+	}
+	for (u16_N=0; u16_N<DSP_BENCH_TAPS; u16_N++) {
+		f32s_DspCoef[u16_N] = (float)q15s_DspCoef[u16_N] / 32768.0f;
+	}
+	for (u8_Stage=0; u8_Stage<DSP_BENCH_STAGES; u8_Stage++) {
+		const q15_t *pq15_C = &q15s_DspBiquadCoef[u8_Stage * DSP_BIQUAD_COEF_NUM];
+		float *pf32_C = &f32s_DspBiquadCoef[u8_Stage * DSP_BIQUAD_F32_COEF_NUM];
+		pf32_C[0] = (float)pq15_C[0] / 16384.0f;
+		pf32_C[1] = (float)pq15_C[2] / 16384.0f;
+		pf32_C[2] = (float)pq15_C[3] / 16384.0f;
+		pf32_C[3] = (float)pq15_C[4] / 16384.0f;
+		pf32_C[4] = (float)pq15_C[5] / 16384.0f;
+	}
+}
+
+/**
+  * @brief  カーネルを1回実行する
+  * @param  u8_Kernel: カーネル番号
+  * @param  bl_Ref: true=C参照実装, false=最適化版
+  * @retval スカラー出力(rms/peak)、その他は0
+  * @note   ベクター出力は q15s_DspOut に格納する
+  */
+static uint32_t dspRunKernel(uint8_t u8_Kernel, bool bl_Ref)
+{
+	DspFirQ15 st_Fir;
+	DspFirF32 st_FirF32;
+	DspMovAvgQ15 st_Avg;
+	uint32_t u32_RetValue = 0;
+
+	mem_set16((uint16_t *)q15s_DspOut, 0x0000, DSP_BENCH_SIZE);
+	switch (u8_Kernel) {
+	case DSP_BENCH_FIR_Q15:
+		dspFirInitQ15(&st_Fir, q15s_DspCoef, DSP_BENCH_TAPS, q15s_DspState, DSP_BENCH_SIZE);
+		(bl_Ref ? dspFirQ15Ref : dspFirQ15)(&st_Fir, q15s_DspIn, q15s_DspOut, DSP_BENCH_SIZE);
+		break;
+	case DSP_BENCH_BIQUAD_Q15:
+		mem_set16((uint16_t *)q15s_DspBiquadState, 0x0000, DSP_BENCH_STAGES * DSP_BIQUAD_STATE_NUM);
+		mem_cpy16((uint16_t *)q15s_DspOut, (const uint16_t *)q15s_DspIn, DSP_BENCH_SIZE);
+		(bl_Ref ? dspBiquadQ15Ref : dspBiquadQ15)(q15s_DspBiquadCoef, q15s_DspBiquadState, DSP_BENCH_STAGES, q15s_DspOut, DSP_BENCH_SIZE);
+		break;
+	case DSP_BENCH_MOVAVG_Q15:
+		dspMovAvgInitQ15(&st_Avg, q15s_DspAverage, 4);
+		(bl_Ref ? dspMovAvgQ15Ref : dspMovAvgQ15)(&st_Avg, q15s_DspIn, q15s_DspOut, DSP_BENCH_SIZE);
+		break;
+	case DSP_BENCH_DECIM_Q15:
+		dspFirInitQ15(&st_Fir, q15s_DspCoef, DSP_BENCH_TAPS, q15s_DspState, DSP_BENCH_SIZE);
+		(bl_Ref ? dspDecimateQ15Ref : dspDecimateQ15)(&st_Fir, DSP_BENCH_DECIM, q15s_DspIn, q15s_DspOut, DSP_BENCH_SIZE);
+		break;
+	case DSP_BENCH_RMS_Q15:
+		u32_RetValue = (uint16_t)(bl_Ref ? dspRmsQ15Ref : dspRmsQ15)(q15s_DspIn, DSP_BENCH_SIZE);
+		break;
+	case DSP_BENCH_PEAK_Q15:
+		u32_RetValue = (uint16_t)(bl_Ref ? dspPeakQ15Ref : dspPeakQ15)(q15s_DspIn, DSP_BENCH_SIZE);
+		break;
+	case DSP_BENCH_ADD_Q15:
+		(bl_Ref ? dspAddQ15Ref : dspAddQ15)(q15s_DspIn, q15s_DspIn2, q15s_DspOut, DSP_BENCH_SIZE);
+		break;
+	case DSP_BENCH_FIR_F32:
+		dspFirInitF32(&st_FirF32, f32s_DspCoef, DSP_BENCH_TAPS, f32s_DspState, DSP_BENCH_SIZE);
+		dspFirF32(&st_FirF32, f32s_DspIn, f32s_DspOut, DSP_BENCH_SIZE);
+		break;
+	case DSP_BENCH_BIQUAD_F32:
+		mem_set32((uint32_t *)f32s_DspBiquadState, 0x00000000, DSP_BENCH_STAGES * DSP_BIQUAD_STATE_NUM);
+		mem_cpy32((uint32_t *)f32s_DspOut, (const uint32_t *)f32s_DspIn, DSP_BENCH_SIZE);
+		dspBiquadF32(f32s_DspBiquadCoef, f32s_DspBiquadState, DSP_BENCH_STAGES, f32s_DspOut, DSP_BENCH_SIZE);
+		break;
+	case DSP_BENCH_MAG_F32:
+		/* 入力を{re, im}の組として扱う */
+		dspMagF32(f32s_DspIn, f32s_DspOut, DSP_BENCH_SIZE / 2);
+		break;
+	default:
+		break;
+	}
+	return u32_RetValue;
+}
+
+/**
+  * @brief  1サンプルあたりのサイクル数を計測する
+  * @param  u8_Kernel: カーネル番号
+  * @param  bl_Ref: true=C参照実装, false=最適化版
+  * @retval 1サンプルあたりのサイクル数(×100)
+  */
+static uint32_t dspMeasureKernel(uint8_t u8_Kernel, bool bl_Ref)
+{
+	uint8_t u8_Repeat;
+	uint32_t u32_Start;
+	uint32_t u32_Cycle;
+	uint32_t u32_Min = 0xFFFFFFFF;
+
+	for (u8_Repeat=0; u8_Repeat<DSP_BENCH_REPEAT; u8_Repeat++) {
+		u32_Start = LL_DWT_GetCycle();
+		dspRunKernel(u8_Kernel, bl_Ref);
+		u32_Cycle = LL_DWT_GetCycle() - u32_Start;
+		if (u32_Cycle < u32_Min) {
+			u32_Min = u32_Cycle;
+		}
+	}
+	return (u32_Min * 100) / DSP_BENCH_SIZE;
+}
@@ -7,8 +7,11 @@
 
 .syntax unified
 .cpu cortex-m4
-.fpu softvfp
+.fpu fpv4-sp-d16
 .thumb
+@ 整数引数のみのため、ソフトウェア/ハードウェア浮動小数点ABIの両方とリンク可能とする
+@ (Tag_ABI_VFP_args = 3: base/VFP variant 両対応)
+.eabi_attribute 28, 3
 
 /* Includes ------------------------------------------------------------------*/
 
@@ -0,0 +1,965 @@
+/**
+  ******************************************************************************
+  * @file           : lib_mon.c
+  * @brief          : モニター シェル
+  ******************************************************************************
+  * @note   UARTから1行ずつ命令を受け付け、メモリの読み書き/フィル、周辺レジスター
+  *         ブロックのダンプ、統計情報と割り込み遅延の表示を行う(数値は16進数, 0x省略可)。
+  *         出力は周期毎にmonRun()から送信Queueの空きに収まる行だけを登録し、
+  *         長いダンプも周期処理を止めずに通信速度で流す(キー入力で中断)。
+  *         ダンプの1行はuartEchoDump()で作成し、送信Queueへ一度に登録する。
+  *         アドレスは確認しないため、存在しない領域へのアクセスはバスエラーになる。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "drv.h"
+#include "lib.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* 命令 */
+typedef struct _MonCommand {
+	const char *pc_name;							/* 命令名					*/
+	void (*pf_func)(uint8_t u8_Width, uint8_t u8_Argc, char **ppc_Argv);	/* 実行関数(幅0:指定なし)	*/
+	const char *pc_help;							/* ヘルプ表示				*/
+} MonCommand;
+
+/* 周辺レジスターブロック */
+typedef struct _MonRegBlock {
+	const char *pc_name;							/* ブロック名				*/
+	const volatile void *pv_base;					/* 先頭アドレス				*/
+	uint32_t u32_size;								/* サイズ[byte]				*/
+	uint8_t u8_width;								/* 読み出し幅[byte]			*/
+} MonRegBlock;
+
+/* Private define ------------------------------------------------------------*/
+#define MON_INPUT_SIZE		(48)					/* 入力行の最大文字数		*/
+#define MON_ARG_MAX			(4)						/* 引数の最大数(命令名を含む)	*/
+#define MON_DUMP_DEFAULT	(0x40)					/* ダンプの既定サイズ[byte]	*/
+
+/* 出力中の処理 */
+#define MON_JOB_NONE		(0)						/* なし(プロンプト表示済み)	*/
+#define MON_JOB_PROMPT		(1)						/* プロンプト表示待ち		*/
+#define MON_JOB_DUMP		(2)						/* ダンプ					*/
+#define MON_JOB_HELP		(3)						/* 命令一覧表示				*/
+#define MON_JOB_REG_LIST	(4)						/* レジスターブロック一覧表示	*/
+#define MON_JOB_STAT		(5)						/* 統計情報表示				*/
+#define MON_JOB_LAT			(6)						/* 割り込み遅延表示			*/
+
+/* 統計情報の表示行 */
+#define MON_STAT_CORO		(0)						/* コルーチン				*/
+#define MON_STAT_POOL		(1)						/* メモリプール(クラス数分)	*/
+#define MON_STAT_STACK		(MON_STAT_POOL + POOL_CLASS_NUM)	/* スタック(コンテキスト数分)	*/
+#define MON_STAT_UART		(MON_STAT_STACK + STACK_CTX_NUM)	/* UART/ダンプ		*/
+#define MON_STAT_NUM		(MON_STAT_UART + 1)
+
+/* 周辺レジスターブロック数(mon_reg_get) */
+#define MON_REG_NUM			(16)
+
+/* Private macro -------------------------------------------------------------*/
+#define MON_COMMAND_NUM		(sizeof(sts_MonCommand) / sizeof(sts_MonCommand[0]))
+
+/* Private variables ---------------------------------------------------------*/
+static bool bls_MonActive;							/* モニター動作中			*/
+static char cs_MonInput[MON_INPUT_SIZE];			/* 入力行					*/
+static uint8_t u8s_MonInputLen;						/* 入力行の文字数			*/
+static bool bls_MonLastCr;							/* 直前の入力がCR			*/
+static char cs_MonOut[UART_DUMP_LINE_MAX];			/* 出力行					*/
+static uint8_t u8s_MonOutLen;						/* 出力行の文字数			*/
+static bool bls_MonOutPending;						/* 出力行の送信待ち			*/
+static uint8_t u8s_MonJob;							/* 出力中の処理(MON_JOB_xxx)	*/
+static uint8_t u8s_MonJobIndex;						/* 出力中の行				*/
+static uintptr_t u32s_MonDumpAddr;					/* ダンプの次のアドレス		*/
+static uint32_t u32s_MonDumpRemain;					/* ダンプの残りサイズ[byte]	*/
+static uint8_t u8s_MonDumpWidth;					/* ダンプの読み出し幅[byte]	*/
+static uint32_t u32s_MonDumpBytes;					/* ダンプした総サイズ[byte]	*/
+static uint32_t u32s_MonDumpWaits;					/* 送信Queueの空き待ち回数	*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void mon_execute(void);						/* 入力行を実行する			*/
+static void mon_job_step(void);						/* 出力中の処理を1行進める	*/
+static bool mon_dump_line(void);					/* ダンプを1行登録する		*/
+static void mon_dump_start(uintptr_t u32_Addr, uint32_t u32_Size, uint8_t u8_Width);	/* ダンプを開始する	*/
+static bool mon_reg_get(uint8_t u8_Index, MonRegBlock *pst_Block);	/* レジスターブロックを取得する	*/
+static bool mon_parse_hex(const char *pc_Str, uint32_t *pu32_Value);	/* 16進数を解析する	*/
+static bool mon_parse_addr(const char *pc_Str, uint8_t u8_Width, uintptr_t *pu32_Addr);	/* アドレスを解析する	*/
+static bool mon_str_equal(const char *pc_Str1, const char *pc_Str2);	/* 文字列を比較する(大小文字区別なし)	*/
+static void mon_out_str(const char *pc_Str);		/* 出力行に文字列を追加する	*/
+static void mon_out_hex(uint32_t u32_Value, uint8_t u8_Digits);	/* 出力行に16進数を追加する	*/
+static void mon_out_dec(uint32_t u32_Value);		/* 出力行に10進数を追加する	*/
+static void mon_out_line(void);						/* 出力行を確定する(改行付き)	*/
+static void mon_error(const char *pc_Msg);			/* エラーを表示する			*/
+static void mon_cmd_help(uint8_t u8_Width, uint8_t u8_Argc, char **ppc_Argv);	/* help: 命令一覧	*/
+static void mon_cmd_md(uint8_t u8_Width, uint8_t u8_Argc, char **ppc_Argv);	/* md: メモリダンプ		*/
+static void mon_cmd_mr(uint8_t u8_Width, uint8_t u8_Argc, char **ppc_Argv);	/* mr: メモリ読み出し	*/
+static void mon_cmd_mw(uint8_t u8_Width, uint8_t u8_Argc, char **ppc_Argv);	/* mw: メモリ書き込み	*/
+static void mon_cmd_mf(uint8_t u8_Width, uint8_t u8_Argc, char **ppc_Argv);	/* mf: メモリフィル		*/
+static void mon_cmd_reg(uint8_t u8_Width, uint8_t u8_Argc, char **ppc_Argv);	/* reg: レジスターダンプ	*/
+static void mon_cmd_stat(uint8_t u8_Width, uint8_t u8_Argc, char **ppc_Argv);	/* stat: 統計情報		*/
+static void mon_cmd_lat(uint8_t u8_Width, uint8_t u8_Argc, char **ppc_Argv);	/* lat: 割り込み遅延	*/
+static void mon_cmd_exit(uint8_t u8_Width, uint8_t u8_Argc, char **ppc_Argv);	/* exit: 終了			*/
+
+/* 命令一覧(幅は命令名に.b/.h/.wを付けて指定する) */
+static const MonCommand sts_MonCommand[] = {
+	{"help",	mon_cmd_help,	"help                        command list"},
+	{"md",		mon_cmd_md,		"md[.b|.h|.w] addr [size]    memory dump (default .b 40)"},
+	{"mr",		mon_cmd_mr,		"mr[.b|.h|.w] addr           memory read (default .w)"},
+	{"mw",		mon_cmd_mw,		"mw[.b|.h|.w] addr value     memory write (default .w)"},
+	{"mf",		mon_cmd_mf,		"mf[.b|.h|.w] addr size value memory fill (default .b)"},
+	{"reg",		mon_cmd_reg,	"reg [name]                  register block dump/list"},
+	{"stat",	mon_cmd_stat,	"stat                        statistics"},
+	{"lat",		mon_cmd_lat,	"lat [start|stop|clear]      irq latency [cycles]"},
+	{"exit",	mon_cmd_exit,	"exit                        leave monitor"},
+};
+
+/* 読み出し幅の表示名(1/2/4byte) */
+static const char *const pcs_MonWidthName[5] = {
+	"", ".b", ".h", "", ".w"
+};
+
+/* スタックのコンテキスト名 */
+static const char *const pcs_MonStackName[STACK_CTX_NUM] = {
+	"main", "isr"
+};
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  モニター初期化処理
+  * @param  None
+  * @retval None
+  */
+void monInit(void)
+{
+	bls_MonActive = false;
+	u8s_MonInputLen = 0;
+	bls_MonLastCr = false;
+	u8s_MonOutLen = 0;
+	bls_MonOutPending = false;
+	u8s_MonJob = MON_JOB_NONE;
+	u32s_MonDumpBytes = 0;
+	u32s_MonDumpWaits = 0;
+}
+
+/**
+  * @brief  モニターを開始する
+  * @param  None
+  * @retval None
+  * @note   以降の受信データはmonInput()に渡す(exit命令で終了する)
+  */
+void monStart(void)
+{
+	bls_MonActive = true;
+	u8s_MonInputLen = 0;
+	bls_MonLastCr = false;
+	uartEchoStrln("");
+	mon_out_str("Monitor (help: command list, exit: leave)");
+	mon_out_line();
+	u8s_MonJob = MON_JOB_PROMPT;
+}
+
+/**
+  * @brief  モニターの動作状態を取得する
+  * @param  None
+  * @retval true:動作中 / false:停止
+  */
+bool monIsActive(void)
+{
+	return bls_MonActive;
+}
+
+/**
+  * @brief  受信データを入力する
+  * @param  pu8_Data: 受信データ
+  * @param  u16_Size: 受信データのサイズ
+  * @retval None
+  * @note   出力中のキー入力は出力を中断する。BS/DELで1文字消去し、CR/LFで実行する
+  */
+void monInput(const uint8_t *pu8_Data, uint16_t u16_Size)
+{
+	uint8_t u8_Char;
+	uint16_t _i;
+
+	for (_i=0; _i<u16_Size; _i++) {
+		u8_Char = pu8_Data[_i];
+		/* 出力中の処理を中断する(入力は捨てる) */
+		if ((u8s_MonJob != MON_JOB_NONE) && (u8s_MonJob != MON_JOB_PROMPT)) {
+			u8s_MonJob = MON_JOB_PROMPT;
+			u8s_MonOutLen = 0;
+			mon_out_str("^C");
+			mon_out_line();
+			return;
+		}
+		if ((u8_Char == '\r') || (u8_Char == '\n')) {
+			/* CR+LFは1回だけ実行する */
+			if ((u8_Char == '\n') && bls_MonLastCr) {
+				bls_MonLastCr = false;
+				continue;
+			}
+			bls_MonLastCr = (u8_Char == '\r');
+			(void)uartSetTxData((const uint8_t *)"\r\n", 2);
+			mon_execute();
+			/* 同じ受信データの残りは捨てる(exitで終了した場合を含む) */
+			return;
+		}
+		bls_MonLastCr = false;
+		if ((u8_Char == 0x08) || (u8_Char == 0x7F)) {
+			/* 1文字消去する */
+			if (u8s_MonInputLen > 0) {
+				u8s_MonInputLen--;
+				(void)uartSetTxData((const uint8_t *)"\b \b", 3);
+			}
+		}
+		else if ((u8_Char >= 0x20) && (u8_Char < 0x7F) && (u8s_MonInputLen < (MON_INPUT_SIZE - 1))) {
+			cs_MonInput[u8s_MonInputLen++] = (char)u8_Char;
+			(void)uartSetTxData(&u8_Char, 1);
+		}
+	}
+}
+
+/**
+  * @brief  モニターの出力を進める(周期毎に1回呼び出す)
+  * @param  None
+  * @retval None
+  * @note   送信Queueの空きに収まる行だけを登録し、残りは次の周期に回す
+  */
+void monRun(void)
+{
+	while (true) {
+		/* 作成済みの行を送信する */
+		if (bls_MonOutPending) {
+			if (uartGetTxFree() < u8s_MonOutLen) {
+				return;
+			}
+			(void)uartSetTxData((const uint8_t *)&cs_MonOut[0], u8s_MonOutLen);
+			bls_MonOutPending = false;
+			u8s_MonOutLen = 0;
+		}
+		switch (u8s_MonJob) {
+		case MON_JOB_NONE:
+			return;
+		case MON_JOB_PROMPT:
+			u8s_MonJob = MON_JOB_NONE;
+			if (bls_MonActive) {
+				mon_out_str("> ");
+				bls_MonOutPending = true;
+			}
+			break;
+		case MON_JOB_DUMP:
+			/* 1行ずつ直接登録する(空きが無ければ次の周期) */
+			if (u32s_MonDumpRemain == 0) {
+				u8s_MonJob = MON_JOB_PROMPT;
+			}
+			else if (!mon_dump_line()) {
+				u32s_MonDumpWaits++;
+				return;
+			}
+			break;
+		default:
+			mon_job_step();
+			break;
+		}
+	}
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  入力行を実行する
+  * @param  None
+  * @retval None
+  * @note   空白で区切り、命令名の.b/.h/.wを読み出し幅とする
+  */
+static void mon_execute(void)
+{
+	char *pc_Argv[MON_ARG_MAX];
+	uint8_t u8_Argc = 0;
+	uint8_t u8_Width = 0;
+	char *pc_Pos;
+	uint8_t _i;
+
+	cs_MonInput[u8s_MonInputLen] = '\0';
+	u8s_MonInputLen = 0;
+	u8s_MonJob = MON_JOB_PROMPT;
+
+	/* 引数に分ける */
+	pc_Pos = &cs_MonInput[0];
+	while (*pc_Pos != '\0') {
+		if (*pc_Pos == ' ') {
+			*pc_Pos++ = '\0';
+			continue;
+		}
+		if (u8_Argc >= MON_ARG_MAX) {
+			mon_error("too many arguments");
+			return;
+		}
+		pc_Argv[u8_Argc++] = pc_Pos;
+		while ((*pc_Pos != '\0') && (*pc_Pos != ' ')) {
+			pc_Pos++;
+		}
+	}
+	if (u8_Argc == 0) {
+		return;
+	}
+
+	/* 読み出し幅 */
+	for (pc_Pos = pc_Argv[0]; *pc_Pos != '\0'; pc_Pos++) {
+		if (*pc_Pos != '.') {
+			continue;
+		}
+		*pc_Pos = '\0';
+		if (mon_str_equal(pc_Pos + 1, "b")) {
+			u8_Width = 1;
+		}
+		else if (mon_str_equal(pc_Pos + 1, "h")) {
+			u8_Width = 2;
+		}
+		else if (mon_str_equal(pc_Pos + 1, "w")) {
+			u8_Width = 4;
+		}
+		else {
+			mon_error("width must be .b/.h/.w");
+			return;
+		}
+		break;
+	}
+
+	for (_i=0; _i<MON_COMMAND_NUM; _i++) {
+		if (mon_str_equal(pc_Argv[0], sts_MonCommand[_i].pc_name)) {
+			sts_MonCommand[_i].pf_func(u8_Width, u8_Argc, &pc_Argv[0]);
+			return;
+		}
+	}
+	mon_error("unknown command (help: command list)");
+}
+
+/**
+  * @brief  出力中の処理を1行進める
+  * @param  None
+  * @retval None
+  * @note   1行を出力行に作成する。最後の行の次でプロンプト表示待ちにする
+  */
+static void mon_job_step(void)
+{
+	MonRegBlock st_Block;
+	PoolStatistics st_Pool;
+	CoroStatistics st_Coro;
+	StackUsage st_Stack;
+	LatResult st_Lat;
+	uint8_t u8_Index = u8s_MonJobIndex++;
+
+	switch (u8s_MonJob) {
+	case MON_JOB_HELP:
+		if (u8_Index >= MON_COMMAND_NUM) {
+			break;
+		}
+		mon_out_str("  ");
+		mon_out_str(sts_MonCommand[u8_Index].pc_help);
+		mon_out_line();
+		return;
+	case MON_JOB_REG_LIST:
+		if (!mon_reg_get(u8_Index, &st_Block)) {
+			break;
+		}
+		mon_out_str("  ");
+		mon_out_str(st_Block.pc_name);
+		while (u8s_MonOutLen < 10) {
+			mon_out_str(" ");
+		}
+		mon_out_hex((uint32_t)(uintptr_t)st_Block.pv_base, 8);
+		mon_out_str(" size=");
+		mon_out_hex(st_Block.u32_size, 4);
+		mon_out_str(" ");
+		mon_out_str(pcs_MonWidthName[st_Block.u8_width]);
+		mon_out_line();
+		return;
+	case MON_JOB_STAT:
+		if (u8_Index == MON_STAT_CORO) {
+			coroGetStatistics(&st_Coro);
+			mon_out_str("coro   active=");
+			mon_out_dec(st_Coro.u8_active);
+			mon_out_str(" high=");
+			mon_out_dec(st_Coro.u8_high_water);
+			mon_out_str(" resume=");
+			mon_out_dec(st_Coro.u32_resume);
+			mon_out_str(" check=");
+			mon_out_dec(st_Coro.u32_check);
+		}
+		else if (u8_Index < MON_STAT_STACK) {
+			(void)poolGetStatistics(u8_Index - MON_STAT_POOL, &st_Pool);
+			mon_out_str("pool");
+			mon_out_dec(st_Pool.u16_block_size);
+			mon_out_str(" used=");
+			mon_out_dec(st_Pool.u16_used);
+			mon_out_str("/");
+			mon_out_dec(st_Pool.u16_block_num);
+			mon_out_str(" high=");
+			mon_out_dec(st_Pool.u16_high_water);
+			mon_out_str(" alloc=");
+			mon_out_dec(st_Pool.u32_alloc_count);
+			mon_out_str(" fail=");
+			mon_out_dec(st_Pool.u32_fail_count);
+		}
+		else if (u8_Index < MON_STAT_UART) {
+			(void)stackGetUsage(u8_Index - MON_STAT_STACK, &st_Stack);
+			mon_out_str("stack  ");
+			mon_out_str(pcs_MonStackName[u8_Index - MON_STAT_STACK]);
+			mon_out_str(" peak=");
+			mon_out_dec(st_Stack.u32_peak);
+			mon_out_str("/");
+			mon_out_dec(st_Stack.u32_size);
+		}
+		else if (u8_Index == MON_STAT_UART) {
+			mon_out_str("uart   tx_free=");
+			mon_out_dec(uartGetTxFree());
+			mon_out_str(" rx=");
+			mon_out_dec(uartGetRxCount());
+			mon_out_str(" dump=");
+			mon_out_dec(u32s_MonDumpBytes);
+			mon_out_str(" waits=");
+			mon_out_dec(u32s_MonDumpWaits);
+		}
+		else {
+			break;
+		}
+		mon_out_line();
+		return;
+	case MON_JOB_LAT:
+		if (u8_Index == 0) {
+			mon_out_str(latIsRunning() ? "lat    running" : "lat    stopped");
+			mon_out_str(" cpu=");
+			mon_out_dec(SystemCoreClock / 1000000);
+			mon_out_str("MHz");
+		}
+		else if (latGetResult(u8_Index - 1, &st_Lat) == OK) {
+			mon_out_str("  ");
+			mon_out_str(st_Lat.pc_name);
+			mon_out_str(" n=");
+			mon_out_dec(st_Lat.u32_count);
+			mon_out_str(" miss=");
+			mon_out_dec(st_Lat.u32_missed);
+			mon_out_str(" min=");
+			mon_out_dec(st_Lat.u32_min);
+			mon_out_str(" p50=");
+			mon_out_dec(st_Lat.u32_p50);
+			mon_out_str(" p99=");
+			mon_out_dec(st_Lat.u32_p99);
+			mon_out_str(" max=");
+			mon_out_dec(st_Lat.u32_max);
+			mon_out_str(" jit=");
+			mon_out_dec(st_Lat.u32_max - st_Lat.u32_min);
+		}
+		else {
+			break;
+		}
+		mon_out_line();
+		return;
+	default:
+		break;
+	}
+	u8s_MonJob = MON_JOB_PROMPT;
+}
+
+/**
+  * @brief  ダンプを1行登録する
+  * @param  None
+  * @retval true:登録した / false:送信Queueの空き不足
+  */
+static bool mon_dump_line(void)
+{
+	uint8_t u8_Size = UART_DUMP_BYTES;
+
+	if (u32s_MonDumpRemain < UART_DUMP_BYTES) {
+		u8_Size = (uint8_t)u32s_MonDumpRemain;
+	}
+	if (uartEchoDump((const volatile void *)u32s_MonDumpAddr, u8_Size, u8s_MonDumpWidth) != OK) {
+		return false;
+	}
+	u32s_MonDumpAddr += u8_Size;
+	u32s_MonDumpRemain -= u8_Size;
+	u32s_MonDumpBytes += u8_Size;
+	return true;
+}
+
+/**
+  * @brief  ダンプを開始する
+  * @param  u32_Addr: 先頭アドレス
+  * @param  u32_Size: サイズ[byte](幅の倍数に切り上げる)
+  * @param  u8_Width: 読み出し幅[byte]
+  * @retval None
+  */
+static void mon_dump_start(uintptr_t u32_Addr, uint32_t u32_Size, uint8_t u8_Width)
+{
+	u32s_MonDumpAddr = u32_Addr;
+	u32s_MonDumpRemain = (u32_Size + u8_Width - 1) & ~(uint32_t)(u8_Width - 1);
+	u8s_MonDumpWidth = u8_Width;
+	u8s_MonJob = MON_JOB_DUMP;
+}
+
+/**
+  * @brief  周辺レジスターブロックを取得する
+  * @param  u8_Index: ブロック番号
+  * @param  pst_Block: ブロック情報の格納先
+  * @retval true:取得した / false:番号が範囲外
+  * @note   読み出し幅はブロック内の主なレジスターの幅に合わせる。
+  *         読み出しで状態が変わるレジスター(SCIのRDR等)を含むことに注意
+  */
+static bool mon_reg_get(uint8_t u8_Index, MonRegBlock *pst_Block)
+{
+	const MonRegBlock st_Block[MON_REG_NUM] = {
+		{"SYSTEM",	R_SYSTEM,	sizeof(*R_SYSTEM),	1},
+		{"MSTP",	R_MSTP,		sizeof(*R_MSTP),	4},
+		{"ICU",		R_ICU,		sizeof(*R_ICU),		4},
+		{"DTC",		R_DTC,		sizeof(*R_DTC),		4},
+		{"ELC",		R_ELC,		sizeof(*R_ELC),		1},
+		{"PORT0",	R_PORT0,	sizeof(*R_PORT0),	4},
+		{"PORT1",	R_PORT1,	sizeof(*R_PORT1),	4},
+		{"PFS",		R_PFS,		sizeof(*R_PFS),		4},
+		{"SCI1",	R_SCI1,		sizeof(*R_SCI1),	1},
+		{"GPT5",	R_GPT5,		sizeof(*R_GPT5),	4},
+		{"ADC0",	R_ADC0,		sizeof(*R_ADC0),	2},
+		{"IIC1",	R_IIC1,		sizeof(*R_IIC1),	1},
+		{"SPI0",	R_SPI0,		sizeof(*R_SPI0),	1},
+		{"CAN0",	R_CAN0,		sizeof(*R_CAN0),	4},
+		{"USBFS",	R_USB_FS0,	sizeof(*R_USB_FS0),	2},
+		{"WDT",		R_WDT,		sizeof(*R_WDT),		1},
+	};
+
+	if (u8_Index >= MON_REG_NUM) {
+		return false;
+	}
+	*pst_Block = st_Block[u8_Index];
+	return true;
+}
+
+/**
+  * @brief  16進数を解析する
+  * @param  pc_Str: 文字列(0x省略可)
+  * @param  pu32_Value: 値の格納先
+  * @retval true:成功 / false:16進数でない
+  */
+static bool mon_parse_hex(const char *pc_Str, uint32_t *pu32_Value)
+{
+	uint32_t u32_Value = 0;
+	uint8_t u8_Digits = 0;
+	char c_Char;
+
+	if ((pc_Str[0] == '0') && ((pc_Str[1] == 'x') || (pc_Str[1] == 'X'))) {
+		pc_Str += 2;
+	}
+	while ((c_Char = *pc_Str++) != '\0') {
+		if ((c_Char >= '0') && (c_Char <= '9')) {
+			c_Char -= '0';
+		}
+		else if ((c_Char >= 'a') && (c_Char <= 'f')) {
+			c_Char -= 'a' - 10;
+		}
+		else if ((c_Char >= 'A') && (c_Char <= 'F')) {
+			c_Char -= 'A' - 10;
+		}
+		else {
+			return false;
+		}
+		if (++u8_Digits > 8) {
+			return false;
+		}
+		u32_Value = (u32_Value << 4) | (uint32_t)c_Char;
+	}
+	*pu32_Value = u32_Value;
+	return (u8_Digits > 0);
+}
+
+/**
+  * @brief  アドレスを解析する
+  * @param  pc_Str: 文字列
+  * @param  u8_Width: アクセス幅[byte]
+  * @param  pu32_Addr: アドレスの格納先
+  * @retval true:成功 / false:16進数でない,幅に揃っていない(エラー表示済み)
+  */
+static bool mon_parse_addr(const char *pc_Str, uint8_t u8_Width, uintptr_t *pu32_Addr)
+{
+	uint32_t u32_Addr;
+
+	if (!mon_parse_hex(pc_Str, &u32_Addr)) {
+		mon_error("bad address");
+		return false;
+	}
+	if ((u32_Addr % u8_Width) != 0) {
+		mon_error("address not aligned to width");
+		return false;
+	}
+	*pu32_Addr = (uintptr_t)u32_Addr;
+	return true;
+}
+
+/**
+  * @brief  文字列を比較する(大小文字区別なし)
+  * @param  pc_Str1: 文字列1
+  * @param  pc_Str2: 文字列2
+  * @retval true:一致 / false:不一致
+  */
+static bool mon_str_equal(const char *pc_Str1, const char *pc_Str2)
+{
+	char c_Char1;
+	char c_Char2;
+
+	do {
+		c_Char1 = *pc_Str1++;
+		c_Char2 = *pc_Str2++;
+		if ((c_Char1 >= 'a') && (c_Char1 <= 'z')) {
+			c_Char1 -= 'a' - 'A';
+		}
+		if ((c_Char2 >= 'a') && (c_Char2 <= 'z')) {
+			c_Char2 -= 'a' - 'A';
+		}
+		if (c_Char1 != c_Char2) {
+			return false;
+		}
+	} while (c_Char1 != '\0');
+	return true;
+}
+
+/**
+  * @brief  出力行に文字列を追加する
+  * @param  pc_Str: 文字列
+  * @retval None
+  * @note   行に収まらない分は切り捨てる(改行の領域は残す)
+  */
+static void mon_out_str(const char *pc_Str)
+{
+	while ((*pc_Str != '\0') && (u8s_MonOutLen < (UART_DUMP_LINE_MAX - 2))) {
+		cs_MonOut[u8s_MonOutLen++] = *pc_Str++;
+	}
+}
+
+/**
+  * @brief  出力行に16進数を追加する
+  * @param  u32_Value: 値
+  * @param  u8_Digits: 桁数(1～8)
+  * @retval None
+  */
+static void mon_out_hex(uint32_t u32_Value, uint8_t u8_Digits)
+{
+	static const char c_Hex[] = "0123456789ABCDEF";
+	char c_Digit[9];
+	uint8_t _i;
+
+	for (_i=u8_Digits; _i>0; _i--) {
+		c_Digit[_i - 1] = c_Hex[u32_Value & 0x0F];
+		u32_Value >>= 4;
+	}
+	c_Digit[u8_Digits] = '\0';
+	mon_out_str(&c_Digit[0]);
+}
+
+/**
+  * @brief  出力行に10進数を追加する
+  * @param  u32_Value: 値
+  * @retval None
+  */
+static void mon_out_dec(uint32_t u32_Value)
+{
+	char c_Digit[11];
+	uint8_t u8_Pos = sizeof(c_Digit) - 1;
+
+	c_Digit[u8_Pos] = '\0';
+	do {
+		c_Digit[--u8_Pos] = (char)('0' + (u32_Value % 10));
+		u32_Value /= 10;
+	} while (u32_Value != 0);
+	mon_out_str(&c_Digit[u8_Pos]);
+}
+
+/**
+  * @brief  出力行を確定する(改行付き)
+  * @param  None
+  * @retval None
+  * @note   monRun()が送信Queueの空きを待って登録する
+  */
+static void mon_out_line(void)
+{
+	cs_MonOut[u8s_MonOutLen++] = '\r';
+	cs_MonOut[u8s_MonOutLen++] = '\n';
+	bls_MonOutPending = true;
+}
+
+/**
+  * @brief  エラーを表示する
+  * @param  pc_Msg: メッセージ
+  * @retval None
+  */
+static void mon_error(const char *pc_Msg)
+{
+	mon_out_str("error: ");
+	mon_out_str(pc_Msg);
+	mon_out_line();
+	u8s_MonJob = MON_JOB_PROMPT;
+}
+
+/**
+  * @brief  help: 命令一覧
+  * @param  u8_Width: 読み出し幅(未使用)
+  * @param  u8_Argc: 引数の数
+  * @param  ppc_Argv: 引数
+  * @retval None
+  */
+static void mon_cmd_help(uint8_t u8_Width, uint8_t u8_Argc, char **ppc_Argv)
+{
+	(void)u8_Width;
+	(void)u8_Argc;
+	(void)ppc_Argv;
+	u8s_MonJob = MON_JOB_HELP;
+	u8s_MonJobIndex = 0;
+}
+
+/**
+  * @brief  md: メモリダンプ
+  * @param  u8_Width: 読み出し幅(0:1byte)
+  * @param  u8_Argc: 引数の数
+  * @param  ppc_Argv: 引数(アドレス [サイズ])
+  * @retval None
+  */
+static void mon_cmd_md(uint8_t u8_Width, uint8_t u8_Argc, char **ppc_Argv)
+{
+	uintptr_t u32_Addr;
+	uint32_t u32_Size = MON_DUMP_DEFAULT;
+
+	if (u8_Width == 0) {
+		u8_Width = 1;
+	}
+	if (u8_Argc < 2) {
+		mon_error("md addr [size]");
+		return;
+	}
+	if (!mon_parse_addr(ppc_Argv[1], u8_Width, &u32_Addr)) {
+		return;
+	}
+	if ((u8_Argc > 2) && (!mon_parse_hex(ppc_Argv[2], &u32_Size) || (u32_Size == 0))) {
+		mon_error("bad size");
+		return;
+	}
+	mon_dump_start(u32_Addr, u32_Size, u8_Width);
+}
+
+/**
+  * @brief  mr: メモリ読み出し
+  * @param  u8_Width: 読み出し幅(0:4byte)
+  * @param  u8_Argc: 引数の数
+  * @param  ppc_Argv: 引数(アドレス)
+  * @retval None
+  */
+static void mon_cmd_mr(uint8_t u8_Width, uint8_t u8_Argc, char **ppc_Argv)
+{
+	uintptr_t u32_Addr;
+	uint32_t u32_Value;
+
+	if (u8_Width == 0) {
+		u8_Width = 4;
+	}
+	if (u8_Argc < 2) {
+		mon_error("mr addr");
+		return;
+	}
+	if (!mon_parse_addr(ppc_Argv[1], u8_Width, &u32_Addr)) {
+		return;
+	}
+	if (u8_Width == 4) {
+		u32_Value = *(volatile uint32_t *)u32_Addr;
+	}
+	else if (u8_Width == 2) {
+		u32_Value = *(volatile uint16_t *)u32_Addr;
+	}
+	else {
+		u32_Value = *(volatile uint8_t *)u32_Addr;
+	}
+	mon_out_hex((uint32_t)u32_Addr, 8);
+	mon_out_str(" = ");
+	mon_out_hex(u32_Value, u8_Width * 2);
+	mon_out_line();
+}
+
+/**
+  * @brief  mw: メモリ書き込み
+  * @param  u8_Width: 書き込み幅(0:4byte)
+  * @param  u8_Argc: 引数の数
+  * @param  ppc_Argv: 引数(アドレス 値)
+  * @retval None
+  */
+static void mon_cmd_mw(uint8_t u8_Width, uint8_t u8_Argc, char **ppc_Argv)
+{
+	uintptr_t u32_Addr;
+	uint32_t u32_Value;
+
+	if (u8_Width == 0) {
+		u8_Width = 4;
+	}
+	if (u8_Argc < 3) {
+		mon_error("mw addr value");
+		return;
+	}
+	if (!mon_parse_addr(ppc_Argv[1], u8_Width, &u32_Addr)) {
+		return;
+	}
+	if (!mon_parse_hex(ppc_Argv[2], &u32_Value)) {
+		mon_error("bad value");
+		return;
+	}
+	if (u8_Width == 4) {
+		*(volatile uint32_t *)u32_Addr = u32_Value;
+	}
+	else if (u8_Width == 2) {
+		*(volatile uint16_t *)u32_Addr = (uint16_t)u32_Value;
+	}
+	else {
+		*(volatile uint8_t *)u32_Addr = (uint8_t)u32_Value;
+	}
+}
+
+/**
+  * @brief  mf: メモリフィル
+  * @param  u8_Width: 書き込み幅(0:1byte)
+  * @param  u8_Argc: 引数の数
+  * @param  ppc_Argv: 引数(アドレス サイズ 値)
+  * @retval None
+  * @note   その周期の中で書き込みを終える(SRAM全体でも1ms未満)
+  */
+static void mon_cmd_mf(uint8_t u8_Width, uint8_t u8_Argc, char **ppc_Argv)
+{
+	uintptr_t u32_Addr;
+	uint32_t u32_Size;
+	uint32_t u32_Value;
+	uint32_t _i;
+
+	if (u8_Width == 0) {
+		u8_Width = 1;
+	}
+	if (u8_Argc < 4) {
+		mon_error("mf addr size value");
+		return;
+	}
+	if (!mon_parse_addr(ppc_Argv[1], u8_Width, &u32_Addr)) {
+		return;
+	}
+	if (!mon_parse_hex(ppc_Argv[2], &u32_Size) || ((u32_Size % u8_Width) != 0)) {
+		mon_error("bad size");
+		return;
+	}
+	if (!mon_parse_hex(ppc_Argv[3], &u32_Value)) {
+		mon_error("bad value");
+		return;
+	}
+	for (_i=0; _i<u32_Size; _i+=u8_Width) {
+		if (u8_Width == 4) {
+			*(volatile uint32_t *)(u32_Addr + _i) = u32_Value;
+		}
+		else if (u8_Width == 2) {
+			*(volatile uint16_t *)(u32_Addr + _i) = (uint16_t)u32_Value;
+		}
+		else {
+			*(volatile uint8_t *)(u32_Addr + _i) = (uint8_t)u32_Value;
+		}
+	}
+}
+
+/**
+  * @brief  reg: レジスターダンプ
+  * @param  u8_Width: 読み出し幅(0:ブロックの既定値)
+  * @param  u8_Argc: 引数の数
+  * @param  ppc_Argv: 引数([ブロック名])
+  * @retval None
+  * @note   ブロック名を省略すると一覧を表示する
+  */
+static void mon_cmd_reg(uint8_t u8_Width, uint8_t u8_Argc, char **ppc_Argv)
+{
+	MonRegBlock st_Block;
+	uint8_t _i;
+
+	if (u8_Argc < 2) {
+		u8s_MonJob = MON_JOB_REG_LIST;
+		u8s_MonJobIndex = 0;
+		return;
+	}
+	for (_i=0; mon_reg_get(_i, &st_Block); _i++) {
+		if (mon_str_equal(ppc_Argv[1], st_Block.pc_name)) {
+			if (u8_Width == 0) {
+				u8_Width = st_Block.u8_width;
+			}
+			mon_dump_start((uintptr_t)st_Block.pv_base, st_Block.u32_size, u8_Width);
+			return;
+		}
+	}
+	mon_error("unknown block (reg: block list)");
+}
+
+/**
+  * @brief  stat: 統計情報
+  * @param  u8_Width: 読み出し幅(未使用)
+  * @param  u8_Argc: 引数の数
+  * @param  ppc_Argv: 引数
+  * @retval None
+  */
+static void mon_cmd_stat(uint8_t u8_Width, uint8_t u8_Argc, char **ppc_Argv)
+{
+	(void)u8_Width;
+	(void)u8_Argc;
+	(void)ppc_Argv;
+	u8s_MonJob = MON_JOB_STAT;
+	u8s_MonJobIndex = 0;
+}
+
+/**
+  * @brief  lat: 割り込み遅延
+  * @param  u8_Width: 読み出し幅(未使用)
+  * @param  u8_Argc: 引数の数
+  * @param  ppc_Argv: 引数([start|stop|clear])
+  * @retval None
+  * @note   引数を省略すると計測結果を表示する
+  */
+static void mon_cmd_lat(uint8_t u8_Width, uint8_t u8_Argc, char **ppc_Argv)
+{
+	(void)u8_Width;
+	if (u8_Argc >= 2) {
+		if (mon_str_equal(ppc_Argv[1], "start")) {
+			if (latIsRunning()) {
+				mon_error("already running");
+				return;
+			}
+			latClear();
+			if (latStart() != OK) {
+				mon_error("ICLK is not a multiple of PCLKD");
+				return;
+			}
+		}
+		else if (mon_str_equal(ppc_Argv[1], "stop")) {
+			latStop();
+		}
+		else if (mon_str_equal(ppc_Argv[1], "clear")) {
+			latClear();
+		}
+		else {
+			mon_error("usage: lat [start|stop|clear]");
+			return;
+		}
+	}
+	u8s_MonJob = MON_JOB_LAT;
+	u8s_MonJobIndex = 0;
+}
+
+/**
+  * @brief  exit: 終了
+  * @param  u8_Width: 読み出し幅(未使用)
+  * @param  u8_Argc: 引数の数
+  * @param  ppc_Argv: 引数
+  * @retval None
+  */
+static void mon_cmd_exit(uint8_t u8_Width, uint8_t u8_Argc, char **ppc_Argv)
+{
+	(void)u8_Width;
+	(void)u8_Argc;
+	(void)ppc_Argv;
+	bls_MonActive = false;
+	mon_out_str("bye");
+	mon_out_line();
+}
@@ -0,0 +1,454 @@
+/**
+  ******************************************************************************
+  * @file           : lib_pool.c
+  * @brief          : 固定長ブロック メモリプール
+  ******************************************************************************
+  * @note   ブロックサイズの異なる複数のクラスを持ち、要求サイズに合う最小の
+  *         クラスから確保する(空きが無ければ上位のクラスから確保する)。
+  *         空きリストは「更新回数(上位16bit)+ブロック番号(下位16bit)」を
+  *         CAS(LDREX/STREX)で更新するためロック不要で、割り込みハンドラーからも
+  *         使用できる。確保/解放は O(1)。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include "main.h"
+#include "lib.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* ブロッククラス情報 */
+typedef struct _PoolClass {
+	uint32_t *pu32_base;				/* ブロック領域の先頭					*/
+	uint32_t *pu32_map;					/* 使用中ビットマップ					*/
+	uint16_t u16_size;					/* ブロックサイズ[byte]					*/
+	uint16_t u16_num;					/* ブロック数							*/
+	uint32_t u32_head;					/* 空きリスト先頭(更新回数|ブロック番号)*/
+	uint32_t u32_used;					/* 使用中ブロック数						*/
+	uint32_t u32_high_water;			/* 最大使用ブロック数					*/
+	uint32_t u32_alloc_count;			/* 確保回数								*/
+	uint32_t u32_fail_count;			/* 確保失敗回数							*/
+} PoolClass;
+
+/* Private define ------------------------------------------------------------*/
+#define POOL_INDEX_NONE		(0xFFFFU)				/* 空きリスト終端			*/
+#define POOL_INDEX_MASK		(0x0000FFFFU)			/* ブロック番号				*/
+#define POOL_TAG_INC		(0x00010000U)			/* 更新回数の加算値			*/
+#define POOL_BENCH_LOOP		(16)					/* ベンチマーク繰り返し回数	*/
+#define POOL_BENCH_DEPTH	(8)						/* 同時確保数				*/
+
+/* 設定値の確認 */
+_Static_assert((POOL_BLOCK_SIZE_0 % 4) == 0, "POOL_BLOCK_SIZE_0 must be a multiple of 4");
+_Static_assert((POOL_BLOCK_SIZE_1 % 4) == 0, "POOL_BLOCK_SIZE_1 must be a multiple of 4");
+_Static_assert((POOL_BLOCK_SIZE_2 % 4) == 0, "POOL_BLOCK_SIZE_2 must be a multiple of 4");
+_Static_assert((POOL_BLOCK_SIZE_0 < POOL_BLOCK_SIZE_1) && (POOL_BLOCK_SIZE_1 < POOL_BLOCK_SIZE_2), "pool block sizes must be ascending");
+_Static_assert((POOL_BLOCK_NUM_0 > 0) && (POOL_BLOCK_NUM_0 < POOL_INDEX_NONE), "POOL_BLOCK_NUM_0 out of range");
+_Static_assert((POOL_BLOCK_NUM_1 > 0) && (POOL_BLOCK_NUM_1 < POOL_INDEX_NONE), "POOL_BLOCK_NUM_1 out of range");
+_Static_assert((POOL_BLOCK_NUM_2 > 0) && (POOL_BLOCK_NUM_2 < POOL_INDEX_NONE), "POOL_BLOCK_NUM_2 out of range");
+_Static_assert(POOL_BLOCK_SIZE_2 <= 0xFFFF, "POOL_BLOCK_SIZE_2 out of range");
+
+/* Private macro -------------------------------------------------------------*/
+#define POOL_WORDS(size, num)	(((size) / 4) * (num))	/* ブロック領域のワード数	*/
+#define POOL_MAP_WORDS(num)		(((num) + 31) / 32)		/* ビットマップのワード数	*/
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t u32s_Pool0[POOL_WORDS(POOL_BLOCK_SIZE_0, POOL_BLOCK_NUM_0)];
+static uint32_t u32s_Pool1[POOL_WORDS(POOL_BLOCK_SIZE_1, POOL_BLOCK_NUM_1)];
+static uint32_t u32s_Pool2[POOL_WORDS(POOL_BLOCK_SIZE_2, POOL_BLOCK_NUM_2)];
+static uint32_t u32s_PoolMap0[POOL_MAP_WORDS(POOL_BLOCK_NUM_0)];
+static uint32_t u32s_PoolMap1[POOL_MAP_WORDS(POOL_BLOCK_NUM_1)];
+static uint32_t u32s_PoolMap2[POOL_MAP_WORDS(POOL_BLOCK_NUM_2)];
+
+static PoolClass sts_PoolClass[POOL_CLASS_NUM] = {
+	{&u32s_Pool0[0], &u32s_PoolMap0[0], POOL_BLOCK_SIZE_0, POOL_BLOCK_NUM_0, 0, 0, 0, 0, 0},
+	{&u32s_Pool1[0], &u32s_PoolMap1[0], POOL_BLOCK_SIZE_1, POOL_BLOCK_NUM_1, 0, 0, 0, 0, 0},
+	{&u32s_Pool2[0], &u32s_PoolMap2[0], POOL_BLOCK_SIZE_2, POOL_BLOCK_NUM_2, 0, 0, 0, 0, 0},
+};
+
+/* ベンチマークの要求サイズと解放順(奇数番目→偶数番目の順に解放して空きリストを並べ替える) */
+static const uint16_t u16s_BenchSize[POOL_BENCH_DEPTH] = {8, 12, 16, 40, 64, 24, 200, 48};
+static const uint8_t u8s_BenchFreeOrder[POOL_BENCH_DEPTH] = {1, 3, 5, 7, 0, 2, 4, 6};
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t *pool_block(PoolClass *pst_Class, uint32_t u32_Index);
+static uint32_t *pool_pop(PoolClass *pst_Class);
+static void pool_push(PoolClass *pst_Class, uint32_t u32_Index);
+static void pool_count_used(PoolClass *pst_Class);
+static PoolClass *pool_find_class(const void *pv_Block, uint32_t *pu32_Index);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  メモリプール初期化処理
+  * @param  None
+  * @retval None
+  * @note   全ブロックを空きリストにつなぐ(使用中のブロックは無効になる)
+  */
+void poolInit(void)
+{
+	PoolClass *pst_Class;
+	uint32_t _i;
+	uint32_t _j;
+
+	for (_i=0; _i<POOL_CLASS_NUM; _i++) {
+		pst_Class = &sts_PoolClass[_i];
+		/* 各ブロックの先頭ワードに次の空きブロック番号を格納する */
+		for (_j=0; _j<pst_Class->u16_num; _j++) {
+			*pool_block(pst_Class, _j) = ((_j + 1) < pst_Class->u16_num) ? (_j + 1) : POOL_INDEX_NONE;
+		}
+		mem_set32(pst_Class->pu32_map, 0, POOL_MAP_WORDS(pst_Class->u16_num));
+		pst_Class->u32_head = 0;
+		pst_Class->u32_used = 0;
+		pst_Class->u32_high_water = 0;
+		pst_Class->u32_alloc_count = 0;
+		pst_Class->u32_fail_count = 0;
+	}
+}
+
+/**
+  * @brief  メモリブロックを確保する
+  * @param  u32_Size: 要求サイズ[byte]
+  * @retval ブロックの先頭(4byte境界) / NULL:確保失敗
+  * @note   割り込みハンドラーからも呼び出し可能
+  */
+void *poolAlloc(uint32_t u32_Size)
+{
+	PoolClass *pst_Fit = NULL;
+	uint32_t *pu32_Block;
+	uint32_t _i;
+
+	for (_i=0; _i<POOL_CLASS_NUM; _i++) {
+		if (u32_Size > sts_PoolClass[_i].u16_size) {
+			continue;
+		}
+		if (pst_Fit == NULL) {
+			pst_Fit = &sts_PoolClass[_i];
+		}
+		pu32_Block = pool_pop(&sts_PoolClass[_i]);
+		if (pu32_Block != NULL) {
+			pool_count_used(&sts_PoolClass[_i]);
+			return pu32_Block;
+		}
+	}
+
+	/* 確保失敗は要求サイズに合う最小のクラスで数える */
+	if (pst_Fit != NULL) {
+		__atomic_fetch_add(&pst_Fit->u32_fail_count, 1, __ATOMIC_RELAXED);
+	}
+	return NULL;
+}
+
+/**
+  * @brief  メモリブロックを解放する
+  * @param  pv_Block: poolAlloc()で確保したブロック
+  * @retval OK:解放 / NG:プール外のアドレスまたは二重解放
+  * @note   割り込みハンドラーからも呼び出し可能
+  */
+uint8_t poolFree(void *pv_Block)
+{
+	PoolClass *pst_Class;
+	uint32_t u32_Index;
+	uint32_t u32_Bit;
+
+	pst_Class = pool_find_class(pv_Block, &u32_Index);
+	if (pst_Class == NULL) {
+		return NG;
+	}
+
+	/* 使用中ビットを落とし、既に落ちていた場合は二重解放とする */
+	u32_Bit = 1UL << (u32_Index % 32);
+	if ((__atomic_fetch_and(&pst_Class->pu32_map[u32_Index / 32], ~u32_Bit, __ATOMIC_ACQ_REL) & u32_Bit) == 0) {
+		return NG;
+	}
+	__atomic_fetch_sub(&pst_Class->u32_used, 1, __ATOMIC_RELAXED);
+	pool_push(pst_Class, u32_Index);
+	return OK;
+}
+
+/**
+  * @brief  メモリプールの統計情報を取得する
+  * @param  u8_Class: クラス番号(0～POOL_CLASS_NUM-1)
+  * @param  pst_Stat: 統計情報の格納先
+  * @retval OK/NG
+  */
+uint8_t poolGetStatistics(uint8_t u8_Class, PoolStatistics *pst_Stat)
+{
+	PoolClass *pst_Class;
+
+	if (u8_Class >= POOL_CLASS_NUM) {
+		return NG;
+	}
+	pst_Class = &sts_PoolClass[u8_Class];
+	pst_Stat->u16_block_size = pst_Class->u16_size;
+	pst_Stat->u16_block_num = pst_Class->u16_num;
+	pst_Stat->u16_used = (uint16_t)__atomic_load_n(&pst_Class->u32_used, __ATOMIC_RELAXED);
+	pst_Stat->u16_high_water = (uint16_t)__atomic_load_n(&pst_Class->u32_high_water, __ATOMIC_RELAXED);
+	pst_Stat->u32_alloc_count = __atomic_load_n(&pst_Class->u32_alloc_count, __ATOMIC_RELAXED);
+	pst_Stat->u32_fail_count = __atomic_load_n(&pst_Class->u32_fail_count, __ATOMIC_RELAXED);
+	return OK;
+}
+
+/**
+  * @brief  セルフテスト
+  * @param  None
+  * @retval 0:正常 / 0以外:異常のあったクラスのビット(bit8以降は共通項目)
+  * @note   全ブロックの確保/解放を行うため、他に使用者がいない状態で呼ぶこと。
+  *         終了後はpoolInit()直後の状態に戻る。
+  */
+uint32_t poolSelfTest(void)
+{
+	PoolClass *pst_Class;
+	uint32_t *pu32_Block;
+	uint32_t u32_Result = 0;
+	uint32_t u32_Index;
+	uint32_t _i;
+	uint32_t _j;
+
+	poolInit();
+
+	for (_i=0; _i<POOL_CLASS_NUM; _i++) {
+		pst_Class = &sts_PoolClass[_i];
+
+		/* ---- 全ブロックを確保する(所属クラス/ブロック先頭を確認) ---- */
+		for (_j=0; _j<pst_Class->u16_num; _j++) {
+			pu32_Block = poolAlloc(pst_Class->u16_size);
+			if (pool_find_class(pu32_Block, &u32_Index) != pst_Class) {
+				u32_Result |= (1UL << _i);
+				break;
+			}
+			/* ブロック番号を書き込み、重複して確保されていないことを解放時に確認する */
+			mem_set32(pu32_Block, u32_Index, pst_Class->u16_size / 4);
+		}
+		if (pst_Class->u32_used != pst_Class->u16_num) {
+			u32_Result |= (1UL << _i);
+		}
+		/* 空きが無くなった後は上位クラスから確保される(最上位はNULL) */
+		pu32_Block = poolAlloc(pst_Class->u16_size);
+		if (pool_find_class(pu32_Block, &u32_Index) != ((_i < (POOL_CLASS_NUM - 1)) ? &sts_PoolClass[_i + 1] : NULL)) {
+			u32_Result |= (1UL << _i);
+		}
+		(void)poolFree(pu32_Block);
+
+		/* ---- 全ブロックを解放する ---- */
+		for (_j=0; _j<pst_Class->u16_num; _j++) {
+			pu32_Block = pool_block(pst_Class, _j);
+			if ((pu32_Block[0] != _j) || (pu32_Block[(pst_Class->u16_size / 4) - 1] != _j)
+			 || (poolFree(pu32_Block) != OK)) {
+				u32_Result |= (1UL << _i);
+			}
+		}
+		if ((pst_Class->u32_used != 0) || (pst_Class->u32_high_water != pst_Class->u16_num)) {
+			u32_Result |= (1UL << _i);
+		}
+	}
+
+	/* ---- 二重解放/プール外アドレス ---- */
+	pu32_Block = poolAlloc(1);
+	if ((poolFree(pu32_Block) != OK) || (poolFree(pu32_Block) != NG)) {
+		u32_Result |= (1UL << 8);
+	}
+	if ((poolFree(NULL) != NG) || (poolFree(&u32_Result) != NG)
+	 || (poolFree((uint8_t *)&u32s_Pool0[0] + 2) != NG)) {
+		u32_Result |= (1UL << 9);
+	}
+
+	/* ---- クラス選択(最小の合うクラス/上位クラスへの切り替え/サイズ超過) ---- */
+	pu32_Block = poolAlloc(POOL_BLOCK_SIZE_0 + 1);
+	if (pool_find_class(pu32_Block, &_j) != &sts_PoolClass[1]) {
+		u32_Result |= (1UL << 10);
+	}
+	(void)poolFree(pu32_Block);
+	if (poolAlloc(POOL_BLOCK_SIZE_2 + 1) != NULL) {
+		u32_Result |= (1UL << 10);
+	}
+	for (_j=0; _j<POOL_BLOCK_NUM_0; _j++) {
+		(void)poolAlloc(1);
+	}
+	pu32_Block = poolAlloc(1);
+	if (pool_find_class(pu32_Block, &_j) != &sts_PoolClass[1]) {
+		u32_Result |= (1UL << 11);
+	}
+
+	poolInit();
+	return u32_Result;
+}
+
+/**
+  * @brief  ベンチマーク(poolAlloc/poolFree と malloc/free の比較)
+  * @param  pst_Result: 結果の格納先
+  * @retval None
+  * @note   サイズの異なる確保をPOOL_BENCH_DEPTH個行ってから確保順と異なる順で
+  *         解放する処理を繰り返し、1回の確保+解放あたりの平均/最大サイクル数を
+  *         求める。mallocが失敗した場合(ヒープ無し)はmallocの結果を0とする。
+  */
+void poolBenchmark(PoolBenchResult *pst_Result)
+{
+	void *pv_Block[POOL_BENCH_DEPTH];
+	uint32_t u32_Start;
+	uint32_t u32_Cycle;
+	uint32_t u32_PoolSum = 0;
+	uint32_t u32_MallocSum = 0;
+	bool bl_MallocOk = true;
+	uint32_t _i;
+	uint32_t _j;
+
+	mem_set08((uint8_t *)pst_Result, 0, sizeof(PoolBenchResult));
+
+	for (_i=0; _i<POOL_BENCH_LOOP; _i++) {
+		/* ---- メモリプール ---- */
+		for (_j=0; _j<POOL_BENCH_DEPTH; _j++) {
+			u32_Start = LL_DWT_GetCycle();
+			pv_Block[_j] = poolAlloc(u16s_BenchSize[_j]);
+			u32_Cycle = LL_DWT_GetCycle() - u32_Start;
+			u32_PoolSum += u32_Cycle;
+			if (u32_Cycle > pst_Result->u32_pool_max) {
+				pst_Result->u32_pool_max = u32_Cycle;
+			}
+		}
+		for (_j=0; _j<POOL_BENCH_DEPTH; _j++) {
+			u32_Start = LL_DWT_GetCycle();
+			(void)poolFree(pv_Block[u8s_BenchFreeOrder[_j]]);
+			u32_Cycle = LL_DWT_GetCycle() - u32_Start;
+			u32_PoolSum += u32_Cycle;
+			if (u32_Cycle > pst_Result->u32_pool_max) {
+				pst_Result->u32_pool_max = u32_Cycle;
+			}
+		}
+
+		/* ---- malloc ---- */
+		for (_j=0; _j<POOL_BENCH_DEPTH; _j++) {
+			u32_Start = LL_DWT_GetCycle();
+			pv_Block[_j] = malloc(u16s_BenchSize[_j]);
+			u32_Cycle = LL_DWT_GetCycle() - u32_Start;
+			u32_MallocSum += u32_Cycle;
+			if (u32_Cycle > pst_Result->u32_malloc_max) {
+				pst_Result->u32_malloc_max = u32_Cycle;
+			}
+			if (pv_Block[_j] == NULL) {
+				bl_MallocOk = false;
+			}
+		}
+		for (_j=0; _j<POOL_BENCH_DEPTH; _j++) {
+			u32_Start = LL_DWT_GetCycle();
+			free(pv_Block[u8s_BenchFreeOrder[_j]]);
+			u32_Cycle = LL_DWT_GetCycle() - u32_Start;
+			u32_MallocSum += u32_Cycle;
+			if (u32_Cycle > pst_Result->u32_malloc_max) {
+				pst_Result->u32_malloc_max = u32_Cycle;
+			}
+		}
+	}
+
+	pst_Result->u32_pool_cycles = u32_PoolSum / (POOL_BENCH_LOOP * POOL_BENCH_DEPTH);
+	pst_Result->u32_malloc_cycles = u32_MallocSum / (POOL_BENCH_LOOP * POOL_BENCH_DEPTH);
+	if (!bl_MallocOk) {
+		pst_Result->u32_malloc_cycles = 0;
+		pst_Result->u32_malloc_max = 0;
+	}
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  ブロック番号からブロックの先頭を求める
+  * @param  pst_Class: クラス情報
+  * @param  u32_Index: ブロック番号
+  * @retval ブロックの先頭
+  */
+static uint32_t *pool_block(PoolClass *pst_Class, uint32_t u32_Index)
+{
+	return &pst_Class->pu32_base[u32_Index * (pst_Class->u16_size / 4)];
+}
+
+/**
+  * @brief  空きリストからブロックを取り出す
+  * @param  pst_Class: クラス情報
+  * @retval ブロックの先頭 / NULL:空き無し
+  * @note   取り出しの途中で割り込み等により先頭が入れ替わった場合は、
+  *         更新回数が変わるためCASが失敗してやり直す(ABA対策)
+  */
+static uint32_t *pool_pop(PoolClass *pst_Class)
+{
+	uint32_t u32_Head = __atomic_load_n(&pst_Class->u32_head, __ATOMIC_ACQUIRE);
+	uint32_t u32_New;
+	uint32_t u32_Index;
+	uint32_t u32_Next;
+
+	do {
+		u32_Index = u32_Head & POOL_INDEX_MASK;
+		if (u32_Index == POOL_INDEX_NONE) {
+			return NULL;
+		}
+		u32_Next = *(volatile uint32_t *)pool_block(pst_Class, u32_Index);
+		u32_New = ((u32_Head + POOL_TAG_INC) & ~POOL_INDEX_MASK) | (u32_Next & POOL_INDEX_MASK);
+	} while (!__atomic_compare_exchange_n(&pst_Class->u32_head, &u32_Head, u32_New,
+				true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+	__atomic_fetch_or(&pst_Class->pu32_map[u32_Index / 32], 1UL << (u32_Index % 32), __ATOMIC_RELAXED);
+	return pool_block(pst_Class, u32_Index);
+}
+
+/**
+  * @brief  空きリストにブロックを戻す
+  * @param  pst_Class: クラス情報
+  * @param  u32_Index: ブロック番号
+  * @retval None
+  */
+static void pool_push(PoolClass *pst_Class, uint32_t u32_Index)
+{
+	uint32_t u32_Head = __atomic_load_n(&pst_Class->u32_head, __ATOMIC_ACQUIRE);
+	uint32_t u32_New;
+
+	do {
+		*(volatile uint32_t *)pool_block(pst_Class, u32_Index) = u32_Head & POOL_INDEX_MASK;
+		u32_New = ((u32_Head + POOL_TAG_INC) & ~POOL_INDEX_MASK) | u32_Index;
+	} while (!__atomic_compare_exchange_n(&pst_Class->u32_head, &u32_Head, u32_New,
+				true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+}
+
+/**
+  * @brief  確保回数/使用中ブロック数/最大使用ブロック数を更新する
+  * @param  pst_Class: クラス情報
+  * @retval None
+  */
+static void pool_count_used(PoolClass *pst_Class)
+{
+	uint32_t u32_Used = __atomic_add_fetch(&pst_Class->u32_used, 1, __ATOMIC_RELAXED);
+	uint32_t u32_High = __atomic_load_n(&pst_Class->u32_high_water, __ATOMIC_RELAXED);
+
+	__atomic_fetch_add(&pst_Class->u32_alloc_count, 1, __ATOMIC_RELAXED);
+	while ((u32_Used > u32_High)
+	 && !__atomic_compare_exchange_n(&pst_Class->u32_high_water, &u32_High, u32_Used,
+				true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+		/* 他の確保と競合した場合は最新値と比較し直す */
+	}
+}
+
+/**
+  * @brief  ブロックのアドレスからクラスとブロック番号を求める
+  * @param  pv_Block: ブロックのアドレス
+  * @param  pu32_Index: ブロック番号の格納先
+  * @retval クラス情報 / NULL:プール外またはブロック先頭でない
+  */
+static PoolClass *pool_find_class(const void *pv_Block, uint32_t *pu32_Index)
+{
+	PoolClass *pst_Class;
+	uintptr_t u32_Offset;
+	uint32_t _i;
+
+	for (_i=0; _i<POOL_CLASS_NUM; _i++) {
+		pst_Class = &sts_PoolClass[_i];
+		if (((uintptr_t)pv_Block < (uintptr_t)pst_Class->pu32_base)
+		 || ((uintptr_t)pv_Block >= (uintptr_t)pool_block(pst_Class, pst_Class->u16_num))) {
+			continue;
+		}
+		u32_Offset = (uintptr_t)pv_Block - (uintptr_t)pst_Class->pu32_base;
+		if ((u32_Offset % pst_Class->u16_size) != 0) {
+			return NULL;
+		}
+		*pu32_Index = (uint32_t)(u32_Offset / pst_Class->u16_size);
+		return pst_Class;
+	}
+	return NULL;
+}
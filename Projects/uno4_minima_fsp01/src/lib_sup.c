@@ -0,0 +1,170 @@
+/**
+  ******************************************************************************
+  * @file           : lib_sup.c
+  * @brief          : タスク監視(スーパーバイザー)
+  ******************************************************************************
+  * @note   周期処理の各タスクは処理の完了をチェックインで報告し、周期の最後に
+  *         supEvaluate()で全タスクの進行を確認する。登録した周期数の間に
+  *         チェックインの無いタスクを停止と判定し、判定はリセットまで保持する。
+  *         ハードウェアに依存しないため、ウォッチドッグの更新可否の判断だけを
+  *         ホスト上で確認できる(supSelfTest)。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "lib.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  タスク監視を初期化する
+  * @param  pst_Sup: タスク監視情報
+  * @retval None
+  */
+void supInit(Supervisor *pst_Sup)
+{
+	mem_set08((uint8_t *)pst_Sup, 0, sizeof(Supervisor));
+}
+
+/**
+  * @brief  監視対象のタスクを登録する
+  * @param  pst_Sup: タスク監視情報
+  * @param  u8_Task: タスク番号(0～SUP_TASK_MAX-1)
+  * @param  u16_MaxCycles: チェックインの無い周期の許容数(1:毎周期)
+  * @retval OK/NG
+  */
+uint8_t supRegister(Supervisor *pst_Sup, uint8_t u8_Task, uint16_t u16_MaxCycles)
+{
+	if ((u8_Task >= SUP_TASK_MAX) || (u16_MaxCycles == 0)) {
+		return NG;
+	}
+	pst_Sup->u16_limit[u8_Task] = u16_MaxCycles;
+	pst_Sup->u16_count[u8_Task] = 0;
+	pst_Sup->u32_registered |= (1UL << u8_Task);
+	return OK;
+}
+
+/**
+  * @brief  タスクの進行を報告する
+  * @param  pst_Sup: タスク監視情報
+  * @param  u8_Task: タスク番号
+  * @retval None
+  * @note   割り込みハンドラーからも呼び出せる
+  */
+void supCheckin(Supervisor *pst_Sup, uint8_t u8_Task)
+{
+	if (u8_Task < SUP_TASK_MAX) {
+		__atomic_fetch_or(&pst_Sup->u32_checkin, (1UL << u8_Task), __ATOMIC_RELAXED);
+	}
+}
+
+/**
+  * @brief  全タスクの進行を判定する(周期毎に1回呼び出す)
+  * @param  pst_Sup: タスク監視情報
+  * @retval true:正常(ウォッチドッグを更新してよい) / false:停止したタスクがある
+  * @note   停止と判定したタスクはu32_failedに保持し、以降はfalseを返し続ける
+  */
+bool supEvaluate(Supervisor *pst_Sup)
+{
+	uint32_t u32_Checkin = __atomic_exchange_n(&pst_Sup->u32_checkin, 0, __ATOMIC_RELAXED);
+	uint8_t _i;
+
+	for (_i=0; _i<SUP_TASK_MAX; _i++) {
+		if ((pst_Sup->u32_registered & (1UL << _i)) == 0) {
+			continue;
+		}
+		if (u32_Checkin & (1UL << _i)) {
+			pst_Sup->u16_count[_i] = 0;
+		}
+		else if (++pst_Sup->u16_count[_i] >= pst_Sup->u16_limit[_i]) {
+			pst_Sup->u32_failed |= (1UL << _i);
+		}
+	}
+	return (pst_Sup->u32_failed == 0);
+}
+
+/**
+  * @brief  停止と判定したタスクを取得する
+  * @param  pst_Sup: タスク監視情報
+  * @retval 停止したタスクのビットマスク
+  */
+uint32_t supGetFailed(const Supervisor *pst_Sup)
+{
+	return pst_Sup->u32_failed;
+}
+
+/**
+  * @brief  セルフテスト
+  * @param  None
+  * @retval 0:正常 / 0以外:失敗した項目のビットマスク
+  * @note   専用の監視情報で実行するため、動作中の監視には影響しない
+  */
+uint32_t supSelfTest(void)
+{
+	Supervisor st_Sup;
+	uint32_t u32_Result = 0;
+	uint8_t _i;
+
+	supInit(&st_Sup);
+
+	/* ---- 登録(範囲外/許容数0は登録しない) ---- */
+	if ((supRegister(&st_Sup, 0, 1) != OK) || (supRegister(&st_Sup, 1, 3) != OK)
+	 || (supRegister(&st_Sup, SUP_TASK_MAX, 1) != NG) || (supRegister(&st_Sup, 2, 0) != NG)
+	 || (st_Sup.u32_registered != 0x00000003)) {
+		u32_Result |= (1UL << 0);
+	}
+
+	/* ---- 全タスクがチェックインした周期は正常 ---- */
+	for (_i=0; _i<5; _i++) {
+		supCheckin(&st_Sup, 0);
+		supCheckin(&st_Sup, 1);
+		supCheckin(&st_Sup, 5);						/* 未登録のタスクは判定しない	*/
+		if (!supEvaluate(&st_Sup)) {
+			u32_Result |= (1UL << 1);
+		}
+	}
+
+	/* ---- 許容数の周期まではチェックインが無くても正常 ---- */
+	for (_i=0; _i<2; _i++) {
+		supCheckin(&st_Sup, 0);
+		if (!supEvaluate(&st_Sup)) {
+			u32_Result |= (1UL << 2);
+		}
+	}
+	supCheckin(&st_Sup, 0);
+	if (supEvaluate(&st_Sup) || (supGetFailed(&st_Sup) != 0x00000002)) {
+		u32_Result |= (1UL << 3);
+	}
+
+	/* ---- 停止の判定はチェックインが再開しても保持する ---- */
+	supCheckin(&st_Sup, 0);
+	supCheckin(&st_Sup, 1);
+	if (supEvaluate(&st_Sup) || (supGetFailed(&st_Sup) != 0x00000002)) {
+		u32_Result |= (1UL << 4);
+	}
+
+	/* ---- 毎周期のタスクは1周期の欠落で停止と判定する ---- */
+	supInit(&st_Sup);
+	(void)supRegister(&st_Sup, 0, 1);
+	(void)supRegister(&st_Sup, SUP_TASK_MAX - 1, 1);
+	supCheckin(&st_Sup, SUP_TASK_MAX - 1);
+	if (supEvaluate(&st_Sup) || (supGetFailed(&st_Sup) != 0x00000001)) {
+		u32_Result |= (1UL << 5);
+	}
+
+	return u32_Result;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
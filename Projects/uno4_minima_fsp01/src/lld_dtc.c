@@ -0,0 +1,70 @@
+/**
+  ******************************************************************************
+  * @file           : lld_dtc.c
+  * @brief          : Low Level Driver DTC処理
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define DTC_VECTOR_MAX		(BSP_ICU_VECTOR_MAX_ENTRIES)	/* DTCベクター数		*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+/* DTCベクターテーブル(DTCVBRの下位10bitは0固定のため1KB境界に配置する) */
+BSP_ALIGN_VARIABLE(1024) static uint32_t u32s_DtcVectorTable[DTC_VECTOR_MAX];
+static bool bls_DtcInitialized = false;				/* DTC初期化済み		*/
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  DTC初期化処理
+  * @param  None
+  * @retval None
+  * @note   複数のドライバーから呼ばれるため、2回目以降は何もしない
+  */
+void LL_DTC_Init(void)
+{
+	size_t _i;
+
+	if (bls_DtcInitialized) {
+		return;
+	}
+
+	for (_i=0; _i<DTC_VECTOR_MAX; _i++) {
+		u32s_DtcVectorTable[_i] = 0;
+	}
+
+	/* ---- DTC モジュールストップ解除 ---- */
+	R_BSP_RegisterProtectDisable(BSP_REG_PROTECT_OM_LPC_BATT);
+	R_MSTP->MSTPCRA_b.MSTPA22 = 0;					// DMAC/DTC ON
+	R_BSP_RegisterProtectEnable(BSP_REG_PROTECT_OM_LPC_BATT);
+
+	/* ---- DTC 設定 ---- */
+	R_DTC->DTCST = 0;								// DTC停止
+	R_DTC->DTCCR = 0x08;							// リードスキップ禁止
+	R_DTC->DTCVBR = (uint32_t)(uintptr_t)&u32s_DtcVectorTable[0];
+	R_DTC->DTCST = 1;								// DTC起動
+
+	bls_DtcInitialized = true;
+}
+
+/**
+  * @brief  DTCベクターを登録する
+  * @param  u8_Irq: IRQ番号
+  * @param  pst_Info: DTC転送情報のポインタ(チェーン転送時は先頭)
+  * @retval None
+  */
+void LL_DTC_SetVector(uint8_t u8_Irq, DtcTransferInfo *pst_Info)
+{
+	u32s_DtcVectorTable[u8_Irq] = (uint32_t)(uintptr_t)pst_Info;
+}
+
+/* Private functions ---------------------------------------------------------*/
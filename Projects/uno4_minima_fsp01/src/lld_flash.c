@@ -0,0 +1,202 @@
+/**
+  ******************************************************************************
+  * @file           : lld_flash.c
+  * @brief          : Low Level Driver データフラッシュ処理
+  ******************************************************************************
+  * @note   低消費電力フラッシュ(FACI LP)でデータフラッシュ(8KB,1KBブロック)を
+  *         1byte単位で書き込み,ブロック単位で消去する。書き込み/消去は開始だけ
+  *         行い、完了はLL_FLASH_Poll()で確認する(周期処理を止めないため)。
+  *         P/Eモード中はデータフラッシュを読み出せない。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define FLASH_PE_BASE		(0xFE000000UL)			/* P/E時のデータフラッシュアドレス	*/
+#define FLASH_FENTRYR_READ	(0xAA00)				/* リードモード				*/
+#define FLASH_FENTRYR_PE_D	(0xAA80)				/* データフラッシュP/Eモード	*/
+#define FLASH_FPR_UNLOCK	(0xA5)					/* FPMCR書き込みプロテクト解除	*/
+#define FLASH_FPMCR_PE_D	(0x10)					/* データフラッシュP/Eモード	*/
+#define FLASH_FPMCR_READ	(0x08)					/* リードモード				*/
+#define FLASH_FCR_PROGRAM	(0x81)					/* 書き込み開始				*/
+#define FLASH_FCR_ERASE		(0x84)					/* ブロック消去開始			*/
+#define FLASH_FCR_CLEAR		(0x00)					/* 処理終了					*/
+#define FLASH_FSTATR1_FRDY	(0x40)					/* 処理完了					*/
+#define FLASH_FSTATR2_ERR	(0x0033)				/* ERERR/PRGERR/ILGLERR/EILGLERR	*/
+#define FLASH_WAIT_TDSTOP	(2)						/* データフラッシュ起動待ち[us]	*/
+#define FLASH_WAIT_TMS		(6)						/* モード切り替え待ち[us]	*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static bool bls_FlashPeMode = false;				/* P/Eモード中				*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void flash_wait_us(uint32_t u32_Time);		/* 時間待ち処理(us指定)		*/
+static void flash_set_address(uint32_t u32_Start, uint32_t u32_End);	/* 対象アドレスを設定する	*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  データフラッシュ初期化処理
+  * @param  None
+  * @retval None
+  * @note   データフラッシュの読み出しを許可する(DWT初期化後に呼び出すこと)
+  */
+void LL_FLASH_Init(void)
+{
+	R_FACI_LP->DFLCTL = 1;							// DFLEN: データフラッシュ アクセス許可
+	flash_wait_us(FLASH_WAIT_TDSTOP);
+}
+
+/**
+  * @brief  データフラッシュを読み出す
+  * @param  u32_Offset: データフラッシュ先頭からのオフセット
+  * @param  pu8_Data: 読み出し先
+  * @param  u32_Size: サイズ[byte]
+  * @retval None
+  * @note   リードモード中だけ呼び出せる
+  */
+void LL_FLASH_Read(uint32_t u32_Offset, uint8_t *pu8_Data, uint32_t u32_Size)
+{
+	const volatile uint8_t *pu8_Flash = (const volatile uint8_t *)(uintptr_t)(BSP_FEATURE_FLASH_DATA_FLASH_START + u32_Offset);
+	uint32_t _i;
+
+	for (_i=0; _i<u32_Size; _i++) {
+		pu8_Data[_i] = pu8_Flash[_i];
+	}
+}
+
+/**
+  * @brief  データフラッシュP/Eモードにする
+  * @param  None
+  * @retval None
+  */
+void LL_FLASH_EnterPE(void)
+{
+	if (bls_FlashPeMode) {
+		return;
+	}
+	R_FACI_LP->FENTRYR = FLASH_FENTRYR_PE_D;
+	flash_wait_us(FLASH_WAIT_TDSTOP);
+	/* FPMCRは規定の順序(値,反転値,値)で書き込む */
+	R_FACI_LP->FPR = FLASH_FPR_UNLOCK;
+	R_FACI_LP->FPMCR = FLASH_FPMCR_PE_D;
+	R_FACI_LP->FPMCR = (uint8_t)~FLASH_FPMCR_PE_D;
+	R_FACI_LP->FPMCR = FLASH_FPMCR_PE_D;
+	/* FCLK周波数[MHz]-1 */
+	R_FACI_LP->FISR = (uint8_t)(((R_FSP_SystemClockHzGet(FSP_PRIV_CLOCK_FCLK) / 1000000) - 1) & 0x1F);
+	R_FACI_LP->FASR = 0;							// ユーザー領域/データ領域
+	bls_FlashPeMode = true;
+}
+
+/**
+  * @brief  リードモードに戻す
+  * @param  None
+  * @retval None
+  * @note   書き込み/消去の完了後に呼び出すこと
+  */
+void LL_FLASH_ExitPE(void)
+{
+	if (!bls_FlashPeMode) {
+		return;
+	}
+	R_FACI_LP->FPR = FLASH_FPR_UNLOCK;
+	R_FACI_LP->FPMCR = FLASH_FPMCR_READ;
+	R_FACI_LP->FPMCR = (uint8_t)~FLASH_FPMCR_READ;
+	R_FACI_LP->FPMCR = FLASH_FPMCR_READ;
+	flash_wait_us(FLASH_WAIT_TMS);
+	R_FACI_LP->FENTRYR = FLASH_FENTRYR_READ;
+	while (R_FACI_LP->FENTRYR != 0) {
+	}
+	bls_FlashPeMode = false;
+}
+
+/**
+  * @brief  1byte書き込みを開始する
+  * @param  u32_Offset: データフラッシュ先頭からのオフセット
+  * @param  u8_Data: 書き込みデータ
+  * @retval None
+  */
+void LL_FLASH_ProgramStart(uint32_t u32_Offset, uint8_t u8_Data)
+{
+	flash_set_address(u32_Offset, u32_Offset);
+	R_FACI_LP->FWBL0 = u8_Data;
+	R_FACI_LP->FCR = FLASH_FCR_PROGRAM;
+}
+
+/**
+  * @brief  ブロック消去を開始する
+  * @param  u32_Offset: 消去するブロックの先頭オフセット
+  * @retval None
+  */
+void LL_FLASH_EraseStart(uint32_t u32_Offset)
+{
+	flash_set_address(u32_Offset, u32_Offset + LL_FLASH_BLOCK_SIZE - 1);
+	R_FACI_LP->FCR = FLASH_FCR_ERASE;
+}
+
+/**
+  * @brief  書き込み/消去の完了を確認する
+  * @param  None
+  * @retval LL_FLASH_BUSY/LL_FLASH_DONE/LL_FLASH_ERROR
+  * @note   完了していれば処理を終了し、次の書き込み/消去を開始できる状態にする
+  */
+uint8_t LL_FLASH_Poll(void)
+{
+	if ((R_FACI_LP->FSTATR1 & FLASH_FSTATR1_FRDY) == 0) {
+		return LL_FLASH_BUSY;
+	}
+	R_FACI_LP->FCR = FLASH_FCR_CLEAR;
+	while (R_FACI_LP->FSTATR1 & FLASH_FSTATR1_FRDY) {
+	}
+	return (R_FACI_LP->FSTATR2 & FLASH_FSTATR2_ERR) ? LL_FLASH_ERROR : LL_FLASH_DONE;
+}
+
+/**
+  * @brief  P/Eモード中かを取得する
+  * @param  None
+  * @retval true:P/Eモード中
+  * @note   P/Eモード中はFCLKを変更できない(FISRはP/Eモード開始時に設定する)
+  */
+bool LL_FLASH_IsPeMode(void)
+{
+	return bls_FlashPeMode;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  時間待ち処理(us指定)
+  * @param  u32_Time: 待ち時間[us]
+  * @retval None
+  */
+static void flash_wait_us(uint32_t u32_Time)
+{
+	uint32_t u32_Start = LL_DWT_GetCycle();
+	uint32_t u32_Cycles = (SystemCoreClock / 1000000) * u32_Time;
+
+	while ((LL_DWT_GetCycle() - u32_Start) < u32_Cycles) {
+	}
+}
+
+/**
+  * @brief  対象アドレスを設定する
+  * @param  u32_Start: 開始オフセット
+  * @param  u32_End: 終了オフセット
+  * @retval None
+  */
+static void flash_set_address(uint32_t u32_Start, uint32_t u32_End)
+{
+	u32_Start += FLASH_PE_BASE;
+	u32_End += FLASH_PE_BASE;
+	R_FACI_LP->FSARH = (uint16_t)(u32_Start >> 16);
+	R_FACI_LP->FSARL = (uint16_t)u32_Start;
+	R_FACI_LP->FEARH = (uint16_t)(u32_End >> 16);
+	R_FACI_LP->FEARL = (uint16_t)u32_End;
+}
+
@@ -0,0 +1,99 @@
+/**
+  ******************************************************************************
+  * @file           : lld_semihost.c
+  * @brief          : Low Level Driver セミホスティング処理
+  ******************************************************************************
+  * @note   ARMセミホスティング(BKPT 0xAB)でデバッガー経由のホストに出力する。
+  *         OpenOCDでは "arm semihosting enable" で有効にし、出力はOpenOCDの
+  *         標準出力に表示される。SYS_EXITを受けたOpenOCDは(GDB未接続なら)
+  *         その終了コードで終了する。
+  *         デバッガーが接続されていない時にBKPTを実行するとHardFaultになるため、
+  *         DHCSR.C_DEBUGENを確認して要求しない。
+  *         ホスト実行版はbsp_api.hの__semihost()(ARMコンパイラ互換)を使用する。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* 操作番号 */
+#define SEMIHOST_SYS_WRITE0			(0x04)		/* 文字列(NUL終端)の出力			*/
+#define SEMIHOST_SYS_EXIT			(0x18)		/* 終了の通知						*/
+
+/* SYS_EXITの終了理由 */
+#define SEMIHOST_EXIT_SUCCESS		(0x20026)	/* ADP_Stopped_ApplicationExit		*/
+#define SEMIHOST_EXIT_FAILURE		(0x20024)	/* ADP_Stopped_RunTimeErrorUnknown	*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static int32_t semihost_call(uint32_t u32_Op, const void *pv_Arg);	/* セミホスティング要求	*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  デバッガーの接続を確認する
+  * @param  None
+  * @retval true:接続中(セミホスティング要求可) / false:未接続
+  */
+bool LL_SEMIHOST_IsConnected(void)
+{
+	return ((CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk) != 0);
+}
+
+/**
+  * @brief  文字列をホストのコンソールに出力する
+  * @param  pc_Str: 文字列(NUL終端)
+  * @retval LL_SEMIHOST_OK / LL_SEMIHOST_NC:未接続
+  * @note   1回の要求でコアが停止するため、1行をまとめて出力すること
+  */
+int32_t LL_SEMIHOST_Write0(const char *pc_Str)
+{
+	if (!LL_SEMIHOST_IsConnected()) {
+		return LL_SEMIHOST_NC;
+	}
+	(void)semihost_call(SEMIHOST_SYS_WRITE0, pc_Str);
+	return LL_SEMIHOST_OK;
+}
+
+/**
+  * @brief  ホストに終了を通知する
+  * @param  bl_Success: true:正常終了 / false:異常終了
+  * @retval LL_SEMIHOST_NC:未接続(接続中は戻らない)
+  */
+int32_t LL_SEMIHOST_Exit(bool bl_Success)
+{
+	if (!LL_SEMIHOST_IsConnected()) {
+		return LL_SEMIHOST_NC;
+	}
+	/* SYS_EXITはパラメーターブロックではなく終了理由をそのまま渡す */
+	(void)semihost_call(SEMIHOST_SYS_EXIT, (const void *)(uintptr_t)(bl_Success ? SEMIHOST_EXIT_SUCCESS : SEMIHOST_EXIT_FAILURE));
+	return LL_SEMIHOST_OK;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  セミホスティング要求
+  * @param  u32_Op: 操作番号
+  * @param  pv_Arg: パラメーター(操作により意味が異なる)
+  * @retval 戻り値(R0)
+  */
+static int32_t semihost_call(uint32_t u32_Op, const void *pv_Arg)
+{
+#if defined(__arm__)
+	register uint32_t u32_R0 __asm("r0") = u32_Op;
+	register const void *pv_R1 __asm("r1") = pv_Arg;
+
+	__asm volatile ("bkpt 0xAB" : "+r" (u32_R0) : "r" (pv_R1) : "memory");
+	return (int32_t)u32_R0;
+#else
+	return (int32_t)__semihost((int)u32_Op, pv_Arg);
+#endif
+}
@@ -51,3 +51,17 @@ void LL_mDelay(uint32_t Delay)
 	}
 }
 
+/**
+  * @brief  DWTサイクルカウンター初期化処理
+  * @param  None
+  * @retval None
+  */
+void LL_DWT_Init(void)
+{
+	/* トレース機能有効 */
+	SET_BIT(CoreDebug->DEMCR, CoreDebug_DEMCR_TRCENA_Msk);
+	/* サイクルカウンター開始 */
+	DWT->CYCCNT = 0;
+	SET_BIT(DWT->CTRL, DWT_CTRL_CYCCNTENA_Msk);
+}
+
@@ -13,12 +13,14 @@
 /* Private typedef -----------------------------------------------------------*/
 
 /* Private define ------------------------------------------------------------*/
+#define CYCLE_TIME_CEILING	(IRQ_PRIO_SYSTICK)		/* 周期時間カウンターのシーリング(SysTick)	*/
 
 /* Private macro -------------------------------------------------------------*/
 
 /* Private variables ---------------------------------------------------------*/
-extern const uint32_t __StackTop;
-const uint32_t APPLICATION_VECTOR_TABLE_ADDRESS_RAM = (uint32_t)&__StackTop;
+/* リンカーシンボルは大きさの無い配列として宣言する(1要素の変数とみなした範囲外アクセス警告を避ける) */
+extern const uint32_t __StackTop[];
+const uintptr_t APPLICATION_VECTOR_TABLE_ADDRESS_RAM = (uintptr_t)__StackTop;
 
 volatile uint32_t *irq_vector_table;
 
@@ -29,6 +31,7 @@ volatile static uint32_t u32s_CycleTimeCounter;		/* 周期時間カウンター
 
 /* Private function prototypes -----------------------------------------------*/
 static void arduino_main(void);
+static uint8_t systick_clock_callback(uint8_t u8_Event, uint8_t u8_Mode);
 
 /* Exported functions --------------------------------------------------------*/
 
@@ -48,7 +51,10 @@ void SysTick_Handler(void)
   * @retval None
   */
 void hal_entry(void) {
-	arduino_main();
+	/* スタック監視ドライバー初期化処理(塗りつぶしとSPMON設定) */
+	taskStackDriverInit();
+	/* 以降はメインスタック(PSP)で実行し、割り込みだけがMSPを使用する */
+	stackStartMain(arduino_main);
 }
 
 /* Private functions ---------------------------------------------------------*/
@@ -60,52 +66,166 @@ void hal_entry(void) {
   */
 static void arduino_main(void)
 {
-	R_MPU_SPMON->SP[0].CTL = 0;
+	uint32_t u32_Mask;
 
+#if (__FPU_USED == 1)
+	/* ---- FPU 設定 ---- */
+	SCB->CPACR |= (0xFUL << 20);					// CP10/CP11 フルアクセス
+	// FPCCRはリセット値でASPEN=LSPEN=1(Lazy Stacking有効)のため設定しない
+	__DSB();
+	__ISB();
+#endif
+
+	/* ベクターテーブルの移動は全ての割り込みに関わるため全て禁止する */
 	__disable_irq();
 	irq_vector_table = (volatile uint32_t *)APPLICATION_VECTOR_TABLE_ADDRESS_RAM;
 	size_t _i;
 	for (_i=0; _i<BSP_CORTEX_VECTOR_TABLE_ENTRIES; _i++) {
-		*(irq_vector_table + _i) = (uint32_t)__VECTOR_TABLE[_i];
+		*(irq_vector_table + _i) = (uint32_t)(uintptr_t)__VECTOR_TABLE[_i];
 	}
 	for (_i=0; _i<BSP_ICU_VECTOR_MAX_ENTRIES; _i++) {
-		*(irq_vector_table + _i +BSP_CORTEX_VECTOR_TABLE_ENTRIES) = (uint32_t)g_vector_table[_i];
+		*(irq_vector_table + _i +BSP_CORTEX_VECTOR_TABLE_ENTRIES) = (uint32_t)(uintptr_t)g_vector_table[_i];
 	}
 
-	SCB->VTOR = (uint32_t)irq_vector_table;
+	SCB->VTOR = (uint32_t)(uintptr_t)irq_vector_table;
 
 	__DSB();
 	__enable_irq();
 
 	u32s_CycleTimeCounter = 0;
+	/* DWTサイクルカウンター初期化処理 */
+	LL_DWT_Init();
+	/* クロック管理ドライバー初期化処理(他のドライバーより先に行う) */
+	taskClockDriverInit();
+	if (clockRegisterCallback(systick_clock_callback) != OK) {
+		Error_Handler();
+	}
+	/* ウォッチドッグドライバー初期化処理(リセット要因の確定とWDT開始) */
+	taskWdtDriverInit();
 	/* タイマー初期化処理 */
 	taskTimerInit();
+	/* メモリプール初期化処理 */
+	poolInit();
+	/* コルーチン初期化処理 */
+	coroInit();
+	/* モニター初期化処理 */
+	monInit();
 	/* UARTドライバー初期化処理 */
 	taskUartDriverInit();
+	/* ADCドライバー初期化処理 */
+	taskAdcDriverInit();
+	/* GPIOドライバー初期化処理 */
+	taskGpioDriverInit();
+	/* 外部端子割り込みドライバー初期化処理 */
+	taskExtiDriverInit();
+	/* キー・バリューストア ドライバー初期化処理 */
+	taskKvsDriverInit();
+	/* USBドライバー初期化処理 */
+	taskUsbDriverInit();
+	/* IICドライバー初期化処理 */
+	taskIicDriverInit();
+#if !defined(BOARD_UNO_R4_WIFI)
+	/* SPIドライバー初期化処理(WiFiではP109/P110はSCI9のため使用しない) */
+	taskSpiDriverInit();
+#endif
+	/* CANドライバー初期化処理 */
+	taskCanDriverInit();
+	/* 割り込み遅延計測ドライバー初期化処理 */
+	taskLatDriverInit();
+	/* ESP32-S3リンクドライバー初期化処理 */
+	taskEspDriverInit();
+	/* LEDマトリクスドライバー初期化処理 */
+	taskMatrixDriverInit();
 	/* 初期化関数 */
 	setup();
 	/* SysTickタイマー開始 */
-	// MPUクロック=48MHz → 1tick=1ms
-	SysTick_Config(48000000 / 1000);
+	// MPUクロック(SystemCoreClock) → 1tick=1ms
+	SysTick_Config(SystemCoreClock / 1000);
 	/* Infinite loop */
 	while (true) {
 		/* 周期時間カウンターがシステムの周期時間[ms]に達した場合 */
 		if (u32s_CycleTimeCounter >= SYS_CYCLE_TIME) {
-			/* Disable Interrupts */
-			__disable_irq();
+			/* SysTick以下の優先度の割り込みを保留(BASEPRI) */
+			u32_Mask = LL_IRQ_Lock(CYCLE_TIME_CEILING);
 			u32s_CycleTimeCounter = 0;
-			/* Enable Interrupts */
-			__enable_irq();
+			/* BASEPRIを元に戻す */
+			LL_IRQ_Unlock(u32_Mask);
 
+			/* クロック管理ドライバー入力処理(負荷計測開始) */
+			taskClockDriverInput();
+			wdtCheckin(TASK_ID_CLOCK_IN);
 			/* タイマー更新処理 */
 			taskTimerUpdate();
+			wdtCheckin(TASK_ID_TIMER);
 			/* UARTドライバー入力処理 */
 			taskUartDriverInput();
+			wdtCheckin(TASK_ID_UART_IN);
+			/* GPIOドライバー入力処理 */
+			taskGpioDriverInput();
+			wdtCheckin(TASK_ID_GPIO_IN);
+			/* 外部端子割り込みドライバー入力処理 */
+			taskExtiDriverInput();
+			wdtCheckin(TASK_ID_EXTI_IN);
+			/* USBドライバー入力処理 */
+			taskUsbDriverInput();
+			wdtCheckin(TASK_ID_USB_IN);
+			/* IICドライバー入力処理 */
+			taskIicDriverInput();
+			wdtCheckin(TASK_ID_IIC_IN);
+#if !defined(BOARD_UNO_R4_WIFI)
+			/* SPIドライバー入力処理 */
+			taskSpiDriverInput();
+			wdtCheckin(TASK_ID_SPI_IN);
+#endif
+			/* CANドライバー入力処理 */
+			taskCanDriverInput();
+			wdtCheckin(TASK_ID_CAN_IN);
+			/* ESP32-S3リンクドライバー入力処理(受信フレームの組み立て) */
+			taskEspDriverInput();
+			wdtCheckin(TASK_ID_ESP_IN);
 			/* 周期処理関数 */
 			loop();
+			wdtCheckin(TASK_ID_LOOP);
+			/* ADCドライバー出力処理 */
+			taskAdcDriverOutput();
+			wdtCheckin(TASK_ID_ADC_OUT);
+			/* キー・バリューストア ドライバー出力処理(データフラッシュ書き込み) */
+			taskKvsDriverOutput();
+			wdtCheckin(TASK_ID_KVS_OUT);
+			/* スタック監視ドライバー出力処理(最大使用量の走査) */
+			taskStackDriverOutput();
+			wdtCheckin(TASK_ID_STACK_OUT);
+			/* USBドライバー出力処理 */
+			taskUsbDriverOutput();
+			wdtCheckin(TASK_ID_USB_OUT);
+			/* ESP32-S3リンクドライバー出力処理(フレームの送信/再送) */
+			taskEspDriverOutput();
+			wdtCheckin(TASK_ID_ESP_OUT);
 			/* UARTドライバー出力処理 */
 			taskUartDriverOutput();
+			wdtCheckin(TASK_ID_UART_OUT);
+			/* クロック管理ドライバー出力処理(負荷に応じたクロック切り替え) */
+			taskClockDriverOutput();
+			wdtCheckin(TASK_ID_CLOCK_OUT);
+			/* ウォッチドッグドライバー出力処理(全タスクの進行を確認してWDT更新) */
+			taskWdtDriverOutput();
 		}
 	}
 }
 
+/**
+  * @brief  クロック変更コールバック(SysTick)
+  * @param  u8_Event: CLOCK_EVENT_xxx
+  * @param  u8_Mode: 切り替え先の動作モード
+  * @retval OK
+  * @note   切り替え後に1tick=1msとなるよう設定し直す(切り替え時の1ms未満の端数は切り捨てる)
+  */
+static uint8_t systick_clock_callback(uint8_t u8_Event, uint8_t u8_Mode)
+{
+	(void)u8_Mode;
+	if ((u8_Event == CLOCK_EVENT_POST) && (SysTick->CTRL & SysTick_CTRL_ENABLE_Msk)) {
+		SysTick_Config(SystemCoreClock / 1000);
+	}
+	return OK;
+}
+
@@ -12,6 +12,16 @@
 
 /* Private typedef -----------------------------------------------------------*/
 
+/* SPIベンチマーク結果 */
+typedef struct _SpiBenchResult {
+	uint32_t u32_bytes;								/* 転送データ数[byte]		*/
+	uint32_t u32_time_us;							/* 転送時間の合計[us]		*/
+	uint32_t u32_cycles;							/* ドライバーのCPUサイクル数	*/
+	uint32_t u32_bitrate;							/* 転送速度[bps]			*/
+	uint8_t u8_errors;								/* 失敗した転送数			*/
+	bool bl_verify;									/* 受信データが一致			*/
+} SpiBenchResult;
+
 /* Private define ------------------------------------------------------------*/
 #define TIME_1S				(1000)					/* 1秒判定時間[ms]			*/
 #define UART_BUFF_SIZE		(64)					/* UARTバッファサイズ		*/
@@ -20,32 +30,316 @@
 #define UART_CMD_HELP		(0x08)					/* ヘルプ表示(^H)			*/
 #define UART_CMD_RESET		(0x12)					/* リセット(^R)				*/
 #define UART_CMD_SLEEP		(0x13)					/* スリープ(^S)				*/
+#define UART_CMD_ADC		(0x01)					/* ADCストリーミング(^A)	*/
+#define UART_CMD_DSP		(0x04)					/* DSPベンチマーク(^D)		*/
+#define UART_CMD_POOL		(0x10)					/* メモリプール(^P)			*/
+#define UART_CMD_WDT		(0x17)					/* ウォッチドッグ試験(^W)	*/
+#define UART_CMD_KVS		(0x0B)					/* キー・バリューストア(^K)	*/
+#define UART_CMD_STACK		(0x14)					/* スタック使用量(^T)		*/
+#define UART_CMD_STACK_TEST	(0x16)					/* スタックオーバーフロー試験(^V)	*/
+#define UART_CMD_PACKET		(0x15)					/* パケット受信(^U)			*/
+#define UART_CMD_CLOCK		(0x06)					/* クロック切り替え(^F)		*/
+#define UART_CMD_IIC		(0x09)					/* IIC自己診断(^I)			*/
+#define UART_CMD_SPI		(0x02)					/* SPIベンチマーク(^B)		*/
+#define UART_CMD_CAN		(0x0E)					/* CAN自己診断(^N)			*/
+#define UART_CMD_MONITOR	(0x05)					/* モニター(^E)				*/
+#define UART_CMD_MATRIX		(0x0C)					/* LEDマトリクス統計(^L)		*/
+
+/* ヘルプ表示(送信Queueに収まらないため1行ずつ表示する) */
+#define HELP_REPORT_NUM		(16)					/* 表示行数(WiFi: ^Bの代わりに^L)	*/
+
+/* ADCストリーミング設定 */
+/* 1ブロック = ヘッダー6byte + 3ch×64スキャン×2byte = 390byte。100Hzでは約610byte/sとなり、
+   9600bps(約960byte/s)のUARTにコマンド応答分の余裕を残して収まる */
+#define ADC_DEMO_CH_MASK	(0x07)					/* A0～A2					*/
+#define ADC_DEMO_RATE		(100)					/* サンプリング周波数[Hz]	*/
+
+/* 外部端子割り込み設定(D2 = P105 = IRQ0) */
+#define EXTI_DEMO_CH		(0)						/* IRQ0						*/
+#define EXTI_DEMO_DEBOUNCE	(20000)					/* デバウンス時間[us]		*/
+
+/* キー・バリューストア設定 */
+#define KVS_DEMO_KEY_BOOT	(0)						/* 起動回数					*/
+#define KVS_DEMO_KEY_UPTIME	(1)						/* 累積稼働時間[s]			*/
+#define KVS_REPORT_NUM		(3)						/* 統計情報の表示行数		*/
+
+/* スタック監視設定 */
+#define STACK_REPORT_NUM	(STACK_CTX_NUM + 1)		/* 使用量と診断情報の表示行数	*/
+#define STACK_TEST_FRAME	(64)					/* 試験で1段あたりに使う領域[byte]	*/
+#define STACK_TEST_DEPTH	((STACK_MAIN_SIZE / STACK_TEST_FRAME) + 8)	/* 試験の最大段数	*/
+
+/* パケット受信設定 */
+#define PKT_DEMO_IDLE_CHARS	(3)						/* 終端とする無受信の文字数	*/
+#define PKT_DEMO_EVENT		(0x00000001)			/* 表示要求(コルーチンのイベント)	*/
+#define PKT_DEMO_LOG_NUM	(8)						/* 表示待ちのパケット数		*/
+
+/* USBループバック設定 */
+#define USB_DEMO_CHUNK		(64)					/* 1回に折り返すサイズ[byte]	*/
+
+/* クロック切り替え設定 */
+#define CLOCK_REPORT_NUM	(2)						/* 統計情報の表示行数		*/
+
+/* IIC自己診断設定(スレーブは配線先に合わせる) */
+#define IIC_DEMO_EEPROM		(0x50)					/* EEPROM(24C02相当)			*/
+#define IIC_DEMO_SENSOR		(0x48)					/* 温度センサー				*/
+#define IIC_DEMO_MISSING	(0x30)					/* 存在しないスレーブ		*/
+#define IIC_DEMO_EEP_ADDR	(0x10)					/* EEPROMの試験アドレス		*/
+#define IIC_DEMO_EEP_SIZE	(8)						/* EEPROMの試験サイズ(1ページ)	*/
+#define IIC_DEMO_REG_TEMP	(0x00)					/* センサー 温度レジスタ	*/
+#define IIC_DEMO_REG_FAULT	(0xF0)					/* センサー 障害注入レジスタ	*/
+#define IIC_DEMO_FAULT_STRETCH	(0x01)				/* 障害注入 長いクロックストレッチ	*/
+#define IIC_DEMO_FAULT_STUCK	(0x02)					/* 障害注入 STOP後のSDA固定	*/
+#define IIC_DEMO_POLL_MAX	(40)					/* 書き込み完了待ちの最大回数	*/
+#define IIC_DEMO_NOT_DONE	(0xFF)					/* 結果 未完了				*/
+#define IIC_DEMO_REPORT_NUM	(3)						/* 結果の表示行数			*/
+
+/* IIC自己診断 段階 */
+#define IIC_DEMO_STEP_IDLE		(0)					/* 停止						*/
+#define IIC_DEMO_STEP_WRITE		(1)					/* EEPROM書き込み			*/
+#define IIC_DEMO_STEP_POLL		(2)					/* 書き込み完了待ち→読み出し	*/
+#define IIC_DEMO_STEP_STRETCH	(3)					/* タイムアウト試験			*/
+#define IIC_DEMO_STEP_RECOVER	(4)					/* バス復旧試験				*/
+#define IIC_DEMO_STEP_REPORT	(5)					/* 結果表示					*/
+
+/* IIC自己診断 転送番号 */
+#define IIC_DEMO_ID_EEP_WRITE		(0)				/* EEPROM書き込み			*/
+#define IIC_DEMO_ID_EEP_POLL		(1)				/* EEPROM書き込み完了待ち	*/
+#define IIC_DEMO_ID_EEP_READ		(2)				/* EEPROM読み返し			*/
+#define IIC_DEMO_ID_TEMP			(3)				/* 温度読み出し				*/
+#define IIC_DEMO_ID_MISSING			(4)				/* 存在しないスレーブ		*/
+#define IIC_DEMO_ID_FAULT_STRETCH	(5)				/* 障害注入(ストレッチ)	*/
+#define IIC_DEMO_ID_STRETCH_READ	(6)				/* 温度読み出し(タイムアウト)	*/
+#define IIC_DEMO_ID_FAULT_STUCK		(7)				/* 障害注入(SDA固定)		*/
+#define IIC_DEMO_ID_STUCK_READ		(8)				/* 温度読み出し(STOP後にSDA固定)	*/
+#define IIC_DEMO_ID_STUCK_PROBE		(9)				/* 応答確認(バスエラー)	*/
+#define IIC_DEMO_ID_AFTER			(10)				/* 復旧後の温度読み出し	*/
+#define IIC_DEMO_ID_NUM				(11)				/* 転送数					*/
+
+/* SPIベンチマーク設定 */
+#define SPI_BENCH_BITRATE	(12000000)				/* デバイスの転送速度上限[bps]	*/
+#define SPI_BENCH_SIZE		(1024)					/* 1試験の転送データ数[byte]	*/
+#define SPI_BENCH_CHUNKS	(2)						/* 1試験の転送要求数(CS保持で連結)	*/
+#define SPI_BENCH_CASE_NUM	(5)						/* 試験数					*/
+#define SPI_BENCH_REPORT_NUM	(SPI_BENCH_CASE_NUM + 1)	/* 結果の表示行数	*/
+
+/* CAN自己診断設定(通常モードの試験はバスの相手ノードが応答ノードの場合) */
+#define CAN_DEMO_BITRATE	(500000)				/* 通信速度[bps]			*/
+#define CAN_DEMO_FILTER_NUM	(3)						/* フィルター数(受信FIFO 2+メールボックス 1)	*/
+#define CAN_DEMO_FRAME_NUM	(12)					/* ループバック試験の送信フレーム数	*/
+#define CAN_DEMO_PROBE_ID	(0x321)					/* 応答確認のID(応答はID+1)	*/
+#define CAN_DEMO_RECOVER_ID	(0x123)					/* バスオフ復帰後の応答確認のID	*/
+#define CAN_DEMO_FAULT_ID	(0x7FF)					/* 障害注入のID(相手ノードがバスをドミナント固定)	*/
+#define CAN_DEMO_FAULT_MS	(20)					/* 障害注入 ドミナント固定時間[ms]	*/
+#define CAN_DEMO_WAIT_MAX	(40)					/* 各段階の完了待ちの最大周期数	*/
+#define CAN_DEMO_REPORT_NUM	(4)						/* 結果の表示行数			*/
+
+/* CAN自己診断 段階 */
+#define CAN_DEMO_STEP_IDLE		(0)					/* 停止						*/
+#define CAN_DEMO_STEP_LOOP		(1)					/* 内部ループバック(フィルター,データ)	*/
+#define CAN_DEMO_STEP_BUS		(2)					/* 通常モード(相手ノードの応答)	*/
+#define CAN_DEMO_STEP_BUSOFF	(3)					/* 通常モード(バスオフと復帰)	*/
+
+/* CAN自己診断 結果 */
+#define CAN_DEMO_SKIP		(0)						/* 未実施					*/
+#define CAN_DEMO_PASS		(1)						/* 合格						*/
+#define CAN_DEMO_FAIL		(2)						/* 不合格					*/
+
+/* LEDマトリクス設定 */
+#define MATRIX_DEMO_CYCLES	(20)					/* 描画の周期数(100ms)		*/
 
 /* Private macro -------------------------------------------------------------*/
 
 /* Private variables ---------------------------------------------------------*/
-static Timer sts_Timer1s;							/* 1秒タイマー				*/
 static uint8_t u8s_RcvData[UART_BUFF_SIZE];			/* UART受信データ			*/
 static uint16_t u16s_RcvDataSize;					/* UART受信データサイズ		*/
+static uint8_t u8s_HelpReportIndex = HELP_REPORT_NUM;	/* ヘルプ表示位置			*/
+static DspBenchResult sts_DspBench[DSP_BENCH_KERNEL_NUM];	/* DSPベンチマーク結果	*/
+static uint8_t u8s_DspReportIndex = DSP_BENCH_KERNEL_NUM;	/* DSPベンチマーク表示位置	*/
+static uint8_t u8s_PoolReportIndex = POOL_CLASS_NUM;		/* メモリプール統計表示位置	*/
+static uint8_t u8s_KvsReportIndex = KVS_REPORT_NUM;			/* キー・バリューストア統計表示位置	*/
+static uint32_t u32s_KvsBootCount;					/* 起動回数					*/
+static uint32_t u32s_KvsUptime;						/* 累積稼働時間[s]			*/
+static uint8_t u8s_StackReportIndex = STACK_REPORT_NUM;		/* スタック使用量表示位置	*/
+static uint16_t u16s_PktLogSize[PKT_DEMO_LOG_NUM];	/* 受信パケットのサイズ		*/
+static uint32_t u32s_PktLogTime[PKT_DEMO_LOG_NUM];	/* 受信パケットの時刻[us]	*/
+volatile static uint8_t u8s_PktLogHead;				/* 登録位置(割り込みで更新)	*/
+volatile static uint8_t u8s_PktLogTail;				/* 表示位置					*/
+volatile static bool bls_PktStopRequest;			/* パケット受信の停止要求	*/
+static bool bls_UsbOpen;							/* USB仮想COMポートのオープン状態	*/
+#if defined(BOARD_UNO_R4_WIFI)
+static bool bls_EspUp;								/* ESP32-S3リンクの通信状態	*/
+static uint8_t u8s_MatrixDemoWait;					/* LEDマトリクス 次の描画までの周期数	*/
+static uint8_t u8s_MatrixDemoPhase;					/* LEDマトリクス 描画の位相	*/
+#endif
+static uint8_t u8s_ClockDemoMode = CLOCK_MODE_AUTO;	/* 指定中の動作モード		*/
+static uint8_t u8s_ClockReportIndex = CLOCK_REPORT_NUM;		/* クロック統計表示位置	*/
+static uint8_t u8s_IicDemoStep = IIC_DEMO_STEP_IDLE;	/* IIC自己診断の段階		*/
+static uint8_t u8s_IicDemoPending;					/* IIC自己診断の完了待ち転送数	*/
+static uint8_t u8s_IicDemoPolls;					/* EEPROM書き込み完了待ちの回数	*/
+static uint8_t u8s_IicDemoResult[IIC_DEMO_ID_NUM];	/* 転送結果(IIC_RESULT_xxx)	*/
+static uint8_t u8s_IicReportIndex = IIC_DEMO_REPORT_NUM;	/* IIC自己診断結果表示位置	*/
+static IicStatistics sts_IicDemoBefore;				/* 自己診断開始時の統計情報	*/
+static uint8_t u8s_IicDemoEepWrite[1 + IIC_DEMO_EEP_SIZE];	/* EEPROM書き込みデータ(アドレス+データ)	*/
+static uint8_t u8s_IicDemoEepPtr[1];				/* EEPROM読み出しアドレス	*/
+static uint8_t u8s_IicDemoEepRead[IIC_DEMO_EEP_SIZE];	/* EEPROM読み返しデータ	*/
+static uint8_t u8s_IicDemoTempPtr[1];				/* センサー 温度レジスタ番号	*/
+static uint8_t u8s_IicDemoTemp[2];					/* センサー 温度				*/
+static uint8_t u8s_IicDemoFault[2][2];				/* センサー 障害注入データ	*/
+static uint8_t u8s_IicDemoScratch[6];				/* 障害試験の受信データ		*/
+#if !defined(BOARD_UNO_R4_WIFI)
+static uint8_t u8s_SpiBenchCase = SPI_BENCH_CASE_NUM;	/* SPIベンチマークの実行中の試験	*/
+static bool bls_SpiBenchSubmitted;					/* 試験の転送を登録済み		*/
+static uint8_t u8s_SpiBenchPending;					/* 完了待ちの転送数			*/
+static SpiStatistics sts_SpiBenchBefore;			/* 試験開始時の統計情報		*/
+static SpiBenchResult sts_SpiBench[SPI_BENCH_CASE_NUM];	/* SPIベンチマーク結果	*/
+static uint8_t u8s_SpiReportIndex = SPI_BENCH_REPORT_NUM;	/* SPIベンチマーク表示位置	*/
+static uint32_t u32s_SpiBenchTx[SPI_BENCH_SIZE / 4];	/* 送信データ				*/
+static uint32_t u32s_SpiBenchRx[SPI_BENCH_SIZE / 4];	/* 受信データ				*/
+#endif
+static uint8_t u8s_CanDemoStep = CAN_DEMO_STEP_IDLE;	/* CAN自己診断の段階		*/
+static uint8_t u8s_CanDemoWait;						/* 段階の完了待ちの周期数	*/
+static uint16_t u16s_CanDemoSeen;					/* 受信した試験フレーム(番号のbit)	*/
+static uint8_t u8s_CanDemoRx;						/* ループバック試験の受信フレーム数	*/
+static bool bls_CanDemoFilter;						/* フィルター通りに受信した	*/
+static bool bls_CanDemoData;						/* 受信データが一致			*/
+static bool bls_CanDemoNode;						/* 相手ノードが応答した		*/
+static uint8_t u8s_CanDemoEcho;						/* 応答データの照合結果(CAN_DEMO_xxx)	*/
+static uint8_t u8s_CanDemoBusOff;					/* バスオフ復帰の結果(CAN_DEMO_xxx)	*/
+static bool bls_CanDemoRecovered;					/* バスオフ復帰後に応答を受信した	*/
+static CanStatus sts_CanDemoBus;					/* 通常モード試験の終了時の状態	*/
+static CanStatus sts_CanDemoBefore;					/* バスオフ試験開始時の状態	*/
+static uint8_t u8s_CanReportIndex = CAN_DEMO_REPORT_NUM;	/* CAN自己診断結果表示位置	*/
 
-/* Private function prototypes -----------------------------------------------*/
-static void port_irq0_init(void);					/* PORT_IRQ0 初期化処理					*/
+/* ヘルプ表示(UART命令) */
+static const char *const ps8s_HelpLine[] = {
+	"^H :Help",
+	"^R :Reset",
+	"^S :Sleep",
+	"^A :ADC stream",
+	"^D :DSP benchmark",
+	"^P :Pool benchmark",
+	"^W :Watchdog test",
+	"^K :KVS flush",
+	"^T :Stack usage",
+	"^V :Stack overflow test",
+	"^U :Packet receive (^U packet to stop)",
+	"^F :Clock mode (Auto/High/Middle/Low)",
+	"^I :IIC self-test",
+#if !defined(BOARD_UNO_R4_WIFI)
+	"^B :SPI benchmark",
+#endif
+	"^N :CAN self-test",
+	"^E :Monitor shell",
+#if defined(BOARD_UNO_R4_WIFI)
+	"^L :LED matrix statistics",
+#endif
+};
+_Static_assert((sizeof(ps8s_HelpLine) / sizeof(ps8s_HelpLine[0])) == HELP_REPORT_NUM, "HELP_REPORT_NUM mismatch");
 
-/* Exported functions --------------------------------------------------------*/
+/* リセット要因の表示名 */
+static const char *const ps8s_ResetCauseName[WDT_RESET_NUM] = {
+	"PowerOn", "Pin", "Software", "Watchdog", "Error", "Stack"
+};
 
-/**
-  * @brief  外部端子割り込み0ハンドラ
-  * @param  None
-  * @retval None
-  */
-void PORT_IRQ0_Handler(void)
-{
-    /* 割り込み要求フラグ クリア */
-	R_ICU->IELSR_b[IRQ_PORT_IRQ0].IR = 0;
+/* スタックのコンテキスト名 */
+static const char *const ps8s_StackCtxName[STACK_CTX_NUM] = {
+	"main", "isr"
+};
 
-	/* 文字を出力する */
-	uartEchoStr("Exti12");
-}
+#if !defined(BOARD_UNO_R4_WIFI)
+/* SPIベンチマークの試験(送信のみ: 表示器への転送, 送受信: ループバックで照合) */
+static const char *const ps8s_SpiBenchName[SPI_BENCH_CASE_NUM] = {
+	"tx8  ", "tx16 ", "tx32 ", "dup8 ", "dup32"
+};
+static const uint8_t u8s_SpiBenchBits[SPI_BENCH_CASE_NUM] = {8, 16, 32, 8, 32};
+static const bool bls_SpiBenchDuplex[SPI_BENCH_CASE_NUM] = {false, false, false, true, true};
+
+/* SPIベンチマークのデバイス */
+static const SpiDevice sts_SpiBenchDisplay = {SPI_CS_PORT, SPI_CS_MASK, SPI_MODE_0, 0, SPI_BENCH_BITRATE};
+static const SpiDevice sts_SpiBenchLoopback = {SPI_CS_PORT, SPI_CS_MASK, SPI_MODE_0, SPI_OPT_LOOPBACK, SPI_BENCH_BITRATE};
+#endif
+
+/* CAN自己診断のフィルター */
+static const CanFilter sts_CanDemoFilters[CAN_DEMO_FILTER_NUM] = {
+	{0x100, 0x7F0},									/* 受信FIFO: 0x100～0x10F		*/
+	{CAN_ID_EXT | 0x18FF0000, 0x1FFF0000},			/* 受信FIFO: 拡張ID 0x18FFxxxx	*/
+	{0x7DF, CAN_ID_STD_MASK},						/* メールボックス: 0x7DFのみ	*/
+};
+
+/* CAN自己診断のループバック試験フレーム(受信すべきものはbls_CanDemoAccept) */
+static const uint32_t u32s_CanDemoIds[CAN_DEMO_FRAME_NUM] = {
+	0x100, 0x101, 0x10F, 0x110, 0x200, CAN_ID_EXT | 0x100,
+	CAN_ID_EXT | 0x18FF1234, CAN_ID_EXT | 0x18FF0001, CAN_ID_EXT | 0x18FE0001,
+	0x7DF, 0x7DE, 0x108
+};
+static const bool bls_CanDemoAccept[CAN_DEMO_FRAME_NUM] = {
+	true, true, true, false, false, false,
+	true, true, false,
+	true, false, true
+};
+
+/* CAN状態と結果の表示名 */
+static const char *const ps8s_CanStateName[] = {
+	"Stopped", "Active", "Warning", "Passive", "BusOff"
+};
+static const char *const ps8s_CanDemoResultName[] = {
+	"SKIP", "PASS", "FAIL"
+};
+
+/* クロック動作モードの表示名 */
+static const char *const ps8s_ClockModeName[CLOCK_MODE_NUM] = {
+	"High", "Middle", "Low"
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static void uart_cmd_task(Coro *pst_Coro);			/* UART命令 コルーチン					*/
+static void uart_cmd_exec(uint8_t u8_Cmd);			/* UART命令 実行処理					*/
+static void led_demo_task(Coro *pst_Coro);			/* LED点灯 コルーチン					*/
+static void uptime_tick(void);						/* 累積稼働時間の更新(1秒毎)			*/
+static void exti_demo_init(void);					/* 外部端子割り込み 初期化処理			*/
+static void exti_demo_report(void);					/* 外部端子割り込み イベント表示		*/
+static void adc_stream_toggle(void);				/* ADCストリーミング開始/停止			*/
+static void pool_report_bench(void);				/* メモリプール ベンチマーク結果表示	*/
+static void pool_report_class(uint8_t u8_Class);	/* メモリプール 統計情報表示			*/
+static void reset_report(void);						/* リセット要因表示						*/
+static void kvs_demo_init(void);					/* キー・バリューストア 初期化処理		*/
+static void kvs_demo_report(uint8_t u8_Line);		/* キー・バリューストア 統計情報表示	*/
+static void stack_report(uint8_t u8_Line);			/* スタック使用量表示					*/
+static uint32_t stack_overflow_test(uint32_t u32_Depth);	/* スタックオーバーフロー試験		*/
+static void packet_demo_start(void);				/* パケット受信 開始処理				*/
+static void packet_demo_callback(const uint8_t *pu8_Data, uint16_t u16_Size, uint32_t u32_TimeUs);	/* パケット受信コールバック	*/
+static void packet_demo_report(void);				/* パケット受信 表示処理				*/
+static void packet_demo_task(Coro *pst_Coro);		/* パケット受信 表示コルーチン			*/
+static void usb_demo_loopback(void);				/* USBループバック処理					*/
+static void usb_demo_report(void);					/* USBオープン/クローズ表示				*/
+#if defined(BOARD_UNO_R4_WIFI)
+static void esp_demo_start(void);					/* ESP32-S3リンク 開始処理				*/
+static bool esp_demo_echo(uint8_t u8_Ch, const uint8_t *pu8_Data, uint16_t u16_Size);	/* ESP32-S3リンク 受信データの折り返し	*/
+static void esp_demo_report(void);					/* ESP32-S3リンク 接続/切断表示			*/
+static void matrix_demo_start(void);				/* LEDマトリクス 表示開始				*/
+static void matrix_demo_run(void);					/* LEDマトリクス 描画					*/
+static void matrix_demo_report(void);				/* LEDマトリクス 統計情報表示			*/
+#endif
+static void clock_demo_next(void);					/* クロック動作モード切り替え			*/
+static void clock_report(uint8_t u8_Line);			/* クロック統計情報表示					*/
+static void iic_demo_start(void);					/* IIC自己診断 開始処理					*/
+static void iic_demo_run(void);						/* IIC自己診断 実行処理					*/
+static void iic_demo_submit(uint8_t u8_Id, uint8_t u8_Addr, const uint8_t *pu8_Tx, uint16_t u16_TxSize, uint8_t *pu8_Rx, uint16_t u16_RxSize);	/* IIC自己診断 転送登録	*/
+static void iic_demo_callback(const IicTransfer *pst_Xfer, uint8_t u8_Result, uint32_t u32_TimeUs);	/* IIC自己診断 転送完了コールバック	*/
+static void iic_demo_report(uint8_t u8_Line);		/* IIC自己診断 結果表示					*/
+#if !defined(BOARD_UNO_R4_WIFI)
+static void spi_bench_start(void);					/* SPIベンチマーク 開始処理				*/
+static void spi_bench_run(void);					/* SPIベンチマーク 実行処理				*/
+static void spi_bench_callback(const SpiTransfer *pst_Xfer, uint8_t u8_Result, uint32_t u32_TimeUs);	/* SPIベンチマーク 転送完了コールバック	*/
+static void spi_bench_report(uint8_t u8_Line);		/* SPIベンチマーク 結果表示				*/
+#endif
+static void can_demo_start(void);					/* CAN自己診断 開始処理					*/
+static void can_demo_run(void);						/* CAN自己診断 実行処理					*/
+static void can_demo_frame(uint8_t u8_Index, uint32_t u32_Id, CanFrame *pst_Frame);	/* CAN自己診断 試験フレーム作成	*/
+static void can_demo_check(const CanFrame *pst_Frame);	/* CAN自己診断 受信フレーム照合			*/
+static void can_demo_report(uint8_t u8_Line);		/* CAN自己診断 結果表示					*/
+
+/* Exported functions --------------------------------------------------------*/
 
 /**
   * @brief  初期化関数
@@ -54,23 +348,46 @@ void PORT_IRQ0_Handler(void)
   */
 void setup(void)
 {
+	StackOverflowInfo st_StackInfo;
+
 	mem_set08(&u8s_RcvData[0], 0x00, UART_BUFF_SIZE);
 	u16s_RcvDataSize = 0;
 
 	// 各ポートの方向設定
-	R_PORT1->PDR_b.PDR11 = 1;						// SCK LED(P111): 出力
-	R_PORT0->PDR_b.PDR12 = 1;						// TX LED(P012): 出力
-	R_PORT0->PDR_b.PDR13 = 1;						// RX LED(P013): 出力
+	gpioSetOutput(LED_SCK_PORT, LED_SCK_MASK);		// SCK LED(P111): 出力
+	gpioSetOutput(LED_TXRX_PORT, LED_TX_MASK | LED_RX_MASK);	// TX/RX LED(P012/P013): 出力
+#if !defined(BOARD_UNO_R4_WIFI)
+	gpioSet(SPI_CS_PORT, SPI_CS_MASK);				// SPI CS(P112): 非選択
+	gpioSetOutput(SPI_CS_PORT, SPI_CS_MASK);		// SPI CS(P112): 出力
+#endif
 
-	/* PORT_IRQ0 初期化処理 */
-	port_irq0_init();
+	/* 外部端子割り込み 初期化処理 */
+	exti_demo_init();
+	/* キー・バリューストア 初期化処理 */
+	kvs_demo_init();
+#if defined(BOARD_UNO_R4_WIFI)
+	/* ESP32-S3リンク 開始処理 */
+	esp_demo_start();
+	/* LEDマトリクス 表示開始 */
+	matrix_demo_start();
+#endif
 
-	/* タイマーを開始する */
-	startTimer(&sts_Timer1s);
+	/* コルーチンを開始する(UART命令→パケット受信表示→LEDの順に再開する) */
+	if ((coroStart(uart_cmd_task) == CORO_ID_NONE)
+	 || (coroStart(packet_demo_task) == CORO_ID_NONE)
+	 || (coroStart(led_demo_task) == CORO_ID_NONE)) {
+		Error_Handler();
+	}
 
 	/* プログラム開始メッセージを表示する */
 	uartEchoStrln("");
 	uartEchoStrln("Start UART/GPIO sample!!");
+	/* リセット要因を表示する */
+	reset_report();
+	/* スタックオーバーフローの記録があれば表示する */
+	if (stackGetOverflowInfo(&st_StackInfo)) {
+		u8s_StackReportIndex = 0;
+	}
 }
 
 /**
@@ -80,82 +397,87 @@ void setup(void)
   */
 void loop(void)
 {
-	static uint8_t u8_led_state = 0;
-
-	/* UART受信データを取得する */
-	u16s_RcvDataSize = uartGetRxData(&u8s_RcvData[0], UART_BUFF_SIZE);
-	/* UART受信データが存在する場合 */
-	if (u16s_RcvDataSize > 0) {
-		/* UART送信データを登録する */
-		uartSetTxData(&u8s_RcvData[0], u16s_RcvDataSize);
-
-		/* UART命令解析 */
-		switch (u8s_RcvData[0]) {
-		/* ヘルプ表示(^H) */
-		case UART_CMD_HELP:
-			/* UART命令表示 */
-			uartEchoStrln("");
-			uartEchoStrln("^H :Help");
-			uartEchoStrln("^R :Reset");
-			uartEchoStrln("^S :Sleep");
-			break;
-		/* リセット(^R) */
-		case UART_CMD_RESET:
-			/* リセット処理 */
-			NVIC_SystemReset();
-			break;
-		/* スリープ(^S) */
-		case UART_CMD_SLEEP:
-			/* SysTickタイマー停止 */
-			LL_SYSTICK_DisableIT();
-			/* イベント待機 */
-			__WFE();
-			__WFE();
-			/* SysTickタイマー開始 */
-			LL_SYSTICK_EnableIT();
-			/* 文字を出力する */
-			uartEchoStr("<Wakeup!!>");
-			break;
-		}
-	}
+	/* 待ち条件の成立したコルーチンを再開する(UART命令,パケット受信表示,LED) */
+	coroRun();
 
-	/* 1秒判定時間が満了した場合 */
-	if (checkTimer(&sts_Timer1s, TIME_1S)) {
-		/* ユーザーLEDを反転出力する */
-		switch (u8_led_state) {
-		case 0:
-			// 各ポートの出力データ設定(1)
-			R_PORT1->PODR_b.PODR11 = 1;				// SCK LED(P111): High出力(点灯)
-			R_PORT0->PODR_b.PODR12 = 1;				// TX LED(P012): High出力(消灯)
-			R_PORT0->PODR_b.PODR13 = 1;				// RX LED(P013): High出力(消灯)
-			break;
-		case 1:
-			// 各ポートの出力データ設定(2)
-//			R_PORT1->PODR_b.PODR11 = 0;				// SCK LED(P111): High出力(消灯)
-//			R_PORT0->PODR_b.PODR12 = 0;				// TX LED(P012): High出力(点灯)
-//			R_PORT0->PODR_b.PODR13 = 1;				// RX LED(P013): High出力(消灯)
-			R_PORT1->PORR = 0x0800;
-			R_PORT0->PORR = 0x1000;
-			R_PORT0->POSR = 0x2000;
-			break;
-		case 2:
-	// 各ポートの出力データ設定(3)
-//			R_PORT1->PODR_b.PODR11 = 0;				// SCK LED(P111): High出力(消灯)
-//			R_PORT0->PODR_b.PODR12 = 1;				// TX LED(P012): High出力(消灯)
-//			R_PORT0->PODR_b.PODR13 = 0;				// RX LED(P013): High出力(点灯)
-			R_PORT1->PORR_b.PORR11 = 1;
-			R_PORT0->POSR_b.POSR12 = 1;
-			R_PORT0->PORR_b.PORR13 = 1;
-			break;
+	/* ヘルプを1行ずつ表示する(送信Queueが空いてから) */
+	if ((u8s_HelpReportIndex < HELP_REPORT_NUM) && (uartGetTxCount() == 0)) {
+		uartEchoStrln(ps8s_HelpLine[u8s_HelpReportIndex]);
+		u8s_HelpReportIndex++;
+	}
+	/* DSPベンチマーク結果を1行ずつ表示する(送信Queueが空いてから) */
+	else if ((u8s_DspReportIndex < DSP_BENCH_KERNEL_NUM) && (uartGetTxCount() == 0)) {
+		uartEchoStr(sts_DspBench[u8s_DspReportIndex].ps8_name);
+		uartEchoStr(" cycles/sample(x100)=");
+		uartEchoHex32(sts_DspBench[u8s_DspReportIndex].u32_cycles_x100);
+		if (sts_DspBench[u8s_DspReportIndex].u32_ref_cycles_x100 != 0) {
+			uartEchoStr(" ref=");
+			uartEchoHex32(sts_DspBench[u8s_DspReportIndex].u32_ref_cycles_x100);
 		}
-		u8_led_state++;
-		u8_led_state = u8_led_state % 3;
-		/* 文字を出力する */
-		uartEchoStr(".");
-
-		/* タイマーを再開する */
-		startTimer(&sts_Timer1s);
+		uartEchoStrln("");
+		u8s_DspReportIndex++;
+	}
+	/* メモリプール統計を1行ずつ表示する(送信Queueが空いてから) */
+	else if ((u8s_PoolReportIndex < POOL_CLASS_NUM) && (uartGetTxCount() == 0)) {
+		pool_report_class(u8s_PoolReportIndex);
+		u8s_PoolReportIndex++;
+	}
+	/* キー・バリューストア統計を1行ずつ表示する(送信Queueが空いてから) */
+	else if ((u8s_KvsReportIndex < KVS_REPORT_NUM) && (uartGetTxCount() == 0)) {
+		kvs_demo_report(u8s_KvsReportIndex);
+		u8s_KvsReportIndex++;
+	}
+	/* スタック使用量を1行ずつ表示する(送信Queueが空いてから) */
+	else if ((u8s_StackReportIndex < STACK_REPORT_NUM) && (uartGetTxCount() == 0)) {
+		stack_report(u8s_StackReportIndex);
+		u8s_StackReportIndex++;
+	}
+	/* クロック統計を1行ずつ表示する(送信Queueが空き,動作モードが切り替わってから) */
+	else if ((u8s_ClockReportIndex < CLOCK_REPORT_NUM) && (uartGetTxCount() == 0)
+	 && ((u8s_ClockDemoMode == CLOCK_MODE_AUTO) || (clockGetMode() == u8s_ClockDemoMode))) {
+		clock_report(u8s_ClockReportIndex);
+		u8s_ClockReportIndex++;
 	}
+	/* IIC自己診断結果を1行ずつ表示する(送信Queueが空いてから) */
+	else if ((u8s_IicReportIndex < IIC_DEMO_REPORT_NUM) && (uartGetTxCount() == 0)) {
+		iic_demo_report(u8s_IicReportIndex);
+		u8s_IicReportIndex++;
+	}
+#if !defined(BOARD_UNO_R4_WIFI)
+	/* SPIベンチマーク結果を1行ずつ表示する(送信Queueが空いてから) */
+	else if ((u8s_SpiReportIndex < SPI_BENCH_REPORT_NUM) && (uartGetTxCount() == 0)) {
+		spi_bench_report(u8s_SpiReportIndex);
+		u8s_SpiReportIndex++;
+	}
+#endif
+	/* CAN自己診断結果を1行ずつ表示する(送信Queueが空いてから) */
+	else if ((u8s_CanReportIndex < CAN_DEMO_REPORT_NUM) && (uartGetTxCount() == 0)) {
+		can_demo_report(u8s_CanReportIndex);
+		u8s_CanReportIndex++;
+	}
+
+	/* 外部端子割り込みのイベントを表示する */
+	exti_demo_report();
+	/* USB受信データを折り返し送信する */
+	usb_demo_loopback();
+	/* USBのオープン/クローズを表示する */
+	usb_demo_report();
+#if defined(BOARD_UNO_R4_WIFI)
+	/* ESP32-S3リンクの接続/切断を表示する */
+	esp_demo_report();
+	/* LEDマトリクスを描画する */
+	matrix_demo_run();
+#endif
+	/* IIC自己診断を進める */
+	iic_demo_run();
+#if !defined(BOARD_UNO_R4_WIFI)
+	/* SPIベンチマークを進める */
+	spi_bench_run();
+#endif
+	/* CAN自己診断を進める */
+	can_demo_run();
+	/* モニターの出力を進める */
+	monRun();
 }
 
 /**
@@ -165,10 +487,16 @@ void loop(void)
   */
 void Error_Handler(void)
 {
+	/* エラー停止を記録する(WDTのタイムアウトでリセットされる) */
+	wdtNotifyError();
 	__disable_irq();
+#if !defined(BOARD_UNO_R4_WIFI)
+	/* SCK LED(P111)をRSPCKAから汎用入出力に戻す */
+	spiReleasePins();
+#endif
 	while (true) {
 		/* SCK LED(P111)を反転出力する */
-		R_PORT1->PODR_b.PODR11 = !R_PORT1->PODR_b.PODR11;
+		gpioToggle(LED_SCK_PORT, LED_SCK_MASK);
 		/* 100ms待つ */
 		LL_mDelay(100);
 	}
@@ -177,43 +505,1440 @@ void Error_Handler(void)
 /* Private functions ---------------------------------------------------------*/
 
 /**
-  * @brief  PORT_IRQ0 初期化処理
+  * @brief  UART命令 コルーチン
+  * @param  pst_Coro: コルーチン情報
+  * @retval None
+  */
+static void uart_cmd_task(Coro *pst_Coro)
+{
+	CORO_BEGIN(pst_Coro);
+	while (true) {
+		/* UART受信データを待つ */
+		CORO_AWAIT_UART_RX(pst_Coro);
+		/* UART受信データを取得する */
+		u16s_RcvDataSize = uartGetRxData(&u8s_RcvData[0], UART_BUFF_SIZE);
+		/* モニター動作中は1行ずつの命令として渡す */
+		if (monIsActive()) {
+			monInput(&u8s_RcvData[0], u16s_RcvDataSize);
+		}
+		else if (u16s_RcvDataSize > 0) {
+			/* UART送信データを登録する */
+			uartSetTxData(&u8s_RcvData[0], u16s_RcvDataSize);
+			/* UART命令解析 */
+			uart_cmd_exec(u8s_RcvData[0]);
+		}
+	}
+	CORO_END(pst_Coro);
+}
+
+/**
+  * @brief  UART命令 実行処理
+  * @param  u8_Cmd: 受信データの先頭(UART_CMD_xxx)
+  * @retval None
+  */
+static void uart_cmd_exec(uint8_t u8_Cmd)
+{
+	switch (u8_Cmd) {
+	/* ヘルプ表示(^H) */
+	case UART_CMD_HELP:
+		/* UART命令表示(周期処理で1行ずつ表示する) */
+		uartEchoStrln("");
+		u8s_HelpReportIndex = 0;
+		break;
+	/* リセット(^R) */
+	case UART_CMD_RESET:
+		/* リセット処理(リセット要因を記録する) */
+		wdtSystemReset();
+		break;
+	/* スリープ(^S) */
+	case UART_CMD_SLEEP:
+		/* SysTickタイマー停止 */
+		LL_SYSTICK_DisableIT();
+		/* イベント待機 */
+		__WFE();
+		__WFE();
+		/* SysTickタイマー開始 */
+		LL_SYSTICK_EnableIT();
+		/* 文字を出力する */
+		uartEchoStr("<Wakeup!!>");
+		break;
+	/* ADCストリーミング(^A) */
+	case UART_CMD_ADC:
+		/* ADCストリーミング開始/停止 */
+		adc_stream_toggle();
+		break;
+	/* DSPベンチマーク(^D) */
+	case UART_CMD_DSP:
+		/* セルフテストとベンチマークを実行する */
+		uartEchoStrln("");
+		uartEchoStr("DSP float=");
+		uartEchoStr(dspGetFloatAbi());
+		uartEchoStr(" selftest=");
+		uartEchoHex32(dspSelfTest());
+		uartEchoStrln("");
+		dspBenchmark(&sts_DspBench[0]);
+		u8s_DspReportIndex = 0;
+		break;
+	/* メモリプール(^P) */
+	case UART_CMD_POOL:
+		/* セルフテストとベンチマークを実行する */
+		uartEchoStrln("");
+		uartEchoStr("POOL selftest=");
+		uartEchoHex32(poolSelfTest());
+		uartEchoStrln("");
+		pool_report_bench();
+		u8s_PoolReportIndex = 0;
+		break;
+	/* ウォッチドッグ試験(^W) */
+	case UART_CMD_WDT:
+		/* 周期処理を停止させ、WDTリセットを発生させる */
+		while (true) {
+		}
+		break;
+	/* キー・バリューストア(^K) */
+	case UART_CMD_KVS:
+		/* 未書き込みの値を書き込み、統計情報を表示する */
+		kvsFlush();
+		uartEchoStrln("");
+		u8s_KvsReportIndex = 0;
+		break;
+	/* スタック使用量(^T) */
+	case UART_CMD_STACK:
+		uartEchoStrln("");
+		u8s_StackReportIndex = 0;
+		break;
+	/* スタックオーバーフロー試験(^V) */
+	case UART_CMD_STACK_TEST:
+		/* メインスタックを使い切り、SPMONのNMIでリセットさせる */
+		uartEchoStrln("");
+		uartEchoStr("STACK test depth=");
+		uartEchoHex32(stack_overflow_test(0));
+		uartEchoStrln("");
+		break;
+	/* パケット受信(^U) */
+	case UART_CMD_PACKET:
+		/* アイドル区切りのパケット受信に切り替える */
+		packet_demo_start();
+		break;
+	/* クロック切り替え(^F) */
+	case UART_CMD_CLOCK:
+		/* 自動→高速→中速→低速→自動の順に切り替え、統計情報を表示する */
+		clock_demo_next();
+		break;
+	/* IIC自己診断(^I) */
+	case UART_CMD_IIC:
+		/* EEPROMとセンサーへの転送,NACK,タイムアウト,バス復旧を確認する */
+		iic_demo_start();
+		break;
+#if !defined(BOARD_UNO_R4_WIFI)
+	/* SPIベンチマーク(^B) */
+	case UART_CMD_SPI:
+		/* 8/16/32bitの送信のみと送受信(ループバック)の転送速度,CPU負荷を測定する */
+		spi_bench_start();
+		break;
+#endif
+	/* CAN自己診断(^N) */
+	case UART_CMD_CAN:
+		/* 内部ループバックでフィルターとデータ,通常モードで相手ノードとバスオフ復帰を確認する */
+		can_demo_start();
+		break;
+	/* モニター(^E) */
+	case UART_CMD_MONITOR:
+		/* メモリ/レジスターの読み書きと統計情報の表示(exitで戻る) */
+		monStart();
+		break;
+#if defined(BOARD_UNO_R4_WIFI)
+	/* LEDマトリクス統計(^L) */
+	case UART_CMD_MATRIX:
+		/* 走査のフレーム数,1フレームの割り込み処理サイクル,CPU負荷を表示する */
+		matrix_demo_report();
+		break;
+#endif
+	}
+}
+
+/**
+  * @brief  LED点灯 コルーチン
+  * @param  pst_Coro: コルーチン情報
+  * @retval None
+  * @note   1秒毎にユーザーLEDの点灯パターンを切り替える(ポート毎に1回の書き込み)
+  */
+static void led_demo_task(Coro *pst_Coro)
+{
+	GpioBatch st_LedBatch;
+
+	CORO_BEGIN(pst_Coro);
+	while (true) {
+		CORO_AWAIT_TIMER(pst_Coro, TIME_1S);
+		// 各ポートの出力データ設定(1)
+		gpioBatchInit(&st_LedBatch);
+		gpioBatchSet(&st_LedBatch, LED_SCK_PORT, LED_SCK_MASK);				// SCK LED(P111): High出力(点灯)
+		gpioBatchSet(&st_LedBatch, LED_TXRX_PORT, LED_TX_MASK | LED_RX_MASK);	// TX/RX LED: High出力(消灯)
+		gpioBatchApply(&st_LedBatch);
+		uptime_tick();
+
+		CORO_AWAIT_TIMER(pst_Coro, TIME_1S);
+		// 各ポートの出力データ設定(2)
+		gpioBatchInit(&st_LedBatch);
+		gpioBatchClear(&st_LedBatch, LED_SCK_PORT, LED_SCK_MASK);			// SCK LED(P111): Low出力(消灯)
+		gpioBatchClear(&st_LedBatch, LED_TXRX_PORT, LED_TX_MASK);			// TX LED(P012): Low出力(点灯)
+		gpioBatchSet(&st_LedBatch, LED_TXRX_PORT, LED_RX_MASK);				// RX LED(P013): High出力(消灯)
+		gpioBatchApply(&st_LedBatch);
+		uptime_tick();
+
+		CORO_AWAIT_TIMER(pst_Coro, TIME_1S);
+		// 各ポートの出力データ設定(3)
+		gpioBatchInit(&st_LedBatch);
+		gpioBatchClear(&st_LedBatch, LED_SCK_PORT, LED_SCK_MASK);			// SCK LED(P111): Low出力(消灯)
+		gpioBatchSet(&st_LedBatch, LED_TXRX_PORT, LED_TX_MASK);				// TX LED(P012): High出力(消灯)
+		gpioBatchClear(&st_LedBatch, LED_TXRX_PORT, LED_RX_MASK);			// RX LED(P013): Low出力(点灯)
+		gpioBatchApply(&st_LedBatch);
+		uptime_tick();
+	}
+	CORO_END(pst_Coro);
+}
+
+/**
+  * @brief  累積稼働時間の更新(1秒毎)
   * @param  None
   * @retval None
   */
-static void port_irq0_init(void)
+static void uptime_tick(void)
 {
-	/* ---- ベクターテーブル登録 ---- */
-	__disable_irq();
-	NVIC_SetVector((IRQn_Type)IRQ_PORT_IRQ0, (uint32_t)PORT_IRQ0_Handler);
-	__enable_irq();
-
-	/* ---- PORT_IRQ0 無効 ---- */
-	R_ICU->IELSR[IRQ_PORT_IRQ0] = 0x00000000;
-	R_ICU->IRQCR[0] = 0x00;
-
-	/* ---- ポート設定 ---- */
-	// 書き込みプロテクト解除
-	R_BSP_PinAccessEnable();
-	// P105 = IRQ0
-	R_PFS->PORT[1].PIN[5].PmnPFS_b.PMR = 0;			// 汎用入出力端子
-	R_PFS->PORT[1].PIN[5].PmnPFS_b.PCR = 1;			// 入力プルアップ有効
-	R_PFS->PORT[1].PIN[5].PmnPFS_b.ISEL = 1;		// IRQ0入力端子
-	// 書き込みプロテクト施錠
-	R_BSP_PinAccessDisable();
-
-	/* ---- PORT_IRQ0 設定 ---- */
-	R_ICU->IRQCR_b[0].IRQMD = 0;					// 立ち下がりエッジ
-	R_ICU->IRQCR_b[0].FCLKSEL = 3;					// PCLKB/64
-	R_ICU->IRQCR_b[0].FLTEN = 1;					// デジタルフィルタ有効
-
-	/* ---- ICU → NVIC 割り込み割り当て ---- */
-	R_ICU->IELSR_b[IRQ_PORT_IRQ0].IR = 0;			// 割り込み要求フラグ クリア
-	R_ICU->IELSR_b[IRQ_PORT_IRQ0].IELS = 0x01;		// PORT_IRQ0
-
-	/* ---- NVIC 設定 ---- */
-	NVIC_ClearPendingIRQ((IRQn_Type)IRQ_PORT_IRQ0);
-	NVIC_SetPriority((IRQn_Type)IRQ_PORT_IRQ0, 12);	// 優先度 12
-	NVIC_EnableIRQ((IRQn_Type)IRQ_PORT_IRQ0);
+	/* 累積稼働時間を更新する(書き込みはドライバーがまとめて行う) */
+	u32s_KvsUptime++;
+	(void)kvsSet(KVS_DEMO_KEY_UPTIME, (const uint8_t *)&u32s_KvsUptime, sizeof(u32s_KvsUptime));
+	/* 文字を出力する(ストリーミング中はフレームを崩さず,モニター中は表示を乱さないよう出力しない) */
+	if (!adcIsStreaming() && !monIsActive()) {
+		uartEchoStr(".");
+	}
+}
+
+/**
+  * @brief  外部端子割り込み 初期化処理
+  * @param  None
+  * @retval None
+  */
+static void exti_demo_init(void)
+{
+	ExtiConfig st_Config;
+
+	// P105 = IRQ0 (立ち下がりエッジ, PCLKB/64 デジタルフィルタ, 入力プルアップ有効)
+	st_Config.u8_port = 1;
+	st_Config.u8_pin = 5;
+	st_Config.u8_edge = EXTI_EDGE_FALLING;
+	st_Config.u8_filter = EXTI_FILTER_PCLKB_64;
+	st_Config.bl_pullup = true;
+	st_Config.u32_debounce_us = EXTI_DEMO_DEBOUNCE;
+	if (extiOpen(EXTI_DEMO_CH, &st_Config) != OK) {
+		Error_Handler();
+	}
+}
+
+/**
+  * @brief  外部端子割り込み イベント表示
+  * @param  None
+  * @retval None
+  */
+static void exti_demo_report(void)
+{
+	ExtiEvent st_Event;
+	ExtiMeasure st_Measure;
+
+	while (extiGetEvent(&st_Event)) {
+		/* ストリーミング中はフレームを崩さないよう出力しない */
+		if (adcIsStreaming()) {
+			continue;
+		}
+		(void)extiGetMeasure(st_Event.u8_channel, &st_Measure);
+		uartEchoStr("Exti");
+		uartEchoHex8(st_Event.u8_channel);
+		uartEchoStr(" t=");
+		uartEchoHex32(st_Event.u32_time_us);
+		uartEchoStr(" period=");
+		uartEchoHex32(st_Measure.u32_period_us);
+		uartEchoStrln("");
+	}
+}
+
+/**
+  * @brief  ADCストリーミング開始/停止
+  * @param  None
+  * @retval None
+  */
+static void adc_stream_toggle(void)
+{
+	AdcStatistics st_Stat;
+
+	/* ストリーミング中の場合は停止して統計情報を表示する */
+	if (adcIsStreaming()) {
+		adcStop();
+		adcGetStatistics(&st_Stat);
+		uartEchoStrln("");
+		uartEchoStr("ADC rate=");
+		uartEchoHex32(st_Stat.u32_sample_rate);
+		uartEchoStr(" load=");
+		uartEchoHex16(st_Stat.u16_cpu_load);
+		uartEchoStr(" blocks=");
+		uartEchoHex32(st_Stat.u32_blocks);
+		uartEchoStr(" overruns=");
+		uartEchoHex32(st_Stat.u32_overruns);
+		uartEchoStr(" missed=");
+		uartEchoHex32(st_Stat.u32_missed);
+		uartEchoStrln("");
+	}
+	/* 停止中の場合はストリーミングを開始する */
+	else if (adcStart(ADC_DEMO_CH_MASK, ADC_DEMO_RATE) == OK) {
+		adcSetStreaming(true);
+	}
 }
 
+/**
+  * @brief  メモリプール ベンチマーク結果表示
+  * @param  None
+  * @retval None
+  */
+static void pool_report_bench(void)
+{
+	PoolBenchResult st_Bench;
+
+	poolBenchmark(&st_Bench);
+	uartEchoStr("pool cycles=");
+	uartEchoHex32(st_Bench.u32_pool_cycles);
+	uartEchoStr(" max=");
+	uartEchoHex32(st_Bench.u32_pool_max);
+	uartEchoStrln("");
+	uartEchoStr("malloc cycles=");
+	uartEchoHex32(st_Bench.u32_malloc_cycles);
+	uartEchoStr(" max=");
+	uartEchoHex32(st_Bench.u32_malloc_max);
+	uartEchoStrln("");
+}
+
+/**
+  * @brief  メモリプール 統計情報表示
+  * @param  u8_Class: クラス番号
+  * @retval None
+  */
+static void pool_report_class(uint8_t u8_Class)
+{
+	PoolStatistics st_Stat;
+
+	(void)poolGetStatistics(u8_Class, &st_Stat);
+	uartEchoStr("size=");
+	uartEchoHex16(st_Stat.u16_block_size);
+	uartEchoStr(" num=");
+	uartEchoHex16(st_Stat.u16_block_num);
+	uartEchoStr(" used=");
+	uartEchoHex16(st_Stat.u16_used);
+	uartEchoStr(" high=");
+	uartEchoHex16(st_Stat.u16_high_water);
+	uartEchoStr(" fail=");
+	uartEchoHex32(st_Stat.u32_fail_count);
+	uartEchoStrln("");
+}
+
+/**
+  * @brief  リセット要因表示
+  * @param  None
+  * @retval None
+  */
+static void reset_report(void)
+{
+	WdtResetInfo st_Info;
+
+	wdtGetResetInfo(&st_Info);
+	uartEchoStr("Reset=");
+	uartEchoStr(ps8s_ResetCauseName[st_Info.u8_cause]);
+	uartEchoStr(" stalled=");
+	uartEchoHex32(st_Info.u32_stalled);
+	uartEchoStr(" boot=");
+	uartEchoHex32(st_Info.u32_boot_count);
+	uartEchoStr(" wdt(ms)=");
+	uartEchoHex32(st_Info.u32_timeout_ms);
+	uartEchoStr(" sup selftest=");
+	uartEchoHex32(supSelfTest());
+	uartEchoStrln("");
+}
+
+/**
+  * @brief  キー・バリューストア 初期化処理
+  * @param  None
+  * @retval None
+  * @note   起動回数を更新してすぐに書き込み、統計情報の表示を予約する
+  */
+static void kvs_demo_init(void)
+{
+	u32s_KvsBootCount = 0;
+	u32s_KvsUptime = 0;
+	(void)kvsGet(KVS_DEMO_KEY_BOOT, (uint8_t *)&u32s_KvsBootCount, sizeof(u32s_KvsBootCount));
+	(void)kvsGet(KVS_DEMO_KEY_UPTIME, (uint8_t *)&u32s_KvsUptime, sizeof(u32s_KvsUptime));
+	u32s_KvsBootCount++;
+	(void)kvsSet(KVS_DEMO_KEY_BOOT, (const uint8_t *)&u32s_KvsBootCount, sizeof(u32s_KvsBootCount));
+	kvsFlush();
+	u8s_KvsReportIndex = 0;
+}
+
+/**
+  * @brief  キー・バリューストア 統計情報表示
+  * @param  u8_Line: 表示行(0～KVS_REPORT_NUM-1)
+  * @retval None
+  */
+static void kvs_demo_report(uint8_t u8_Line)
+{
+	KvsStatistics st_Stat;
+
+	kvsGetStatistics(&st_Stat);
+	switch (u8_Line) {
+	case 0:
+		uartEchoStr("KVS boot=");
+		uartEchoHex32(u32s_KvsBootCount);
+		uartEchoStr(" uptime(s)=");
+		uartEchoHex32(u32s_KvsUptime);
+		uartEchoStr(" torn=");
+		uartEchoHex32(st_Stat.u32_torn);
+		break;
+	case 1:
+		uartEchoStr("rec=");
+		uartEchoHex32(st_Stat.u32_records);
+		uartEchoStr(" coal=");
+		uartEchoHex32(st_Stat.u32_coalesced);
+		uartEchoStr(" erase=");
+		uartEchoHex32(st_Stat.u32_erases);
+		uartEchoStr(" comp=");
+		uartEchoHex32(st_Stat.u32_compactions);
+		break;
+	default:
+		uartEchoStr("err=");
+		uartEchoHex32(st_Stat.u32_errors);
+		uartEchoStr(" step(us)=");
+		uartEchoHex32(st_Stat.u32_max_step_us);
+		uartEchoStr(" used=");
+		uartEchoHex8(st_Stat.u8_used_blocks);
+		uartEchoStr(" free=");
+		uartEchoHex8(st_Stat.u8_free_blocks);
+		break;
+	}
+	uartEchoStrln("");
+}
+
+/**
+  * @brief  スタック使用量表示
+  * @param  u8_Line: 表示行(0～STACK_REPORT_NUM-1)
+  * @retval None
+  * @note   最後の行は前回のスタックオーバーフローの記録(ある場合のみ)
+  */
+static void stack_report(uint8_t u8_Line)
+{
+	StackUsage st_Usage;
+	StackOverflowInfo st_Info;
+
+	if (u8_Line < STACK_CTX_NUM) {
+		(void)stackGetUsage(u8_Line, &st_Usage);
+		uartEchoStr("STACK ");
+		uartEchoStr(ps8s_StackCtxName[u8_Line]);
+		uartEchoStr(" size=");
+		uartEchoHex32(st_Usage.u32_size);
+		uartEchoStr(" peak=");
+		uartEchoHex32(st_Usage.u32_peak);
+		uartEchoStrln("");
+	}
+	else if (stackGetOverflowInfo(&st_Info)) {
+		uartEchoStr("STACK overflow mon=");
+		uartEchoHex8(st_Info.u8_monitor);
+		uartEchoStr(" msp=");
+		uartEchoHex32(st_Info.u32_msp);
+		uartEchoStr(" psp=");
+		uartEchoHex32(st_Info.u32_psp);
+		uartEchoStrln("");
+	}
+}
+
+/**
+  * @brief  スタックオーバーフロー試験
+  * @param  u32_Depth: 現在の段数
+  * @retval 到達した段数(実機ではSTACK_TEST_DEPTHに達する前にリセットされる)
+  */
+static uint32_t stack_overflow_test(uint32_t u32_Depth)
+{
+	volatile uint8_t u8_Frame[STACK_TEST_FRAME];
+
+	u8_Frame[0] = (uint8_t)u32_Depth;
+	if (u32_Depth >= STACK_TEST_DEPTH) {
+		return u32_Depth;
+	}
+	return stack_overflow_test(u32_Depth + 1) + u8_Frame[0] - (uint8_t)u32_Depth;
+}
+
+/**
+  * @brief  パケット受信 開始処理
+  * @param  None
+  * @retval None
+  */
+static void packet_demo_start(void)
+{
+	u8s_PktLogHead = 0;
+	u8s_PktLogTail = 0;
+	bls_PktStopRequest = false;
+	uartEchoStrln("");
+	if (uartPacketStart(packet_demo_callback, PKT_DEMO_IDLE_CHARS) == OK) {
+		uartEchoStrln("PKT start");
+	}
+}
+
+/**
+  * @brief  パケット受信コールバック
+  * @param  pu8_Data: パケットデータ
+  * @param  u16_Size: パケットサイズ
+  * @param  u32_TimeUs: 受信完了時刻[us]
+  * @retval None
+  * @note   割り込みから呼ばれるため、サイズと時刻を記録するだけにする
+  */
+static void packet_demo_callback(const uint8_t *pu8_Data, uint16_t u16_Size, uint32_t u32_TimeUs)
+{
+	uint8_t u8_Next = (u8s_PktLogHead + 1) % PKT_DEMO_LOG_NUM;
+
+	/* ^Uだけのパケットで停止する */
+	if ((u16_Size == 1) && (pu8_Data[0] == UART_CMD_PACKET)) {
+		bls_PktStopRequest = true;
+		coroSetEvent(PKT_DEMO_EVENT);
+		return;
+	}
+	/* 表示待ちが一杯の場合は破棄する */
+	if (u8_Next == u8s_PktLogTail) {
+		return;
+	}
+	u16s_PktLogSize[u8s_PktLogHead] = u16_Size;
+	u32s_PktLogTime[u8s_PktLogHead] = u32_TimeUs;
+	u8s_PktLogHead = u8_Next;
+	coroSetEvent(PKT_DEMO_EVENT);
+}
+
+/**
+  * @brief  パケット受信 表示処理
+  * @param  None
+  * @retval None
+  */
+static void packet_demo_report(void)
+{
+	UartPacketStatistics st_Stat;
+
+	while (u8s_PktLogTail != u8s_PktLogHead) {
+		uartEchoStr("PKT len=");
+		uartEchoHex16(u16s_PktLogSize[u8s_PktLogTail]);
+		uartEchoStr(" t=");
+		uartEchoHex32(u32s_PktLogTime[u8s_PktLogTail]);
+		uartEchoStrln("");
+		u8s_PktLogTail = (u8s_PktLogTail + 1) % PKT_DEMO_LOG_NUM;
+	}
+
+	/* 停止して統計情報を表示する */
+	if (bls_PktStopRequest) {
+		bls_PktStopRequest = false;
+		uartPacketStop();
+		uartGetPacketStatistics(&st_Stat);
+		uartEchoStr("PKT packets=");
+		uartEchoHex32(st_Stat.u32_packets);
+		uartEchoStr(" bytes=");
+		uartEchoHex32(st_Stat.u32_bytes);
+		uartEchoStr(" rxi=");
+		uartEchoHex32(st_Stat.u32_rx_irqs);
+		uartEchoStr(" idle=");
+		uartEchoHex32(st_Stat.u32_idle_irqs);
+		uartEchoStr(" splits=");
+		uartEchoHex32(st_Stat.u32_splits);
+		uartEchoStrln("");
+	}
+}
+
+/**
+  * @brief  パケット受信 表示コルーチン
+  * @param  pst_Coro: コルーチン情報
+  * @retval None
+  * @note   受信コールバックが通知するイベントでだけ再開する
+  */
+static void packet_demo_task(Coro *pst_Coro)
+{
+	CORO_BEGIN(pst_Coro);
+	while (true) {
+		CORO_AWAIT_EVENT(pst_Coro, PKT_DEMO_EVENT);
+		packet_demo_report();
+	}
+	CORO_END(pst_Coro);
+}
+/**
+  * @brief  USBループバック処理
+  * @param  None
+  * @retval None
+  * @note   送信Queueに入る分だけ受信データを取り出して送り返す(取り出さない分は
+  *         受信Queueに残り、一杯になるとホストへのNAKで流量が制御される)
+  */
+static void usb_demo_loopback(void)
+{
+	uint8_t u8_Data[USB_DEMO_CHUNK];
+	uint16_t u16_Space = USB_QUEUE_SIZE - usbGetTxCount();
+	uint16_t u16_Size;
+
+	while ((u16_Space > 0) && (usbGetRxCount() > 0)) {
+		u16_Size = usbGetRxData(&u8_Data[0], (u16_Space < USB_DEMO_CHUNK) ? u16_Space : USB_DEMO_CHUNK);
+		(void)usbSetTxData(&u8_Data[0], u16_Size);
+		u16_Space -= u16_Size;
+	}
+}
+
+/**
+  * @brief  USBオープン/クローズ表示
+  * @param  None
+  * @retval None
+  * @note   クローズ時は統計情報を表示する
+  */
+static void usb_demo_report(void)
+{
+	UsbStatistics st_Stat;
+	bool bl_Open = usbIsConnected();
+
+	if (bl_Open == bls_UsbOpen) {
+		return;
+	}
+	bls_UsbOpen = bl_Open;
+	uartEchoStrln("");
+	if (bl_Open) {
+		uartEchoStrln("USB open");
+	}
+	else {
+		usbGetStatistics(&st_Stat);
+		uartEchoStr("USB close rx=");
+		uartEchoHex32(st_Stat.u32_rx_bytes);
+		uartEchoStr(" tx=");
+		uartEchoHex32(st_Stat.u32_tx_bytes);
+		uartEchoStr(" paused=");
+		uartEchoHex32(st_Stat.u32_rx_paused);
+		uartEchoStr(" setups=");
+		uartEchoHex32(st_Stat.u32_setups);
+		uartEchoStr(" stalls=");
+		uartEchoHex32(st_Stat.u32_stalls);
+		uartEchoStrln("");
+	}
+}
+
+#if defined(BOARD_UNO_R4_WIFI)
+/**
+  * @brief  ESP32-S3リンク 開始処理
+  * @param  None
+  * @retval None
+  * @note   全チャネルで受信データを同じチャネルへ折り返す(相手側の試験用)
+  */
+static void esp_demo_start(void)
+{
+	uint8_t _i;
+
+	for (_i=0; _i<ESP_CH_NUM; _i++) {
+		espSetReceiver(_i, esp_demo_echo);
+	}
+	if (espOpen() != OK) {
+		uartEchoStrln("ESP link NG");
+	}
+}
+
+/**
+  * @brief  ESP32-S3リンク 受信データの折り返し
+  * @param  u8_Ch: チャネル
+  * @param  pu8_Data: 受信データ
+  * @param  u16_Size: 受信データ数
+  * @retval true:受け取った / false:送信の空きが無い(相手の再送を待つ)
+  */
+static bool esp_demo_echo(uint8_t u8_Ch, const uint8_t *pu8_Data, uint16_t u16_Size)
+{
+	if (espGetTxFree(u8_Ch) < u16_Size) {
+		return false;
+	}
+	(void)espWrite(u8_Ch, pu8_Data, u16_Size);
+	return true;
+}
+
+/**
+  * @brief  ESP32-S3リンク 接続/切断表示
+  * @param  None
+  * @retval None
+  */
+static void esp_demo_report(void)
+{
+	EspStatistics st_Stat;
+	bool bl_Up = espIsConnected();
+
+	if (bl_Up == bls_EspUp) {
+		return;
+	}
+	bls_EspUp = bl_Up;
+	espGetStatistics(&st_Stat);
+	uartEchoStrln("");
+	if (bl_Up) {
+		uartEchoStr("ESP link up bps=");
+		uartEchoHex32(st_Stat.u32_bitrate);
+		uartEchoStrln("");
+	}
+	else {
+		uartEchoStr("ESP link down rx=");
+		uartEchoHex32(st_Stat.u32_rx_bytes);
+		uartEchoStr(" tx=");
+		uartEchoHex32(st_Stat.u32_tx_bytes);
+		uartEchoStr(" retx=");
+		uartEchoHex32(st_Stat.u32_retransmits);
+		uartEchoStr(" crc=");
+		uartEchoHex32(st_Stat.u32_crc_errors);
+		uartEchoStr(" seq=");
+		uartEchoHex32(st_Stat.u32_seq_errors);
+		uartEchoStrln("");
+	}
+}
+
+/**
+  * @brief  LEDマトリクス 表示開始
+  * @param  None
+  * @retval None
+  */
+static void matrix_demo_start(void)
+{
+	u8s_MatrixDemoWait = 0;
+	u8s_MatrixDemoPhase = 0;
+	if (matrixOpen() != OK) {
+		uartEchoStrln("MATRIX NG");
+	}
+}
+
+/**
+  * @brief  LEDマトリクス 描画
+  * @param  None
+  * @retval None
+  * @note   MATRIX_DEMO_CYCLES周期毎に斜めの輝度勾配(16段階)を1列ずらして描画する。
+  *         入れ替え待ちで受け付けられなかった場合は次の周期に描画し直す
+  */
+static void matrix_demo_run(void)
+{
+	uint8_t *pu8_Pixel;
+	uint8_t u8_Row;
+	uint8_t u8_Col;
+
+	if (u8s_MatrixDemoWait > 0) {
+		u8s_MatrixDemoWait--;
+		return;
+	}
+	pu8_Pixel = matrixGetBuffer();
+	for (u8_Row=0; u8_Row<MATRIX_ROWS; u8_Row++) {
+		for (u8_Col=0; u8_Col<MATRIX_COLS; u8_Col++) {
+			pu8_Pixel[(u8_Row * MATRIX_COLS) + u8_Col] = (uint8_t)(((u8_Row + u8_Col + u8s_MatrixDemoPhase) % MATRIX_LEVELS) * 17);
+		}
+	}
+	if (matrixSwap() == OK) {
+		u8s_MatrixDemoPhase++;
+		u8s_MatrixDemoWait = MATRIX_DEMO_CYCLES - 1;
+	}
+}
+
+/**
+  * @brief  LEDマトリクス 統計情報表示
+  * @param  None
+  * @retval None
+  */
+static void matrix_demo_report(void)
+{
+	MatrixStatistics st_Stat;
+
+	matrixGetStatistics(&st_Stat);
+	uartEchoStrln("");
+	uartEchoStr("MATRIX frames=");
+	uartEchoHex32(st_Stat.u32_frames);
+	uartEchoStr(" swaps=");
+	uartEchoHex32(st_Stat.u32_swaps);
+	uartEchoStr(" busy=");
+	uartEchoHex32(st_Stat.u32_busy);
+	uartEchoStrln("");
+	uartEchoStr("MATRIX cycles=");
+	uartEchoHex32(st_Stat.u32_frame_cycles);
+	uartEchoStr(" max=");
+	uartEchoHex32(st_Stat.u32_frame_cycles_max);
+	uartEchoStr(" frame_us=");
+	uartEchoHex32(st_Stat.u32_frame_us);
+	uartEchoStr(" load=");
+	uartEchoHex16(st_Stat.u16_cpu_load);
+	uartEchoStrln("");
+}
+#endif
+
+/**
+  * @brief  クロック動作モード切り替え
+  * @param  None
+  * @retval None
+  * @note   切り替えは送信完了後の周期処理の最後に行われる
+  */
+static void clock_demo_next(void)
+{
+	if (u8s_ClockDemoMode == CLOCK_MODE_AUTO) {
+		u8s_ClockDemoMode = CLOCK_MODE_HIGH;
+	}
+	else if ((u8s_ClockDemoMode + 1) >= CLOCK_MODE_NUM) {
+		u8s_ClockDemoMode = CLOCK_MODE_AUTO;
+	}
+	else {
+		u8s_ClockDemoMode++;
+	}
+	(void)clockSetMode(u8s_ClockDemoMode);
+	uartEchoStrln("");
+	u8s_ClockReportIndex = 0;
+}
+
+/**
+  * @brief  クロック統計情報表示
+  * @param  u8_Line: 表示行(0～CLOCK_REPORT_NUM-1)
+  * @retval None
+  */
+static void clock_report(uint8_t u8_Line)
+{
+	ClockStatistics st_Stat;
+
+	clockGetStatistics(&st_Stat);
+	if (u8_Line == 0) {
+		uartEchoStr("CLK set=");
+		uartEchoStr((u8s_ClockDemoMode == CLOCK_MODE_AUTO) ? "Auto" : ps8s_ClockModeName[u8s_ClockDemoMode]);
+		uartEchoStr(" mode=");
+		uartEchoStr(ps8s_ClockModeName[st_Stat.u8_mode]);
+		uartEchoStr(" load=");
+		uartEchoHex16(st_Stat.u16_load);
+		uartEchoStr(" trans=");
+		uartEchoHex32(st_Stat.u32_transitions);
+		uartEchoStr(" veto=");
+		uartEchoHex32(st_Stat.u32_vetoes);
+		uartEchoStr(" lat(ns)=");
+		uartEchoHex32(st_Stat.u32_last_ns);
+		uartEchoStr(" max=");
+		uartEchoHex32(st_Stat.u32_max_ns);
+	}
+	else {
+		uartEchoStr("res(ms) H=");
+		uartEchoHex32(st_Stat.u32_residency_ms[CLOCK_MODE_HIGH]);
+		uartEchoStr(" M=");
+		uartEchoHex32(st_Stat.u32_residency_ms[CLOCK_MODE_MIDDLE]);
+		uartEchoStr(" L=");
+		uartEchoHex32(st_Stat.u32_residency_ms[CLOCK_MODE_LOW]);
+		uartEchoStr(" energy=");
+		uartEchoHex16(st_Stat.u16_energy);
+	}
+	uartEchoStrln("");
+}
+
+/**
+  * @brief  IIC自己診断 開始処理
+  * @param  None
+  * @retval None
+  */
+static void iic_demo_start(void)
+{
+	uint8_t _i;
+
+	if (u8s_IicDemoStep != IIC_DEMO_STEP_IDLE) {
+		return;
+	}
+	for (_i=0; _i<IIC_DEMO_ID_NUM; _i++) {
+		u8s_IicDemoResult[_i] = IIC_DEMO_NOT_DONE;
+	}
+	u8s_IicDemoPolls = 0;
+	u8s_IicDemoPending = 0;
+	iicGetStatistics(&sts_IicDemoBefore);
+	u8s_IicDemoStep = IIC_DEMO_STEP_WRITE;
+	uartEchoStrln("");
+	uartEchoStrln("IIC selftest start");
+}
+
+/**
+  * @brief  IIC自己診断 実行処理
+  * @param  None
+  * @retval None
+  * @note   前の段階の転送が全て完了してから次の段階の転送をまとめて登録する
+  *         - 書き込み: EEPROMへ1ページ書き込む
+  *         - 応答確認: EEPROMの書き込み完了をアドレスの応答で待つ
+  *         - 読み出し: EEPROMの読み返し,温度読み出し,存在しないスレーブ
+  *         - ストレッチ: センサーの障害注入で長いクロックストレッチを起こす
+  *         - 復旧: センサーの障害注入でSDAを固定し、復旧後に転送できること
+  */
+static void iic_demo_run(void)
+{
+	uint8_t _i;
+
+	if ((u8s_IicDemoStep == IIC_DEMO_STEP_IDLE) || (u8s_IicDemoPending > 0)) {
+		return;
+	}
+	switch (u8s_IicDemoStep) {
+	case IIC_DEMO_STEP_WRITE:
+		u8s_IicDemoEepWrite[0] = IIC_DEMO_EEP_ADDR;
+		for (_i=0; _i<IIC_DEMO_EEP_SIZE; _i++) {
+			u8s_IicDemoEepWrite[1 + _i] = (uint8_t)(0xA0 + (_i * 3));
+		}
+		iic_demo_submit(IIC_DEMO_ID_EEP_WRITE, IIC_DEMO_EEPROM, &u8s_IicDemoEepWrite[0], sizeof(u8s_IicDemoEepWrite), NULL, 0);
+		u8s_IicDemoStep = IIC_DEMO_STEP_POLL;
+		break;
+	case IIC_DEMO_STEP_POLL:
+		/* 書き込み中はアドレスにNACKを返す */
+		if ((u8s_IicDemoResult[IIC_DEMO_ID_EEP_POLL] == IIC_DEMO_NOT_DONE)
+		 || ((u8s_IicDemoResult[IIC_DEMO_ID_EEP_POLL] == IIC_RESULT_NACK_ADDR) && (u8s_IicDemoPolls < IIC_DEMO_POLL_MAX))) {
+			u8s_IicDemoPolls++;
+			iic_demo_submit(IIC_DEMO_ID_EEP_POLL, IIC_DEMO_EEPROM, NULL, 0, NULL, 0);
+			break;
+		}
+		/* EEPROMの読み返し,温度読み出し,存在しないスレーブをまとめて登録する */
+		u8s_IicDemoEepPtr[0] = IIC_DEMO_EEP_ADDR;
+		iic_demo_submit(IIC_DEMO_ID_EEP_READ, IIC_DEMO_EEPROM, &u8s_IicDemoEepPtr[0], 1, &u8s_IicDemoEepRead[0], IIC_DEMO_EEP_SIZE);
+		u8s_IicDemoTempPtr[0] = IIC_DEMO_REG_TEMP;
+		iic_demo_submit(IIC_DEMO_ID_TEMP, IIC_DEMO_SENSOR, &u8s_IicDemoTempPtr[0], 1, &u8s_IicDemoTemp[0], sizeof(u8s_IicDemoTemp));
+		iic_demo_submit(IIC_DEMO_ID_MISSING, IIC_DEMO_MISSING, &u8s_IicDemoTempPtr[0], 1, NULL, 0);
+		u8s_IicDemoStep = IIC_DEMO_STEP_STRETCH;
+		break;
+	case IIC_DEMO_STEP_STRETCH:
+		u8s_IicDemoFault[0][0] = IIC_DEMO_REG_FAULT;
+		u8s_IicDemoFault[0][1] = IIC_DEMO_FAULT_STRETCH;
+		iic_demo_submit(IIC_DEMO_ID_FAULT_STRETCH, IIC_DEMO_SENSOR, &u8s_IicDemoFault[0][0], 2, NULL, 0);
+		iic_demo_submit(IIC_DEMO_ID_STRETCH_READ, IIC_DEMO_SENSOR, &u8s_IicDemoTempPtr[0], 1, &u8s_IicDemoScratch[0], 2);
+		u8s_IicDemoStep = IIC_DEMO_STEP_RECOVER;
+		break;
+	case IIC_DEMO_STEP_RECOVER:
+		u8s_IicDemoFault[1][0] = IIC_DEMO_REG_FAULT;
+		u8s_IicDemoFault[1][1] = IIC_DEMO_FAULT_STUCK;
+		iic_demo_submit(IIC_DEMO_ID_FAULT_STUCK, IIC_DEMO_SENSOR, &u8s_IicDemoFault[1][0], 2, NULL, 0);
+		iic_demo_submit(IIC_DEMO_ID_STUCK_READ, IIC_DEMO_SENSOR, &u8s_IicDemoTempPtr[0], 1, &u8s_IicDemoScratch[2], 2);
+		iic_demo_submit(IIC_DEMO_ID_STUCK_PROBE, IIC_DEMO_SENSOR, NULL, 0, NULL, 0);
+		iic_demo_submit(IIC_DEMO_ID_AFTER, IIC_DEMO_SENSOR, &u8s_IicDemoTempPtr[0], 1, &u8s_IicDemoScratch[4], 2);
+		u8s_IicDemoStep = IIC_DEMO_STEP_REPORT;
+		break;
+	default:
+		/* 結果を表示する(IIC_DEMO_REPORT_NUM行) */
+		u8s_IicDemoStep = IIC_DEMO_STEP_IDLE;
+		u8s_IicReportIndex = 0;
+		break;
+	}
+}
+
+/**
+  * @brief  IIC自己診断 転送登録
+  * @param  u8_Id: 転送番号(IIC_DEMO_ID_xxx)
+  * @param  u8_Addr: スレーブアドレス
+  * @param  pu8_Tx: 送信データ
+  * @param  u16_TxSize: 送信データ数
+  * @param  pu8_Rx: 受信データの格納先
+  * @param  u16_RxSize: 受信データ数
+  * @retval None
+  */
+static void iic_demo_submit(uint8_t u8_Id, uint8_t u8_Addr, const uint8_t *pu8_Tx, uint16_t u16_TxSize, uint8_t *pu8_Rx, uint16_t u16_RxSize)
+{
+	IicTransfer st_Xfer;
+
+	st_Xfer.u8_addr = u8_Addr;
+	st_Xfer.pu8_tx = pu8_Tx;
+	st_Xfer.u16_tx_size = u16_TxSize;
+	st_Xfer.pu8_rx = pu8_Rx;
+	st_Xfer.u16_rx_size = u16_RxSize;
+	st_Xfer.pf_callback = iic_demo_callback;
+	st_Xfer.pv_context = (void *)(uintptr_t)u8_Id;
+	u8s_IicDemoResult[u8_Id] = IIC_DEMO_NOT_DONE;
+	if (iicSubmit(&st_Xfer) == OK) {
+		u8s_IicDemoPending++;
+	}
+}
+
+/**
+  * @brief  IIC自己診断 転送完了コールバック
+  * @param  pst_Xfer: 完了した転送
+  * @param  u8_Result: 結果(IIC_RESULT_xxx)
+  * @param  u32_TimeUs: 転送時間[us]
+  * @retval None
+  */
+static void iic_demo_callback(const IicTransfer *pst_Xfer, uint8_t u8_Result, uint32_t u32_TimeUs)
+{
+	(void)u32_TimeUs;
+	u8s_IicDemoResult[(uintptr_t)pst_Xfer->pv_context] = u8_Result;
+	u8s_IicDemoPending--;
+}
+
+/**
+  * @brief  IIC自己診断 結果表示
+  * @param  u8_Line: 表示行(0～IIC_DEMO_REPORT_NUM-1)
+  * @retval None
+  */
+static void iic_demo_report(uint8_t u8_Line)
+{
+	IicStatistics st_Stat;
+	bool bl_Pass;
+
+	iicGetStatistics(&st_Stat);
+	if (u8_Line == 0) {
+		/* EEPROM: 書き込み→応答確認(NACKの後にACK)→読み返しが一致 */
+		bl_Pass = (u8s_IicDemoResult[IIC_DEMO_ID_EEP_WRITE] == IIC_RESULT_OK)
+			&& (u8s_IicDemoResult[IIC_DEMO_ID_EEP_POLL] == IIC_RESULT_OK) && (u8s_IicDemoPolls > 1)
+			&& (u8s_IicDemoResult[IIC_DEMO_ID_EEP_READ] == IIC_RESULT_OK)
+			&& (mem_cmp08(&u8s_IicDemoEepRead[0], &u8s_IicDemoEepWrite[1], IIC_DEMO_EEP_SIZE) == 0);
+		uartEchoStr("IIC eeprom=");
+		uartEchoStr(bl_Pass ? "PASS" : "FAIL");
+		uartEchoStr(" polls=");
+		uartEchoHex8(u8s_IicDemoPolls);
+		uartEchoStr(" temp=");
+		uartEchoStr((u8s_IicDemoResult[IIC_DEMO_ID_TEMP] == IIC_RESULT_OK) ? "PASS" : "FAIL");
+		uartEchoStr("(");
+		uartEchoHex16((uint16_t)((u8s_IicDemoTemp[0] << 8) | u8s_IicDemoTemp[1]));
+		uartEchoStr(") nack=");
+		uartEchoStr((u8s_IicDemoResult[IIC_DEMO_ID_MISSING] == IIC_RESULT_NACK_ADDR) ? "PASS" : "FAIL");
+		/* 長いクロックストレッチはタイムアウトで打ち切る */
+		bl_Pass = (u8s_IicDemoResult[IIC_DEMO_ID_FAULT_STRETCH] == IIC_RESULT_OK)
+			&& (u8s_IicDemoResult[IIC_DEMO_ID_STRETCH_READ] == IIC_RESULT_TIMEOUT);
+		uartEchoStr(" timeout=");
+		uartEchoStr(bl_Pass ? "PASS" : "FAIL");
+		/* SDA固定はバスエラーになり、復旧後の転送は成功する */
+		bl_Pass = (u8s_IicDemoResult[IIC_DEMO_ID_FAULT_STUCK] == IIC_RESULT_OK)
+			&& (u8s_IicDemoResult[IIC_DEMO_ID_STUCK_READ] == IIC_RESULT_OK)
+			&& (u8s_IicDemoResult[IIC_DEMO_ID_STUCK_PROBE] == IIC_RESULT_BUS_ERROR)
+			&& (u8s_IicDemoResult[IIC_DEMO_ID_AFTER] == IIC_RESULT_OK)
+			&& (st_Stat.u32_recoveries > sts_IicDemoBefore.u32_recoveries);
+		uartEchoStr(" recover=");
+		uartEchoStr(bl_Pass ? "PASS" : "FAIL");
+	}
+	else if (u8_Line == 1) {
+		uartEchoStr("IIC xfer=");
+		uartEchoHex32(st_Stat.u32_transfers);
+		uartEchoStr(" nack=");
+		uartEchoHex32(st_Stat.u32_nacks);
+		uartEchoStr(" tmo=");
+		uartEchoHex32(st_Stat.u32_timeouts);
+		uartEchoStr(" buserr=");
+		uartEchoHex32(st_Stat.u32_bus_errors);
+		uartEchoStr(" recov=");
+		uartEchoHex32(st_Stat.u32_recoveries);
+		uartEchoStr(" qpeak=");
+		uartEchoHex8(st_Stat.u8_queue_peak);
+	}
+	else {
+		uartEchoStr("IIC irq=");
+		uartEchoHex32(st_Stat.u32_irqs);
+		uartEchoStr(" dtc=");
+		uartEchoHex32(st_Stat.u32_dtc_bytes);
+		uartEchoStr(" last(us)=");
+		uartEchoHex32(st_Stat.u32_last_us);
+		uartEchoStr(" avg=");
+		uartEchoHex32(st_Stat.u32_avg_us);
+		uartEchoStr(" max=");
+		uartEchoHex32(st_Stat.u32_max_us);
+		uartEchoStr(" bps=");
+		uartEchoHex32(st_Stat.u32_bitrate);
+	}
+	uartEchoStrln("");
+}
+
+#if !defined(BOARD_UNO_R4_WIFI)
+/**
+  * @brief  SPIベンチマーク 開始処理
+  * @param  None
+  * @retval None
+  */
+static void spi_bench_start(void)
+{
+	if (u8s_SpiBenchCase < SPI_BENCH_CASE_NUM) {
+		return;
+	}
+	mem_set08((uint8_t *)&sts_SpiBench[0], 0x00, sizeof(sts_SpiBench));
+	u8s_SpiBenchPending = 0;
+	bls_SpiBenchSubmitted = false;
+	u8s_SpiBenchCase = 0;
+	uartEchoStrln("");
+	uartEchoStrln("SPI benchmark start");
+}
+
+/**
+  * @brief  SPIベンチマーク 実行処理
+  * @param  None
+  * @retval None
+  * @note   試験毎にSPI_BENCH_SIZEのデータをSPI_BENCH_CHUNKS個の転送に分けて
+  *         登録する(最後以外はCSを保持する)。全ての転送が完了してから
+  *         統計情報の差分でCPUサイクル数を求め、次の試験に進む
+  */
+static void spi_bench_run(void)
+{
+	SpiBenchResult *pst_Result;
+	SpiStatistics st_Stat;
+	SpiTransfer st_Xfer;
+	uint32_t u32_Chunk = SPI_BENCH_SIZE / SPI_BENCH_CHUNKS;
+	uint8_t *pu8_Tx = (uint8_t *)&u32s_SpiBenchTx[0];
+	uint32_t _i;
+
+	if ((u8s_SpiBenchCase >= SPI_BENCH_CASE_NUM) || (u8s_SpiBenchPending > 0)) {
+		return;
+	}
+	pst_Result = &sts_SpiBench[u8s_SpiBenchCase];
+
+	/* ---- 試験の完了: 結果を記録して次の試験へ ---- */
+	if (bls_SpiBenchSubmitted) {
+		spiGetStatistics(&st_Stat);
+		pst_Result->u32_cycles = st_Stat.u32_cpu_cycles - sts_SpiBenchBefore.u32_cpu_cycles;
+		pst_Result->u32_bitrate = st_Stat.u32_bitrate;
+		pst_Result->bl_verify = (pst_Result->u8_errors == 0);
+		if (bls_SpiBenchDuplex[u8s_SpiBenchCase]) {
+			pst_Result->bl_verify = pst_Result->bl_verify
+				&& (mem_cmp08((uint8_t *)&u32s_SpiBenchRx[0], pu8_Tx, SPI_BENCH_SIZE) == 0);
+		}
+		bls_SpiBenchSubmitted = false;
+		u8s_SpiBenchCase++;
+		if (u8s_SpiBenchCase >= SPI_BENCH_CASE_NUM) {
+			u8s_SpiReportIndex = 0;
+		}
+		return;
+	}
+
+	/* ---- 試験の開始 ---- */
+	for (_i=0; _i<SPI_BENCH_SIZE; _i++) {
+		pu8_Tx[_i] = (uint8_t)((_i * 7) + u8s_SpiBenchCase);
+	}
+	mem_set08((uint8_t *)&u32s_SpiBenchRx[0], 0x00, SPI_BENCH_SIZE);
+	spiGetStatistics(&sts_SpiBenchBefore);
+	st_Xfer.pst_dev = bls_SpiBenchDuplex[u8s_SpiBenchCase] ? &sts_SpiBenchLoopback : &sts_SpiBenchDisplay;
+	st_Xfer.u8_bits = u8s_SpiBenchBits[u8s_SpiBenchCase];
+	st_Xfer.u16_frames = (uint16_t)(u32_Chunk / (st_Xfer.u8_bits / 8));
+	st_Xfer.pf_callback = spi_bench_callback;
+	st_Xfer.pv_context = pst_Result;
+	for (_i=0; _i<SPI_BENCH_CHUNKS; _i++) {
+		st_Xfer.pv_tx = &pu8_Tx[_i * u32_Chunk];
+		st_Xfer.pv_rx = bls_SpiBenchDuplex[u8s_SpiBenchCase] ? &((uint8_t *)&u32s_SpiBenchRx[0])[_i * u32_Chunk] : NULL;
+		st_Xfer.bl_keep_cs = (_i < (SPI_BENCH_CHUNKS - 1));
+		if (spiSubmit(&st_Xfer) == OK) {
+			u8s_SpiBenchPending++;
+		}
+		else {
+			pst_Result->u8_errors++;
+		}
+	}
+	bls_SpiBenchSubmitted = true;
+}
+
+/**
+  * @brief  SPIベンチマーク 転送完了コールバック
+  * @param  pst_Xfer: 完了した転送
+  * @param  u8_Result: 結果(SPI_RESULT_xxx)
+  * @param  u32_TimeUs: 転送時間[us]
+  * @retval None
+  */
+static void spi_bench_callback(const SpiTransfer *pst_Xfer, uint8_t u8_Result, uint32_t u32_TimeUs)
+{
+	SpiBenchResult *pst_Result = (SpiBenchResult *)pst_Xfer->pv_context;
+
+	pst_Result->u32_time_us += u32_TimeUs;
+	if (u8_Result == SPI_RESULT_OK) {
+		pst_Result->u32_bytes += (uint32_t)pst_Xfer->u16_frames * (pst_Xfer->u8_bits / 8);
+	}
+	else {
+		pst_Result->u8_errors++;
+	}
+	u8s_SpiBenchPending--;
+}
+
+/**
+  * @brief  SPIベンチマーク 結果表示
+  * @param  u8_Line: 表示行(0～SPI_BENCH_REPORT_NUM-1)
+  * @retval None
+  * @note   kB/s = byte/ms, eff = 転送速度に対するデータの割合,
+  *         cpu = 転送時間に対するドライバー(割り込み+登録)の処理時間の割合
+  */
+static void spi_bench_report(uint8_t u8_Line)
+{
+	const SpiBenchResult *pst_Result;
+	SpiStatistics st_Stat;
+	uint32_t u32_Time;
+
+	if (u8_Line < SPI_BENCH_CASE_NUM) {
+		pst_Result = &sts_SpiBench[u8_Line];
+		u32_Time = (pst_Result->u32_time_us > 0) ? pst_Result->u32_time_us : 1;
+		uartEchoStr("SPI ");
+		uartEchoStr(ps8s_SpiBenchName[u8_Line]);
+		uartEchoStr(" kB/s=");
+		uartEchoHex32((uint32_t)(((uint64_t)pst_Result->u32_bytes * 1000) / u32_Time));
+		uartEchoStr(" bus(kbps)=");
+		uartEchoHex32(pst_Result->u32_bitrate / 1000);
+		uartEchoStr(" eff(x0.1%)=");
+		uartEchoHex16((uint16_t)(((uint64_t)pst_Result->u32_bytes * 8 * 1000000 * 1000)
+			/ ((uint64_t)u32_Time * ((pst_Result->u32_bitrate > 0) ? pst_Result->u32_bitrate : 1))));
+		uartEchoStr(" cpu(x0.1%)=");
+		uartEchoHex16((uint16_t)(((uint64_t)pst_Result->u32_cycles * 1000) / ((uint64_t)u32_Time * (SystemCoreClock / 1000000))));
+		uartEchoStr(" verify=");
+		uartEchoStr(pst_Result->bl_verify ? "PASS" : "FAIL");
+	}
+	else {
+		spiGetStatistics(&st_Stat);
+		uartEchoStr("SPI xfer=");
+		uartEchoHex32(st_Stat.u32_transfers);
+		uartEchoStr(" err=");
+		uartEchoHex32(st_Stat.u32_errors);
+		uartEchoStr(" tmo=");
+		uartEchoHex32(st_Stat.u32_timeouts);
+		uartEchoStr(" irq=");
+		uartEchoHex32(st_Stat.u32_irqs);
+		uartEchoStr(" dtc=");
+		uartEchoHex32(st_Stat.u32_dtc_frames);
+		uartEchoStr(" qpeak=");
+		uartEchoHex8(st_Stat.u8_queue_peak);
+	}
+	uartEchoStrln("");
+}
+#endif
+
+/**
+  * @brief  CAN自己診断 開始処理
+  * @param  None
+  * @retval None
+  * @note   内部ループバックで試験フレームをまとめて送信する
+  */
+static void can_demo_start(void)
+{
+	CanConfig st_Config;
+	CanFrame st_Frame;
+	uint8_t _i;
+
+	if (u8s_CanDemoStep != CAN_DEMO_STEP_IDLE) {
+		return;
+	}
+	u16s_CanDemoSeen = 0;
+	u8s_CanDemoRx = 0;
+	bls_CanDemoFilter = true;
+	bls_CanDemoData = true;
+	bls_CanDemoNode = false;
+	u8s_CanDemoEcho = CAN_DEMO_SKIP;
+	u8s_CanDemoBusOff = CAN_DEMO_SKIP;
+	bls_CanDemoRecovered = false;
+	mem_set08((uint8_t *)&sts_CanDemoBus, 0x00, sizeof(sts_CanDemoBus));
+	uartEchoStrln("");
+	st_Config.u32_bitrate = CAN_DEMO_BITRATE;
+	st_Config.u8_mode = CAN_MODE_LOOPBACK;
+	st_Config.u8_filter_num = CAN_DEMO_FILTER_NUM;
+	st_Config.pst_filters = &sts_CanDemoFilters[0];
+	if (canStart(&st_Config) != OK) {
+		uartEchoStrln("CAN start NG");
+		return;
+	}
+	for (_i=0; _i<CAN_DEMO_FRAME_NUM; _i++) {
+		can_demo_frame(_i, u32s_CanDemoIds[_i], &st_Frame);
+		(void)canSend(&st_Frame);
+	}
+	u8s_CanDemoWait = 0;
+	u8s_CanDemoStep = CAN_DEMO_STEP_LOOP;
+	uartEchoStrln("CAN selftest start");
+}
+
+/**
+  * @brief  CAN自己診断 実行処理
+  * @param  None
+  * @retval None
+  * @note   受信フレームを照合し、段階の完了(または待ち時間の満了)で次へ進む
+  *         - ループバック: 受信すべきフレームだけを受信し、データが一致すること
+  *         - 通常モード: 相手ノードの応答を待つ(無ければACKエラーでエラーパッシブ)
+  *         - バスオフ: 障害注入でバスオフにし、自動復帰後に応答を受信できること
+  */
+static void can_demo_run(void)
+{
+	CanConfig st_Config;
+	CanFrame st_Frame;
+	CanStatus st_Status;
+	uint8_t u8_Expect = 0;
+	uint8_t _i;
+
+	if (u8s_CanDemoStep == CAN_DEMO_STEP_IDLE) {
+		return;
+	}
+	while (canReceive(&st_Frame) == OK) {
+		can_demo_check(&st_Frame);
+	}
+	u8s_CanDemoWait++;
+	canGetStatus(&st_Status);
+	switch (u8s_CanDemoStep) {
+	case CAN_DEMO_STEP_LOOP:
+		for (_i=0; _i<CAN_DEMO_FRAME_NUM; _i++) {
+			u8_Expect += bls_CanDemoAccept[_i] ? 1 : 0;
+		}
+		if (((u8s_CanDemoRx < u8_Expect) || (st_Status.u8_tx_pending > 0)) && (u8s_CanDemoWait < CAN_DEMO_WAIT_MAX)) {
+			break;
+		}
+		/* 通常モード(全て受信)で相手ノードに応答を求める */
+		st_Config.u32_bitrate = CAN_DEMO_BITRATE;
+		st_Config.u8_mode = CAN_MODE_NORMAL;
+		st_Config.u8_filter_num = 0;
+		st_Config.pst_filters = NULL;
+		(void)canStart(&st_Config);
+		can_demo_frame(0, CAN_DEMO_PROBE_ID, &st_Frame);
+		(void)canSend(&st_Frame);
+		u8s_CanDemoWait = 0;
+		u8s_CanDemoStep = CAN_DEMO_STEP_BUS;
+		break;
+	case CAN_DEMO_STEP_BUS:
+		if (!bls_CanDemoNode && (u8s_CanDemoWait < CAN_DEMO_WAIT_MAX)) {
+			break;
+		}
+		sts_CanDemoBus = st_Status;
+		if (!bls_CanDemoNode) {
+			/* ACKを返すノードが無い(送信を中止する) */
+			canStop();
+			u8s_CanDemoStep = CAN_DEMO_STEP_IDLE;
+			u8s_CanReportIndex = 0;
+			break;
+		}
+		/* 障害注入の後の送信でバスオフにし、自動復帰後の応答を待つ */
+		sts_CanDemoBefore = st_Status;
+		st_Frame.u32_id = CAN_DEMO_FAULT_ID;
+		st_Frame.u8_dlc = 1;
+		st_Frame.u8_flags = 0;
+		st_Frame.u8_data[0] = CAN_DEMO_FAULT_MS;
+		(void)canSend(&st_Frame);
+		can_demo_frame(1, CAN_DEMO_RECOVER_ID, &st_Frame);
+		(void)canSend(&st_Frame);
+		u8s_CanDemoWait = 0;
+		u8s_CanDemoStep = CAN_DEMO_STEP_BUSOFF;
+		break;
+	default:
+		if (!bls_CanDemoRecovered && (u8s_CanDemoWait < CAN_DEMO_WAIT_MAX)) {
+			break;
+		}
+		u8s_CanDemoBusOff = (bls_CanDemoRecovered && (st_Status.u32_busoffs > sts_CanDemoBefore.u32_busoffs)
+			&& (st_Status.u32_recoveries > sts_CanDemoBefore.u32_recoveries)) ? CAN_DEMO_PASS : CAN_DEMO_FAIL;
+		canStop();
+		u8s_CanDemoStep = CAN_DEMO_STEP_IDLE;
+		u8s_CanReportIndex = 0;
+		break;
+	}
+}
+
+/**
+  * @brief  CAN自己診断 試験フレーム作成
+  * @param  u8_Index: 試験フレーム番号(データ長とデータを変える)
+  * @param  u32_Id: ID
+  * @param  pst_Frame: 格納先
+  * @retval None
+  */
+static void can_demo_frame(uint8_t u8_Index, uint32_t u32_Id, CanFrame *pst_Frame)
+{
+	uint8_t _i;
+
+	pst_Frame->u32_id = u32_Id;
+	pst_Frame->u8_dlc = (uint8_t)(1 + (u8_Index % 8));
+	pst_Frame->u8_flags = 0;
+	pst_Frame->u16_timestamp = 0;
+	for (_i=0; _i<8; _i++) {
+		pst_Frame->u8_data[_i] = (_i < pst_Frame->u8_dlc) ? (uint8_t)(u32_Id + (_i * 0x11) + u8_Index) : 0;
+	}
+}
+
+/**
+  * @brief  CAN自己診断 受信フレーム照合
+  * @param  pst_Frame: 受信したフレーム
+  * @retval None
+  * @note   相手ノードの応答はIDが+1で、データは送信したものと同じ
+  */
+static void can_demo_check(const CanFrame *pst_Frame)
+{
+	CanFrame st_Expect;
+	uint8_t _i;
+
+	switch (u8s_CanDemoStep) {
+	case CAN_DEMO_STEP_LOOP:
+		for (_i=0; _i<CAN_DEMO_FRAME_NUM; _i++) {
+			if (u32s_CanDemoIds[_i] == pst_Frame->u32_id) {
+				break;
+			}
+		}
+		if ((_i >= CAN_DEMO_FRAME_NUM) || !bls_CanDemoAccept[_i] || (u16s_CanDemoSeen & (1U << _i))) {
+			bls_CanDemoFilter = false;
+			break;
+		}
+		u16s_CanDemoSeen |= (uint16_t)(1U << _i);
+		u8s_CanDemoRx++;
+		can_demo_frame(_i, u32s_CanDemoIds[_i], &st_Expect);
+		if ((pst_Frame->u8_dlc != st_Expect.u8_dlc)
+		 || (mem_cmp08(&pst_Frame->u8_data[0], &st_Expect.u8_data[0], st_Expect.u8_dlc) != 0)) {
+			bls_CanDemoData = false;
+		}
+		break;
+	case CAN_DEMO_STEP_BUS:
+		if (pst_Frame->u32_id == (CAN_DEMO_PROBE_ID + 1)) {
+			can_demo_frame(0, CAN_DEMO_PROBE_ID, &st_Expect);
+			bls_CanDemoNode = true;
+			u8s_CanDemoEcho = ((pst_Frame->u8_dlc == st_Expect.u8_dlc)
+				&& (mem_cmp08(&pst_Frame->u8_data[0], &st_Expect.u8_data[0], st_Expect.u8_dlc) == 0)) ? CAN_DEMO_PASS : CAN_DEMO_FAIL;
+		}
+		break;
+	case CAN_DEMO_STEP_BUSOFF:
+		if (pst_Frame->u32_id == (CAN_DEMO_RECOVER_ID + 1)) {
+			bls_CanDemoRecovered = true;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+  * @brief  CAN自己診断 結果表示
+  * @param  u8_Line: 表示行(0～CAN_DEMO_REPORT_NUM-1)
+  * @retval None
+  */
+static void can_demo_report(uint8_t u8_Line)
+{
+	CanStatus st_Status;
+	uint8_t u8_Expect = 0;
+	uint8_t _i;
+
+	switch (u8_Line) {
+	case 0:
+		for (_i=0; _i<CAN_DEMO_FRAME_NUM; _i++) {
+			u8_Expect += bls_CanDemoAccept[_i] ? 1 : 0;
+		}
+		uartEchoStr("CAN loop rx=");
+		uartEchoHex8(u8s_CanDemoRx);
+		uartEchoStr("/");
+		uartEchoHex8(u8_Expect);
+		uartEchoStr(" filter=");
+		uartEchoStr(ps8s_CanDemoResultName[(bls_CanDemoFilter && (u8s_CanDemoRx == u8_Expect)) ? CAN_DEMO_PASS : CAN_DEMO_FAIL]);
+		uartEchoStr(" data=");
+		uartEchoStr(ps8s_CanDemoResultName[bls_CanDemoData ? CAN_DEMO_PASS : CAN_DEMO_FAIL]);
+		break;
+	case 1:
+		uartEchoStr("CAN bus=");
+		uartEchoStr(bls_CanDemoNode ? "Node" : "NoAck");
+		uartEchoStr(" state=");
+		uartEchoStr(ps8s_CanStateName[sts_CanDemoBus.u8_state]);
+		uartEchoStr(" tec=");
+		uartEchoHex8(sts_CanDemoBus.u8_tec);
+		uartEchoStr(" echo=");
+		uartEchoStr(ps8s_CanDemoResultName[u8s_CanDemoEcho]);
+		uartEchoStr(" busoff=");
+		uartEchoStr(ps8s_CanDemoResultName[u8s_CanDemoBusOff]);
+		break;
+	case 2:
+		canGetStatus(&st_Status);
+		uartEchoStr("CAN tx=");
+		uartEchoHex32(st_Status.u32_tx_frames);
+		uartEchoStr(" rx=");
+		uartEchoHex32(st_Status.u32_rx_frames);
+		uartEchoStr(" drop=");
+		uartEchoHex32(st_Status.u32_rx_dropped);
+		uartEchoStr(" lost=");
+		uartEchoHex32(st_Status.u32_rx_lost);
+		uartEchoStr(" irq=");
+		uartEchoHex32(st_Status.u32_irqs);
+		uartEchoStr(" rxpeak=");
+		uartEchoHex8(st_Status.u8_rx_peak);
+		break;
+	case 3:
+		canGetStatus(&st_Status);
+		uartEchoStr("CAN buserr=");
+		uartEchoHex32(st_Status.u32_bus_errors);
+		uartEchoStr(" passive=");
+		uartEchoHex16((uint16_t)st_Status.u32_passives);
+		uartEchoStr(" busoff=");
+		uartEchoHex16((uint16_t)st_Status.u32_busoffs);
+		uartEchoStr(" recov=");
+		uartEchoHex16((uint16_t)st_Status.u32_recoveries);
+		uartEchoStr(" err=");
+		uartEchoHex8(st_Status.u8_error_code);
+		break;
+	}
+	uartEchoStrln("");
+}
@@ -0,0 +1,83 @@
+/**
+  ******************************************************************************
+  * @file           : test_bench.c
+  * @brief          : ベンチマーク
+  ******************************************************************************
+  * @note   計測値は#BENCH行で出力し、test_runner.pyが記録する(成否は判定しない)。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_runner.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define BENCH_MEM_SIZE		(1024)					/* メモリ操作の対象サイズ[byte]	*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t u32s_BenchSrc[BENCH_MEM_SIZE / 4];
+static uint32_t u32s_BenchDst[BENCH_MEM_SIZE / 4];
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  DSPカーネル
+  * @param  None
+  * @retval None
+  */
+void benchDsp(void)
+{
+	DspBenchResult st_Result[DSP_BENCH_KERNEL_NUM];
+	uint8_t _i;
+
+	dspBenchmark(&st_Result[0]);
+	for (_i=0; _i<DSP_BENCH_KERNEL_NUM; _i++) {
+		testBenchResult("dsp", st_Result[_i].ps8_name, st_Result[_i].u32_cycles_x100, "cyc_x100");
+		/* C参照実装は"dsp_ref.<カーネル名>"で出力する */
+		if (st_Result[_i].u32_ref_cycles_x100 != 0) {
+			testBenchResult("dsp_ref", st_Result[_i].ps8_name, st_Result[_i].u32_ref_cycles_x100, "cyc_x100");
+		}
+	}
+}
+
+/**
+  * @brief  メモリプール/malloc
+  * @param  None
+  * @retval None
+  */
+void benchPool(void)
+{
+	PoolBenchResult st_Result;
+
+	poolBenchmark(&st_Result);
+	testBenchResult("pool", "pool_avg", st_Result.u32_pool_cycles, "cyc");
+	testBenchResult("pool", "pool_max", st_Result.u32_pool_max, "cyc");
+	testBenchResult("pool", "malloc_avg", st_Result.u32_malloc_cycles, "cyc");
+	testBenchResult("pool", "malloc_max", st_Result.u32_malloc_max, "cyc");
+}
+
+/**
+  * @brief  mem_cpyxx
+  * @param  None
+  * @retval None
+  */
+void benchMem(void)
+{
+	uint32_t u32_Start;
+	uint32_t u32_Cycles;
+
+	u32_Start = LL_DWT_GetCycle();
+	mem_cpy08((uint8_t *)&u32s_BenchDst[0], (const uint8_t *)&u32s_BenchSrc[0], BENCH_MEM_SIZE);
+	u32_Cycles = LL_DWT_GetCycle() - u32_Start;
+	testBenchResult("mem", "cpy08_1k", u32_Cycles, "cyc");
+
+	u32_Start = LL_DWT_GetCycle();
+	mem_cpy32(&u32s_BenchDst[0], &u32s_BenchSrc[0], BENCH_MEM_SIZE / 4);
+	u32_Cycles = LL_DWT_GetCycle() - u32_Start;
+	testBenchResult("mem", "cpy32_1k", u32_Cycles, "cyc");
+}
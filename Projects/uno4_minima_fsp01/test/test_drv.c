@@ -0,0 +1,574 @@
+/**
+  ******************************************************************************
+  * @file           : test_drv.c
+  * @brief          : ドライバーのテスト
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_runner.h"
+#if !defined(__arm__)
+#include "sim_ra4m1.h"
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+/* エッジ検出の確認に使う端子(出力した値をPIDRで読み戻す) */
+#define TEST_EDGE_PORT		LED_TXRX_PORT			/* TX LED(P012)					*/
+#define TEST_EDGE_MASK		LED_TX_MASK
+
+/* CAN(内部ループバックは実機でもトランシーバー無しで動く) */
+#define TEST_CAN_BITRATE	(500000)				/* 通信速度[bps]				*/
+#define TEST_CAN_BASE_ID	(0x100)					/* 受信するID(0x100～0x10F)		*/
+#define TEST_CAN_REJECT_ID	(0x200)					/* フィルターで捨てるID			*/
+#define TEST_CAN_FRAME_NUM	(8)						/* 受信するフレーム数			*/
+#define TEST_CAN_ECHO_ID	(0x321)					/* 応答ノードへのID(応答はID+1)	*/
+
+#if !defined(__arm__)
+/* IIC(ホスト実行版が模擬するスレーブ) */
+#define TEST_IIC_EEPROM		(0x50)					/* EEPROM(24C02相当)			*/
+#define TEST_IIC_SENSOR		(0x48)					/* 温度センサー(LM75相当)		*/
+#define TEST_IIC_MISSING	(0x30)					/* 存在しないスレーブ			*/
+#define TEST_IIC_EEP_ADDR	(0x40)					/* EEPROMの試験アドレス			*/
+#define TEST_IIC_EEP_SIZE	(8)						/* EEPROMの試験サイズ(1ページ)	*/
+#define TEST_IIC_REG_TEMP	(0x00)					/* センサー 温度レジスタ		*/
+#define TEST_IIC_REG_FAULT	(0xF0)					/* センサー 障害注入レジスタ	*/
+#define TEST_IIC_FAULT_STRETCH	(0x01)				/* 障害注入 長いクロックストレッチ	*/
+#define TEST_IIC_FAULT_STUCK	(0x02)				/* 障害注入 STOP後のSDA固定		*/
+#define TEST_IIC_POLL_MAX	(40)					/* 書き込み完了待ちの最大回数	*/
+#define TEST_IIC_NOT_DONE	(0xFF)					/* 結果 未完了					*/
+
+/* IIC 段階(前の段階の転送が全て完了してから進む) */
+#define TEST_IIC_STEP_WRITE		(0)					/* EEPROM書き込み				*/
+#define TEST_IIC_STEP_POLL		(1)					/* 書き込み完了待ち				*/
+#define TEST_IIC_STEP_READ		(2)					/* 読み返し,温度,NACKの確認		*/
+#define TEST_IIC_STEP_STRETCH	(3)					/* タイムアウトの確認			*/
+#define TEST_IIC_STEP_RECOVER	(4)					/* バス復旧の確認				*/
+
+/* IIC 転送番号 */
+#define TEST_IIC_ID_WRITE		(0)					/* EEPROM書き込み				*/
+#define TEST_IIC_ID_POLL		(1)					/* EEPROM書き込み完了待ち		*/
+#define TEST_IIC_ID_READ		(2)					/* EEPROM読み返し				*/
+#define TEST_IIC_ID_TEMP		(3)					/* 温度読み出し					*/
+#define TEST_IIC_ID_MISSING		(4)					/* 存在しないスレーブ			*/
+#define TEST_IIC_ID_FAULT		(5)					/* 障害注入						*/
+#define TEST_IIC_ID_FAULT_READ	(6)					/* 障害注入後の温度読み出し		*/
+#define TEST_IIC_ID_PROBE		(7)					/* 応答確認(バスエラー)			*/
+#define TEST_IIC_ID_AFTER		(8)					/* 復旧後の温度読み出し			*/
+#define TEST_IIC_ID_NUM			(9)
+
+/* UARTパケット受信 */
+#define TEST_PKT_IDLE_CHARS	(3)						/* 終端とする無受信の文字数		*/
+#define TEST_PKT_SIZE		(16)					/* 試験パケットの最大サイズ		*/
+
+/* KVS電源断(ホスト実行版のデータフラッシュで書き込みの途中に電源断させる) */
+#define TEST_KVS_KEY		(KVS_KEY_MAX - 1)		/* 試験に使うキー				*/
+#define TEST_KVS_LEN		(8)						/* 値の長さ						*/
+#define TEST_KVS_CUT_MAX	(TEST_KVS_LEN + 4 + 1)	/* 電源断させる回数目の最大(レコード+1)	*/
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t u8s_CanEchoes;						/* CAN 受信した応答の数			*/
+static uint8_t u8s_CanSeen;							/* CAN 受信したフレーム(bitn:n番目)	*/
+
+#if !defined(__arm__)
+static uint8_t u8s_IicStep;							/* IIC 段階						*/
+static uint8_t u8s_IicPolls;						/* IIC 書き込み完了待ちの回数	*/
+static uint8_t u8s_IicPending;						/* IIC 未完了の転送数			*/
+static uint8_t u8s_IicResult[TEST_IIC_ID_NUM];		/* IIC 結果(IIC_RESULT_xxx)		*/
+static uint8_t u8s_IicTx[1 + TEST_IIC_EEP_SIZE];	/* IIC 送信データ				*/
+static uint8_t u8s_IicReg[1];						/* IIC 温度レジスタの指定		*/
+static uint8_t u8s_IicFault[2];						/* IIC 障害注入の送信データ		*/
+static uint8_t u8s_IicRead[TEST_IIC_EEP_SIZE];		/* IIC EEPROM読み返しデータ		*/
+static uint8_t u8s_IicTemp[3][2];					/* IIC 温度(通常,障害注入後,復旧後)	*/
+static uint32_t u32s_IicRecoveries;					/* IIC 障害注入前の復旧回数		*/
+
+static uint8_t u8s_PktStep;							/* パケット 段階				*/
+static volatile uint8_t u8s_PktCount;				/* パケット 受信数				*/
+static uint16_t u16s_PktSize;						/* パケット 最後のサイズ		*/
+static uint8_t u8s_PktData[TEST_PKT_SIZE];			/* パケット 最後のデータ		*/
+
+static uint8_t u8s_KvsCut;							/* KVS 電源断させる回数目(0:電源断無し)	*/
+static bool bls_KvsCommitted;						/* KVS 前の値を書き込み済み		*/
+static uint8_t u8s_KvsOld;							/* KVS 前の値で復元された回数	*/
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+static void can_test_frame(uint8_t u8_Index, uint32_t u32_Id, CanFrame *pst_Frame);	/* CAN 試験フレーム作成	*/
+#if !defined(__arm__)
+static void iic_test_submit(uint8_t u8_Id, uint8_t u8_Addr, const uint8_t *pu8_Tx, uint16_t u16_TxSize, uint8_t *pu8_Rx, uint16_t u16_RxSize);	/* IIC 転送登録	*/
+static void iic_test_callback(const IicTransfer *pst_Xfer, uint8_t u8_Result, uint32_t u32_TimeUs);	/* IIC 転送完了コールバック	*/
+static void pkt_test_callback(const uint8_t *pu8_Data, uint16_t u16_Size, uint32_t u32_TimeUs);	/* パケット受信コールバック	*/
+static void kvs_test_value(uint8_t u8_Seed, uint8_t *pu8_Value);	/* KVS 試験値作成			*/
+#endif
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  GPIOのエッジ検出
+  * @param  None
+  * @retval None
+  * @note   出力端子の入力レベル(PIDR)でエッジを作り、周期処理
+  *         (taskGpioDriverInput)のサンプリングで検出されることと、
+  *         サンプリングの間に戻るパルスは検出されないことを確認する
+  */
+void testGpioEdge(void)
+{
+	TEST_ASSERT(TEST_EDGE_MASK != 0);
+	gpioSet(TEST_EDGE_PORT, TEST_EDGE_MASK);		/* 消灯 */
+	gpioSetOutput(TEST_EDGE_PORT, TEST_EDGE_MASK);
+	gpioEdgeWatch(TEST_EDGE_PORT, TEST_EDGE_MASK);
+	TEST_ASSERT_EQUAL(0, gpioGetEdge(TEST_EDGE_PORT, TEST_EDGE_MASK, GPIO_EDGE_BOTH));
+
+	/* 立ち下がり(取得したエッジはクリアされる) */
+	gpioClear(TEST_EDGE_PORT, TEST_EDGE_MASK);
+	taskGpioDriverInput();
+	TEST_ASSERT_EQUAL(0, gpioGetEdge(TEST_EDGE_PORT, TEST_EDGE_MASK, GPIO_EDGE_RISING));
+	TEST_ASSERT_EQUAL(TEST_EDGE_MASK, gpioGetEdge(TEST_EDGE_PORT, TEST_EDGE_MASK, GPIO_EDGE_FALLING));
+	TEST_ASSERT_EQUAL(0, gpioGetEdge(TEST_EDGE_PORT, TEST_EDGE_MASK, GPIO_EDGE_FALLING));
+
+	/* 立ち上がり(gpioGetEdge()の再サンプリングで検出する) */
+	gpioSet(TEST_EDGE_PORT, TEST_EDGE_MASK);
+	TEST_ASSERT_EQUAL(TEST_EDGE_MASK, gpioGetEdge(TEST_EDGE_PORT, TEST_EDGE_MASK, GPIO_EDGE_RISING));
+
+	/* 両エッジ(読み出すまで保持する) */
+	gpioClear(TEST_EDGE_PORT, TEST_EDGE_MASK);
+	taskGpioDriverInput();
+	gpioSet(TEST_EDGE_PORT, TEST_EDGE_MASK);
+	taskGpioDriverInput();
+	TEST_ASSERT_EQUAL(TEST_EDGE_MASK, gpioGetEdge(TEST_EDGE_PORT, TEST_EDGE_MASK, GPIO_EDGE_FALLING));
+	TEST_ASSERT_EQUAL(TEST_EDGE_MASK, gpioGetEdge(TEST_EDGE_PORT, TEST_EDGE_MASK, GPIO_EDGE_RISING));
+
+	/* サンプリングの間に戻るパルスは検出できない(制限事項) */
+	gpioClear(TEST_EDGE_PORT, TEST_EDGE_MASK);
+	gpioSet(TEST_EDGE_PORT, TEST_EDGE_MASK);
+	taskGpioDriverInput();
+	TEST_ASSERT_EQUAL(0, gpioGetEdge(TEST_EDGE_PORT, TEST_EDGE_MASK, GPIO_EDGE_BOTH));
+
+	gpioEdgeWatch(TEST_EDGE_PORT, 0);
+	gpioClear(TEST_EDGE_PORT, TEST_EDGE_MASK);
+	taskGpioDriverInput();
+	TEST_ASSERT_EQUAL(0, gpioGetEdge(TEST_EDGE_PORT, TEST_EDGE_MASK, GPIO_EDGE_BOTH));
+	gpioSet(TEST_EDGE_PORT, TEST_EDGE_MASK);
+}
+
+/**
+  * @brief  CANの内部ループバック
+  * @param  None
+  * @retval None
+  * @note   受信フィルター(0x100～0x10F)を設定して送信し、フィルターに合う
+  *         フレームだけを1回ずつ受信することと、データ長とデータが一致する
+  *         ことを確認する(TEST_CAN_REJECT_IDは途中で送信して捨てられること)
+  */
+void testCanLoopback(void)
+{
+	static const CanFilter st_Filter = {TEST_CAN_BASE_ID, CAN_ID_STD_MASK & ~0x00FUL};
+	CanConfig st_Config;
+	CanFrame st_Frame;
+	CanFrame st_Expect;
+	CanStatus st_Status;
+	uint8_t _i;
+
+	if (testGetCycle() == 0) {
+		st_Config.u32_bitrate = TEST_CAN_BITRATE;
+		st_Config.u8_mode = CAN_MODE_LOOPBACK;
+		st_Config.u8_filter_num = 1;
+		st_Config.pst_filters = &st_Filter;
+		TEST_ASSERT_EQUAL(OK, canStart(&st_Config));
+		for (_i=0; _i<TEST_CAN_FRAME_NUM; _i++) {
+			if (_i == (TEST_CAN_FRAME_NUM / 2)) {
+				can_test_frame(_i, TEST_CAN_REJECT_ID, &st_Frame);
+				TEST_ASSERT_EQUAL(OK, canSend(&st_Frame));
+			}
+			can_test_frame(_i, TEST_CAN_BASE_ID + _i, &st_Frame);
+			TEST_ASSERT_EQUAL(OK, canSend(&st_Frame));
+		}
+		u8s_CanSeen = 0;
+		testContinue();
+		return;
+	}
+
+	while (canReceive(&st_Frame) == OK) {
+		TEST_ASSERT((st_Frame.u32_id >= TEST_CAN_BASE_ID) && (st_Frame.u32_id < (TEST_CAN_BASE_ID + TEST_CAN_FRAME_NUM)));
+		_i = (uint8_t)(st_Frame.u32_id - TEST_CAN_BASE_ID);
+		TEST_ASSERT((u8s_CanSeen & (1U << _i)) == 0);
+		u8s_CanSeen |= (uint8_t)(1U << _i);
+		can_test_frame(_i, st_Frame.u32_id, &st_Expect);
+		TEST_ASSERT_EQUAL(st_Expect.u8_dlc, st_Frame.u8_dlc);
+		TEST_ASSERT(mem_cmp08(&st_Frame.u8_data[0], &st_Expect.u8_data[0], st_Expect.u8_dlc) == 0);
+	}
+	canGetStatus(&st_Status);
+	if ((u8s_CanSeen != (uint8_t)((1U << TEST_CAN_FRAME_NUM) - 1)) || (st_Status.u8_tx_pending > 0)) {
+		testContinue();
+		return;
+	}
+	TEST_ASSERT_EQUAL(0, st_Status.u32_rx_dropped);
+	canStop();
+}
+
+#if !defined(__arm__)
+/**
+  * @brief  CANの応答ノード(ホスト実行版のみ)
+  * @param  None
+  * @retval None
+  * @note   通常モードで送信したフレームに、バスの応答ノード(-b echo)が
+  *         ID+1で同じデータを送り返すことを確認する
+  */
+void testCanEcho(void)
+{
+	CanConfig st_Config;
+	CanFrame st_Frame;
+	CanFrame st_Expect;
+
+	if (testGetCycle() == 0) {
+		st_Config.u32_bitrate = TEST_CAN_BITRATE;
+		st_Config.u8_mode = CAN_MODE_NORMAL;
+		st_Config.u8_filter_num = 0;
+		st_Config.pst_filters = NULL;
+		TEST_ASSERT_EQUAL(OK, canStart(&st_Config));
+		can_test_frame(5, TEST_CAN_ECHO_ID, &st_Frame);
+		TEST_ASSERT_EQUAL(OK, canSend(&st_Frame));
+		u8s_CanEchoes = 0;
+		testContinue();
+		return;
+	}
+
+	while (canReceive(&st_Frame) == OK) {
+		TEST_ASSERT_EQUAL(TEST_CAN_ECHO_ID + 1, st_Frame.u32_id);
+		can_test_frame(5, TEST_CAN_ECHO_ID, &st_Expect);
+		TEST_ASSERT_EQUAL(st_Expect.u8_dlc, st_Frame.u8_dlc);
+		TEST_ASSERT(mem_cmp08(&st_Frame.u8_data[0], &st_Expect.u8_data[0], st_Expect.u8_dlc) == 0);
+		u8s_CanEchoes++;
+	}
+	if (u8s_CanEchoes == 0) {
+		testContinue();
+		return;
+	}
+	TEST_ASSERT_EQUAL(1, u8s_CanEchoes);
+	canStop();
+}
+
+/**
+  * @brief  IICのEEPROM/センサー/NACK(ホスト実行版のみ)
+  * @param  None
+  * @retval None
+  * @note   ホスト実行版が模擬するスレーブで、段階毎に転送を登録して完了を待つ
+  *         - EEPROMへ1ページ書き込み、書き込み中のNACKの後にACKを返すまで待つ
+  *         - 読み返しが一致,温度が範囲内,存在しないスレーブはアドレスにNACK
+  *         - 長いクロックストレッチはタイムアウトで打ち切る
+  *         - STOP後のSDA固定はバスエラーになり、復旧後の転送は成功する
+  */
+void testIic(void)
+{
+	IicStatistics st_Stat;
+	uint8_t _i;
+
+	if (testGetCycle() == 0) {
+		u8s_IicStep = TEST_IIC_STEP_WRITE;
+		u8s_IicPolls = 0;
+		u8s_IicPending = 0;
+	}
+	if (u8s_IicPending > 0) {
+		testContinue();
+		return;
+	}
+
+	switch (u8s_IicStep) {
+	case TEST_IIC_STEP_WRITE:
+		u8s_IicTx[0] = TEST_IIC_EEP_ADDR;
+		for (_i=0; _i<TEST_IIC_EEP_SIZE; _i++) {
+			u8s_IicTx[1 + _i] = (uint8_t)(0x5A ^ (_i * 0x21));
+		}
+		iic_test_submit(TEST_IIC_ID_WRITE, TEST_IIC_EEPROM, &u8s_IicTx[0], sizeof(u8s_IicTx), NULL, 0);
+		u8s_IicStep = TEST_IIC_STEP_POLL;
+		break;
+	case TEST_IIC_STEP_POLL:
+		if (u8s_IicPolls == 0) {
+			TEST_ASSERT_EQUAL(IIC_RESULT_OK, u8s_IicResult[TEST_IIC_ID_WRITE]);
+		}
+		/* 書き込み中はアドレスにNACKを返す */
+		else if (u8s_IicResult[TEST_IIC_ID_POLL] != IIC_RESULT_NACK_ADDR) {
+			TEST_ASSERT_EQUAL(IIC_RESULT_OK, u8s_IicResult[TEST_IIC_ID_POLL]);
+			TEST_ASSERT(u8s_IicPolls > 1);
+			u8s_IicStep = TEST_IIC_STEP_READ;
+			iic_test_submit(TEST_IIC_ID_READ, TEST_IIC_EEPROM, &u8s_IicTx[0], 1, &u8s_IicRead[0], TEST_IIC_EEP_SIZE);
+			u8s_IicReg[0] = TEST_IIC_REG_TEMP;
+			iic_test_submit(TEST_IIC_ID_TEMP, TEST_IIC_SENSOR, &u8s_IicReg[0], 1, &u8s_IicTemp[0][0], 2);
+			iic_test_submit(TEST_IIC_ID_MISSING, TEST_IIC_MISSING, &u8s_IicReg[0], 1, NULL, 0);
+			break;
+		}
+		TEST_ASSERT(u8s_IicPolls < TEST_IIC_POLL_MAX);
+		u8s_IicPolls++;
+		iic_test_submit(TEST_IIC_ID_POLL, TEST_IIC_EEPROM, NULL, 0, NULL, 0);
+		break;
+	case TEST_IIC_STEP_READ:
+		TEST_ASSERT_EQUAL(IIC_RESULT_OK, u8s_IicResult[TEST_IIC_ID_READ]);
+		TEST_ASSERT(mem_cmp08(&u8s_IicRead[0], &u8s_IicTx[1], TEST_IIC_EEP_SIZE) == 0);
+		/* 25.0～28.5℃(上位:整数部,下位bit7:0.5℃) */
+		TEST_ASSERT_EQUAL(IIC_RESULT_OK, u8s_IicResult[TEST_IIC_ID_TEMP]);
+		TEST_ASSERT((u8s_IicTemp[0][0] >= 25) && (u8s_IicTemp[0][0] <= 28));
+		TEST_ASSERT_EQUAL(0, u8s_IicTemp[0][1] & 0x7F);
+		TEST_ASSERT_EQUAL(IIC_RESULT_NACK_ADDR, u8s_IicResult[TEST_IIC_ID_MISSING]);
+		u8s_IicFault[0] = TEST_IIC_REG_FAULT;
+		u8s_IicFault[1] = TEST_IIC_FAULT_STRETCH;
+		iic_test_submit(TEST_IIC_ID_FAULT, TEST_IIC_SENSOR, &u8s_IicFault[0], 2, NULL, 0);
+		iic_test_submit(TEST_IIC_ID_FAULT_READ, TEST_IIC_SENSOR, &u8s_IicReg[0], 1, &u8s_IicTemp[1][0], 2);
+		u8s_IicStep = TEST_IIC_STEP_STRETCH;
+		break;
+	case TEST_IIC_STEP_STRETCH:
+		TEST_ASSERT_EQUAL(IIC_RESULT_OK, u8s_IicResult[TEST_IIC_ID_FAULT]);
+		TEST_ASSERT_EQUAL(IIC_RESULT_TIMEOUT, u8s_IicResult[TEST_IIC_ID_FAULT_READ]);
+		iicGetStatistics(&st_Stat);
+		u32s_IicRecoveries = st_Stat.u32_recoveries;
+		u8s_IicFault[1] = TEST_IIC_FAULT_STUCK;
+		iic_test_submit(TEST_IIC_ID_FAULT, TEST_IIC_SENSOR, &u8s_IicFault[0], 2, NULL, 0);
+		iic_test_submit(TEST_IIC_ID_FAULT_READ, TEST_IIC_SENSOR, &u8s_IicReg[0], 1, &u8s_IicTemp[1][0], 2);
+		iic_test_submit(TEST_IIC_ID_PROBE, TEST_IIC_SENSOR, NULL, 0, NULL, 0);
+		iic_test_submit(TEST_IIC_ID_AFTER, TEST_IIC_SENSOR, &u8s_IicReg[0], 1, &u8s_IicTemp[2][0], 2);
+		u8s_IicStep = TEST_IIC_STEP_RECOVER;
+		break;
+	default:
+		TEST_ASSERT_EQUAL(IIC_RESULT_OK, u8s_IicResult[TEST_IIC_ID_FAULT]);
+		TEST_ASSERT_EQUAL(IIC_RESULT_OK, u8s_IicResult[TEST_IIC_ID_FAULT_READ]);
+		TEST_ASSERT_EQUAL(IIC_RESULT_BUS_ERROR, u8s_IicResult[TEST_IIC_ID_PROBE]);
+		TEST_ASSERT_EQUAL(IIC_RESULT_OK, u8s_IicResult[TEST_IIC_ID_AFTER]);
+		iicGetStatistics(&st_Stat);
+		TEST_ASSERT(st_Stat.u32_recoveries > u32s_IicRecoveries);
+		return;
+	}
+	testContinue();
+}
+
+/**
+  * @brief  UARTのパケット受信(ホスト実行版のみ)
+  * @param  None
+  * @retval None
+  * @note   SCI1に受信データを積み、無受信の区切りでパケット毎にコールバック
+  *         されることと統計情報を確認する。停止後は通常の受信に戻ること
+  */
+void testUartPacket(void)
+{
+	static const uint8_t u8_Packet1[] = {0x01, 0x02, 0x03, 0x04, 0x05};
+	static const uint8_t u8_Packet2[] = {0xA5, 0x5A, 0x00, 0xFF, 0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0x70};
+	UartPacketStatistics st_Stat;
+	uint8_t u8_Data[4];
+
+	if (testGetCycle() == 0) {
+		u8s_PktStep = 0;
+		u8s_PktCount = 0;
+		TEST_ASSERT_EQUAL(OK, uartPacketStart(pkt_test_callback, TEST_PKT_IDLE_CHARS));
+		TEST_ASSERT_EQUAL(NG, uartPacketStart(pkt_test_callback, TEST_PKT_IDLE_CHARS));
+		TEST_ASSERT_EQUAL(sizeof(u8_Packet1), simSciReceive(&u8_Packet1[0], sizeof(u8_Packet1)));
+		testContinue();
+		return;
+	}
+
+	switch (u8s_PktStep) {
+	case 0:
+		if (u8s_PktCount < 1) {
+			break;
+		}
+		TEST_ASSERT_EQUAL(1, u8s_PktCount);
+		TEST_ASSERT_EQUAL(sizeof(u8_Packet1), u16s_PktSize);
+		TEST_ASSERT(mem_cmp08(&u8s_PktData[0], &u8_Packet1[0], sizeof(u8_Packet1)) == 0);
+		TEST_ASSERT_EQUAL(sizeof(u8_Packet2), simSciReceive(&u8_Packet2[0], sizeof(u8_Packet2)));
+		u8s_PktStep = 1;
+		break;
+	case 1:
+		if (u8s_PktCount < 2) {
+			break;
+		}
+		TEST_ASSERT_EQUAL(2, u8s_PktCount);
+		TEST_ASSERT_EQUAL(sizeof(u8_Packet2), u16s_PktSize);
+		TEST_ASSERT(mem_cmp08(&u8s_PktData[0], &u8_Packet2[0], sizeof(u8_Packet2)) == 0);
+		uartGetPacketStatistics(&st_Stat);
+		TEST_ASSERT_EQUAL(2, st_Stat.u32_packets);
+		TEST_ASSERT_EQUAL(sizeof(u8_Packet1) + sizeof(u8_Packet2), st_Stat.u32_bytes);
+		TEST_ASSERT_EQUAL(0, st_Stat.u32_splits);
+		/* 停止後は通常の受信に戻る */
+		uartPacketStop();
+		u8_Data[0] = 0x7E;
+		TEST_ASSERT_EQUAL(1, simSciReceive(&u8_Data[0], 1));
+		u8s_PktStep = 2;
+		break;
+	default:
+		if (uartGetRxCount() == 0) {
+			break;
+		}
+		u8_Data[0] = 0;
+		TEST_ASSERT_EQUAL(1, uartGetRxData(&u8_Data[0], sizeof(u8_Data)));
+		TEST_ASSERT_EQUAL(0x7E, u8_Data[0]);
+		TEST_ASSERT_EQUAL(2, u8s_PktCount);
+		return;
+	}
+	testContinue();
+}
+
+/**
+  * @brief  KVSの電源断からの復元(ホスト実行版のみ)
+  * @param  None
+  * @retval None
+  * @note   前の値を書き込んだ後、新しい値のレコードの書き込みをn回目(1～)の
+  *         書き込みの途中で電源断させ、ドライバーを初期化し直して(再起動)
+  *         前の値か新しい値のどちらかが復元されることを確認する。電源断が
+  *         レコードの途中なら前の値,最後に電源断無しで新しい値となること
+  */
+void testKvsPowerCut(void)
+{
+	uint8_t u8_Old[TEST_KVS_LEN];
+	uint8_t u8_New[TEST_KVS_LEN];
+	uint8_t u8_Read[KVS_VALUE_MAX];
+	KvsStatistics st_Stat;
+
+	kvs_test_value(0x10, &u8_Old[0]);
+	kvs_test_value(0x80, &u8_New[0]);
+	if (testGetCycle() == 0) {
+		u8s_KvsCut = 1;
+		u8s_KvsOld = 0;
+		bls_KvsCommitted = false;
+		TEST_ASSERT_EQUAL(OK, kvsSet(TEST_KVS_KEY, &u8_Old[0], TEST_KVS_LEN));
+		kvsFlush();
+		testContinue();
+		return;
+	}
+	if (kvsIsBusy()) {
+		testContinue();
+		return;
+	}
+
+	if (!bls_KvsCommitted) {
+		/* 前の値が書き込まれたので新しい値を書き込みの途中で電源断させる */
+		bls_KvsCommitted = true;
+		TEST_ASSERT_EQUAL(OK, kvsSet(TEST_KVS_KEY, &u8_New[0], TEST_KVS_LEN));
+		simFlashPowerCut(u8s_KvsCut);
+		kvsFlush();
+		testContinue();
+		return;
+	}
+
+	/* 復電して再起動する */
+	simFlashPowerCut(0);
+	taskKvsDriverInit();
+	TEST_ASSERT_EQUAL(TEST_KVS_LEN, kvsGet(TEST_KVS_KEY, &u8_Read[0], sizeof(u8_Read)));
+	if (mem_cmp08(&u8_Read[0], &u8_Old[0], TEST_KVS_LEN) == 0) {
+		/* 書きかけのレコードは読み飛ばす */
+		kvsGetStatistics(&st_Stat);
+		TEST_ASSERT(st_Stat.u32_torn > 0);
+		u8s_KvsOld++;
+	}
+	else {
+		TEST_ASSERT(mem_cmp08(&u8_Read[0], &u8_New[0], TEST_KVS_LEN) == 0);
+	}
+	if (u8s_KvsCut == 0) {
+		TEST_ASSERT(mem_cmp08(&u8_Read[0], &u8_New[0], TEST_KVS_LEN) == 0);
+		TEST_ASSERT(u8s_KvsOld > 0);
+		return;
+	}
+
+	/* 前の値に戻して次の回数目で電源断させる(最後は電源断無し) */
+	u8s_KvsCut = (u8s_KvsCut < TEST_KVS_CUT_MAX) ? (uint8_t)(u8s_KvsCut + 1) : 0;
+	bls_KvsCommitted = false;
+	TEST_ASSERT_EQUAL(OK, kvsSet(TEST_KVS_KEY, &u8_Old[0], TEST_KVS_LEN));
+	kvsFlush();
+	testContinue();
+}
+#endif
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  CAN 試験フレーム作成
+  * @param  u8_Index: 試験フレーム番号(データ長とデータを変える)
+  * @param  u32_Id: ID
+  * @param  pst_Frame: 格納先
+  * @retval None
+  */
+static void can_test_frame(uint8_t u8_Index, uint32_t u32_Id, CanFrame *pst_Frame)
+{
+	uint8_t _i;
+
+	pst_Frame->u32_id = u32_Id;
+	pst_Frame->u8_dlc = (uint8_t)(1 + (u8_Index % 8));
+	pst_Frame->u8_flags = 0;
+	pst_Frame->u16_timestamp = 0;
+	for (_i=0; _i<8; _i++) {
+		pst_Frame->u8_data[_i] = (_i < pst_Frame->u8_dlc) ? (uint8_t)(u32_Id + (_i * 0x11) + u8_Index) : 0;
+	}
+}
+
+#if !defined(__arm__)
+/**
+  * @brief  IIC 転送登録
+  * @param  u8_Id: 転送番号(TEST_IIC_ID_xxx)
+  * @param  u8_Addr: スレーブアドレス
+  * @param  pu8_Tx: 送信データ
+  * @param  u16_TxSize: 送信データ数
+  * @param  pu8_Rx: 受信データの格納先
+  * @param  u16_RxSize: 受信データ数
+  * @retval None
+  */
+static void iic_test_submit(uint8_t u8_Id, uint8_t u8_Addr, const uint8_t *pu8_Tx, uint16_t u16_TxSize, uint8_t *pu8_Rx, uint16_t u16_RxSize)
+{
+	IicTransfer st_Xfer;
+
+	st_Xfer.u8_addr = u8_Addr;
+	st_Xfer.pu8_tx = pu8_Tx;
+	st_Xfer.u16_tx_size = u16_TxSize;
+	st_Xfer.pu8_rx = pu8_Rx;
+	st_Xfer.u16_rx_size = u16_RxSize;
+	st_Xfer.pf_callback = iic_test_callback;
+	st_Xfer.pv_context = (void *)(uintptr_t)u8_Id;
+	u8s_IicResult[u8_Id] = TEST_IIC_NOT_DONE;
+	if (iicSubmit(&st_Xfer) == OK) {
+		u8s_IicPending++;
+	}
+}
+
+/**
+  * @brief  IIC 転送完了コールバック
+  * @param  pst_Xfer: 完了した転送
+  * @param  u8_Result: 結果(IIC_RESULT_xxx)
+  * @param  u32_TimeUs: 転送時間[us]
+  * @retval None
+  */
+static void iic_test_callback(const IicTransfer *pst_Xfer, uint8_t u8_Result, uint32_t u32_TimeUs)
+{
+	(void)u32_TimeUs;
+	u8s_IicResult[(uintptr_t)pst_Xfer->pv_context] = u8_Result;
+	u8s_IicPending--;
+}
+
+/**
+  * @brief  パケット受信コールバック
+  * @param  pu8_Data: パケットデータ
+  * @param  u16_Size: パケットサイズ
+  * @param  u32_TimeUs: 受信完了時刻[us]
+  * @retval None
+  * @note   割り込みから呼ばれる。最後のパケットを保存して受信数を数える
+  */
+static void pkt_test_callback(const uint8_t *pu8_Data, uint16_t u16_Size, uint32_t u32_TimeUs)
+{
+	(void)u32_TimeUs;
+	u16s_PktSize = u16_Size;
+	mem_cpy08(&u8s_PktData[0], pu8_Data, (u16_Size < TEST_PKT_SIZE) ? u16_Size : TEST_PKT_SIZE);
+	u8s_PktCount++;
+}
+
+/**
+  * @brief  KVS 試験値作成
+  * @param  u8_Seed: 先頭の値
+  * @param  pu8_Value: 格納先(TEST_KVS_LEN)
+  * @retval None
+  */
+static void kvs_test_value(uint8_t u8_Seed, uint8_t *pu8_Value)
+{
+	uint8_t _i;
+
+	for (_i=0; _i<TEST_KVS_LEN; _i++) {
+		pu8_Value[_i] = (uint8_t)(u8_Seed + _i);
+	}
+}
+#endif
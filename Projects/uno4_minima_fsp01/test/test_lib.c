@@ -0,0 +1,342 @@
+/**
+  ******************************************************************************
+  * @file           : test_lib.c
+  * @brief          : ライブラリのテスト
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_runner.h"
+#if !defined(__arm__)
+#include <pthread.h>
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_MEM_SIZE		(64)					/* メモリ操作の対象サイズ[byte]	*/
+#define TEST_CORO_EVENT		(0x80000000)			/* コルーチンテスト用イベント	*/
+#define TEST_POOL_THREADS	(4)						/* 競合テストのスレッド数		*/
+#define TEST_POOL_DEPTH		(8)						/* 1スレッドの同時確保数		*/
+#define TEST_POOL_LOOP		(2000)					/* 1スレッドの繰り返し回数		*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t u32s_MemSrc[TEST_MEM_SIZE / 4];
+static uint32_t u32s_MemDst[TEST_MEM_SIZE / 4];
+static uint8_t u8s_CoroStep;						/* コルーチンの進行			*/
+#if !defined(__arm__)
+static uint32_t u32s_PoolStressError;				/* 競合テストの異常数		*/
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+static void test_coro(Coro *pst_Coro);				/* テスト用コルーチン		*/
+#if !defined(__arm__)
+static void *pool_stress_thread(void *pv_Arg);		/* 競合テストのスレッド		*/
+#endif
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  mem_cpyxx
+  * @param  None
+  * @retval None
+  */
+void testMemCopy(void)
+{
+	uint8_t *pu8_Src = (uint8_t *)&u32s_MemSrc[0];
+	uint8_t *pu8_Dst = (uint8_t *)&u32s_MemDst[0];
+	uint8_t _i;
+
+	for (_i=0; _i<TEST_MEM_SIZE; _i++) {
+		pu8_Src[_i] = (uint8_t)(_i * 7 + 1);
+	}
+
+	/* 8bit版(端数の長さ,末尾を書き換えないこと) */
+	mem_set08(pu8_Dst, 0xEE, TEST_MEM_SIZE);
+	mem_cpy08(pu8_Dst, pu8_Src, TEST_MEM_SIZE - 3);
+	TEST_ASSERT_EQUAL(0, mem_cmp08(pu8_Dst, pu8_Src, TEST_MEM_SIZE - 3));
+	TEST_ASSERT_EQUAL(0xEE, pu8_Dst[TEST_MEM_SIZE - 3]);
+
+	/* 16bit版 */
+	mem_set08(pu8_Dst, 0, TEST_MEM_SIZE);
+	mem_cpy16((uint16_t *)pu8_Dst, (const uint16_t *)pu8_Src, TEST_MEM_SIZE / 2);
+	TEST_ASSERT_EQUAL(0, mem_cmp08(pu8_Dst, pu8_Src, TEST_MEM_SIZE));
+
+	/* 32bit版 */
+	mem_set08(pu8_Dst, 0, TEST_MEM_SIZE);
+	mem_cpy32(&u32s_MemDst[0], &u32s_MemSrc[0], TEST_MEM_SIZE / 4);
+	TEST_ASSERT_EQUAL(0, mem_cmp08(pu8_Dst, pu8_Src, TEST_MEM_SIZE));
+}
+
+/**
+  * @brief  mem_setxx/mem_cmpxx
+  * @param  None
+  * @retval None
+  */
+void testMemSetCmp(void)
+{
+	uint8_t *pu8_Dst = (uint8_t *)&u32s_MemDst[0];
+	uint16_t *pu16_Dst = (uint16_t *)&u32s_MemDst[0];
+
+	mem_set32(&u32s_MemDst[0], 0x12345678, TEST_MEM_SIZE / 4);
+	TEST_ASSERT_EQUAL(0x12345678, u32s_MemDst[TEST_MEM_SIZE / 4 - 1]);
+	mem_set16(pu16_Dst, 0xA55A, TEST_MEM_SIZE / 2);
+	TEST_ASSERT_EQUAL(0xA55A, pu16_Dst[TEST_MEM_SIZE / 2 - 1]);
+	mem_set08(pu8_Dst, 0x3C, TEST_MEM_SIZE);
+	TEST_ASSERT_EQUAL(0x3C, pu8_Dst[TEST_MEM_SIZE - 1]);
+
+	/* 一致/不一致(符号は最初の不一致の大小) */
+	mem_cpy32(&u32s_MemSrc[0], &u32s_MemDst[0], TEST_MEM_SIZE / 4);
+	TEST_ASSERT_EQUAL(0, mem_cmp32(&u32s_MemDst[0], &u32s_MemSrc[0], TEST_MEM_SIZE / 4));
+	TEST_ASSERT_EQUAL(0, mem_cmp16(pu16_Dst, (const uint16_t *)&u32s_MemSrc[0], TEST_MEM_SIZE / 2));
+	pu8_Dst[TEST_MEM_SIZE - 1] = 0x3D;
+	TEST_ASSERT(mem_cmp08(pu8_Dst, (const uint8_t *)&u32s_MemSrc[0], TEST_MEM_SIZE) > 0);
+	TEST_ASSERT(mem_cmp08((const uint8_t *)&u32s_MemSrc[0], pu8_Dst, TEST_MEM_SIZE) < 0);
+	TEST_ASSERT(mem_cmp32(&u32s_MemDst[0], &u32s_MemSrc[0], TEST_MEM_SIZE / 4) != 0);
+}
+
+/**
+  * @brief  タイマーの満了/停止
+  * @param  None
+  * @retval None
+  * @note   タイマー更新処理を直接呼び出して時間を進める
+  */
+void testTimer(void)
+{
+	Timer st_Timer;
+
+	startTimer(&st_Timer);
+	TEST_ASSERT(isRunTimer(&st_Timer));
+	TEST_ASSERT(!checkTimer(&st_Timer, SYS_CYCLE_TIME * 2));
+	taskTimerUpdate();
+	TEST_ASSERT(!checkTimer(&st_Timer, SYS_CYCLE_TIME * 2));
+	taskTimerUpdate();
+	TEST_ASSERT(checkTimer(&st_Timer, SYS_CYCLE_TIME * 2));
+
+	stopTimer(&st_Timer);
+	TEST_ASSERT(!isRunTimer(&st_Timer));
+	TEST_ASSERT(!checkTimer(&st_Timer, 0));
+}
+
+/**
+  * @brief  メモリプールのセルフテスト
+  * @param  None
+  * @retval None
+  */
+void testPool(void)
+{
+	TEST_ASSERT_EQUAL(0, poolSelfTest());
+}
+
+/**
+  * @brief  メモリプールの枯渇と解放
+  * @param  None
+  * @retval None
+  * @note   最大クラスを使い切り、確保失敗/二重解放/解放後の再確保を確認する
+  */
+void testPoolExhaust(void)
+{
+	void *pv_Block[POOL_BLOCK_NUM_2];
+	PoolStatistics st_Before;
+	PoolStatistics st_After;
+	uint16_t u16_Free;
+	uint16_t _i;
+
+	TEST_ASSERT_EQUAL(OK, poolGetStatistics(POOL_CLASS_NUM - 1, &st_Before));
+	u16_Free = st_Before.u16_block_num - st_Before.u16_used;
+	for (_i=0; _i<u16_Free; _i++) {
+		pv_Block[_i] = poolAlloc(POOL_BLOCK_SIZE_2);
+		TEST_ASSERT(pv_Block[_i] != NULL);
+	}
+	TEST_ASSERT(poolAlloc(POOL_BLOCK_SIZE_2) == NULL);
+	TEST_ASSERT_EQUAL(OK, poolGetStatistics(POOL_CLASS_NUM - 1, &st_After));
+	TEST_ASSERT_EQUAL(st_Before.u32_fail_count + 1, st_After.u32_fail_count);
+	TEST_ASSERT_EQUAL(st_Before.u16_block_num, st_After.u16_used);
+
+	for (_i=0; _i<u16_Free; _i++) {
+		TEST_ASSERT_EQUAL(OK, poolFree(pv_Block[_i]));
+	}
+	if (u16_Free > 0) {
+		TEST_ASSERT_EQUAL(NG, poolFree(pv_Block[0]));
+	}
+	TEST_ASSERT_EQUAL(OK, poolGetStatistics(POOL_CLASS_NUM - 1, &st_After));
+	TEST_ASSERT_EQUAL(st_Before.u16_used, st_After.u16_used);
+
+	pv_Block[0] = poolAlloc(POOL_BLOCK_SIZE_2);
+	TEST_ASSERT(pv_Block[0] != NULL);
+	TEST_ASSERT_EQUAL(OK, poolFree(pv_Block[0]));
+}
+
+#if !defined(__arm__)
+/**
+  * @brief  メモリプールの競合(ホスト実行版のみ)
+  * @param  None
+  * @retval None
+  * @note   TEST_POOL_THREADS個のスレッドが確保→タグ書き込み→確認→解放を
+  *         繰り返し、空きリストのCAS(更新回数付きブロック番号)を競合させる。
+  *         同じブロックの二重確保はタグの不一致または解放のNGで検出する。
+  *         終了後に確保回数/使用中ブロック数が保存され、クラス0の空きリストに
+  *         全ブロックが揃っていることを確認する。
+  */
+void testPoolStress(void)
+{
+	pthread_t st_Thread[TEST_POOL_THREADS];
+	PoolStatistics st_Before[POOL_CLASS_NUM];
+	PoolStatistics st_After;
+	void *pv_Block[POOL_BLOCK_NUM_0];
+	uint32_t u32_AllocCount = 0;
+	uint16_t u16_Free;
+	uint16_t _i;
+
+	for (_i=0; _i<POOL_CLASS_NUM; _i++) {
+		TEST_ASSERT_EQUAL(OK, poolGetStatistics(_i, &st_Before[_i]));
+	}
+
+	u32s_PoolStressError = 0;
+	for (_i=0; _i<TEST_POOL_THREADS; _i++) {
+		TEST_ASSERT_EQUAL(0, pthread_create(&st_Thread[_i], NULL, pool_stress_thread, (void *)(uintptr_t)_i));
+	}
+	for (_i=0; _i<TEST_POOL_THREADS; _i++) {
+		(void)pthread_join(st_Thread[_i], NULL);
+	}
+	TEST_ASSERT_EQUAL(0, u32s_PoolStressError);
+
+	/* 確保回数は全クラスの合計(空きが無い瞬間は上位クラスから確保される) */
+	for (_i=0; _i<POOL_CLASS_NUM; _i++) {
+		TEST_ASSERT_EQUAL(OK, poolGetStatistics(_i, &st_After));
+		TEST_ASSERT_EQUAL(st_Before[_i].u16_used, st_After.u16_used);
+		TEST_ASSERT_EQUAL(st_Before[_i].u32_fail_count, st_After.u32_fail_count);
+		u32_AllocCount += st_After.u32_alloc_count - st_Before[_i].u32_alloc_count;
+	}
+	TEST_ASSERT_EQUAL(TEST_POOL_THREADS * TEST_POOL_LOOP * TEST_POOL_DEPTH, u32_AllocCount);
+
+	/* 空きブロック数だけクラス0から確保でき、全て異なること */
+	u16_Free = st_Before[0].u16_block_num - st_Before[0].u16_used;
+	for (_i=0; _i<u16_Free; _i++) {
+		pv_Block[_i] = poolAlloc(POOL_BLOCK_SIZE_0);
+		TEST_ASSERT(pv_Block[_i] != NULL);
+		*(uint32_t *)pv_Block[_i] = _i;
+	}
+	TEST_ASSERT_EQUAL(OK, poolGetStatistics(0, &st_After));
+	TEST_ASSERT_EQUAL(st_After.u16_block_num, st_After.u16_used);
+	for (_i=0; _i<u16_Free; _i++) {
+		TEST_ASSERT_EQUAL(_i, *(uint32_t *)pv_Block[_i]);
+		TEST_ASSERT_EQUAL(OK, poolFree(pv_Block[_i]));
+	}
+}
+#endif
+
+/**
+  * @brief  DSPカーネルのセルフテスト
+  * @param  None
+  * @retval None
+  */
+void testDsp(void)
+{
+	TEST_ASSERT_EQUAL(0, dspSelfTest());
+}
+
+/**
+  * @brief  タスク監視のセルフテスト
+  * @param  None
+  * @retval None
+  */
+void testSup(void)
+{
+	TEST_ASSERT_EQUAL(0, supSelfTest());
+}
+
+/**
+  * @brief  コルーチンの待ちと終了
+  * @param  None
+  * @retval None
+  * @note   coroRun()を直接呼び出し、イベントで再開して終了することを確認する
+  */
+void testCoro(void)
+{
+	uint8_t u8_Id;
+
+	u8s_CoroStep = 0;
+	u8_Id = coroStart(test_coro);
+	TEST_ASSERT(u8_Id != CORO_ID_NONE);
+
+	coroRun();
+	TEST_ASSERT_EQUAL(1, u8s_CoroStep);
+	coroRun();
+	TEST_ASSERT_EQUAL(1, u8s_CoroStep);
+
+	coroSetEvent(TEST_CORO_EVENT);
+	coroRun();
+	TEST_ASSERT_EQUAL(2, u8s_CoroStep);
+	TEST_ASSERT(!coroIsRunning(u8_Id));
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  テスト用コルーチン
+  * @param  pst_Coro: コルーチン情報
+  * @retval None
+  */
+static void test_coro(Coro *pst_Coro)
+{
+	CORO_BEGIN(pst_Coro);
+	u8s_CoroStep = 1;
+	CORO_AWAIT_EVENT(pst_Coro, TEST_CORO_EVENT);
+	if (CORO_EVENTS(pst_Coro) == TEST_CORO_EVENT) {
+		u8s_CoroStep = 2;
+	}
+	CORO_END(pst_Coro);
+}
+
+#if !defined(__arm__)
+/**
+  * @brief  競合テストのスレッド
+  * @param  pv_Arg: スレッド番号
+  * @retval NULL
+  * @note   ブロック全体にスレッド番号/周回/位置のタグを書き、全ブロックの
+  *         確保後に確認してから解放する。異常は数えるだけにする
+  *         (TEST_ASSERTはテストを実行するスレッド専用)。
+  */
+static void *pool_stress_thread(void *pv_Arg)
+{
+	uint32_t *pu32_Block[TEST_POOL_DEPTH];
+	uint32_t u32_Thread = (uint32_t)(uintptr_t)pv_Arg;
+	uint32_t u32_Tag;
+	uint32_t _i;
+	uint32_t _j;
+	uint32_t _k;
+
+	for (_i=0; _i<TEST_POOL_LOOP; _i++) {
+		for (_j=0; _j<TEST_POOL_DEPTH; _j++) {
+			pu32_Block[_j] = poolAlloc(POOL_BLOCK_SIZE_0);
+			if (pu32_Block[_j] == NULL) {
+				__atomic_fetch_add(&u32s_PoolStressError, 1, __ATOMIC_RELAXED);
+				continue;
+			}
+			u32_Tag = (u32_Thread << 24) | ((_i & 0xFFFF) << 8) | _j;
+			for (_k=0; _k<(POOL_BLOCK_SIZE_0 / 4); _k++) {
+				((volatile uint32_t *)pu32_Block[_j])[_k] = u32_Tag;
+			}
+		}
+		for (_j=0; _j<TEST_POOL_DEPTH; _j++) {
+			if (pu32_Block[_j] == NULL) {
+				continue;
+			}
+			u32_Tag = (u32_Thread << 24) | ((_i & 0xFFFF) << 8) | _j;
+			for (_k=0; _k<(POOL_BLOCK_SIZE_0 / 4); _k++) {
+				if (((volatile uint32_t *)pu32_Block[_j])[_k] != u32_Tag) {
+					__atomic_fetch_add(&u32s_PoolStressError, 1, __ATOMIC_RELAXED);
+					break;
+				}
+			}
+			if (poolFree(pu32_Block[_j]) != OK) {
+				__atomic_fetch_add(&u32s_PoolStressError, 1, __ATOMIC_RELAXED);
+			}
+		}
+	}
+	return NULL;
+}
+#endif
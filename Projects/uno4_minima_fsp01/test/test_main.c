@@ -0,0 +1,351 @@
+/**
+  ******************************************************************************
+  * @file           : test_main.c
+  * @brief          : テストランナー(テスト用ビルドのMAINアプリケーション)
+  ******************************************************************************
+  * @note   main_app.cの代わりにリンクし、周期処理から1件ずつテストを実行する。
+  *         実機ではOpenOCDのセミホスティング、ホスト実行版では標準エラー出力に
+  *         結果を出力する(出力形式はtest_runner.h)。
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_runner.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_SUITE_NAME		"fsp01"					/* スイート名				*/
+#define TEST_LINE_SIZE		(160)					/* 出力1行の最大長			*/
+
+/* Private macro -------------------------------------------------------------*/
+#define TEST_CASE_NUM		(sizeof(sts_TestCase) / sizeof(sts_TestCase[0]))
+
+/* Private variables ---------------------------------------------------------*/
+
+/* テストケース(実行順) */
+static const TestCase sts_TestCase[] = {
+	{"mem_copy",		testMemCopy},
+	{"mem_set_cmp",		testMemSetCmp},
+	{"timer",			testTimer},
+	{"pool",			testPool},
+	{"pool_exhaust",	testPoolExhaust},
+#if !defined(__arm__)
+	{"pool_stress",		testPoolStress},
+#endif
+	{"dsp",				testDsp},
+	{"sup",				testSup},
+	{"coro",			testCoro},
+	{"gpio_edge",		testGpioEdge},
+	{"can_loopback",	testCanLoopback},
+#if !defined(__arm__)
+	{"can_echo",		testCanEcho},
+	{"iic",				testIic},
+	{"uart_packet",		testUartPacket},
+	{"kvs_power_cut",	testKvsPowerCut},
+#endif
+	{"bench_dsp",		benchDsp},
+	{"bench_pool",		benchPool},
+	{"bench_mem",		benchMem},
+};
+
+static uint16_t u16s_TestIndex;						/* 次に実行するテスト		*/
+static uint16_t u16s_TestPass;						/* 成功数					*/
+static uint16_t u16s_TestFail;						/* 失敗数					*/
+static bool bls_TestDone;							/* 終了を通知した			*/
+static uint16_t u16s_TestCycle;						/* 実行中のテストの周期数	*/
+static bool bls_TestContinue;						/* 次の周期に続ける			*/
+static uint32_t u32s_TestStart;						/* 実行中のテストの開始サイクル	*/
+
+/* 実行中のテストの失敗情報(最初の1件) */
+static bool bls_FailRecorded;
+static const char *pcs_FailFile;
+static uint32_t u32s_FailLine;
+static const char *pcs_FailExpr;
+static uint32_t u32s_FailExpected;
+static uint32_t u32s_FailActual;
+static bool bls_FailValue;
+
+/* 出力行 */
+static char cs_TestLine[TEST_LINE_SIZE];
+static uint16_t u16s_TestLineLen;
+
+/* Private function prototypes -----------------------------------------------*/
+static bool test_run(const TestCase *pst_Case);		/* テストを1周期分実行する	*/
+static void line_str(const char *pc_Str);			/* 文字列を追加する			*/
+static void line_dec(uint32_t u32_Value);			/* 10進数を追加する			*/
+static void line_hex(uint32_t u32_Value);			/* 16進数(0x付き)を追加する	*/
+static void line_send(void);						/* 1行を出力する			*/
+static const char *base_name(const char *pc_Path);	/* パスからファイル名を取り出す	*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  初期化関数
+  * @param  None
+  * @retval None
+  */
+void setup(void)
+{
+	u16s_TestIndex = 0;
+	u16s_TestPass = 0;
+	u16s_TestFail = 0;
+	bls_TestDone = false;
+	u16s_TestCycle = 0;
+
+	line_str("#START " TEST_SUITE_NAME " ");
+	line_dec(TEST_CASE_NUM);
+	line_send();
+}
+
+/**
+  * @brief  周期処理関数
+  * @param  None
+  * @retval None
+  * @note   1周期に1件ずつ実行し(完了を待つテストは終わるまで同じ件)、
+  *         全件の終了後にホストへ終了を通知する
+  */
+void loop(void)
+{
+	if (u16s_TestIndex < TEST_CASE_NUM) {
+		if (test_run(&sts_TestCase[u16s_TestIndex])) {
+			u16s_TestIndex++;
+		}
+		return;
+	}
+	if (!bls_TestDone) {
+		bls_TestDone = true;
+		line_str("#END ");
+		line_dec(u16s_TestPass);
+		line_str(" ");
+		line_dec(u16s_TestFail);
+		line_send();
+		(void)LL_SEMIHOST_Exit(u16s_TestFail == 0);
+	}
+}
+
+/**
+  * @brief  エラー処理ハンドラ
+  * @param  None
+  * @retval None
+  */
+void Error_Handler(void)
+{
+	line_str("#ERROR Error_Handler");
+	line_send();
+	(void)LL_SEMIHOST_Exit(false);
+	/* デバッガー未接続時はアプリケーションと同様に停止する */
+	wdtNotifyError();
+	__disable_irq();
+#if !defined(BOARD_UNO_R4_WIFI)
+	spiReleasePins();
+#endif
+	while (true) {
+		gpioToggle(LED_SCK_PORT, LED_SCK_MASK);
+		LL_mDelay(100);
+	}
+}
+
+/**
+  * @brief  失敗を記録する(TEST_ASSERT_xxx用)
+  * @param  pc_File: ファイル名
+  * @param  u32_Line: 行番号
+  * @param  pc_Expr: 条件式
+  * @param  u32_Expected: 期待値(bl_Value=true時)
+  * @param  u32_Actual: 実際の値(bl_Value=true時)
+  * @param  bl_Value: 期待値と実際の値を出力する
+  * @retval None
+  * @note   1件のテストで最初の失敗だけを出力する
+  */
+void testAssertFailed(const char *pc_File, uint32_t u32_Line, const char *pc_Expr, uint32_t u32_Expected, uint32_t u32_Actual, bool bl_Value)
+{
+	if (bls_FailRecorded) {
+		return;
+	}
+	bls_FailRecorded = true;
+	pcs_FailFile = pc_File;
+	u32s_FailLine = u32_Line;
+	pcs_FailExpr = pc_Expr;
+	u32s_FailExpected = u32_Expected;
+	u32s_FailActual = u32_Actual;
+	bls_FailValue = bl_Value;
+}
+
+/**
+  * @brief  計測値を出力する
+  * @param  pc_Name: 対象名
+  * @param  pc_Item: 項目名
+  * @param  u32_Value: 値
+  * @param  pc_Unit: 単位
+  * @retval None
+  */
+void testBenchResult(const char *pc_Name, const char *pc_Item, uint32_t u32_Value, const char *pc_Unit)
+{
+	line_str("#BENCH ");
+	line_str(pc_Name);
+	line_str(".");
+	line_str(pc_Item);
+	line_str(" ");
+	line_dec(u32_Value);
+	line_str(" ");
+	line_str(pc_Unit);
+	line_send();
+}
+
+/**
+  * @brief  次の周期にもう一度呼び出す
+  * @param  None
+  * @retval None
+  * @note   ドライバーの完了を待つテストが戻る前に呼ぶ。失敗を記録した場合は続けない
+  */
+void testContinue(void)
+{
+	bls_TestContinue = true;
+}
+
+/**
+  * @brief  実行中のテストの周期数を取得する
+  * @param  None
+  * @retval 周期数(最初の呼び出しは0)
+  */
+uint16_t testGetCycle(void)
+{
+	return u16s_TestCycle;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  テストを1周期分実行する
+  * @param  pst_Case: テストケース
+  * @retval true:終了(結果を出力した) false:次の周期に続ける
+  */
+static bool test_run(const TestCase *pst_Case)
+{
+	uint32_t u32_Cycles;
+	uint32_t u32_Mhz;
+
+	if (u16s_TestCycle == 0) {
+		bls_FailRecorded = false;
+		u32s_TestStart = LL_DWT_GetCycle();
+	}
+	bls_TestContinue = false;
+	pst_Case->pf_func();
+	if (bls_TestContinue && !bls_FailRecorded) {
+		u16s_TestCycle++;
+		if (u16s_TestCycle < TEST_CYCLE_MAX) {
+			return false;
+		}
+		testAssertFailed(__FILE__, __LINE__, "timeout", 0, 0, false);
+	}
+	u16s_TestCycle = 0;
+	u32_Cycles = LL_DWT_GetCycle() - u32s_TestStart;
+	u32_Mhz = SystemCoreClock / 1000000;
+
+	line_str("#TEST ");
+	line_str(pst_Case->pc_name);
+	line_str(bls_FailRecorded ? " FAIL " : " PASS ");
+	line_dec((u32_Mhz > 0) ? (u32_Cycles / u32_Mhz) : 0);
+	if (bls_FailRecorded) {
+		u16s_TestFail++;
+		line_str(" ");
+		line_str(base_name(pcs_FailFile));
+		line_str(":");
+		line_dec(u32s_FailLine);
+		line_str(" ");
+		line_str(pcs_FailExpr);
+		if (bls_FailValue) {
+			line_str(" expected=");
+			line_hex(u32s_FailExpected);
+			line_str(" actual=");
+			line_hex(u32s_FailActual);
+		}
+	}
+	else {
+		u16s_TestPass++;
+	}
+	line_send();
+	return true;
+}
+
+/**
+  * @brief  文字列を追加する
+  * @param  pc_Str: 文字列
+  * @retval None
+  * @note   行に収まらない分は切り捨てる(改行の領域は残す)
+  */
+static void line_str(const char *pc_Str)
+{
+	while ((*pc_Str != '\0') && (u16s_TestLineLen < (TEST_LINE_SIZE - 2))) {
+		cs_TestLine[u16s_TestLineLen++] = *pc_Str++;
+	}
+}
+
+/**
+  * @brief  10進数を追加する
+  * @param  u32_Value: 値
+  * @retval None
+  */
+static void line_dec(uint32_t u32_Value)
+{
+	char c_Digit[11];
+	uint8_t u8_Pos = sizeof(c_Digit) - 1;
+
+	c_Digit[u8_Pos] = '\0';
+	do {
+		c_Digit[--u8_Pos] = (char)('0' + (u32_Value % 10));
+		u32_Value /= 10;
+	} while (u32_Value != 0);
+	line_str(&c_Digit[u8_Pos]);
+}
+
+/**
+  * @brief  16進数(0x付き)を追加する
+  * @param  u32_Value: 値
+  * @retval None
+  */
+static void line_hex(uint32_t u32_Value)
+{
+	static const char c_Hex[] = "0123456789ABCDEF";
+	char c_Digit[11];
+	uint8_t _i;
+
+	c_Digit[0] = '0';
+	c_Digit[1] = 'x';
+	for (_i=0; _i<8; _i++) {
+		c_Digit[2 + _i] = c_Hex[(u32_Value >> (28 - (_i * 4))) & 0x0F];
+	}
+	c_Digit[10] = '\0';
+	line_str(c_Digit);
+}
+
+/**
+  * @brief  1行を出力する
+  * @param  None
+  * @retval None
+  */
+static void line_send(void)
+{
+	cs_TestLine[u16s_TestLineLen++] = '\n';
+	cs_TestLine[u16s_TestLineLen] = '\0';
+	(void)LL_SEMIHOST_Write0(cs_TestLine);
+	u16s_TestLineLen = 0;
+}
+
+/**
+  * @brief  パスからファイル名を取り出す
+  * @param  pc_Path: パス
+  * @retval ファイル名
+  */
+static const char *base_name(const char *pc_Path)
+{
+	const char *pc_Name = pc_Path;
+
+	while (*pc_Path != '\0') {
+		if ((*pc_Path == '/') || (*pc_Path == '\\')) {
+			pc_Name = pc_Path + 1;
+		}
+		pc_Path++;
+	}
+	return pc_Name;
+}
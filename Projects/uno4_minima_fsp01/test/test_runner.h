@@ -0,0 +1,100 @@
+/**
+  ******************************************************************************
+  * @file           : test_runner.h
+  * @brief          : テストランナー共通定義
+  ******************************************************************************
+  * @note   テスト用ビルド(uno_r4_minima_test/native_test)ではmain_app.cの代わりに
+  *         test_main.cのsetup()/loop()が動き、周期毎に1件ずつテストを実行する。
+  *         結果はセミホスティングで1行ずつ出力し、全件の終了後にSYS_EXITで
+  *         成否を通知する(test_runner.pyがJUnit/CSVに変換する)。
+  *           #START <スイート名> <件数>
+  *           #TEST <名前> PASS <時間[us]>
+  *           #TEST <名前> FAIL <時間[us]> <ファイル>:<行> <内容>
+  *           #BENCH <名前>.<項目> <値> <単位>
+  *           #END <成功数> <失敗数>
+  *         テスト関数は1周期(WDTのタイムアウト)内に終わること。ドライバーの
+  *         完了を待つテストはtestContinue()を呼んで戻り、次の周期に同じ関数が
+  *         呼ばれる(testGetCycle()が呼び出しの回数目,TEST_CYCLE_MAX周期で失敗)。
+  *         時間は最初の呼び出しから終了までの経過時間とする。
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __TEST_RUNNER_H
+#define __TEST_RUNNER_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "drv.h"
+#include "lib.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/* テストケース */
+typedef struct _TestCase {
+	const char *pc_name;			/* 名前(空白を含まないこと)				*/
+	void (*pf_func)(void);			/* テスト関数							*/
+} TestCase;
+
+/* Exported constants --------------------------------------------------------*/
+#define TEST_CYCLE_MAX		(400)					/* 1件のテストの最大周期数	*/
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* 条件が成立しなければ失敗としてテスト関数を抜ける */
+#define TEST_ASSERT(expr)								\
+	do {												\
+		if (!(expr)) {									\
+			testAssertFailed(__FILE__, __LINE__, #expr, 0, 0, false);	\
+			return;										\
+		}												\
+	} while (0)
+
+/* 値が一致しなければ失敗としてテスト関数を抜ける(期待値と実際の値を出力する) */
+#define TEST_ASSERT_EQUAL(exp, act)						\
+	do {												\
+		uint32_t _e = (uint32_t)(exp);					\
+		uint32_t _a = (uint32_t)(act);					\
+		if (_e != _a) {									\
+			testAssertFailed(__FILE__, __LINE__, #act, _e, _a, true);	\
+			return;										\
+		}												\
+	} while (0)
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+/* test_main.c */
+extern void testAssertFailed(const char *pc_File, uint32_t u32_Line, const char *pc_Expr, uint32_t u32_Expected, uint32_t u32_Actual, bool bl_Value);	/* 失敗を記録する	*/
+extern void testBenchResult(const char *pc_Name, const char *pc_Item, uint32_t u32_Value, const char *pc_Unit);	/* 計測値を出力する	*/
+extern void testContinue(void);													/* 次の周期にもう一度呼び出す		*/
+extern uint16_t testGetCycle(void);												/* 実行中のテストの周期数を取得する	*/
+
+/* test_lib.c */
+extern void testMemCopy(void);													/* mem_cpyxx						*/
+extern void testMemSetCmp(void);												/* mem_setxx/mem_cmpxx				*/
+extern void testTimer(void);													/* タイマーの満了/停止				*/
+extern void testPool(void);														/* メモリプールのセルフテスト		*/
+extern void testPoolExhaust(void);												/* メモリプールの枯渇と解放			*/
+#if !defined(__arm__)
+extern void testPoolStress(void);												/* メモリプールの競合				*/
+#endif
+extern void testDsp(void);														/* DSPカーネルのセルフテスト		*/
+extern void testSup(void);														/* タスク監視のセルフテスト			*/
+extern void testCoro(void);														/* コルーチンの待ちと終了			*/
+
+/* test_drv.c */
+extern void testGpioEdge(void);													/* GPIOのエッジ検出					*/
+extern void testCanLoopback(void);												/* CANの内部ループバック			*/
+#if !defined(__arm__)
+extern void testCanEcho(void);													/* CANの応答ノード					*/
+extern void testIic(void);														/* IICのEEPROM/センサー/NACK		*/
+extern void testUartPacket(void);												/* UARTのパケット受信				*/
+extern void testKvsPowerCut(void);												/* KVSの電源断からの復元			*/
+#endif
+
+/* test_bench.c */
+extern void benchDsp(void);														/* DSPカーネル						*/
+extern void benchPool(void);													/* メモリプール/malloc				*/
+extern void benchMem(void);														/* mem_cpyxx						*/
+
+#endif /* __TEST_RUNNER_H */
@@ -0,0 +1,145 @@
+#
+# テストランナー(ホスト側)
+#   テスト用ビルド(uno_r4_minima_test/native_test)を実行し、セミホスティングで
+#   出力される結果行(#START/#TEST/#BENCH/#END, test/test_runner.h参照)を集計して
+#   JUnit XMLとCSVに書き出す。全件成功で終了コード0を返す。
+#     native: ホスト実行版を早送り(-x)で実行し、標準エラー出力を読む
+#             (CANバスに応答ノード(-b echo)を接続する)
+#     target: OpenOCD(CMSIS-DAP)で実機をリセットし、セミホスティング出力を読む
+#             (先にpio run -e uno_r4_minima_test -t uploadで書き込んでおく)
+#
+#   使い方: python3 test_runner.py native [プログラム] [レポート名]
+#           python3 test_runner.py target [レポート名]
+#
+import os
+import subprocess
+import sys
+import time
+import xml.etree.ElementTree as ET
+
+TIMEOUT = 60.0
+NATIVE_PROGRAM = ".pio/build/native_test/program"
+NATIVE_TIME_LIMIT_MS = 60000
+
+
+def openocd_command():
+    core = os.environ.get("PLATFORMIO_CORE_DIR", os.path.expanduser("~/.platformio"))
+    tool = os.path.join(core, "packages", "tool-openocd")
+    return [
+        os.path.join(tool, "bin", "openocd"),
+        "-s", os.path.join(tool, "openocd", "scripts"),
+        "-f", "interface/cmsis-dap.cfg",
+        "-f", "target/renesas_ra4m1.cfg",
+        "-c", "init",
+        "-c", "reset halt",
+        "-c", "arm semihosting enable",
+        "-c", "resume",
+    ]
+
+
+def run(cmd, stream):
+    # 結果行を読み取り、#ENDまたはタイムアウトで終える
+    proc = subprocess.Popen(cmd, stdin=subprocess.DEVNULL, stdout=subprocess.PIPE if stream == "stdout" else subprocess.DEVNULL,
+                            stderr=subprocess.PIPE if stream == "stderr" else subprocess.STDOUT, text=True, errors="replace")
+    pipe = proc.stdout if stream == "stdout" else proc.stderr
+    result = {"suite": "fsp01", "count": 0, "tests": [], "bench": [], "end": None, "error": None}
+    deadline = time.monotonic() + TIMEOUT
+    for line in pipe:
+        parse(line.strip(), result)
+        if result["end"] is not None or result["error"] is not None or time.monotonic() > deadline:
+            break
+    if result["end"] is None and result["error"] is None:
+        result["error"] = "timeout" if time.monotonic() > deadline else "no #END"
+    # SYS_EXITで終了しない場合(デバッガー切断など)は停止させる
+    try:
+        proc.wait(timeout=5.0)
+    except subprocess.TimeoutExpired:
+        proc.kill()
+        proc.wait()
+    return result, proc.returncode
+
+
+def parse(line, result):
+    # OpenOCDのログ行などの#で始まらない行は読み飛ばす
+    pos = line.find("#")
+    if pos < 0:
+        return
+    words = line[pos:].split(" ")
+    tag = words[0]
+    if tag == "#START" and len(words) >= 3:
+        result["suite"] = words[1]
+        result["count"] = int(words[2])
+    elif tag == "#TEST" and len(words) >= 4:
+        test = {"name": words[1], "passed": words[2] == "PASS", "us": int(words[3]), "message": " ".join(words[4:])}
+        result["tests"].append(test)
+        print("%-16s %s %8d us %s" % (test["name"], words[2], test["us"], test["message"]))
+    elif tag == "#BENCH" and len(words) >= 4:
+        result["bench"].append((words[1], int(words[2]), words[3]))
+    elif tag == "#END" and len(words) >= 3:
+        result["end"] = (int(words[1]), int(words[2]))
+    elif tag == "#ERROR":
+        result["error"] = " ".join(words[1:])
+
+
+def write_junit(path, result):
+    failures = sum(1 for t in result["tests"] if not t["passed"])
+    suite = ET.Element("testsuite", name=result["suite"], tests=str(len(result["tests"])), failures=str(failures),
+                       errors="0" if result["error"] is None else "1",
+                       time="%.6f" % (sum(t["us"] for t in result["tests"]) / 1e6))
+    props = ET.SubElement(suite, "properties")
+    for name, value, unit in result["bench"]:
+        ET.SubElement(props, "property", name="%s[%s]" % (name, unit), value=str(value))
+    for t in result["tests"]:
+        case = ET.SubElement(suite, "testcase", classname=result["suite"], name=t["name"], time="%.6f" % (t["us"] / 1e6))
+        if not t["passed"]:
+            ET.SubElement(case, "failure", message=t["message"])
+    if result["error"] is not None:
+        case = ET.SubElement(suite, "testcase", classname=result["suite"], name="runner")
+        ET.SubElement(case, "error", message=result["error"])
+    ET.ElementTree(suite).write(path, encoding="utf-8", xml_declaration=True)
+
+
+def write_csv(path, result):
+    with open(path, "w") as f:
+        f.write("kind,name,result,value,unit\n")
+        for t in result["tests"]:
+            f.write("test,%s,%s,%d,us\n" % (t["name"], "PASS" if t["passed"] else "FAIL", t["us"]))
+        for name, value, unit in result["bench"]:
+            f.write("bench,%s,,%d,%s\n" % (name, value, unit))
+
+
+def main():
+    if len(sys.argv) < 2 or sys.argv[1] not in ("native", "target"):
+        print("usage: test_runner.py native [program] [report] | target [report]")
+        return 2
+    if sys.argv[1] == "native":
+        program = sys.argv[2] if len(sys.argv) > 2 else NATIVE_PROGRAM
+        report = sys.argv[3] if len(sys.argv) > 3 else "test_report"
+        cmd = [program, "-x", "-t", str(NATIVE_TIME_LIMIT_MS), "-o", os.devnull, "-b", "echo"]
+        result, code = run(cmd, "stderr")
+    else:
+        report = sys.argv[2] if len(sys.argv) > 2 else "test_report"
+        result, code = run(openocd_command(), "stdout")
+
+    write_junit(report + ".xml", result)
+    write_csv(report + ".csv", result)
+
+    passed = sum(1 for t in result["tests"] if t["passed"])
+    failed = len(result["tests"]) - passed
+    missing = result["count"] - len(result["tests"])
+    if result["error"] is not None:
+        print("NG: %s (%d passed, %d failed, %d not run)" % (result["error"], passed, failed, missing))
+        return 1
+    if failed > 0 or missing > 0:
+        print("NG: %d passed, %d failed, %d not run" % (passed, failed, missing))
+        return 1
+    # ホスト実行版はSYS_EXITの成否を終了コードで確認できる
+    if sys.argv[1] == "native" and code != 0:
+        print("NG: exit code %d" % code)
+        return 1
+    print("OK: %d passed, %d benchmarks -> %s.xml, %s.csv" % (passed, len(result["bench"]), report, report))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
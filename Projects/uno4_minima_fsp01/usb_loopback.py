@@ -0,0 +1,62 @@
+#
+# USB仮想COMポート ループバック確認スクリプト
+#   main_appのUSBエコーバックに送信したデータが一致して戻ることを確認し、
+#   スループットを表示する。実機(/dev/ttyACM0)とシミュレーターの
+#   疑似端末(/dev/pts/N)のどちらでも使用できる(pyserial不要)。
+#
+#   使い方: python3 usb_loopback.py デバイス [総バイト数] [送信単位]
+#
+import os
+import select
+import sys
+import termios
+import time
+import tty
+
+TIMEOUT = 5.0
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("usage: usb_loopback.py device [bytes] [chunk]")
+        return 2
+    path = sys.argv[1]
+    total = int(sys.argv[2]) if len(sys.argv) > 2 else 65536
+    chunk = int(sys.argv[3]) if len(sys.argv) > 3 else 256
+
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    termios.tcflush(fd, termios.TCIOFLUSH)
+    # ポートを開くとDTRが送られ、デバイスがエコーを開始する
+    time.sleep(0.2)
+
+    data = bytes((i * 7 + (i >> 8)) & 0xFF for i in range(total))
+    received = bytearray()
+    sent = 0
+    start = time.monotonic()
+    last = start
+    while len(received) < total:
+        wr = [fd] if sent < total else []
+        rd, wr, _ = select.select([fd], wr, [], 0.1)
+        if wr:
+            # 受信が遅れている間は送りすぎない(エコー側のキューを溢れさせない)
+            if sent - len(received) < 4 * chunk:
+                sent += os.write(fd, data[sent:sent + chunk])
+        if rd:
+            received += os.read(fd, 4096)
+            last = time.monotonic()
+        if time.monotonic() - last > TIMEOUT:
+            break
+    elapsed = time.monotonic() - start
+    os.close(fd)
+
+    if bytes(received) != data:
+        diff = next((i for i, (a, b) in enumerate(zip(received, data)) if a != b), min(len(received), total))
+        print("NG: received %d/%d bytes, first mismatch at %d" % (len(received), total, diff))
+        return 1
+    print("OK: %d bytes looped back in %.2f s (%.1f KB/s each way)" % (total, elapsed, total / elapsed / 1024))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
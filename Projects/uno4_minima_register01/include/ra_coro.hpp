@@ -0,0 +1,235 @@
+/*
+ * スタックレス コルーチン(C++20, ヘッダーのみ)
+ *
+ * Task
+ *   コルーチンの戻り値型。フレームは固定長スロットの静的領域から確保し、
+ *   ヒープを使わない(スロットに収まらない/空きが無い場合は生成に失敗する)。
+ * start(Task) / run(ms) / post(Event)
+ *   start()で登録し、loop()からrun()を呼び出す。run()は待ち条件が成立した
+ *   コルーチンだけを再開し、条件の確認はコルーチンを呼び出さずに行う。
+ *   post()は割り込みハンドラーから呼び出せる。
+ * co_await await_timer(ms) / await_uart_rx(rx) / await_event(Event)
+ *   待ち条件はpromiseに保持する(20byte)。イベントは待っている
+ *   コルーチンが再開する時に消費する(待つ前に通知されたイベントも残る)。
+ *   await_event()は成立したイベントを返す。
+ *
+ * ※ C++20(-std=gnu++20, GCC10は-fcoroutines)が必要
+ */
+#ifndef RA_CORO_HPP
+#define RA_CORO_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <coroutine>
+
+/* コルーチン設定(ビルドオプションで変更可) */
+#ifndef RA_CORO_MAX
+#define RA_CORO_MAX			(4)						// 同時に動作できるコルーチン数
+#endif
+#ifndef RA_CORO_FRAME_SIZE
+#define RA_CORO_FRAME_SIZE	(128)					// フレームの最大サイズ[byte]
+#endif
+
+namespace ra::coro {
+
+/* 待ち種別 */
+enum class WaitKind : uint8_t {
+	Yield,											// 次のrun()で再開
+	Timer,											// 時間待ち
+	UartRx,											// UART受信待ち
+	Event,											// イベント待ち
+};
+
+/* 待ち条件 */
+struct Wait {
+	uint32_t u32_start;								// 時間待ちの開始時刻[ms]
+	uint32_t u32_arg;								// 待ち時間[ms] / 待つイベント(再開後は成立したイベント)
+	bool (*pf_ready)(void *);						// 受信待ちの確認関数
+	void *pv_source;								// 受信待ちの対象
+	WaitKind kind;
+};
+
+namespace detail {
+	inline void *frame_alloc(size_t u32_Size) noexcept;
+	inline void frame_free(void *pv_Frame) noexcept;
+}
+
+/* コルーチンの戻り値型 */
+class Task {
+public:
+	struct promise_type {
+		Wait st_wait{0, 0, nullptr, nullptr, WaitKind::Yield};
+
+		Task get_return_object() noexcept { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+		static Task get_return_object_on_allocation_failure() noexcept { return Task(nullptr); }
+		std::suspend_always initial_suspend() noexcept { return {}; }	// 最初のrun()で開始
+		std::suspend_always final_suspend() noexcept { return {}; }	// 終了はrun()が検出して解放
+		void return_void() noexcept {}
+		void unhandled_exception() noexcept {}
+
+		static void *operator new(size_t u32_Size) noexcept { return detail::frame_alloc(u32_Size); }
+		static void operator delete(void *pv_Frame) noexcept { detail::frame_free(pv_Frame); }
+	};
+	using Handle = std::coroutine_handle<promise_type>;
+
+	Task(Task &&other) noexcept : h_(other.h_) { other.h_ = nullptr; }
+	Task(const Task &) = delete;
+	Task &operator=(const Task &) = delete;
+	Task &operator=(Task &&) = delete;
+	~Task() { if (h_) { h_.destroy(); } }
+
+	explicit operator bool() const noexcept { return static_cast<bool>(h_); }	// 生成に成功した
+	Handle release() noexcept { Handle h = h_; h_ = nullptr; return h; }
+
+private:
+	explicit Task(Handle h) noexcept : h_(h) {}
+	Handle h_;
+};
+
+namespace detail {
+	/* フレーム領域(固定長スロット) */
+	alignas(8) inline uint8_t u8_frame[RA_CORO_MAX][RA_CORO_FRAME_SIZE];
+	inline bool bl_frame_used[RA_CORO_MAX];
+
+	/* スケジューラー */
+	inline Task::Handle h_task[RA_CORO_MAX];		// 登録済みのコルーチン(nullptr:空き)
+	inline volatile uint32_t u32_event;				// 未消費のイベント(割り込みで更新)
+	inline uint32_t u32_now;						// run()に渡された現在時刻[ms]
+
+	inline void *frame_alloc(size_t u32_Size) noexcept
+	{
+		if (u32_Size > RA_CORO_FRAME_SIZE) {
+			return nullptr;
+		}
+		for (uint8_t _i = 0; _i < RA_CORO_MAX; _i++) {
+			if (!bl_frame_used[_i]) {
+				bl_frame_used[_i] = true;
+				return &u8_frame[_i][0];
+			}
+		}
+		return nullptr;
+	}
+
+	inline void frame_free(void *pv_Frame) noexcept
+	{
+		const uintptr_t u32_Offset = reinterpret_cast<uintptr_t>(pv_Frame) - reinterpret_cast<uintptr_t>(&u8_frame[0][0]);
+		if (u32_Offset < sizeof(u8_frame)) {
+			bl_frame_used[u32_Offset / RA_CORO_FRAME_SIZE] = false;
+		}
+	}
+
+	/* 待ち条件の成立を確認する(イベント待ちは成立したイベントを消費する) */
+	inline bool ready(Wait &st_Wait)
+	{
+		uint32_t u32_Fired;
+
+		switch (st_Wait.kind) {
+		case WaitKind::Timer:
+			return (u32_now - st_Wait.u32_start) >= st_Wait.u32_arg;	// 32bitの周回を含めて比較
+		case WaitKind::UartRx:
+			return st_Wait.pf_ready(st_Wait.pv_source);
+		case WaitKind::Event:
+			u32_Fired = u32_event & st_Wait.u32_arg;
+			if (u32_Fired == 0) {
+				return false;
+			}
+			__atomic_fetch_and(&u32_event, ~u32_Fired, __ATOMIC_RELAXED);
+			st_Wait.u32_arg = u32_Fired;
+			return true;
+		default:
+			return true;
+		}
+	}
+
+	/* 待ち条件を設定して中断する */
+	struct Awaiter {
+		Wait st_wait;
+		Task::promise_type *pst_promise;
+
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(Task::Handle h) noexcept
+		{
+			pst_promise = &h.promise();
+			st_wait.u32_start = u32_now;
+			pst_promise->st_wait = st_wait;
+		}
+		uint32_t await_resume() const noexcept { return pst_promise->st_wait.u32_arg; }
+	};
+}
+
+/* 次のrun()まで待つ */
+inline detail::Awaiter yield()
+{
+	return {{0, 0, nullptr, nullptr, WaitKind::Yield}, nullptr};
+}
+
+/* 時間[ms]の経過を待つ */
+inline detail::Awaiter await_timer(uint32_t u32_Ms)
+{
+	return {{0, u32_Ms, nullptr, nullptr, WaitKind::Timer}, nullptr};
+}
+
+/* UART受信データを待つ(rx.available()が0より大きくなるまで) */
+template <typename Rx>
+inline detail::Awaiter await_uart_rx(Rx &rx)
+{
+	return {{0, 0, [](void *pv_Rx) { return static_cast<Rx *>(pv_Rx)->available() > 0; }, &rx, WaitKind::UartRx}, nullptr};
+}
+
+/* イベント(いずれかのbit)を待つ */
+inline detail::Awaiter await_event(uint32_t u32_Event)
+{
+	return {{0, u32_Event, nullptr, nullptr, WaitKind::Event}, nullptr};
+}
+
+/* コルーチンを登録する(false:生成失敗/登録数超過) */
+inline bool start(Task &&task)
+{
+	if (!task) {
+		return false;
+	}
+	for (uint8_t _i = 0; _i < RA_CORO_MAX; _i++) {
+		if (!detail::h_task[_i]) {
+			detail::h_task[_i] = task.release();
+			return true;
+		}
+	}
+	return false;
+}
+
+/* イベントを通知する(割り込みハンドラーからも呼び出し可能) */
+inline void post(uint32_t u32_Event)
+{
+	__atomic_fetch_or(&detail::u32_event, u32_Event, __ATOMIC_RELAXED);
+}
+
+/* 待ち条件の成立したコルーチンを再開する(登録順に最大1回ずつ) */
+inline void run(uint32_t u32_NowMs)
+{
+	detail::u32_now = u32_NowMs;
+	for (uint8_t _i = 0; _i < RA_CORO_MAX; _i++) {
+		Task::Handle &h = detail::h_task[_i];
+		if (!h || !detail::ready(h.promise().st_wait)) {
+			continue;
+		}
+		h.resume();
+		if (h.done()) {
+			h.destroy();
+			h = nullptr;
+		}
+	}
+}
+
+/* 動作中のコルーチン数 */
+inline uint8_t active()
+{
+	uint8_t u8_Count = 0;
+	for (uint8_t _i = 0; _i < RA_CORO_MAX; _i++) {
+		u8_Count += detail::h_task[_i] ? 1 : 0;
+	}
+	return u8_Count;
+}
+
+} // namespace ra::coro
+
+#endif /* RA_CORO_HPP */
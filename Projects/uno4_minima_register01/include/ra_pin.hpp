@@ -0,0 +1,196 @@
+/*
+ * RA4M1 端子アクセス テンプレート(ヘッダーのみ)
+ *
+ * Pin<Port, Bit>
+ *   1端子の操作。POSR/PORR(PCNTR3)への書き込みで出力するため
+ *   リード・モディファイ・ライトにならない。
+ * PinGroup<Pins...>
+ *   同一ポートの複数端子。マスクをコンパイル時に合成し、
+ *   1回のPCNTR3書き込みでセット/リセットを同時に行う。
+ * Output<Set<Pins...>, Clear<Pins...>>
+ *   複数ポートにまたがる出力。ポート毎にマスクを合成し、
+ *   変化のあるポートだけに1回ずつPCNTR3を書き込む。
+ * PinConfig<Pin, Value> / configurePins<Configs...>()
+ *   PmnPFS設定値をコンパイル時に計算し、ビットフィールド操作の代わりに
+ *   32bitの書き込みだけで端子機能を設定する。
+ *
+ * ※ C++17(畳み込み式, if constexpr)が必要
+ */
+#ifndef RA_PIN_HPP
+#define RA_PIN_HPP
+
+#include <stdint.h>
+#include <utility>
+#include <bsp_api.h>
+
+namespace ra {
+
+/* ポート数(PORT0～PORT9) */
+constexpr uint8_t PORT_NUM = 10;
+
+/* PmnPFS 設定値 */
+namespace pfs {
+	constexpr uint32_t PODR		= (1UL << 0);		// 出力データ
+	constexpr uint32_t PDR		= (1UL << 2);		// 出力方向
+	constexpr uint32_t PCR		= (1UL << 4);		// 入力プルアップ
+	constexpr uint32_t NCODR	= (1UL << 6);		// Nチャネル オープンドレイン
+	constexpr uint32_t ISEL		= (1UL << 14);		// IRQ入力
+	constexpr uint32_t ASEL		= (1UL << 15);		// アナログ入力
+	constexpr uint32_t PMR		= (1UL << 16);		// 周辺機能
+	constexpr uint32_t RESERVED	= 0xE0FE03AAUL;		// 予約/読み出し専用ビット
+
+	// 駆動能力(0:Low, 1:Middle, 3:High)
+	constexpr uint32_t dscr(uint32_t u32_Drive) { return (u32_Drive & 0x3UL) << 10; }
+	// イベント入力エッジ(0:Don't care, 1:立ち上がり, 2:立ち下がり, 3:両エッジ)
+	constexpr uint32_t eofr(uint32_t u32_Edge) { return (u32_Edge & 0x3UL) << 12; }
+	// 周辺機能選択
+	constexpr uint32_t psel(uint32_t u32_Func) { return (u32_Func & 0x1FUL) << 24; }
+	// 周辺機能端子(PSEL + PMR)
+	constexpr uint32_t peripheral(uint32_t u32_Func) { return psel(u32_Func) | PMR; }
+}
+
+namespace detail {
+	/* ポートのレジスタ(PORTnのアドレス間隔から求める) */
+	inline R_PORT0_Type *port(uint8_t u8_Port)
+	{
+		const uintptr_t u32_Base = reinterpret_cast<uintptr_t>(R_PORT0);
+		const uintptr_t u32_Stride = reinterpret_cast<uintptr_t>(R_PORT1) - u32_Base;
+		return reinterpret_cast<R_PORT0_Type *>(u32_Base + (u32_Stride * u8_Port));
+	}
+
+	/* PDRのリード・モディファイ・ライト(C++20でvolatileの複合代入は非推奨) */
+	inline void pdr(uint8_t u8_Port, uint16_t u16_Output, uint16_t u16_Input)
+	{
+		R_PORT0_Type *pst_Port = port(u8_Port);
+		pst_Port->PDR = static_cast<uint16_t>((pst_Port->PDR | u16_Output) & ~u16_Input);
+	}
+
+	/* PCNTR3 設定値(上位16bit:PORR, 下位16bit:POSR) */
+	constexpr uint32_t pcntr3(uint16_t u16_Set, uint16_t u16_Clear)
+	{
+		return (static_cast<uint32_t>(u16_Clear) << 16) | u16_Set;
+	}
+}
+
+/* 1端子 */
+template <uint8_t Port, uint8_t Bit>
+struct Pin {
+	static_assert(Port < PORT_NUM, "Pin: port out of range");
+	static_assert(Bit < 16, "Pin: bit out of range");
+
+	static constexpr uint8_t port = Port;
+	static constexpr uint8_t bit = Bit;
+	static constexpr uint16_t mask = static_cast<uint16_t>(1U << Bit);
+
+	static void high() { detail::port(Port)->POSR = mask; }		// High出力
+	static void low() { detail::port(Port)->PORR = mask; }			// Low出力
+	static void write(bool bl_Level) { bl_Level ? high() : low(); }
+	static bool read() { return (detail::port(Port)->PIDR & mask) != 0; }
+	static bool isHigh() { return (detail::port(Port)->PODR & mask) != 0; }
+	static void toggle() { isHigh() ? low() : high(); }
+	static void output() { detail::pdr(Port, mask, 0); }			// 出力方向
+	static void input() { detail::pdr(Port, 0, mask); }				// 入力方向
+
+	/* 端子機能設定(PFS書き込みプロテクトは呼び出し側で解除すること) */
+	template <uint32_t Value>
+	static void configure()
+	{
+		static_assert((Value & pfs::RESERVED) == 0, "Pin: reserved PmnPFS bits");
+		volatile uint32_t &u32_Pfs = R_PFS->PORT[Port].PIN[Bit].PmnPFS;
+		if constexpr ((Value & pfs::PMR) != 0) {
+			// 周辺機能: PMR=0の状態でPSELを設定してからPMR=1にする
+			u32_Pfs = Value & ~pfs::PMR;
+		}
+		u32_Pfs = Value;
+	}
+};
+
+/* 同一ポートの複数端子 */
+template <typename First, typename... Rest>
+struct PinGroup {
+	static constexpr uint8_t port = First::port;
+	static constexpr uint16_t mask = static_cast<uint16_t>(First::mask | (0U | ... | Rest::mask));
+
+	static_assert(((Rest::port == port) && ...), "PinGroup: pins must share a port");
+	static_assert((First::mask + (0U + ... + Rest::mask)) == mask, "PinGroup: duplicate pin");
+
+	static void high() { detail::port(port)->POSR = mask; }
+	static void low() { detail::port(port)->PORR = mask; }
+	/* 端子毎の出力(u16_Valueのmask外のビットは無視) */
+	static void write(uint16_t u16_Value)
+	{
+		detail::port(port)->PCNTR3 = detail::pcntr3(u16_Value & mask, static_cast<uint16_t>(~u16_Value & mask));
+	}
+	static uint16_t read() { return detail::port(port)->PIDR & mask; }
+	static void output() { detail::pdr(port, mask, 0); }
+	static void input() { detail::pdr(port, 0, mask); }
+};
+
+/* 出力する端子のリスト */
+template <typename... Pins> struct Set {};
+template <typename... Pins> struct Clear {};
+
+/* 複数ポートにまたがる出力 */
+template <typename SetList, typename ClearList = Clear<>>
+struct Output;
+
+template <typename... SetPins, typename... ClearPins>
+struct Output<Set<SetPins...>, Clear<ClearPins...>> {
+	static constexpr uint16_t setMask(uint8_t u8_Port)
+	{
+		(void)u8_Port;							// 端子が無い場合の未使用警告対策
+		return static_cast<uint16_t>((0U | ... | ((SetPins::port == u8_Port) ? SetPins::mask : 0U)));
+	}
+	static constexpr uint16_t clearMask(uint8_t u8_Port)
+	{
+		(void)u8_Port;							// 端子が無い場合の未使用警告対策
+		return static_cast<uint16_t>((0U | ... | ((ClearPins::port == u8_Port) ? ClearPins::mask : 0U)));
+	}
+	static constexpr uint32_t pcntr3(uint8_t u8_Port)
+	{
+		return detail::pcntr3(setMask(u8_Port), clearMask(u8_Port));
+	}
+	static constexpr bool isDisjoint()
+	{
+		for (uint8_t _i = 0; _i < PORT_NUM; _i++) {
+			if ((setMask(_i) & clearMask(_i)) != 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+	static_assert(isDisjoint(), "Output: pin is both set and cleared");
+
+	static void apply() { apply_ports(std::make_integer_sequence<uint8_t, PORT_NUM>{}); }
+
+private:
+	template <uint8_t... Ports>
+	static void apply_ports(std::integer_sequence<uint8_t, Ports...>) { (apply_port<Ports>(), ...); }
+
+	template <uint8_t Port>
+	static void apply_port()
+	{
+		if constexpr (pcntr3(Port) != 0) {
+			detail::port(Port)->PCNTR3 = pcntr3(Port);
+		}
+	}
+};
+
+/* 端子機能設定 */
+template <typename PinType, uint32_t Value>
+struct PinConfig {
+	static void apply() { PinType::template configure<Value>(); }
+};
+
+/* 端子機能を一括設定する(PFS書き込みプロテクトの解除/設定を含む) */
+template <typename... Configs>
+inline void configurePins()
+{
+	R_BSP_PinAccessEnable();
+	(Configs::apply(), ...);
+	R_BSP_PinAccessDisable();
+}
+
+} // namespace ra
+
+#endif /* RA_PIN_HPP */
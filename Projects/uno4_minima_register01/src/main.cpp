@@ -1,4 +1,6 @@
 #include <Arduino.h>
+#include "ra_pin.hpp"
+#include "ra_coro.hpp"
 
 /* IRQ番号の割り当て */
 // IRQManager との競合を避けるため、
@@ -7,8 +9,49 @@
 #define IRQ_SCI1_RXI		(30)					// UART受信(SCI1)割り込み
 #define IRQ_SCI1_TXI		(29)					// UART送信(SCI1)割り込み
 
+/* 端子定義 */
+using LedSck = ra::Pin<1, 11>;						// SCK LED(P111)
+using LedTx = ra::Pin<0, 12>;						// TX LED(P012)
+using LedRx = ra::Pin<0, 13>;						// RX LED(P013)
+using Sci1Txd = ra::Pin<5, 1>;						// TXD1(P501)
+using Sci1Rxd = ra::Pin<5, 2>;						// RXD1(P502)
+using Irq0Pin = ra::Pin<1, 5>;						// IRQ0(P105)
+
+#define PSEL_SCI_ODD		(0b00101)				// SCI1/3/5/7/9 周辺機能選択
+
+/* コルーチンのイベント */
+#define EVENT_IRQ0			(0x00000001)			// 外部端子(IRQ0)割り込み
+
+/* SCI1 受信バッファ(RXI割り込みで格納, コルーチンで取り出す) */
+struct Sci1RxBuffer {
+	static constexpr uint8_t SIZE = 32;				// 2のべき乗
+	volatile uint8_t u8_data[SIZE];
+	volatile uint8_t u8_head = 0;					// 格納位置(割り込みで更新)
+	volatile uint8_t u8_tail = 0;					// 取り出し位置
+
+	int available() const { return static_cast<uint8_t>(u8_head - u8_tail); }
+	int read()
+	{
+		if (available() == 0) {
+			return -1;
+		}
+		uint8_t u8_Data = u8_data[u8_tail % SIZE];
+		u8_tail = u8_tail + 1;
+		return u8_Data;
+	}
+	void push(uint8_t u8_Data)						// 割り込みハンドラーから呼び出す(満杯時は破棄)
+	{
+		if (available() < SIZE) {
+			u8_data[u8_head % SIZE] = u8_Data;
+			u8_head = u8_head + 1;
+		}
+	}
+};
+static Sci1RxBuffer sts_Sci1Rx;
+
 /* システムタイマー用カウンタ */
 volatile uint32_t u32s_SystemTimeCounter = 0;
+volatile uint32_t u32s_SystemTimeMs = 0;			// 経過時間[ms](コルーチンの時間待ち用)
 
 volatile uint8_t u8s_TxData = 0x00;
 
@@ -22,8 +65,8 @@ void SCI1_RXI_Handler(void)
     /* 割り込み要求フラグ クリア */
 	R_ICU->IELSR_b[IRQ_SCI1_RXI].IR = 0;
 
-	// 1文字送信
-	sci1_putc(R_SCI1->RDR);
+	// 受信バッファに格納(折り返し送信はコルーチンで行う)
+	sts_Sci1Rx.push(R_SCI1->RDR);
 }
 
 /*
@@ -70,27 +113,18 @@ void sci1_init(void)
 	R_SCI1->SCMR = 0xF2;							// 通常モード
 
 	/* ---- ボーレート設定 ---- */
-	// PCLKA = 48MHz
-	// BBR = 48MHz / (64 * 2^(-1) * 9600bps) - 1 = 155.25
+	// BRR = PCLKA / (64 * 2^(-1) * 9600bps) - 1 (四捨五入)
 	// 前提条件1 [SMR.CKS=00b (n=0)]
 	// 前提条件2 [SEMR.ABCS=0b, SEMR.ABCSE=0b, SEMR.BGDM=0b]
-	// 9600bps → BRR = 155
-	R_SCI1->BRR = 155;
+	// PCLKA = 48MHz → BRR = 155
+	R_SCI1->BRR = (uint8_t)(((R_FSP_SystemClockHzGet(FSP_PRIV_CLOCK_PCLKA) + (32 * 9600 / 2)) / (32 * 9600)) - 1);
 
 	/* ---- ポート設定 ---- */
-	// 書き込みプロテクト解除
-//	R_PMISC->PWPR_b.B0WI = 0;
-//	R_PMISC->PWPR_b.PFSWE = 1;
-	R_BSP_PinAccessEnable();
-	// P501 = TXD1, P502 = RXD1
-	R_PFS->PORT[5].PIN[1].PmnPFS_b.PSEL = 0b00101;	// SCI1 TX
-	R_PFS->PORT[5].PIN[2].PmnPFS_b.PSEL = 0b00101;	// SCI1 RX
-	R_PFS->PORT[5].PIN[1].PmnPFS_b.PMR = 1;
-	R_PFS->PORT[5].PIN[2].PmnPFS_b.PMR = 1;
-	// 書き込みプロテクト施錠
-//	R_PMISC->PWPR_b.PFSWE = 0;
-//	R_PMISC->PWPR_b.B0WI = 1;
-	R_BSP_PinAccessDisable();
+	// P501 = TXD1, P502 = RXD1 (書き込みプロテクトの解除/施錠を含む)
+	ra::configurePins<
+		ra::PinConfig<Sci1Txd, ra::pfs::peripheral(PSEL_SCI_ODD)>,	// SCI1 TX
+		ra::PinConfig<Sci1Rxd, ra::pfs::peripheral(PSEL_SCI_ODD)>	// SCI1 RX
+	>();
 
 	/* ---- 送受信有効 ---- */
 	R_SCI1->SCR = 0xF0;								// TIE=1, RIE=1, TE=1, RE=1
@@ -141,8 +175,8 @@ void PORT_IRQ0_Handler(void)
     /* 割り込み要求フラグ クリア */
 	R_ICU->IELSR_b[IRQ_PORT_IRQ0].IR = 0;
 
-	// 1文字送信
-	sci1_putc('e');
+	// イベント通知(表示はコルーチンで行う)
+	ra::coro::post(EVENT_IRQ0);
 }
 
 /* PORT_IRQ0 初期化 */
@@ -158,14 +192,10 @@ void port_irq0_init(void)
 	R_ICU->IRQCR[0] = 0x00;
 
 	/* ---- ポート設定 ---- */
-	// 書き込みプロテクト解除
-	R_BSP_PinAccessEnable();
-	// P105 = IRQ0
-	R_PFS->PORT[1].PIN[5].PmnPFS_b.PMR = 0;			// 汎用入出力端子
-	R_PFS->PORT[1].PIN[5].PmnPFS_b.PCR = 1;			// 入力プルアップ有効
-	R_PFS->PORT[1].PIN[5].PmnPFS_b.ISEL = 1;		// IRQ0入力端子
-	// 書き込みプロテクト施錠
-	R_BSP_PinAccessDisable();
+	// P105 = IRQ0 (汎用入出力端子, 入力プルアップ有効, IRQ0入力端子)
+	ra::configurePins<
+		ra::PinConfig<Irq0Pin, ra::pfs::PCR | ra::pfs::ISEL>
+	>();
 
 	/* ---- PORT_IRQ0 設定 ---- */
 	R_ICU->IRQCR_b[0].IRQMD = 0;					// 立ち下がりエッジ
@@ -185,7 +215,8 @@ void port_irq0_init(void)
 /* SysTick 割り込みハンドラ */
 void SysTick_Handler(void)
 {
-	u32s_SystemTimeCounter++;
+	u32s_SystemTimeMs = u32s_SystemTimeMs + 1;
+	u32s_SystemTimeCounter = u32s_SystemTimeCounter + 1;
 
 	// 割り込みによる1秒周期の確認
 	if (u32s_SystemTimeCounter >= 1000) {
@@ -205,15 +236,63 @@ void sys_timer_init(void)
 	__enable_irq();
 
 	/* ---- System Tick Configuration ---- */
-	// MPUクロック=48MHz → 1tick=1ms に設定
-	SysTick_Config(48000000 / 1000);
+	// MPUクロック(SystemCoreClock) → 1tick=1ms に設定
+	SysTick_Config(SystemCoreClock / 1000);
+}
+
+/* LED点灯 コルーチン(1秒毎に点灯パターンを切り替える) */
+static ra::coro::Task led_task(void)
+{
+	while (true) {
+		// 各ポートの出力データ設定(1)
+		// SCK LED(P111): High出力(点灯), TX/RX LED(P012/P013): High出力(消灯)
+		ra::Output<ra::Set<LedSck, LedTx, LedRx>>::apply();
+		// 1文字送信
+		sci1_putc('1');
+		co_await ra::coro::await_timer(1000);
+
+		// 各ポートの出力データ設定(2)
+		// SCK LED(P111): Low出力(消灯), TX LED(P012): Low出力(点灯), RX LED(P013): High出力(消灯)
+		ra::Output<ra::Set<LedRx>, ra::Clear<LedSck, LedTx>>::apply();
+		// 1文字送信
+		sci1_putc('2');
+		co_await ra::coro::await_timer(1000);
+
+		// 各ポートの出力データ設定(3)
+		// SCK LED(P111): Low出力(消灯), TX LED(P012): High出力(消灯), RX LED(P013): Low出力(点灯)
+		ra::Output<ra::Set<LedTx>, ra::Clear<LedSck, LedRx>>::apply();
+		// 1文字送信
+		sci1_putc('3');
+		co_await ra::coro::await_timer(1000);
+	}
+}
+
+/* UART折り返し コルーチン */
+static ra::coro::Task echo_task(void)
+{
+	while (true) {
+		co_await ra::coro::await_uart_rx(sts_Sci1Rx);
+		// 1文字送信
+		while (sts_Sci1Rx.available() > 0) {
+			sci1_putc(static_cast<char>(sts_Sci1Rx.read()));
+		}
+	}
+}
+
+/* 外部端子(IRQ0) 表示コルーチン */
+static ra::coro::Task irq0_task(void)
+{
+	while (true) {
+		co_await ra::coro::await_event(EVENT_IRQ0);
+		// 1文字送信
+		sci1_putc('e');
+	}
 }
 
 void setup() {
 	// 各ポートの方向設定
-	R_PORT1->PDR_b.PDR11 = 1;						// SCK LED(P111): 出力
-	R_PORT0->PDR_b.PDR12 = 1;						// TX LED(P012): 出力
-	R_PORT0->PDR_b.PDR13 = 1;						// RX LED(P013): 出力
+	LedSck::output();								// SCK LED(P111): 出力
+	ra::PinGroup<LedTx, LedRx>::output();			// TX/RX LED(P012/P013): 出力
 
 	// SCI1 UART 初期化
 	sci1_init();
@@ -223,36 +302,14 @@ void setup() {
 
 	// System Timer 初期化
 	sys_timer_init();
+
+	// コルーチン登録(フレームは静的領域から確保する)
+	if (!ra::coro::start(echo_task()) || !ra::coro::start(irq0_task()) || !ra::coro::start(led_task())) {
+		sci1_puts("coro NG");
+	}
 }
 
 void loop() {
-	// 各ポートの出力データ設定(1)
-	R_PORT1->PODR_b.PODR11 = 1;						// SCK LED(P111): High出力(点灯)
-	R_PORT0->PODR_b.PODR12 = 1;						// TX LED(P012): High出力(消灯)
-	R_PORT0->PODR_b.PODR13 = 1;						// RX LED(P013): High出力(消灯)
-	// 1文字送信
-	sci1_putc('1');
-	delay(1000);
-
-	// 各ポートの出力データ設定(2)
-//	R_PORT1->PODR_b.PODR11 = 0;						// SCK LED(P111): High出力(消灯)
-//	R_PORT0->PODR_b.PODR12 = 0;						// TX LED(P012): High出力(点灯)
-//	R_PORT0->PODR_b.PODR13 = 1;						// RX LED(P013): High出力(消灯)
-	R_PORT1->PORR = 0x0800;
-	R_PORT0->PORR = 0x1000;
-	R_PORT0->POSR = 0x2000;
-	// 1文字送信
-	sci1_putc('2');
-	delay(1000);
-
-	// 各ポートの出力データ設定(3)
-//	R_PORT1->PODR_b.PODR11 = 0;						// SCK LED(P111): High出力(消灯)
-//	R_PORT0->PODR_b.PODR12 = 1;						// TX LED(P012): High出力(消灯)
-//	R_PORT0->PODR_b.PODR13 = 0;						// RX LED(P013): High出力(点灯)
-	R_PORT1->PORR_b.PORR11 = 1;
-	R_PORT0->POSR_b.POSR12 = 1;
-	R_PORT0->PORR_b.PORR13 = 1;
-	// 1文字送信
-	sci1_putc('3');
-	delay(1000);
+	// 待ち条件の成立したコルーチンを再開する
+	ra::coro::run(u32s_SystemTimeMs);
 }
@@ -0,0 +1,132 @@
+/*
+ * ra_pin.hpp テスト用 bsp_api.h 代替(ホストのg++でビルドする)
+ *
+ * ra_pin.hppが使うPORT/PFSのレジスタ型とR_BSP_PinAccessEnable/Disableだけを
+ * FSPと同じ名前で定義する。レジスタはRAM上の配列に置き換えるため、
+ * 書き込んだ値をテストから読み出して確認できる。
+ */
+#ifndef BSP_API_H
+#define BSP_API_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define __IM	volatile const
+#define __OM	volatile
+#define __IOM	volatile
+
+/* 16bitレジスタ(ビット名 <name>0～<name>15) */
+#define STUB_REG16(name)									\
+	union {													\
+		__IOM uint16_t name;								\
+		struct {											\
+			__IOM uint16_t name##0 : 1;						\
+			__IOM uint16_t name##1 : 1;						\
+			__IOM uint16_t name##2 : 1;						\
+			__IOM uint16_t name##3 : 1;						\
+			__IOM uint16_t name##4 : 1;						\
+			__IOM uint16_t name##5 : 1;						\
+			__IOM uint16_t name##6 : 1;						\
+			__IOM uint16_t name##7 : 1;						\
+			__IOM uint16_t name##8 : 1;						\
+			__IOM uint16_t name##9 : 1;						\
+			__IOM uint16_t name##10 : 1;					\
+			__IOM uint16_t name##11 : 1;					\
+			__IOM uint16_t name##12 : 1;					\
+			__IOM uint16_t name##13 : 1;					\
+			__IOM uint16_t name##14 : 1;					\
+			__IOM uint16_t name##15 : 1;					\
+		} name##_b;											\
+	}
+
+/* ---- PORT ---- */
+typedef struct {
+	union {
+		__IOM uint32_t PCNTR1;
+		struct {
+			STUB_REG16(PDR);
+			STUB_REG16(PODR);
+		};
+	};
+	union {
+		__IM uint32_t PCNTR2;
+		struct {
+			STUB_REG16(PIDR);
+			STUB_REG16(EIDR);
+		};
+	};
+	union {
+		__OM uint32_t PCNTR3;
+		struct {
+			STUB_REG16(POSR);
+			STUB_REG16(PORR);
+		};
+	};
+	union {
+		__IOM uint32_t PCNTR4;
+		struct {
+			STUB_REG16(EOSR);
+			STUB_REG16(EORR);
+		};
+	};
+} R_PORT0_Type;
+
+/* ---- PFS ---- */
+typedef struct {
+	union {
+		__IOM uint32_t PmnPFS;
+		struct {
+			__IOM uint32_t PODR : 1;
+			__IM  uint32_t PIDR : 1;
+			__IOM uint32_t PDR : 1;
+			uint32_t : 1;
+			__IOM uint32_t PCR : 1;
+			uint32_t : 1;
+			__IOM uint32_t NCODR : 1;
+			uint32_t : 3;
+			__IOM uint32_t DSCR : 2;
+			__IOM uint32_t EOFR : 2;
+			__IOM uint32_t ISEL : 1;
+			__IOM uint32_t ASEL : 1;
+			__IOM uint32_t PMR : 1;
+			uint32_t : 7;
+			__IOM uint32_t PSEL : 5;
+			uint32_t : 3;
+		} PmnPFS_b;
+	};
+} R_PFS_PIN_Type;
+
+typedef struct {
+	struct {
+		R_PFS_PIN_Type PIN[16];
+	} PORT[15];
+} R_PFS_Type;
+
+/* レジスタの実体(テスト側で定義する,PORTnの間隔は実機と同じ0x20) */
+extern uint32_t g_stub_port[10][8];
+extern uint32_t g_stub_pfs[15][16];
+
+#define R_PORT0		((R_PORT0_Type *)&g_stub_port[0][0])
+#define R_PORT1		((R_PORT0_Type *)&g_stub_port[1][0])
+#define R_PORT2		((R_PORT0_Type *)&g_stub_port[2][0])
+#define R_PORT3		((R_PORT0_Type *)&g_stub_port[3][0])
+#define R_PORT4		((R_PORT0_Type *)&g_stub_port[4][0])
+#define R_PORT5		((R_PORT0_Type *)&g_stub_port[5][0])
+#define R_PORT6		((R_PORT0_Type *)&g_stub_port[6][0])
+#define R_PORT7		((R_PORT0_Type *)&g_stub_port[7][0])
+#define R_PORT8		((R_PORT0_Type *)&g_stub_port[8][0])
+#define R_PORT9		((R_PORT0_Type *)&g_stub_port[9][0])
+#define R_PFS		((R_PFS_Type *)&g_stub_pfs[0][0])
+
+/* PFS書き込みプロテクトの解除/施錠(テスト側で定義する) */
+void R_BSP_PinAccessEnable(void);
+void R_BSP_PinAccessDisable(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BSP_API_H */
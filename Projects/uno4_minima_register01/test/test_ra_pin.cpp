@@ -0,0 +1,120 @@
+/*
+ * ra_pin.hpp のテスト(ホストのg++でビルドする)
+ *
+ * マスク/PCNTR3/PmnPFSの設定値はstatic_assertでコンパイル時に確認し、
+ * 書き込み先のポートと値はtest/stub/bsp_api.hのRAM上のレジスタで確認する。
+ * 失敗した項目を標準エラー出力に出力し、失敗数を終了コードとする。
+ *   例) pio run -e native_test && .pio/build/native_test/program
+ */
+#include <stdio.h>
+#include <string.h>
+#include "ra_pin.hpp"
+
+/* レジスタの実体 */
+uint32_t g_stub_port[10][8];
+uint32_t g_stub_pfs[15][16];
+
+static int i32s_PinAccess = 0;						// PFS書き込みプロテクト解除中
+static int i32s_Fail = 0;							// 失敗数
+
+void R_BSP_PinAccessEnable(void) { i32s_PinAccess++; }
+void R_BSP_PinAccessDisable(void) { i32s_PinAccess--; }
+
+/* 条件が成立しなければ失敗として数える */
+#define CHECK(expr)															\
+	do {																	\
+		if (!(expr)) {														\
+			fprintf(stderr, "%s:%d: FAIL %s\n", __FILE__, __LINE__, #expr);	\
+			i32s_Fail++;													\
+		}																	\
+	} while (0)
+
+/* 端子定義(src/main.cppと同じ) */
+using P0_12 = ra::Pin<0, 12>;
+using P0_13 = ra::Pin<0, 13>;
+using P1_11 = ra::Pin<1, 11>;
+using P1_05 = ra::Pin<1, 5>;
+using P5_01 = ra::Pin<5, 1>;
+
+/* ---- コンパイル時の確認 ---- */
+static_assert(P0_12::mask == 0x1000, "Pin mask");
+static_assert(ra::PinGroup<P0_12, P0_13>::mask == 0x3000, "PinGroup mask");
+static_assert(ra::PinGroup<P0_13>::mask == 0x2000, "PinGroup single mask");
+using Out = ra::Output<ra::Set<P0_13>, ra::Clear<P1_11, P0_12>>;
+static_assert(Out::pcntr3(0) == 0x10002000UL, "Output port0");
+static_assert(Out::pcntr3(1) == 0x08000000UL, "Output port1");
+static_assert(Out::pcntr3(2) == 0, "Output untouched port");
+static_assert(ra::Output<ra::Set<P0_12, P0_13, P1_11>>::pcntr3(0) == 0x00003000UL, "Output set only");
+static_assert(ra::pfs::peripheral(0x05) == 0x05010000UL, "PFS peripheral");
+static_assert((ra::pfs::PCR | ra::pfs::ISEL) == 0x00004010UL, "PFS irq input");
+static_assert((ra::pfs::dscr(3) | ra::pfs::eofr(2)) == 0x00002C00UL, "PFS drive/edge");
+
+/* ---- 実行時の確認 ---- */
+
+/* Pin: POSR/PORRへの書き込み, PDRの方向設定 */
+static void test_pin(void)
+{
+	memset(g_stub_port, 0, sizeof(g_stub_port));
+	P1_11::high();
+	CHECK(R_PORT1->POSR == 0x0800);
+	CHECK(R_PORT1->PORR == 0);
+	P1_11::low();
+	CHECK(R_PORT1->PORR == 0x0800);
+	CHECK(R_PORT0->PCNTR3 == 0);					// 他のポートに書き込まないこと
+
+	R_PORT0->PDR = 0x0001;
+	P0_12::output();
+	CHECK(R_PORT0->PDR == 0x1001);
+	P0_12::input();
+	CHECK(R_PORT0->PDR == 0x0001);
+}
+
+/* PinGroup: 1回のPCNTR3書き込みでセット/リセット */
+static void test_pin_group(void)
+{
+	using Leds = ra::PinGroup<P0_12, P0_13>;
+
+	memset(g_stub_port, 0, sizeof(g_stub_port));
+	Leds::write(0x1000 | 0x0001);					// mask外のビットは無視
+	CHECK(R_PORT0->PCNTR3 == 0x20001000UL);
+	Leds::output();
+	CHECK(R_PORT0->PDR == 0x3000);
+}
+
+/* Output: 変化のあるポートだけに1回ずつ書き込む */
+static void test_output(void)
+{
+	memset(g_stub_port, 0, sizeof(g_stub_port));
+	Out::apply();
+	CHECK(R_PORT0->PCNTR3 == 0x10002000UL);
+	CHECK(R_PORT1->PCNTR3 == 0x08000000UL);
+	for (int _i = 2; _i < ra::PORT_NUM; _i++) {
+		CHECK(g_stub_port[_i][2] == 0);				// PCNTR3
+	}
+}
+
+/* configurePins: PmnPFSの設定値とプロテクト解除/施錠 */
+static void test_configure(void)
+{
+	memset(g_stub_pfs, 0, sizeof(g_stub_pfs));
+	ra::configurePins<
+		ra::PinConfig<P5_01, ra::pfs::peripheral(0b00101)>,
+		ra::PinConfig<P1_05, ra::pfs::PCR | ra::pfs::ISEL>
+	>();
+	CHECK(R_PFS->PORT[5].PIN[1].PmnPFS_b.PSEL == 0b00101);
+	CHECK(R_PFS->PORT[5].PIN[1].PmnPFS_b.PMR == 1);
+	CHECK(R_PFS->PORT[1].PIN[5].PmnPFS == 0x00004010UL);
+	CHECK(R_PFS->PORT[1].PIN[5].PmnPFS_b.PMR == 0);
+	CHECK(i32s_PinAccess == 0);
+}
+
+int main(void)
+{
+	test_pin();
+	test_pin_group();
+	test_output();
+	test_configure();
+
+	fprintf(stderr, "ra_pin: %s (%d failed)\n", (i32s_Fail == 0) ? "PASS" : "FAIL", i32s_Fail);
+	return i32s_Fail;
+}